@@ -0,0 +1,138 @@
+//
+// EventBench.cpp
+// 引擎事件基准：每局各类事件的回调次数、按值传参要复制的字节数、整局耗时
+//
+// 用法：EventBench [局数]
+//
+// - 四个监听者统计收到的事件，机器人过掉所有动作、打出编号最大的牌，打到终局后重新开始；
+// - 按值传参时每次回调复制一份事件（超过 16 字节的结构体在栈上复制），
+//   按 const 引用传参时监听者直接读引擎构造好的那一份，复制为 0；
+// - 另外不入座玩家，只用 GameEngine::apply 打同样多局（事件写进缓冲区，不分发），对比整局耗时。
+//
+
+#include "GameEngine.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+struct EventCount {
+    size_t start, send, out, notify, result, end;
+};
+
+class CountPlayer : public IPlayer, public IGameEngineEventListener {
+public:
+    CountPlayer(EventCount *pCount, bool *pGameEnd) : IPlayer(false, MALE, NULL), m_pCount(pCount), m_pGameEnd(pGameEnd) {
+        setGameEngineEventListener(this);
+    }
+    bool onUserEnterEvent(IPlayer *pIPlayer) override { return true; }
+    bool onGameStartEvent(const CMD_S_GameStart &GameStart) override { m_pCount->start++; return true; }
+    bool onSendCardEvent(const CMD_S_SendCard &SendCard) override { m_pCount->send++; return true; }
+    bool onOutCardEvent(const CMD_S_OutCard &OutCard) override { m_pCount->out++; return true; }
+    bool onOperateNotifyEvent(const CMD_S_OperateNotify &OperateNotify) override { m_pCount->notify++; return true; }
+    bool onOperateResultEvent(const CMD_S_OperateResult &OperateResult) override { m_pCount->result++; return true; }
+    bool onGameEndEvent(const CMD_S_GameEnd &GameEnd) override { m_pCount->end++; *m_pGameEnd = true; return true; }
+
+private:
+    EventCount *m_pCount;
+    bool *m_pGameEnd;
+};
+
+// 过掉所有动作，当前玩家打出编号最大的牌
+bool nextCommand(const tagGameState &State, tagGameCommand &Command) {
+    for (uint8_t i = 0; i < GAME_PLAYER; i++) {
+        if (State.cbUserAction[i] == WIK_NULL || State.bResponse[i]) continue;
+        Command = tagGameCommand::makeOperateCard(i, WIK_NULL, State.cbProvideCard);
+        return true;
+    }
+    if (State.cbCurrentUser >= GAME_PLAYER) return false;
+    for (int j = MAX_INDEX - 1; j >= 0; j--) {
+        if (State.cbCardIndex[State.cbCurrentUser][j] == 0) continue;
+        Command = tagGameCommand::makeOutCard(GameLogic::switchToCardData(static_cast<uint8_t>(j)));
+        return true;
+    }
+    return false;
+}
+
+// 经监听者适配执行一步
+bool step(GameEngine &engine) {
+    tagGameCommand Command;
+    if (!nextCommand(engine.getGameState(), Command)) return false;
+    if (Command.cbKind == GameCommand_OutCard) {
+        engine.onUserOutCard(Command.OutCard);
+    } else {
+        engine.onUserOperateCard(Command.OperateCard);
+    }
+    return true;
+}
+
+size_t copied(size_t calls, size_t size) {
+    return size > 16 ? calls * size : 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    size_t games = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 20000;
+    EventCount count = {0, 0, 0, 0, 0, 0};
+    bool bGameEnd = false;
+    CountPlayer *players[GAME_PLAYER];
+    GameEngine engine;
+    engine.setRoomSeed(42);
+    for (int i = 0; i < GAME_PLAYER; i++) players[i] = new CountPlayer(&count, &bGameEnd);
+
+    std::cout.setstate(std::ios::failbit);      //引擎每局结束会打日志
+    Clock::time_point begin = Clock::now();
+    for (size_t g = 0; g < games; g++) {
+        bGameEnd = false;
+        if (g == 0) {
+            for (int i = 0; i < GAME_PLAYER; i++) engine.onUserEnter(players[i]);
+        } else {
+            engine.onGameRestart();
+        }
+        int iSteps = 0;
+        while (!bGameEnd && iSteps++ < 1000 && step(engine)) {}
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - begin).count();
+    std::cout.clear();
+
+    size_t bytes = copied(count.start, sizeof(CMD_S_GameStart)) + copied(count.send, sizeof(CMD_S_SendCard))
+                   + copied(count.out, sizeof(CMD_S_OutCard)) + copied(count.notify, sizeof(CMD_S_OperateNotify))
+                   + copied(count.result, sizeof(CMD_S_OperateResult)) + copied(count.end, sizeof(CMD_S_GameEnd));
+    std::printf("每局回调：开始 %.1f × %zuB | 发牌 %.1f × %zuB | 出牌 %.1f × %zuB | 通知 %.1f × %zuB | 结果 %.1f × %zuB | 结束 %.1f × %zuB\n",
+                1.0 * count.start / games, sizeof(CMD_S_GameStart), 1.0 * count.send / games, sizeof(CMD_S_SendCard),
+                1.0 * count.out / games, sizeof(CMD_S_OutCard), 1.0 * count.notify / games, sizeof(CMD_S_OperateNotify),
+                1.0 * count.result / games, sizeof(CMD_S_OperateResult), 1.0 * count.end / games, sizeof(CMD_S_GameEnd));
+    //只用 apply，不分发事件
+    GameEngine core;
+    core.setRoomSeed(42);
+    GameEventBuffer Events;
+    size_t events = 0;
+    std::cout.setstate(std::ios::failbit);
+    begin = Clock::now();
+    for (size_t g = 0; g < games; g++) {
+        Events.clear();
+        core.apply(tagGameCommand::makeStart(GAME_PLAYER, 0), Events);
+        bool bEnd = false;
+        for (int n = 0; n < 1000 && !bEnd; n++) {
+            tagGameCommand Command;
+            if (!nextCommand(core.getGameState(), Command)) break;
+            Events.clear();
+            core.apply(Command, Events);
+            events += Events.size();
+            for (uint8_t e = 0; e < Events.size(); e++) bEnd = bEnd || Events[e].cbKind == GameEvent_GameEnd;
+        }
+    }
+    double headless = std::chrono::duration<double>(Clock::now() - begin).count();
+    std::cout.clear();
+
+    std::printf("按值传参每局复制 %.0f 字节，按引用 0 字节 | 监听者适配 %.2f us/局 | 只用 apply %.2f us/局（每局 %.1f 条事件）\n",
+                1.0 * bytes / games, elapsed * 1e6 / games, headless * 1e6 / games, 1.0 * events / games);
+    for (int i = 0; i < GAME_PLAYER; i++) delete players[i];
+    return 0;
+}
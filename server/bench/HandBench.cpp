@@ -0,0 +1,368 @@
+//
+// HandBench.cpp
+// 手牌表示基准：uint8_t[34] 数组与位压缩 PackedHand 的单项操作对比，以及整局模拟速度
+//
+// 用法：HandBench [操作次数] [模拟局数]
+//
+// - ops ：复制 + 摸一张 + 数牌、删一张、七对判断（数对子）、整手比较，以及听牌分析（打一张 × 摸 34 种，
+//         每次查表判定）两种表示各跑一遍；
+// - conv：牌值与索引互转（改动前按花色、点数计算 / 现在编译期生成的表），以及整手 14 张牌值转索引数组；
+// - game：4 个机器人通过 GameEngine 打完整局（能胡就胡，不碰不杠，出牌尽量保留听牌），
+//         每次摸牌、出牌都会经过 analyseHuCard 的卡张判定（34 次 analyseCanHuCard），统计每秒局数。
+//
+
+#include "GameEngine.h"
+#include "GameLogic.h"
+#include "HuTable.h"
+#include "PackedHand.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double secondsSince(Clock::time_point begin) {
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+struct Hand {
+    uint8_t cbCardIndex[MAX_INDEX];
+};
+
+std::vector<Hand> randomHands(std::mt19937 &rng, size_t count, uint8_t cbSize) {
+    std::vector<uint8_t> wall;
+    for (uint8_t i = 0; i < MAX_INDEX; i++) {
+        for (int k = 0; k < 4; k++) wall.push_back(i);
+    }
+    std::vector<Hand> hands(count);
+    for (size_t n = 0; n < count; n++) {
+        std::shuffle(wall.begin(), wall.end(), rng);
+        memset(hands[n].cbCardIndex, 0, MAX_INDEX);
+        for (uint8_t i = 0; i < cbSize; i++) hands[n].cbCardIndex[wall[i]]++;
+    }
+    return hands;
+}
+
+// 防止结果被优化掉
+volatile uint64_t g_sink = 0;
+
+template <typename F>
+double nsPerOp(size_t count, F op) {
+    uint64_t sink = 0;
+    Clock::time_point begin = Clock::now();
+    for (size_t i = 0; i < count; i++) {
+        sink += op(i);
+    }
+    double seconds = secondsSince(begin);
+    g_sink += sink;
+    return seconds * 1e9 / count;
+}
+
+void reportOp(const char *name, double arrayNs, double packedNs) {
+    std::printf("%-12s 数组 %8.2f ns | 位压缩 %8.2f ns (%5.1fx)\n", name, arrayNs, packedNs, arrayNs / packedNs);
+}
+
+// 改动前 GameLogic 的转换（除法、取模、掩码）
+uint8_t arithmeticIndex(uint8_t cbCardData) {
+    return static_cast<uint8_t>(((cbCardData & MASK_COLOR) >> 4) * 9 + (cbCardData & MASK_VALUE) - 1);
+}
+
+uint8_t arithmeticData(uint8_t cbCardIndex) {
+    return static_cast<uint8_t>(((cbCardIndex / 9) << 4) | (cbCardIndex % 9 + 1));
+}
+
+void reportConvert(const char *name, double arithmeticNs, double tableNs) {
+    std::printf("%-12s 计算 %8.2f ns | 查表   %8.2f ns (%5.1fx)\n", name, arithmeticNs, tableNs, arithmeticNs / tableNs);
+}
+
+void benchConvert(size_t count) {
+    std::mt19937 rng(7);
+    const size_t kCards = 4096;
+    std::vector<uint8_t> cards(kCards), indexes(kCards);
+    for (size_t i = 0; i < kCards; i++) {
+        indexes[i] = static_cast<uint8_t>(rng() % MAX_INDEX);
+        cards[i] = GameLogic::switchToCardData(indexes[i]);
+    }
+    //下标里读一次 volatile，防止整个循环被编译器折叠
+    reportConvert("牌值->索引",
+                  nsPerOp(count, [&](size_t n) { return arithmeticIndex(cards[(n + g_sink) % kCards]); }),
+                  nsPerOp(count, [&](size_t n) { return GameLogic::switchToCardIndex(cards[(n + g_sink) % kCards]); }));
+    reportConvert("索引->牌值",
+                  nsPerOp(count, [&](size_t n) { return arithmeticData(indexes[(n + g_sink) % kCards]); }),
+                  nsPerOp(count, [&](size_t n) { return GameLogic::switchToCardData(indexes[(n + g_sink) % kCards]); }));
+    reportConvert("14 张转数组",
+                  nsPerOp(count / 10, [&](size_t n) {
+                      uint8_t cbCardIndex[MAX_INDEX];
+                      memset(cbCardIndex, 0, sizeof(cbCardIndex));
+                      const uint8_t *cbCardData = &cards[(n * MAX_COUNT) % (kCards - MAX_COUNT)];
+                      for (uint8_t i = 0; i < MAX_COUNT; i++) cbCardIndex[arithmeticIndex(cbCardData[i])]++;
+                      return cbCardIndex[n % MAX_INDEX];
+                  }),
+                  nsPerOp(count / 10, [&](size_t n) {
+                      uint8_t cbCardIndex[MAX_INDEX];
+                      memset(cbCardIndex, 0, sizeof(cbCardIndex));
+                      const uint8_t *cbCardData = &cards[(n * MAX_COUNT) % (kCards - MAX_COUNT)];
+                      for (uint8_t i = 0; i < MAX_COUNT; i++) cbCardIndex[GameLogic::switchToCardIndex(cbCardData[i])]++;
+                      return cbCardIndex[n % MAX_INDEX];
+                  }));
+}
+
+// 数组版本的听牌分析（与改动前 GameLogic::analyseTingCard 相同的做法，判定直接查表）
+bool tingByArray(const uint8_t cbCardIndex[MAX_INDEX]) {
+    const HuTable &table = HuTable::instance();
+    uint8_t cbCardIndexTemp[MAX_INDEX];
+    memcpy(cbCardIndexTemp, cbCardIndex, sizeof(cbCardIndexTemp));
+    for (uint8_t i = 0; i < MAX_INDEX; i++) {
+        if (cbCardIndexTemp[i] == 0) continue;
+        cbCardIndexTemp[i]--;
+        for (uint8_t j = 0; j < MAX_INDEX; j++) {
+            uint8_t cbHand[MAX_INDEX];
+            memcpy(cbHand, cbCardIndexTemp, sizeof(cbHand));
+            cbHand[j]++;
+            uint8_t cbDuiCount = 0;
+            for (uint8_t k = 0; k < MAX_INDEX; k++) cbDuiCount += cbHand[k] == 2;
+            if (cbDuiCount == 7 || table.isComplete(cbHand)) return true;
+        }
+        cbCardIndexTemp[i]++;
+    }
+    return false;
+}
+
+bool tingByPacked(const uint8_t cbCardIndex[MAX_INDEX]) {
+    const HuTable &table = HuTable::instance();
+    PackedHand Hand(cbCardIndex);
+    for (uint8_t i = 0; i < MAX_INDEX; i++) {
+        if (!Hand.remove(i)) continue;
+        for (uint8_t j = 0; j < MAX_INDEX; j++) {
+            PackedHand HandTemp = Hand;
+            HandTemp.add(j);
+            if (HandTemp.countEqual(2) == 7 || table.isComplete(HandTemp)) return true;
+        }
+        Hand.add(i);
+    }
+    return false;
+}
+
+void benchOps(size_t count) {
+    std::mt19937 rng(42);
+    const size_t kHands = 4096;
+    std::vector<Hand> hands = randomHands(rng, kHands, MAX_COUNT - 1);
+    std::vector<PackedHand> packed;
+    for (size_t i = 0; i < kHands; i++) packed.push_back(PackedHand(hands[i].cbCardIndex));
+
+    reportOp("摸牌+数牌",
+             nsPerOp(count, [&](size_t n) {
+                 uint8_t cbTemp[MAX_INDEX];
+                 memcpy(cbTemp, hands[n % kHands].cbCardIndex, sizeof(cbTemp));
+                 cbTemp[n % MAX_INDEX]++;
+                 return GameLogic::getCardCount(cbTemp);
+             }),
+             nsPerOp(count, [&](size_t n) {
+                 PackedHand Temp = packed[n % kHands];
+                 Temp.add(static_cast<uint8_t>(n % MAX_INDEX));
+                 return Temp.total();
+             }));
+    reportOp("删一张",
+             nsPerOp(count, [&](size_t n) {
+                 uint8_t cbTemp[MAX_INDEX];
+                 memcpy(cbTemp, hands[n % kHands].cbCardIndex, sizeof(cbTemp));
+                 return GameLogic::removeCard(cbTemp, GameLogic::switchToCardData(static_cast<uint8_t>(n % MAX_INDEX))) ? cbTemp[0] + 1 : 0;
+             }),
+             nsPerOp(count, [&](size_t n) {
+                 PackedHand Temp = packed[n % kHands];
+                 return Temp.remove(static_cast<uint8_t>(n % MAX_INDEX)) ? Temp.word(0) + 1 : 0;
+             }));
+    reportOp("数对子",
+             nsPerOp(count, [&](size_t n) {
+                 const uint8_t *cbHand = hands[n % kHands].cbCardIndex;
+                 uint8_t cbDuiCount = 0;
+                 for (uint8_t i = 0; i < MAX_INDEX; i++) cbDuiCount += cbHand[i] == 2;
+                 return cbDuiCount;
+             }),
+             nsPerOp(count, [&](size_t n) {
+                 return packed[n % kHands].countEqual(2);
+             }));
+    reportOp("整手比较",
+             nsPerOp(count, [&](size_t n) {
+                 return memcmp(hands[n % kHands].cbCardIndex, hands[(n + 1) % kHands].cbCardIndex, MAX_INDEX) == 0;
+             }),
+             nsPerOp(count, [&](size_t n) {
+                 return packed[n % kHands] == packed[(n + 1) % kHands];
+             }));
+    size_t tingCount = std::max<size_t>(count / 1000, 1);
+    reportOp("听牌分析",
+             nsPerOp(tingCount, [&](size_t n) { return tingByArray(hands[n % kHands].cbCardIndex); }),
+             nsPerOp(tingCount, [&](size_t n) { return tingByPacked(hands[n % kHands].cbCardIndex); }));
+    reportOp("胡牌数量",
+             nsPerOp(tingCount, [&](size_t n) {
+                 uint8_t cbCount = 0;
+                 for (uint8_t j = 0; j < MAX_INDEX; j++) {
+                     uint8_t cbHand[MAX_INDEX];
+                     memcpy(cbHand, hands[n % kHands].cbCardIndex, sizeof(cbHand));
+                     cbHand[j]++;
+                     cbCount += HuTable::instance().isComplete(cbHand);
+                 }
+                 return cbCount;
+             }),
+             nsPerOp(tingCount, [&](size_t n) {
+                 tagWeaveItem WeaveItem[MAX_WEAVE];
+                 return GameLogic::analyseHuCardCount(hands[n % kHands].cbCardIndex, WeaveItem, 0);
+             }));
+}
+
+// 一次待处理的动作：回调中只记录，由驱动循环在引擎调用返回后执行（引擎回调是同步的）
+struct Pending {
+    uint8_t cbChairID;
+    bool bRespond;          //响应别人的牌（否则是自己的回合）
+    uint8_t cbActionMask;
+    uint8_t cbCard;
+};
+
+class BenchPlayer : public IPlayer, public IGameEngineEventListener {
+public:
+    BenchPlayer(std::deque<Pending> *pQueue, bool *pGameEnd)
+            : IPlayer(false, MALE, NULL), m_pQueue(pQueue), m_pGameEnd(pGameEnd) {
+        setGameEngineEventListener(this);
+        memset(m_cbCardIndex, 0, sizeof(m_cbCardIndex));
+    }
+
+    bool onUserEnterEvent(IPlayer *pIPlayer) override { return true; }
+
+    bool onGameStartEvent(const CMD_S_GameStart &GameStart) override {
+        memset(m_cbCardIndex, 0, sizeof(m_cbCardIndex));
+        GameLogic::switchToCardIndex(GameStart.cbCardData, MAX_COUNT - 1, m_cbCardIndex);
+        return true;
+    }
+
+    bool onSendCardEvent(const CMD_S_SendCard &SendCard) override {
+        if (SendCard.cbCurrentUser != m_ChairID) return true;
+        m_cbCardIndex[GameLogic::switchToCardIndex(SendCard.cbCardData)]++;
+        Pending pending = {m_ChairID, false, SendCard.cbActionMask, SendCard.cbCardData};
+        m_pQueue->push_back(pending);
+        return true;
+    }
+
+    bool onOutCardEvent(const CMD_S_OutCard &OutCard) override { return true; }
+
+    bool onOperateNotifyEvent(const CMD_S_OperateNotify &OperateNotify) override {
+        Pending pending = {m_ChairID, true, OperateNotify.cbActionMask, OperateNotify.cbActionCard};
+        m_pQueue->push_back(pending);
+        return true;
+    }
+
+    bool onOperateResultEvent(const CMD_S_OperateResult &OperateResult) override { return true; }
+
+    bool onGameEndEvent(const CMD_S_GameEnd &GameEnd) override {
+        *m_pGameEnd = true;
+        return true;
+    }
+
+    // 出牌：优先保留听牌（打出后胡牌数量最多），否则打出孤张
+    uint8_t chooseOutCard() {
+        tagWeaveItem WeaveItem[MAX_WEAVE];
+        uint8_t cbBest = 0, cbBestHu = 0;
+        int iBestScore = 1 << 30;
+        for (uint8_t i = 0; i < MAX_INDEX; i++) {
+            if (m_cbCardIndex[i] == 0) continue;
+            m_cbCardIndex[i]--;
+            uint8_t cbHu = GameLogic::analyseHuCardCount(m_cbCardIndex, WeaveItem, 0);
+            m_cbCardIndex[i]++;
+            int iScore = 3 * m_cbCardIndex[i];
+            if (i < 27) {
+                uint8_t cbPos = static_cast<uint8_t>(i % 9);
+                if (cbPos > 0) iScore += 2 * m_cbCardIndex[i - 1];
+                if (cbPos < 8) iScore += 2 * m_cbCardIndex[i + 1];
+                if (cbPos > 1) iScore += m_cbCardIndex[i - 2];
+                if (cbPos < 7) iScore += m_cbCardIndex[i + 2];
+            }
+            if (cbHu > cbBestHu || (cbHu == cbBestHu && iScore < iBestScore)) {
+                cbBest = i;
+                cbBestHu = cbHu;
+                iBestScore = iScore;
+            }
+        }
+        m_cbCardIndex[cbBest]--;
+        return GameLogic::switchToCardData(cbBest);
+    }
+
+private:
+    uint8_t m_cbCardIndex[MAX_INDEX];   //自己的手牌（不碰不杠，只有摸牌和出牌）
+    std::deque<Pending> *m_pQueue;
+    bool *m_pGameEnd;
+};
+
+void benchGames(size_t games) {
+    std::deque<Pending> queue;
+    bool bGameEnd = false;
+    GameEngine engine;
+    std::vector<BenchPlayer *> players;
+    for (int i = 0; i < GAME_PLAYER; i++) {
+        players.push_back(new BenchPlayer(&queue, &bGameEnd));
+    }
+    engine.setRoomSeed(42);                     //各局牌墙固定，便于前后对比
+    std::cout.setstate(std::ios::failbit);      //引擎每局结束会打日志
+
+    size_t huGames = 0, actions = 0;
+    Clock::time_point begin = Clock::now();
+    for (size_t g = 0; g < games; g++) {
+        bGameEnd = false;
+        queue.clear();
+        if (g == 0) {
+            for (int i = 0; i < GAME_PLAYER; i++) engine.onUserEnter(players[i]);
+        } else {
+            engine.onGameRestart();
+        }
+        while (!bGameEnd && !queue.empty()) {
+            Pending pending = queue.front();
+            queue.pop_front();
+            actions++;
+            CMD_C_OperateCard OperateCard;
+            OperateCard.cbOperateUser = pending.cbChairID;
+            OperateCard.cbOperateCard = pending.cbCard;
+            if ((pending.cbActionMask & WIK_H) != 0) {
+                OperateCard.cbOperateCode = WIK_H;
+                engine.onUserOperateCard(OperateCard);
+                continue;
+            }
+            if (pending.bRespond) {
+                OperateCard.cbOperateCode = WIK_NULL;       //不碰不杠
+                engine.onUserOperateCard(OperateCard);
+                continue;
+            }
+            if (pending.cbActionMask != WIK_NULL) {
+                OperateCard.cbOperateCode = WIK_NULL;       //自己的回合放弃杠
+                engine.onUserOperateCard(OperateCard);
+            }
+            CMD_C_OutCard OutCard;
+            OutCard.cbCardData = players[pending.cbChairID]->chooseOutCard();
+            engine.onUserOutCard(OutCard);
+        }
+        if (bGameEnd) huGames++;
+    }
+    double seconds = secondsSince(begin);
+    std::cout.clear();
+    std::printf("game         %zu 局 %.2f 秒，%.0f 局/秒，%.1f us/动作（结束 %zu 局）\n",
+                games, seconds, games / seconds, seconds * 1e6 / actions, huGames);
+    for (size_t i = 0; i < players.size(); i++) delete players[i];
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 20000000;
+    size_t games = argc > 2 ? static_cast<size_t>(std::atol(argv[2])) : 2000;
+    HuTable::instance();
+    benchOps(count);
+    benchConvert(count);
+    benchGames(games);
+    return 0;
+}
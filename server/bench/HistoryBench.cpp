@@ -0,0 +1,158 @@
+//
+// HistoryBench.cpp
+// 对局历史基准：写入速度、压缩后的大小、按玩家查询和规则统计的延迟
+//
+// 用法：HistoryBench [局数] [玩家数]
+//
+// - 先由四个机器人打出 2000 局取得真实的结算结果，再循环使用这些结果、从玩家池里随机入座，
+//   每秒 20 局（结束时间递增）写入指定局数，默认 1000 万局；1 亿局需要约 3 GB 磁盘；
+// - 写入速度含玩家编号和写满换段，压缩在后台线程，另给出等待全部压缩完成的总耗时；
+// - 查询：随机玩家的积分汇总（全部时间）、最近 20 局，全部对局和最近一天的规则统计。
+//
+
+#include "BotPlayer.h"
+#include "MatchHistory.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const char *kHistoryPath = "HistoryBench";
+const uint32_t kBaseTime = 1700000000;
+
+class GameEndTap : public IGameCommandListener {
+public:
+    explicit GameEndTap(std::vector<CMD_S_GameEnd> &GameEnds) : m_GameEnds(GameEnds) {}
+
+    void onCommandApplied(const tagGameCommand &, uint8_t, const tagGameState &, const GameEventBuffer &Events,
+                          uint8_t cbFirstEvent) override {
+        for (uint8_t i = cbFirstEvent; i < Events.size(); i++) {
+            if (Events[i].cbKind == GameEvent_GameEnd) m_GameEnds.push_back(Events[i].GameEnd);
+        }
+    }
+
+private:
+    std::vector<CMD_S_GameEnd> &m_GameEnds;
+};
+
+std::vector<CMD_S_GameEnd> playHands(size_t hands) {
+    std::vector<CMD_S_GameEnd> GameEnds;
+    GameEndTap Tap(GameEnds);
+    GameEngine engine;
+    engine.setQuiet(true);
+    engine.setCommandListener(&Tap);
+    BotPlayer bots[GAME_PLAYER];
+    engine.setRoomSeed(2048);
+    for (int i = 0; i < GAME_PLAYER; i++) engine.onUserEnter(&bots[i]);
+    for (size_t h = 0; h < hands; h++) {
+        if (h > 0) engine.onGameRestart();
+        for (int n = 0; n < 1000 && !bots[0].isGameEnd(); n++) {
+            tagGameCommand Command;
+            bool bTaken = false;
+            for (int i = 0; i < GAME_PLAYER && !bTaken; i++) bTaken = bots[i].takeCommand(Command);
+            if (!bTaken) break;
+            GameEventBuffer Events;
+            engine.apply(Command, Events);
+            engine.dispatchEvents(Events);
+        }
+    }
+    engine.setCommandListener(NULL);
+    return GameEnds;
+}
+
+void removeHistory() {
+    char szPath[256];
+    for (unsigned int seq = 1; seq < 100000; seq++) {
+        std::snprintf(szPath, sizeof(szPath), "%s.%08u", kHistoryPath, seq);
+        if (std::remove(szPath) != 0 && seq > 1) break;
+    }
+    std::remove((std::string(kHistoryPath) + ".players").c_str());
+}
+
+double elapsed(Clock::time_point Begin) {
+    return std::chrono::duration<double>(Clock::now() - Begin).count();
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    size_t hands = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 10000000;
+    size_t players = argc > 2 ? static_cast<size_t>(std::atol(argv[2])) : 1000000;
+    std::cout.setstate(std::ios::failbit);
+
+    std::vector<CMD_S_GameEnd> GameEnds = playHands(2000);
+    std::vector<std::string> PlayerIds(players);
+    for (size_t i = 0; i < players; i++) PlayerIds[i] = "player_" + std::to_string(i);
+    uint64_t llRandom = 0x9E3779B97F4A7C15ULL;
+
+    removeHistory();
+    MatchHistory::Config config;
+    config.path = kHistoryPath;
+    MatchHistory history(config);
+    if (!history.open()) {
+        std::printf("无法创建对局历史 %s\n", kHistoryPath);
+        return 1;
+    }
+
+    //每局预先生成结果会占用太多内存，入座和生成结果计入写入时间
+    Clock::time_point Begin = Clock::now();
+    std::string playerIds[GAME_PLAYER];
+    for (size_t h = 0; h < hands; h++) {
+        for (int s = 0; s < GAME_PLAYER; s++) {
+            llRandom ^= llRandom << 13;
+            llRandom ^= llRandom >> 7;
+            llRandom ^= llRandom << 17;
+            playerIds[s] = PlayerIds[llRandom % players];
+        }
+        history.append(MatchRecord::fromGameEnd(GameEnds[h % GameEnds.size()], playerIds, kBaseTime + static_cast<uint32_t>(h / 20)));
+    }
+    double dAppend = elapsed(Begin);
+    history.waitSealed();
+    double dSealed = elapsed(Begin);
+    std::printf("[HistoryBench] %zu 局，%zu 位玩家，%zu 段\n", hands, players, history.getSegmentCount());
+    std::printf("写入：%.0f 局/秒（%.0f ns/局），含后台压缩 %.1f 秒；已压缩 %llu 局，每局 %.1f 字节\n", hands / dAppend,
+                dAppend * 1e9 / hands, dSealed, static_cast<unsigned long long>(history.getSealedHands()),
+                history.getSealedHands() > 0 ? 1.0 * history.getStoredBytes() / history.getSealedHands() : 0.0);
+
+    const int kQueries = 20;
+    std::vector<double> Totals, Recent;
+    uint64_t llHands = 0;
+    for (int q = 0; q < kQueries; q++) {
+        const std::string &playerId = PlayerIds[(q * 7919) % players];
+        Clock::time_point Start = Clock::now();
+        llHands += history.playerTotals(playerId).hands;
+        Totals.push_back(elapsed(Start));
+        std::vector<MatchRecord> Records;
+        Start = Clock::now();
+        history.playerHistory(playerId, 20, Records);
+        Recent.push_back(elapsed(Start));
+    }
+    std::sort(Totals.begin(), Totals.end());
+    std::sort(Recent.begin(), Recent.end());
+    std::printf("玩家积分汇总：中位 %.2f ms，最大 %.2f ms（平均每位玩家 %.1f 局，扫描 %.1f 亿行/秒）\n", Totals[kQueries / 2] * 1e3,
+                Totals.back() * 1e3, 1.0 * llHands / kQueries, hands * GAME_PLAYER / Totals[kQueries / 2] / 1e8);
+    std::printf("玩家最近 20 局：中位 %.2f ms，最大 %.2f ms\n", Recent[kQueries / 2] * 1e3, Recent.back() * 1e3);
+
+    Clock::time_point Start = Clock::now();
+    RuleStats All = history.ruleStats();
+    double dAll = elapsed(Start);
+    uint32_t dwLast = kBaseTime + static_cast<uint32_t>(hands / 20);
+    Start = Clock::now();
+    RuleStats Day = history.ruleStats(dwLast > 86400 ? dwLast - 86400 : 0, UINT32_MAX);
+    double dDay = elapsed(Start);
+    std::printf("规则统计（全部 %llu 局）：%.2f ms，流局 %.1f%%，自摸占胡牌 %.1f%%；最近一天（%llu 局）：%.2f ms\n",
+                static_cast<unsigned long long>(All.hands), dAll * 1e3, All.hands > 0 ? 100.0 * All.draws / All.hands : 0.0,
+                All.winners > 0 ? 100.0 * All.huKind[0] / All.winners : 0.0, static_cast<unsigned long long>(Day.hands), dDay * 1e3);
+
+    history.close();
+    removeHistory();
+    return 0;
+}
@@ -0,0 +1,122 @@
+//
+// HuBench.cpp
+// 胡牌判定基准：组合搜索 analyseCardBySearch 与查表 analyseCard / HuTable::analyse 每秒可判定的手数
+//
+// 用法：HuBench [手数]
+//
+// - random ：从洗好的牌墙取 14 张，绝大多数不能胡（判定的主要场景：每次摸牌、别人出牌）；
+// - winning：随机拼出的胡牌（面子 + 将），拆法的列出也计入耗时；
+// - ting   ：analyseTingCard（打出一张 × 摸进 34 种）的整轮耗时，内部调用 analyseCanHuCard。
+//
+
+#include "GameLogic.h"
+#include "HuTable.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+struct Hand {
+    uint8_t cbCardIndex[MAX_INDEX];
+    uint8_t cbCardCount;
+};
+
+std::vector<Hand> randomHands(std::mt19937 &rng, size_t count) {
+    std::vector<uint8_t> wall;
+    for (uint8_t i = 0; i < MAX_INDEX; i++) {
+        for (int k = 0; k < 4; k++) wall.push_back(i);
+    }
+    std::vector<Hand> hands(count);
+    for (size_t n = 0; n < count; n++) {
+        std::shuffle(wall.begin(), wall.end(), rng);
+        memset(hands[n].cbCardIndex, 0, MAX_INDEX);
+        for (uint8_t i = 0; i < MAX_COUNT; i++) hands[n].cbCardIndex[wall[i]]++;
+        hands[n].cbCardCount = MAX_COUNT;
+    }
+    return hands;
+}
+
+std::vector<Hand> winningHands(std::mt19937 &rng, size_t count) {
+    std::vector<Hand> hands;
+    while (hands.size() < count) {
+        Hand hand;
+        memset(hand.cbCardIndex, 0, MAX_INDEX);
+        uint8_t cbSuit = static_cast<uint8_t>(rng() % 3);
+        for (int m = 0; m < MAX_WEAVE; m++) {
+            if (rng() % 2 == 0) {
+                uint8_t i = static_cast<uint8_t>(cbSuit * 9 + rng() % 7);
+                hand.cbCardIndex[i]++; hand.cbCardIndex[i + 1]++; hand.cbCardIndex[i + 2]++;
+            } else {
+                hand.cbCardIndex[rng() % MAX_INDEX] += 3;
+            }
+        }
+        hand.cbCardIndex[rng() % MAX_INDEX] += 2;
+        hand.cbCardCount = MAX_COUNT;
+        bool bValid = true;
+        for (uint8_t i = 0; i < MAX_INDEX; i++) bValid = bValid && hand.cbCardIndex[i] <= 4;
+        if (bValid) hands.push_back(hand);
+    }
+    return hands;
+}
+
+template <typename F>
+double handsPerSecond(const std::vector<Hand> &hands, size_t &huCount, F analyse) {
+    huCount = 0;
+    Clock::time_point begin = Clock::now();
+    for (size_t i = 0; i < hands.size(); i++) {
+        if (analyse(hands[i])) huCount++;
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+    return hands.size() / seconds;
+}
+
+void report(const char *name, const std::vector<Hand> &hands) {
+    const HuTable &table = HuTable::instance();
+    size_t searchHu = 0, tableHu = 0, flagHu = 0;
+    double search = handsPerSecond(hands, searchHu, [](const Hand &hand) {
+        CAnalyseItemArray items;
+        return GameLogic::analyseCardBySearch(hand.cbCardIndex, hand.cbCardCount, nullptr, 0, items);
+    });
+    double decompose = handsPerSecond(hands, tableHu, [](const Hand &hand) {
+        CAnalyseItemArray items;
+        return GameLogic::analyseCard(hand.cbCardIndex, hand.cbCardCount, nullptr, 0, items);
+    });
+    double flags = handsPerSecond(hands, flagHu, [&table](const Hand &hand) {
+        return table.isComplete(hand.cbCardIndex);
+    });
+    std::printf("%-8s 组合搜索 %12.0f 手/秒 | 查表+拆法 %12.0f 手/秒 (%5.1fx) | 只查表 %12.0f 手/秒 (%6.1fx) | 胡 %zu/%zu/%zu\n",
+                name, search, decompose, decompose / search, flags, flags / search, searchHu, tableHu, flagHu);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 200000;
+    std::mt19937 rng(42);
+
+    Clock::time_point begin = Clock::now();
+    HuTable::instance();
+    std::printf("生成表耗时 %.1f ms\n", std::chrono::duration<double, std::milli>(Clock::now() - begin).count());
+
+    report("random", randomHands(rng, count));
+    report("winning", winningHands(rng, count));
+
+    // 听牌分析：13 张手牌，每次最多 14 × 34 次 analyseCanHuCard
+    std::vector<Hand> hands = randomHands(rng, count / 100);
+    size_t tingCount = 0;
+    begin = Clock::now();
+    for (size_t i = 0; i < hands.size(); i++) {
+        if (GameLogic::analyseTingCard(hands[i].cbCardIndex, nullptr, 0)) tingCount++;
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+    std::printf("ting     analyseTingCard %.2f us/次（%zu 手，可听 %zu）\n", seconds * 1e6 / hands.size(), hands.size(), tingCount);
+    return 0;
+}
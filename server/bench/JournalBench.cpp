@@ -0,0 +1,246 @@
+//
+// JournalBench.cpp
+// 房间日志基准：每条命令的写日志开销、各落盘策略的吞吐、组提交、恢复速度
+//
+// 用法：JournalBench [局数] [线程数]
+//
+// - 先由四个机器人打出若干局并记下全部命令，再按原顺序重新执行：一遍不写日志，每种落盘策略各一遍写日志
+//   （与房间一样在命令执行后追加开局或命令记录），差值除以命令数就是每条命令的写日志开销；
+// - 组提交：多个线程各自占一张桌并发追加命令，Always 策略下比较每秒命令数与 msync 次数；
+// - 恢复：关闭日志后重新打开，给出重放的命令数和耗时。
+//
+
+#include "BotPlayer.h"
+#include "RoomJournal.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const char *kJournalPath = "JournalBench.journal";
+
+struct tagHand {
+    uint64_t llGameSeed;
+    uint8_t cbBankerUser;                       //开局前的庄家
+    std::vector<tagGameCommand> Commands;       //开局之后的命令
+};
+
+//记下每局的种子、开局前的庄家和之后的命令
+class HandCapture : public IGameCommandListener {
+public:
+    explicit HandCapture(std::vector<tagHand> &Hands) : m_Hands(Hands) {}
+
+    void onCommandApplied(const tagGameCommand &Command, uint8_t cbChairID, const tagGameState &State,
+                          const GameEventBuffer &, uint8_t) override {
+        if (Command.cbKind == GameCommand_Start) {
+            tagHand Hand;
+            Hand.llGameSeed = State.llGameSeed;
+            Hand.cbBankerUser = cbChairID;
+            m_Hands.push_back(Hand);
+        } else if (!m_Hands.empty()) {
+            m_Hands.back().Commands.push_back(Command);
+        }
+    }
+
+private:
+    std::vector<tagHand> &m_Hands;
+};
+
+//机器人打 hands 局
+std::vector<tagHand> playHands(size_t hands) {
+    std::vector<tagHand> Hands;
+    HandCapture Capture(Hands);
+    GameEngine engine;
+    engine.setQuiet(true);
+    engine.setCommandListener(&Capture);
+    BotPlayer bots[GAME_PLAYER];
+    engine.setRoomSeed(2047);
+    for (int i = 0; i < GAME_PLAYER; i++) engine.onUserEnter(&bots[i]);
+    for (size_t h = 0; h < hands; h++) {
+        if (h > 0) engine.onGameRestart();
+        for (int n = 0; n < 1000 && !bots[0].isGameEnd(); n++) {
+            tagGameCommand Command;
+            bool bTaken = false;
+            for (int i = 0; i < GAME_PLAYER && !bTaken; i++) bTaken = bots[i].takeCommand(Command);
+            if (!bTaken) break;
+            GameEventBuffer Events;
+            engine.apply(Command, Events);
+            engine.dispatchEvents(Events);
+        }
+    }
+    engine.setCommandListener(NULL);
+    return Hands;
+}
+
+//与 Room 相同：命令执行后追加开局或命令记录
+class JournalTap : public IGameCommandListener {
+public:
+    JournalTap(RoomJournal &journal, uint32_t dwRoom) : m_Journal(journal), m_dwRoom(dwRoom) {}
+
+    void onCommandApplied(const tagGameCommand &Command, uint8_t cbChairID, const tagGameState &State,
+                          const GameEventBuffer &, uint8_t) override {
+        if (Command.cbKind == GameCommand_Start) {
+            m_Journal.appendStart(m_dwRoom, State.llGameSeed, cbChairID, Command.Start.cbPlayerCount, Command.Start.cbAndroidMask);
+        } else {
+            m_Journal.appendCommand(m_dwRoom, Command);
+        }
+    }
+
+private:
+    RoomJournal &m_Journal;
+    uint32_t m_dwRoom;
+};
+
+//按记录重新执行全部局，pJournal 不为 NULL 时同时写日志（bCloseTable 为 false 时不关桌，留给下次 open 恢复），返回秒数
+double applyAll(const std::vector<tagHand> &Hands, RoomJournal *pJournal, bool bCloseTable = true) {
+    GameEngine engine;
+    engine.setQuiet(true);
+    JournalSeat Seats[GAME_PLAYER];
+    for (int i = 0; i < GAME_PLAYER; i++) Seats[i].bot = true;
+    uint32_t dwRoom = 0;
+    std::unique_ptr<JournalTap> pTap;
+    if (pJournal != NULL) {
+        dwRoom = pJournal->openTable("bench", Seats);
+        pTap.reset(new JournalTap(*pJournal, dwRoom));
+        engine.setCommandListener(pTap.get());
+    }
+    const tagGameCommand Start = tagGameCommand::makeStart(GAME_PLAYER, 0x0F);
+    Clock::time_point Begin = Clock::now();
+    for (size_t h = 0; h < Hands.size(); h++) {
+        engine.setBankerUser(Hands[h].cbBankerUser);
+        engine.setGameSeed(Hands[h].llGameSeed);
+        GameEventBuffer Events;
+        engine.apply(Start, Events);
+        for (size_t n = 0; n < Hands[h].Commands.size(); n++) {
+            Events.clear();
+            engine.apply(Hands[h].Commands[n], Events);
+        }
+    }
+    double dSeconds = std::chrono::duration<double>(Clock::now() - Begin).count();
+    engine.setCommandListener(NULL);
+    if (pJournal != NULL && bCloseTable) pJournal->closeTable(dwRoom);
+    return dSeconds;
+}
+
+void removeJournal() {
+    char szPath[256];
+    for (unsigned int seq = 1; seq < 1000; seq++) {
+        std::snprintf(szPath, sizeof(szPath), "%s.%08u", kJournalPath, seq);
+        std::remove(szPath);
+    }
+}
+
+RoomJournal::Config makeConfig(JournalSync Sync) {
+    RoomJournal::Config Config;
+    Config.path = kJournalPath;
+    Config.sync = Sync;
+    return Config;
+}
+
+const char *syncName(JournalSync Sync) {
+    return Sync == JournalSync::None ? "none" : (Sync == JournalSync::Interval ? "interval" : "always");
+}
+
+//threads 个线程各占一张桌并发追加 commands 条命令，返回秒数
+double appendConcurrent(RoomJournal &journal, int threads, size_t commands) {
+    std::vector<std::thread> Workers;
+    std::atomic<int> ready(0);
+    std::atomic<bool> go(false);
+    for (int t = 0; t < threads; t++) {
+        Workers.emplace_back([&journal, &ready, &go, commands, t]() {
+            JournalSeat Seats[GAME_PLAYER];
+            char szRoom[32];
+            std::snprintf(szRoom, sizeof(szRoom), "bench_%d", t);
+            uint32_t dwRoom = journal.openTable(szRoom, Seats);
+            const tagGameCommand Command = tagGameCommand::makeOutCard(0x01);
+            ready++;
+            while (!go) std::this_thread::yield();
+            for (size_t n = 0; n < commands; n++) journal.appendCommand(dwRoom, Command);
+            journal.closeTable(dwRoom);
+        });
+    }
+    while (ready < threads) std::this_thread::yield();
+    Clock::time_point Begin = Clock::now();
+    go = true;
+    for (size_t t = 0; t < Workers.size(); t++) Workers[t].join();
+    return std::chrono::duration<double>(Clock::now() - Begin).count();
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    size_t hands = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 2000;
+    int threads = argc > 2 ? std::atoi(argv[2]) : 8;
+    std::cout.setstate(std::ios::failbit);
+
+    std::vector<tagHand> Hands = playHands(hands);
+    size_t commands = 0;
+    for (size_t h = 0; h < Hands.size(); h++) commands += Hands[h].Commands.size() + 1;       //含每局的开始命令
+
+    double dPlain = applyAll(Hands, NULL);
+    std::printf("[JournalBench] %zu 局，%zu 条命令；不写日志 %.1f ns/命令\n", hands, commands, dPlain * 1e9 / commands);
+
+    const JournalSync Policies[] = {JournalSync::None, JournalSync::Interval, JournalSync::Always};
+    for (size_t p = 0; p < sizeof(Policies) / sizeof(Policies[0]); p++) {
+        removeJournal();
+        RoomJournal journal(makeConfig(Policies[p]));
+        std::vector<RecoveredRoom> Rooms;
+        if (!journal.open(Rooms)) {
+            std::printf("无法创建日志文件 %s\n", kJournalPath);
+            return 1;
+        }
+        //Always 下每条命令都等一次 msync，只跑前 1/20 的局
+        std::vector<tagHand> Subset(Hands.begin(), Policies[p] == JournalSync::Always ? Hands.begin() + (Hands.size() + 19) / 20 : Hands.end());
+        size_t subsetCommands = 0;
+        for (size_t h = 0; h < Subset.size(); h++) subsetCommands += Subset[h].Commands.size() + 1;
+        double dPlainSubset = Subset.size() == Hands.size() ? dPlain : applyAll(Subset, NULL);
+        double dJournal = applyAll(Subset, &journal);
+        std::printf("%-8s：%.1f ns/命令，写日志开销 %.1f ns/命令，%.0f 条命令/秒，%.1f 字节/命令，msync %llu 次\n",
+                    syncName(Policies[p]), dJournal * 1e9 / subsetCommands, (dJournal - dPlainSubset) * 1e9 / subsetCommands,
+                    subsetCommands / dJournal, 1.0 * journal.getAppendedBytes() / subsetCommands,
+                    static_cast<unsigned long long>(journal.getSyncCount()));
+    }
+
+    //组提交：并发追加时一次 msync 提交多条记录
+    for (int t = 1; t <= threads; t *= 2) {
+        removeJournal();
+        RoomJournal journal(makeConfig(JournalSync::Always));
+        std::vector<RecoveredRoom> Rooms;
+        journal.open(Rooms);
+        size_t perThread = 2000;
+        double dSeconds = appendConcurrent(journal, t, perThread);
+        double dTotal = 1.0 * perThread * t;
+        std::printf("always %d 线程：%.0f 条命令/秒，msync %llu 次，每次 msync 提交 %.1f 条记录\n", t, dTotal / dSeconds,
+                    static_cast<unsigned long long>(journal.getSyncCount()),
+                    journal.getSyncCount() > 0 ? dTotal / journal.getSyncCount() : 0.0);
+    }
+
+    //恢复：全部局写进一张未关的桌，重新打开时整段重放
+    removeJournal();
+    {
+        RoomJournal journal(makeConfig(JournalSync::None));
+        std::vector<RecoveredRoom> Rooms;
+        journal.open(Rooms);
+        applyAll(Hands, &journal, false);
+    }
+    {
+        RoomJournal journal(makeConfig(JournalSync::None));
+        std::vector<RecoveredRoom> Rooms;
+        RecoveryStats Stats;
+        journal.open(Rooms, &Stats);
+        std::printf("恢复：%zu 个文件 %llu 字节，重放 %llu 条命令，%.1f ms（%.0f 条命令/秒），恢复 %zu 个房间\n", Stats.files,
+                    static_cast<unsigned long long>(Stats.bytes), static_cast<unsigned long long>(Stats.commands),
+                    Stats.seconds * 1e3, Stats.seconds > 0 ? Stats.commands / Stats.seconds : 0.0, Stats.rooms);
+    }
+    removeJournal();
+    return 0;
+}
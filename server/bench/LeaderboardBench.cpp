@@ -0,0 +1,186 @@
+//
+// LeaderboardBench.cpp
+// 排行榜基准：批量登记、更新吞吐、按速率提交时的查询延迟、快照的写入和读入
+//
+// 用法：LeaderboardBench [玩家数] [秒数] [每秒更新数]
+//
+// - 默认 1000 万位玩家：先每人提交一次积分（含登记新玩家），再对已有玩家尽快提交 200 万次，给出后台线程的
+//   更新吞吐；
+// - 之后由一个线程按每秒更新数（默认 5 万，即每秒 12500 局、每局 4 人）提交指定秒数（默认 5），同时主线程
+//   每毫秒查询一次随机玩家的名次（总榜和周榜）和总榜前 100 名，给出提交耗时、查询延迟和结束时积压的更新；
+// - 最后写一次快照并重新打开，给出快照大小和读入（按名次自底向上重建各榜）耗时。
+//
+
+#include "Leaderboard.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const char *kSnapshotPath = "LeaderboardBench.snapshot";
+
+double elapsed(Clock::time_point Begin) {
+    return std::chrono::duration<double>(Clock::now() - Begin).count();
+}
+
+size_t residentBytes() {
+    long pages = 0, resident = 0;
+    FILE *pFile = std::fopen("/proc/self/statm", "r");
+    if (pFile == nullptr) return 0;
+    if (std::fscanf(pFile, "%ld %ld", &pages, &resident) != 2) resident = 0;
+    std::fclose(pFile);
+    return static_cast<size_t>(resident) * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+struct Random {
+    uint64_t llState;
+
+    explicit Random(uint64_t llSeed) : llState(llSeed) {}
+
+    uint64_t next() {
+        llState ^= llState << 13;
+        llState ^= llState >> 7;
+        llState ^= llState << 17;
+        return llState;
+    }
+};
+
+double percentile(std::vector<double> &Values, double dRatio) {
+    if (Values.empty()) return 0.0;
+    std::sort(Values.begin(), Values.end());
+    return Values[std::min(Values.size() - 1, static_cast<size_t>(Values.size() * dRatio))];
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    size_t players = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 10000000;
+    int seconds = argc > 2 ? std::atoi(argv[2]) : 5;
+    size_t rate = argc > 3 ? static_cast<size_t>(std::atol(argv[3])) : 50000;
+    std::cout.setstate(std::ios::failbit);
+
+    std::vector<std::string> PlayerIds(players);
+    for (size_t i = 0; i < players; i++) PlayerIds[i] = "player_" + std::to_string(i);
+    uint32_t dwNow = static_cast<uint32_t>(std::time(nullptr));
+
+    std::remove(kSnapshotPath);
+    Leaderboard::Config config;
+    config.path = kSnapshotPath;
+    config.snapshotInterval = std::chrono::seconds(3600);
+    std::unique_ptr<Leaderboard> pBoard(new Leaderboard(config));
+    Leaderboard &board = *pBoard;
+    if (!board.open()) {
+        std::printf("无法打开排行榜 %s\n", kSnapshotPath);
+        return 1;
+    }
+
+    //批量登记：每人一次
+    Random random(0x9E3779B97F4A7C15ULL);
+    size_t rssBefore = residentBytes();
+    Clock::time_point Begin = Clock::now();
+    for (size_t i = 0; i < players; i++) {
+        board.addScore(PlayerIds[i], static_cast<int64_t>(random.next() % 2001) - 1000, dwNow);
+        if (i % 65536 == 65535) board.flush();      // 不让缓冲区攒满全部更新
+    }
+    board.flush();
+    double dLoad = elapsed(Begin);
+    std::printf("[LeaderboardBench] %zu 位玩家，登记 %.0f 次/秒（%.2f 秒），内存 %.0f MB（不计基准自己的 id 列表）\n", players,
+                players / dLoad, dLoad, (residentBytes() - rssBefore) / 1048576.0);
+
+    //已有玩家的更新吞吐
+    const size_t kBurst = 2000000;
+    Begin = Clock::now();
+    for (size_t i = 0; i < kBurst; i++) {
+        board.addScore(PlayerIds[random.next() % players], static_cast<int64_t>(random.next() % 129) - 64, dwNow);
+        if (i % 65536 == 65535) board.flush();
+    }
+    board.flush();
+    double dBurst = elapsed(Begin);
+    std::printf("更新吞吐：%.0f 次/秒（%.2f us/次，含提交）\n", kBurst / dBurst, dBurst * 1e6 / kBurst);
+
+    //按速率提交，同时查询
+    std::atomic<bool> bStop(false);
+    std::vector<double> Submits;
+    std::thread producer([&] {
+        Random ProducerRandom(12345);
+        std::string playerIds[GAME_PLAYER];
+        int64_t lScores[GAME_PLAYER];
+        size_t hands = rate / GAME_PLAYER;
+        Clock::time_point Start = Clock::now();
+        for (size_t h = 0; !bStop.load(); h++) {
+            Clock::time_point Due = Start + std::chrono::microseconds(h * 1000000 / hands);
+            if (Clock::now() < Due) std::this_thread::sleep_until(Due);
+            int64_t lSum = 0;
+            for (int s = 0; s < GAME_PLAYER; s++) {
+                playerIds[s] = PlayerIds[ProducerRandom.next() % players];
+                lScores[s] = s < GAME_PLAYER - 1 ? static_cast<int64_t>(ProducerRandom.next() % 65) - 32 : -lSum;
+                lSum += lScores[s];
+            }
+            Clock::time_point SubmitStart = Clock::now();
+            board.submit(playerIds, lScores, dwNow);
+            if (h % 16 == 0) Submits.push_back(elapsed(SubmitStart));
+        }
+    });
+    std::vector<double> Ranks, Weekly, Tops;
+    uint64_t llAppliedBefore = board.getAppliedUpdates();
+    Begin = Clock::now();
+    while (elapsed(Begin) < seconds) {
+        const std::string &playerId = PlayerIds[random.next() % players];
+        LeaderboardEntry Entry;
+        Clock::time_point Start = Clock::now();
+        board.rank(LeaderboardWindow::Total, playerId, Entry);
+        Ranks.push_back(elapsed(Start));
+        Start = Clock::now();
+        board.rank(LeaderboardWindow::Weekly, playerId, Entry);
+        Weekly.push_back(elapsed(Start));
+        std::vector<LeaderboardEntry> Top;
+        Start = Clock::now();
+        board.top(LeaderboardWindow::Total, 100, Top);
+        Tops.push_back(elapsed(Start));
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    bStop = true;
+    producer.join();
+    double dPaced = elapsed(Begin);
+    uint64_t llApplied = board.getAppliedUpdates() - llAppliedBefore;
+    Begin = Clock::now();
+    board.flush();
+    double dLag = elapsed(Begin);
+    std::printf("按 %zu 次/秒提交 %.1f 秒：期间已应用 %.0f 次/秒，结束时积压 %.1f ms；提交一局 中位 %.2f us，p99 %.2f us\n", rate,
+                dPaced, llApplied / dPaced, dLag * 1e3, percentile(Submits, 0.5) * 1e6, percentile(Submits, 0.99) * 1e6);
+    std::printf("名次查询 %zu 次：总榜 中位 %.2f us，p99 %.2f us；周榜 中位 %.2f us，p99 %.2f us；前 100 名 中位 %.2f us，p99 %.2f us\n",
+                Ranks.size(), percentile(Ranks, 0.5) * 1e6, percentile(Ranks, 0.99) * 1e6, percentile(Weekly, 0.5) * 1e6,
+                percentile(Weekly, 0.99) * 1e6, percentile(Tops, 0.5) * 1e6, percentile(Tops, 0.99) * 1e6);
+
+    //快照
+    Begin = Clock::now();
+    bool bSnapshot = board.snapshot();
+    double dSnapshot = elapsed(Begin);
+    pBoard.reset();     // 先释放，重新打开时不占两份内存
+    struct stat st;
+    double dMB = stat(kSnapshotPath, &st) == 0 ? st.st_size / 1048576.0 : 0.0;
+    Begin = Clock::now();
+    Leaderboard reopened(config);
+    bool bLoaded = reopened.open();
+    double dReload = elapsed(Begin);
+    std::printf("快照：%s，%.1f MB，写入 %.2f 秒；读入并重建 %.2f 秒（总榜 %llu 人）\n", bSnapshot ? "成功" : "失败", dMB, dSnapshot,
+                dReload, bLoaded ? static_cast<unsigned long long>(reopened.size(LeaderboardWindow::Total)) : 0ULL);
+    reopened.close();
+    std::remove(kSnapshotPath);
+    return 0;
+}
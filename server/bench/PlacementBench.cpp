@@ -0,0 +1,187 @@
+//
+// PlacementBench.cpp
+// 绑核与 NUMA 放置基准：对比开启/关闭放置时每局开局的延迟分布和跨节点内存分配
+//
+// 用法：PlacementBench [工作线程数] [每线程房间数] [每房间局数]
+//
+// - off：房间由主线程统一创建（内存落在主线程所在节点），工作线程不绑核，由内核调度；
+// - on ：工作线程按节点轮流绑核，房间目录按节点划分，每个线程在本节点创建并驱动自己的房间；
+// - 每局执行一次 GameEngine 结束 + 下一局（洗牌、发牌、胡牌/杠牌分析），统计单局耗时；
+// - 跨节点流量用 /sys/devices/system/node/node*/numastat 中 other_node + numa_miss 的增量近似
+//   （按页计数，反映远端分配而非每次访存；需要精确访存流量时配合 perf 的 uncore 计数器）。
+//
+
+#include "NetPlayerPool.h"
+#include "NetPlayer.h"
+#include "game/GameEngine.h"
+#include "Room.h"
+#include "RoomDirectory.h"
+#include "ThreadPlacement.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+struct BenchConfig {
+    int workers;
+    int roomsPerWorker;
+    int handsPerRoom;
+};
+
+struct BenchResult {
+    double seconds;
+    uint64_t hands;
+    double p50Us;
+    double p99Us;
+    double maxUs;
+    uint64_t remotePages;
+};
+
+// 所有节点 numastat 中 other_node + numa_miss 的总和
+uint64_t remotePageCount() {
+    uint64_t total = 0;
+    for (int node = 0; node < ThreadPlacement::nodeCount(); node++) {
+        std::ifstream in(("/sys/devices/system/node/node" + std::to_string(node) + "/numastat").c_str());
+        std::string key;
+        uint64_t value = 0;
+        while (in >> key >> value) {
+            if (key == "other_node" || key == "numa_miss") {
+                total += value;
+            }
+        }
+    }
+    return total;
+}
+
+// 第 index 个工作线程的 CPU：按节点轮流，使各节点的线程数均衡
+int workerCpu(int index) {
+    int nodes = ThreadPlacement::nodeCount();
+    const std::vector<int>& cpus = ThreadPlacement::nodeCpus(index % nodes);
+    if (cpus.empty()) {
+        return -1;
+    }
+    return cpus[(index / nodes) % cpus.size()];
+}
+
+const char* kPlayerIds[Room::kMaxPlayers] = { "p0", "p1", "p2", "p3" };
+
+std::shared_ptr<Room> openTable(RoomDirectory& directory, NetPlayerPool& pool, const std::string& alias) {
+    std::shared_ptr<Room> room = directory.getOrCreate(alias);
+    for (int i = 0; i < Room::kMaxPlayers; i++) {
+        room->addPlayer(pool.acquire(kPlayerIds[i], -1, nullptr));
+    }
+    room->startGame();
+    return room;
+}
+
+// 驱动一组房间，记录每局耗时（微秒）
+void playHands(std::vector<std::shared_ptr<Room>>& rooms, int hands, std::vector<double>& latencies) {
+    for (int h = 0; h < hands; h++) {
+        for (size_t r = 0; r < rooms.size(); r++) {
+            Clock::time_point begin = Clock::now();
+            rooms[r]->getGameEngine()->onEventGameConclude(INVALID_CHAIR);
+            rooms[r]->restartGame();
+            latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - begin).count());
+        }
+    }
+}
+
+BenchResult runBench(const BenchConfig& config, bool placement) {
+    RoomDirectory::Config roomConfig;
+    roomConfig.slotsPerShard = 256;
+    roomConfig.preallocatedRooms = 0;
+    roomConfig.numaAware = placement;
+    RoomDirectory directory(roomConfig);
+
+    std::vector<std::vector<std::shared_ptr<Room>>> rooms(config.workers);
+    std::vector<std::unique_ptr<NetPlayerPool>> pools;
+    std::vector<std::vector<double>> latencies(config.workers);
+    for (int w = 0; w < config.workers; w++) {
+        pools.push_back(std::unique_ptr<NetPlayerPool>(new NetPlayerPool(config.roomsPerWorker * Room::kMaxPlayers)));
+        latencies[w].reserve(static_cast<size_t>(config.roomsPerWorker) * config.handsPerRoom);
+    }
+
+    // 关闭放置时房间全部由主线程创建
+    if (!placement) {
+        for (int w = 0; w < config.workers; w++) {
+            for (int r = 0; r < config.roomsPerWorker; r++) {
+                rooms[w].push_back(openTable(directory, *pools[w], "w" + std::to_string(w) + "_r" + std::to_string(r)));
+            }
+        }
+    }
+
+    uint64_t remoteBefore = remotePageCount();
+    Clock::time_point begin = Clock::now();
+    std::vector<std::thread> threads;
+    for (int w = 0; w < config.workers; w++) {
+        threads.push_back(std::thread([&, w]() {
+            if (placement) {
+                int cpu = workerCpu(w);
+                if (cpu >= 0) {
+                    ThreadPlacement::pinCurrentThread(std::vector<int>(1, cpu));
+                }
+                for (int r = 0; r < config.roomsPerWorker; r++) {
+                    rooms[w].push_back(openTable(directory, *pools[w], "w" + std::to_string(w) + "_r" + std::to_string(r)));
+                }
+            }
+            playHands(rooms[w], config.handsPerRoom, latencies[w]);
+        }));
+    }
+    for (size_t i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+
+    BenchResult result;
+    result.seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+    result.remotePages = remotePageCount() - remoteBefore;
+
+    std::vector<double> all;
+    for (int w = 0; w < config.workers; w++) {
+        all.insert(all.end(), latencies[w].begin(), latencies[w].end());
+    }
+    std::sort(all.begin(), all.end());
+    result.hands = all.size();
+    result.p50Us = all.empty() ? 0 : all[all.size() / 2];
+    result.p99Us = all.empty() ? 0 : all[std::min(all.size() - 1, all.size() * 99 / 100)];
+    result.maxUs = all.empty() ? 0 : all.back();
+    return result;
+}
+
+void printResult(const char* name, const BenchResult& result) {
+    std::printf("%-4s  %8llu 局  %7.2f s  %10.0f 局/s  p50 %7.2f us  p99 %7.2f us  max %8.2f us  远端页 %llu\n",
+                name, static_cast<unsigned long long>(result.hands), result.seconds,
+                result.seconds > 0 ? result.hands / result.seconds : 0.0,
+                result.p50Us, result.p99Us, result.maxUs,
+                static_cast<unsigned long long>(result.remotePages));
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+    config.workers = argc > 1 ? std::atoi(argv[1]) : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    config.roomsPerWorker = argc > 2 ? std::atoi(argv[2]) : 8;
+    config.handsPerRoom = argc > 3 ? std::atoi(argv[3]) : 2000;
+
+    // 关闭被测代码的日志
+    std::cout.setstate(std::ios::failbit);
+
+    std::printf("[PlacementBench] 节点数 %d，工作线程 %d，每线程房间 %d，每房间 %d 局\n",
+                ThreadPlacement::nodeCount(), config.workers, config.roomsPerWorker, config.handsPerRoom);
+    std::printf("[PlacementBench] 每个房间 %zu 字节，GameEngine %zu 字节嵌在房间对象内，规则（GameLogic）无状态不占房间内存\n",
+                sizeof(Room), sizeof(GameEngine));
+    printResult("off", runBench(config, false));
+    printResult("on", runBench(config, true));
+    return 0;
+}
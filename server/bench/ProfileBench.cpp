@@ -0,0 +1,170 @@
+//
+// ProfileBench.cpp
+// 玩家档案缓存基准：建档写盘、启动时扫描日志并预热、命中和未命中的取档案延迟、游戏路径与写盘并行
+//
+// 用法：ProfileBench [玩家数] [缓存份数] [秒数]
+//
+// - 默认 200 万位玩家、缓存 100 万份：先给每人建档案（昵称 + 积分），给出建档速度、写盘批次和日志大小；
+// - 关闭后重新打开，给出扫描日志建表、预热最近写入的 100 万份档案的耗时；
+// - 对预热的档案逐个 get()，给出命中延迟的中位数和 p99；
+// - 之后 4 个线程按指定秒数（默认 5）模拟入座和结算：随机玩家 get()，未命中时照常继续（后台线程随后读入），
+//   每 4 次取档案累加一次积分；给出命中率、命中和未命中各自的延迟，以及后台线程读入和写盘的档案数。
+//
+
+#include "ProfileCache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const char *kLogPath = "ProfileBench.log";
+const int kThreads = 4;
+
+double elapsed(Clock::time_point Begin) {
+    return std::chrono::duration<double>(Clock::now() - Begin).count();
+}
+
+struct Random {
+    uint64_t llState;
+
+    explicit Random(uint64_t llSeed) : llState(llSeed) {}
+
+    uint64_t next() {
+        llState ^= llState << 13;
+        llState ^= llState >> 7;
+        llState ^= llState << 17;
+        return llState;
+    }
+};
+
+double percentile(std::vector<double> &Values, double dRatio) {
+    if (Values.empty()) return 0.0;
+    std::sort(Values.begin(), Values.end());
+    return Values[std::min(Values.size() - 1, static_cast<size_t>(Values.size() * dRatio))];
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    size_t players = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 2000000;
+    size_t capacity = argc > 2 ? static_cast<size_t>(std::atol(argv[2])) : 1000000;
+    int seconds = argc > 3 ? std::atoi(argv[3]) : 5;
+    std::cout.setstate(std::ios::failbit);
+
+    std::vector<std::string> PlayerIds(players);
+    for (size_t i = 0; i < players; i++) PlayerIds[i] = "player_" + std::to_string(i);
+
+    std::remove(kLogPath);
+    ProfileCache::Config config;
+    config.path = kLogPath;
+    config.capacity = capacity;
+    std::unique_ptr<ProfileCache> pCache(new ProfileCache(config));
+    if (!pCache->open()) {
+        std::printf("无法打开档案日志 %s\n", kLogPath);
+        return 1;
+    }
+
+    //建档：每人一次昵称和积分
+    Random random(0x9E3779B97F4A7C15ULL);
+    Clock::time_point Begin = Clock::now();
+    for (size_t i = 0; i < players; i++) {
+        pCache->setNickname(PlayerIds[i], "nick_" + std::to_string(i));
+        pCache->addScore(PlayerIds[i], static_cast<int64_t>(random.next() % 2001) - 1000);
+        if (i % 65536 == 65535) pCache->flush();     // 未写盘的档案不淘汰，不让它们攒满内存
+    }
+    pCache->flush();
+    double dCreate = elapsed(Begin);
+    ProfileCache::Stats Stats = pCache->getStats();
+    std::printf("[ProfileBench] %zu 位玩家，缓存 %zu 份：建档 %.0f 位/秒（%.2f 秒），写盘 %llu 批，日志 %.1f MB\n", players,
+                capacity, players / dCreate, dCreate, static_cast<unsigned long long>(Stats.batches),
+                Stats.logBytes / 1048576.0);
+    pCache.reset();
+
+    //启动：扫描日志建表并预热
+    Begin = Clock::now();
+    pCache.reset(new ProfileCache(config));
+    bool bOpened = pCache->open();
+    double dOpen = elapsed(Begin);
+    Stats = pCache->getStats();
+    std::printf("重新打开：%s，扫描并预热 %.2f 秒（%llu 位玩家，缓存 %llu 份）\n", bOpened ? "成功" : "失败", dOpen,
+                static_cast<unsigned long long>(Stats.players), static_cast<unsigned long long>(Stats.cached));
+    ProfileCache &cache = *pCache;
+
+    //命中延迟：预热的是最近写入的档案
+    std::vector<double> Hits;
+    size_t hitCount = 0;
+    size_t warmFirst = players > capacity ? players - capacity : 0;
+    for (size_t i = 0; i < 200000; i++) {
+        const std::string &playerId = PlayerIds[warmFirst + random.next() % (players - warmFirst)];
+        PlayerProfile Profile;
+        if (playerId.empty()) continue;     // 先读一次 id，入座时 id 刚解析出来，在缓存里
+        Clock::time_point Start = Clock::now();
+        bool bHit = cache.get(playerId, Profile);
+        double dTime = elapsed(Start);
+        if (bHit) {
+            hitCount++;
+            Hits.push_back(dTime);
+        }
+    }
+    std::printf("预热档案的 get()：命中 %zu / 200000，中位 %.3f us，p99 %.3f us\n", hitCount, percentile(Hits, 0.5) * 1e6,
+                percentile(Hits, 0.99) * 1e6);
+
+    //游戏路径：多线程取档案、结算，同时后台读入和写盘
+    Stats = cache.getStats();
+    uint64_t llLoadsBefore = Stats.loads, llWrittenBefore = Stats.written;
+    std::atomic<bool> bStop(false);
+    std::vector<std::vector<double> > HitTimes(kThreads), MissTimes(kThreads);
+    std::vector<size_t> Calls(kThreads, 0);
+    std::vector<std::thread> Threads;
+    Begin = Clock::now();
+    for (int t = 0; t < kThreads; t++) {
+        Threads.push_back(std::thread([&, t] {
+            Random ThreadRandom(1000 + t);
+            PlayerProfile Profile;
+            for (size_t n = 0; !bStop.load(std::memory_order_relaxed); n++) {
+                const std::string &playerId = PlayerIds[ThreadRandom.next() % players];
+                if (playerId.empty()) continue;
+                Clock::time_point Start = Clock::now();
+                bool bHit = cache.get(playerId, Profile);
+                double dTime = elapsed(Start);
+                if (n % 8 == 0) (bHit ? HitTimes[t] : MissTimes[t]).push_back(dTime);
+                if (n % 4 == 0) cache.addScore(playerId, static_cast<int64_t>(ThreadRandom.next() % 65) - 32);
+                Calls[t]++;
+            }
+        }));
+    }
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    bStop = true;
+    for (size_t t = 0; t < Threads.size(); t++) Threads[t].join();
+    double dRun = elapsed(Begin);
+    cache.flush();
+    std::vector<double> AllHits, AllMisses;
+    size_t calls = 0;
+    for (int t = 0; t < kThreads; t++) {
+        AllHits.insert(AllHits.end(), HitTimes[t].begin(), HitTimes[t].end());
+        AllMisses.insert(AllMisses.end(), MissTimes[t].begin(), MissTimes[t].end());
+        calls += Calls[t];
+    }
+    Stats = cache.getStats();
+    std::printf("%d 线程 %.1f 秒：get() %.0f 次/秒，命中率 %.1f%%；命中 中位 %.3f us，p99 %.3f us；未命中 中位 %.3f us，p99 %.3f us\n",
+                kThreads, dRun, calls / dRun, 100.0 * AllHits.size() / std::max<size_t>(1, AllHits.size() + AllMisses.size()),
+                percentile(AllHits, 0.5) * 1e6, percentile(AllHits, 0.99) * 1e6, percentile(AllMisses, 0.5) * 1e6,
+                percentile(AllMisses, 0.99) * 1e6);
+    std::printf("后台线程：读入 %.0f 份/秒，写盘 %.0f 份/秒；日志 %.1f MB（有效 %.1f MB），重写 %llu 次\n",
+                (Stats.loads - llLoadsBefore) / dRun, (Stats.written - llWrittenBefore) / dRun, Stats.logBytes / 1048576.0,
+                Stats.liveBytes / 1048576.0, static_cast<unsigned long long>(Stats.compactions));
+    pCache.reset();
+    std::remove(kLogPath);
+    return 0;
+}
@@ -0,0 +1,120 @@
+//
+// RecordBench.cpp
+// 牌局记录基准：每条命令的记录开销、回放速度
+//
+// 用法：RecordBench [局数] [重复次数]
+//
+// - 先由四个机器人打出若干局并记录到文件，再把记录的命令按原顺序重新执行：
+//   一遍不记录，一遍记录（哈希事件 + 写进后台写入器），两遍的差值除以命令数就是每条命令的记录开销；
+// - 回放速度按每秒命令数和每秒局数给出，并按每局 5 分钟折算相对真实时间的倍数。
+//
+
+#include "BotPlayer.h"
+#include "GameRecord.h"
+#include "RecordWriter.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const char *kRecordFile = "RecordBench.rec";
+
+//机器人打 hands 局并记录，返回命令数
+size_t recordHands(size_t hands) {
+    RecordWriter writer(kRecordFile);
+    GameRecorder recorder;
+    recorder.bind(&writer, "bench");
+    GameEngine engine;
+    engine.setQuiet(true);
+    engine.setCommandListener(&recorder);
+    BotPlayer bots[GAME_PLAYER];
+    engine.setRoomSeed(2046);
+    for (int i = 0; i < GAME_PLAYER; i++) engine.onUserEnter(&bots[i]);
+    size_t commands = 0;
+    for (size_t h = 0; h < hands; h++) {
+        if (h > 0) engine.onGameRestart();
+        for (int n = 0; n < 1000 && !bots[0].isGameEnd(); n++) {
+            tagGameCommand Command;
+            bool bTaken = false;
+            for (int i = 0; i < GAME_PLAYER && !bTaken; i++) bTaken = bots[i].takeCommand(Command);
+            if (!bTaken) break;
+            GameEventBuffer Events;
+            engine.apply(Command, Events);
+            engine.dispatchEvents(Events);
+            commands++;
+        }
+    }
+    return commands;
+}
+
+//按记录重新执行全部命令，pRecorder 不为 NULL 时同时记录，返回秒数
+double applyAll(const std::vector<uint8_t> &Data, int iRepeat, GameRecorder *pRecorder) {
+    GameEngine engine;
+    engine.setQuiet(true);
+    engine.setCommandListener(pRecorder);
+    Clock::time_point Begin = Clock::now();
+    for (int r = 0; r < iRepeat; r++) {
+        size_t Offset = 0;
+        const tagRecordHeader *pHeader = NULL;
+        const tagRecordEntry *pEntries = NULL;
+        while (GameRecord::nextSegment(Data.data(), Data.size(), Offset, pHeader, pEntries)) {
+            GameRecord::prepare(engine, *pHeader);
+            GameEventBuffer Events;
+            engine.apply(GameRecord::makeStart(*pHeader), Events);
+            for (uint16_t n = 0; n < pHeader->wEntryCount; n++) {
+                Events.clear();
+                engine.apply(GameRecord::makeCommand(pEntries[n]), Events);
+            }
+        }
+    }
+    return std::chrono::duration<double>(Clock::now() - Begin).count();
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    size_t hands = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 2000;
+    int iRepeat = argc > 2 ? std::atoi(argv[2]) : 5;
+    std::cout.setstate(std::ios::failbit);
+
+    std::remove(kRecordFile);
+    size_t commands = recordHands(hands);
+    std::vector<uint8_t> Data;
+    FILE *pFile = std::fopen(kRecordFile, "rb");
+    if (pFile != NULL) {
+        uint8_t cbBuffer[64 * 1024];
+        size_t cbRead;
+        while ((cbRead = std::fread(cbBuffer, 1, sizeof(cbBuffer), pFile)) > 0) Data.insert(Data.end(), cbBuffer, cbBuffer + cbRead);
+        std::fclose(pFile);
+    }
+    std::remove(kRecordFile);
+
+    double dPlain = applyAll(Data, iRepeat, NULL);
+    double dRecorded;
+    uint64_t llWritten;
+    {
+        RecordWriter writer(kRecordFile);
+        GameRecorder recorder;
+        recorder.bind(&writer, "bench");
+        dRecorded = applyAll(Data, iRepeat, &recorder);
+        writer.flush();
+        llWritten = writer.getWrittenBytes();
+    }
+    std::remove(kRecordFile);
+
+    double dCommands = 1.0 * (commands + hands) * iRepeat;       //含每局的开始命令
+    std::printf("[RecordBench] %zu 局，%zu 条命令，记录 %zu 字节（每局 %.0f 字节），重复 %d 遍\n", hands, commands, Data.size(),
+                hands > 0 ? 1.0 * Data.size() / hands : 0.0, iRepeat);
+    std::printf("不记录：%.1f ns/命令；记录：%.1f ns/命令；记录开销 %.1f ns/命令（写出 %llu 字节）\n",
+                dPlain * 1e9 / dCommands, dRecorded * 1e9 / dCommands, (dRecorded - dPlain) * 1e9 / dCommands,
+                static_cast<unsigned long long>(llWritten));
+    std::printf("回放：%.0f 条命令/秒，%.0f 局/秒，按每局 5 分钟折算快 %.0f 倍\n", dCommands / dPlain,
+                hands * iRepeat / dPlain, hands * iRepeat * 300.0 / dPlain);
+    return 0;
+}
@@ -0,0 +1,160 @@
+//
+// RespondBench.cpp
+// 响应判定基准：每次出牌后其余三家碰、杠、胡判定（estimateUserRespond 的判定部分）的耗时
+//
+// 用法：RespondBench [出牌次数]
+//
+// - 逐座位：改动前的做法，每家依次 estimatePengCard、estimateGangCard（各自转换牌索引、取手牌列），再查等牌掩码；
+// - 批量  ：estimateRespond 一次取出三家手牌的这一列，同时算出碰、杠和胡牌候选座位。
+// 两种做法都只对等牌中有这张牌的座位做完整胡牌分析，等牌缓存的更新计入耗时。
+// 四家手牌从同一副牌墙轮流摸、随机打出（三分之一打出刚摸的牌），两种做法走相同的牌序。
+//
+
+#include "GameLogic.h"
+#include "TingCache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// 一轮：摸牌者、摸的牌、打出的牌
+struct Turn {
+    uint8_t cbChairID;
+    uint8_t cbDraw;
+    uint8_t cbOut;
+};
+
+struct Deal {
+    uint8_t cbCardIndex[GAME_PLAYER][MAX_INDEX];
+    std::vector<Turn> turns;
+};
+
+std::vector<Deal> makeDeals(std::mt19937 &rng, size_t turnCount) {
+    std::vector<Deal> deals;
+    size_t total = 0;
+    while (total < turnCount) {
+        std::vector<uint8_t> wall;
+        for (uint8_t i = 0; i < MAX_INDEX; i++) {
+            for (int k = 0; k < 4; k++) wall.push_back(i);
+        }
+        std::shuffle(wall.begin(), wall.end(), rng);
+        Deal deal;
+        memset(deal.cbCardIndex, 0, sizeof(deal.cbCardIndex));
+        size_t pos = 0;
+        for (uint8_t s = 0; s < GAME_PLAYER; s++) {
+            for (uint8_t k = 0; k < MAX_COUNT - 1; k++) deal.cbCardIndex[s][wall[pos++]]++;
+        }
+        uint8_t cbHand[GAME_PLAYER][MAX_INDEX];
+        memcpy(cbHand, deal.cbCardIndex, sizeof(cbHand));
+        for (uint8_t s = 0; pos < wall.size(); s = static_cast<uint8_t>((s + 1) % GAME_PLAYER)) {
+            Turn turn;
+            turn.cbChairID = s;
+            turn.cbDraw = wall[pos++];
+            cbHand[s][turn.cbDraw]++;
+            turn.cbOut = turn.cbDraw;
+            if (rng() % 3 != 0) {
+                do {
+                    turn.cbOut = static_cast<uint8_t>(rng() % MAX_INDEX);
+                } while (cbHand[s][turn.cbOut] == 0);
+            }
+            cbHand[s][turn.cbOut]--;
+            deal.turns.push_back(turn);
+        }
+        total += deal.turns.size();
+        deals.push_back(deal);
+    }
+    return deals;
+}
+
+uint8_t analyse(uint8_t cbCardIndex[MAX_INDEX], uint8_t cbCard) {
+    uint8_t huKind = 0, huSpecial = 0, cbFanShu = 0;
+    uint64_t huRight = 0;
+    tagWeaveItem WeaveItem[MAX_WEAVE];
+    return GameLogic::analyseHuCard(cbCardIndex, WeaveItem, 0, cbCard, huKind, huRight, huSpecial, 10, 10, false, false, false, cbFanShu, false);
+}
+
+// 统计：各动作出现的次数，两种做法应一致
+struct Result {
+    size_t discards;
+    size_t actions[3];
+};
+
+template <bool bBatch>
+double run(const std::vector<Deal> &deals, Result &result, TingCache &cache) {
+    memset(&result, 0, sizeof(result));
+    bool bPassPeng[GAME_PLAYER][MAX_INDEX];
+    Clock::time_point begin = Clock::now();
+    for (size_t d = 0; d < deals.size(); d++) {
+        uint8_t cbHand[GAME_PLAYER][MAX_INDEX];
+        memcpy(cbHand, deals[d].cbCardIndex, sizeof(cbHand));
+        memset(bPassPeng, 0, sizeof(bPassPeng));
+        cache.reset();
+        for (size_t t = 0; t < deals[d].turns.size(); t++) {
+            const Turn &turn = deals[d].turns[t];
+            cbHand[turn.cbChairID][turn.cbDraw]++;
+            cbHand[turn.cbChairID][turn.cbOut]--;
+            uint8_t cbOutCard = GameLogic::switchToCardData(turn.cbOut);
+            uint8_t cbUserAction[GAME_PLAYER];
+            memset(cbUserAction, 0, sizeof(cbUserAction));
+            if (bBatch) {
+                uint64_t llHuMask[GAME_PLAYER] = {0};
+                for (uint8_t s = 0; s < GAME_PLAYER; s++) {
+                    if (s == turn.cbChairID) continue;
+                    llHuMask[s] = cache.update(s, cbHand[s], nullptr, 0);
+                }
+                uint8_t cbHuUser = GameLogic::estimateRespond(cbHand, bPassPeng, llHuMask, GAME_PLAYER, turn.cbChairID, cbOutCard, true, true, cbUserAction);
+                for (uint8_t s = 0; s < GAME_PLAYER; s++) {
+                    if ((cbUserAction[s] & WIK_P) != 0) bPassPeng[s][turn.cbOut] = true;
+                    if ((cbHuUser >> s) & 1) cbUserAction[s] |= analyse(cbHand[s], cbOutCard);
+                }
+            } else {
+                for (uint8_t s = 0; s < GAME_PLAYER; s++) {
+                    if (s == turn.cbChairID) continue;
+                    if (!bPassPeng[s][GameLogic::switchToCardIndex(cbOutCard)]) {
+                        cbUserAction[s] |= GameLogic::estimatePengCard(cbHand[s], cbOutCard);
+                        if ((cbUserAction[s] & WIK_P) != 0) bPassPeng[s][GameLogic::switchToCardIndex(cbOutCard)] = true;
+                    }
+                    cbUserAction[s] |= GameLogic::estimateGangCard(cbHand[s], cbOutCard);
+                    uint64_t llHuMask = cache.update(s, cbHand[s], nullptr, 0);
+                    if ((llHuMask >> GameLogic::switchToCardIndex(cbOutCard)) & 1) {
+                        cbUserAction[s] |= analyse(cbHand[s], cbOutCard);
+                    }
+                }
+            }
+            for (uint8_t s = 0; s < GAME_PLAYER; s++) {
+                result.actions[0] += (cbUserAction[s] & WIK_P) != 0;
+                result.actions[1] += (cbUserAction[s] & WIK_G) != 0;
+                result.actions[2] += (cbUserAction[s] & WIK_H) != 0;
+            }
+            result.discards++;
+        }
+    }
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    size_t turnCount = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 500000;
+    std::mt19937 rng(42);
+    std::vector<Deal> deals = makeDeals(rng, turnCount);
+
+    TingCache cache;
+    Result seat, batch;
+    run<true>(deals, batch, cache);     //预热（生成胡牌表）
+    double seatTime = run<false>(deals, seat, cache);
+    double batchTime = run<true>(deals, batch, cache);
+    std::printf("逐座位 %7.1f ns/次出牌 | 批量 %7.1f ns/次出牌 (%4.2fx) | %zu 次出牌，碰 %zu 杠 %zu 胡 %zu\n",
+                seatTime * 1e9 / seat.discards, batchTime * 1e9 / batch.discards, seatTime / batchTime,
+                batch.discards, batch.actions[0], batch.actions[1], batch.actions[2]);
+    bool bSame = memcmp(&seat, &batch, sizeof(Result)) == 0;
+    return bSame ? 0 : 1;
+}
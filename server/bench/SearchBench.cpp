@@ -0,0 +1,86 @@
+//
+// SearchBench.cpp
+// 蒙特卡洛搜索基准：每秒推演次数，专家机器人对高级机器人的胜率
+//
+// 用法：SearchBench [局数] [每次决策的毫秒数] [线程数]
+//
+// - 两张牌桌用相同的房间种子，每局发到的牌相同：一张桌 0 号座位是专家（搜索），
+//   另一张桌四个座位都是高级机器人，对比 0 号座位的胡牌率和平均积分；
+// - 专家只在有多个候选时推演，输出推演过的决策数、每次决策的平均推演次数和每秒推演次数。
+//
+
+#include "BotPlayer.h"
+#include "MonteCarloSearch.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+
+struct SeatResult {
+    size_t hands, hu;
+    int64_t score;
+};
+
+//打完一局，统计 0 号座位
+void playHand(GameEngine &engine, BotPlayer bots[GAME_PLAYER], SeatResult &Result) {
+    for (int n = 0; n < 1000; n++) {
+        tagGameCommand Command;
+        bool bTaken = false;
+        for (int i = 0; i < GAME_PLAYER && !bTaken; i++) bTaken = bots[i].takeCommand(Command);
+        if (!bTaken) break;
+        GameEventBuffer Events;
+        engine.apply(Command, Events);
+        engine.dispatchEvents(Events);
+        for (uint8_t e = 0; e < Events.size(); e++) {
+            if (Events[e].cbKind != GameEvent_GameEnd) continue;
+            Result.hands++;
+            if ((Events[e].GameEnd.cbHuUser & 1) != 0) Result.hu++;
+            Result.score += Events[e].GameEnd.lGameScore[0];
+            return;
+        }
+    }
+}
+
+void playTable(size_t hands, MonteCarloSearch *pSearch, SeatResult &Result) {
+    GameEngine engine;
+    engine.setQuiet(true);
+    BotPlayer bots[GAME_PLAYER];
+    if (pSearch != NULL) {
+        bots[0].setLevel(BotLevel_Expert);
+        bots[0].setSearch(pSearch, &engine.getGameState());
+    }
+    engine.setRoomSeed(2024);
+    for (int i = 0; i < GAME_PLAYER; i++) engine.onUserEnter(&bots[i]);
+    for (size_t h = 0; h < hands; h++) {
+        if (h > 0) engine.onGameRestart();
+        playHand(engine, bots, Result);
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    size_t hands = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 40;
+    tagSearchConfig Config;
+    Config.dwBudgetMs = argc > 2 ? static_cast<uint32_t>(std::atoi(argv[2])) : 50;
+    Config.dwThreads = argc > 3 ? static_cast<uint32_t>(std::atoi(argv[3])) : 0;
+    std::cout.setstate(std::ios::failbit);
+
+    MonteCarloSearch search(Config);
+    SeatResult Expert = {0, 0, 0}, Baseline = {0, 0, 0};
+    playTable(hands, &search, Expert);
+    playTable(hands, NULL, Baseline);
+
+    std::printf("[SearchBench] %zu 局，每次决策 %u 毫秒，%u 线程\n", hands, Config.dwBudgetMs, search.getConfig().dwThreads);
+    std::printf("推演：%llu 次决策，平均每次 %.0f 次推演，%.0f 次推演/秒\n",
+                static_cast<unsigned long long>(search.getDecisionCount()),
+                search.getDecisionCount() > 0 ? 1.0 * search.getRolloutCount() / search.getDecisionCount() : 0.0,
+                search.getSearchSeconds() > 0 ? search.getRolloutCount() / search.getSearchSeconds() : 0.0);
+    std::printf("0 号座位 专家：胡牌 %zu/%zu 局（%.1f%%），平均积分 %+.2f\n", Expert.hu, Expert.hands,
+                Expert.hands > 0 ? 100.0 * Expert.hu / Expert.hands : 0.0, Expert.hands > 0 ? 1.0 * Expert.score / Expert.hands : 0.0);
+    std::printf("0 号座位 高级：胡牌 %zu/%zu 局（%.1f%%），平均积分 %+.2f\n", Baseline.hu, Baseline.hands,
+                Baseline.hands > 0 ? 100.0 * Baseline.hu / Baseline.hands : 0.0, Baseline.hands > 0 ? 1.0 * Baseline.score / Baseline.hands : 0.0);
+    return 0;
+}
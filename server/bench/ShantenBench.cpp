@@ -0,0 +1,88 @@
+//
+// ShantenBench.cpp
+// 向听数基准：analyseShanten 每秒可计算的手数，analyseDiscard（出牌建议）每次的耗时
+//
+// 用法：ShantenBench [手数]
+//
+// - shanten：从洗好的牌墙取 13 张，逐手调用 analyseShanten（查 4 次表 + 合成 + 七对）；
+// - discard：14 张手牌的出牌建议，每种可打的牌 × 34 种摸进各算一次向听数，
+//            按"打出后 1 次 + 摸进 34 次"折算成每秒的向听数计算次数。
+//
+
+#include "GameLogic.h"
+#include "ShantenTable.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+struct Hand {
+    uint8_t cbCardIndex[MAX_INDEX];
+};
+
+std::vector<Hand> randomHands(std::mt19937 &rng, size_t count, uint8_t cbSize) {
+    std::vector<uint8_t> wall;
+    for (uint8_t i = 0; i < MAX_INDEX; i++) {
+        for (int k = 0; k < 4; k++) wall.push_back(i);
+    }
+    std::vector<Hand> hands(count);
+    for (size_t n = 0; n < count; n++) {
+        std::shuffle(wall.begin(), wall.end(), rng);
+        memset(hands[n].cbCardIndex, 0, MAX_INDEX);
+        for (uint8_t k = 0; k < cbSize; k++) hands[n].cbCardIndex[wall[k]]++;
+    }
+    return hands;
+}
+
+double seconds(Clock::time_point begin) {
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 200000;
+    std::mt19937 rng(42);
+
+    Clock::time_point begin = Clock::now();
+    ShantenTable::instance();
+    std::printf("生成表 %.2f 秒\n", seconds(begin));
+
+    std::vector<Hand> hands = randomHands(rng, count, MAX_COUNT - 1);
+    long histogram[8] = {0};
+    begin = Clock::now();
+    for (size_t n = 0; n < hands.size(); n++) {
+        int8_t cbShanten = GameLogic::analyseShanten(hands[n].cbCardIndex, 0);
+        histogram[std::min(cbShanten + 1, 7)]++;
+    }
+    double elapsed = seconds(begin);
+    std::printf("shanten %8zu 手 %.3f 秒，%.2f M 手/秒，%.1f ns/手 | 向听数 0:%ld 1:%ld 2:%ld 3:%ld 4+:%ld\n",
+                hands.size(), elapsed, hands.size() / elapsed / 1e6, elapsed * 1e9 / hands.size(),
+                histogram[1], histogram[2], histogram[3], histogram[4], histogram[5] + histogram[6] + histogram[7]);
+
+    std::vector<Hand> discardHands = randomHands(rng, count / 10, MAX_COUNT);
+    uint8_t cbVisibleIndex[MAX_INDEX];
+    memset(cbVisibleIndex, 0, sizeof(cbVisibleIndex));
+    size_t evaluations = 0;
+    long usefulTotal = 0;
+    begin = Clock::now();
+    for (size_t n = 0; n < discardHands.size(); n++) {
+        tagDiscardResult DiscardResult[MAX_INDEX];
+        uint8_t cbResultCount = GameLogic::analyseDiscard(discardHands[n].cbCardIndex, 0, cbVisibleIndex, DiscardResult);
+        evaluations += cbResultCount * (1 + MAX_INDEX);
+        usefulTotal += DiscardResult[0].cbUsefulCount;
+    }
+    elapsed = seconds(begin);
+    std::printf("discard %8zu 手 %.3f 秒，%.2f us/手，%.2f M 次向听数/秒 | 最佳出牌平均有效牌 %.1f 张\n",
+                discardHands.size(), elapsed, elapsed * 1e6 / discardHands.size(), evaluations / elapsed / 1e6,
+                static_cast<double>(usefulTotal) / discardHands.size());
+    return 0;
+}
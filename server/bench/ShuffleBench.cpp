@@ -0,0 +1,88 @@
+//
+// ShuffleBench.cpp
+// 洗牌基准：每秒可洗的整副牌（136 张）数
+//
+// 用法：ShuffleBench [次数]
+//
+// - srand/rand：改动前的做法，每次洗牌 srand(time(NULL))，从剩余的牌里用 rand() % n 抽取（共享全局状态，有取模偏差）；
+// - GameRandom：房间自己的 xoshiro256**，Fisher–Yates 原地交换，无偏的区间随机数；
+// - 另外测量每局取本局种子 + 重新设置种子的开销（GameEngine::onGameStart 的做法）。
+//
+
+#include "GameLogic.h"
+#include "GameRandom.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const uint8_t kCardDataArray[MAX_REPERTORY] = {
+        0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09,
+        0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09,
+        0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19,
+        0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19,
+        0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29,
+        0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29,
+        0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37,
+        0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37,
+};
+
+// 改动前的洗牌
+void shuffleRand(uint8_t *cbCardData, uint8_t cbMaxCount) {
+    srand(static_cast<unsigned int>(time(NULL)));
+    uint8_t cbCardDataTemp[MAX_REPERTORY];
+    memcpy(cbCardDataTemp, kCardDataArray, sizeof(kCardDataArray));
+    uint8_t cbRandCount = 0, cbPosition = 0;
+    do {
+        cbPosition = static_cast<uint8_t>(rand() % (cbMaxCount - cbRandCount));
+        cbCardData[cbRandCount++] = cbCardDataTemp[cbPosition];
+        cbCardDataTemp[cbPosition] = cbCardDataTemp[cbMaxCount - cbRandCount];
+    } while (cbRandCount < cbMaxCount);
+}
+
+double seconds(Clock::time_point begin) {
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 2000000;
+    uint8_t cbCardData[MAX_REPERTORY];
+    unsigned long checksum = 0;
+
+    Clock::time_point begin = Clock::now();
+    for (size_t n = 0; n < count; n++) {
+        shuffleRand(cbCardData, MAX_REPERTORY);
+        checksum += cbCardData[n % MAX_REPERTORY];
+    }
+    double old = seconds(begin);
+
+    GameRandom random(GameRandom::makeSeed());
+    begin = Clock::now();
+    for (size_t n = 0; n < count; n++) {
+        GameLogic::shuffle(cbCardData, MAX_REPERTORY, random);
+        checksum += cbCardData[n % MAX_REPERTORY];
+    }
+    double fresh = seconds(begin);
+
+    GameRandom room(GameRandom::makeSeed()), game;
+    begin = Clock::now();
+    for (size_t n = 0; n < count; n++) {
+        game.seed(room.next());
+        GameLogic::shuffle(cbCardData, MAX_REPERTORY, game);
+        checksum += game.nextBounded(6) + game.nextBounded(6);
+    }
+    double seeded = seconds(begin);
+
+    std::printf("srand/rand %6.1f ns/副 (%5.2f M 副/秒) | GameRandom %6.1f ns/副 (%5.2f M 副/秒, %4.2fx) | 每局重设种子 + 骰子 %6.1f ns/局 | 校验 %lu\n",
+                old * 1e9 / count, count / old / 1e6, fresh * 1e9 / count, count / fresh / 1e6, old / fresh,
+                seeded * 1e9 / count, checksum);
+    return 0;
+}
@@ -0,0 +1,155 @@
+//
+// TingBench.cpp
+// 等牌缓存基准：每一轮（一人摸牌、出牌，其余三家判定能否胡这张牌）的判定耗时
+//
+// 用法：TingBench [轮数]
+//
+// - analyseHuCard：改动前 GameEngine 的做法，摸牌者自摸判定 1 次 + 三家各 1 次完整分析（每次含卡张判定的 34 次胡牌检查）；
+// - TingCache    ：出牌后增量更新出牌者的等牌，摸牌判定和三家判定只检查掩码，命中时才做完整分析。
+// 四家手牌从同一副牌墙轮流摸、随机打出（三分之一打出刚摸的牌），两种做法走相同的牌序。
+//
+
+#include "GameLogic.h"
+#include "TingCache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// 一轮：摸牌者、摸的牌、打出的牌
+struct Turn {
+    uint8_t cbChairID;
+    uint8_t cbDraw;
+    uint8_t cbOut;
+};
+
+struct Deal {
+    uint8_t cbCardIndex[GAME_PLAYER][MAX_INDEX];
+    std::vector<Turn> turns;
+};
+
+std::vector<Deal> makeDeals(std::mt19937 &rng, size_t turnCount) {
+    std::vector<Deal> deals;
+    size_t total = 0;
+    while (total < turnCount) {
+        std::vector<uint8_t> wall;
+        for (uint8_t i = 0; i < MAX_INDEX; i++) {
+            for (int k = 0; k < 4; k++) wall.push_back(i);
+        }
+        std::shuffle(wall.begin(), wall.end(), rng);
+        Deal deal;
+        memset(deal.cbCardIndex, 0, sizeof(deal.cbCardIndex));
+        size_t pos = 0;
+        for (uint8_t s = 0; s < GAME_PLAYER; s++) {
+            for (uint8_t k = 0; k < MAX_COUNT - 1; k++) deal.cbCardIndex[s][wall[pos++]]++;
+        }
+        uint8_t cbHand[GAME_PLAYER][MAX_INDEX];
+        memcpy(cbHand, deal.cbCardIndex, sizeof(cbHand));
+        for (uint8_t s = 0; pos < wall.size(); s = static_cast<uint8_t>((s + 1) % GAME_PLAYER)) {
+            Turn turn;
+            turn.cbChairID = s;
+            turn.cbDraw = wall[pos++];
+            cbHand[s][turn.cbDraw]++;
+            turn.cbOut = turn.cbDraw;
+            if (rng() % 3 != 0) {
+                do {
+                    turn.cbOut = static_cast<uint8_t>(rng() % MAX_INDEX);
+                } while (cbHand[s][turn.cbOut] == 0);
+            }
+            cbHand[s][turn.cbOut]--;
+            deal.turns.push_back(turn);
+        }
+        total += deal.turns.size();
+        deals.push_back(deal);
+    }
+    return deals;
+}
+
+uint8_t analyse(const uint8_t cbCardIndex[MAX_INDEX], uint8_t cbCard, bool bZimo) {
+    uint8_t huKind = 0, huSpecial = 0, cbFanShu = 0;
+    uint64_t huRight = 0;
+    tagWeaveItem WeaveItem[MAX_WEAVE];
+    return GameLogic::analyseHuCard(cbCardIndex, WeaveItem, 0, cbCard, huKind, huRight, huSpecial, 10, 10, false, bZimo, false, cbFanShu, false);
+}
+
+// 改动前：每轮 4 次完整分析
+double runFull(const std::vector<Deal> &deals, size_t &turns, size_t &huCount) {
+    turns = 0;
+    huCount = 0;
+    Clock::time_point begin = Clock::now();
+    for (size_t d = 0; d < deals.size(); d++) {
+        uint8_t cbHand[GAME_PLAYER][MAX_INDEX];
+        memcpy(cbHand, deals[d].cbCardIndex, sizeof(cbHand));
+        for (size_t t = 0; t < deals[d].turns.size(); t++) {
+            const Turn &turn = deals[d].turns[t];
+            huCount += analyse(cbHand[turn.cbChairID], GameLogic::switchToCardData(turn.cbDraw), true) == WIK_H;
+            cbHand[turn.cbChairID][turn.cbDraw]++;
+            cbHand[turn.cbChairID][turn.cbOut]--;
+            uint8_t cbOutCard = GameLogic::switchToCardData(turn.cbOut);
+            for (uint8_t s = 0; s < GAME_PLAYER; s++) {
+                if (s == turn.cbChairID) continue;
+                huCount += analyse(cbHand[s], cbOutCard, false) == WIK_H;
+            }
+            turns++;
+        }
+    }
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+// 等牌缓存：出牌后更新一家，判定只查掩码
+double runCached(const std::vector<Deal> &deals, size_t &turns, size_t &huCount, TingCache &cache) {
+    turns = 0;
+    huCount = 0;
+    Clock::time_point begin = Clock::now();
+    for (size_t d = 0; d < deals.size(); d++) {
+        uint8_t cbHand[GAME_PLAYER][MAX_INDEX];
+        memcpy(cbHand, deals[d].cbCardIndex, sizeof(cbHand));
+        cache.reset();
+        for (uint8_t s = 0; s < GAME_PLAYER; s++) cache.update(s, cbHand[s], nullptr, 0);
+        for (size_t t = 0; t < deals[d].turns.size(); t++) {
+            const Turn &turn = deals[d].turns[t];
+            if (cache.canHu(turn.cbChairID, turn.cbDraw)) {
+                huCount += analyse(cbHand[turn.cbChairID], GameLogic::switchToCardData(turn.cbDraw), true) == WIK_H;
+            }
+            cbHand[turn.cbChairID][turn.cbDraw]++;
+            cbHand[turn.cbChairID][turn.cbOut]--;
+            cache.update(turn.cbChairID, cbHand[turn.cbChairID], nullptr, 0);
+            uint8_t cbOutCard = GameLogic::switchToCardData(turn.cbOut);
+            for (uint8_t s = 0; s < GAME_PLAYER; s++) {
+                if (s == turn.cbChairID) continue;
+                if (cache.update(s, cbHand[s], nullptr, 0) & (1ULL << turn.cbOut)) {
+                    huCount += analyse(cbHand[s], cbOutCard, false) == WIK_H;
+                }
+            }
+            turns++;
+        }
+    }
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    size_t turnCount = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 200000;
+    std::mt19937 rng(42);
+    std::vector<Deal> deals = makeDeals(rng, turnCount);
+
+    size_t fullTurns = 0, fullHu = 0, cachedTurns = 0, cachedHu = 0;
+    TingCache cache;
+    runCached(deals, cachedTurns, cachedHu, cache);     //预热（生成胡牌表）
+    double full = runFull(deals, fullTurns, fullHu);
+    double cached = runCached(deals, cachedTurns, cachedHu, cache);
+    std::printf("analyseHuCard %8.2f us/轮 | TingCache %8.2f us/轮 (%5.1fx) | %zu 轮，可胡 %zu/%zu 次\n",
+                full * 1e6 / fullTurns, cached * 1e6 / cachedTurns, full / cached, fullTurns, fullHu, cachedHu);
+    std::printf("TingCache 更新：未变 %llu 次，增量 %llu 次，全量 %llu 次\n",
+                (unsigned long long) cache.getHitCount(), (unsigned long long) cache.getPartialCount(), (unsigned long long) cache.getFullCount());
+    return fullHu == cachedHu ? 0 : 1;
+}
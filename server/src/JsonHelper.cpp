@@ -133,6 +133,34 @@ namespace JsonHelper {
         return result;
     }
     
+    std::string escape(const std::string& value) {
+        static const char kHex[] = "0123456789abcdef";
+        std::string result;
+        result.reserve(value.size() + 2);
+        for (char ch : value) {
+            unsigned char c = static_cast<unsigned char>(ch);
+            switch (c) {
+                case '"':  result += "\\\""; break;
+                case '\\': result += "\\\\"; break;
+                case '\n': result += "\\n"; break;
+                case '\r': result += "\\r"; break;
+                case '\t': result += "\\t"; break;
+                case '\b': result += "\\b"; break;
+                case '\f': result += "\\f"; break;
+                default:
+                    if (c < 0x20) {
+                        result += "\\u00";
+                        result += kHex[c >> 4];
+                        result += kHex[c & 0xF];
+                    } else {
+                        result += ch;
+                    }
+                    break;
+            }
+        }
+        return result;
+    }
+    
     std::string buildJson(const std::map<std::string, std::string>& stringFields,
                          const std::map<std::string, int>& intFields) {
         std::ostringstream oss;
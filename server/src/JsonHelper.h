@@ -37,6 +37,9 @@ namespace JsonHelper {
     std::vector<int> getIntArray(const std::string& json, const std::string& key);
     std::vector<std::string> getStringArray(const std::string& json, const std::string& key);
     
+    // 转义字符串值：双引号、反斜杠和控制字符（< 0x20）按 JSON 转义，其余字节（含 UTF-8）原样输出
+    std::string escape(const std::string& value);
+    
     // 构建 JSON 对象（rapidjson 支持）
     std::string buildJson(const std::map<std::string, std::string>& stringFields,
                          const std::map<std::string, int>& intFields);
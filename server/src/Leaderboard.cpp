@@ -0,0 +1,789 @@
+//
+// Leaderboard.cpp
+// 排行榜实现
+//
+// RankTree：计数 B+ 树。叶子存最多 64 个键（积分、玩家编号分两列），按顺序双向链接；内部节点存最多 64 棵子树，
+// 第 i 棵子树的最小键（i = 0 的不用）和键数。插入时自顶向下，经过已满的节点先对半分裂；删除只在节点变空时
+// 从父节点摘下，根只剩一棵子树时降一层。节点放在两个数组里，下标互指，回收的下标放进空闲表。
+//
+// 快照文件格式（本机字节序）：
+//   魔数、版本、榜数、玩家数 n；之后 n 条玩家 id（2 字节长度 + id），第 i 条的编号为 i（从 1 开始）；
+//   之后每个榜依次为：周期、榜上人数 m，以及按名次排列的 m 条（4 字节玩家编号 + 8 字节积分）。
+//
+
+#include "Leaderboard.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+
+#include <unistd.h>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const uint32_t kLeaderboardMagic = 0x424C4D4DU;      // "MMLB"
+const uint16_t kLeaderboardVersion = 1;
+const size_t kFileBuffer = 1024 * 1024;
+const std::chrono::seconds kRollCheck(1);           // 没有更新时检查换榜的间隔
+const size_t kApplyChunk = 16;                      // 每次持锁应用的更新数
+
+const uint32_t kNodeKeys = 64;                      // 每个节点的键数上限
+const uint32_t kBuildKeys = 48;                     // 重建时每个节点填入的键数（留出插入的空间）
+const uint32_t kNoLeaf = UINT32_MAX;
+const int kMaxHeight = 16;
+
+// 键 (score, player) 排在 (otherScore, otherPlayer) 之前：积分高的在前，积分相同时编号小的在前
+inline bool keyBefore(int64_t score, uint32_t player, int64_t otherScore, uint32_t otherPlayer) {
+    return score > otherScore || (score == otherScore && player < otherPlayer);
+}
+
+template <typename T>
+bool readValue(FILE* file, T& value) {
+    return std::fread(&value, sizeof(value), 1, file) == 1;
+}
+
+template <typename T>
+void writeValue(FILE* file, const T& value) {
+    std::fwrite(&value, sizeof(value), 1, file);
+}
+
+} // namespace
+
+class RankTree {
+public:
+    uint32_t period;        // 当前周期
+
+    RankTree() : period(0) { clear(); }
+
+    void clear() {
+        leaves_.clear();
+        inners_.clear();
+        freeLeaves_.clear();
+        freeInners_.clear();
+        root_ = allocLeaf();
+        height_ = 0;
+        size_ = 0;
+    }
+
+    uint64_t size() const { return size_; }
+
+    void insert(int64_t score, uint32_t player) {
+        if (isFull(root_, height_)) {
+            uint32_t root = allocInner();
+            Inner& inner = inners_[root];
+            inner.children[0] = root_;
+            inner.sizes[0] = static_cast<uint32_t>(size_);
+            inner.count = 1;
+            root_ = root;
+            height_++;
+            splitChild(root_, 0, height_ - 1);
+        }
+        uint32_t node = root_;
+        for (int level = height_; level > 0; level--) {
+            uint32_t slot = childSlot(inners_[node], score, player);
+            if (isFull(inners_[node].children[slot], level - 1)) {
+                splitChild(node, slot, level - 1);
+                const Inner& split = inners_[node];
+                if (!keyBefore(score, player, split.scores[slot + 1], split.players[slot + 1])) {
+                    slot++;
+                }
+            }
+            Inner& inner = inners_[node];
+            inner.sizes[slot]++;
+            node = inner.children[slot];
+        }
+        Leaf& leaf = leaves_[node];
+        uint32_t pos = lowerBound(leaf, score, player);
+        std::memmove(leaf.scores + pos + 1, leaf.scores + pos, (leaf.count - pos) * sizeof(leaf.scores[0]));
+        std::memmove(leaf.players + pos + 1, leaf.players + pos, (leaf.count - pos) * sizeof(leaf.players[0]));
+        leaf.scores[pos] = score;
+        leaf.players[pos] = player;
+        leaf.count++;
+        size_++;
+    }
+
+    // 键须在树中
+    void erase(int64_t score, uint32_t player) {
+        uint32_t path[kMaxHeight + 1];
+        uint32_t slots[kMaxHeight + 1];
+        uint32_t node = root_;
+        for (int level = height_; level > 0; level--) {
+            Inner& inner = inners_[node];
+            uint32_t slot = childSlot(inner, score, player);
+            inner.sizes[slot]--;
+            path[level] = node;
+            slots[level] = slot;
+            node = inner.children[slot];
+        }
+        Leaf& leaf = leaves_[node];
+        uint32_t pos = lowerBound(leaf, score, player);
+        leaf.count--;
+        std::memmove(leaf.scores + pos, leaf.scores + pos + 1, (leaf.count - pos) * sizeof(leaf.scores[0]));
+        std::memmove(leaf.players + pos, leaf.players + pos + 1, (leaf.count - pos) * sizeof(leaf.players[0]));
+        size_--;
+        if (leaf.count > 0 || height_ == 0) {
+            return;
+        }
+
+        //叶子变空：从链表和父节点摘下，父节点也变空时继续往上
+        if (leaf.prev != kNoLeaf) leaves_[leaf.prev].next = leaf.next;
+        if (leaf.next != kNoLeaf) leaves_[leaf.next].prev = leaf.prev;
+        freeLeaves_.push_back(node);
+        for (int level = 1; level <= height_; level++) {
+            Inner& inner = inners_[path[level]];
+            removeSlot(inner, slots[level]);
+            if (inner.count > 0) {
+                break;
+            }
+            freeInners_.push_back(path[level]);
+        }
+        while (height_ > 0 && inners_[root_].count == 1) {
+            freeInners_.push_back(root_);
+            root_ = inners_[root_].children[0];
+            height_--;
+        }
+    }
+
+    // 键的名次（从 1 开始），键须在树中
+    uint64_t rank(int64_t score, uint32_t player) const {
+        uint64_t ahead = 0;
+        uint32_t node = root_;
+        for (int level = height_; level > 0; level--) {
+            const Inner& inner = inners_[node];
+            uint32_t slot = childSlot(inner, score, player);
+            for (uint32_t i = 0; i < slot; i++) {
+                ahead += inner.sizes[i];
+            }
+            node = inner.children[slot];
+        }
+        return ahead + lowerBound(leaves_[node], score, player) + 1;
+    }
+
+    // 从第 first 名（从 0 开始）起按名次依次调用 visit(player, score)，visit 返回 false 时停止
+    template <typename Visit>
+    void visitFrom(uint64_t first, Visit visit) const {
+        if (first >= size_) {
+            return;
+        }
+        uint32_t node = root_;
+        for (int level = height_; level > 0; level--) {
+            const Inner& inner = inners_[node];
+            uint32_t slot = 0;
+            while (first >= inner.sizes[slot]) {
+                first -= inner.sizes[slot];
+                slot++;
+            }
+            node = inner.children[slot];
+        }
+        for (uint32_t pos = static_cast<uint32_t>(first); node != kNoLeaf; node = leaves_[node].next, pos = 0) {
+            const Leaf& leaf = leaves_[node];
+            for (; pos < leaf.count; pos++) {
+                if (!visit(leaf.players[pos], leaf.scores[pos])) {
+                    return;
+                }
+            }
+        }
+    }
+
+    // 按名次顺序自底向上建树（players 已按键排好，scores 为对应的积分）
+    void build(const std::vector<uint32_t>& players, const std::vector<int64_t>& scores) {
+        clear();
+        if (players.empty()) {
+            return;
+        }
+        leaves_.clear();
+        std::vector<uint32_t> level;
+        std::vector<uint64_t> sizes;
+        for (size_t begin = 0; begin < players.size(); begin += kBuildKeys) {
+            uint32_t node = allocLeaf();
+            Leaf& leaf = leaves_[node];
+            leaf.count = static_cast<uint32_t>(std::min<size_t>(kBuildKeys, players.size() - begin));
+            std::memcpy(leaf.players, &players[begin], leaf.count * sizeof(leaf.players[0]));
+            std::memcpy(leaf.scores, &scores[begin], leaf.count * sizeof(leaf.scores[0]));
+            if (!level.empty()) {
+                leaf.prev = level.back();
+                leaves_[level.back()].next = node;
+            }
+            level.push_back(node);
+            sizes.push_back(leaf.count);
+        }
+        height_ = 0;
+        while (level.size() > 1) {
+            std::vector<uint32_t> upper;
+            std::vector<uint64_t> upperSizes;
+            for (size_t begin = 0; begin < level.size(); begin += kBuildKeys) {
+                uint32_t node = allocInner();
+                Inner& inner = inners_[node];
+                uint64_t total = 0;
+                inner.count = static_cast<uint32_t>(std::min<size_t>(kBuildKeys, level.size() - begin));
+                for (uint32_t i = 0; i < inner.count; i++) {
+                    uint32_t child = level[begin + i];
+                    inner.children[i] = child;
+                    inner.sizes[i] = static_cast<uint32_t>(sizes[begin + i]);
+                    firstKey(child, height_, inner.scores[i], inner.players[i]);
+                    total += sizes[begin + i];
+                }
+                upper.push_back(node);
+                upperSizes.push_back(total);
+            }
+            level.swap(upper);
+            sizes.swap(upperSizes);
+            height_++;
+        }
+        root_ = level[0];
+        size_ = players.size();
+    }
+
+private:
+    struct Leaf {
+        int64_t scores[kNodeKeys];
+        uint32_t players[kNodeKeys];
+        uint32_t count;
+        uint32_t prev;
+        uint32_t next;
+    };
+
+    struct Inner {
+        int64_t scores[kNodeKeys];      // 子树的最小键（第 0 个不用）
+        uint32_t players[kNodeKeys];
+        uint32_t children[kNodeKeys];
+        uint32_t sizes[kNodeKeys];      // 子树的键数
+        uint32_t count;                 // 子树数
+    };
+
+    uint32_t allocLeaf() {
+        uint32_t node;
+        if (!freeLeaves_.empty()) {
+            node = freeLeaves_.back();
+            freeLeaves_.pop_back();
+        } else {
+            node = static_cast<uint32_t>(leaves_.size());
+            leaves_.emplace_back();
+        }
+        leaves_[node].count = 0;
+        leaves_[node].prev = kNoLeaf;
+        leaves_[node].next = kNoLeaf;
+        return node;
+    }
+
+    uint32_t allocInner() {
+        uint32_t node;
+        if (!freeInners_.empty()) {
+            node = freeInners_.back();
+            freeInners_.pop_back();
+        } else {
+            node = static_cast<uint32_t>(inners_.size());
+            inners_.emplace_back();
+        }
+        inners_[node].count = 0;
+        return node;
+    }
+
+    bool isFull(uint32_t node, int level) const {
+        return (level == 0 ? leaves_[node].count : inners_[node].count) == kNodeKeys;
+    }
+
+    void firstKey(uint32_t node, int level, int64_t& score, uint32_t& player) const {
+        if (level == 0) {
+            score = leaves_[node].scores[0];
+            player = leaves_[node].players[0];
+        } else {
+            score = inners_[node].scores[0];
+            player = inners_[node].players[0];
+        }
+    }
+
+    // 键所在的子树：最后一个最小键不在键之后的子树
+    static uint32_t childSlot(const Inner& inner, int64_t score, uint32_t player) {
+        uint32_t low = 1, high = inner.count;
+        while (low < high) {
+            uint32_t mid = (low + high) / 2;
+            if (keyBefore(score, player, inner.scores[mid], inner.players[mid])) {
+                high = mid;
+            } else {
+                low = mid + 1;
+            }
+        }
+        return low - 1;
+    }
+
+    // 叶子中第一个不在键之前的位置
+    static uint32_t lowerBound(const Leaf& leaf, int64_t score, uint32_t player) {
+        uint32_t low = 0, high = leaf.count;
+        while (low < high) {
+            uint32_t mid = (low + high) / 2;
+            if (keyBefore(leaf.scores[mid], leaf.players[mid], score, player)) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        return low;
+    }
+
+    // 把 parent 的第 slot 棵（已满的）子树对半分成两棵
+    void splitChild(uint32_t parent, uint32_t slot, int level) {
+        uint32_t half = kNodeKeys / 2;
+        uint32_t moved = kNodeKeys - half;
+        uint32_t right;
+        uint64_t leftSize = 0, rightSize = 0;
+        if (level == 0) {
+            right = allocLeaf();
+            uint32_t left = inners_[parent].children[slot];
+            Leaf& rightLeaf = leaves_[right];
+            Leaf& leftLeaf = leaves_[left];
+            std::memcpy(rightLeaf.scores, leftLeaf.scores + half, moved * sizeof(leftLeaf.scores[0]));
+            std::memcpy(rightLeaf.players, leftLeaf.players + half, moved * sizeof(leftLeaf.players[0]));
+            rightLeaf.count = moved;
+            leftLeaf.count = half;
+            rightLeaf.prev = left;
+            rightLeaf.next = leftLeaf.next;
+            if (leftLeaf.next != kNoLeaf) leaves_[leftLeaf.next].prev = right;
+            leftLeaf.next = right;
+            leftSize = half;
+            rightSize = moved;
+        } else {
+            right = allocInner();
+            Inner& rightInner = inners_[right];
+            Inner& leftInner = inners_[inners_[parent].children[slot]];
+            std::memcpy(rightInner.scores, leftInner.scores + half, moved * sizeof(leftInner.scores[0]));
+            std::memcpy(rightInner.players, leftInner.players + half, moved * sizeof(leftInner.players[0]));
+            std::memcpy(rightInner.children, leftInner.children + half, moved * sizeof(leftInner.children[0]));
+            std::memcpy(rightInner.sizes, leftInner.sizes + half, moved * sizeof(leftInner.sizes[0]));
+            rightInner.count = moved;
+            leftInner.count = half;
+            for (uint32_t i = 0; i < half; i++) leftSize += leftInner.sizes[i];
+            for (uint32_t i = 0; i < moved; i++) rightSize += rightInner.sizes[i];
+        }
+
+        Inner& inner = inners_[parent];
+        uint32_t tail = inner.count - slot - 1;
+        std::memmove(inner.scores + slot + 2, inner.scores + slot + 1, tail * sizeof(inner.scores[0]));
+        std::memmove(inner.players + slot + 2, inner.players + slot + 1, tail * sizeof(inner.players[0]));
+        std::memmove(inner.children + slot + 2, inner.children + slot + 1, tail * sizeof(inner.children[0]));
+        std::memmove(inner.sizes + slot + 2, inner.sizes + slot + 1, tail * sizeof(inner.sizes[0]));
+        firstKey(right, level, inner.scores[slot + 1], inner.players[slot + 1]);
+        inner.children[slot + 1] = right;
+        inner.sizes[slot] = static_cast<uint32_t>(leftSize);
+        inner.sizes[slot + 1] = static_cast<uint32_t>(rightSize);
+        inner.count++;
+    }
+
+    static void removeSlot(Inner& inner, uint32_t slot) {
+        uint32_t tail = inner.count - slot - 1;
+        std::memmove(inner.scores + slot, inner.scores + slot + 1, tail * sizeof(inner.scores[0]));
+        std::memmove(inner.players + slot, inner.players + slot + 1, tail * sizeof(inner.players[0]));
+        std::memmove(inner.children + slot, inner.children + slot + 1, tail * sizeof(inner.children[0]));
+        std::memmove(inner.sizes + slot, inner.sizes + slot + 1, tail * sizeof(inner.sizes[0]));
+        inner.count--;
+    }
+
+    std::vector<Leaf> leaves_;
+    std::vector<Inner> inners_;
+    std::vector<uint32_t> freeLeaves_;
+    std::vector<uint32_t> freeInners_;
+    uint32_t root_;
+    int height_;            // 0 为根是叶子
+    uint64_t size_;
+};
+
+Leaderboard::Leaderboard(const Config& config)
+    : config_(config)
+    , applied_(0)
+    , submitted_(0)
+    , drained_(0)
+    , snapshotRequests_(0)
+    , snapshotsDone_(0)
+    , snapshotOk_(false)
+    , stop_(false)
+    , running_(false) {
+    for (int w = 0; w < kWindowCount; w++) {
+        trees_[w].reset(new RankTree());
+    }
+    playerIds_.push_back(std::string());
+    scores_.push_back(PlayerScore());
+}
+
+Leaderboard::~Leaderboard() {
+    close();
+}
+
+bool Leaderboard::open() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        if (running_) {
+            return true;
+        }
+    }
+    {
+        std::lock_guard<InstrumentedMutex> lock(mutex_);
+        if (!config_.path.empty() && !loadSnapshotLocked()) {
+            return false;
+        }
+        rollLocked(static_cast<uint32_t>(std::time(nullptr)));
+    }
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    stop_ = false;
+    running_ = true;
+    updateThread_ = std::thread(&Leaderboard::updateLoop, this);
+    return true;
+}
+
+void Leaderboard::close() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        if (!running_) {
+            return;
+        }
+        stop_ = true;
+    }
+    queueWake_.notify_one();
+    updateThread_.join();
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    running_ = false;
+    queueDrained_.notify_all();
+}
+
+void Leaderboard::submit(const std::string playerIds[GAME_PLAYER], const int64_t scores[GAME_PLAYER], uint32_t time) {
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    if (!running_ || stop_) {
+        return;
+    }
+    bool wasEmpty = front_.empty();
+    for (int i = 0; i < GAME_PLAYER; i++) {
+        if (playerIds[i].empty()) {
+            continue;
+        }
+        Update update;
+        update.playerId = playerIds[i];
+        update.delta = scores[i];
+        update.time = time;
+        front_.push_back(std::move(update));
+        submitted_++;
+    }
+    if (wasEmpty) {
+        queueWake_.notify_one();
+    }
+}
+
+void Leaderboard::addScore(const std::string& playerId, int64_t delta, uint32_t time) {
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    if (!running_ || stop_ || playerId.empty()) {
+        return;
+    }
+    Update update;
+    update.playerId = playerId;
+    update.delta = delta;
+    update.time = time;
+    if (front_.empty()) {
+        queueWake_.notify_one();
+    }
+    front_.push_back(std::move(update));
+    submitted_++;
+}
+
+void Leaderboard::flush() {
+    std::unique_lock<std::mutex> lock(queueMutex_);
+    uint64_t target = submitted_;
+    queueWake_.notify_one();
+    queueDrained_.wait(lock, [this, target] { return drained_ >= target || !running_; });
+}
+
+bool Leaderboard::snapshot() {
+    if (config_.path.empty()) {
+        return false;
+    }
+    std::unique_lock<std::mutex> lock(queueMutex_);
+    if (!running_) {
+        return writeSnapshot();
+    }
+    uint64_t request = ++snapshotRequests_;
+    queueWake_.notify_one();
+    queueDrained_.wait(lock, [this, request] { return snapshotsDone_ >= request || !running_; });
+    return snapshotsDone_ >= request && snapshotOk_;
+}
+
+void Leaderboard::updateLoop() {
+    std::vector<Update> batch;
+    Clock::time_point nextSnapshot = Clock::now() + config_.snapshotInterval;
+    for (;;) {
+        uint64_t target = 0;
+        uint64_t requests = 0;
+        bool stop = false;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex_);
+            Clock::time_point wakeAt = Clock::now() + kRollCheck;
+            if (!config_.path.empty() && nextSnapshot < wakeAt) {
+                wakeAt = nextSnapshot;
+            }
+            queueWake_.wait_until(lock, wakeAt, [this] {
+                return stop_ || !front_.empty() || snapshotRequests_ > snapshotsDone_;
+            });
+            batch.swap(front_);
+            target = submitted_;
+            requests = snapshotRequests_;
+            stop = stop_;
+        }
+
+        //分块持锁，块之间让出处理器，查询最多等一块
+        for (size_t begin = 0; begin == 0 || begin < batch.size(); begin += kApplyChunk) {
+            if (begin > 0) {
+                std::this_thread::yield();
+            }
+            size_t end = std::min(batch.size(), begin + kApplyChunk);
+            std::lock_guard<InstrumentedMutex> lock(mutex_);
+            if (begin == 0) {
+                rollLocked(static_cast<uint32_t>(std::time(nullptr)));
+            }
+            for (size_t i = begin; i < end; i++) {
+                applyLocked(batch[i]);
+            }
+            applied_ += end - begin;
+        }
+        batch.clear();
+        {
+            std::lock_guard<std::mutex> lock(queueMutex_);
+            drained_ = target;
+        }
+        queueDrained_.notify_all();
+
+        bool requested = requests > snapshotsDone_;
+        if (!config_.path.empty() && (stop || requested || Clock::now() >= nextSnapshot)) {
+            bool ok = writeSnapshot();
+            nextSnapshot = Clock::now() + config_.snapshotInterval;
+            std::lock_guard<std::mutex> lock(queueMutex_);
+            snapshotOk_ = ok;
+            snapshotsDone_ = requests;
+            queueDrained_.notify_all();
+        } else if (requested) {
+            std::lock_guard<std::mutex> lock(queueMutex_);
+            snapshotOk_ = false;
+            snapshotsDone_ = requests;
+            queueDrained_.notify_all();
+        }
+        if (stop) {
+            std::lock_guard<std::mutex> lock(queueMutex_);
+            if (front_.empty()) {
+                break;
+            }
+        }
+    }
+}
+
+uint32_t Leaderboard::periodOf(int window, uint32_t time) const {
+    int64_t day = (static_cast<int64_t>(time) + config_.utcOffset) / 86400;
+    if (window == static_cast<int>(LeaderboardWindow::Daily)) {
+        return static_cast<uint32_t>(day);
+    }
+    if (window == static_cast<int>(LeaderboardWindow::Weekly)) {
+        return static_cast<uint32_t>((day + 3) / 7);    // 1970-01-01 为周四，加 3 后周一为一周的开始
+    }
+    return 0;
+}
+
+void Leaderboard::rollLocked(uint32_t time) {
+    for (int w = 0; w < kWindowCount; w++) {
+        uint32_t period = periodOf(w, time);
+        if (period > trees_[w]->period) {
+            //玩家身上旧周期的积分按 period 判断为不在榜上，不需要逐个清理
+            trees_[w]->clear();
+            trees_[w]->period = period;
+        }
+    }
+}
+
+uint32_t Leaderboard::playerLocked(const std::string& playerId) {
+    uint32_t player = static_cast<uint32_t>(playerIds_.size());
+    std::pair<std::unordered_map<std::string, uint32_t>::iterator, bool> inserted = playerNumbers_.emplace(playerId, player);
+    if (!inserted.second) {
+        return inserted.first->second;
+    }
+    playerIds_.push_back(playerId);
+    scores_.push_back(PlayerScore());
+    return player;
+}
+
+void Leaderboard::applyLocked(const Update& update) {
+    uint32_t player = playerLocked(update.playerId);
+    PlayerScore& entry = scores_[player];
+    for (int w = 0; w < kWindowCount; w++) {
+        RankTree& tree = *trees_[w];
+        uint32_t period = periodOf(w, update.time);
+        if (period < tree.period) {
+            continue;   // 早于当前周期，只计入总榜
+        }
+        if (period > tree.period) {
+            tree.clear();
+            tree.period = period;
+        }
+        if (entry.period[w] == period + 1) {
+            if (update.delta == 0) {
+                continue;
+            }
+            tree.erase(entry.score[w], player);
+            entry.score[w] += update.delta;
+        } else {
+            entry.score[w] = update.delta;
+            entry.period[w] = period + 1;
+        }
+        tree.insert(entry.score[w], player);
+    }
+}
+
+bool Leaderboard::rank(LeaderboardWindow window, const std::string& playerId, LeaderboardEntry& entry) const {
+    int w = static_cast<int>(window);
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    std::unordered_map<std::string, uint32_t>::const_iterator found = playerNumbers_.find(playerId);
+    if (found == playerNumbers_.end()) {
+        return false;
+    }
+    const RankTree& tree = *trees_[w];
+    const PlayerScore& score = scores_[found->second];
+    if (score.period[w] != tree.period + 1) {
+        return false;
+    }
+    entry.playerId = playerId;
+    entry.score = score.score[w];
+    entry.rank = tree.rank(score.score[w], found->second);
+    return true;
+}
+
+size_t Leaderboard::range(LeaderboardWindow window, uint64_t first, size_t count, std::vector<LeaderboardEntry>& entries) const {
+    entries.clear();
+    if (count == 0) {
+        return 0;
+    }
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    trees_[static_cast<int>(window)]->visitFrom(first, [this, first, count, &entries](uint32_t player, int64_t score) {
+        LeaderboardEntry entry;
+        entry.playerId = playerIds_[player];
+        entry.score = score;
+        entry.rank = first + entries.size() + 1;
+        entries.push_back(entry);
+        return entries.size() < count;
+    });
+    return entries.size();
+}
+
+uint64_t Leaderboard::size(LeaderboardWindow window) const {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    return trees_[static_cast<int>(window)]->size();
+}
+
+uint64_t Leaderboard::getAppliedUpdates() const {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    return applied_;
+}
+
+uint64_t Leaderboard::getPlayerCount() const {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    return playerIds_.size() - 1;
+}
+
+bool Leaderboard::writeSnapshot() {
+    std::string temp = config_.path + ".tmp";
+    FILE* file = std::fopen(temp.c_str(), "wb");
+    if (file == nullptr) {
+        std::cout << "[Leaderboard] 无法创建快照: " << temp << std::endl;
+        return false;
+    }
+    std::vector<char> buffer(kFileBuffer);
+    std::setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+
+    writeValue(file, kLeaderboardMagic);
+    writeValue(file, kLeaderboardVersion);
+    writeValue(file, static_cast<uint16_t>(kWindowCount));
+    uint32_t players = static_cast<uint32_t>(playerIds_.size() - 1);
+    writeValue(file, players);
+    for (uint32_t i = 1; i <= players; i++) {
+        const std::string& playerId = playerIds_[i];
+        uint16_t length = static_cast<uint16_t>(std::min<size_t>(playerId.size(), UINT16_MAX));
+        writeValue(file, length);
+        std::fwrite(playerId.data(), 1, length, file);
+    }
+    for (int w = 0; w < kWindowCount; w++) {
+        const RankTree& tree = *trees_[w];
+        writeValue(file, tree.period);
+        writeValue(file, static_cast<uint32_t>(tree.size()));
+        tree.visitFrom(0, [file](uint32_t player, int64_t score) {
+            writeValue(file, player);
+            writeValue(file, score);
+            return true;
+        });
+    }
+    bool ok = std::fflush(file) == 0 && !std::ferror(file) && fsync(fileno(file)) == 0;
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok || std::rename(temp.c_str(), config_.path.c_str()) != 0) {
+        std::cout << "[Leaderboard] 写快照失败: " << config_.path << std::endl;
+        std::remove(temp.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool Leaderboard::loadSnapshotLocked() {
+    FILE* file = std::fopen(config_.path.c_str(), "rb");
+    if (file == nullptr) {
+        return true;    // 还没有快照
+    }
+    std::vector<char> buffer(kFileBuffer);
+    std::setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+
+    uint32_t magic = 0, players = 0;
+    uint16_t version = 0, windows = 0;
+    bool ok = readValue(file, magic) && readValue(file, version) && readValue(file, windows) && readValue(file, players) &&
+              magic == kLeaderboardMagic && version == kLeaderboardVersion && windows == kWindowCount;
+    if (ok) {
+        playerNumbers_.reserve(players);
+        playerIds_.reserve(static_cast<size_t>(players) + 1);
+        scores_.reserve(static_cast<size_t>(players) + 1);
+    }
+    std::string playerId;
+    for (uint32_t i = 1; ok && i <= players; i++) {
+        uint16_t length = 0;
+        ok = readValue(file, length);
+        playerId.resize(length);
+        ok = ok && (length == 0 || std::fread(&playerId[0], 1, length, file) == length);
+        if (ok) {
+            playerLocked(playerId);
+        }
+    }
+    ok = ok && playerIds_.size() == static_cast<size_t>(players) + 1;
+    std::vector<uint32_t> sorted;
+    std::vector<int64_t> scores;
+    for (int w = 0; ok && w < kWindowCount; w++) {
+        uint32_t period = 0, count = 0;
+        ok = readValue(file, period) && readValue(file, count) && count <= players;
+        sorted.clear();
+        scores.clear();
+        for (uint32_t i = 0; ok && i < count; i++) {
+            uint32_t player = 0;
+            int64_t score = 0;
+            ok = readValue(file, player) && readValue(file, score) && player >= 1 && player <= players &&
+                 scores_[player].period[w] == 0 &&          // 每位玩家只出现一次
+                 (sorted.empty() || keyBefore(scores.back(), sorted.back(), score, player));
+            if (ok) {
+                scores_[player].score[w] = score;
+                scores_[player].period[w] = period + 1;
+                sorted.push_back(player);
+                scores.push_back(score);
+            }
+        }
+        if (ok) {
+            trees_[w]->build(sorted, scores);
+            trees_[w]->period = period;
+        }
+    }
+    std::fclose(file);
+    if (!ok) {
+        std::cout << "[Leaderboard] 快照无法读取: " << config_.path << std::endl;
+        return false;
+    }
+    std::cout << "[Leaderboard] 读入快照 " << config_.path << "：" << players << " 位玩家，总榜 "
+              << trees_[0]->size() << " 人" << std::endl;
+    return true;
+}
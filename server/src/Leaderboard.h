@@ -0,0 +1,128 @@
+//
+// Leaderboard.h
+// 排行榜：每局结束时累加玩家的单局积分，按总榜、日榜、周榜查询名次和前 K 名
+//
+
+#ifndef LEADERBOARD_H
+#define LEADERBOARD_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "LockStats.h"
+#include "game/GameCmd.h"
+
+enum class LeaderboardWindow {
+    Total,      // 总榜
+    Daily,      // 日榜
+    Weekly      // 周榜
+};
+
+struct LeaderboardEntry {
+    std::string playerId;
+    int64_t score;
+    uint64_t rank;              // 名次，从 1 开始
+
+    LeaderboardEntry() : score(0), rank(0) {}
+};
+
+class RankTree;
+
+class Leaderboard {
+public:
+    static const int kWindowCount = 3;
+
+    struct Config {
+        std::string path;                               // 快照文件，空为不写快照
+        std::chrono::seconds snapshotInterval;          // 快照间隔
+        int32_t utcOffset;                              // 日榜、周榜换榜时刻的时区偏移（秒）
+
+        Config() : snapshotInterval(60), utcOffset(8 * 3600) {}
+    };
+
+    explicit Leaderboard(const Config& config);
+    ~Leaderboard();                 // 等同 close()
+
+    // 读入快照（文件不存在时为空榜）并启动后台线程；快照无法读取时返回 false
+    bool open();
+
+    // 应用缓冲区中的更新，写最后一次快照后停止后台线程
+    void close();
+
+    /**
+     * 一局结束：座位上的玩家各加单局积分（不等待，机器人座位 playerId 为空）
+     * @param playerIds
+     * @param scores 单局积分 lGameScore
+     * @param time 结束时间（Unix 秒）
+     */
+    void submit(const std::string playerIds[GAME_PLAYER], const int64_t scores[GAME_PLAYER], uint32_t time);
+    void addScore(const std::string& playerId, int64_t delta, uint32_t time);
+
+    void flush();                   // 等待此前提交的更新全部应用
+
+    // 玩家在榜上的积分和名次，不在榜上返回 false
+    bool rank(LeaderboardWindow window, const std::string& playerId, LeaderboardEntry& entry) const;
+
+    // 从第 first 名（从 0 开始）起的 count 名，返回条数
+    size_t range(LeaderboardWindow window, uint64_t first, size_t count, std::vector<LeaderboardEntry>& entries) const;
+    size_t top(LeaderboardWindow window, size_t count, std::vector<LeaderboardEntry>& entries) const {
+        return range(window, 0, count, entries);
+    }
+
+    uint64_t size(LeaderboardWindow window) const;      // 榜上的玩家数
+    bool snapshot();                                    // 立即写一次快照
+
+    uint64_t getAppliedUpdates() const;     // 已应用的更新数
+    uint64_t getPlayerCount() const;        // 登记过的玩家数
+
+private:
+    struct Update {
+        std::string playerId;
+        int64_t delta;
+        uint32_t time;
+    };
+
+    struct PlayerScore {
+        int64_t score[kWindowCount];        // 各榜上的积分
+        uint32_t period[kWindowCount];      // 所在周期 + 1，0 为不在榜上
+    };
+
+    void updateLoop();
+    void applyLocked(const Update& update);
+    void rollLocked(uint32_t time);                  // 按时间换日榜、周榜
+    uint32_t periodOf(int window, uint32_t time) const;
+    uint32_t playerLocked(const std::string& playerId);
+
+    bool loadSnapshotLocked();
+    bool writeSnapshot();                   // 在后台线程（唯一修改各榜的线程）上不加锁写快照
+
+    Config config_;
+    mutable InstrumentedMutex mutex_{"Leaderboard::mutex_"};   // 保护玩家编号和各榜
+    std::unique_ptr<RankTree> trees_[kWindowCount];
+    std::vector<PlayerScore> scores_;       // 下标为玩家编号
+    std::unordered_map<std::string, uint32_t> playerNumbers_;
+    std::vector<std::string> playerIds_;    // 下标为编号，0 为空
+    uint64_t applied_;
+
+    std::mutex queueMutex_;                 // 保护以下数据
+    std::condition_variable queueWake_;
+    std::condition_variable queueDrained_;
+    std::vector<Update> front_;             // 房间线程追加的缓冲区
+    uint64_t submitted_;
+    uint64_t drained_;                      // 后台线程已应用到的提交序号
+    uint64_t snapshotRequests_;             // snapshot() 请求的次数
+    uint64_t snapshotsDone_;                // 后台线程已完成的请求
+    bool snapshotOk_;                       // 最近一次快照是否写成
+    bool stop_;
+    bool running_;
+    std::thread updateThread_;
+};
+
+#endif // LEADERBOARD_H
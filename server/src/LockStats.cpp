@@ -0,0 +1,260 @@
+//
+// LockStats.cpp
+// 锁竞争统计实现：记录注册、直方图、报告输出和信号触发的转储线程
+//
+
+#include "LockStats.h"
+
+#include <fstream>
+#include <iostream>
+
+#ifdef MAHJONG_LOCK_STATS
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iomanip>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+const int kMaxRecords = 64;
+
+LockStats::Record g_records[kMaxRecords];
+int g_recordCount = 0;
+std::mutex g_registryMutex;     // 只在构造锁时使用，本身不统计
+
+int g_signalPipe[2] = { -1, -1 };
+std::string g_dumpPath;
+
+int bucketOf(uint64_t ns) {
+    if (ns == 0) {
+        return 0;
+    }
+    int bucket = 63 - __builtin_clzll(ns);
+    return bucket < LockStats::kBuckets ? bucket : LockStats::kBuckets - 1;
+}
+
+void updateMax(std::atomic<uint64_t>& target, uint64_t value) {
+    uint64_t current = target.load(std::memory_order_relaxed);
+    while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+void clearRecord(LockStats::Record& record) {
+    record.acquisitions.store(0, std::memory_order_relaxed);
+    record.contended.store(0, std::memory_order_relaxed);
+    record.waitNsTotal.store(0, std::memory_order_relaxed);
+    record.holdNsTotal.store(0, std::memory_order_relaxed);
+    record.waitNsMax.store(0, std::memory_order_relaxed);
+    record.holdNsMax.store(0, std::memory_order_relaxed);
+    for (int i = 0; i < LockStats::kBuckets; i++) {
+        record.waitHistogram[i].store(0, std::memory_order_relaxed);
+        record.holdHistogram[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+// 直方图中第 q 分位所在桶的上界（纳秒）
+uint64_t percentile(const std::atomic<uint64_t>* histogram, uint64_t total, double q) {
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t target = static_cast<uint64_t>(total * q);
+    uint64_t seen = 0;
+    for (int i = 0; i < LockStats::kBuckets; i++) {
+        seen += histogram[i].load(std::memory_order_relaxed);
+        if (seen > target) {
+            return 1ULL << (i + 1);
+        }
+    }
+    return 1ULL << LockStats::kBuckets;
+}
+
+void dumpHistogram(std::ostream& out, const char* title, const std::atomic<uint64_t>* histogram) {
+    out << "  " << title << ":\n";
+    for (int i = 0; i < LockStats::kBuckets; i++) {
+        uint64_t count = histogram[i].load(std::memory_order_relaxed);
+        if (count == 0) {
+            continue;
+        }
+        uint64_t low = i == 0 ? 0 : (1ULL << i);
+        out << "    [" << std::setw(11) << low << ", " << std::setw(11) << (1ULL << (i + 1)) << ") ns  "
+            << count << "\n";
+    }
+}
+
+void signalHandler(int) {
+    int savedErrno = errno;
+    char byte = 1;
+    ssize_t ignored = ::write(g_signalPipe[1], &byte, 1);
+    (void)ignored;
+    errno = savedErrno;
+}
+
+void dumpThread() {
+    char byte;
+    for (;;) {
+        ssize_t n = ::read(g_signalPipe[0], &byte, 1);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return;
+        }
+        if (LockStats::dumpToFile(g_dumpPath)) {
+            std::cout << "[LockStats] 锁统计已写入 " << g_dumpPath << std::endl;
+        }
+    }
+}
+
+} // namespace
+
+namespace LockStats {
+
+Record* record(const char* name) {
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    for (int i = 0; i < g_recordCount; i++) {
+        if (std::strcmp(g_records[i].name, name) == 0) {
+            return &g_records[i];
+        }
+    }
+    if (g_recordCount == kMaxRecords - 1) {
+        // 最后一条留给溢出的名字
+        if (g_records[g_recordCount].name == nullptr) {
+            g_records[g_recordCount].name = "<other>";
+        }
+        return &g_records[g_recordCount];
+    }
+    Record& created = g_records[g_recordCount++];
+    created.name = name;
+    return &created;
+}
+
+void recordWait(Record* record, uint64_t ns, bool contended) {
+    record->acquisitions.fetch_add(1, std::memory_order_relaxed);
+    record->waitHistogram[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+    if (contended) {
+        record->contended.fetch_add(1, std::memory_order_relaxed);
+        record->waitNsTotal.fetch_add(ns, std::memory_order_relaxed);
+        updateMax(record->waitNsMax, ns);
+    }
+}
+
+void recordHold(Record* record, uint64_t ns) {
+    record->holdNsTotal.fetch_add(ns, std::memory_order_relaxed);
+    record->holdHistogram[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+    updateMax(record->holdNsMax, ns);
+}
+
+bool enabled() {
+    return true;
+}
+
+void dump(std::ostream& out) {
+    int count;
+    {
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        count = g_recordCount < kMaxRecords - 1 ? g_recordCount : kMaxRecords;
+    }
+    out << "# 锁竞争统计（" << count << " 个锁名）\n";
+    for (int i = 0; i < count; i++) {
+        const Record& r = g_records[i];
+        if (r.name == nullptr) {
+            continue;
+        }
+        uint64_t acquisitions = r.acquisitions.load(std::memory_order_relaxed);
+        uint64_t contended = r.contended.load(std::memory_order_relaxed);
+        uint64_t waitTotal = r.waitNsTotal.load(std::memory_order_relaxed);
+        uint64_t holdTotal = r.holdNsTotal.load(std::memory_order_relaxed);
+        out << r.name << "\n"
+            << "  获取次数: " << acquisitions
+            << "  竞争次数: " << contended;
+        if (acquisitions > 0) {
+            out << " (" << std::fixed << std::setprecision(2) << (100.0 * contended / acquisitions) << "%)";
+        }
+        out << "\n"
+            << "  等待: 总计 " << waitTotal << " ns, 最大 " << r.waitNsMax.load(std::memory_order_relaxed)
+            << " ns, p50 < " << percentile(r.waitHistogram, acquisitions, 0.50)
+            << " ns, p99 < " << percentile(r.waitHistogram, acquisitions, 0.99) << " ns\n"
+            << "  持有: 总计 " << holdTotal << " ns, 最大 " << r.holdNsMax.load(std::memory_order_relaxed)
+            << " ns, p50 < " << percentile(r.holdHistogram, acquisitions, 0.50)
+            << " ns, p99 < " << percentile(r.holdHistogram, acquisitions, 0.99) << " ns\n";
+        dumpHistogram(out, "等待时间分布", r.waitHistogram);
+        dumpHistogram(out, "持有时间分布", r.holdHistogram);
+    }
+}
+
+void reset() {
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    for (int i = 0; i < kMaxRecords; i++) {
+        clearRecord(g_records[i]);
+    }
+}
+
+bool installDumpSignal(int signo, const std::string& path) {
+    if (g_signalPipe[0] >= 0) {
+        return false;
+    }
+    if (::pipe2(g_signalPipe, O_CLOEXEC) < 0) {
+        std::perror("[LockStats] 创建管道失败");
+        return false;
+    }
+    // 写端非阻塞：转储线程来不及读时丢弃多余的信号
+    ::fcntl(g_signalPipe[1], F_SETFL, O_NONBLOCK);
+    g_dumpPath = path;
+    std::thread(dumpThread).detach();
+
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = signalHandler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    if (::sigaction(signo, &action, nullptr) < 0) {
+        std::perror("[LockStats] 注册信号失败");
+        return false;
+    }
+    std::cout << "[LockStats] 锁统计已开启，收到信号 " << signo << " 时写入 " << path << std::endl;
+    return true;
+}
+
+} // namespace LockStats
+
+#else // MAHJONG_LOCK_STATS
+
+namespace LockStats {
+
+bool enabled() {
+    return false;
+}
+
+void dump(std::ostream& out) {
+    out << "# 锁竞争统计未编译（CMake 选项 MAHJONG_LOCK_STATS=OFF）\n";
+}
+
+void reset() {
+}
+
+bool installDumpSignal(int, const std::string&) {
+    return false;
+}
+
+} // namespace LockStats
+
+#endif // MAHJONG_LOCK_STATS
+
+namespace LockStats {
+
+bool dumpToFile(const std::string& path) {
+    std::ofstream file(path.c_str(), std::ios::out | std::ios::trunc);
+    if (!file) {
+        std::cerr << "[LockStats] 无法写入 " << path << std::endl;
+        return false;
+    }
+    dump(file);
+    return static_cast<bool>(file);
+}
+
+} // namespace LockStats
@@ -0,0 +1,119 @@
+//
+// LockStats.h
+// 锁竞争统计：CMake 选项 MAHJONG_LOCK_STATS 开启的带统计互斥锁，未开启时等同 std::mutex
+//
+
+#ifndef LOCK_STATS_H
+#define LOCK_STATS_H
+
+#include <mutex>
+#include <ostream>
+#include <string>
+
+#ifdef MAHJONG_LOCK_STATS
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace LockStats {
+    const int kBuckets = 32;
+
+    // 一个锁名字的统计记录（原子计数，多线程无锁更新）
+    struct Record {
+        const char* name;
+        std::atomic<uint64_t> acquisitions;
+        std::atomic<uint64_t> contended;
+        std::atomic<uint64_t> waitNsTotal;
+        std::atomic<uint64_t> holdNsTotal;
+        std::atomic<uint64_t> waitNsMax;
+        std::atomic<uint64_t> holdNsMax;
+        std::atomic<uint64_t> waitHistogram[kBuckets];
+        std::atomic<uint64_t> holdHistogram[kBuckets];
+    };
+
+    // 按名字取得记录（同名共用），记录数超过上限时归入 "<other>"
+    Record* record(const char* name);
+
+    // 记录一次等待 / 持有
+    void recordWait(Record* record, uint64_t ns, bool contended);
+    void recordHold(Record* record, uint64_t ns);
+
+    inline uint64_t nowNs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+}
+
+class InstrumentedMutex {
+public:
+    explicit InstrumentedMutex(const char* name)
+        : record_(LockStats::record(name))
+        , lockedAt_(0) {
+    }
+
+    InstrumentedMutex(const InstrumentedMutex&) = delete;
+    InstrumentedMutex& operator=(const InstrumentedMutex&) = delete;
+
+    void lock() {
+        uint64_t begin = LockStats::nowNs();
+        if (mutex_.try_lock()) {
+            LockStats::recordWait(record_, 0, false);
+            lockedAt_ = begin;
+            return;
+        }
+        mutex_.lock();
+        uint64_t acquired = LockStats::nowNs();
+        LockStats::recordWait(record_, acquired - begin, true);
+        lockedAt_ = acquired;
+    }
+
+    bool try_lock() {
+        if (!mutex_.try_lock()) {
+            return false;
+        }
+        LockStats::recordWait(record_, 0, false);
+        lockedAt_ = LockStats::nowNs();
+        return true;
+    }
+
+    void unlock() {
+        // lockedAt_ 只由持有者读写
+        LockStats::recordHold(record_, LockStats::nowNs() - lockedAt_);
+        mutex_.unlock();
+    }
+
+private:
+    std::mutex mutex_;
+    LockStats::Record* record_;
+    uint64_t lockedAt_;
+};
+
+#else // MAHJONG_LOCK_STATS
+
+// 未开启统计：与 std::mutex 完全相同
+class InstrumentedMutex : public std::mutex {
+public:
+    explicit InstrumentedMutex(const char*) {}
+};
+
+static_assert(sizeof(InstrumentedMutex) == sizeof(std::mutex), "InstrumentedMutex 关闭统计时必须与 std::mutex 等价");
+
+#endif // MAHJONG_LOCK_STATS
+
+namespace LockStats {
+    // 是否编译了统计功能
+    bool enabled();
+
+    // 输出当前统计报告（未开启时只输出一行说明）
+    void dump(std::ostream& out);
+    bool dumpToFile(const std::string& path);
+
+    // 清零全部计数
+    void reset();
+
+    // 收到 signo 时把报告写入 path（未开启时不注册）
+    bool installDumpSignal(int signo, const std::string& path);
+}
+
+#endif // LOCK_STATS_H
@@ -0,0 +1,1029 @@
+//
+// MatchHistory.cpp
+// 对局历史实现
+//
+// 段文件格式（本机字节序）：
+//   段头 tagSegmentHeader：魔数、版本、列数、容量（行）、是否已压缩、行数、结束时间范围，
+//   以及每列的偏移、基准值和宽度；之后是各列的数据，每列从 64 字节对齐处开始。
+//   写入段：各列为原始宽度、基准值 0，预留 capacity 行，行数在每行写完后更新；
+//   压缩段：容量等于行数，第 row 行的值 = 基准值 + 该列第 row 个宽度为 width 的无符号数（宽度 0 时就是基准值）。
+// 玩家编号文件 <path>.players：依次为 1 字节长度 + id，第 n 条的编号为 n（从 1 开始），长度为 0 处为末尾；
+// 文件预留后映射，关闭时截到已写长度。
+//
+
+#include "MatchHistory.h"
+#include "game/GameLogic.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+const uint32_t kHistoryMagic = 0x484D4D4DU;          // "MMMH"
+const uint16_t kHistoryVersion = 1;
+const uint32_t kMinSegmentRows = 64;
+const size_t kPlayersChunk = 1024 * 1024;           // 玩家编号文件的初始预留，写满后翻倍
+const size_t kMaxPlayerId = 255;                    // 玩家 id 最多保留的字节数
+
+enum HistoryColumn {
+    Column_Time = 0,
+    Column_Player = Column_Time + 1,                    // 每个座位一列
+    Column_HuUser = Column_Player + GAME_PLAYER,
+    Column_ProvideUser,
+    Column_HuCard,
+    Column_HuRight,                                     // 每个座位一列
+    Column_HuKind = Column_HuRight + GAME_PLAYER,       // 每个座位一列
+    Column_Weave = Column_HuKind + GAME_PLAYER,         // 每个座位一列
+    Column_Ma = Column_Weave + GAME_PLAYER,             // 每只鸟一列
+    Column_Score = Column_Ma + MAX_MA,                  // 每个座位一列
+    Column_Count = Column_Score + GAME_PLAYER
+};
+
+// 写入段中各列的原始宽度
+uint8_t rawWidth(int column) {
+    if (column == Column_Time || (column >= Column_Player && column < Column_HuUser)) {
+        return 4;
+    }
+    if ((column >= Column_HuRight && column < Column_HuKind) || column >= Column_Score) {
+        return 8;
+    }
+    return 1;
+}
+
+// 位掩码列压缩时基准值固定为 0，规则统计可以直接按位计数
+bool isMaskColumn(int column) {
+    return column == Column_HuUser || (column >= Column_HuRight && column < Column_Weave);
+}
+
+bool isSignedColumn(int column) {
+    return column >= Column_Score;
+}
+
+size_t align64(size_t size) {
+    return (size + 63) & ~static_cast<size_t>(63);
+}
+
+uint8_t widthFor(uint64_t range) {
+    if (range == 0) {
+        return 0;
+    }
+    if (range <= 0xFF) {
+        return 1;
+    }
+    if (range <= 0xFFFF) {
+        return 2;
+    }
+    return range <= 0xFFFFFFFFULL ? 4 : 8;
+}
+
+} // namespace
+
+struct tagColumnHeader {
+    uint64_t offset;            // 列数据在文件中的偏移
+    uint64_t base;              // 基准值
+    uint8_t width;              // 每个值的字节数 0/1/2/4/8
+    uint8_t reserved[7];
+};
+
+struct tagSegmentHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t columns;
+    uint32_t capacity;          // 预留的行数
+    uint32_t sealed;            // 1 为已压缩
+    uint32_t rows;              // 已写的行数
+    uint32_t minTime;           // 结束时间范围
+    uint32_t maxTime;
+    uint32_t reserved;
+    tagColumnHeader column[Column_Count];
+};
+
+// 一列的视图
+struct ColumnView {
+    const uint8_t* data;
+    uint64_t base;
+    uint8_t width;
+};
+
+namespace {
+
+// 第 row 行减去基准值后的值
+inline uint64_t loadStored(const ColumnView& column, uint32_t row) {
+    switch (column.width) {
+        case 0:
+            return 0;
+        case 1:
+            return column.data[row];
+        case 2: {
+            uint16_t value;
+            std::memcpy(&value, column.data + 2 * static_cast<size_t>(row), sizeof(value));
+            return value;
+        }
+        case 4: {
+            uint32_t value;
+            std::memcpy(&value, column.data + 4 * static_cast<size_t>(row), sizeof(value));
+            return value;
+        }
+        default: {
+            uint64_t value;
+            std::memcpy(&value, column.data + 8 * static_cast<size_t>(row), sizeof(value));
+            return value;
+        }
+    }
+}
+
+inline uint64_t loadValue(const ColumnView& column, uint32_t row) {
+    return column.base + loadStored(column, row);
+}
+
+inline void storeValue(uint8_t* data, uint8_t width, uint32_t row, uint64_t value) {
+    switch (width) {
+        case 0:
+            break;
+        case 1:
+            data[row] = static_cast<uint8_t>(value);
+            break;
+        case 2: {
+            uint16_t narrow = static_cast<uint16_t>(value);
+            std::memcpy(data + 2 * static_cast<size_t>(row), &narrow, sizeof(narrow));
+            break;
+        }
+        case 4: {
+            uint32_t narrow = static_cast<uint32_t>(value);
+            std::memcpy(data + 4 * static_cast<size_t>(row), &narrow, sizeof(narrow));
+            break;
+        }
+        default:
+            std::memcpy(data + 8 * static_cast<size_t>(row), &value, sizeof(value));
+            break;
+    }
+}
+
+// 把列中值为 value 的行在位图中置位（第 row 行为 bits[row / 64] 的第 row % 64 位，调用方清零）
+void scanEqual(const ColumnView& column, uint32_t rows, uint64_t value, uint64_t* bits) {
+    uint64_t stored = value - column.base;
+    if (column.width < 8 && (stored >> (8 * column.width)) != 0) {
+        return;
+    }
+    uint32_t row = 0;
+    if (column.width == 0) {
+        for (; row + 64 <= rows; row += 64) {
+            bits[row >> 6] = ~0ULL;
+        }
+    }
+#if defined(__SSE2__)
+    // 每次比较 16 行，比较结果收成 16 位掩码；16 整除 64，掩码不会跨字
+    if (column.width == 1) {
+        __m128i key = _mm_set1_epi8(static_cast<char>(stored));
+        for (; row + 16 <= rows; row += 16) {
+            __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(column.data + row));
+            uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(values, key)));
+            bits[row >> 6] |= static_cast<uint64_t>(mask) << (row & 63);
+        }
+    } else if (column.width == 2) {
+        __m128i key = _mm_set1_epi16(static_cast<short>(stored));
+        const uint8_t* data = column.data;
+        for (; row + 16 <= rows; row += 16) {
+            __m128i low = _mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 2 * row)), key);
+            __m128i high = _mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 2 * row + 16)), key);
+            uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_packs_epi16(low, high)));
+            bits[row >> 6] |= static_cast<uint64_t>(mask) << (row & 63);
+        }
+    } else if (column.width == 4) {
+        __m128i key = _mm_set1_epi32(static_cast<int>(stored));
+        const uint8_t* data = column.data;
+        for (; row + 16 <= rows; row += 16) {
+            const __m128i* p = reinterpret_cast<const __m128i*>(data + 4 * static_cast<size_t>(row));
+            __m128i a = _mm_cmpeq_epi32(_mm_loadu_si128(p), key);
+            __m128i b = _mm_cmpeq_epi32(_mm_loadu_si128(p + 1), key);
+            __m128i c = _mm_cmpeq_epi32(_mm_loadu_si128(p + 2), key);
+            __m128i d = _mm_cmpeq_epi32(_mm_loadu_si128(p + 3), key);
+            __m128i packed = _mm_packs_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+            uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(packed));
+            bits[row >> 6] |= static_cast<uint64_t>(mask) << (row & 63);
+        }
+    }
+#endif
+    for (; row < rows; row++) {
+        if (loadStored(column, row) == stored) {
+            bits[row >> 6] |= 1ULL << (row & 63);
+        }
+    }
+}
+
+} // namespace
+
+struct HistorySegment {
+    uint32_t seq;
+    uint8_t* base;
+    size_t bytes;
+    tagSegmentHeader* header;
+    ColumnView columns[Column_Count];
+
+    HistorySegment() : seq(0), base(nullptr), bytes(0), header(nullptr) {}
+
+    ~HistorySegment() {
+        if (base != nullptr) {
+            munmap(base, bytes);
+        }
+    }
+
+    bool sealed() const { return header->sealed != 0; }
+
+    void bindColumns() {
+        for (int c = 0; c < Column_Count; c++) {
+            columns[c].data = base + header->column[c].offset;
+            columns[c].base = header->column[c].base;
+            columns[c].width = header->column[c].width;
+        }
+    }
+};
+
+// 查询时的一段：写入段的行数和时间范围取自加锁时
+struct SegmentView {
+    std::shared_ptr<const HistorySegment> segment;
+    uint32_t rows;
+    uint32_t minTime;
+    uint32_t maxTime;
+};
+
+namespace {
+
+// 映射一个段文件并检查段头，写入段可写映射
+std::shared_ptr<HistorySegment> mapSegment(const std::string& path, uint32_t seq) {
+    int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(tagSegmentHeader)) {
+        ::close(fd);
+        return nullptr;
+    }
+    tagSegmentHeader header;
+    if (pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) || header.magic != kHistoryMagic ||
+        header.version != kHistoryVersion || header.columns != Column_Count || header.rows > header.capacity) {
+        ::close(fd);
+        return nullptr;
+    }
+    size_t bytes = static_cast<size_t>(st.st_size);
+    for (int c = 0; c < Column_Count; c++) {
+        const tagColumnHeader& column = header.column[c];
+        if (column.width > 8 || column.offset > bytes || column.width * static_cast<uint64_t>(header.capacity) > bytes - column.offset) {
+            ::close(fd);
+            return nullptr;
+        }
+    }
+    int prot = header.sealed != 0 ? PROT_READ : PROT_READ | PROT_WRITE;
+    void* mapped = mmap(nullptr, bytes, prot, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        return nullptr;
+    }
+    std::shared_ptr<HistorySegment> segment = std::make_shared<HistorySegment>();
+    segment->seq = seq;
+    segment->base = static_cast<uint8_t*>(mapped);
+    segment->bytes = bytes;
+    segment->header = reinterpret_cast<tagSegmentHeader*>(segment->base);
+    segment->bindColumns();
+    return segment;
+}
+
+// 创建写入段：各列原始宽度，预留 capacity 行（文件是稀疏的，写到哪里占到哪里）
+std::shared_ptr<HistorySegment> createSegment(const std::string& path, uint32_t seq, uint32_t capacity) {
+    tagSegmentHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = kHistoryMagic;
+    header.version = kHistoryVersion;
+    header.columns = Column_Count;
+    header.capacity = capacity;
+    header.minTime = UINT32_MAX;
+    size_t offset = align64(sizeof(header));
+    for (int c = 0; c < Column_Count; c++) {
+        header.column[c].offset = offset;
+        header.column[c].width = rawWidth(c);
+        offset += align64(static_cast<size_t>(rawWidth(c)) * capacity);
+    }
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return nullptr;
+    }
+    bool ok = ftruncate(fd, static_cast<off_t>(offset)) == 0 &&
+              pwrite(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header));
+    ::close(fd);
+    if (!ok) {
+        unlink(path.c_str());
+        return nullptr;
+    }
+    return mapSegment(path, seq);
+}
+
+// 压缩 rows 行写成 path（先写临时文件再改名替换），返回新文件的大小，失败返回 0
+size_t writeSealed(const HistorySegment& raw, uint32_t rows, const std::string& path) {
+    tagSegmentHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = kHistoryMagic;
+    header.version = kHistoryVersion;
+    header.columns = Column_Count;
+    header.capacity = rows;
+    header.sealed = 1;
+    header.rows = rows;
+    header.minTime = raw.header->minTime;
+    header.maxTime = raw.header->maxTime;
+    size_t offset = align64(sizeof(header));
+    for (int c = 0; c < Column_Count; c++) {
+        const ColumnView& column = raw.columns[c];
+        uint64_t base = 0;
+        uint64_t range = 0;
+        if (rows > 0 && isSignedColumn(c)) {
+            int64_t low = static_cast<int64_t>(loadValue(column, 0));
+            int64_t high = low;
+            for (uint32_t row = 1; row < rows; row++) {
+                int64_t value = static_cast<int64_t>(loadValue(column, row));
+                low = std::min(low, value);
+                high = std::max(high, value);
+            }
+            base = static_cast<uint64_t>(low);
+            range = static_cast<uint64_t>(high) - static_cast<uint64_t>(low);
+        } else if (rows > 0) {
+            uint64_t low = isMaskColumn(c) ? 0 : loadValue(column, 0);
+            uint64_t high = low;
+            for (uint32_t row = 0; row < rows; row++) {
+                uint64_t value = loadValue(column, row);
+                low = std::min(low, value);
+                high = std::max(high, value);
+            }
+            base = low;
+            range = high - low;
+        }
+        header.column[c].offset = offset;
+        header.column[c].base = base;
+        header.column[c].width = widthFor(range);
+        offset += align64(static_cast<size_t>(header.column[c].width) * rows);
+    }
+
+    std::vector<uint8_t> data(offset, 0);
+    std::memcpy(data.data(), &header, sizeof(header));
+    for (int c = 0; c < Column_Count; c++) {
+        const tagColumnHeader& target = header.column[c];
+        for (uint32_t row = 0; row < rows && target.width > 0; row++) {
+            storeValue(data.data() + target.offset, target.width, row, loadValue(raw.columns[c], row) - target.base);
+        }
+    }
+
+    std::string temp = path + ".tmp";
+    int fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return 0;
+    }
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t n = ::write(fd, data.data() + written, data.size() - written);
+        if (n <= 0) {
+            break;
+        }
+        written += static_cast<size_t>(n);
+    }
+    bool ok = written == data.size() && fsync(fd) == 0;
+    ::close(fd);
+    if (!ok || rename(temp.c_str(), path.c_str()) != 0) {
+        unlink(temp.c_str());
+        return 0;
+    }
+    return data.size();
+}
+
+// 一行计入规则统计
+void addRuleRow(const HistorySegment& segment, uint32_t row, RuleStats& stats) {
+    uint8_t huUser = static_cast<uint8_t>(loadValue(segment.columns[Column_HuUser], row));
+    if (huUser == 0) {
+        stats.draws++;
+        return;
+    }
+    if ((huUser & (huUser - 1)) != 0) {
+        stats.multiWins++;
+    }
+    for (int s = 0; s < GAME_PLAYER; s++) {
+        if ((huUser & (1 << s)) == 0) {
+            continue;
+        }
+        stats.winners++;
+        for (uint64_t right = loadValue(segment.columns[Column_HuRight + s], row); right != 0; right &= right - 1) {
+            stats.huRight[__builtin_ctzll(right)]++;
+        }
+        for (uint64_t kind = loadValue(segment.columns[Column_HuKind + s], row) & 0xFF; kind != 0; kind &= kind - 1) {
+            stats.huKind[__builtin_ctzll(kind)]++;
+        }
+    }
+}
+
+#if defined(__SSE2__)
+// 字节计数器的 16 个通道求和后清零
+inline uint64_t drainCounter(__m128i& counter) {
+    __m128i sums = _mm_sad_epu8(counter, _mm_setzero_si128());
+    counter = _mm_setzero_si128();
+    return static_cast<uint64_t>(_mm_cvtsi128_si32(sums)) + static_cast<uint64_t>(_mm_cvtsi128_si32(_mm_srli_si128(sums, 8)));
+}
+#endif
+
+// 整段计入规则统计：胡牌人员、胡牌类型和胡牌方式列都是 1 字节（或全为 0）时每次处理 16 行，
+// 每一项计数是 16 个字节通道（比较结果为 0xFF，减去即加一），每个通道每 16 行最多加 GAME_PLAYER，攒满前求和
+void addRuleSegment(const HistorySegment& segment, uint32_t rows, RuleStats& stats) {
+    uint32_t row = 0;
+#if defined(__SSE2__)
+    bool narrow = true;
+    for (int c = Column_HuUser; c < Column_Weave && narrow; c++) {
+        narrow = !isMaskColumn(c) || segment.columns[c].width <= 1;
+    }
+    if (narrow) {
+        static const uint8_t kZeros[16] = {0};
+        const uint32_t kDrainBlocks = 255 / GAME_PLAYER;
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i one = _mm_set1_epi8(1);
+        __m128i draws = zero, multiWins = zero, winners = zero;
+        __m128i huRight[8], huKind[8], bits[8];
+        for (int b = 0; b < 8; b++) {
+            huRight[b] = zero;
+            huKind[b] = zero;
+            bits[b] = _mm_set1_epi8(static_cast<char>(1 << b));
+        }
+        const uint8_t* columnData[Column_Count];
+        for (int c = Column_HuUser; c < Column_Weave; c++) {
+            columnData[c] = segment.columns[c].width == 0 ? nullptr : segment.columns[c].data;
+        }
+        uint32_t blocks = 0;
+        for (; row + 16 <= rows; row += 16) {
+            const uint8_t* huData = columnData[Column_HuUser] != nullptr ? columnData[Column_HuUser] + row : kZeros;
+            __m128i huUser = _mm_loadu_si128(reinterpret_cast<const __m128i*>(huData));
+            draws = _mm_sub_epi8(draws, _mm_cmpeq_epi8(huUser, zero));
+            //有两位以上：huUser & (huUser - 1) 不为 0
+            multiWins = _mm_add_epi8(multiWins, _mm_andnot_si128(_mm_cmpeq_epi8(_mm_and_si128(huUser, _mm_sub_epi8(huUser, one)), zero), one));
+            for (int s = 0; s < GAME_PLAYER; s++) {
+                __m128i selected = _mm_cmpeq_epi8(_mm_and_si128(huUser, bits[s]), bits[s]);
+                winners = _mm_sub_epi8(winners, selected);
+                const uint8_t* rightData = columnData[Column_HuRight + s] != nullptr ? columnData[Column_HuRight + s] + row : kZeros;
+                const uint8_t* kindData = columnData[Column_HuKind + s] != nullptr ? columnData[Column_HuKind + s] + row : kZeros;
+                __m128i right = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(rightData)), selected);
+                __m128i kind = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(kindData)), selected);
+                for (int b = 0; b < 8; b++) {
+                    huRight[b] = _mm_sub_epi8(huRight[b], _mm_cmpeq_epi8(_mm_and_si128(right, bits[b]), bits[b]));
+                    huKind[b] = _mm_sub_epi8(huKind[b], _mm_cmpeq_epi8(_mm_and_si128(kind, bits[b]), bits[b]));
+                }
+            }
+            if (++blocks == kDrainBlocks) {
+                blocks = 0;
+                stats.draws += drainCounter(draws);
+                stats.multiWins += drainCounter(multiWins);
+                stats.winners += drainCounter(winners);
+                for (int b = 0; b < 8; b++) {
+                    stats.huRight[b] += drainCounter(huRight[b]);
+                    stats.huKind[b] += drainCounter(huKind[b]);
+                }
+            }
+        }
+        stats.draws += drainCounter(draws);
+        stats.multiWins += drainCounter(multiWins);
+        stats.winners += drainCounter(winners);
+        for (int b = 0; b < 8; b++) {
+            stats.huRight[b] += drainCounter(huRight[b]);
+            stats.huKind[b] += drainCounter(huKind[b]);
+        }
+    }
+#endif
+    for (; row < rows; row++) {
+        addRuleRow(segment, row, stats);
+    }
+}
+
+void readRecord(const HistorySegment& segment, uint32_t row, MatchRecord& record, uint32_t players[GAME_PLAYER]) {
+    const ColumnView* columns = segment.columns;
+    record.time = static_cast<uint32_t>(loadValue(columns[Column_Time], row));
+    record.huUser = static_cast<uint8_t>(loadValue(columns[Column_HuUser], row));
+    record.provideUser = static_cast<uint8_t>(loadValue(columns[Column_ProvideUser], row));
+    record.huCard = static_cast<uint8_t>(loadValue(columns[Column_HuCard], row));
+    for (int s = 0; s < GAME_PLAYER; s++) {
+        players[s] = static_cast<uint32_t>(loadValue(columns[Column_Player + s], row));
+        record.huRight[s] = loadValue(columns[Column_HuRight + s], row);
+        record.huKind[s] = static_cast<uint8_t>(loadValue(columns[Column_HuKind + s], row));
+        record.weaveCount[s] = static_cast<uint8_t>(loadValue(columns[Column_Weave + s], row));
+        record.score[s] = static_cast<int64_t>(loadValue(columns[Column_Score + s], row));
+    }
+    for (int m = 0; m < MAX_MA; m++) {
+        record.maCard[m] = static_cast<uint8_t>(loadValue(columns[Column_Ma + m], row));
+    }
+}
+
+inline bool overlaps(const SegmentView& view, uint32_t fromTime, uint32_t toTime) {
+    return view.rows > 0 && view.minTime < toTime && view.maxTime >= fromTime;
+}
+
+inline bool covers(const SegmentView& view, uint32_t fromTime, uint32_t toTime) {
+    return view.minTime >= fromTime && view.maxTime < toTime;
+}
+
+} // namespace
+
+MatchRecord::MatchRecord()
+    : time(0)
+    , huUser(0)
+    , provideUser(INVALID_CHAIR)
+    , huCard(0) {
+    std::memset(huRight, 0, sizeof(huRight));
+    std::memset(huKind, 0, sizeof(huKind));
+    std::memset(weaveCount, 0, sizeof(weaveCount));
+    std::memset(maCard, 0, sizeof(maCard));
+    std::memset(score, 0, sizeof(score));
+}
+
+MatchRecord MatchRecord::fromGameEnd(const CMD_S_GameEnd& gameEnd, const std::string playerIds[GAME_PLAYER], uint32_t time) {
+    MatchRecord record;
+    record.time = time;
+    record.huUser = gameEnd.cbHuUser;
+    record.provideUser = gameEnd.cbProvideUser;
+    record.huCard = gameEnd.cbHuCard;
+    for (int s = 0; s < GAME_PLAYER; s++) {
+        record.playerIds[s] = playerIds[s];
+        record.huRight[s] = gameEnd.dwHuRight[s];
+        record.huKind[s] = gameEnd.cbHuKind[s];
+        record.weaveCount[s] = gameEnd.cbWeaveCount[s];
+        record.score[s] = gameEnd.lGameScore[s];
+    }
+    std::memcpy(record.maCard, gameEnd.cbMaCard, sizeof(record.maCard));
+    return record;
+}
+
+RuleStats::RuleStats() : hands(0), draws(0), winners(0), multiWins(0) {
+    std::memset(huRight, 0, sizeof(huRight));
+    std::memset(huKind, 0, sizeof(huKind));
+}
+
+MatchHistory::MatchHistory(const Config& config)
+    : config_(config)
+    , sealing_(false)
+    , playersFd_(-1)
+    , playersBase_(nullptr)
+    , playersUsed_(0)
+    , playersCapacity_(0)
+    , storedBytes_(0)
+    , sealedHands_(0)
+    , hands_(0)
+    , open_(false)
+    , stop_(false) {
+    config_.segmentRows = std::max(config_.segmentRows, kMinSegmentRows);
+}
+
+MatchHistory::~MatchHistory() {
+    close();
+}
+
+std::string MatchHistory::segmentPath(uint32_t seq) const {
+    char suffix[16];
+    std::snprintf(suffix, sizeof(suffix), ".%08u", seq);
+    return config_.path + suffix;
+}
+
+bool MatchHistory::open() {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    if (open_) {
+        return true;
+    }
+
+    // 玩家编号：文件按 kPlayersChunk 的倍数预留并映射，读到长度为 0 处为止
+    std::string playersPath = config_.path + ".players";
+    playersFd_ = ::open(playersPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    struct stat st;
+    if (playersFd_ < 0 || fstat(playersFd_, &st) != 0 || !mapPlayersLocked(static_cast<size_t>(st.st_size))) {
+        std::cout << "[MatchHistory] 无法打开玩家编号文件: " << playersPath << std::endl;
+        closePlayersLocked();
+        return false;
+    }
+    size_t pos = 0;
+    while (pos < playersCapacity_ && playersBase_[pos] != 0 && pos + 1 + playersBase_[pos] <= playersCapacity_) {
+        std::string playerId(reinterpret_cast<const char*>(playersBase_ + pos + 1), playersBase_[pos]);
+        playerIds_.push_back(playerId);
+        playerNumbers_[playerId] = static_cast<uint32_t>(playerIds_.size());
+        pos += 1 + playersBase_[pos];
+    }
+    playersUsed_ = pos;
+
+    // 段文件：<前缀>.<8 位序号>，中断的压缩留下的临时文件删掉（原文件仍完整）
+    std::string dir = ".";
+    std::string prefix = config_.path;
+    size_t slash = config_.path.rfind('/');
+    if (slash != std::string::npos) {
+        dir = config_.path.substr(0, slash);
+        prefix = config_.path.substr(slash + 1);
+        if (dir.empty()) {
+            dir = "/";
+        }
+    }
+    prefix += ".";
+    std::vector<uint32_t> seqs;
+    if (DIR* handle = opendir(dir.c_str())) {
+        while (dirent* entry = readdir(handle)) {
+            std::string name = entry->d_name;
+            if (name.size() < prefix.size() + 8 || name.compare(0, prefix.size(), prefix) != 0) {
+                continue;
+            }
+            std::string suffix = name.substr(prefix.size());
+            if (suffix.size() == 8 + 4 && suffix.compare(8, 4, ".tmp") == 0) {
+                unlink((dir + "/" + name).c_str());
+                continue;
+            }
+            if (suffix.size() == 8 && suffix.find_first_not_of("0123456789") == std::string::npos) {
+                seqs.push_back(static_cast<uint32_t>(std::strtoul(suffix.c_str(), nullptr, 10)));
+            }
+        }
+        closedir(handle);
+    }
+    std::sort(seqs.begin(), seqs.end());
+
+    uint32_t lastSeq = 0;
+    for (size_t i = 0; i < seqs.size(); i++) {
+        std::shared_ptr<HistorySegment> segment = mapSegment(segmentPath(seqs[i]), seqs[i]);
+        lastSeq = seqs[i];
+        if (!segment) {
+            std::cout << "[MatchHistory] 跳过无法读取的段: " << segmentPath(seqs[i]) << std::endl;
+            continue;
+        }
+        hands_ += segment->header->rows;
+        if (segment->sealed()) {
+            storedBytes_ += segment->bytes;
+            sealedHands_ += segment->header->rows;
+        } else if (i + 1 < seqs.size() || segment->header->rows == segment->header->capacity) {
+            pendingSeal_.push_back(segment->seq);
+        }
+        segments_.push_back(segment);
+    }
+    bool tailOpen = !segments_.empty() && segments_.back()->seq == lastSeq && !segments_.back()->sealed() &&
+                    segments_.back()->header->rows < segments_.back()->header->capacity;
+    if (!tailOpen && !openTailLocked(lastSeq + 1)) {
+        segments_.clear();
+        closePlayersLocked();
+        return false;
+    }
+    std::cout << "[MatchHistory] 打开 " << config_.path << "：" << segments_.size() << " 段，" << hands_ << " 局，"
+              << playerIds_.size() << " 位玩家" << std::endl;
+
+    open_ = true;
+    stop_ = false;
+    sealThread_ = std::thread(&MatchHistory::sealLoop, this);
+    if (!pendingSeal_.empty()) {
+        sealWake_.notify_one();
+    }
+    return true;
+}
+
+void MatchHistory::close() {
+    {
+        std::lock_guard<InstrumentedMutex> lock(mutex_);
+        if (!open_ && !sealThread_.joinable()) {
+            return;
+        }
+        open_ = false;
+        stop_ = true;
+    }
+    sealWake_.notify_one();
+    if (sealThread_.joinable()) {
+        sealThread_.join();
+    }
+
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    // 写入段：有数据就压缩，没有就删掉
+    if (!segments_.empty() && !segments_.back()->sealed()) {
+        std::shared_ptr<HistorySegment> tail = segments_.back();
+        std::string path = segmentPath(tail->seq);
+        if (tail->header->rows == 0) {
+            unlink(path.c_str());
+        } else if (writeSealed(*tail, tail->header->rows, path) == 0) {
+            std::cout << "[MatchHistory] 压缩段失败，保留未压缩的段: " << path << std::endl;
+        }
+    }
+    segments_.clear();
+    pendingSeal_.clear();
+    closePlayersLocked();
+    storedBytes_ = 0;
+    sealedHands_ = 0;
+    hands_ = 0;
+}
+
+bool MatchHistory::isOpen() const {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    return open_;
+}
+
+bool MatchHistory::openTailLocked(uint32_t seq) {
+    std::shared_ptr<HistorySegment> segment = createSegment(segmentPath(seq), seq, config_.segmentRows);
+    if (!segment) {
+        std::cout << "[MatchHistory] 无法创建段文件: " << segmentPath(seq) << std::endl;
+        return false;
+    }
+    segments_.push_back(segment);
+    return true;
+}
+
+bool MatchHistory::mapPlayersLocked(size_t bytes) {
+    size_t capacity = std::max(playersCapacity_, kPlayersChunk);
+    while (capacity < bytes) {
+        capacity *= 2;
+    }
+    if (playersBase_ != nullptr) {
+        munmap(playersBase_, playersCapacity_);
+        playersBase_ = nullptr;
+    }
+    struct stat st;
+    if (fstat(playersFd_, &st) != 0 || (static_cast<size_t>(st.st_size) < capacity && ftruncate(playersFd_, static_cast<off_t>(capacity)) != 0)) {
+        return false;
+    }
+    void* mapped = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, playersFd_, 0);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    playersBase_ = static_cast<uint8_t*>(mapped);
+    playersCapacity_ = capacity;
+    return true;
+}
+
+void MatchHistory::closePlayersLocked() {
+    if (playersBase_ != nullptr) {
+        munmap(playersBase_, playersCapacity_);
+        playersBase_ = nullptr;
+    }
+    if (playersFd_ >= 0) {
+        if (ftruncate(playersFd_, static_cast<off_t>(playersUsed_)) != 0) {
+            std::cout << "[MatchHistory] 截断玩家编号文件失败: " << config_.path << ".players" << std::endl;
+        }
+        ::close(playersFd_);
+        playersFd_ = -1;
+    }
+    playerNumbers_.clear();
+    playerIds_.clear();
+    playersUsed_ = 0;
+    playersCapacity_ = 0;
+}
+
+uint32_t MatchHistory::addPlayerLocked(const std::string& playerId) {
+    std::unordered_map<std::string, uint32_t>::const_iterator it = playerNumbers_.find(playerId);
+    if (it != playerNumbers_.end()) {
+        return it->second;
+    }
+    size_t entryBytes = 1 + playerId.size();
+    if (playersUsed_ + entryBytes > playersCapacity_ && !mapPlayersLocked(playersUsed_ + entryBytes)) {
+        std::cout << "[MatchHistory] 无法扩展玩家编号文件: " << config_.path << ".players" << std::endl;
+        return 0;
+    }
+    // 先写 id 再写长度，进程被杀时不完整的一条读作文件末尾
+    std::memcpy(playersBase_ + playersUsed_ + 1, playerId.data(), playerId.size());
+    playersBase_[playersUsed_] = static_cast<uint8_t>(playerId.size());
+    playersUsed_ += entryBytes;
+    playerIds_.push_back(playerId);
+    uint32_t number = static_cast<uint32_t>(playerIds_.size());
+    playerNumbers_[playerId] = number;
+    return number;
+}
+
+void MatchHistory::append(const MatchRecord& record) {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    if (!open_) {
+        return;
+    }
+    HistorySegment& tail = *segments_.back();
+    tagSegmentHeader& header = *tail.header;
+    uint32_t row = header.rows;
+    uint8_t* base = tail.base;
+    storeValue(base + header.column[Column_Time].offset, 4, row, record.time);
+    storeValue(base + header.column[Column_HuUser].offset, 1, row, record.huUser);
+    storeValue(base + header.column[Column_ProvideUser].offset, 1, row, record.provideUser);
+    storeValue(base + header.column[Column_HuCard].offset, 1, row, record.huCard);
+    for (int s = 0; s < GAME_PLAYER; s++) {
+        uint32_t player = record.playerIds[s].empty() ? 0 : addPlayerLocked(record.playerIds[s].substr(0, kMaxPlayerId));
+        storeValue(base + header.column[Column_Player + s].offset, 4, row, player);
+        storeValue(base + header.column[Column_HuRight + s].offset, 8, row, record.huRight[s]);
+        storeValue(base + header.column[Column_HuKind + s].offset, 1, row, record.huKind[s]);
+        storeValue(base + header.column[Column_Weave + s].offset, 1, row, record.weaveCount[s]);
+        storeValue(base + header.column[Column_Score + s].offset, 8, row, static_cast<uint64_t>(record.score[s]));
+    }
+    for (int m = 0; m < MAX_MA; m++) {
+        storeValue(base + header.column[Column_Ma + m].offset, 1, row, record.maCard[m]);
+    }
+    header.minTime = std::min(header.minTime, record.time);
+    header.maxTime = std::max(header.maxTime, record.time);
+    header.rows = row + 1;          // 行写完才计数，进程被杀时只会少最后一行
+    hands_++;
+
+    // 写满：交给后台线程压缩，换新段
+    if (header.rows == header.capacity) {
+        pendingSeal_.push_back(tail.seq);
+        sealWake_.notify_one();
+        if (!openTailLocked(tail.seq + 1)) {
+            open_ = false;
+        }
+    }
+}
+
+void MatchHistory::sealLoop() {
+    std::unique_lock<InstrumentedMutex> lock(mutex_);
+    while (true) {
+        sealWake_.wait(lock, [this] { return stop_ || !pendingSeal_.empty(); });
+        if (pendingSeal_.empty()) {
+            break;
+        }
+        uint32_t seq = pendingSeal_.front();
+        pendingSeal_.pop_front();
+        std::shared_ptr<HistorySegment> raw;
+        for (size_t i = 0; i < segments_.size(); i++) {
+            if (segments_[i]->seq == seq) {
+                raw = segments_[i];
+            }
+        }
+        if (!raw || raw->sealed()) {
+            continue;
+        }
+        sealing_ = true;
+        lock.unlock();
+        // 写满的段不再变化，锁外压缩；查询仍可读原来的映射，替换后最后一个快照释放时解除映射
+        std::string path = segmentPath(seq);
+        size_t bytes = writeSealed(*raw, raw->header->rows, path);
+        std::shared_ptr<HistorySegment> sealed = bytes > 0 ? mapSegment(path, seq) : nullptr;
+        lock.lock();
+        sealing_ = false;
+        if (sealed) {
+            for (size_t i = 0; i < segments_.size(); i++) {
+                if (segments_[i]->seq == seq) {
+                    segments_[i] = sealed;
+                }
+            }
+            storedBytes_ += sealed->bytes;
+            sealedHands_ += sealed->header->rows;
+        } else {
+            std::cout << "[MatchHistory] 压缩段失败，保留未压缩的段: " << path << std::endl;
+        }
+        sealed_.notify_all();
+    }
+}
+
+void MatchHistory::waitSealed() {
+    std::unique_lock<InstrumentedMutex> lock(mutex_);
+    sealed_.wait(lock, [this] { return !open_ || (pendingSeal_.empty() && !sealing_); });
+}
+
+void MatchHistory::snapshot(std::vector<SegmentView>& views) const {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    views.resize(segments_.size());
+    for (size_t i = 0; i < segments_.size(); i++) {
+        views[i].segment = segments_[i];
+        views[i].rows = segments_[i]->header->rows;
+        views[i].minTime = segments_[i]->header->minTime;
+        views[i].maxTime = segments_[i]->header->maxTime;
+    }
+}
+
+uint32_t MatchHistory::findPlayer(const std::string& playerId) const {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    std::unordered_map<std::string, uint32_t>::const_iterator it = playerNumbers_.find(playerId.substr(0, kMaxPlayerId));
+    return it != playerNumbers_.end() ? it->second : 0;
+}
+
+size_t MatchHistory::playerHistory(const std::string& playerId, size_t limit, std::vector<MatchRecord>& records) const {
+    records.clear();
+    uint32_t player = playerId.empty() ? 0 : findPlayer(playerId);
+    if (player == 0 || limit == 0) {
+        return 0;
+    }
+    std::vector<SegmentView> views;
+    snapshot(views);
+    std::vector<uint64_t> bits;
+    std::vector<uint32_t> numbers;
+    for (size_t i = views.size(); i-- > 0 && records.size() < limit;) {
+        const HistorySegment& segment = *views[i].segment;
+        uint32_t rows = views[i].rows;
+        bits.assign((rows + 63) / 64, 0);
+        for (int s = 0; s < GAME_PLAYER; s++) {
+            scanEqual(segment.columns[Column_Player + s], rows, player, bits.data());
+        }
+        for (size_t w = bits.size(); w-- > 0 && records.size() < limit;) {
+            for (uint64_t word = bits[w]; word != 0 && records.size() < limit;) {
+                int bit = 63 - __builtin_clzll(word);
+                word &= ~(1ULL << bit);
+                records.push_back(MatchRecord());
+                uint32_t players[GAME_PLAYER];
+                readRecord(segment, static_cast<uint32_t>(w * 64 + bit), records.back(), players);
+                numbers.insert(numbers.end(), players, players + GAME_PLAYER);
+            }
+        }
+    }
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    for (size_t r = 0; r < records.size(); r++) {
+        for (int s = 0; s < GAME_PLAYER; s++) {
+            uint32_t number = numbers[r * GAME_PLAYER + s];
+            if (number > 0 && number <= playerIds_.size()) {
+                records[r].playerIds[s] = playerIds_[number - 1];
+            }
+        }
+    }
+    return records.size();
+}
+
+PlayerTotals MatchHistory::playerTotals(const std::string& playerId, uint32_t fromTime, uint32_t toTime) const {
+    PlayerTotals totals;
+    uint32_t player = playerId.empty() ? 0 : findPlayer(playerId);
+    if (player == 0) {
+        return totals;
+    }
+    std::vector<SegmentView> views;
+    snapshot(views);
+    std::vector<uint64_t> bits;
+    for (size_t i = 0; i < views.size(); i++) {
+        if (!overlaps(views[i], fromTime, toTime)) {
+            continue;
+        }
+        const HistorySegment& segment = *views[i].segment;
+        uint32_t rows = views[i].rows;
+        bool covered = covers(views[i], fromTime, toTime);
+        for (int s = 0; s < GAME_PLAYER; s++) {
+            bits.assign((rows + 63) / 64, 0);
+            scanEqual(segment.columns[Column_Player + s], rows, player, bits.data());
+            for (size_t w = 0; w < bits.size(); w++) {
+                for (uint64_t word = bits[w]; word != 0; word &= word - 1) {
+                    uint32_t row = static_cast<uint32_t>(w * 64 + __builtin_ctzll(word));
+                    if (!covered) {
+                        uint32_t time = static_cast<uint32_t>(loadValue(segment.columns[Column_Time], row));
+                        if (time < fromTime || time >= toTime) {
+                            continue;
+                        }
+                    }
+                    totals.hands++;
+                    totals.score += static_cast<int64_t>(loadValue(segment.columns[Column_Score + s], row));
+                    uint64_t huUser = loadValue(segment.columns[Column_HuUser], row);
+                    if ((huUser & (1U << s)) != 0) {
+                        totals.wins++;
+                        if ((loadValue(segment.columns[Column_HuKind + s], row) & CHK_ZM) != 0) {
+                            totals.selfDrawn++;
+                        }
+                    } else if (huUser != 0 && loadValue(segment.columns[Column_ProvideUser], row) == static_cast<uint64_t>(s)) {
+                        totals.dealtIn++;
+                    }
+                }
+            }
+        }
+    }
+    return totals;
+}
+
+RuleStats MatchHistory::ruleStats(uint32_t fromTime, uint32_t toTime) const {
+    RuleStats stats;
+    std::vector<SegmentView> views;
+    snapshot(views);
+    for (size_t i = 0; i < views.size(); i++) {
+        if (!overlaps(views[i], fromTime, toTime)) {
+            continue;
+        }
+        const HistorySegment& segment = *views[i].segment;
+        uint32_t rows = views[i].rows;
+        if (covers(views[i], fromTime, toTime)) {
+            stats.hands += rows;
+            addRuleSegment(segment, rows, stats);
+            continue;
+        }
+        for (uint32_t row = 0; row < rows; row++) {
+            uint32_t time = static_cast<uint32_t>(loadValue(segment.columns[Column_Time], row));
+            if (time >= fromTime && time < toTime) {
+                stats.hands++;
+                addRuleRow(segment, row, stats);
+            }
+        }
+    }
+    return stats;
+}
+
+uint64_t MatchHistory::getHandCount() const {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    return hands_;
+}
+
+size_t MatchHistory::getSegmentCount() const {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    return segments_.size();
+}
+
+uint64_t MatchHistory::getStoredBytes() const {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    return storedBytes_;
+}
+
+uint64_t MatchHistory::getSealedHands() const {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    return sealedHands_;
+}
@@ -0,0 +1,143 @@
+//
+// MatchHistory.h
+// 对局历史：每局的结算结果按列存进内存映射的段文件，按玩家查历史、统计积分和胡牌规则
+//
+
+#ifndef MATCH_HISTORY_H
+#define MATCH_HISTORY_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "LockStats.h"
+#include "game/GameCmd.h"
+
+// 一局的结算结果
+struct MatchRecord {
+    uint32_t time;                              // 结束时间（Unix 秒）
+    std::string playerIds[GAME_PLAYER];         // 座位上的玩家，机器人为空
+    uint8_t huUser;                             // 胡牌人员，1 左移座位号
+    uint8_t provideUser;                        // 供应用户
+    uint8_t huCard;                             // 胡的牌
+    uint64_t huRight[GAME_PLAYER];              // 胡牌类型 CHR_
+    uint8_t huKind[GAME_PLAYER];                // 胡牌方式 CHK_
+    uint8_t weaveCount[GAME_PLAYER];            // 组合数量
+    uint8_t maCard[MAX_MA];                     // 扎鸟的牌
+    int64_t score[GAME_PLAYER];                 // 单局积分
+
+    MatchRecord();
+
+    // 由结算消息和座位上的玩家生成
+    static MatchRecord fromGameEnd(const CMD_S_GameEnd& gameEnd, const std::string playerIds[GAME_PLAYER], uint32_t time);
+};
+
+// 一位玩家的汇总
+struct PlayerTotals {
+    uint64_t hands;             // 参与的局数
+    uint64_t wins;              // 胡牌局数
+    uint64_t selfDrawn;         // 其中自摸
+    uint64_t dealtIn;           // 放炮局数
+    int64_t score;              // 积分合计
+
+    PlayerTotals() : hands(0), wins(0), selfDrawn(0), dealtIn(0), score(0) {}
+};
+
+// 胡牌规则统计
+struct RuleStats {
+    uint64_t hands;             // 局数
+    uint64_t draws;             // 流局（无人胡牌）
+    uint64_t winners;           // 胡牌人次（一炮多响计多次）
+    uint64_t multiWins;         // 一炮多响的局数
+    uint64_t huRight[64];       // 胡牌人次中 dwHuRight 每一位出现的次数
+    uint64_t huKind[8];         // 胡牌人次中 cbHuKind 每一位出现的次数
+
+    RuleStats();
+};
+
+struct HistorySegment;
+struct SegmentView;
+
+class MatchHistory {
+public:
+    struct Config {
+        std::string path;           // 文件路径前缀
+        uint32_t segmentRows;       // 每段的行数
+
+        Config() : segmentRows(256 * 1024) {}
+    };
+
+    explicit MatchHistory(const Config& config);
+    ~MatchHistory();                // 等同 close()
+
+    // 读取已有的段和玩家编号，未写满的最后一段继续追加；无法创建文件时返回 false
+    bool open();
+
+    // 压缩未写满的段后关闭
+    void close();
+
+    bool isOpen() const;
+    const Config& getConfig() const { return config_; }
+
+    // 追加一局（不等待压缩，写满时换段的那一次要创建新文件）
+    void append(const MatchRecord& record);
+
+    /**
+     * 玩家最近的对局，按时间从新到旧
+     * @param playerId
+     * @param limit 最多返回的局数
+     * @param records 输出
+     */
+    size_t playerHistory(const std::string& playerId, size_t limit, std::vector<MatchRecord>& records) const;
+
+    // 玩家在 [fromTime, toTime) 内的局数、胡牌和积分合计
+    PlayerTotals playerTotals(const std::string& playerId, uint32_t fromTime = 0, uint32_t toTime = UINT32_MAX) const;
+
+    // [fromTime, toTime) 内全部对局的胡牌规则统计
+    RuleStats ruleStats(uint32_t fromTime = 0, uint32_t toTime = UINT32_MAX) const;
+
+    void waitSealed();                      // 等待写满的段全部压缩完成
+    uint64_t getHandCount() const;          // 总局数
+    size_t getSegmentCount() const;
+    uint64_t getStoredBytes() const;        // 已压缩的段占用的字节数
+    uint64_t getSealedHands() const;        // 已压缩的段中的局数
+
+private:
+    // 取各段快照（写入中的段同时记下当前行数和时间范围）
+    void snapshot(std::vector<SegmentView>& views) const;
+    uint32_t findPlayer(const std::string& playerId) const;          // 未登记返回 0
+    uint32_t addPlayerLocked(const std::string& playerId);
+    bool mapPlayersLocked(size_t bytes);    // 把玩家编号文件扩到至少 bytes 字节并重新映射
+    void closePlayersLocked();
+    bool openTailLocked(uint32_t seq);      // 创建新的写入段（调用方持有 mutex_）
+    void sealLoop();
+    std::string segmentPath(uint32_t seq) const;
+
+    Config config_;
+    mutable InstrumentedMutex mutex_{"MatchHistory::mutex_"};   // 保护以下数据
+    std::condition_variable_any sealWake_;
+    std::condition_variable_any sealed_;
+    std::vector<std::shared_ptr<HistorySegment>> segments_;      // 按序号排列，最后一段为写入段
+    std::deque<uint32_t> pendingSeal_;      // 待压缩的段序号
+    bool sealing_;                          // 后台线程正在压缩
+    std::unordered_map<std::string, uint32_t> playerNumbers_;
+    std::vector<std::string> playerIds_;    // 编号 - 1 到 id
+    int playersFd_;
+    uint8_t* playersBase_;                  // 玩家编号文件的映射
+    size_t playersUsed_;
+    size_t playersCapacity_;
+    uint64_t storedBytes_;
+    uint64_t sealedHands_;
+    uint64_t hands_;
+    bool open_;
+    bool stop_;
+    std::thread sealThread_;
+};
+
+#endif // MATCH_HISTORY_H
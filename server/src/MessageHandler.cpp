@@ -8,6 +8,7 @@
 #include "Room.h"
 #include "NetPlayer.h"
 #include "JsonHelper.h"
+#include "ProfileCache.h"
 #include "game/GameLogic.h"  // 用于 WIK_* 常量
 #include <iostream>
 #include <sstream>
@@ -17,7 +18,8 @@
 // ========== MessageHandler 实现 ==========
 
 MessageHandler::MessageHandler(WebSocketServer* server)
-    : server_(server) {
+    : server_(server)
+    , profiles_(nullptr) {
 }
 
 void MessageHandler::setRoomManager(std::function<std::shared_ptr<Room>(const std::string& roomId)> getOrCreateRoom) {
@@ -36,6 +38,8 @@ void MessageHandler::handleMessage(int clientFd, const std::string& jsonText) {
         handlePlayCard(clientFd, jsonText);
     } else if (type == "choose_action") {
         handleChooseAction(clientFd, jsonText);
+    } else if (type == "save_settings") {
+        handleSaveSettings(clientFd, jsonText);
     } else {
         std::cout << "[MessageHandler] 未知消息类型: " << type << std::endl;
         sendError(clientFd, "UNKNOWN_TYPE", "未知的消息类型: " + type);
@@ -52,6 +56,14 @@ void MessageHandler::handleJoinRoom(int clientFd, const std::string& jsonText) {
         roomId = "room_" + std::to_string(clientFd);
     }
     
+    // 玩家档案（只查缓存）：命中时 nickname 可以不填，沿用档案里的昵称；未命中时由后台线程读进缓存，
+    // 这次按客户端给的昵称处理
+    PlayerProfile profile;
+    bool hasProfile = profiles_ != nullptr && !playerId.empty() && profiles_->get(playerId, profile);
+    if (nickname.empty() && hasProfile) {
+        nickname = profile.nickname;
+    }
+    
     if (playerId.empty() || nickname.empty()) {
         sendError(clientFd, "INVALID_PARAMS", "playerId 和 nickname 不能为空");
         return;
@@ -67,32 +79,61 @@ void MessageHandler::handleJoinRoom(int clientFd, const std::string& jsonText) {
     }
     
     auto room = getOrCreateRoom_(roomId);
-    
-    // 创建 NetPlayer（需要 clientFd 和 server 指针）
-    auto player = std::make_shared<NetPlayer>(playerId, clientFd, server_);
-    player->setNickname(nickname);
-    
-    // 添加到房间（Room 会自动分配座位）
-    if (!room->addPlayer(player)) {
-        sendError(clientFd, "ROOM_FULL", "房间已满或无法加入");
+    if (!room) {
+        sendError(clientFd, "ROOM_LIMIT", "房间数量已达上限，请稍后再试");
         return;
     }
     
+    // 游戏中掉线的玩家重连：收回机器人代打的座位；否则从对象池取出 NetPlayer（需要 clientFd 和 server 指针）
+    auto player = room->reconnectPlayer(playerId, clientFd, server_);
+    bool reconnected = player != nullptr;
+    if (!reconnected) {
+        player = playerPool_.acquire(playerId, clientFd, server_);
+        player->setNickname(nickname);
+        
+        // 添加到房间（Room 会自动分配座位）
+        if (!room->addPlayer(player)) {
+            sendError(clientFd, "ROOM_FULL", "房间已满或无法加入");
+            return;
+        }
+    }
+    
     int seat = player->getSeat();
     
+    // 当前是该客户端的线程：迁移到房间所在节点，同一房间的线程与房间数据在同一 NUMA 节点；
+    // 已按收包 CPU 绑定到单个 CPU 的线程不迁移，保留与网络收包的对齐
+    if (placement_.enabled && placement_.migrateToRoomNode
+        && room->getHomeNode() != ThreadPlacement::currentNode() && ThreadPlacement::pinnedCpu() < 0) {
+        ThreadPlacement::migrateCurrentThreadToNode(room->getHomeNode(), placement_.workerCpus);
+        std::cout << "[MessageHandler] 客户端线程迁移到房间所在节点 " << room->getHomeNode()
+                  << " (fd=" << clientFd << ")" << std::endl;
+    }
+    
     // 保存客户端信息
     ClientInfo info;
     info.room = room;
     info.playerId = playerId;
     info.nickname = nickname;
     info.seat = seat;
-    clients_[clientFd] = info;
+    {
+        std::lock_guard<InstrumentedMutex> lock(clientsMutex_);
+        clients_[clientFd] = info;
+    }
+    
+    // 昵称有变化时更新档案（只改缓存，后台线程写盘）
+    if (profiles_ != nullptr && (!hasProfile || profile.nickname != nickname)) {
+        profiles_->setNickname(playerId, nickname);
+        profile.nickname = nickname;
+    }
     
     // 向所有玩家发送更新后的房间信息
     sendRoomInfoToAll(room);
+    if (hasProfile) {
+        sendProfile(clientFd, profile);
+    }
     
-    // 如果房间有 4 个玩家，自动开始游戏
-    if (room->getPlayerCount() >= 4) {
+    // 如果房间有 4 个玩家，自动开始游戏（不足 4 人时由房间在等待超时后用机器人补位）
+    if (!reconnected && room->getPlayerCount() >= 4) {
         std::cout << "[MessageHandler] 房间已满，开始游戏" << std::endl;
         room->startGame();  // 使用真实的 GameEngine 启动游戏
         
@@ -103,15 +144,19 @@ void MessageHandler::handleJoinRoom(int clientFd, const std::string& jsonText) {
 }
 
 void MessageHandler::handlePlayCard(int clientFd, const std::string& jsonText) {
-    // 获取客户端信息
-    std::lock_guard<std::mutex> lock(clientsMutex_);
-    auto it = clients_.find(clientFd);
-    if (it == clients_.end()) {
-        sendError(clientFd, "NOT_IN_ROOM", "玩家未加入房间");
-        return;
+    // 获取客户端信息：只在 clientsMutex_ 内复制出来，房间里的出牌和机器人行动不持有全局锁
+    ClientInfo info;
+    {
+        std::lock_guard<InstrumentedMutex> lock(clientsMutex_);
+        auto it = clients_.find(clientFd);
+        if (it == clients_.end()) {
+            sendError(clientFd, "NOT_IN_ROOM", "玩家未加入房间");
+            return;
+        }
+        info = it->second;
     }
     
-    auto room = it->second.room;
+    auto room = info.room;
     if (!room) {
         sendError(clientFd, "ROOM_NOT_FOUND", "房间不存在");
         return;
@@ -131,42 +176,37 @@ void MessageHandler::handlePlayCard(int clientFd, const std::string& jsonText) {
     }
     
 #ifdef USE_GAME_ENGINE
-    // 调用 GameEngine 的出牌方法
-    auto gameEngine = room->getGameEngine();
-    if (!gameEngine) {
-        sendError(clientFd, "GAME_ENGINE_ERROR", "游戏引擎未初始化");
-        return;
-    }
-    
-    CMD_C_OutCard outCard;
-    outCard.cbCardData = static_cast<uint8_t>(card);
-    
-    if (gameEngine->onUserOutCard(outCard)) {
-        std::cout << "[MessageHandler] 玩家出牌成功: playerId=" << it->second.playerId 
+    // 经房间交给 GameEngine，之后机器人座位接着行动
+    if (room->onUserOutCard(info.seat, static_cast<uint8_t>(card))) {
+        std::cout << "[MessageHandler] 玩家出牌成功: playerId=" << info.playerId 
                   << ", card=" << card << std::endl;
     } else {
         sendError(clientFd, "PLAY_CARD_FAILED", "出牌失败");
     }
 #else
     // 未启用 GameEngine，使用简化版
-    std::cout << "[MessageHandler] 玩家出牌: playerId=" << it->second.playerId 
-              << ", seat=" << it->second.seat << ", card=" << card << std::endl;
-    std::string response = R"({"type":"player_play_card","seat":)" + std::to_string(it->second.seat)
+    std::cout << "[MessageHandler] 玩家出牌: playerId=" << info.playerId 
+              << ", seat=" << info.seat << ", card=" << card << std::endl;
+    std::string response = R"({"type":"player_play_card","seat":)" + std::to_string(info.seat)
                           + R"(,"card":)" + std::to_string(card) + "}";
     server_->sendText(clientFd, response);
 #endif
 }
 
 void MessageHandler::handleChooseAction(int clientFd, const std::string& jsonText) {
-    // 获取客户端信息
-    std::lock_guard<std::mutex> lock(clientsMutex_);
-    auto it = clients_.find(clientFd);
-    if (it == clients_.end()) {
-        sendError(clientFd, "NOT_IN_ROOM", "玩家未加入房间");
-        return;
+    // 获取客户端信息：只在 clientsMutex_ 内复制出来，房间里的动作和机器人行动不持有全局锁
+    ClientInfo info;
+    {
+        std::lock_guard<InstrumentedMutex> lock(clientsMutex_);
+        auto it = clients_.find(clientFd);
+        if (it == clients_.end()) {
+            sendError(clientFd, "NOT_IN_ROOM", "玩家未加入房间");
+            return;
+        }
+        info = it->second;
     }
     
-    auto room = it->second.room;
+    auto room = info.room;
     if (!room) {
         sendError(clientFd, "ROOM_NOT_FOUND", "房间不存在");
         return;
@@ -198,27 +238,16 @@ void MessageHandler::handleChooseAction(int clientFd, const std::string& jsonTex
     }
     
 #ifdef USE_GAME_ENGINE
-    // 调用 GameEngine 的操作方法
-    auto gameEngine = room->getGameEngine();
-    if (!gameEngine) {
-        sendError(clientFd, "GAME_ENGINE_ERROR", "游戏引擎未初始化");
-        return;
-    }
-    
-    CMD_C_OperateCard operateCard;
-    operateCard.cbOperateUser = static_cast<uint8_t>(it->second.seat);
-    operateCard.cbOperateCode = operateCode;
-    operateCard.cbOperateCard = static_cast<uint8_t>(card);
-    
-    if (gameEngine->onUserOperateCard(operateCard)) {
-        std::cout << "[MessageHandler] 玩家选择动作成功: playerId=" << it->second.playerId 
+    // 经房间交给 GameEngine，之后机器人座位接着行动
+    if (room->onUserOperateCard(info.seat, operateCode, static_cast<uint8_t>(card))) {
+        std::cout << "[MessageHandler] 玩家选择动作成功: playerId=" << info.playerId 
                   << ", action=" << action << ", card=" << card << std::endl;
     } else {
         sendError(clientFd, "ACTION_FAILED", "动作执行失败");
     }
 #else
     // 未启用 GameEngine，使用简化版
-    std::cout << "[MessageHandler] 玩家选择动作: playerId=" << it->second.playerId 
+    std::cout << "[MessageHandler] 玩家选择动作: playerId=" << info.playerId 
               << ", action=" << action << ", card=" << card << std::endl;
     std::string response = R"({"type":"action_confirmed","action":")" + action 
                           + R"(","card":)" + std::to_string(card) + "}";
@@ -226,6 +255,47 @@ void MessageHandler::handleChooseAction(int clientFd, const std::string& jsonTex
 #endif
 }
 
+void MessageHandler::handleSaveSettings(int clientFd, const std::string& jsonText) {
+    std::string playerId;
+    {
+        std::lock_guard<InstrumentedMutex> lock(clientsMutex_);
+        auto it = clients_.find(clientFd);
+        if (it == clients_.end()) {
+            sendError(clientFd, "NOT_IN_ROOM", "玩家未加入房间");
+            return;
+        }
+        playerId = it->second.playerId;
+    }
+    
+    if (profiles_ == nullptr) {
+        sendError(clientFd, "PROFILE_DISABLED", "服务器未开启玩家档案");
+        return;
+    }
+    
+    // getString 不解码转义，含反斜杠或控制字符的设置存下来无法原样取回，直接拒绝
+    std::string settings = JsonHelper::getString(jsonText, "settings");
+    for (char ch : settings) {
+        if (ch == '\\' || static_cast<unsigned char>(ch) < 0x20) {
+            sendError(clientFd, "INVALID_PARAMS", "settings 不能包含反斜杠或控制字符");
+            return;
+        }
+    }
+    
+    // 只改缓存，后台线程写盘
+    profiles_->setSettings(playerId, settings);
+    std::cout << "[MessageHandler] 保存设置: playerId=" << playerId << ", settings=" << settings << std::endl;
+}
+
+void MessageHandler::sendProfile(int clientFd, const PlayerProfile& profile) {
+    std::ostringstream oss;
+    // 昵称、设置由客户端提交，写进 JSON 前转义
+    oss << R"({"type":"profile","playerId":")" << JsonHelper::escape(profile.playerId)
+        << R"(","nickname":")" << JsonHelper::escape(profile.nickname)
+        << R"(","score":)" << profile.score
+        << R"(,"settings":")" << JsonHelper::escape(profile.settings) << "\"}";
+    server_->sendText(clientFd, oss.str());
+}
+
 void MessageHandler::sendRoomInfo(int clientFd, std::shared_ptr<Room> room) {
     std::ostringstream oss;
     
@@ -293,13 +363,10 @@ void MessageHandler::sendRoomInfoToAll(std::shared_ptr<Room> room) {
     oss << "]}";
     std::string roomInfoJson = oss.str();
     
-    // 向房间内所有玩家发送（线程安全）
-    {
-        std::lock_guard<std::mutex> lock(clientsMutex_);
-        for (auto& pair : clients_) {
-            if (pair.second.room == room) {
-                server_->sendText(pair.first, roomInfoJson);
-            }
+    // 向房间内所有玩家发送（按房间的玩家列表发送，不遍历全部连接）
+    for (const auto& player : players) {
+        if (player->isConnected()) {
+            server_->sendText(player->getClientFd(), roomInfoJson);
         }
     }
     
@@ -313,7 +380,7 @@ void MessageHandler::cleanupClient(int clientFd) {
     
     // 从客户端映射中获取信息并移除（线程安全）
     {
-        std::lock_guard<std::mutex> lock(clientsMutex_);
+        std::lock_guard<InstrumentedMutex> lock(clientsMutex_);
         auto it = clients_.find(clientFd);
         if (it == clients_.end()) {
             return;
@@ -332,7 +399,12 @@ void MessageHandler::cleanupClient(int clientFd) {
     
     // 从房间中移除玩家
     if (room) {
-        room->removePlayer(playerId);
+        // 连接即将关闭，游戏期间 GameEngine 仍持有该玩家，后续事件不再向此 fd 发送
+        room->detachClient(playerId);
+        // 游戏中掉线由机器人代打、保留座位等待重连，否则移出房间
+        if (!room->onPlayerDisconnect(playerId)) {
+            room->removePlayer(playerId);
+        }
         
         // 如果房间还有玩家，通知他们更新
         if (room->getPlayerCount() > 0) {
@@ -12,9 +12,14 @@
 #include <map>
 #include <mutex>
 #include "JsonHelper.h"
+#include "LockStats.h"
+#include "NetPlayerPool.h"
+#include "ThreadPlacement.h"
 
 class Room;
 class WebSocketServer;
+class ProfileCache;
+struct PlayerProfile;
 
 class MessageHandler {
 public:
@@ -29,6 +34,12 @@ public:
     // 清理客户端信息（当客户端断开时调用）
     void cleanupClient(int clientFd);
     
+    // 设置线程放置策略（加入房间后是否迁移到房间所在的 NUMA 节点）
+    void setPlacement(const PlacementConfig& placement) { placement_ = placement; }
+    
+    // 设置玩家档案缓存（nullptr 为不用档案）：join_room 时取档案、更新昵称，save_settings 保存设置
+    void setProfileCache(ProfileCache* profiles) { profiles_ = profiles; }
+    
 private:
     WebSocketServer* server_;
     std::function<std::shared_ptr<Room>(const std::string&)> getOrCreateRoom_;
@@ -41,16 +52,21 @@ private:
         int seat;
     };
     std::map<int, ClientInfo> clients_;
-    std::mutex clientsMutex_;  // 保护 clients_ 的访问
+    InstrumentedMutex clientsMutex_{"MessageHandler::clientsMutex_"};  // 保护 clients_ 的访问
+    NetPlayerPool playerPool_; // NetPlayer 对象池，join_room 时复用
+    PlacementConfig placement_;
+    ProfileCache* profiles_;   // 玩家档案，只访问缓存，不等待磁盘
     
     // 消息处理函数
     void handleJoinRoom(int clientFd, const std::string& jsonText);
     void handlePlayCard(int clientFd, const std::string& jsonText);
     void handleChooseAction(int clientFd, const std::string& jsonText);
+    void handleSaveSettings(int clientFd, const std::string& jsonText);
     
     // 发送响应消息
     void sendRoomInfo(int clientFd, std::shared_ptr<Room> room);
     void sendRoomInfoToAll(std::shared_ptr<Room> room);
+    void sendProfile(int clientFd, const PlayerProfile& profile);
     void sendError(int clientFd, const std::string& code, const std::string& message);
 };
 
@@ -2,7 +2,41 @@
 #include "WebSocketServer.h"
 #include "JsonHelper.h"
 #include <iostream>
-#include <sstream>
+
+namespace {
+
+const size_t kBufferReserve = 2048; // 最长的消息（结算、重连牌面含各家出牌记录）也不用扩容
+
+// 数字直接写进缓冲区，不经过 ostringstream（每次构造都会分配）
+void appendUint(std::string& out, uint64_t value) {
+    char digits[24];
+    size_t n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (n > 0) {
+        out += digits[--n];
+    }
+}
+
+void appendInt(std::string& out, int64_t value) {
+    if (value < 0) {
+        out += '-';
+        appendUint(out, 0 - static_cast<uint64_t>(value));
+    } else {
+        appendUint(out, static_cast<uint64_t>(value));
+    }
+}
+
+void appendCards(std::string& out, const uint8_t* cards, int count) {
+    for (int i = 0; i < count; i++) {
+        if (i > 0) out += ',';
+        appendInt(out, cards[i]);
+    }
+}
+
+} // namespace
 
 NetPlayer::NetPlayer(const std::string& playerId, int clientFd, WebSocketServer* server)
     : IPlayer(false, IPlayer::MALE, this)  // 不是机器人，默认男性
@@ -10,6 +44,17 @@ NetPlayer::NetPlayer(const std::string& playerId, int clientFd, WebSocketServer*
     , clientFd_(clientFd)
     , server_(server)
     , seat_(-1) {
+    buffer_.reserve(kBufferReserve);
+    setGameEngineEventListener(this);
+}
+
+void NetPlayer::reset(const std::string& playerId, int clientFd, WebSocketServer* server) {
+    playerId_ = playerId;
+    nickname_.clear();
+    clientFd_ = clientFd;
+    server_ = server;
+    seat_ = -1;
+    m_Android = false;
     setGameEngineEventListener(this);
 }
 
@@ -22,14 +67,22 @@ bool NetPlayer::onUserEnterEvent(IPlayer *pIPlayer) {
     return true;
 }
 
-bool NetPlayer::onGameStartEvent(CMD_S_GameStart GameStart) {
+bool NetPlayer::onGameStartEvent(const CMD_S_GameStart &GameStart) {
     // 游戏开始事件
-    std::ostringstream oss;
-    oss << R"({"type":"game_start","diceCount":)" << GameStart.iDiceCount
-        << R"(,"bankerUser":)" << static_cast<int>(GameStart.cbBankerUser)
-        << R"(,"currentUser":)" << static_cast<int>(GameStart.cbCurrentUser)
-        << R"(,"leftCardCount":)" << static_cast<int>(GameStart.cbLeftCardCount)
-        << R"(,"cards":[)";
+    if (!isConnected()) {
+        return true;    // 连接已断开，不再编码消息
+    }
+    std::string& out = buffer_;
+    out.clear();
+    out += R"({"type":"game_start","diceCount":)";
+    appendInt(out, GameStart.iDiceCount);
+    out += R"(,"bankerUser":)";
+    appendInt(out, GameStart.cbBankerUser);
+    out += R"(,"currentUser":)";
+    appendInt(out, GameStart.cbCurrentUser);
+    out += R"(,"leftCardCount":)";
+    appendInt(out, GameStart.cbLeftCardCount);
+    out += R"(,"cards":[)";
     
     // 发送手牌（只发送当前玩家的牌）
     // 注意：GameEngine 在 onGameStart 中，对每个玩家调用 onGameStartEvent 时，
@@ -43,8 +96,8 @@ bool NetPlayer::onGameStartEvent(CMD_S_GameStart GameStart) {
         // 检查是否为有效牌（麻将牌范围：0x01-0x37，即 1-55）
         // 0x00 表示空位，0x38-0xFF 为无效值
         if (card >= 0x01 && card <= 0x37) {
-            if (!first) oss << ",";
-            oss << static_cast<int>(card);
+            if (!first) out += ',';
+            appendInt(out, card);
             first = false;
             validCardCount++;
         } else if (card == 0) {
@@ -58,109 +111,208 @@ bool NetPlayer::onGameStartEvent(CMD_S_GameStart GameStart) {
         std::cout << "[NetPlayer] 警告：玩家 " << playerId_ << " 未收到有效手牌" << std::endl;
     }
     
-    oss << "]}";
-    sendJson(oss.str());
+    out += "]}";
+    sendJson(out);
     return true;
 }
 
-bool NetPlayer::onSendCardEvent(CMD_S_SendCard SendCard) {
+bool NetPlayer::onSendCardEvent(const CMD_S_SendCard &SendCard) {
     // 发牌事件
-    std::ostringstream oss;
-    oss << R"({"type":"deal_cards","card":)" << static_cast<int>(SendCard.cbCardData)
-        << R"(,"actionMask":)" << static_cast<int>(SendCard.cbActionMask)
-        << R"(,"currentUser":)" << static_cast<int>(SendCard.cbCurrentUser)
-        << R"(,"isTail":)" << (SendCard.bTail ? "true" : "false");
+    if (!isConnected()) {
+        return true;    // 连接已断开，不再编码消息
+    }
+    std::string& out = buffer_;
+    out.clear();
+    out += R"({"type":"deal_cards","card":)";
+    appendInt(out, SendCard.cbCardData);
+    out += R"(,"actionMask":)";
+    appendInt(out, SendCard.cbActionMask);
+    out += R"(,"currentUser":)";
+    appendInt(out, SendCard.cbCurrentUser);
+    out += R"(,"isTail":)";
+    out += SendCard.bTail ? "true" : "false";
     
     if (SendCard.cbGangCount > 0) {
-        oss << R"(,"gangCount":)" << static_cast<int>(SendCard.cbGangCount)
-            << R"(,"gangCards":[)";
-        bool first = true;
-        for (int i = 0; i < SendCard.cbGangCount; i++) {
-            if (!first) oss << ",";
-            oss << static_cast<int>(SendCard.cbGangCard[i]);
-            first = false;
-        }
-        oss << "]";
+        out += R"(,"gangCount":)";
+        appendInt(out, SendCard.cbGangCount);
+        out += R"(,"gangCards":[)";
+        appendCards(out, SendCard.cbGangCard, SendCard.cbGangCount);
+        out += ']';
     }
     
-    oss << "}";
-    sendJson(oss.str());
+    out += '}';
+    sendJson(out);
     return true;
 }
 
-bool NetPlayer::onOutCardEvent(CMD_S_OutCard OutCard) {
+bool NetPlayer::onOutCardEvent(const CMD_S_OutCard &OutCard) {
     // 出牌事件
-    std::ostringstream oss;
-    oss << R"({"type":"player_play_card","seat":)" << static_cast<int>(OutCard.cbOutCardUser)
-        << R"(,"card":)" << static_cast<int>(OutCard.cbOutCardData) << "}";
-    sendJson(oss.str());
+    if (!isConnected()) {
+        return true;    // 连接已断开，不再编码消息
+    }
+    std::string& out = buffer_;
+    out.clear();
+    out += R"({"type":"player_play_card","seat":)";
+    appendInt(out, OutCard.cbOutCardUser);
+    out += R"(,"card":)";
+    appendInt(out, OutCard.cbOutCardData);
+    out += '}';
+    sendJson(out);
     return true;
 }
 
-bool NetPlayer::onOperateNotifyEvent(CMD_S_OperateNotify OperateNotify) {
+bool NetPlayer::onOperateNotifyEvent(const CMD_S_OperateNotify &OperateNotify) {
     // 操作通知事件（询问是否可以吃碰杠胡）
+    if (!isConnected()) {
+        return true;    // 连接已断开，不再编码消息
+    }
     if (seat_ == OperateNotify.cbResumeUser) {
         // 只通知当前玩家
-        std::ostringstream oss;
-        oss << R"({"type":"ask_action","actionMask":)" << static_cast<int>(OperateNotify.cbActionMask)
-            << R"(,"actionCard":)" << static_cast<int>(OperateNotify.cbActionCard);
+        std::string& out = buffer_;
+        out.clear();
+        out += R"({"type":"ask_action","actionMask":)";
+        appendInt(out, OperateNotify.cbActionMask);
+        out += R"(,"actionCard":)";
+        appendInt(out, OperateNotify.cbActionCard);
         
         if (OperateNotify.cbGangCount > 0) {
-            oss << R"(,"gangCount":)" << static_cast<int>(OperateNotify.cbGangCount)
-                << R"(,"gangCards":[)";
-            bool first = true;
-            for (int i = 0; i < OperateNotify.cbGangCount; i++) {
-                if (!first) oss << ",";
-                oss << static_cast<int>(OperateNotify.cbGangCard[i]);
-                first = false;
-            }
-            oss << "]";
+            out += R"(,"gangCount":)";
+            appendInt(out, OperateNotify.cbGangCount);
+            out += R"(,"gangCards":[)";
+            appendCards(out, OperateNotify.cbGangCard, OperateNotify.cbGangCount);
+            out += ']';
         }
         
-        oss << "}";
-        sendJson(oss.str());
+        out += '}';
+        sendJson(out);
     }
     return true;
 }
 
-bool NetPlayer::onOperateResultEvent(CMD_S_OperateResult OperateResult) {
+bool NetPlayer::onOperateResultEvent(const CMD_S_OperateResult &OperateResult) {
     // 操作结果事件
-    std::ostringstream oss;
-    oss << R"({"type":"action_result","operateUser":)" << static_cast<int>(OperateResult.cbOperateUser)
-        << R"(,"provideUser":)" << static_cast<int>(OperateResult.cbProvideUser)
-        << R"(,"operateCode":)" << static_cast<int>(OperateResult.cbOperateCode)
-        << R"(,"operateCard":)" << static_cast<int>(OperateResult.cbOperateCard) << "}";
-    sendJson(oss.str());
+    if (!isConnected()) {
+        return true;    // 连接已断开，不再编码消息
+    }
+    std::string& out = buffer_;
+    out.clear();
+    out += R"({"type":"action_result","operateUser":)";
+    appendInt(out, OperateResult.cbOperateUser);
+    out += R"(,"provideUser":)";
+    appendInt(out, OperateResult.cbProvideUser);
+    out += R"(,"operateCode":)";
+    appendInt(out, OperateResult.cbOperateCode);
+    out += R"(,"operateCard":)";
+    appendInt(out, OperateResult.cbOperateCard);
+    out += '}';
+    sendJson(out);
     return true;
 }
 
-bool NetPlayer::onGameEndEvent(CMD_S_GameEnd GameEnd) {
+bool NetPlayer::onGameEndEvent(const CMD_S_GameEnd &GameEnd) {
     // 游戏结束事件
-    std::ostringstream oss;
-    oss << R"({"type":"round_result","huUser":)" << static_cast<int>(GameEnd.cbHuUser)
-        << R"(,"provideUser":)" << static_cast<int>(GameEnd.cbProvideUser)
-        << R"(,"huCard":)" << static_cast<int>(GameEnd.cbHuCard)
-        << R"(,"scores":[)";
+    if (!isConnected()) {
+        return true;    // 连接已断开，不再编码消息
+    }
+    std::string& out = buffer_;
+    out.clear();
+    out += R"({"type":"round_result","huUser":)";
+    appendInt(out, GameEnd.cbHuUser);
+    out += R"(,"provideUser":)";
+    appendInt(out, GameEnd.cbProvideUser);
+    out += R"(,"huCard":)";
+    appendInt(out, GameEnd.cbHuCard);
+    out += R"(,"scores":[)";
     
-    bool first = true;
     for (int i = 0; i < GAME_PLAYER; i++) {
-        if (!first) oss << ",";
-        oss << R"({"seat":)" << i
-            << R"(,"score":)" << GameEnd.lGameScore[i]
-            << R"(,"huRight":)" << GameEnd.dwHuRight[i]
-            << R"(,"huKind":)" << static_cast<int>(GameEnd.cbHuKind[i])
-            << "}";
-        first = false;
+        if (i > 0) out += ',';
+        out += R"({"seat":)";
+        appendInt(out, i);
+        out += R"(,"score":)";
+        appendInt(out, GameEnd.lGameScore[i]);
+        out += R"(,"huRight":)";
+        appendUint(out, GameEnd.dwHuRight[i]);
+        out += R"(,"huKind":)";
+        appendInt(out, GameEnd.cbHuKind[i]);
+        out += '}';
     }
     
-    oss << "]}";
-    sendJson(oss.str());
+    out += "]}";
+    sendJson(out);
     return true;
 }
 
+void NetPlayer::sendGameResume(const tagGameState &State) {
+    if (!isConnected() || seat_ < 0 || seat_ >= GAME_PLAYER) {
+        return;
+    }
+    std::string& out = buffer_;
+    out.clear();
+    out += R"({"type":"game_resume","seat":)";
+    appendInt(out, seat_);
+    out += R"(,"bankerUser":)";
+    appendInt(out, State.cbBankerUser);
+    out += R"(,"currentUser":)";
+    appendInt(out, State.cbCurrentUser);
+    out += R"(,"leftCardCount":)";
+    appendInt(out, State.cbLeftCardCount);
+    out += R"(,"cards":[)";
+    bool first = true;
+    for (uint8_t j = 0; j < MAX_INDEX; j++) {
+        for (uint8_t n = 0; n < State.cbCardIndex[seat_][j]; n++) {
+            if (!first) out += ',';
+            appendInt(out, GameLogic::switchToCardData(j));
+            first = false;
+        }
+    }
+    out += R"(],"weaves":[)";
+    first = true;
+    for (int i = 0; i < GAME_PLAYER; i++) {
+        for (int j = 0; j < State.cbWeaveItemCount[i]; j++) {
+            if (!first) out += ',';
+            out += R"({"seat":)";
+            appendInt(out, i);
+            out += R"(,"kind":)";
+            appendInt(out, State.WeaveItemArray[i][j].cbWeaveKind);
+            out += R"(,"card":)";
+            appendInt(out, State.WeaveItemArray[i][j].cbCenterCard);
+            out += '}';
+            first = false;
+        }
+    }
+    // 各家的手牌张数和出牌记录；刚打出、还没进出牌记录的那张（等待响应）排在该座位末尾
+    out += R"(],"handCount":[)";
+    for (int i = 0; i < GAME_PLAYER; i++) {
+        int count = 0;
+        for (uint8_t j = 0; j < MAX_INDEX; j++) {
+            count += State.cbCardIndex[i][j];
+        }
+        if (i > 0) out += ',';
+        appendInt(out, count);
+    }
+    out += R"(],"discards":[)";
+    for (int i = 0; i < GAME_PLAYER; i++) {
+        if (i > 0) out += ',';
+        out += '[';
+        appendCards(out, State.cbDiscardCard[i], State.cbDiscardCount[i]);
+        if (State.cbOutCardUser == i && State.cbOutCardData != 0) {
+            if (State.cbDiscardCount[i] > 0) out += ',';
+            appendInt(out, State.cbOutCardData);
+        }
+        out += ']';
+    }
+    out += R"(],"provideUser":)";
+    appendInt(out, State.cbProvideUser == INVALID_CHAIR ? -1 : State.cbProvideUser);
+    out += R"(,"provideCard":)";
+    appendInt(out, State.cbProvideCard);
+    out += '}';
+    sendJson(out);
+}
+
 void NetPlayer::sendJson(const std::string& json) {
-    if (server_ && clientFd_ > 0) {
-        server_->sendText(clientFd_, json);
+    int clientFd = clientFd_.load();    // 只读一次，解除绑定后不会用 -1 以外的旧值
+    if (server_ && clientFd > 0) {
+        server_->sendText(clientFd, json);
         std::cout << "[NetPlayer] 发送消息到 " << playerId_ << ": " << json << std::endl;
     }
-}
\ No newline at end of file
+}
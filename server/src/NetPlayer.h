@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <cstdint>
@@ -16,6 +17,14 @@ public:
     explicit NetPlayer(const std::string& playerId, int clientFd, WebSocketServer* server);
     ~NetPlayer() override = default;
 
+    // 重新绑定到新的玩家连接（对象池复用）
+    void reset(const std::string& playerId, int clientFd, WebSocketServer* server);
+
+    // 连接断开后解除与客户端的绑定，之后的事件不再发送（入座后由 Room::detachClient 在房间锁内调用，
+    // 与事件的发送互斥，连接关闭后不会再向可能被复用的 fd 发送）
+    void detachClient() { clientFd_.store(-1); }
+    bool isConnected() const { return server_ != nullptr && clientFd_.load() > 0; }
+
     const std::string& getPlayerId() const { return playerId_; }
     
     void setNickname(const std::string& nickname) { nickname_ = nickname; }
@@ -27,24 +36,28 @@ public:
     }
     int getSeat() const { return seat_; }
     
-    int getClientFd() const { return clientFd_; }
+    int getClientFd() const { return clientFd_.load(); }
 
     // IGameEngineEventListener 接口实现
     void setIPlayer(IPlayer *pIPlayer) override;
     bool onUserEnterEvent(IPlayer *pIPlayer) override;
-    bool onGameStartEvent(CMD_S_GameStart GameStart) override;
-    bool onSendCardEvent(CMD_S_SendCard SendCard) override;
-    bool onOutCardEvent(CMD_S_OutCard OutCard) override;
-    bool onOperateNotifyEvent(CMD_S_OperateNotify OperateNotify) override;
-    bool onOperateResultEvent(CMD_S_OperateResult OperateResult) override;
-    bool onGameEndEvent(CMD_S_GameEnd GameEnd) override;
+    bool onGameStartEvent(const CMD_S_GameStart &GameStart) override;
+    bool onSendCardEvent(const CMD_S_SendCard &SendCard) override;
+    bool onOutCardEvent(const CMD_S_OutCard &OutCard) override;
+    bool onOperateNotifyEvent(const CMD_S_OperateNotify &OperateNotify) override;
+    bool onOperateResultEvent(const CMD_S_OperateResult &OperateResult) override;
+    bool onGameEndEvent(const CMD_S_GameEnd &GameEnd) override;
+
+    // 重连后发送当前牌面（手牌、各家碰杠、当前玩家、剩余牌数），之后照常接收事件
+    void sendGameResume(const tagGameState &State);
 
 private:
     std::string playerId_;
     std::string nickname_;
     int seat_;
-    int clientFd_;  // WebSocket 客户端文件描述符
+    std::atomic<int> clientFd_;  // WebSocket 客户端文件描述符（网络线程解除绑定时与房间线程并发读取）
     WebSocketServer* server_;  // 用于发送消息
+    std::string buffer_;  // 事件消息的编码缓冲区，复用容量（事件都在房间锁内送达）
     
     // 发送 JSON 消息到客户端
     void sendJson(const std::string& json);
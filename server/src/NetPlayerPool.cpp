@@ -0,0 +1,55 @@
+//
+// NetPlayerPool.cpp
+// NetPlayer 对象池实现
+//
+
+#include "NetPlayerPool.h"
+#include "NetPlayer.h"
+
+#include <atomic>
+
+NetPlayerPool::NetPlayerPool(size_t preallocated)
+    : cursor_(0) {
+    players_.reserve(preallocated);
+    for (size_t i = 0; i < preallocated; i++) {
+        players_.push_back(std::make_shared<NetPlayer>("", -1, nullptr));
+    }
+}
+
+std::shared_ptr<NetPlayer> NetPlayerPool::acquire(const std::string& playerId, int clientFd, WebSocketServer* server) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // 只有池本身能复制出新的引用，所以 use_count() == 1 时对象一定空闲；
+    // 每次最多扫描 kMaxScan 个，大量玩家同时在线时不会退化成对整个池的线性扫描
+    size_t scan = players_.size() < kMaxScan ? players_.size() : kMaxScan;
+    for (size_t n = 0; n < scan; n++) {
+        size_t i = (cursor_ + n) % players_.size();
+        if (players_[i].use_count() == 1) {
+            // use_count() 是宽松读取，与上一个持有者释放引用时的写入建立同步
+            std::atomic_thread_fence(std::memory_order_acquire);
+            cursor_ = (i + 1) % players_.size();
+            players_[i]->reset(playerId, clientFd, server);
+            return players_[i];
+        }
+    }
+    if (!players_.empty()) {
+        cursor_ = (cursor_ + scan) % players_.size();     // 下次从未扫描过的位置开始
+    }
+    players_.push_back(std::make_shared<NetPlayer>(playerId, clientFd, server));
+    return players_.back();
+}
+
+size_t NetPlayerPool::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return players_.size();
+}
+
+size_t NetPlayerPool::inUse() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t count = 0;
+    for (size_t i = 0; i < players_.size(); i++) {
+        if (players_[i].use_count() > 1) {
+            count++;
+        }
+    }
+    return count;
+}
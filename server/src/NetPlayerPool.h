@@ -0,0 +1,35 @@
+//
+// NetPlayerPool.h
+// NetPlayer 对象池：join_room 时复用预先创建的玩家对象，不再每次 make_shared
+//
+
+#ifndef NET_PLAYER_POOL_H
+#define NET_PLAYER_POOL_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class NetPlayer;
+class WebSocketServer;
+
+class NetPlayerPool {
+public:
+    explicit NetPlayerPool(size_t preallocated = 256);
+
+    // 取出一个空闲的 NetPlayer 并绑定到指定连接
+    std::shared_ptr<NetPlayer> acquire(const std::string& playerId, int clientFd, WebSocketServer* server);
+
+    size_t size() const;        // 池中对象总数
+    size_t inUse() const;       // 正在使用的对象数
+
+private:
+    static const size_t kMaxScan = 64;
+
+    mutable std::mutex mutex_;
+    std::vector<std::shared_ptr<NetPlayer>> players_;
+    size_t cursor_;             // 下一次开始扫描的位置
+};
+
+#endif // NET_PLAYER_POOL_H
@@ -0,0 +1,922 @@
+//
+// ProfileCache.cpp
+// 玩家档案缓存实现
+//
+// 日志文件格式（本机字节序）：
+//   文件头 8 字节：魔数、版本、保留；
+//   之后每条记录：校验（其后全部字节的 FNV-1a）、记录长度、id 长度、昵称长度、设置长度、保留、
+//   累计积分、修改时间（共 28 字节），再接 id、昵称和设置。同一玩家以最后一条为准。
+//
+// 分片锁只在游戏路径上短暂持有；后台线程是唯一读写日志、修改记录位置的线程，读档案时不持分片锁。
+//
+
+#include "ProfileCache.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const uint32_t kProfileMagic = 0x46504D4DU;         // "MMPF"
+const uint16_t kProfileVersion = 1;
+const size_t kFileHeaderSize = 8;
+const size_t kRecordHeaderSize = 28;
+const size_t kMaxIdLength = 255;
+const size_t kMaxTextLength = 65535;
+const uint64_t kNotStored = UINT64_MAX;
+const size_t kFileBuffer = 1024 * 1024;
+const size_t kEvictScan = 16;                       // 游戏路径淘汰时从表尾最多看几份（跳过未写盘的）
+const int kSweepScan = 64;                          // 每次写盘后每个分片从表尾检查过期的份数
+const size_t kMinTableSize = 64;
+
+inline uint64_t hashOf(const std::string& playerId) {
+    return std::hash<std::string>()(playerId);
+}
+
+// 缓存表的位置取哈希的高位（低位用来选分片）
+inline size_t tableIndex(uint64_t hash, size_t mask) {
+    return static_cast<size_t>((hash * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+}
+
+uint32_t fnv1a(const uint8_t* data, size_t size) {
+    uint32_t hash = 2166136261U;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 16777619U;
+    }
+    return hash;
+}
+
+template <typename T>
+void putValue(std::string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+T getValue(const uint8_t* data) {
+    T value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+// 在 out 末尾编一条记录
+void encodeRecord(const PlayerProfile& profile, std::string& out) {
+    size_t begin = out.size();
+    uint32_t size = static_cast<uint32_t>(kRecordHeaderSize + profile.playerId.size() + profile.nickname.size()
+                                          + profile.settings.size());
+    putValue<uint32_t>(out, 0);
+    putValue<uint32_t>(out, size);
+    putValue<uint16_t>(out, static_cast<uint16_t>(profile.playerId.size()));
+    putValue<uint16_t>(out, static_cast<uint16_t>(profile.nickname.size()));
+    putValue<uint16_t>(out, static_cast<uint16_t>(profile.settings.size()));
+    putValue<uint16_t>(out, 0);
+    putValue<int64_t>(out, profile.score);
+    putValue<uint32_t>(out, profile.updatedAt);
+    out += profile.playerId;
+    out += profile.nickname;
+    out += profile.settings;
+    uint32_t checksum = fnv1a(reinterpret_cast<const uint8_t*>(out.data()) + begin + 4, size - 4);
+    std::memcpy(&out[begin], &checksum, sizeof(checksum));
+}
+
+// 检查 data 开头的一条记录，返回记录长度（不完整或校验不符时为 0），profile 不为空时填入
+uint32_t decodeRecord(const uint8_t* data, size_t available, PlayerProfile* profile) {
+    if (available < kRecordHeaderSize) {
+        return 0;
+    }
+    uint32_t size = getValue<uint32_t>(data + 4);
+    uint16_t idLength = getValue<uint16_t>(data + 8);
+    uint16_t nicknameLength = getValue<uint16_t>(data + 10);
+    uint16_t settingsLength = getValue<uint16_t>(data + 12);
+    if (size > available || size != kRecordHeaderSize + idLength + nicknameLength + settingsLength || idLength == 0
+        || fnv1a(data + 4, size - 4) != getValue<uint32_t>(data)) {
+        return 0;
+    }
+    if (profile != nullptr) {
+        const char* text = reinterpret_cast<const char*>(data + kRecordHeaderSize);
+        profile->score = getValue<int64_t>(data + 16);
+        profile->updatedAt = getValue<uint32_t>(data + 24);
+        profile->playerId.assign(text, idLength);
+        profile->nickname.assign(text + idLength, nicknameLength);
+        profile->settings.assign(text + idLength + nicknameLength, settingsLength);
+    }
+    return size;
+}
+
+bool writeFully(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+std::string fileHeader() {
+    std::string header;
+    putValue<uint32_t>(header, kProfileMagic);
+    putValue<uint16_t>(header, kProfileVersion);
+    putValue<uint16_t>(header, 0);
+    return header;
+}
+
+} // namespace
+
+struct ProfileCache::Shard {
+    // 缓存表的一项：线性探测，空项 node 为 nullptr
+    struct Entry {
+        uint64_t hash;
+        Node* node;
+    };
+
+    InstrumentedMutex mutex{"ProfileCache::Shard::mutex"};
+    std::vector<Entry> table;                       // 缓存的档案，至少一半为空
+    size_t tableMask;
+    std::unordered_map<std::string, Slot> slots;    // 所有登记的玩家
+    Node head;                                      // LRU 哨兵：head.next 最近放进来的
+    size_t cached;
+    std::vector<Node*> dirty;                       // 等待写盘的档案
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    char padding[64];                               // 相邻分片的锁不在同一缓存行
+
+    Shard() : tableMask(0), cached(0), hits(0), misses(0), evictions(0) {
+        head.prev = &head;
+        head.next = &head;
+        head.slot = nullptr;
+        head.dirty = false;
+        head.version = 0;
+    }
+
+    ~Shard() {
+        Node* node = head.next;
+        while (node != &head) {
+            Node* next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+};
+
+ProfileCache::Stats::Stats()
+    : hits(0), misses(0), loads(0), evictions(0), written(0), batches(0), compactions(0), players(0), cached(0)
+    , logBytes(0), liveBytes(0) {
+}
+
+ProfileCache::Slot::Slot() : offset(kNotStored), size(0), queued(0), node(nullptr) {
+}
+
+ProfileCache::ProfileCache(const Config& config)
+    : config_(config)
+    , shardCount_(1)
+    , shardCapacity_(1)
+    , accepting_(false)
+    , fd_(-1)
+    , fileSize_(0)
+    , liveBytes_(0)
+    , logBytes_(0)
+    , loads_(0)
+    , written_(0)
+    , batches_(0)
+    , compactions_(0)
+    , flushRequests_(0)
+    , flushesDone_(0)
+    , stop_(false)
+    , running_(false) {
+    while (shardCount_ < config_.shards) {
+        shardCount_ <<= 1;
+    }
+    shardCapacity_ = std::max<size_t>(1, config_.capacity / shardCount_);
+    size_t tableSize = kMinTableSize;
+    while (tableSize < shardCapacity_ * 2) {
+        tableSize <<= 1;
+    }
+    shards_.reset(new Shard[shardCount_]);
+    for (size_t s = 0; s < shardCount_; s++) {
+        shards_[s].table.assign(tableSize, Shard::Entry());
+        shards_[s].tableMask = tableSize - 1;
+    }
+}
+
+ProfileCache::~ProfileCache() {
+    close();
+}
+
+bool ProfileCache::open() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        if (running_) {
+            return true;
+        }
+    }
+    if (!config_.path.empty() && !scanLog()) {
+        return false;
+    }
+    accepting_ = true;
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    stop_ = false;
+    running_ = true;
+    updateThread_ = std::thread(&ProfileCache::updateLoop, this);
+    return true;
+}
+
+void ProfileCache::close() {
+    accepting_ = false;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        if (!running_) {
+            return;
+        }
+        stop_ = true;
+    }
+    queueWake_.notify_one();
+    updateThread_.join();
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        running_ = false;
+    }
+    queueDone_.notify_all();
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+ProfileCache::Shard& ProfileCache::shardOf(uint64_t hash) const {
+    return shards_[hash & (shardCount_ - 1)];
+}
+
+bool ProfileCache::get(const std::string& playerId, PlayerProfile& profile) {
+    if (!accepting_.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    uint64_t hash = hashOf(playerId);
+    Shard& shard = shardOf(hash);
+    std::lock_guard<InstrumentedMutex> lock(shard.mutex);
+    Node* node = findLocked(shard, hash, playerId);
+    if (node != nullptr && !node->stale) {
+        if (node->dirty || Clock::now() < node->expiresAt) {
+            node->referenced = true;
+            shard.hits++;
+            profile = node->profile;
+            return true;
+        }
+        removeLocked(shard, node);
+        shard.evictions++;
+    }
+
+    //未命中：老玩家排队读入（已有排队的操作时不用再排）
+    shard.misses++;
+    auto it = shard.slots.find(playerId);
+    if (it != shard.slots.end() && it->second.node == nullptr && it->second.queued == 0) {
+        it->second.queued++;
+        Op op;
+        op.playerId = playerId;
+        op.kind = Op_Load;
+        op.delta = 0;
+        enqueue(op);
+    }
+    return false;
+}
+
+void ProfileCache::setNickname(const std::string& playerId, const std::string& nickname) {
+    Op op;
+    op.playerId = playerId;
+    op.kind = Op_Nickname;
+    op.delta = 0;
+    op.text = nickname;
+    mutate(op);
+}
+
+void ProfileCache::addScore(const std::string& playerId, int64_t delta) {
+    Op op;
+    op.playerId = playerId;
+    op.kind = Op_Score;
+    op.delta = delta;
+    mutate(op);
+}
+
+void ProfileCache::setSettings(const std::string& playerId, const std::string& settings) {
+    Op op;
+    op.playerId = playerId;
+    op.kind = Op_Settings;
+    op.delta = 0;
+    op.text = settings;
+    mutate(op);
+}
+
+void ProfileCache::submit(const std::string playerIds[GAME_PLAYER], const int64_t scores[GAME_PLAYER]) {
+    for (int i = 0; i < GAME_PLAYER; i++) {
+        if (!playerIds[i].empty()) {
+            addScore(playerIds[i], scores[i]);
+        }
+    }
+}
+
+void ProfileCache::mutate(const Op& op) {
+    if (!accepting_.load(std::memory_order_relaxed) || op.playerId.empty() || op.playerId.size() > kMaxIdLength
+        || op.text.size() > kMaxTextLength) {
+        return;
+    }
+    uint32_t now = static_cast<uint32_t>(std::time(nullptr));
+    uint64_t hash = hashOf(op.playerId);
+    Shard& shard = shardOf(hash);
+    std::lock_guard<InstrumentedMutex> lock(shard.mutex);
+    Node* node = findLocked(shard, hash, op.playerId);
+    if (node != nullptr && !node->stale) {
+        applyOp(op, node->profile, now);
+        node->expiresAt = Clock::now() + config_.ttl;
+        node->referenced = true;
+        markDirtyLocked(shard, node);
+        return;
+    }
+    auto it = shard.slots.find(op.playerId);
+    if (it == shard.slots.end()) {
+        //新玩家：直接在缓存里建档案
+        Slot& slot = shard.slots[op.playerId];
+        node = new Node();
+        node->profile.playerId = op.playerId;
+        applyOp(op, node->profile, now);
+        insertLocked(shard, slot, node, hash);
+        markDirtyLocked(shard, node);
+        evictLocked(shard, kEvictScan);
+        return;
+    }
+    //不在缓存里（或前面还有排队的操作）：持分片锁排队，同一玩家的操作按顺序应用
+    Slot& slot = it->second;
+    slot.queued++;
+    if (slot.node != nullptr) {
+        slot.node->stale = true;
+    }
+    enqueue(op);
+}
+
+void ProfileCache::applyOp(const Op& op, PlayerProfile& profile, uint32_t now) {
+    switch (op.kind) {
+        case Op_Nickname:
+            profile.nickname = op.text;
+            break;
+        case Op_Score:
+            profile.score += op.delta;
+            break;
+        case Op_Settings:
+            profile.settings = op.text;
+            break;
+        default:
+            return;
+    }
+    profile.updatedAt = now;
+}
+
+ProfileCache::Node* ProfileCache::findLocked(Shard& shard, uint64_t hash, const std::string& playerId) const {
+    for (size_t i = tableIndex(hash, shard.tableMask); shard.table[i].node != nullptr; i = (i + 1) & shard.tableMask) {
+        if (shard.table[i].hash == hash && shard.table[i].node->profile.playerId == playerId) {
+            return shard.table[i].node;
+        }
+    }
+    return nullptr;
+}
+
+void ProfileCache::growTableLocked(Shard& shard) {
+    std::vector<Shard::Entry> old(shard.table.size() * 2, Shard::Entry());
+    old.swap(shard.table);
+    shard.tableMask = shard.table.size() - 1;
+    for (size_t j = 0; j < old.size(); j++) {
+        if (old[j].node != nullptr) {
+            size_t i = tableIndex(old[j].hash, shard.tableMask);
+            while (shard.table[i].node != nullptr) {
+                i = (i + 1) & shard.tableMask;
+            }
+            shard.table[i] = old[j];
+        }
+    }
+}
+
+void ProfileCache::insertLocked(Shard& shard, Slot& slot, Node* node, uint64_t hash) {
+    if ((shard.cached + 1) * 2 > shard.table.size()) {
+        growTableLocked(shard);     // 未写盘的档案超出容量时
+    }
+    size_t i = tableIndex(hash, shard.tableMask);
+    while (shard.table[i].node != nullptr) {
+        i = (i + 1) & shard.tableMask;
+    }
+    shard.table[i].hash = hash;
+    shard.table[i].node = node;
+    node->hash = hash;
+    node->referenced = false;
+    node->slot = &slot;
+    node->expiresAt = Clock::now() + config_.ttl;
+    node->prev = &shard.head;
+    node->next = shard.head.next;
+    shard.head.next->prev = node;
+    shard.head.next = node;
+    slot.node = node;
+    shard.cached++;
+}
+
+void ProfileCache::touchLocked(Shard& shard, Node* node) {
+    if (shard.head.next == node) {
+        return;
+    }
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->prev = &shard.head;
+    node->next = shard.head.next;
+    shard.head.next->prev = node;
+    shard.head.next = node;
+}
+
+void ProfileCache::removeLocked(Shard& shard, Node* node) {
+    //线性探测的删除：把后面探测链上的项往前挪，不留墓碑
+    size_t i = tableIndex(node->hash, shard.tableMask);
+    while (shard.table[i].node != node) {
+        i = (i + 1) & shard.tableMask;
+    }
+    for (size_t j = (i + 1) & shard.tableMask; shard.table[j].node != nullptr; j = (j + 1) & shard.tableMask) {
+        size_t home = tableIndex(shard.table[j].hash, shard.tableMask);
+        if (((j - home) & shard.tableMask) >= ((j - i) & shard.tableMask)) {
+            shard.table[i] = shard.table[j];
+            i = j;
+        }
+    }
+    shard.table[i].node = nullptr;
+
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->slot->node = nullptr;
+    shard.cached--;
+    delete node;
+}
+
+void ProfileCache::markDirtyLocked(Shard& shard, Node* node) {
+    node->version++;
+    if (!node->dirty) {
+        node->dirty = true;
+        shard.dirty.push_back(node);
+    }
+}
+
+void ProfileCache::evictLocked(Shard& shard, size_t scanLimit) {
+    Node* node = shard.head.prev;
+    for (size_t scanned = 0; shard.cached > shardCapacity_ && node != &shard.head && scanned < scanLimit; scanned++) {
+        Node* prev = node->prev;
+        if (node->referenced) {
+            node->referenced = false;
+            touchLocked(shard, node);
+        } else if (!node->dirty) {
+            removeLocked(shard, node);
+            shard.evictions++;
+        }
+        node = prev;
+    }
+}
+
+void ProfileCache::sweepShards() {
+    Clock::time_point now = Clock::now();
+    for (size_t s = 0; s < shardCount_; s++) {
+        Shard& shard = shards_[s];
+        std::lock_guard<InstrumentedMutex> lock(shard.mutex);
+        evictLocked(shard, shard.cached);       // 写完后淘汰超出容量的部分，用过的档案留到下一轮
+        Node* node = shard.head.prev;
+        for (int scanned = 0; node != &shard.head && scanned < kSweepScan; scanned++) {
+            Node* prev = node->prev;
+            if (!node->dirty && now >= node->expiresAt) {
+                removeLocked(shard, node);
+                shard.evictions++;
+            }
+            node = prev;
+        }
+    }
+}
+
+void ProfileCache::enqueue(const Op& op) {
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    if (front_.empty()) {
+        queueWake_.notify_one();
+    }
+    front_.push_back(op);
+}
+
+void ProfileCache::flush() {
+    std::unique_lock<std::mutex> lock(queueMutex_);
+    if (!running_) {
+        return;
+    }
+    uint64_t request = ++flushRequests_;
+    queueWake_.notify_one();
+    queueDone_.wait(lock, [this, request] { return flushesDone_ >= request || !running_; });
+}
+
+bool ProfileCache::load(const std::string& playerId, PlayerProfile& profile) {
+    if (get(playerId, profile)) {
+        return true;
+    }
+    flush();
+    return get(playerId, profile);
+}
+
+ProfileCache::Stats ProfileCache::getStats() const {
+    Stats stats;
+    for (size_t s = 0; s < shardCount_; s++) {
+        Shard& shard = shards_[s];
+        std::lock_guard<InstrumentedMutex> lock(shard.mutex);
+        stats.hits += shard.hits;
+        stats.misses += shard.misses;
+        stats.evictions += shard.evictions;
+        stats.players += shard.slots.size();
+        stats.cached += shard.cached;
+    }
+    stats.loads = loads_;
+    stats.written = written_;
+    stats.batches = batches_;
+    stats.compactions = compactions_;
+    stats.logBytes = logBytes_;
+    stats.liveBytes = liveBytes_;
+    return stats;
+}
+
+void ProfileCache::updateLoop() {
+    std::vector<Op> ops;
+    Clock::time_point nextWrite = Clock::now() + config_.flushInterval;
+    for (;;) {
+        uint64_t requests = 0;
+        bool requested = false;
+        bool stop = false;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex_);
+            queueWake_.wait_until(lock, nextWrite, [this] {
+                return stop_ || !front_.empty() || flushRequests_ > flushesDone_;
+            });
+            ops.swap(front_);
+            requests = flushRequests_;
+            requested = requests > flushesDone_;
+            stop = stop_;
+        }
+
+        //先读入并应用排队的修改，再写盘：flush() 之前的修改都在这一批里
+        applyOps(ops);
+        ops.clear();
+        if (stop || requested || Clock::now() >= nextWrite) {
+            writeDirty();
+            sweepShards();
+            if (fd_ >= 0 && fileSize_ > config_.compactMinBytes
+                && static_cast<double>(fileSize_) > config_.compactRatio * static_cast<double>(liveBytes_)) {
+                compact();
+            }
+            nextWrite = Clock::now() + config_.flushInterval;
+        }
+        if (requested) {
+            std::lock_guard<std::mutex> lock(queueMutex_);
+            flushesDone_ = requests;
+            queueDone_.notify_all();
+        }
+        if (stop) {
+            std::lock_guard<std::mutex> lock(queueMutex_);
+            if (front_.empty()) {
+                break;
+            }
+        }
+    }
+}
+
+void ProfileCache::applyOps(std::vector<Op>& ops) {
+    uint32_t now = static_cast<uint32_t>(std::time(nullptr));
+    for (size_t i = 0; i < ops.size(); i++) {
+        const Op& op = ops[i];
+        uint64_t hash = hashOf(op.playerId);
+        Shard& shard = shardOf(hash);
+        Slot stored;
+        {
+            std::lock_guard<InstrumentedMutex> lock(shard.mutex);
+            auto it = shard.slots.find(op.playerId);
+            if (it == shard.slots.end()) {
+                continue;
+            }
+            Slot& slot = it->second;
+            if (slot.node != nullptr) {
+                //已在缓存里（同一批里前面的操作已经读入）
+                slot.queued--;
+                slot.node->stale = slot.queued > 0;
+                if (op.kind != Op_Load) {
+                    applyOp(op, slot.node->profile, now);
+                    markDirtyLocked(shard, slot.node);
+                }
+                continue;
+            }
+            stored = slot;
+        }
+
+        //不持分片锁读日志（记录位置只由本线程修改）
+        PlayerProfile profile;
+        if (stored.offset == kNotStored || !readProfile(stored, op.playerId, profile)) {
+            profile = PlayerProfile();
+            profile.playerId = op.playerId;
+        }
+        loads_++;
+
+        std::lock_guard<InstrumentedMutex> lock(shard.mutex);
+        Slot& slot = shard.slots.find(op.playerId)->second;
+        slot.queued--;
+        Node* node = new Node();
+        node->profile = std::move(profile);
+        node->stale = slot.queued > 0;
+        insertLocked(shard, slot, node, hash);
+        node->referenced = true;        // 刚有人要，淘汰时先留一轮
+        if (op.kind != Op_Load) {
+            applyOp(op, node->profile, now);
+            markDirtyLocked(shard, node);
+        }
+        evictLocked(shard, kEvictScan);
+    }
+}
+
+bool ProfileCache::readProfile(const Slot& slot, const std::string& playerId, PlayerProfile& profile) {
+    std::vector<uint8_t> buffer(slot.size);
+    ssize_t got = pread(fd_, buffer.data(), slot.size, static_cast<off_t>(slot.offset));
+    if (got != static_cast<ssize_t>(slot.size) || decodeRecord(buffer.data(), buffer.size(), &profile) != slot.size
+        || profile.playerId != playerId) {
+        std::cout << "[ProfileCache] 无法读取玩家 " << playerId << " 的档案（偏移 " << slot.offset << "）" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void ProfileCache::writeDirty() {
+    //取出各分片的脏档案；写完之前仍标记为脏，不会被淘汰
+    std::vector<Pending> batch;
+    for (size_t s = 0; s < shardCount_; s++) {
+        Shard& shard = shards_[s];
+        std::lock_guard<InstrumentedMutex> lock(shard.mutex);
+        for (size_t i = 0; i < shard.dirty.size(); i++) {
+            Pending pending;
+            pending.shard = &shard;
+            pending.node = shard.dirty[i];
+            pending.version = shard.dirty[i]->version;
+            pending.profile = shard.dirty[i]->profile;
+            batch.push_back(std::move(pending));
+        }
+        shard.dirty.clear();
+    }
+    if (batch.empty()) {
+        return;
+    }
+
+    std::vector<uint64_t> offsets(batch.size());
+    std::vector<uint32_t> sizes(batch.size());
+    bool ok = true;
+    if (fd_ >= 0) {
+        std::string buffer;
+        buffer.reserve(kFileBuffer + 4096);
+        uint64_t offset = fileSize_;
+        for (size_t i = 0; i < batch.size() && ok; i++) {
+            size_t begin = buffer.size();
+            encodeRecord(batch[i].profile, buffer);
+            offsets[i] = offset + begin;
+            sizes[i] = static_cast<uint32_t>(buffer.size() - begin);
+            if (buffer.size() >= kFileBuffer || i + 1 == batch.size()) {
+                ok = writeFully(fd_, buffer.data(), buffer.size());
+                offset += buffer.size();
+                buffer.clear();
+            }
+        }
+        if (ok && config_.sync) {
+            ok = fdatasync(fd_) == 0;
+        }
+        if (!ok) {
+            //写了一部分时截回原来的大小，下次整批重写
+            std::cout << "[ProfileCache] 写日志失败: " << config_.path << std::endl;
+            if (ftruncate(fd_, static_cast<off_t>(fileSize_)) != 0) {
+                std::cout << "[ProfileCache] 无法截回日志: " << config_.path << std::endl;
+            }
+        } else {
+            fileSize_ = offset;
+            logBytes_ = fileSize_;
+            written_ += batch.size();
+            batches_++;
+        }
+    }
+
+    //写成后更新记录位置；期间又改过的档案留在脏表里，写失败的全部放回
+    uint64_t live = liveBytes_;
+    for (size_t i = 0; i < batch.size(); i++) {
+        Shard& shard = *batch[i].shard;
+        Node* node = batch[i].node;
+        std::lock_guard<InstrumentedMutex> lock(shard.mutex);
+        if (!ok || node->version != batch[i].version) {
+            shard.dirty.push_back(node);
+        } else {
+            node->dirty = false;
+        }
+        if (ok && fd_ >= 0) {
+            Slot& slot = *node->slot;
+            if (slot.offset != kNotStored) {
+                live -= slot.size;
+            }
+            slot.offset = offsets[i];
+            slot.size = sizes[i];
+            live += sizes[i];
+        }
+    }
+    liveBytes_ = live;
+}
+
+void ProfileCache::compact() {
+    struct Live {
+        uint64_t offset;
+        uint32_t size;
+        Shard* shard;
+        Slot* slot;
+    };
+    std::vector<Live> records;
+    for (size_t s = 0; s < shardCount_; s++) {
+        Shard& shard = shards_[s];
+        std::lock_guard<InstrumentedMutex> lock(shard.mutex);
+        for (auto it = shard.slots.begin(); it != shard.slots.end(); ++it) {
+            if (it->second.offset != kNotStored) {
+                Live record = {it->second.offset, it->second.size, &shard, &it->second};
+                records.push_back(record);
+            }
+        }
+    }
+    std::sort(records.begin(), records.end(), [](const Live& a, const Live& b) { return a.offset < b.offset; });
+
+    //按旧位置顺序读出有效记录，写进临时文件后改名替换
+    std::string temp = config_.path + ".compact";
+    int out = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (out < 0) {
+        std::cout << "[ProfileCache] 无法创建 " << temp << std::endl;
+        return;
+    }
+    std::vector<uint64_t> offsets(records.size());
+    std::vector<uint8_t> window;
+    uint64_t windowBegin = 0;
+    uint64_t windowEnd = 0;
+    std::string buffer = fileHeader();
+    uint64_t outSize = 0;
+    bool ok = true;
+    for (size_t i = 0; i < records.size() && ok; i++) {
+        const Live& record = records[i];
+        if (record.offset < windowBegin || record.offset + record.size > windowEnd) {
+            window.resize(std::max<size_t>(kFileBuffer, record.size));
+            ssize_t got = pread(fd_, window.data(), window.size(), static_cast<off_t>(record.offset));
+            windowBegin = record.offset;
+            windowEnd = got > 0 ? record.offset + static_cast<uint64_t>(got) : record.offset;
+            ok = record.offset + record.size <= windowEnd;
+        }
+        if (ok) {
+            offsets[i] = outSize + buffer.size();
+            buffer.append(reinterpret_cast<const char*>(window.data() + (record.offset - windowBegin)), record.size);
+        }
+        if (ok && (buffer.size() >= kFileBuffer || i + 1 == records.size())) {
+            ok = writeFully(out, buffer.data(), buffer.size());
+            outSize += buffer.size();
+            buffer.clear();
+        }
+    }
+    if (ok && records.empty()) {
+        ok = writeFully(out, buffer.data(), buffer.size());
+        outSize += buffer.size();
+    }
+    ok = ok && fsync(out) == 0;
+    ::close(out);
+    int fd = ok ? ::open(temp.c_str(), O_RDWR | O_APPEND | O_CLOEXEC) : -1;
+    if (fd < 0 || std::rename(temp.c_str(), config_.path.c_str()) != 0) {
+        std::cout << "[ProfileCache] 压缩日志失败: " << config_.path << std::endl;
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        std::remove(temp.c_str());
+        return;
+    }
+    ::close(fd_);
+    fd_ = fd;
+    std::cout << "[ProfileCache] 压缩日志 " << config_.path << "：" << fileSize_ / 1048576 << " MB -> "
+              << outSize / 1048576 << " MB，" << records.size() << " 份档案" << std::endl;
+    fileSize_ = outSize;
+    logBytes_ = outSize;
+    liveBytes_ = outSize - kFileHeaderSize;
+    compactions_++;
+    for (size_t i = 0; i < records.size(); i++) {
+        std::lock_guard<InstrumentedMutex> lock(records[i].shard->mutex);
+        records[i].slot->offset = offsets[i];
+    }
+}
+
+bool ProfileCache::scanLog() {
+    int fd = ::open(config_.path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        std::cout << "[ProfileCache] 无法打开日志: " << config_.path << std::endl;
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return false;
+    }
+    size_t fileSize = static_cast<size_t>(st.st_size);
+    if (fileSize < kFileHeaderSize) {
+        //新文件（或文件头没写完）
+        std::string header = fileHeader();
+        if (ftruncate(fd, 0) != 0 || !writeFully(fd, header.data(), header.size())) {
+            std::cout << "[ProfileCache] 无法写日志: " << config_.path << std::endl;
+            ::close(fd);
+            return false;
+        }
+        fd_ = fd;
+        fileSize_ = kFileHeaderSize;
+        logBytes_ = fileSize_;
+        return true;
+    }
+    void* mapped = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+    madvise(mapped, fileSize, MADV_SEQUENTIAL);
+    const uint8_t* data = static_cast<const uint8_t*>(mapped);
+    if (getValue<uint32_t>(data) != kProfileMagic || getValue<uint16_t>(data + 4) != kProfileVersion) {
+        std::cout << "[ProfileCache] 不是档案日志: " << config_.path << std::endl;
+        munmap(mapped, fileSize);
+        ::close(fd);
+        return false;
+    }
+
+    //建表：同一玩家以最后一条为准
+    size_t offset = kFileHeaderSize;
+    uint64_t live = 0;
+    std::vector<std::pair<uint64_t, Slot*> > latest;
+    while (offset < fileSize) {
+        uint32_t size = decodeRecord(data + offset, fileSize - offset, nullptr);
+        if (size == 0) {
+            break;
+        }
+        std::string playerId(reinterpret_cast<const char*>(data + offset + kRecordHeaderSize),
+                             getValue<uint16_t>(data + offset + 8));
+        Slot& slot = shardOf(hashOf(playerId)).slots[playerId];
+        if (slot.offset != kNotStored) {
+            live -= slot.size;
+        }
+        slot.offset = offset;
+        slot.size = size;
+        live += size;
+        offset += size;
+    }
+
+    //预热：每个分片最近写入的 capacity / shards 份档案，按写入顺序放进缓存（最新的在表头）；
+    //一批写盘按分片顺序排列，所以按分片各取各的
+    size_t players = 0;
+    size_t warm = 0;
+    for (size_t s = 0; s < shardCount_; s++) {
+        Shard& shard = shards_[s];
+        latest.clear();
+        for (auto it = shard.slots.begin(); it != shard.slots.end(); ++it) {
+            latest.push_back(std::make_pair(it->second.offset, &it->second));
+        }
+        players += latest.size();
+        size_t count = std::min(latest.size(), shardCapacity_);
+        std::nth_element(latest.begin(), latest.begin() + (latest.size() - count), latest.end());
+        std::sort(latest.begin() + (latest.size() - count), latest.end());
+        for (size_t i = latest.size() - count; i < latest.size(); i++) {
+            Slot& slot = *latest[i].second;
+            if (slot.node != nullptr) {
+                continue;
+            }
+            Node* node = new Node();
+            decodeRecord(data + slot.offset, slot.size, &node->profile);
+            insertLocked(shard, slot, node, hashOf(node->profile.playerId));
+            warm++;
+        }
+    }
+    munmap(mapped, fileSize);
+
+    if (offset < fileSize) {
+        std::cout << "[ProfileCache] 截掉日志末尾不完整的 " << fileSize - offset << " 字节: " << config_.path << std::endl;
+        if (ftruncate(fd, static_cast<off_t>(offset)) != 0) {
+            ::close(fd);
+            return false;
+        }
+    }
+    fd_ = fd;
+    fileSize_ = offset;
+    logBytes_ = fileSize_;
+    liveBytes_ = live;
+    std::cout << "[ProfileCache] 读入日志 " << config_.path << "：" << players << " 位玩家，预热 " << warm
+              << " 份档案，" << fileSize_ / 1048576 << " MB" << std::endl;
+    return true;
+}
@@ -0,0 +1,199 @@
+//
+// ProfileCache.h
+// 玩家档案缓存：昵称、累计积分和设置放在分片 LRU 缓存里，后台线程成批追加到本地日志文件
+//
+
+#ifndef PROFILE_CACHE_H
+#define PROFILE_CACHE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "LockStats.h"
+#include "game/GameCmd.h"
+
+struct PlayerProfile {
+    std::string playerId;
+    std::string nickname;
+    int64_t score;              // 累计积分（每局单局积分之和）
+    std::string settings;       // 客户端的设置，原样保存
+    uint32_t updatedAt;         // 最后修改时间（Unix 秒）
+
+    PlayerProfile() : score(0), updatedAt(0) {}
+};
+
+class ProfileCache {
+public:
+    struct Config {
+        std::string path;                           // 日志文件，空为只在内存里
+        size_t shards;                              // 分片数，取整到 2 的幂
+        size_t capacity;                            // 缓存的档案数（未写盘的档案不淘汰，可能暂时超出）
+        std::chrono::seconds ttl;                   // 档案在缓存中的有效期
+        std::chrono::milliseconds flushInterval;    // 写盘间隔，期间的修改攒成一批
+        bool sync;                                  // 每批写完后 fdatasync
+        double compactRatio;                        // 日志超过有效记录的这个倍数时重写
+        uint64_t compactMinBytes;                   // 日志不到这个大小时不重写
+
+        Config()
+            : shards(64), capacity(1 << 20), ttl(3600), flushInterval(100), sync(false), compactRatio(2.0)
+            , compactMinBytes(64ULL * 1024 * 1024) {}
+    };
+
+    struct Stats {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t loads;             // 后台线程从日志读出的档案数
+        uint64_t evictions;         // 按容量淘汰和过期清出的档案数
+        uint64_t written;           // 写进日志的档案数
+        uint64_t batches;           // 写盘批次
+        uint64_t compactions;
+        uint64_t players;           // 登记的玩家数
+        uint64_t cached;            // 缓存中的档案数
+        uint64_t logBytes;
+        uint64_t liveBytes;         // 日志中有效记录的字节数
+
+        Stats();
+    };
+
+    explicit ProfileCache(const Config& config);
+    ~ProfileCache();                // 等同 close()
+
+    // 扫描日志建表、预热缓存并启动后台线程；日志无法打开时返回 false
+    bool open();
+
+    // 写完所有修改后停止后台线程
+    void close();
+
+    /**
+     * 取档案（不碰磁盘）
+     * @param playerId
+     * @param profile 命中时填入
+     * @return 命中返回 true；未命中返回 false，存过的档案由后台线程随后读进缓存
+     */
+    bool get(const std::string& playerId, PlayerProfile& profile);
+
+    // 修改档案（不等待）：不存在的玩家新建档案
+    void setNickname(const std::string& playerId, const std::string& nickname);
+    void addScore(const std::string& playerId, int64_t delta);
+    void setSettings(const std::string& playerId, const std::string& settings);
+
+    /**
+     * 一局结束：座位上的玩家各加单局积分（机器人座位 playerId 为空）
+     * @param playerIds
+     * @param scores 单局积分 lGameScore
+     */
+    void submit(const std::string playerIds[GAME_PLAYER], const int64_t scores[GAME_PLAYER]);
+
+    void flush();                   // 等待此前的修改写进日志、排队的读取完成
+
+    // 取档案，未命中时等后台线程读入（管理工具和测试用，会等待磁盘）
+    bool load(const std::string& playerId, PlayerProfile& profile);
+
+    Stats getStats() const;
+
+private:
+    enum OpKind {
+        Op_Load,            // 只读入缓存
+        Op_Nickname,
+        Op_Score,
+        Op_Settings
+    };
+
+    struct Op {
+        std::string playerId;
+        uint8_t kind;
+        int64_t delta;
+        std::string text;
+    };
+
+    struct Node;
+
+    struct Slot {
+        uint64_t offset;            // 最新记录在日志中的位置，kNotStored 为还没写过
+        uint32_t size;              // 最新记录的字节数
+        uint32_t queued;            // 排队等后台线程应用的操作数；不为 0 时游戏路径也排队，保证顺序
+        Node* node;                 // 在缓存中时指向 LRU 节点
+
+        Slot();
+    };
+
+    // 命中时只读这个结构：标志、有效期和 playerId 在第一个缓存行，档案内联
+    struct Node {
+        uint64_t hash;
+        bool referenced;            // 上次扫到之后用过，淘汰时再给一次机会（CLOCK）
+        bool stale;                 // 队列里还有这位玩家的操作，缓存里的不是最新的
+        bool dirty;                 // 有没写进日志的修改（写盘期间仍为 true，不淘汰）
+        uint32_t version;           // 每次修改加 1，写完时据此判断期间是否又改过
+        std::chrono::steady_clock::time_point expiresAt;
+        PlayerProfile profile;
+        Slot* slot;                 // unordered_map 的元素地址不随扩容改变
+        Node* prev;
+        Node* next;
+    };
+
+    struct Shard;
+
+    // 写盘批次中的一份档案
+    struct Pending {
+        Shard* shard;
+        Node* node;
+        uint32_t version;
+        PlayerProfile profile;
+    };
+
+    Shard& shardOf(uint64_t hash) const;
+    void mutate(const Op& op);
+    static void applyOp(const Op& op, PlayerProfile& profile, uint32_t now);
+    Node* findLocked(Shard& shard, uint64_t hash, const std::string& playerId) const;
+    void growTableLocked(Shard& shard);
+    void insertLocked(Shard& shard, Slot& slot, Node* node, uint64_t hash);
+    void touchLocked(Shard& shard, Node* node);
+    void removeLocked(Shard& shard, Node* node);
+    void markDirtyLocked(Shard& shard, Node* node);
+    void evictLocked(Shard& shard, size_t scanLimit);
+    void sweepShards();                     // 写盘后淘汰超出容量的和过期的档案
+
+    void updateLoop();
+    void enqueue(const Op& op);
+    void applyOps(std::vector<Op>& ops);
+    bool readProfile(const Slot& slot, const std::string& playerId, PlayerProfile& profile);
+    void writeDirty();
+    void compact();
+    bool scanLog();
+
+    Config config_;
+    size_t shardCount_;
+    size_t shardCapacity_;
+    std::unique_ptr<Shard[]> shards_;
+    std::atomic<bool> accepting_;           // open() 之后、close() 之前接受修改
+
+    // 以下只由后台线程（open() 时由调用线程）使用
+    int fd_;
+    uint64_t fileSize_;
+    std::atomic<uint64_t> liveBytes_;
+    std::atomic<uint64_t> logBytes_;
+    std::atomic<uint64_t> loads_;
+    std::atomic<uint64_t> written_;
+    std::atomic<uint64_t> batches_;
+    std::atomic<uint64_t> compactions_;
+
+    std::mutex queueMutex_;                 // 保护以下数据；加锁顺序为分片锁在前
+    std::condition_variable queueWake_;
+    std::condition_variable queueDone_;
+    std::vector<Op> front_;                 // 游戏路径排队的读取和修改
+    uint64_t flushRequests_;
+    uint64_t flushesDone_;
+    bool stop_;
+    bool running_;
+    std::thread updateThread_;
+};
+
+#endif // PROFILE_CACHE_H
@@ -4,25 +4,74 @@
 
 #include <iostream>
 #include <algorithm>
+#include <cstring>
+#include <ctime>
 #include <memory>
 
 Room::Room(const std::string& id)
     : roomId_(id)
-    , state_(RoomState::WAITING) {
+    , state_(RoomState::WAITING)
+    , homeNode_(0)
+#ifdef USE_GAME_ENGINE
+    , botFillDelay_(0)
+    , botLevel_(BotLevel_Normal)
+    , recordWriter_(nullptr)
+    , journal_(nullptr)
+    , journalRoom_(0)
+    , matchHistory_(nullptr)
+    , leaderboard_(nullptr)
+    , profiles_(nullptr)
+    , recovering_(false)
+#endif
+{
+    roomId_.reserve(64);                 // 复用时重新赋值房间号不再分配
+    players_.reserve(kMaxPlayers);
+#ifdef USE_GAME_ENGINE
+    for (int i = 0; i < kMaxPlayers; i++) {
+        botSeats_[i] = false;
+        takenOver_[i] = false;
+    }
+#endif
+}
+
+void Room::reset(const std::string& id) {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    roomId_ = id;
+    state_ = RoomState::WAITING;
+    players_.clear();
+    for (int i = 0; i < kMaxPlayers; i++) {
+        playersBySeat_[i].reset();
+        gamePlayers_[i].reset();
+#ifdef USE_GAME_ENGINE
+        botSeats_[i] = false;
+        takenOver_[i] = false;
+#endif
+    }
+#ifdef USE_GAME_ENGINE
+    recorder_.flush();      // 放弃的一局也写出
+    closeJournalLocked();
+    recovering_ = false;
+    gameEngine_.reset();
+#endif
 }
 
 size_t Room::getPlayerCount() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
     return players_.size();
 }
 
+bool Room::isIdle() const {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    return players_.empty() || state_ == RoomState::FINISHED;
+}
+
 std::vector<std::shared_ptr<NetPlayer>> Room::getPlayers() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
     return players_;
 }
 
 bool Room::addPlayer(const std::shared_ptr<NetPlayer>& player) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
     
     // 检查房间状态
     if (state_ != RoomState::WAITING) {
@@ -31,7 +80,7 @@ bool Room::addPlayer(const std::shared_ptr<NetPlayer>& player) {
     }
     
     // 检查房间是否已满
-    if (players_.size() >= 4) {
+    if (players_.size() >= kMaxPlayers) {
         std::cout << "[Room] 房间已满，无法加入玩家" << std::endl;
         return false;
     }
@@ -44,10 +93,18 @@ bool Room::addPlayer(const std::shared_ptr<NetPlayer>& player) {
         }
     }
     
-    // 分配座位号（按加入顺序）
-    int seat = static_cast<int>(players_.size());
+    // 分配座位号（取第一个空座位）
+    int seat = 0;
+    while (seat < kMaxPlayers && playersBySeat_[seat]) {
+        seat++;
+    }
     player->setSeat(seat);
     
+    // 第一位玩家进入，开始机器人补位计时
+    if (players_.empty()) {
+        waitingSince_ = Clock::now();
+    }
+    
     // 添加到列表
     players_.push_back(player);
     playersBySeat_[seat] = player;
@@ -61,7 +118,7 @@ bool Room::addPlayer(const std::shared_ptr<NetPlayer>& player) {
 }
 
 bool Room::removePlayer(const std::string& playerId) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
     
     auto it = std::find_if(players_.begin(), players_.end(),
         [&playerId](const std::shared_ptr<NetPlayer>& p) {
@@ -74,7 +131,9 @@ bool Room::removePlayer(const std::string& playerId) {
     
     int seat = (*it)->getSeat();
     players_.erase(it);
-    playersBySeat_.erase(seat);
+    if (seat >= 0 && seat < kMaxPlayers) {
+        playersBySeat_[seat].reset();
+    }
     
     std::cout << "[Room] 玩家离开: room=" << roomId_
               << ", playerId=" << playerId
@@ -85,15 +144,13 @@ bool Room::removePlayer(const std::string& playerId) {
 }
 
 bool Room::removePlayerBySeat(int seat) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
     
-    auto it = playersBySeat_.find(seat);
-    if (it == playersBySeat_.end()) {
+    if (seat < 0 || seat >= kMaxPlayers || !playersBySeat_[seat]) {
         return false;
     }
     
-    std::string playerId = it->second->getPlayerId();
-    playersBySeat_.erase(it);
+    playersBySeat_[seat].reset();
     
     players_.erase(
         std::remove_if(players_.begin(), players_.end(),
@@ -111,16 +168,15 @@ bool Room::removePlayerBySeat(int seat) {
 }
 
 std::shared_ptr<NetPlayer> Room::getPlayerBySeat(int seat) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = playersBySeat_.find(seat);
-    if (it != playersBySeat_.end()) {
-        return it->second;
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    if (seat >= 0 && seat < kMaxPlayers) {
+        return playersBySeat_[seat];
     }
     return nullptr;
 }
 
 std::shared_ptr<NetPlayer> Room::getPlayerById(const std::string& playerId) const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
     for (const auto& player : players_) {
         if (player->getPlayerId() == playerId) {
             return player;
@@ -129,8 +185,17 @@ std::shared_ptr<NetPlayer> Room::getPlayerById(const std::string& playerId) cons
     return nullptr;
 }
 
+void Room::detachClient(const std::string& playerId) {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    for (const auto& player : players_) {
+        if (player->getPlayerId() == playerId) {
+            player->detachClient();
+        }
+    }
+}
+
 void Room::startGame() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
     
     if (state_ != RoomState::WAITING) {
         std::cout << "[Room] 房间不在等待状态，无法开始游戏" << std::endl;
@@ -142,38 +207,100 @@ void Room::startGame() {
         return;
     }
     
+#ifdef USE_GAME_ENGINE
+    startGameLocked();
+#else
     state_ = RoomState::PLAYING;
     std::cout << "[Room] 开始游戏: room=" << roomId_
               << ", players=" << players_.size() << std::endl;
-    
+    // 未启用 GameEngine，使用模拟版本
+    std::cout << "[Room] 使用模拟游戏逻辑" << std::endl;
+#endif
+}
+
 #ifdef USE_GAME_ENGINE
-    // 创建 GameEngine（不使用单例，每个房间一个实例）
-    // 注意：C++11 没有 make_unique，使用 new
-    gameEngine_ = std::unique_ptr<GameEngine>(new GameEngine());
-    gameEngine_->init();
+void Room::startGameLocked() {
+    state_ = RoomState::PLAYING;
+    std::cout << "[Room] 开始游戏: room=" << roomId_
+              << ", players=" << players_.size() << std::endl;
+    
+    // 复用房间自带的 GameEngine（嵌在房间对象里，不重新分配）
+    gameEngine_.reset();
+    recorder_.flush();
+    recorder_.bind(recordWriter_, roomId_);
+    gameEngine_.setCommandListener(&commandTap_);
+    
+    // 游戏期间保持引用，玩家中途离开也不会让 GameEngine 持有悬空指针
+    for (int i = 0; i < kMaxPlayers; i++) {
+        if (botSeats_[i]) {
+            gamePlayers_[i].reset();
+        } else {
+            gamePlayers_[i] = playersBySeat_[i];
+        }
+    }
+    
+    // 开桌写进日志（先于第 4 位玩家进入时自动开局的开局记录）
+    closeJournalLocked();
+    if (journal_ != nullptr) {
+        JournalSeat seats[kMaxPlayers];
+        journalSeatsLocked(seats);
+        journalRoom_ = journal_->openTable(roomId_, seats);
+    }
     
-    // 注册玩家到 GameEngine
-    for (size_t i = 0; i < players_.size(); i++) {
-        auto player = players_[i];
-        if (player) {
-            // 设置玩家的事件监听器
-            player->setGameEngineEventListener(player.get());
-            // 注册玩家到 GameEngine
-            gameEngine_->onUserEnter(player.get());
+    // 注册玩家到 GameEngine，第 4 位玩家进入时 GameEngine 会自动开始游戏
+    // 按座位顺序注册，保证 GameEngine 的椅子号与座位号一致；空座位由补位机器人入座
+    bool entered = true;
+    for (int i = 0; i < kMaxPlayers && entered; i++) {
+        takenOver_[i] = false;
+        if (botSeats_[i]) {
+            bots_[i].setLevel(botLevel_);
+            entered = gameEngine_.onUserEnter(&bots_[i]);
+            continue;
         }
+        const std::shared_ptr<NetPlayer>& player = gamePlayers_[i];
+        // 设置玩家的事件监听器
+        player->setGameEngineEventListener(player.get());
+        // 注册玩家到 GameEngine
+        entered = gameEngine_.onUserEnter(player.get());
     }
     
-    // 启动游戏
-    if (gameEngine_->onGameStart()) {
-        std::cout << "[Room] 游戏启动成功" << std::endl;
+    if (entered) {
+        // 记录种子，相同的房间种子、本局种子可以复现牌墙和骰子
+        std::cout << "[Room] 游戏启动成功: room=" << roomId_ << std::hex
+                  << ", roomSeed=0x" << gameEngine_.getRoomSeed()
+                  << ", gameSeed=0x" << gameEngine_.getGameSeed() << std::dec << std::endl;
+        driveBotsLocked();      // 机器人坐庄时先行动
     } else {
         std::cout << "[Room] 游戏启动失败" << std::endl;
+        closeJournalLocked();
         state_ = RoomState::WAITING;
         gameEngine_.reset();
+        for (int i = 0; i < kMaxPlayers; i++) {
+            gamePlayers_[i].reset();
+            botSeats_[i] = false;
+        }
+    }
+}
+#endif
+
+bool Room::restartGame() {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    
+    if (state_ == RoomState::WAITING) {
+        std::cout << "[Room] 游戏尚未开始，无法开始下一局" << std::endl;
+        return false;
     }
+    
+    state_ = RoomState::PLAYING;
+#ifdef USE_GAME_ENGINE
+    bool restarted = gameEngine_.onGameRestart();
+    std::cout << "[Room] 开始下一局: room=" << roomId_ << std::hex
+              << ", gameSeed=0x" << gameEngine_.getGameSeed() << std::dec << std::endl;
+    driveBotsLocked();
+    return restarted;
 #else
-    // 未启用 GameEngine，使用模拟版本
-    std::cout << "[Room] 使用模拟游戏逻辑" << std::endl;
+    std::cout << "[Room] 开始下一局: room=" << roomId_ << std::endl;
+    return true;
 #endif
 }
 
@@ -183,8 +310,352 @@ void Room::startGameMock() {
 }
 
 void Room::finishGame() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
     state_ = RoomState::FINISHED;
+#ifdef USE_GAME_ENGINE
+    closeJournalLocked();
+#endif
     std::cout << "[Room] 游戏结束: room=" << roomId_ << std::endl;
     // TODO: 后续可以重置房间状态，允许重新开始游戏
 }
+
+#ifdef USE_GAME_ENGINE
+void Room::setBotPolicy(std::chrono::milliseconds fillDelay, BotLevel level) {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    botFillDelay_ = fillDelay;
+    botLevel_ = level;
+}
+
+void Room::setRecordWriter(RecordWriter* writer) {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    recordWriter_ = writer;
+}
+
+void Room::setJournal(RoomJournal* journal) {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    journal_ = journal;
+}
+
+void Room::setMatchHistory(MatchHistory* history) {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    matchHistory_ = history;
+}
+
+void Room::setLeaderboard(Leaderboard* leaderboard) {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    leaderboard_ = leaderboard;
+}
+
+void Room::setProfileCache(ProfileCache* profiles) {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    profiles_ = profiles;
+}
+
+void Room::CommandTap::onCommandApplied(const tagGameCommand& command, uint8_t chairId, const tagGameState& state,
+                                        const GameEventBuffer& events, uint8_t firstEvent) {
+    Room& room = *room_;
+    if (room.recordWriter_ != nullptr) {
+        room.recorder_.onCommandApplied(command, chairId, state, events, firstEvent);
+    }
+    if (room.matchHistory_ != nullptr || room.leaderboard_ != nullptr || room.profiles_ != nullptr) {
+        for (uint8_t i = firstEvent; i < events.size(); i++) {
+            if (events[i].cbKind == GameEvent_GameEnd) {
+                room.recordGameEndLocked(events[i].GameEnd);
+                break;
+            }
+        }
+    }
+    if (room.journal_ == nullptr || room.journalRoom_ == 0) {
+        return;
+    }
+    if (command.cbKind == GameCommand_Start) {
+        room.journal_->appendStart(room.journalRoom_, state.llGameSeed, chairId,
+                                   command.Start.cbPlayerCount, command.Start.cbAndroidMask);
+    } else {
+        room.journal_->appendCommand(room.journalRoom_, command);
+    }
+}
+
+void Room::recordGameEndLocked(const CMD_S_GameEnd& gameEnd) {
+    std::string playerIds[kMaxPlayers];
+    for (int i = 0; i < kMaxPlayers; i++) {
+        if (!botSeats_[i] && gamePlayers_[i]) {
+            playerIds[i] = gamePlayers_[i]->getPlayerId();
+        }
+    }
+    uint32_t now = static_cast<uint32_t>(std::time(nullptr));
+    if (matchHistory_ != nullptr) {
+        matchHistory_->append(MatchRecord::fromGameEnd(gameEnd, playerIds, now));
+    }
+    int64_t scores[kMaxPlayers];
+    for (int i = 0; i < kMaxPlayers; i++) {
+        scores[i] = gameEnd.lGameScore[i];
+    }
+    if (leaderboard_ != nullptr) {
+        leaderboard_->submit(playerIds, scores, now);
+    }
+    if (profiles_ != nullptr) {
+        profiles_->submit(playerIds, scores);
+    }
+}
+
+void Room::journalSeatsLocked(JournalSeat seats[kMaxPlayers]) const {
+    for (int i = 0; i < kMaxPlayers; i++) {
+        seats[i].bot = botSeats_[i];
+        if (!botSeats_[i] && gamePlayers_[i]) {
+            seats[i].playerId = gamePlayers_[i]->getPlayerId();
+            seats[i].nickname = gamePlayers_[i]->getNickname();
+        }
+    }
+}
+
+void Room::closeJournalLocked() {
+    if (journal_ != nullptr && journalRoom_ != 0) {
+        journal_->closeTable(journalRoom_);
+    }
+    journalRoom_ = 0;
+}
+
+bool Room::writeCheckpoint() {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    if (journal_ == nullptr || journalRoom_ == 0 || state_ != RoomState::PLAYING || players_.empty()) {
+        return false;
+    }
+    JournalSeat seats[kMaxPlayers];
+    journalSeatsLocked(seats);
+    journal_->appendState(journalRoom_, roomId_, seats, gameEngine_.getGameState());
+    return true;
+}
+
+bool Room::recoverFromJournal(const RecoveredRoom& recovered) {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    if (state_ != RoomState::WAITING || !players_.empty()) {
+        return false;
+    }
+    gameEngine_.reset();
+    recorder_.flush();
+    recorder_.bind(recordWriter_, roomId_);
+    // 第 4 个座位入座时引擎会自动开一局，这一局不记录也不写日志，随后被日志里的状态覆盖
+    gameEngine_.setCommandListener(nullptr);
+    bool entered = true;
+    for (int i = 0; i < kMaxPlayers && entered; i++) {
+        const JournalSeat& seat = recovered.seats[i];
+        botSeats_[i] = seat.bot;
+        takenOver_[i] = !seat.bot;
+        bots_[i].setLevel(botLevel_);
+        if (seat.bot) {
+            gamePlayers_[i].reset();
+            entered = gameEngine_.onUserEnter(&bots_[i]);
+            continue;
+        }
+        // 真人还没有连接：保留座位，事件交给机器人，重连时 reconnectPlayer 绑定新连接
+        std::shared_ptr<NetPlayer> player = std::make_shared<NetPlayer>(seat.playerId, -1, nullptr);
+        player->setNickname(seat.nickname);
+        player->setSeat(i);
+        player->setGameEngineEventListener(&bots_[i]);
+        players_.push_back(player);
+        playersBySeat_[i] = player;
+        gamePlayers_[i] = player;
+        entered = gameEngine_.onUserEnter(player.get());
+    }
+    if (!entered || players_.empty()) {
+        std::cout << "[Room] 按日志恢复失败: room=" << roomId_ << std::endl;
+        if (journal_ != nullptr) {
+            journal_->closeTable(recovered.journalRoom);
+        }
+        players_.clear();
+        for (int i = 0; i < kMaxPlayers; i++) {
+            playersBySeat_[i].reset();
+            gamePlayers_[i].reset();
+            botSeats_[i] = false;
+            takenOver_[i] = false;
+        }
+        gameEngine_.reset();
+        return false;
+    }
+    gameEngine_.restore(recovered.state);
+    for (int i = 0; i < kMaxPlayers; i++) {
+        bots_[i].syncFromState(static_cast<uint8_t>(i), recovered.state);
+    }
+    gameEngine_.setCommandListener(&commandTap_);
+    journalRoom_ = recovered.journalRoom;
+    state_ = RoomState::PLAYING;
+    recovering_ = true;
+    recoveredAt_ = Clock::now();
+    std::cout << "[Room] 按日志恢复牌局，等待玩家重连: room=" << roomId_ << std::hex
+              << ", gameSeed=0x" << recovered.state.llGameSeed << std::dec
+              << ", players=" << players_.size() << std::endl;
+    return true;
+}
+
+bool Room::tick(Clock::time_point now) {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    if (recovering_ && now - recoveredAt_ >= std::chrono::seconds(static_cast<int>(kRecoveryGraceSeconds))) {
+        // 恢复后没有真人回来：放弃本局，房间随之空闲回收
+        recovering_ = false;
+        recorder_.flush();
+        closeJournalLocked();
+        players_.clear();
+        for (int i = 0; i < kMaxPlayers; i++) {
+            playersBySeat_[i].reset();
+        }
+        state_ = RoomState::FINISHED;
+        std::cout << "[Room] 恢复的牌局无人重连，放弃本局: room=" << roomId_ << std::endl;
+        return false;
+    }
+    if (state_ != RoomState::WAITING || players_.empty() || botFillDelay_.count() <= 0) {
+        return false;
+    }
+    if (now - waitingSince_ < botFillDelay_) {
+        return false;
+    }
+    for (int i = 0; i < kMaxPlayers; i++) {
+        botSeats_[i] = !playersBySeat_[i];
+    }
+    std::cout << "[Room] 等待超时，机器人补位: room=" << roomId_
+              << ", players=" << players_.size() << std::endl;
+    startGameLocked();
+    return state_ == RoomState::PLAYING;
+}
+
+bool Room::onUserOutCard(int seat, uint8_t card) {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    if (state_ != RoomState::PLAYING || seat < 0 || seat >= kMaxPlayers || isBotSeatLocked(seat)) {
+        return false;
+    }
+    if (gameEngine_.getGameState().cbCurrentUser != seat) {
+        return false;       // 不是该座位的回合
+    }
+    CMD_C_OutCard outCard;
+    outCard.cbCardData = card;
+    bool result = gameEngine_.onUserOutCard(outCard);
+    driveBotsLocked();
+    return result;
+}
+
+bool Room::onUserOperateCard(int seat, uint8_t operateCode, uint8_t card) {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    if (state_ != RoomState::PLAYING || seat < 0 || seat >= kMaxPlayers || isBotSeatLocked(seat)) {
+        return false;
+    }
+    CMD_C_OperateCard operateCard;
+    operateCard.cbOperateUser = static_cast<uint8_t>(seat);
+    operateCard.cbOperateCode = operateCode;
+    operateCard.cbOperateCard = card;
+    bool result = gameEngine_.onUserOperateCard(operateCard);
+    driveBotsLocked();
+    return result;
+}
+
+void Room::driveBotsLocked() {
+    for (int step = 0; step < kMaxBotSteps; step++) {
+        tagGameCommand command;
+        bool taken = false;
+        for (int i = 0; i < kMaxPlayers && !taken; i++) {
+            if (isBotSeatLocked(i)) {
+                taken = bots_[i].takeCommand(command);
+            }
+        }
+        if (!taken) {
+            return;
+        }
+        if (command.cbKind == GameCommand_OutCard) {
+            gameEngine_.onUserOutCard(command.OutCard);
+        } else {
+            gameEngine_.onUserOperateCard(command.OperateCard);
+        }
+    }
+    std::cout << "[Room] 机器人连续行动超过上限: room=" << roomId_ << std::endl;
+}
+
+bool Room::onPlayerDisconnect(const std::string& playerId) {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    if (state_ != RoomState::PLAYING) {
+        return false;
+    }
+    size_t online = 0;
+    for (const auto& p : players_) {
+        if (!takenOver_[p->getSeat()]) {
+            online++;
+        }
+    }
+    if (online <= 1) {
+        // 最后一位真人离开：放弃本局，清掉代打的玩家，剩下这位由调用方移除
+        players_.erase(
+            std::remove_if(players_.begin(), players_.end(),
+                [this](const std::shared_ptr<NetPlayer>& p) {
+                    if (!takenOver_[p->getSeat()]) {
+                        return false;
+                    }
+                    playersBySeat_[p->getSeat()].reset();
+                    return true;
+                }),
+            players_.end()
+        );
+        recorder_.flush();
+        closeJournalLocked();
+        std::cout << "[Room] 在线真人全部离开，放弃本局: room=" << roomId_ << std::endl;
+        return false;
+    }
+    for (const auto& player : players_) {
+        if (player->getPlayerId() != playerId) {
+            continue;
+        }
+        int seat = player->getSeat();
+        player->detachClient();
+        // 机器人按引擎状态接管，之后该座位的事件交给机器人
+        takenOver_[seat] = true;
+        bots_[seat].setLevel(botLevel_);
+        bots_[seat].syncFromState(static_cast<uint8_t>(seat), gameEngine_.getGameState());
+        player->setGameEngineEventListener(&bots_[seat]);
+        std::cout << "[Room] 玩家掉线，机器人代打: room=" << roomId_
+                  << ", playerId=" << playerId << ", seat=" << seat << std::endl;
+        driveBotsLocked();      // 掉线时正轮到该座位
+        return true;
+    }
+    return false;
+}
+
+std::shared_ptr<NetPlayer> Room::reconnectPlayer(const std::string& playerId, int clientFd, WebSocketServer* server) {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    if (state_ != RoomState::PLAYING) {
+        return nullptr;
+    }
+    for (const auto& player : players_) {
+        int seat = player->getSeat();
+        if (player->getPlayerId() != playerId || !takenOver_[seat]) {
+            continue;
+        }
+        // 机器人每次行动后都会处理完待办，交还时该座位没有未响应的动作
+        std::string nickname = player->getNickname();
+        player->reset(playerId, clientFd, server);
+        player->setNickname(nickname);
+        player->setSeat(seat);
+        takenOver_[seat] = false;
+        const tagGameState& state = gameEngine_.getGameState();
+        player->sendGameResume(state);
+        // 按日志恢复的房间里机器人还没有行动，该座位可能正等待响应：重发操作提示
+        if (state.cbUserAction[seat] != WIK_NULL && !state.bResponse[seat]) {
+            CMD_S_OperateNotify notify;
+            std::memset(&notify, 0, sizeof(notify));
+            notify.cbResumeUser = state.cbResumeUser;
+            notify.cbActionMask = state.cbUserAction[seat];
+            notify.cbActionCard = state.cbProvideCard;
+            notify.cbGangCount = state.cbGangCount;
+            std::memcpy(notify.cbGangCard, state.cbGangCard, sizeof(notify.cbGangCard));
+            player->onOperateNotifyEvent(notify);
+        }
+        std::cout << "[Room] 玩家重连，收回代打座位: room=" << roomId_
+                  << ", playerId=" << playerId << ", seat=" << seat << std::endl;
+        recovering_ = false;
+        driveBotsLocked();      // 恢复的房间从第一位真人重连开始继续
+        return player;
+    }
+    return nullptr;
+}
+
+bool Room::isBotSeat(int seat) const {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    return seat >= 0 && seat < kMaxPlayers && isBotSeatLocked(seat);
+}
+#endif
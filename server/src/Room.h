@@ -3,16 +3,25 @@
 
 #pragma once
 
+#include <chrono>
 #include <string>
 #include <vector>
 #include <memory>
-#include <map>
 #include <mutex>
 
+#include "LockStats.h"
+
 class NetPlayer;
+class WebSocketServer;
 
 #ifdef USE_GAME_ENGINE
 #include "game/GameEngine.h"
+#include "game/BotPlayer.h"
+#include "game/GameRecord.h"
+#include "RoomJournal.h"
+#include "MatchHistory.h"
+#include "Leaderboard.h"
+#include "ProfileCache.h"
 #endif
 
 enum class RoomState {
@@ -23,13 +32,25 @@ enum class RoomState {
 
 class Room {
 public:
+    static const int kMaxPlayers = 4;
+
     explicit Room(const std::string& id);
 
+    // 重置为空房间并绑定新的房间号（RoomDirectory 复用房间对象时调用）
+    void reset(const std::string& id);
+
     const std::string& getId() const { return roomId_; }
     RoomState getState() const { return state_; }
     
+    // 房间数据所在的 NUMA 节点（由 RoomDirectory 按槽位所属分片设置）
+    int getHomeNode() const { return homeNode_; }
+    void setHomeNode(int node) { homeNode_ = node; }
+    
     // 获取玩家数量（线程安全）
     size_t getPlayerCount() const;
+
+    // 房间是否空闲：没有玩家或游戏已结束（线程安全，供 RoomDirectory 回收判断）
+    bool isIdle() const;
     
     // 获取所有玩家（线程安全，返回副本）
     std::vector<std::shared_ptr<NetPlayer>> getPlayers() const;
@@ -40,6 +61,9 @@ public:
     // 根据 playerId 获取玩家
     std::shared_ptr<NetPlayer> getPlayerById(const std::string& playerId) const;
 
+    // 连接关闭：在房间锁内解除玩家与连接的绑定，返回后该玩家不再收到事件消息
+    void detachClient(const std::string& playerId);
+
     // 新玩家加入房间
     bool addPlayer(const std::shared_ptr<NetPlayer>& player);
     
@@ -49,6 +73,9 @@ public:
 
     // 启动一局游戏（使用 GameEngine）
     void startGame();
+
+    // 同一桌玩家继续下一局（复用 GameEngine，不重新分配）
+    bool restartGame();
     
     // 启动一局游戏（模拟版本，已废弃）
     void startGameMock();
@@ -57,18 +84,111 @@ public:
     void finishGame();
     
 #ifdef USE_GAME_ENGINE
-    // 获取 GameEngine（用于出牌等操作）
-    GameEngine* getGameEngine() { return gameEngine_.get(); }
+    // 获取 GameEngine（用于出牌等操作），游戏未开始时返回 nullptr
+    GameEngine* getGameEngine() { return state_ == RoomState::PLAYING ? &gameEngine_ : nullptr; }
+
+    // 机器人补位：第一位玩家进入后等待 fillDelay 仍未坐满，由机器人补齐空座位开局（0 为不补位）；
+    // 补位和掉线代打的机器人使用同一等级
+    void setBotPolicy(std::chrono::milliseconds fillDelay, BotLevel level);
+
+    // 牌局记录：之后开局的每一局（种子和命令）写到 writer，nullptr 为不记录；writer 须比房间活得久
+    void setRecordWriter(RecordWriter* writer);
+
+    // 崩溃恢复日志：之后开桌的每一局（座位、种子、命令）写进 journal，nullptr 为不写；journal 须比房间活得久
+    void setJournal(RoomJournal* journal);
+
+    // 对局历史：之后每局结束时把结算结果和座位上的玩家追加到 history，nullptr 为不记录；history 须比房间活得久
+    void setMatchHistory(MatchHistory* history);
+
+    // 排行榜：之后每局结束时把座位上真人玩家的单局积分提交给 leaderboard（不等待），nullptr 为不提交；
+    // leaderboard 须比房间活得久
+    void setLeaderboard(Leaderboard* leaderboard);
+
+    // 玩家档案：之后每局结束时把座位上真人玩家的单局积分累加进档案（只改缓存），nullptr 为不累加；
+    // profiles 须比房间活得久
+    void setProfileCache(ProfileCache* profiles);
+
+    // 检查点：游戏中的房间把座位和整局状态写进日志，返回是否写了（RoomDirectory::checkpoint 调用）
+    bool writeCheckpoint();
+
+    // 按日志恢复的状态重建房间（空房间上调用）：机器人回到原座位，真人座位由机器人代打但暂不行动，
+    // 等第一位真人重连（reconnectPlayer）后继续；kRecoveryGraceSeconds 内没有真人重连则放弃本局
+    bool recoverFromJournal(const RecoveredRoom& recovered);
+
+    // 定时检查（RoomDirectory 回收线程每轮扫描调用）：等待超时则机器人补位开局，返回是否开局；
+    // 恢复的房间等待重连超时则放弃本局
+    bool tick(std::chrono::steady_clock::time_point now);
+
+    // 玩家出牌、选择动作（由 MessageHandler 调用）：不是该座位的回合或座位由机器人控制时返回 false，
+    // 执行后机器人座位立即行动，直到轮到真人
+    bool onUserOutCard(int seat, uint8_t card);
+    bool onUserOperateCard(int seat, uint8_t operateCode, uint8_t card);
+
+    // 玩家掉线：游戏中由机器人接管座位并保留玩家，返回 true；不在游戏中返回 false，由调用方移除玩家。
+    // 最后一位在线真人掉线时不再代打（没人看），移除已代打的玩家并返回 false，房间随之空闲回收
+    bool onPlayerDisconnect(const std::string& playerId);
+
+    // 掉线玩家重连：收回机器人代打的座位，重新绑定连接并发送当前牌面，返回该玩家；
+    // 没有该玩家的代打座位时返回 nullptr
+    std::shared_ptr<NetPlayer> reconnectPlayer(const std::string& playerId, int clientFd, WebSocketServer* server);
+
+    // 座位是否由机器人控制（补位或代打）
+    bool isBotSeat(int seat) const;
 #endif
 
 private:
+    typedef std::chrono::steady_clock Clock;
+
+    static const int kMaxBotSteps = 1000;    // 机器人连续行动的上限（全部座位都是机器人时一局也在此之内）
+
+#ifdef USE_GAME_ENGINE
+    static const int kRecoveryGraceSeconds = 300;    // 恢复的房间等待真人重连的时长
+
+    // 引擎每执行一条命令（在事件发给玩家之前）转给牌局记录、崩溃恢复日志和对局历史，调用时房间持有 mutex_
+    class CommandTap : public IGameCommandListener {
+    public:
+        explicit CommandTap(Room* room) : room_(room) {}
+        void onCommandApplied(const tagGameCommand& command, uint8_t chairId, const tagGameState& state,
+                              const GameEventBuffer& events, uint8_t firstEvent) override;
+    private:
+        Room* room_;
+    };
+#endif
+
+#ifdef USE_GAME_ENGINE
+    void startGameLocked();                  // 开局（调用方持有 mutex_，真人和补位机器人共 4 人）
+    void driveBotsLocked();                  // 机器人座位依次行动，直到没有机器人要行动
+    bool isBotSeatLocked(int seat) const { return botSeats_[seat] || takenOver_[seat]; }
+    void journalSeatsLocked(JournalSeat seats[kMaxPlayers]) const;   // 本局座位上的玩家（写日志用）
+    void closeJournalLocked();               // 关桌：之后恢复时不再重建本房间
+    void recordGameEndLocked(const CMD_S_GameEnd& gameEnd);   // 本局结算写进对局历史、提交排行榜
+#endif
+
     std::string roomId_;
     RoomState state_;
+    int homeNode_;
     std::vector<std::shared_ptr<NetPlayer>> players_;
-    std::map<int, std::shared_ptr<NetPlayer>> playersBySeat_;  // 座位号 -> 玩家映射
-    mutable std::mutex mutex_;  // 保护房间数据的互斥锁
+    std::shared_ptr<NetPlayer> playersBySeat_[kMaxPlayers];  // 座位号 -> 玩家映射
+    std::shared_ptr<NetPlayer> gamePlayers_[kMaxPlayers];    // 本局注册到 GameEngine 的玩家，游戏期间保持引用
+    mutable InstrumentedMutex mutex_{"Room::mutex_"};  // 保护房间数据的互斥锁
+    Clock::time_point waitingSince_;                     // 第一位玩家进入的时间（机器人补位计时）
 #ifdef USE_GAME_ENGINE
-    std::unique_ptr<GameEngine> gameEngine_;  // 游戏引擎
+    GameEngine gameEngine_;  // 游戏引擎（嵌在房间对象里，随房间创建，每局复用）
+    BotPlayer bots_[kMaxPlayers];            // 每个座位一个机器人（补位或掉线代打），嵌在房间对象里
+    bool botSeats_[kMaxPlayers];             // 座位由补位机器人入座
+    bool takenOver_[kMaxPlayers];            // 真人座位掉线，由机器人代打
+    std::chrono::milliseconds botFillDelay_; // 机器人补位的等待时间，0 为不补位
+    BotLevel botLevel_;                      // 机器人等级
+    GameRecorder recorder_;                  // 牌局记录（嵌在房间对象里，一局写完整段交给 recordWriter_）
+    RecordWriter* recordWriter_;             // 牌局记录的写入器，nullptr 为不记录
+    RoomJournal* journal_;                   // 崩溃恢复日志，nullptr 为不写
+    uint32_t journalRoom_;                   // 本桌在日志内的编号，0 为未开桌
+    MatchHistory* matchHistory_;             // 对局历史，nullptr 为不记录
+    Leaderboard* leaderboard_;               // 排行榜，nullptr 为不提交
+    ProfileCache* profiles_;                 // 玩家档案，nullptr 为不累加
+    bool recovering_;                        // 按日志恢复后还没有真人重连，机器人暂不行动
+    Clock::time_point recoveredAt_;          // 恢复的时间（等待重连计时）
+    CommandTap commandTap_{this};
 #endif
 };
 
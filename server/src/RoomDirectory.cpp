@@ -0,0 +1,468 @@
+//
+// RoomDirectory.cpp
+// 房间目录实现
+//
+
+#include "RoomDirectory.h"
+#include "Room.h"
+#include "RoomJournal.h"
+#include "ThreadPlacement.h"
+#include "game/AlignedAlloc.h"
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+
+namespace {
+
+inline RoomId makeRoomId(size_t index, uint32_t generation) {
+    return static_cast<RoomId>(((generation & 0xFFFF) << 16) | ((index + 1) & 0xFFFF));
+}
+
+inline uint32_t roomIdGeneration(RoomId id) {
+    return id >> 16;
+}
+
+} // namespace
+
+RoomDirectory::RoomDirectory(const Config& config)
+    : config_(config)
+    , nodeCount_(1)
+    , shards_(new Shard[kShardCount])
+    , createdTotal_(0)
+    , reapedTotal_(0)
+    , journal_(nullptr)
+    , checkpointInterval_(0)
+    , reaperRunning_(false) {
+    // ID 低 16 位存放槽位序号，总槽位数不能超过 kMaxRooms
+    if (config_.slotsPerShard == 0) {
+        config_.slotsPerShard = 1;
+    }
+    if (config_.slotsPerShard * kShardCount > kMaxRooms) {
+        config_.slotsPerShard = kMaxRooms / kShardCount;
+    }
+    for (size_t s = 0; s < kShardCount; s++) {
+        Shard& shard = shards_[s];
+        shard.slots.reset(new Slot[config_.slotsPerShard]);
+        shard.freeSlots.reserve(config_.slotsPerShard);
+        for (size_t i = config_.slotsPerShard; i > 0; i--) {
+            shard.freeSlots.push_back(static_cast<uint16_t>(i - 1));
+        }
+        shard.aliases.reserve(config_.slotsPerShard);
+    }
+    expired_.reserve(config_.slotsPerShard);
+    if (config_.numaAware) {
+        nodeCount_ = std::max(1, std::min(ThreadPlacement::nodeCount(), static_cast<int>(kShardCount)));
+    }
+    // 预先创建房间对象：多节点时每个节点由绑定到该节点的线程创建，保证房间内存落在本节点
+    size_t preallocated = std::min(config_.preallocatedRooms, capacity());
+    if (nodeCount_ == 1) {
+        preallocate(0, preallocated);
+        return;
+    }
+    std::vector<std::thread> threads;
+    for (int node = 0; node < nodeCount_; node++) {
+        threads.push_back(std::thread([this, node, preallocated]() {
+            ThreadPlacement::migrateCurrentThreadToNode(node, std::vector<int>());
+            preallocate(node, preallocated);
+        }));
+    }
+    for (size_t i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+}
+
+void RoomDirectory::preallocate(int node, size_t count) {
+    // 按分片轮流放置，与空闲列表的分配顺序一致
+    for (size_t i = 0; i < count; i++) {
+        size_t s = i % kShardCount;
+        if (shardNode(s) != node) {
+            continue;
+        }
+        std::shared_ptr<Room> room = std::allocate_shared<Room>(AlignedAllocator<Room>(), "");
+        room->setHomeNode(node);
+        shards_[s].slots[i / kShardCount].owner = room;
+    }
+}
+
+RoomDirectory::~RoomDirectory() {
+    stopReaper();
+}
+
+RoomDirectory::Shard& RoomDirectory::aliasShard(const std::string& alias) const {
+    return shards_[std::hash<std::string>()(alias) % kShardCount];
+}
+
+RoomDirectory::Slot* RoomDirectory::resolve(RoomId id, size_t& shardIndex) const {
+    size_t index = id & 0xFFFF;
+    if (index == 0 || index > capacity()) {
+        return nullptr;
+    }
+    index -= 1;
+    shardIndex = index / config_.slotsPerShard;
+    return &shards_[shardIndex].slots[index % config_.slotsPerShard];
+}
+
+std::shared_ptr<Room> RoomDirectory::getOrCreate(const std::string& alias) {
+    if (alias.empty()) {
+        return nullptr;
+    }
+
+    Shard& shard = aliasShard(alias);
+    std::lock_guard<InstrumentedMutex> lock(shard.aliasMutex);
+
+    auto it = shard.aliases.find(alias);
+    if (it != shard.aliases.end()) {
+        std::shared_ptr<Room> room = find(it->second);
+        if (room) {
+            return room;
+        }
+        shard.aliases.erase(it);
+    }
+
+    // 槽位优先从别名所在分片分配，满了再依次尝试其他分片；
+    // 按 NUMA 划分时先只看调用线程所在节点的分片，都满了再跨节点
+    size_t preferred = std::hash<std::string>()(alias) % kShardCount;
+    int node = nodeCount_ > 1 ? ThreadPlacement::currentNode() % nodeCount_ : 0;
+    std::shared_ptr<Room> room;
+    RoomId id = kInvalidRoomId;
+    for (size_t n = 0; n < kShardCount * 2 && id == kInvalidRoomId; n++) {
+        size_t s = (preferred + n) % kShardCount;
+        bool local = shardNode(s) == node;
+        if ((n < kShardCount) != local) {
+            continue;
+        }
+        Shard& target = shards_[s];
+        std::lock_guard<InstrumentedMutex> slotLock(target.slotMutex);
+        if (target.freeSlots.empty()) {
+            continue;
+        }
+        uint16_t slotIndex = target.freeSlots.back();
+        target.freeSlots.pop_back();
+
+        Slot& slot = target.slots[slotIndex];
+        id = makeRoomId(s * config_.slotsPerShard + slotIndex, slot.generation.load(std::memory_order_relaxed));
+        if (slot.owner) {
+            slot.owner->reset(alias);                    // 复用池化的房间对象
+        } else {
+            // 房间对象由调用线程创建、首次访问，物理页在调用线程所在节点，不一定是分片的节点
+            slot.owner = std::allocate_shared<Room>(AlignedAllocator<Room>(), alias);
+            slot.owner->setHomeNode(node);
+        }
+        slot.alias = alias;
+        slot.idle = false;
+        std::atomic_store(&slot.live, slot.owner);
+        room = slot.owner;
+    }
+
+    if (id == kInvalidRoomId) {
+        std::cout << "[RoomDirectory] 房间数量已达上限 (" << capacity() << ")，无法创建: " << alias << std::endl;
+        return nullptr;
+    }
+
+    shard.aliases[alias] = id;
+    createdTotal_++;
+    std::cout << "[RoomDirectory] 创建新房间: " << alias << " (id=" << id << ")" << std::endl;
+    return room;
+}
+
+std::shared_ptr<Room> RoomDirectory::find(RoomId id) const {
+    size_t shardIndex = 0;
+    const Slot* slot = resolve(id, shardIndex);
+    if (slot == nullptr) {
+        return nullptr;
+    }
+
+    // 先取引用再核对代数：回收时先递增代数再清空槽位，复用时代数已经是新的；
+    // atomic_load 与 detach 中的 atomic_store 互斥，要么这里拿到引用（detach 随后看到引用计数不为 1），
+    // 要么拿到空指针
+    std::shared_ptr<Room> room = std::atomic_load(&slot->live);
+    if (!room || (slot->generation.load(std::memory_order_acquire) & 0xFFFF) != roomIdGeneration(id)) {
+        return nullptr;
+    }
+    return room;
+}
+
+std::shared_ptr<Room> RoomDirectory::findByAlias(const std::string& alias) const {
+    RoomId id = lookupId(alias);
+    return id != kInvalidRoomId ? find(id) : nullptr;
+}
+
+RoomId RoomDirectory::lookupId(const std::string& alias) const {
+    Shard& shard = aliasShard(alias);
+    std::lock_guard<InstrumentedMutex> lock(shard.aliasMutex);
+    auto it = shard.aliases.find(alias);
+    return it != shard.aliases.end() ? it->second : kInvalidRoomId;
+}
+
+bool RoomDirectory::detach(RoomId id, bool onlyIfIdle) {
+    size_t shardIndex = 0;
+    Slot* slot = resolve(id, shardIndex);
+    if (slot == nullptr) {
+        return false;
+    }
+
+    std::shared_ptr<Room> released;     // 放弃的引用在槽位锁外析构
+    std::shared_ptr<Room> reusable;     // 待复用的房间对象在槽位锁外重置
+    Shard& shard = shards_[shardIndex];
+    uint16_t slotIndex = static_cast<uint16_t>(slot - shard.slots.get());
+    {
+        std::lock_guard<InstrumentedMutex> lock(shard.slotMutex);
+        if (!slot->live
+            || (slot->generation.load(std::memory_order_relaxed) & 0xFFFF) != roomIdGeneration(id)) {
+            return false;
+        }
+        if (onlyIfIdle && !slot->owner->isIdle()) {
+            return false;
+        }
+
+        slot->generation.fetch_add(1, std::memory_order_release);
+        std::atomic_store(&slot->live, std::shared_ptr<Room>());
+
+        if (slot->owner.use_count() == 1) {
+            // 没有其他引用（槽位已清空，之后的查找拿不到）：取出重置后放回槽位等待复用
+            reusable = std::move(slot->owner);
+        } else {
+            // 仍被外部持有，不能复用：目录放弃引用，由最后一个持有者释放
+            released = std::move(slot->owner);
+        }
+
+        slot->alias.clear();
+        slot->idle = false;
+        if (!reusable) {
+            shard.freeSlots.push_back(slotIndex);
+            return true;
+        }
+    }
+
+    // 重置会写回牌局记录、关闭日志（可能等待落盘），不占用槽位锁；
+    // 此时槽位既不在空闲列表中也没有房间，其他线程不会访问
+    reusable->reset(std::string());     // 释放对玩家的引用
+
+    std::lock_guard<InstrumentedMutex> lock(shard.slotMutex);
+    slot->owner = std::move(reusable);
+    shard.freeSlots.push_back(slotIndex);
+    return true;
+}
+
+bool RoomDirectory::remove(RoomId id) {
+    return removeInternal(id, false);
+}
+
+bool RoomDirectory::removeInternal(RoomId id, bool onlyIfIdle) {
+    size_t shardIndex = 0;
+    Slot* slot = resolve(id, shardIndex);
+    if (slot == nullptr) {
+        return false;
+    }
+
+    // 锁顺序：别名分片锁 -> 槽位分片锁，先取出别名再按顺序加锁
+    std::string alias;
+    {
+        std::lock_guard<InstrumentedMutex> lock(shards_[shardIndex].slotMutex);
+        if ((slot->generation.load(std::memory_order_relaxed) & 0xFFFF) != roomIdGeneration(id)) {
+            return false;
+        }
+        alias = slot->alias;
+    }
+
+    Shard& shard = aliasShard(alias);
+    std::lock_guard<InstrumentedMutex> lock(shard.aliasMutex);
+    if (!detach(id, onlyIfIdle)) {
+        return false;
+    }
+    auto it = shard.aliases.find(alias);
+    if (it != shard.aliases.end() && it->second == id) {
+        shard.aliases.erase(it);
+    }
+    std::cout << "[RoomDirectory] 回收房间: " << alias << " (id=" << id << ")" << std::endl;
+    return true;
+}
+
+size_t RoomDirectory::reapIdle() {
+    std::lock_guard<std::mutex> reapLock(reapMutex_);
+    Clock::time_point now = Clock::now();
+    size_t reaped = 0;
+    std::vector<RoomId>& expired = expired_;
+
+    for (size_t s = 0; s < kShardCount; s++) {
+        Shard& shard = shards_[s];
+        expired.clear();
+        {
+            std::lock_guard<InstrumentedMutex> lock(shard.slotMutex);
+            for (size_t i = 0; i < config_.slotsPerShard; i++) {
+                Slot& slot = shard.slots[i];
+                if (!slot.live) {
+                    continue;
+                }
+                if (!slot.owner->isIdle()) {
+                    slot.idle = false;
+                    continue;
+                }
+                if (!slot.idle) {
+                    slot.idle = true;
+                    slot.idleSince = now;
+                }
+                if (now - slot.idleSince >= config_.idleTtl) {
+                    expired.push_back(makeRoomId(s * config_.slotsPerShard + i,
+                                                 slot.generation.load(std::memory_order_relaxed)));
+                }
+            }
+        }
+        // 加锁顺序要求先拿别名锁，这里释放槽位锁后再逐个摘除（摘除时会再次确认空闲）
+        for (size_t i = 0; i < expired.size(); i++) {
+            if (removeInternal(expired[i], true)) {
+                reaped++;
+            }
+        }
+    }
+
+    reapedTotal_ += reaped;
+    return reaped;
+}
+
+size_t RoomDirectory::tickRooms() {
+    std::lock_guard<std::mutex> reapLock(reapMutex_);
+    std::vector<std::shared_ptr<Room>>& rooms = ticking_;
+    size_t started = 0;
+    for (size_t s = 0; s < kShardCount; s++) {
+        Shard& shard = shards_[s];
+        rooms.clear();
+        {
+            std::lock_guard<InstrumentedMutex> lock(shard.slotMutex);
+            for (size_t i = 0; i < config_.slotsPerShard; i++) {
+                Slot& slot = shard.slots[i];
+                if (slot.live) {
+                    rooms.push_back(slot.owner);
+                }
+            }
+        }
+        // 开局会向玩家发送消息，在槽位锁外执行
+        Clock::time_point now = Clock::now();
+        for (size_t i = 0; i < rooms.size(); i++) {
+            if (rooms[i]->tick(now)) {
+                started++;
+            }
+        }
+    }
+    rooms.clear();
+    return started;
+}
+
+void RoomDirectory::setJournal(RoomJournal* journal, std::chrono::milliseconds interval) {
+    std::lock_guard<std::mutex> reapLock(reapMutex_);
+    journal_ = journal;
+    checkpointInterval_ = interval;
+    lastCheckpoint_ = Clock::now();
+}
+
+size_t RoomDirectory::checkpoint() {
+    std::lock_guard<std::mutex> reapLock(reapMutex_);
+    if (journal_ == nullptr) {
+        return 0;
+    }
+    std::vector<std::shared_ptr<Room>>& rooms = ticking_;
+    size_t written = 0;
+    // 先换文件再逐个写状态：房间在换文件之后写的命令都排在自己的状态记录之后或已包含在状态里
+    journal_->beginCheckpoint();
+    for (size_t s = 0; s < kShardCount; s++) {
+        Shard& shard = shards_[s];
+        rooms.clear();
+        {
+            std::lock_guard<InstrumentedMutex> lock(shard.slotMutex);
+            for (size_t i = 0; i < config_.slotsPerShard; i++) {
+                Slot& slot = shard.slots[i];
+                if (slot.live) {
+                    rooms.push_back(slot.owner);
+                }
+            }
+        }
+        for (size_t i = 0; i < rooms.size(); i++) {
+            if (rooms[i]->writeCheckpoint()) {
+                written++;
+            }
+        }
+    }
+    rooms.clear();
+    journal_->endCheckpoint();
+    lastCheckpoint_ = Clock::now();
+    return written;
+}
+
+RoomDirectory::Stats RoomDirectory::getStats() const {
+    Stats stats;
+    stats.liveRooms = 0;
+    stats.pooledRooms = 0;
+    stats.aliases = 0;
+    for (size_t s = 0; s < kShardCount; s++) {
+        const Shard& shard = shards_[s];
+        {
+            std::lock_guard<InstrumentedMutex> lock(shard.aliasMutex);
+            stats.aliases += shard.aliases.size();
+        }
+        std::lock_guard<InstrumentedMutex> lock(shard.slotMutex);
+        stats.liveRooms += config_.slotsPerShard - shard.freeSlots.size();
+        for (size_t i = 0; i < config_.slotsPerShard; i++) {
+            if (shard.slots[i].owner) {
+                stats.pooledRooms++;
+            }
+        }
+    }
+    stats.createdTotal = createdTotal_.load();
+    stats.reapedTotal = reapedTotal_.load();
+    return stats;
+}
+
+void RoomDirectory::startReaper() {
+    std::lock_guard<std::mutex> lock(reaperMutex_);
+    if (reaperRunning_) {
+        return;
+    }
+    reaperRunning_ = true;
+    reaper_ = std::thread(&RoomDirectory::reaperLoop, this);
+}
+
+void RoomDirectory::stopReaper() {
+    {
+        std::lock_guard<std::mutex> lock(reaperMutex_);
+        if (!reaperRunning_) {
+            return;
+        }
+        reaperRunning_ = false;
+    }
+    reaperCv_.notify_all();
+    if (reaper_.joinable()) {
+        reaper_.join();
+    }
+}
+
+void RoomDirectory::reaperLoop() {
+    std::unique_lock<std::mutex> lock(reaperMutex_);
+    while (reaperRunning_) {
+        reaperCv_.wait_for(lock, config_.reapInterval);
+        if (!reaperRunning_) {
+            break;
+        }
+        lock.unlock();
+        size_t started = tickRooms();
+        if (started > 0) {
+            std::cout << "[RoomDirectory] 本轮机器人补位开局 " << started << " 个房间" << std::endl;
+        }
+        size_t reaped = reapIdle();
+        if (reaped > 0) {
+            Stats stats = getStats();
+            std::cout << "[RoomDirectory] 本轮回收 " << reaped << " 个房间，当前房间数 " << stats.liveRooms << std::endl;
+        }
+        bool checkpointDue;
+        {
+            std::lock_guard<std::mutex> reapLock(reapMutex_);
+            checkpointDue = journal_ != nullptr && checkpointInterval_.count() > 0
+                && Clock::now() - lastCheckpoint_ >= checkpointInterval_;
+        }
+        if (checkpointDue) {
+            size_t written = checkpoint();
+            std::cout << "[RoomDirectory] 检查点：" << written << " 个房间" << std::endl;
+        }
+        lock.lock();
+    }
+}
@@ -0,0 +1,152 @@
+//
+// RoomDirectory.h
+// 房间目录：分片的并发房间注册表，空闲房间由后台线程回收、池化复用
+//
+
+#ifndef ROOM_DIRECTORY_H
+#define ROOM_DIRECTORY_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "LockStats.h"
+
+class Room;
+class RoomJournal;
+
+typedef uint32_t RoomId;
+
+const RoomId kInvalidRoomId = 0;
+
+class RoomDirectory {
+public:
+    struct Config {
+        size_t slotsPerShard;                        // 每个分片的槽位数（房间总上限 = 分片数 * 槽位数）
+        std::chrono::milliseconds idleTtl;           // 空闲或已结束的房间保留时长
+        std::chrono::milliseconds reapInterval;      // 回收线程扫描间隔
+        size_t preallocatedRooms;                    // 启动时预先创建的房间对象数
+        bool numaAware;                              // 分片按 NUMA 节点划分，房间优先分配在调用线程所在节点
+
+        Config()
+            : slotsPerShard(256)
+            , idleTtl(std::chrono::minutes(5))
+            , reapInterval(std::chrono::seconds(1))
+            , preallocatedRooms(64)
+            , numaAware(false) {
+        }
+    };
+
+    struct Stats {
+        size_t liveRooms;          // 目录中的房间数
+        size_t pooledRooms;        // 已创建的房间对象数（含空闲槽位上待复用的）
+        size_t aliases;            // 别名数量
+        uint64_t createdTotal;     // 累计创建
+        uint64_t reapedTotal;      // 累计回收
+    };
+
+    static const size_t kShardCount = 16;
+    static const size_t kMaxRooms = 0xFFFF;
+
+    explicit RoomDirectory(const Config& config = Config());
+    ~RoomDirectory();
+
+    // 根据别名获取房间，不存在时创建；目录已满时返回 nullptr
+    std::shared_ptr<Room> getOrCreate(const std::string& alias);
+
+    // 根据整数 ID 查找房间（不拿分片锁），ID 已失效时返回 nullptr
+    std::shared_ptr<Room> find(RoomId id) const;
+
+    // 根据别名查找房间
+    std::shared_ptr<Room> findByAlias(const std::string& alias) const;
+
+    // 根据别名查询整数 ID，不存在时返回 kInvalidRoomId
+    RoomId lookupId(const std::string& alias) const;
+
+    // 立即将房间移出目录
+    bool remove(RoomId id);
+
+    // 执行一次回收扫描，返回本次回收的房间数（回收线程内部调用，也可手动调用）
+    size_t reapIdle();
+
+    // 对目录中的每个房间调用一次 Room::tick，返回因此开局的房间数（回收线程内部调用，也可手动调用）
+    size_t tickRooms();
+
+    // 崩溃恢复日志：回收线程每隔 interval 写一次检查点（0 为只在调用 checkpoint 时写）
+    void setJournal(RoomJournal* journal, std::chrono::milliseconds interval);
+
+    // 写一次检查点：日志换到新文件，游戏中的房间各写一条整局状态，之后删除旧文件；返回写了状态的房间数
+    size_t checkpoint();
+
+    // 启动/停止后台回收线程
+    void startReaper();
+    void stopReaper();
+
+    Stats getStats() const;
+    size_t capacity() const { return kShardCount * config_.slotsPerShard; }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Slot {
+        std::shared_ptr<Room> live;           // 目录中的房间，空槽位为空（持 slotMutex 用 std::atomic_store 写，
+                                              // find 用 std::atomic_load 读）
+        std::atomic<uint32_t> generation;     // 槽位代数，每次回收 +1
+        std::shared_ptr<Room> owner;          // 槽位上的池化房间对象，空闲时也保留（受 slotMutex 保护）
+        std::string alias;                    // 绑定的别名（受 slotMutex 保护）
+        bool idle;                            // 上次扫描时是否空闲（受 slotMutex 保护）
+        Clock::time_point idleSince;          // 开始空闲的时间（受 slotMutex 保护）
+
+        Slot() : generation(0), idle(false) {}
+    };
+
+    struct Shard {
+        mutable InstrumentedMutex aliasMutex{"RoomDirectory::aliasMutex"};  // 保护 aliases
+        std::unordered_map<std::string, RoomId> aliases;     // 别名 -> ID（按别名哈希分片）
+        mutable InstrumentedMutex slotMutex{"RoomDirectory::slotMutex"};    // 保护 freeSlots 以及槽位写入
+        std::unique_ptr<Slot[]> slots;                       // 固定数量的槽位（按 ID 分片）
+        std::vector<uint16_t> freeSlots;                     // 空闲槽位
+    };
+
+    Config config_;
+    int nodeCount_;                        // 分片划分的节点数（未开启 numaAware 时为 1）
+    std::unique_ptr<Shard[]> shards_;
+    std::atomic<uint64_t> createdTotal_;
+    std::atomic<uint64_t> reapedTotal_;
+
+    std::mutex reapMutex_;                 // 串行化回收扫描
+    std::vector<RoomId> expired_;          // 回收扫描的临时列表（受 reapMutex_ 保护，复用容量）
+    std::vector<std::shared_ptr<Room>> ticking_;   // tickRooms、checkpoint 的临时列表（受 reapMutex_ 保护，复用容量）
+    RoomJournal* journal_;                 // 崩溃恢复日志（受 reapMutex_ 保护）
+    std::chrono::milliseconds checkpointInterval_;
+    Clock::time_point lastCheckpoint_;
+
+    std::thread reaper_;
+    std::mutex reaperMutex_;
+    std::condition_variable reaperCv_;
+    bool reaperRunning_;
+
+    Shard& aliasShard(const std::string& alias) const;
+    int shardNode(size_t shardIndex) const { return static_cast<int>(shardIndex % nodeCount_); }
+
+    // 在当前线程上创建属于 node 的预分配房间
+    void preallocate(int node, size_t count);
+    Slot* resolve(RoomId id, size_t& shardIndex) const;
+
+    // 移除房间（onlyIfIdle 为 true 时仅在房间仍空闲时移除）
+    bool removeInternal(RoomId id, bool onlyIfIdle);
+
+    // 将房间从槽位中摘除（调用方需持有别名分片锁），返回是否成功
+    bool detach(RoomId id, bool onlyIfIdle);
+
+    void reaperLoop();
+};
+
+#endif // ROOM_DIRECTORY_H
@@ -0,0 +1,703 @@
+//
+// RoomJournal.cpp
+// 房间日志实现
+//
+// 记录格式（本机字节序，按 4 字节对齐）：
+//   [0, 4)  校验：FNV-1a，覆盖 [4, 长度)
+//   [4, 6)  长度（含头部和对齐填充）
+//   [6]     类型 JournalRecordKind
+//   [7]     保留
+//   [8, 12) 日志内的房间编号（文件头、检查点结束为 0）
+//   之后为记录体，字符串为 1 字节长度 + 内容（最长 255）
+//
+
+#include "RoomJournal.h"
+#include "game/AlignedAlloc.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const uint32_t kJournalMagic = 0x4C4A4D4DU;          // "MMJL"
+const uint16_t kJournalVersion = 1;
+const size_t kRecordHeaderSize = 12;
+const size_t kMaxRecordSize = 4096;
+const size_t kMinFileBytes = 64 * 1024;
+
+enum JournalRecordKind {
+    JournalRecord_File = 1,            // 文件头：魔数、版本、文件序号
+    JournalRecord_Table,               // 开桌：房间号、座位
+    JournalRecord_Start,               // 开局：种子、庄家、座位数、机器人掩码
+    JournalRecord_Command,             // 命令：类型 + 3 字节参数
+    JournalRecord_Close,               // 关桌
+    JournalRecord_State,               // 检查点：状态版本、状态大小、房间号、座位、tagGameState
+    JournalRecord_CheckpointEnd        // 检查点结束
+};
+
+uint32_t fnv1a(const uint8_t* data, size_t size) {
+    uint32_t hash = 2166136261U;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 16777619U;
+    }
+    return hash;
+}
+
+// 在栈上编一条记录
+class RecordBuilder {
+public:
+    RecordBuilder(uint8_t kind, uint32_t room) : size_(kRecordHeaderSize) {
+        std::memset(data_, 0, kRecordHeaderSize);
+        data_[6] = kind;
+        std::memcpy(data_ + 8, &room, sizeof(room));
+    }
+
+    template <typename T>
+    void put(const T& value) {
+        putBytes(&value, sizeof(value));
+    }
+
+    void putBytes(const void* bytes, size_t size) {
+        std::memcpy(data_ + size_, bytes, size);
+        size_ += size;
+    }
+
+    void putString(const std::string& text) {
+        uint8_t length = static_cast<uint8_t>(std::min<size_t>(text.size(), 255));
+        put(length);
+        putBytes(text.data(), length);
+    }
+
+    void putSeats(const JournalSeat seats[GAME_PLAYER]) {
+        for (int i = 0; i < GAME_PLAYER; i++) {
+            put(static_cast<uint8_t>(seats[i].bot ? 1 : 0));
+            putString(seats[i].playerId);
+            putString(seats[i].nickname);
+        }
+    }
+
+    // 补齐到 4 字节，写入长度和校验
+    const uint8_t* finish() {
+        while (size_ % 4 != 0) {
+            data_[size_++] = 0;
+        }
+        uint16_t size = static_cast<uint16_t>(size_);
+        std::memcpy(data_ + 4, &size, sizeof(size));
+        uint32_t checksum = fnv1a(data_ + 4, size_ - 4);
+        std::memcpy(data_, &checksum, sizeof(checksum));
+        return data_;
+    }
+
+    size_t size() const { return size_; }
+
+private:
+    uint8_t data_[kMaxRecordSize];
+    size_t size_;
+};
+
+// 读取记录体
+class RecordReader {
+public:
+    RecordReader(const uint8_t* data, size_t size) : data_(data), left_(size), ok_(true) {}
+
+    template <typename T>
+    T get() {
+        T value;
+        std::memset(&value, 0, sizeof(value));
+        getBytes(&value, sizeof(value));
+        return value;
+    }
+
+    void getBytes(void* bytes, size_t size) {
+        if (size > left_) {
+            ok_ = false;
+            return;
+        }
+        std::memcpy(bytes, data_, size);
+        data_ += size;
+        left_ -= size;
+    }
+
+    std::string getString() {
+        uint8_t length = get<uint8_t>();
+        if (length > left_) {
+            ok_ = false;
+            return std::string();
+        }
+        std::string text(reinterpret_cast<const char*>(data_), length);
+        data_ += length;
+        left_ -= length;
+        return text;
+    }
+
+    void getSeats(JournalSeat seats[GAME_PLAYER]) {
+        for (int i = 0; i < GAME_PLAYER; i++) {
+            seats[i].bot = get<uint8_t>() != 0;
+            seats[i].playerId = getString();
+            seats[i].nickname = getString();
+        }
+    }
+
+    bool ok() const { return ok_; }
+
+private:
+    const uint8_t* data_;
+    size_t left_;
+    bool ok_;
+};
+
+// 恢复过程中的一个房间：用引擎重放
+struct ReplayRoom {
+    std::string roomId;
+    JournalSeat seats[GAME_PLAYER];
+    GameEngine engine;
+    bool started;          // 已开局（或已从检查点恢复）
+    bool broken;           // 状态版本不符，之后的命令无法重放
+
+    ReplayRoom() : started(false), broken(false) {
+        engine.setQuiet(true);
+    }
+
+    // 内嵌引擎按缓存行对齐，new ReplayRoom 同样按对齐分配（见 AlignedAlloc.h）
+    static void* operator new(std::size_t size) { return alignedAllocate(size, alignof(ReplayRoom)); }
+    static void operator delete(void* p) { alignedRelease(p); }
+};
+
+typedef std::map<uint32_t, std::unique_ptr<ReplayRoom>> ReplayRooms;
+
+// 重放一条记录
+void replayRecord(uint8_t kind, uint32_t room, RecordReader& reader, ReplayRooms& rooms, RecoveryStats& stats) {
+    auto it = rooms.find(room);
+    ReplayRoom* replay = it != rooms.end() ? it->second.get() : nullptr;
+    switch (kind) {
+        case JournalRecord_Table: {
+            std::unique_ptr<ReplayRoom> created(new ReplayRoom());
+            created->roomId = reader.getString();
+            reader.getSeats(created->seats);
+            rooms[room] = std::move(created);
+            break;
+        }
+        case JournalRecord_Start: {
+            uint64_t gameSeed = reader.get<uint64_t>();
+            uint8_t bankerUser = reader.get<uint8_t>();
+            uint8_t playerCount = reader.get<uint8_t>();
+            uint8_t androidMask = reader.get<uint8_t>();
+            if (replay == nullptr || replay->broken || !reader.ok()) {
+                break;
+            }
+            replay->engine.setBankerUser(bankerUser);
+            replay->engine.setGameSeed(gameSeed);
+            GameEventBuffer events;
+            replay->engine.apply(tagGameCommand::makeStart(playerCount, androidMask), events);
+            replay->started = true;
+            stats.commands++;
+            break;
+        }
+        case JournalRecord_Command: {
+            uint8_t args[4];
+            reader.getBytes(args, sizeof(args));
+            if (replay == nullptr || replay->broken || !replay->started || !reader.ok()) {
+                break;
+            }
+            tagGameCommand command;
+            std::memset(&command, 0, sizeof(command));
+            command.cbKind = args[0];
+            if (command.cbKind == GameCommand_OutCard) {
+                command.OutCard.cbCardData = args[1];
+            } else if (command.cbKind == GameCommand_OperateCard) {
+                command.OperateCard.cbOperateUser = args[1];
+                command.OperateCard.cbOperateCode = args[2];
+                command.OperateCard.cbOperateCard = args[3];
+            } else if (command.cbKind == GameCommand_Conclude) {
+                command.cbConcludeUser = args[1];
+            }
+            GameEventBuffer events;
+            replay->engine.apply(command, events);
+            stats.commands++;
+            break;
+        }
+        case JournalRecord_Close:
+            if (it != rooms.end()) {
+                rooms.erase(it);
+            }
+            break;
+        case JournalRecord_State: {
+            uint16_t stateVersion = reader.get<uint16_t>();
+            reader.get<uint16_t>();
+            uint32_t stateSize = reader.get<uint32_t>();
+            std::unique_ptr<ReplayRoom>& slot = rooms[room];
+            if (!slot) {
+                slot.reset(new ReplayRoom());
+            }
+            slot->roomId = reader.getString();
+            reader.getSeats(slot->seats);
+            tagGameState state;
+            if (stateVersion != GAME_STATE_VERSION || stateSize != sizeof(tagGameState)) {
+                slot->broken = true;
+                break;
+            }
+            reader.getBytes(&state, sizeof(state));
+            if (!reader.ok()) {
+                slot->broken = true;
+                break;
+            }
+            slot->engine.restore(state);
+            slot->started = true;
+            slot->broken = false;
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+// 读取一个文件的全部有效记录，返回是否读到文件末尾（false 为遇到不完整或校验不符的记录）
+bool replayFile(const std::string& path, ReplayRooms& rooms, uint32_t& maxRoom, RecoveryStats& stats) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(kRecordHeaderSize)) {
+        ::close(fd);
+        return true;
+    }
+    size_t fileSize = static_cast<size_t>(st.st_size);
+    void* mapped = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    const uint8_t* data = static_cast<const uint8_t*>(mapped);
+    size_t offset = 0;
+    bool clean = true;
+    bool first = true;
+    while (offset + kRecordHeaderSize <= fileSize) {
+        const uint8_t* record = data + offset;
+        uint32_t checksum;
+        uint16_t size;
+        uint32_t room;
+        std::memcpy(&checksum, record, sizeof(checksum));
+        std::memcpy(&size, record + 4, sizeof(size));
+        std::memcpy(&room, record + 8, sizeof(room));
+        uint8_t kind = record[6];
+        if (size == 0 && checksum == 0) {
+            break;          // 文件中未写的部分
+        }
+        if (size < kRecordHeaderSize || size % 4 != 0 || offset + size > fileSize
+            || fnv1a(record + 4, size - 4) != checksum || (first && kind != JournalRecord_File)) {
+            clean = false;
+            break;
+        }
+        RecordReader reader(record + kRecordHeaderSize, size - kRecordHeaderSize);
+        if (first) {
+            if (reader.get<uint32_t>() != kJournalMagic || reader.get<uint16_t>() != kJournalVersion) {
+                clean = false;
+                break;
+            }
+            first = false;
+        } else {
+            replayRecord(kind, room, reader, rooms, stats);
+        }
+        maxRoom = std::max(maxRoom, room);
+        stats.records++;
+        stats.bytes += size;
+        offset += size;
+    }
+    // 末尾不足一个记录头的部分应当全是 0
+    for (size_t i = offset; clean && i < fileSize && i < offset + kRecordHeaderSize; i++) {
+        clean = data[i] == 0;
+    }
+    munmap(mapped, fileSize);
+    return clean;
+}
+
+void msyncRange(uint8_t* base, size_t from, size_t to) {
+    static const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t begin = from & ~(pageSize - 1);
+    if (to > begin) {
+        msync(base + begin, to - begin, MS_SYNC);
+    }
+}
+
+} // namespace
+
+RoomJournal::RoomJournal(const Config& config)
+    : config_(config)
+    , fd_(-1)
+    , base_(nullptr)
+    , used_(0)
+    , syncedInFile_(0)
+    , fileSeq_(0)
+    , firstSeq_(0)
+    , checkpointSeq_(0)
+    , nextRoom_(1)
+    , written_(0)
+    , syncedBytes_(0)
+    , syncCount_(0)
+    , stop_(false) {
+    if (config_.fileBytes < kMinFileBytes) {
+        config_.fileBytes = kMinFileBytes;
+    }
+}
+
+RoomJournal::~RoomJournal() {
+    close();
+}
+
+std::string RoomJournal::filePath(uint32_t seq) const {
+    char suffix[16];
+    std::snprintf(suffix, sizeof(suffix), ".%08u", seq);
+    return config_.path + suffix;
+}
+
+bool RoomJournal::open(std::vector<RecoveredRoom>& rooms, RecoveryStats* stats) {
+    close();
+    Clock::time_point begin = Clock::now();
+    RecoveryStats local;
+    RecoveryStats& recovery = stats != nullptr ? *stats : local;
+    recovery = RecoveryStats();
+
+    // 找出 <path>.NNNNNNNN 形式的文件，按序号重放
+    std::string::size_type slash = config_.path.rfind('/');
+    std::string dir = slash == std::string::npos ? "." : (slash == 0 ? "/" : config_.path.substr(0, slash));
+    std::string prefix = (slash == std::string::npos ? config_.path : config_.path.substr(slash + 1)) + ".";
+    std::vector<uint32_t> seqs;
+    if (DIR* d = opendir(dir.c_str())) {
+        while (struct dirent* entry = readdir(d)) {
+            std::string name = entry->d_name;
+            if (name.size() != prefix.size() + 8 || name.compare(0, prefix.size(), prefix) != 0) {
+                continue;
+            }
+            std::string digits = name.substr(prefix.size());
+            if (digits.find_first_not_of("0123456789") == std::string::npos) {
+                seqs.push_back(static_cast<uint32_t>(std::strtoul(digits.c_str(), nullptr, 10)));
+            }
+        }
+        closedir(d);
+    }
+    std::sort(seqs.begin(), seqs.end());
+
+    ReplayRooms replay;
+    uint32_t maxRoom = 0;
+    for (size_t i = 0; i < seqs.size(); i++) {
+        if (!replayFile(filePath(seqs[i]), replay, maxRoom, recovery)) {
+            recovery.tornFiles++;
+        }
+        recovery.files++;
+    }
+    rooms.clear();
+    for (auto it = replay.begin(); it != replay.end(); ++it) {
+        ReplayRoom& room = *it->second;
+        if (!room.started || room.broken) {
+            recovery.droppedRooms++;
+            continue;
+        }
+        rooms.push_back(RecoveredRoom());
+        RecoveredRoom& recovered = rooms.back();
+        recovered.journalRoom = it->first;
+        recovered.roomId = room.roomId;
+        for (int i = 0; i < GAME_PLAYER; i++) {
+            recovered.seats[i] = room.seats[i];
+        }
+        room.engine.snapshot(recovered.state);
+    }
+    recovery.rooms = rooms.size();
+    recovery.seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+
+    std::unique_lock<InstrumentedMutex> lock(mutex_);
+    firstSeq_ = seqs.empty() ? 1 : seqs.front();
+    nextRoom_ = maxRoom + 1;
+    written_ = 0;
+    syncedBytes_ = 0;
+    syncCount_ = 0;
+    stop_ = false;
+    if (!openFileLocked(seqs.empty() ? 1 : seqs.back() + 1)) {
+        return false;
+    }
+    if (config_.sync != JournalSync::None) {
+        syncThread_ = std::thread(&RoomJournal::syncLoop, this);
+    }
+    std::cout << "[RoomJournal] 读取 " << recovery.files << " 个文件，" << recovery.records << " 条记录，恢复 "
+              << recovery.rooms << " 个房间，写入 " << filePath(fileSeq_) << std::endl;
+    return true;
+}
+
+void RoomJournal::close() {
+    {
+        std::lock_guard<InstrumentedMutex> lock(mutex_);
+        stop_ = true;
+    }
+    syncWake_.notify_all();
+    synced_.notify_all();
+    if (syncThread_.joinable()) {
+        syncThread_.join();
+    }
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    unmapLocked(true);
+}
+
+bool RoomJournal::isOpen() const {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    return base_ != nullptr;
+}
+
+bool RoomJournal::openFileLocked(uint32_t seq) {
+    std::string path = filePath(seq);
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cout << "[RoomJournal] 无法创建日志文件: " << path << std::endl;
+        return false;
+    }
+    void* mapped = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(config_.fileBytes)) == 0) {
+        mapped = mmap(nullptr, config_.fileBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (mapped == MAP_FAILED) {
+        std::cout << "[RoomJournal] 无法映射日志文件: " << path << std::endl;
+        ::close(fd);
+        unlink(path.c_str());
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> mapLock(mapMutex_);
+        base_ = static_cast<uint8_t*>(mapped);
+        fileSeq_ = seq;
+    }
+    fd_ = fd;
+    used_ = 0;
+    syncedInFile_ = 0;
+
+    RecordBuilder header(JournalRecord_File, 0);
+    header.put(kJournalMagic);
+    header.put(kJournalVersion);
+    header.put(static_cast<uint16_t>(GAME_STATE_VERSION));
+    header.put(seq);
+    const uint8_t* record = header.finish();
+    std::memcpy(base_, record, header.size());
+    used_ = header.size();
+    written_ += header.size();
+    return true;
+}
+
+void RoomJournal::unmapLocked(bool sync) {
+    if (base_ == nullptr) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> mapLock(mapMutex_);
+        if (sync && used_ > syncedInFile_) {
+            msyncRange(base_, syncedInFile_, used_);
+            syncCount_++;
+        }
+        munmap(base_, config_.fileBytes);
+        base_ = nullptr;
+    }
+    if (ftruncate(fd_, static_cast<off_t>(used_)) != 0) {
+        std::cout << "[RoomJournal] 截断日志文件失败: " << filePath(fileSeq_) << std::endl;
+    }
+    ::close(fd_);
+    fd_ = -1;
+    if (sync) {
+        syncedBytes_ = written_;
+        synced_.notify_all();
+    }
+}
+
+uint64_t RoomJournal::append(const uint8_t* record, size_t size) {
+    std::unique_lock<InstrumentedMutex> lock(mutex_);
+    if (base_ == nullptr) {
+        return 0;
+    }
+    if (used_ + size > config_.fileBytes) {
+        // 写满：旧文件按策略落盘后换下一个
+        uint32_t seq = fileSeq_ + 1;
+        unmapLocked(config_.sync != JournalSync::None);
+        if (!openFileLocked(seq)) {
+            return 0;
+        }
+    }
+    std::memcpy(base_ + used_, record, size);
+    used_ += size;
+    written_ += size;
+    uint64_t end = written_;
+    if (config_.sync == JournalSync::Always) {
+        syncWake_.notify_one();
+        synced_.wait(lock, [this, end] { return syncedBytes_ >= end || stop_; });
+    }
+    return end;
+}
+
+void RoomJournal::syncLocked(std::unique_lock<InstrumentedMutex>& lock) {
+    if (base_ == nullptr || written_ <= syncedBytes_) {
+        return;
+    }
+    uint8_t* base = base_;
+    uint32_t seq = fileSeq_;
+    size_t from = syncedInFile_;
+    size_t to = used_;
+    uint64_t target = written_;
+    lock.unlock();
+    {
+        // 换文件会先 msync 旧文件再解除映射：映射已换掉时 target 之前的数据已经落盘
+        std::lock_guard<std::mutex> mapLock(mapMutex_);
+        if (base_ == base && fileSeq_ == seq) {
+            msyncRange(base, from, to);
+        }
+    }
+    lock.lock();
+    if (fileSeq_ == seq && syncedInFile_ < to) {
+        syncedInFile_ = to;
+    }
+    if (syncedBytes_ < target) {
+        syncedBytes_ = target;
+    }
+    syncCount_++;
+    synced_.notify_all();
+}
+
+void RoomJournal::syncLoop() {
+    std::unique_lock<InstrumentedMutex> lock(mutex_);
+    while (!stop_) {
+        if (config_.sync == JournalSync::Always) {
+            // 等待期间到达的记录在下一次 msync 中一起提交
+            syncWake_.wait(lock, [this] { return stop_ || written_ > syncedBytes_; });
+        } else {
+            syncWake_.wait_for(lock, config_.syncInterval, [this] { return stop_; });
+        }
+        if (!stop_) {
+            syncLocked(lock);
+        }
+    }
+}
+
+uint32_t RoomJournal::openTable(const std::string& roomId, const JournalSeat seats[GAME_PLAYER]) {
+    uint32_t room;
+    {
+        std::lock_guard<InstrumentedMutex> lock(mutex_);
+        if (base_ == nullptr) {
+            return 0;
+        }
+        room = nextRoom_++;
+    }
+    RecordBuilder record(JournalRecord_Table, room);
+    record.putString(roomId);
+    record.putSeats(seats);
+    const uint8_t* data = record.finish();
+    append(data, record.size());
+    return room;
+}
+
+void RoomJournal::appendStart(uint32_t room, uint64_t gameSeed, uint8_t bankerUser, uint8_t playerCount, uint8_t androidMask) {
+    if (room == 0) {
+        return;
+    }
+    RecordBuilder record(JournalRecord_Start, room);
+    record.put(gameSeed);
+    record.put(bankerUser);
+    record.put(playerCount);
+    record.put(androidMask);
+    const uint8_t* data = record.finish();
+    append(data, record.size());
+}
+
+void RoomJournal::appendCommand(uint32_t room, const tagGameCommand& command) {
+    if (room == 0) {
+        return;
+    }
+    uint8_t args[4] = {command.cbKind, 0, 0, 0};
+    if (command.cbKind == GameCommand_OutCard) {
+        args[1] = command.OutCard.cbCardData;
+    } else if (command.cbKind == GameCommand_OperateCard) {
+        args[1] = command.OperateCard.cbOperateUser;
+        args[2] = command.OperateCard.cbOperateCode;
+        args[3] = command.OperateCard.cbOperateCard;
+    } else if (command.cbKind == GameCommand_Conclude) {
+        args[1] = command.cbConcludeUser;
+    }
+    RecordBuilder record(JournalRecord_Command, room);
+    record.putBytes(args, sizeof(args));
+    const uint8_t* data = record.finish();
+    append(data, record.size());
+}
+
+void RoomJournal::closeTable(uint32_t room) {
+    if (room == 0) {
+        return;
+    }
+    RecordBuilder record(JournalRecord_Close, room);
+    const uint8_t* data = record.finish();
+    append(data, record.size());
+}
+
+void RoomJournal::beginCheckpoint() {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    if (base_ == nullptr) {
+        return;
+    }
+    uint32_t seq = fileSeq_ + 1;
+    unmapLocked(config_.sync != JournalSync::None);
+    if (openFileLocked(seq)) {
+        checkpointSeq_ = seq;
+    }
+}
+
+void RoomJournal::appendState(uint32_t room, const std::string& roomId, const JournalSeat seats[GAME_PLAYER], const tagGameState& state) {
+    if (room == 0) {
+        return;
+    }
+    RecordBuilder record(JournalRecord_State, room);
+    record.put(static_cast<uint16_t>(GAME_STATE_VERSION));
+    record.put(static_cast<uint16_t>(0));
+    record.put(static_cast<uint32_t>(sizeof(tagGameState)));
+    record.putString(roomId);
+    record.putSeats(seats);
+    record.putBytes(&state, sizeof(state));
+    const uint8_t* data = record.finish();
+    append(data, record.size());
+}
+
+void RoomJournal::endCheckpoint() {
+    RecordBuilder record(JournalRecord_CheckpointEnd, 0);
+    const uint8_t* data = record.finish();
+    append(data, record.size());
+
+    // 不论落盘策略，检查点落盘之后才删除之前的文件
+    uint32_t first, checkpoint;
+    {
+        std::unique_lock<InstrumentedMutex> lock(mutex_);
+        if (base_ == nullptr || checkpointSeq_ == 0) {
+            return;
+        }
+        syncLocked(lock);
+        first = firstSeq_;
+        checkpoint = checkpointSeq_;
+        firstSeq_ = checkpointSeq_;
+        checkpointSeq_ = 0;
+    }
+    for (uint32_t seq = first; seq < checkpoint; seq++) {
+        unlink(filePath(seq).c_str());
+    }
+}
+
+uint64_t RoomJournal::getAppendedBytes() const {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    return written_;
+}
+
+uint64_t RoomJournal::getSyncCount() const {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    return syncCount_;
+}
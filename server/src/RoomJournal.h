@@ -0,0 +1,132 @@
+//
+// RoomJournal.h
+// 房间日志：进行中的牌局写进内存映射的预写日志，进程崩溃后重启时重建房间
+//
+
+#ifndef ROOM_JOURNAL_H
+#define ROOM_JOURNAL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "LockStats.h"
+#include "game/GameEngine.h"
+
+enum class JournalSync {
+    None,       // 不主动 msync（进程崩溃不丢，掉电可能丢失最近的记录）
+    Interval,   // 后台线程定期 msync
+    Always      // 每条记录 msync 后才返回（组提交）
+};
+
+// 开桌时座位上的玩家
+struct JournalSeat {
+    bool bot;                  // 补位机器人
+    std::string playerId;
+    std::string nickname;
+
+    JournalSeat() : bot(false) {}
+};
+
+// 恢复出的房间：座位和当前牌局状态
+struct RecoveredRoom {
+    uint32_t journalRoom;                 // 日志内的房间编号，恢复后继续用于写日志
+    std::string roomId;                   // 客户端 join_room 使用的房间号
+    JournalSeat seats[GAME_PLAYER];
+    tagGameState state;
+};
+
+struct RecoveryStats {
+    size_t files;               // 读取的文件数
+    uint64_t records;           // 有效记录数
+    uint64_t bytes;             // 有效记录的字节数
+    uint64_t commands;          // 重放的命令数（含开局）
+    size_t tornFiles;           // 末尾有不完整或校验不符记录的文件数
+    size_t rooms;               // 恢复的房间数
+    size_t droppedRooms;        // 未开局或状态版本不符而放弃的房间数
+    double seconds;             // 恢复耗时
+
+    RecoveryStats() : files(0), records(0), bytes(0), commands(0), tornFiles(0), rooms(0), droppedRooms(0), seconds(0) {}
+};
+
+class RoomJournal {
+public:
+    struct Config {
+        std::string path;                           // 文件路径前缀
+        JournalSync sync;                           // 落盘策略
+        std::chrono::milliseconds syncInterval;     // Interval 策略的 msync 间隔
+        size_t fileBytes;                           // 单个文件大小，写满后换下一个文件
+
+        Config()
+            : sync(JournalSync::Interval)
+            , syncInterval(10)
+            , fileBytes(64 * 1024 * 1024) {
+        }
+    };
+
+    explicit RoomJournal(const Config& config);
+    ~RoomJournal();                 // 等同 close()
+
+    // 读取已有的日志文件恢复房间，再创建新文件开始追加；rooms 按房间编号排序。无法创建文件时返回 false
+    bool open(std::vector<RecoveredRoom>& rooms, RecoveryStats* stats = nullptr);
+
+    // 落盘后关闭（不删除文件，下次 open 照常恢复）
+    void close();
+
+    bool isOpen() const;
+    const Config& getConfig() const { return config_; }
+
+    // 开桌，返回日志内的房间编号（日志未打开时返回 0，之后的调用都忽略编号 0）
+    uint32_t openTable(const std::string& roomId, const JournalSeat seats[GAME_PLAYER]);
+
+    // 开局：本局种子、开局前的庄家（INVALID_CHAIR 由骰子决定）、座位数、机器人掩码
+    void appendStart(uint32_t room, uint64_t gameSeed, uint8_t bankerUser, uint8_t playerCount, uint8_t androidMask);
+
+    // 出牌、操作、结束命令（开局用 appendStart）
+    void appendCommand(uint32_t room, const tagGameCommand& command);
+
+    // 关桌：房间解散或放弃本局，恢复时不再重建
+    void closeTable(uint32_t room);
+
+    // 检查点：begin 换到新文件，之后对每个未关桌的房间调用一次 appendState，end 落盘并删除旧文件
+    void beginCheckpoint();
+    void appendState(uint32_t room, const std::string& roomId, const JournalSeat seats[GAME_PLAYER], const tagGameState& state);
+    void endCheckpoint();
+
+    uint64_t getAppendedBytes() const;     // 本次打开以来追加的字节数
+    uint64_t getSyncCount() const;         // msync 次数（组提交时小于记录数）
+
+private:
+    // 追加一条已编好的记录（含校验），Always 策略下等待落盘，返回记录末尾在日志中的位置
+    uint64_t append(const uint8_t* record, size_t size);
+    bool openFileLocked(uint32_t seq);     // 创建并映射新文件，写文件头（调用方持有 mutex_）
+    void unmapLocked(bool sync);           // 解除当前文件的映射并截到已写长度，sync 为 true 时先 msync（调用方持有 mutex_）
+    void syncLocked(std::unique_lock<InstrumentedMutex>& lock);   // 在锁外 msync 当前文件未落盘的部分
+    void syncLoop();
+    std::string filePath(uint32_t seq) const;
+
+    Config config_;
+    mutable InstrumentedMutex mutex_{"RoomJournal::mutex_"};   // 保护以下数据
+    std::condition_variable_any syncWake_;    // 唤醒落盘线程
+    std::condition_variable_any synced_;      // 落盘完成
+    int fd_;
+    uint8_t* base_;                 // 当前文件的映射（与 fileSeq_ 一样，同时持有 mapMutex_ 才修改）
+    size_t used_;                   // 当前文件已写的字节数
+    size_t syncedInFile_;           // 当前文件已落盘的字节数
+    uint32_t fileSeq_;              // 当前文件序号
+    uint32_t firstSeq_;             // 仍保留的最早文件序号
+    uint32_t checkpointSeq_;        // 进行中的检查点开始的文件序号
+    uint32_t nextRoom_;             // 下一个房间编号
+    uint64_t written_;              // 追加的字节数（累计）
+    uint64_t syncedBytes_;          // 已落盘的字节数（累计）
+    uint64_t syncCount_;
+    bool stop_;
+    std::mutex mapMutex_;           // msync 与换文件时的 munmap 互斥（落盘线程不持有 mutex_ 时 msync）
+    std::thread syncThread_;
+};
+
+#endif // ROOM_JOURNAL_H
@@ -0,0 +1,246 @@
+//
+// ThreadPlacement.cpp
+// 线程绑核与 NUMA 放置实现
+//
+
+#include "ThreadPlacement.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+struct Topology {
+    std::vector<std::vector<int>> nodes;    // 节点 -> CPU 列表
+    std::vector<int> cpuNode;               // CPU -> 节点
+};
+
+std::string readFirstLine(const std::string& path) {
+    std::ifstream in(path.c_str());
+    std::string line;
+    std::getline(in, line);
+    return line;
+}
+
+Topology loadTopology() {
+    Topology topology;
+    std::vector<int> online = ThreadPlacement::parseCpuList(readFirstLine("/sys/devices/system/node/online"));
+    for (size_t i = 0; i < online.size(); i++) {
+        int node = online[i];
+        std::vector<int> cpus = ThreadPlacement::parseCpuList(
+            readFirstLine("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"));
+        if (static_cast<int>(topology.nodes.size()) <= node) {
+            topology.nodes.resize(node + 1);
+        }
+        topology.nodes[node] = cpus;
+    }
+    // 读不到 sysfs（容器或非 NUMA 内核）时，把所有在线 CPU 视为一个节点
+    if (topology.nodes.empty()) {
+        long count = ::sysconf(_SC_NPROCESSORS_ONLN);
+        topology.nodes.resize(1);
+        for (long cpu = 0; cpu < count; cpu++) {
+            topology.nodes[0].push_back(static_cast<int>(cpu));
+        }
+    }
+    for (size_t node = 0; node < topology.nodes.size(); node++) {
+        const std::vector<int>& cpus = topology.nodes[node];
+        for (size_t i = 0; i < cpus.size(); i++) {
+            if (static_cast<int>(topology.cpuNode.size()) <= cpus[i]) {
+                topology.cpuNode.resize(cpus[i] + 1, 0);
+            }
+            topology.cpuNode[cpus[i]] = static_cast<int>(node);
+        }
+    }
+    return topology;
+}
+
+const Topology& topology() {
+    static const Topology instance = loadTopology();
+    return instance;
+}
+
+std::vector<int> allCpus() {
+    std::vector<int> cpus;
+    const Topology& t = topology();
+    for (size_t node = 0; node < t.nodes.size(); node++) {
+        cpus.insert(cpus.end(), t.nodes[node].begin(), t.nodes[node].end());
+    }
+    return cpus;
+}
+
+} // namespace
+
+PlacementConfig PlacementConfig::fromEnvironment() {
+    PlacementConfig config;
+    const char* enabled = std::getenv("MAHJONG_CPU_AFFINITY");
+    config.enabled = enabled != nullptr && std::string(enabled) == "1";
+    const char* acceptCpus = std::getenv("MAHJONG_ACCEPT_CPUS");
+    if (acceptCpus != nullptr) {
+        config.acceptCpus = ThreadPlacement::parseCpuList(acceptCpus);
+    }
+    const char* workerCpus = std::getenv("MAHJONG_WORKER_CPUS");
+    if (workerCpus != nullptr) {
+        config.workerCpus = ThreadPlacement::parseCpuList(workerCpus);
+    }
+    return config;
+}
+
+namespace ThreadPlacement {
+
+std::vector<int> parseCpuList(const std::string& text) {
+    std::vector<int> cpus;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find(',', pos);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        std::string item = text.substr(pos, end - pos);
+        pos = end + 1;
+        // 去除首尾空白（sysfs 文件末尾带换行）
+        item.erase(0, item.find_first_not_of(" \t\r\n"));
+        item.erase(item.find_last_not_of(" \t\r\n") + 1);
+        if (item.empty()) {
+            continue;
+        }
+        size_t dash = item.find('-');
+        char* tail = nullptr;
+        long first = std::strtol(item.c_str(), &tail, 10);
+        long last = first;
+        if (dash != std::string::npos) {
+            if (tail != item.c_str() + dash) {
+                return std::vector<int>();
+            }
+            last = std::strtol(item.c_str() + dash + 1, &tail, 10);
+        }
+        if (*tail != '\0' || first < 0 || last < first || last >= CPU_SETSIZE) {
+            return std::vector<int>();
+        }
+        for (long cpu = first; cpu <= last; cpu++) {
+            cpus.push_back(static_cast<int>(cpu));
+        }
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+int nodeCount() {
+    return static_cast<int>(topology().nodes.size());
+}
+
+const std::vector<int>& nodeCpus(int node) {
+    static const std::vector<int> empty;
+    const Topology& t = topology();
+    if (node < 0 || node >= static_cast<int>(t.nodes.size())) {
+        return empty;
+    }
+    return t.nodes[node];
+}
+
+int nodeOfCpu(int cpu) {
+    const Topology& t = topology();
+    if (cpu < 0 || cpu >= static_cast<int>(t.cpuNode.size())) {
+        return 0;
+    }
+    return t.cpuNode[cpu];
+}
+
+int currentCpu() {
+    return ::sched_getcpu();
+}
+
+int currentNode() {
+    return nodeOfCpu(currentCpu());
+}
+
+bool pinCurrentThread(const std::vector<int>& cpus) {
+    if (cpus.empty()) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (size_t i = 0; i < cpus.size(); i++) {
+        CPU_SET(cpus[i], &set);
+    }
+    int ret = ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+    if (ret != 0) {
+        std::cout << "[ThreadPlacement] 绑核失败 (errno=" << ret << ")" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int pinnedCpu() {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (::pthread_getaffinity_np(::pthread_self(), sizeof(set), &set) != 0 || CPU_COUNT(&set) != 1) {
+        return -1;
+    }
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &set)) {
+            return cpu;
+        }
+    }
+    return -1;
+}
+
+bool migrateCurrentThreadToNode(int node, const std::vector<int>& allowedCpus) {
+    const std::vector<int>& cpus = nodeCpus(node);
+    if (cpus.empty()) {
+        return false;
+    }
+    std::vector<int> target;
+    for (size_t i = 0; i < cpus.size(); i++) {
+        if (allowedCpus.empty() || std::find(allowedCpus.begin(), allowedCpus.end(), cpus[i]) != allowedCpus.end()) {
+            target.push_back(cpus[i]);
+        }
+    }
+    return pinCurrentThread(target.empty() ? cpus : target);
+}
+
+int incomingCpu(int fd) {
+#ifdef SO_INCOMING_CPU
+    int cpu = -1;
+    socklen_t len = sizeof(cpu);
+    if (::getsockopt(fd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, &len) == 0) {
+        return cpu;
+    }
+#else
+    (void)fd;
+#endif
+    return -1;
+}
+
+int chooseWorkerCpu(const PlacementConfig& config, int incoming, unsigned sequence) {
+    std::vector<int> workers = config.workerCpus.empty() ? allCpus() : config.workerCpus;
+    if (workers.empty()) {
+        return -1;
+    }
+    if (config.followIncomingCpu && incoming >= 0) {
+        if (std::find(workers.begin(), workers.end(), incoming) != workers.end()) {
+            return incoming;
+        }
+        // 收包 CPU 不在工作集合中时，选同一节点上的 CPU
+        std::vector<int> sameNode;
+        int node = nodeOfCpu(incoming);
+        for (size_t i = 0; i < workers.size(); i++) {
+            if (nodeOfCpu(workers[i]) == node) {
+                sameNode.push_back(workers[i]);
+            }
+        }
+        if (!sameNode.empty()) {
+            return sameNode[sequence % sameNode.size()];
+        }
+    }
+    return workers[sequence % workers.size()];
+}
+
+} // namespace ThreadPlacement
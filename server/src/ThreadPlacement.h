@@ -0,0 +1,65 @@
+//
+// ThreadPlacement.h
+// 线程绑核与 NUMA 放置：accept 线程和客户端线程绑核，加入房间后迁移到房间所在节点
+//
+
+#ifndef THREAD_PLACEMENT_H
+#define THREAD_PLACEMENT_H
+
+#include <string>
+#include <vector>
+
+struct PlacementConfig {
+    bool enabled;                   // 是否启用绑核与 NUMA 放置
+    std::vector<int> acceptCpus;    // accept 线程可用的 CPU（空表示不限制）
+    std::vector<int> workerCpus;    // 客户端/房间线程可用的 CPU（空表示全部在线 CPU）
+    bool followIncomingCpu;         // 按 SO_INCOMING_CPU 为客户端线程选择 CPU
+    bool migrateToRoomNode;         // 加入房间后迁移到房间所在的 NUMA 节点
+
+    PlacementConfig()
+        : enabled(false)
+        , followIncomingCpu(true)
+        , migrateToRoomNode(true) {
+    }
+
+    // 从环境变量读取配置：
+    //   MAHJONG_CPU_AFFINITY=1         启用
+    //   MAHJONG_ACCEPT_CPUS=0          accept 线程的 CPU 列表
+    //   MAHJONG_WORKER_CPUS=1-15,17    客户端线程的 CPU 列表
+    static PlacementConfig fromEnvironment();
+};
+
+namespace ThreadPlacement {
+    // 解析 Linux cpulist 格式（如 "0-3,8,10-11"），格式错误时返回空列表
+    std::vector<int> parseCpuList(const std::string& text);
+
+    // NUMA 节点数量（至少为 1）
+    int nodeCount();
+
+    // 指定节点上的在线 CPU
+    const std::vector<int>& nodeCpus(int node);
+
+    // CPU 所在的节点，未知时返回 0
+    int nodeOfCpu(int cpu);
+
+    // 当前线程所在的 CPU / 节点
+    int currentCpu();
+    int currentNode();
+
+    // 将当前线程绑定到指定的 CPU 集合
+    bool pinCurrentThread(const std::vector<int>& cpus);
+
+    // 当前线程只允许在一个 CPU 上运行时返回该 CPU，否则返回 -1
+    int pinnedCpu();
+
+    // 将当前线程迁移到指定节点（限定在 allowedCpus 与该节点 CPU 的交集上，交集为空时使用该节点全部 CPU）
+    bool migrateCurrentThreadToNode(int node, const std::vector<int>& allowedCpus);
+
+    // 读取套接字的 SO_INCOMING_CPU，不支持时返回 -1
+    int incomingCpu(int fd);
+
+    // 为新连接选择客户端线程的 CPU：优先收包 CPU 本身，其次同节点的 CPU，最后轮转
+    int chooseWorkerCpu(const PlacementConfig& config, int incomingCpu, unsigned sequence);
+}
+
+#endif // THREAD_PLACEMENT_H
@@ -0,0 +1,161 @@
+//
+// WebSocketCodec.cpp
+// WebSocket 握手与帧编解码实现
+//
+
+#include "WebSocketCodec.h"
+
+#include <sstream>
+#include <openssl/sha.h>
+
+namespace {
+
+// 简单的 Base64 编码实现
+std::string base64EncodeSimple(const std::string& input) {
+    static const char base64_chars[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    std::string result;
+    int val = 0, valb = -6;
+    for (unsigned char c : input) {
+        val = (val << 8) + c;
+        valb += 8;
+        while (valb >= 0) {
+            result.push_back(base64_chars[(val >> valb) & 0x3F]);
+            valb -= 6;
+        }
+    }
+    if (valb > -6) {
+        result.push_back(base64_chars[((val << 8) >> (valb + 8)) & 0x3F]);
+    }
+    while (result.size() % 4) {
+        result.push_back('=');
+    }
+    return result;
+}
+
+} // namespace
+
+namespace WebSocketCodec {
+
+std::string extractKey(const std::string& request) {
+    std::istringstream iss(request);
+    std::string line;
+    while (std::getline(iss, line)) {
+        // 去除 \r
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+
+        // 查找 Sec-WebSocket-Key 头
+        std::string key = "Sec-WebSocket-Key:";
+        if (line.size() > key.size() &&
+            line.substr(0, key.size()) == key) {
+            std::string value = line.substr(key.size());
+            // 去除前导空格
+            value.erase(0, value.find_first_not_of(" \t"));
+            return value;
+        }
+    }
+    return "";
+}
+
+std::string handshakeResponse(const std::string& key) {
+    // WebSocket 握手：key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+    const std::string magic = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    std::string combined = key + magic;
+
+    // SHA1 哈希
+    unsigned char hash[SHA_DIGEST_LENGTH];
+    SHA1(reinterpret_cast<const unsigned char*>(combined.c_str()), combined.size(), hash);
+
+    // Base64 编码
+    std::string accept = base64EncodeSimple(std::string(reinterpret_cast<const char*>(hash), SHA_DIGEST_LENGTH));
+
+    // 构造 HTTP 响应
+    std::ostringstream oss;
+    oss << "HTTP/1.1 101 Switching Protocols\r\n"
+        << "Upgrade: websocket\r\n"
+        << "Connection: Upgrade\r\n"
+        << "Sec-WebSocket-Accept: " << accept << "\r\n"
+        << "\r\n";
+
+    return oss.str();
+}
+
+void appendTextFrame(const std::string& text, std::string& out) {
+    // 帧头：FIN=1, opcode=1 (文本帧)
+    out.push_back(static_cast<char>(0x81));
+
+    // Payload 长度
+    size_t len = text.size();
+    if (len < 126) {
+        out.push_back(static_cast<char>(len));
+    } else if (len < 65536) {
+        out.push_back(static_cast<char>(126));
+        out.push_back(static_cast<char>((len >> 8) & 0xFF));
+        out.push_back(static_cast<char>(len & 0xFF));
+    } else {
+        out.push_back(static_cast<char>(127));
+        for (int i = 7; i >= 0; --i) {
+            out.push_back(static_cast<char>((static_cast<uint64_t>(len) >> (i * 8)) & 0xFF));
+        }
+    }
+
+    // Payload（服务器发送不需要 mask）
+    out.append(text);
+}
+
+long decodeFrame(const char* data, size_t len, int& opcode, std::string& payload) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    if (len < 2) {
+        return 0;
+    }
+    opcode = p[0] & 0x0F;
+    bool masked = (p[1] & 0x80) != 0;
+    uint64_t payloadLen = p[1] & 0x7F;
+    size_t pos = 2;
+
+    // 扩展长度（网络字节序）
+    if (payloadLen == 126) {
+        if (len < pos + 2) {
+            return 0;
+        }
+        payloadLen = (static_cast<uint64_t>(p[2]) << 8) | p[3];
+        pos += 2;
+    } else if (payloadLen == 127) {
+        if (len < pos + 8) {
+            return 0;
+        }
+        payloadLen = 0;
+        for (int i = 0; i < 8; i++) {
+            payloadLen = (payloadLen << 8) | p[pos + i];
+        }
+        pos += 8;
+    }
+    if (payloadLen > kMaxPayload) {
+        return -1;
+    }
+
+    const unsigned char* mask = nullptr;
+    if (masked) {
+        if (len < pos + 4) {
+            return 0;
+        }
+        mask = p + pos;
+        pos += 4;
+    }
+    if (len < pos + payloadLen) {
+        return 0;
+    }
+
+    payload.assign(data + pos, static_cast<size_t>(payloadLen));
+    if (masked) {
+        for (size_t i = 0; i < payload.size(); ++i) {
+            payload[i] ^= mask[i % 4];
+        }
+    }
+    return static_cast<long>(pos + payloadLen);
+}
+
+} // namespace WebSocketCodec
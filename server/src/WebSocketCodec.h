@@ -0,0 +1,35 @@
+//
+// WebSocketCodec.h
+// WebSocket 握手与帧编解码（不涉及 I/O）
+//
+// 说明：
+// WebSocketServer 的阻塞读取和协程会话的非阻塞读取共用这里的编解码逻辑，
+// 解码函数只处理内存中的缓冲区，数据不足时返回 0，由调用方继续读取后再解码。
+//
+
+#ifndef WEBSOCKET_CODEC_H
+#define WEBSOCKET_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace WebSocketCodec {
+    const int kOpcodeText = 1;
+    const int kOpcodeClose = 8;
+    const size_t kMaxPayload = 1 << 20;     // 单帧最大负载，超过视为协议错误
+
+    // 从 HTTP 请求头中提取 Sec-WebSocket-Key，不存在时返回空串
+    std::string extractKey(const std::string& request);
+
+    // 生成握手响应（101 Switching Protocols）
+    std::string handshakeResponse(const std::string& key);
+
+    // 将文本帧追加到 out（服务器发送不加 mask）
+    void appendTextFrame(const std::string& text, std::string& out);
+
+    // 从 data 解码一帧：返回消耗的字节数，数据不足返回 0，协议错误返回 -1
+    long decodeFrame(const char* data, size_t len, int& opcode, std::string& payload);
+}
+
+#endif // WEBSOCKET_CODEC_H
@@ -4,12 +4,12 @@
 //
 
 #include "WebSocketServer.h"
+#include "WebSocketCodec.h"
 #include <iostream>
 #include <cstring>
 #include <sstream>
 #include <algorithm>
-#include <openssl/sha.h>
-#include <openssl/evp.h>
+#include <vector>
 
 #include <sys/types.h>
 #include <sys/socket.h>
@@ -18,57 +18,6 @@
 #include <unistd.h>
 #include <fcntl.h>
 
-namespace {
-
-// 简单的 Base64 编码实现
-std::string base64EncodeSimple(const std::string& input) {
-    static const char base64_chars[] = 
-        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-    
-    std::string result;
-    int val = 0, valb = -6;
-    for (unsigned char c : input) {
-        val = (val << 8) + c;
-        valb += 8;
-        while (valb >= 0) {
-            result.push_back(base64_chars[(val >> valb) & 0x3F]);
-            valb -= 6;
-        }
-    }
-    if (valb > -6) {
-        result.push_back(base64_chars[((val << 8) >> (valb + 8)) & 0x3F]);
-    }
-    while (result.size() % 4) {
-        result.push_back('=');
-    }
-    return result;
-}
-
-// 从 HTTP 请求头中提取 Sec-WebSocket-Key
-std::string extractWebSocketKey(const std::string& request) {
-    std::istringstream iss(request);
-    std::string line;
-    while (std::getline(iss, line)) {
-        // 去除 \r
-        if (!line.empty() && line.back() == '\r') {
-            line.pop_back();
-        }
-        
-        // 查找 Sec-WebSocket-Key 头
-        std::string key = "Sec-WebSocket-Key:";
-        if (line.size() > key.size() && 
-            line.substr(0, key.size()) == key) {
-            std::string value = line.substr(key.size());
-            // 去除前导空格
-            value.erase(0, value.find_first_not_of(" \t"));
-            return value;
-        }
-    }
-    return "";
-}
-
-} // namespace
-
 bool WebSocketServer::start(int port) {
     port_ = port;
     running_ = false;
@@ -111,7 +60,7 @@ void WebSocketServer::stop() {
     
     // 等待所有客户端线程结束
     {
-        std::lock_guard<std::mutex> lock(threadsMutex_);
+        std::lock_guard<InstrumentedMutex> lock(threadsMutex_);
         for (auto& pair : clientThreads_) {
             if (pair.second.joinable()) {
                 pair.second.join();
@@ -138,7 +87,7 @@ bool WebSocketServer::handleHandshake(int clientFd) {
     std::string request(buffer);
     
     // 提取 Sec-WebSocket-Key
-    std::string key = extractWebSocketKey(request);
+    std::string key = WebSocketCodec::extractKey(request);
     if (key.empty()) {
         std::cout << "[WebSocketServer] 未找到 Sec-WebSocket-Key，拒绝连接" << std::endl;
         return false;
@@ -159,26 +108,7 @@ bool WebSocketServer::handleHandshake(int clientFd) {
 }
 
 std::string WebSocketServer::generateHandshakeResponse(const std::string& key) {
-    // WebSocket 握手：key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
-    const std::string magic = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
-    std::string combined = key + magic;
-    
-    // SHA1 哈希
-    unsigned char hash[SHA_DIGEST_LENGTH];
-    SHA1(reinterpret_cast<const unsigned char*>(combined.c_str()), combined.size(), hash);
-    
-    // Base64 编码
-    std::string accept = base64EncodeSimple(std::string(reinterpret_cast<const char*>(hash), SHA_DIGEST_LENGTH));
-    
-    // 构造 HTTP 响应
-    std::ostringstream oss;
-    oss << "HTTP/1.1 101 Switching Protocols\r\n"
-        << "Upgrade: websocket\r\n"
-        << "Connection: Upgrade\r\n"
-        << "Sec-WebSocket-Accept: " << accept << "\r\n"
-        << "\r\n";
-    
-    return oss.str();
+    return WebSocketCodec::handshakeResponse(key);
 }
 
 bool WebSocketServer::readFrame(int clientFd, std::string& outMessage) {
@@ -247,30 +177,11 @@ bool WebSocketServer::readFrame(int clientFd, std::string& outMessage) {
 
 bool WebSocketServer::sendFrame(int clientFd, const std::string& text) {
     // 使用互斥锁保护 send 操作（虽然 send 本身是线程安全的，但为了确保帧完整性）
-    std::lock_guard<std::mutex> lock(threadsMutex_);
-    
-    std::vector<unsigned char> frame;
-    
-    // 帧头：FIN=1, opcode=1 (文本帧)
-    frame.push_back(0x81);
-    
-    // Payload 长度
-    size_t len = text.size();
-    if (len < 126) {
-        frame.push_back(static_cast<unsigned char>(len));
-    } else if (len < 65536) {
-        frame.push_back(126);
-        frame.push_back((len >> 8) & 0xFF);
-        frame.push_back(len & 0xFF);
-    } else {
-        frame.push_back(127);
-        for (int i = 7; i >= 0; --i) {
-            frame.push_back((len >> (i * 8)) & 0xFF);
-        }
-    }
+    std::lock_guard<InstrumentedMutex> lock(threadsMutex_);
     
-    // Payload（服务器发送不需要 mask）
-    frame.insert(frame.end(), text.begin(), text.end());
+    std::string& frame = frameBuffer_;      // 复用容量，发送事件消息不再分配
+    frame.clear();
+    WebSocketCodec::appendTextFrame(text, frame);
     
     ssize_t sent = ::send(clientFd, frame.data(), frame.size(), 0);
     return sent == static_cast<ssize_t>(frame.size());
@@ -280,7 +191,15 @@ bool WebSocketServer::sendText(int clientFd, const std::string& text) {
     return sendFrame(clientFd, text);
 }
 
-void WebSocketServer::handleClient(int clientFd) {
+void WebSocketServer::setPlacement(const PlacementConfig& placement) {
+    placement_ = placement;
+}
+
+void WebSocketServer::handleClient(int clientFd, int workerCpu) {
+    if (workerCpu >= 0) {
+        ThreadPlacement::pinCurrentThread(std::vector<int>(1, workerCpu));
+    }
+    
     // 处理消息循环（在独立线程中运行）
     while (running_) {
         std::string message;
@@ -304,7 +223,7 @@ void WebSocketServer::handleClient(int clientFd) {
     
     // 从线程映射中移除
     {
-        std::lock_guard<std::mutex> lock(threadsMutex_);
+        std::lock_guard<InstrumentedMutex> lock(threadsMutex_);
         auto it = clientThreads_.find(clientFd);
         if (it != clientThreads_.end()) {
             if (it->second.joinable()) {
@@ -316,6 +235,11 @@ void WebSocketServer::handleClient(int clientFd) {
 }
 
 void WebSocketServer::run() {
+    if (placement_.enabled && !placement_.acceptCpus.empty()) {
+        ThreadPlacement::pinCurrentThread(placement_.acceptCpus);
+        std::cout << "[WebSocketServer] accept 线程已绑核 (" << placement_.acceptCpus.size() << " 个 CPU)" << std::endl;
+    }
+    
     while (running_) {
         sockaddr_in clientAddr;
         socklen_t clientLen = sizeof(clientAddr);
@@ -345,10 +269,19 @@ void WebSocketServer::run() {
             onConnect(clientFd);
         }
         
+        // 选择客户端线程的 CPU：与该连接收包的 CPU（SO_INCOMING_CPU）对齐
+        int workerCpu = -1;
+        if (placement_.enabled) {
+            int incoming = ThreadPlacement::incomingCpu(clientFd);
+            workerCpu = ThreadPlacement::chooseWorkerCpu(placement_, incoming, acceptSequence_++);
+            std::cout << "[WebSocketServer] 客户端线程绑定 CPU " << workerCpu
+                      << " (收包 CPU " << incoming << ", fd=" << clientFd << ")" << std::endl;
+        }
+        
         // 创建新线程处理该客户端
         {
-            std::lock_guard<std::mutex> lock(threadsMutex_);
-            clientThreads_[clientFd] = std::thread(&WebSocketServer::handleClient, this, clientFd);
+            std::lock_guard<InstrumentedMutex> lock(threadsMutex_);
+            clientThreads_[clientFd] = std::thread(&WebSocketServer::handleClient, this, clientFd, workerCpu);
             clientThreads_[clientFd].detach();  // 分离线程，让它在后台运行
         }
         
@@ -5,6 +5,7 @@
 // 说明：
 // 这是一个最小化的 WebSocket 服务器实现，用于支持客户端使用 WebSocket 连接。
 // 实现了基本的 HTTP 握手升级和 WebSocket 文本帧的编码/解码。
+// 每个连接一个线程；启用协程会话时由派生类 SessionServer 改为在事件循环上运行。
 //
 
 #ifndef WEBSOCKET_SERVER_H
@@ -16,9 +17,13 @@
 #include <mutex>
 #include <map>
 #include <atomic>
+#include "LockStats.h"
+#include "ThreadPlacement.h"
 
 class WebSocketServer {
 public:
+    virtual ~WebSocketServer() {}
+    
     // 消息回调：收到客户端消息时调用
     std::function<void(int clientFd, const std::string& message)> onMessage;
     
@@ -29,28 +34,34 @@ public:
     std::function<void(int clientFd)> onDisconnect;
 
     // 启动服务器，监听指定端口
-    bool start(int port);
+    virtual bool start(int port);
     
     // 停止服务器
-    void stop();
+    virtual void stop();
     
     // 向指定客户端发送文本消息
-    bool sendText(int clientFd, const std::string& text);
+    virtual bool sendText(int clientFd, const std::string& text);
     
     // 处理事件循环（阻塞调用）
-    void run();
+    virtual void run();
+    
+    // 设置线程绑核与 NUMA 放置（需在 run() 之前调用）
+    void setPlacement(const PlacementConfig& placement);
 
 private:
-    int listenFd_;
-    int port_;
-    std::atomic<bool> running_;
+    int listenFd_ = -1;
+    int port_ = 0;
+    std::atomic<bool> running_{false};
+    PlacementConfig placement_;
+    unsigned acceptSequence_ = 0;  // 已接受的连接数，用于轮转分配 CPU
     
     // 客户端线程管理
     std::map<int, std::thread> clientThreads_;
-    std::mutex threadsMutex_;
+    InstrumentedMutex threadsMutex_{"WebSocketServer::threadsMutex_"};
+    std::string frameBuffer_;  // sendFrame 的帧缓冲区（受 threadsMutex_ 保护）
     
-    // 处理单个客户端的消息循环（在独立线程中运行）
-    void handleClient(int clientFd);
+    // 处理单个客户端的消息循环（在独立线程中运行，workerCpu >= 0 时先绑定到该 CPU）
+    void handleClient(int clientFd, int workerCpu);
     
     // 处理 HTTP 握手升级为 WebSocket
     bool handleHandshake(int clientFd);
@@ -0,0 +1,60 @@
+//
+// AlignedAlloc.h
+// 按类型对齐的堆分配（C++11 的 new / make_shared 不理会 alignas(64)）
+//
+
+#ifndef COCOSTUDIO_MAHJONG_ALIGNEDALLOC_H
+#define COCOSTUDIO_MAHJONG_ALIGNEDALLOC_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <new>
+
+/**
+ * 按指定对齐分配，失败时抛出 std::bad_alloc
+ * @param size 字节数
+ * @param align 对齐（2 的幂）
+ */
+inline void *alignedAllocate(std::size_t size, std::size_t align) {
+    if (align < sizeof(void *)) align = sizeof(void *);    //posix_memalign 要求至少按指针对齐
+    void *p = nullptr;
+    if (posix_memalign(&p, align, size == 0 ? 1 : size) != 0) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+inline void alignedRelease(void *p) {
+    std::free(p);
+}
+
+//按 alignof(T) 分配的分配器（用于 std::allocate_shared、容器）
+template <typename T>
+class AlignedAllocator {
+public:
+    typedef T value_type;
+
+    AlignedAllocator() {}
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U> &) {}
+
+    T *allocate(std::size_t n) {
+        if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T *>(alignedAllocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *p, std::size_t) {
+        alignedRelease(p);
+    }
+};
+
+template <typename T, typename U>
+inline bool operator==(const AlignedAllocator<T> &, const AlignedAllocator<U> &) { return true; }
+
+template <typename T, typename U>
+inline bool operator!=(const AlignedAllocator<T> &, const AlignedAllocator<U> &) { return false; }
+
+#endif //COCOSTUDIO_MAHJONG_ALIGNEDALLOC_H
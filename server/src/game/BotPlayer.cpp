@@ -0,0 +1,212 @@
+//
+// BotPlayer.cpp
+// 进程内机器人玩家
+//
+
+#include "BotPlayer.h"
+#include "MonteCarloSearch.h"
+
+#include <cstring>
+
+BotPlayer::BotPlayer(BotLevel level) : IPlayer(true, MALE, NULL), m_Level(level), m_pSearch(NULL), m_pState(NULL) {
+    setGameEngineEventListener(this);
+    reset();
+}
+
+//清空本局数据
+void BotPlayer::reset() {
+    memset(m_cbCardIndex, 0, sizeof(m_cbCardIndex));
+    memset(m_cbVisibleIndex, 0, sizeof(m_cbVisibleIndex));
+    m_cbWeaveCount = 0;
+    m_cbActionMask = WIK_NULL;
+    m_cbActionCard = 0;
+    m_cbGangCard = 0;
+    m_bOutCard = false;
+    m_bGameEnd = false;
+}
+
+/**
+ * 从引擎状态接管座位
+ * @param cbChairID
+ * @param State
+ */
+void BotPlayer::syncFromState(uint8_t cbChairID, const tagGameState &State) {
+    reset();
+    m_ChairID = cbChairID;
+    memcpy(m_cbCardIndex, State.cbCardIndex[cbChairID], sizeof(m_cbCardIndex));
+    m_cbWeaveCount = State.cbWeaveItemCount[cbChairID];
+    for (uint8_t i = 0; i < State.cbPlayerCount; i++) {            //已见的牌：各家没被碰杠的弃牌和碰杠组合
+        for (uint8_t j = 0; j < State.cbDiscardCount[i]; j++) {
+            m_cbVisibleIndex[GameLogic::switchToCardIndex(State.cbDiscardCard[i][j])]++;
+        }
+        for (uint8_t j = 0; j < State.cbWeaveItemCount[i]; j++) {
+            uint8_t cbIndex = GameLogic::switchToCardIndex(State.WeaveItemArray[i][j].cbCenterCard);
+            m_cbVisibleIndex[cbIndex] = static_cast<uint8_t>(m_cbVisibleIndex[cbIndex] + (State.WeaveItemArray[i][j].cbWeaveKind == WIK_G ? 4 : 3));
+        }
+    }
+    for (uint8_t j = 0; j < MAX_INDEX; j++) {
+        if (m_cbVisibleIndex[j] + m_cbCardIndex[j] > 4) m_cbVisibleIndex[j] = static_cast<uint8_t>(4 - m_cbCardIndex[j]);
+    }
+    uint8_t cbCardCount = 0;
+    for (uint8_t j = 0; j < MAX_INDEX; j++) cbCardCount = static_cast<uint8_t>(cbCardCount + m_cbCardIndex[j]);
+    m_bOutCard = State.cbCurrentUser == cbChairID && cbCardCount % 3 == 2;
+    if (State.cbUserAction[cbChairID] != WIK_NULL && !State.bResponse[cbChairID]) {
+        m_cbActionMask = State.cbUserAction[cbChairID];
+        m_cbActionCard = State.cbProvideCard;
+        m_cbGangCard = State.cbGangCount > 0 ? State.cbGangCard[0] : 0;
+    }
+}
+
+/**
+ * 取出下一条命令
+ * @param Command
+ * @return
+ */
+bool BotPlayer::takeCommand(tagGameCommand &Command) {
+    if (m_bGameEnd) return false;
+    if (m_Level == BotLevel_Expert && m_pSearch != NULL && m_pState != NULL && (m_cbActionMask != WIK_NULL || m_bOutCard)) {
+        tagSearchResult Result;
+        if (m_pSearch->decide(*m_pState, m_ChairID, Result)) {
+            if (Result.Command.cbKind == GameCommand_OperateCard) m_cbActionMask = WIK_NULL;
+            Command = Result.Command;
+            return true;
+        }
+    }
+    if (m_cbActionMask != WIK_NULL) {
+        uint8_t cbOperateCode = chooseOperate();
+        uint8_t cbOperateCard = m_cbActionCard;
+        if (cbOperateCode == WIK_G && m_bOutCard) cbOperateCard = m_cbGangCard;    //自己回合的杠（暗杠、补杠）
+        m_cbActionMask = WIK_NULL;
+        Command = tagGameCommand::makeOperateCard(m_ChairID, cbOperateCode, cbOperateCard);
+        return true;
+    }
+    if (m_bOutCard) {
+        Command = tagGameCommand::makeOutCard(chooseOutCard());
+        return true;
+    }
+    return false;
+}
+
+//能胡就胡，能杠就杠，碰牌看等级
+uint8_t BotPlayer::chooseOperate() {
+    if ((m_cbActionMask & WIK_H) != 0) return WIK_H;
+    if ((m_cbActionMask & WIK_G) != 0) return WIK_G;
+    if ((m_cbActionMask & WIK_P) != 0 && !m_bOutCard && (m_Level == BotLevel_Easy || shouldPeng(m_cbActionCard))) return WIK_P;
+    return WIK_NULL;
+}
+
+//初级只比较打出后的向听数（相同时打编号大的），其余取出牌建议的第一项
+uint8_t BotPlayer::chooseOutCard() {
+    if (m_Level == BotLevel_Easy) {
+        uint8_t cbOutCard = 0;
+        int8_t cbBest = 127;
+        for (int j = MAX_INDEX - 1; j >= 0; j--) {
+            if (m_cbCardIndex[j] == 0) continue;
+            m_cbCardIndex[j]--;
+            int8_t cbShanten = GameLogic::analyseShanten(m_cbCardIndex, m_cbWeaveCount);
+            m_cbCardIndex[j]++;
+            if (cbShanten < cbBest) {
+                cbBest = cbShanten;
+                cbOutCard = GameLogic::switchToCardData(static_cast<uint8_t>(j));
+            }
+        }
+        return cbOutCard;
+    }
+    tagDiscardResult DiscardResult[MAX_INDEX];
+    const uint8_t *cbVisibleIndex = m_Level >= BotLevel_Hard ? m_cbVisibleIndex : NULL;
+    if (GameLogic::analyseDiscard(m_cbCardIndex, m_cbWeaveCount, cbVisibleIndex, DiscardResult) == 0) return 0;
+    return DiscardResult[0].cbOutCard;
+}
+
+/**
+ * 碰牌后（再打出一张）的向听数是否比现在少
+ * @param cbCard
+ * @return
+ */
+bool BotPlayer::shouldPeng(uint8_t cbCard) {
+    uint8_t cbIndex = GameLogic::switchToCardIndex(cbCard);
+    if (m_cbCardIndex[cbIndex] < 2) return false;
+    int8_t cbShanten = GameLogic::analyseShanten(m_cbCardIndex, m_cbWeaveCount);
+    uint8_t cbCardIndex[MAX_INDEX];
+    memcpy(cbCardIndex, m_cbCardIndex, sizeof(cbCardIndex));
+    cbCardIndex[cbIndex] -= 2;
+    tagDiscardResult DiscardResult[MAX_INDEX];
+    const uint8_t *cbVisibleIndex = m_Level >= BotLevel_Hard ? m_cbVisibleIndex : NULL;
+    if (GameLogic::analyseDiscard(cbCardIndex, static_cast<uint8_t>(m_cbWeaveCount + 1), cbVisibleIndex, DiscardResult) == 0) return false;
+    return DiscardResult[0].cbShanten < cbShanten;
+}
+
+bool BotPlayer::onUserEnterEvent(IPlayer *) {
+    return true;
+}
+
+bool BotPlayer::onGameStartEvent(const CMD_S_GameStart &GameStart) {
+    reset();
+    GameLogic::switchToCardIndex(GameStart.cbCardData, MAX_COUNT - 1, m_cbCardIndex);     //前 13 张是自己的牌
+    return true;
+}
+
+bool BotPlayer::onSendCardEvent(const CMD_S_SendCard &SendCard) {
+    if (SendCard.cbCurrentUser != m_ChairID) return true;
+    m_cbCardIndex[GameLogic::switchToCardIndex(SendCard.cbCardData)]++;
+    m_cbActionMask = SendCard.cbActionMask;
+    m_cbActionCard = SendCard.cbCardData;
+    m_cbGangCard = SendCard.cbGangCount > 0 ? SendCard.cbGangCard[0] : 0;
+    m_bOutCard = true;
+    return true;
+}
+
+bool BotPlayer::onOutCardEvent(const CMD_S_OutCard &OutCard) {
+    uint8_t cbIndex = GameLogic::switchToCardIndex(OutCard.cbOutCardData);
+    m_cbVisibleIndex[cbIndex]++;
+    if (OutCard.cbOutCardUser == m_ChairID) {
+        if (m_cbCardIndex[cbIndex] > 0) m_cbCardIndex[cbIndex]--;
+        m_cbActionMask = WIK_NULL;
+        m_bOutCard = false;
+    }
+    return true;
+}
+
+bool BotPlayer::onOperateNotifyEvent(const CMD_S_OperateNotify &OperateNotify) {
+    m_cbActionMask = OperateNotify.cbActionMask;
+    m_cbActionCard = OperateNotify.cbActionCard;
+    m_cbGangCard = OperateNotify.cbGangCount > 0 ? OperateNotify.cbGangCard[0] : 0;
+    return true;
+}
+
+bool BotPlayer::onOperateResultEvent(const CMD_S_OperateResult &OperateResult) {
+    uint8_t cbIndex = GameLogic::switchToCardIndex(OperateResult.cbOperateCard);
+    m_cbActionMask = WIK_NULL;                                  //动作已结算，未响应的作废
+    if (OperateResult.cbOperateUser != m_ChairID) {
+        if (OperateResult.cbOperateCode == WIK_P) {
+            m_cbVisibleIndex[cbIndex] = static_cast<uint8_t>(m_cbVisibleIndex[cbIndex] + 2);
+        } else if (OperateResult.cbOperateCode == WIK_G) {
+            m_cbVisibleIndex[cbIndex] = static_cast<uint8_t>(4 - m_cbCardIndex[cbIndex]);
+        }
+        return true;
+    }
+    switch (OperateResult.cbOperateCode) {
+        case WIK_P:                                             //碰：移除两张，接着出牌
+            m_cbCardIndex[cbIndex] = static_cast<uint8_t>(m_cbCardIndex[cbIndex] - 2);
+            m_cbVisibleIndex[cbIndex] = static_cast<uint8_t>(m_cbVisibleIndex[cbIndex] + 2);
+            m_cbWeaveCount++;
+            m_bOutCard = true;
+            break;
+        case WIK_G:                                             //杠：明杠移除三张，暗杠四张，补杠一张，之后补牌
+            if (OperateResult.cbProvideUser != m_ChairID || m_cbCardIndex[cbIndex] == 4) m_cbWeaveCount++;
+            m_cbCardIndex[cbIndex] = 0;
+            m_cbVisibleIndex[cbIndex] = 4;
+            m_bOutCard = false;
+            break;
+        default:
+            break;
+    }
+    return true;
+}
+
+bool BotPlayer::onGameEndEvent(const CMD_S_GameEnd &) {
+    m_cbActionMask = WIK_NULL;
+    m_bOutCard = false;
+    m_bGameEnd = true;
+    return true;
+}
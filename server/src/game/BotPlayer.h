@@ -0,0 +1,84 @@
+//
+// BotPlayer.h
+// 进程内机器人玩家：只按收到的事件决策，由驱动方调用 takeCommand 取出命令交给引擎
+//
+
+#ifndef COCOSTUDIO_MAHJONG_BOTPLAYER_H
+#define COCOSTUDIO_MAHJONG_BOTPLAYER_H
+
+#include "GameEngine.h"
+#include "GameEvent.h"
+
+class MonteCarloSearch;
+
+enum BotLevel {
+    BotLevel_Easy,                   //初级：能胡就胡、能碰杠就碰杠，出牌只比较向听数
+    BotLevel_Normal,                 //中级：碰后向听数减少才碰，出牌取 analyseDiscard 的第一项
+    BotLevel_Hard,                   //高级：同中级，有效牌扣除已见的牌
+    BotLevel_Expert,                 //专家：蒙特卡洛搜索（需要 setSearch，没有时按高级）
+};
+
+class BotPlayer : public IPlayer, public IGameEngineEventListener {
+public:
+    explicit BotPlayer(BotLevel level = BotLevel_Hard);
+
+    void reset();   //清空本局数据（开局时自动调用）
+
+    void setLevel(BotLevel level) { m_Level = level; }
+    BotLevel getLevel() const { return m_Level; }
+
+    /**
+     * 专家等级使用的搜索和局面（搜索只取该座位能看到的部分），两者都由调用方持有
+     * @param pSearch
+     * @param pState
+     */
+    void setSearch(MonteCarloSearch *pSearch, const tagGameState *pState) {
+        m_pSearch = pSearch;
+        m_pState = pState;
+    }
+
+    /**
+     * 从引擎状态接管座位（掉线代打）：手牌、组合、已见的牌和待响应的动作
+     * @param cbChairID
+     * @param State
+     */
+    void syncFromState(uint8_t cbChairID, const tagGameState &State);
+
+    /**
+     * 取出下一条命令：有待响应的动作先响应，否则轮到自己时出牌
+     * @param Command 输出
+     * @return 没有要做的事返回 false
+     */
+    bool takeCommand(tagGameCommand &Command);
+
+    bool isGameEnd() const { return m_bGameEnd; }
+    const uint8_t *getCardIndex() const { return m_cbCardIndex; }      //自己的手牌（按事件维护）
+    uint8_t getWeaveCount() const { return m_cbWeaveCount; }
+
+    bool onUserEnterEvent(IPlayer *pIPlayer) override;
+    bool onGameStartEvent(const CMD_S_GameStart &GameStart) override;
+    bool onSendCardEvent(const CMD_S_SendCard &SendCard) override;
+    bool onOutCardEvent(const CMD_S_OutCard &OutCard) override;
+    bool onOperateNotifyEvent(const CMD_S_OperateNotify &OperateNotify) override;
+    bool onOperateResultEvent(const CMD_S_OperateResult &OperateResult) override;
+    bool onGameEndEvent(const CMD_S_GameEnd &GameEnd) override;
+
+private:
+    uint8_t chooseOperate();        //从待响应的动作中选择，返回 WIK_H / WIK_G / WIK_P / WIK_NULL
+    uint8_t chooseOutCard();        //选择要打出的牌
+    bool shouldPeng(uint8_t cbCard);    //碰牌后向听数是否减少
+
+    BotLevel m_Level;                       //等级
+    MonteCarloSearch *m_pSearch;            //专家等级的搜索
+    const tagGameState *m_pState;           //专家等级搜索用的局面
+    uint8_t m_cbCardIndex[MAX_INDEX];       //手牌
+    uint8_t m_cbVisibleIndex[MAX_INDEX];    //已见的牌（各家打出、别人碰杠亮出）
+    uint8_t m_cbWeaveCount;                 //组合数量
+    uint8_t m_cbActionMask;                 //待响应的动作
+    uint8_t m_cbActionCard;                 //待响应动作的牌
+    uint8_t m_cbGangCard;                   //自己回合可以杠的牌（取第一张）
+    bool m_bOutCard;                        //轮到自己出牌
+    bool m_bGameEnd;                        //本局已结束
+};
+
+#endif //COCOSTUDIO_MAHJONG_BOTPLAYER_H
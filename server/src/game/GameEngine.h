@@ -9,6 +9,10 @@
 #include "GameLogic.h"
 #include "FvMask.h"
 #include "IPlayer.h"
+#include "TingCache.h"
+#include "GameState.h"
+#include "GameEvent.h"
+#include "AlignedAlloc.h"
 
 enum EstimateKind {
     EstimateKind_OutCard,            //出牌效验
@@ -38,110 +42,142 @@ public:
      * @param GameStart
      * @return
      */
-    virtual bool onGameStartEvent(CMD_S_GameStart GameStart) = 0;
+    virtual bool onGameStartEvent(const CMD_S_GameStart &GameStart) = 0;
 
     /**
      * 发牌事件
      * @param SendCard
      * @return
      */
-    virtual bool onSendCardEvent(CMD_S_SendCard SendCard) = 0;
+    virtual bool onSendCardEvent(const CMD_S_SendCard &SendCard) = 0;
 
     /**
      * 出牌事件
      * @param OutCard
      * @return
      */
-    virtual bool onOutCardEvent(CMD_S_OutCard OutCard) = 0;
+    virtual bool onOutCardEvent(const CMD_S_OutCard &OutCard) = 0;
 
     /**
      * 操作通知事件
      * @param OperateNotify
      * @return
      */
-    virtual bool onOperateNotifyEvent(CMD_S_OperateNotify OperateNotify) = 0;
+    virtual bool onOperateNotifyEvent(const CMD_S_OperateNotify &OperateNotify) = 0;
 
     /**
      * 操作结果事件
      * @param OperateResult
      * @return
      */
-    virtual bool onOperateResultEvent(CMD_S_OperateResult OperateResult) = 0;
+    virtual bool onOperateResultEvent(const CMD_S_OperateResult &OperateResult) = 0;
 
     /**
      * 游戏结束事件
      * @param GameEnd
      * @return
      */
-    virtual bool onGameEndEvent(CMD_S_GameEnd GameEnd) = 0;
+    virtual bool onGameEndEvent(const CMD_S_GameEnd &GameEnd) = 0;
 
 };
 
 
+//命令监听：apply 执行完一条命令后、事件交给玩家之前调用（牌局记录、崩溃恢复日志）
+class IGameCommandListener {
+public:
+    virtual ~IGameCommandListener() {}
+
+    /**
+     * 一条命令执行完毕
+     * @param Command
+     * @param cbChairID 执行前的当前玩家；开始命令为开局前的庄家
+     * @param State 执行后的本局状态
+     * @param Events 调用方的事件缓冲区
+     * @param cbFirstEvent 这条命令产生的第一条事件在 Events 中的位置
+     */
+    virtual void onCommandApplied(const tagGameCommand &Command, uint8_t cbChairID, const tagGameState &State, const GameEventBuffer &Events, uint8_t cbFirstEvent) = 0;
+};
+
+
 class GameEngine {
 
 private:
     IPlayer *m_pIPlayer[GAME_PLAYER];        //游戏玩家
-    GameLogic *m_GameLogic;
-    int64_t m_lGameScoreTable[GAME_PLAYER];           //记录总分
-    uint32_t iDiceCount;                              //骰子点数
     uint8_t m_CurrChair;                              //当前椅子数量
-
-    uint8_t m_cbBankerUser;                           //庄家用户
-    uint8_t m_cbCardIndex[GAME_PLAYER][MAX_INDEX];    //用户扑克
-    uint8_t m_cbMa;                                   //买马数量
-    uint8_t m_cbProvideCard;                          //当前供应的牌
-    uint8_t m_cbProvideUser;                          //供应的玩家
-    uint8_t m_cbResumeUser;                           //暂存玩家，用于碰、杠后恢复
-    uint8_t m_cbCurrentUser;                          //当前操作的玩家
-    uint8_t m_cbOutCardUser;                          //出牌玩家
-    uint8_t m_cbOutCardData;                          //出牌数据
-    uint8_t m_cbDiscardCount[GAME_PLAYER];            //出牌数据
-    uint8_t m_cbDiscardCard[GAME_PLAYER][MAX_DISCARD];//丢弃记录
-
-    bool m_bResponse[GAME_PLAYER];                //响应标志
-    bool m_cbPassPeng[GAME_PLAYER][MAX_INDEX];    //用来检测放弃碰
-    bool m_bGangStatus;                           //杠上状态
-    bool m_bQiangGangStatus;                      //抢杆状态
-    uint8_t m_cbUserAction[GAME_PLAYER];          //用户动作，可能包含多个动作
-    uint8_t m_cbTempUserAction[GAME_PLAYER];      //暂存上一次的动作情况，用来恢复自摸点“过”的情况。
-    uint8_t m_cbOperateCard[GAME_PLAYER];         //操作扑克
-    uint8_t m_cbPerformAction[GAME_PLAYER];       //执行动作，只会包含一个动作
-    uint8_t m_cbFanShu[GAME_PLAYER];              //上一圈番数，用来判定没过手不能胡第二家
-    uint8_t m_cbGangCount;                        //当前可以杠的数量
-    uint8_t m_cbGangCard[MAX_WEAVE];              //可以杠的牌
-    uint8_t m_cbTargetUser;                       //胡牌玩家标识
-    uint8_t m_cbHuCard;                           //胡牌扑克
-    uint8_t m_cbHuKind[GAME_PLAYER];              //胡牌类型
-    uint8_t m_cbHuSpecial[GAME_PLAYER];           //胡牌一些特殊情况
-    uint64_t m_llHuRight[GAME_PLAYER];            //胡牌权重
-private:
-    uint8_t m_cbSendCardData;                     //发牌扑克
-    uint8_t m_cbSendCardCount;                    //发牌数目
-    uint8_t m_cbOutCardCount;                     //出牌数目
-    uint8_t m_cbLeftCardCount;                    //剩余数目
-    uint8_t m_cbRepertoryCard[MAX_REPERTORY];     //库存扑克
-    uint8_t m_cbWeaveItemCount[GAME_PLAYER];      //组合数目
-    tagWeaveItem m_WeaveItemArray[GAME_PLAYER][MAX_WEAVE];//组合扑克
+    tagGameState m_GameState;                     //本局状态（POD，快照、恢复为一次 memcpy）
+    TingCache m_TingCache;                        //各座位的等牌，胡牌判定先查掩码
+    GameRandom m_RoomRandom;                      //房间随机数，房间创建时取种子，每局从中取本局种子
+    GameRandom m_GameRandom;                      //本局随机数（洗牌、骰子），由本局种子确定
+    bool m_bGameSeedFixed;                        //下一局使用 setGameSeed 指定的种子
+    GameEventBuffer *m_pEvents;                   //apply 期间事件写入的缓冲区
+    bool m_bQuiet;                                //不打印日志
+    IGameCommandListener *m_pCommandListener;     //命令监听，NULL 为没有
 
 public:
 
     GameEngine();   //构造函数
     ~GameEngine();  //析构函数
 
+    //堆上的引擎按 m_GameState 的缓存行对齐分配（C++11 的全局 new 只保证 16 字节）
+    static void *operator new(std::size_t size) { return alignedAllocate(size, alignof(GameEngine)); }
+    static void operator delete(void *p) { alignedRelease(p); }
+
 public:
     void init();    //初始化数据
+    void reset();   //重置引擎（清空玩家），用于对象池复用
+
+    /**
+     * 执行一条命令：只修改本局状态，产生的事件按顺序写进 Events，不调用监听者
+     * @param Command
+     * @param Events 输出，调用方提供（不清空，追加在后面）
+     * @return
+     */
+    bool apply(const tagGameCommand &Command, GameEventBuffer &Events);
+
+    /**
+     * 把 apply 产生的事件交给入座玩家的监听者
+     * @param Events
+     */
+    void dispatchEvents(const GameEventBuffer &Events);
+
+    //以下为监听者适配：apply 之后立即 dispatchEvents
     bool onGameStart();     //开始游戏
     bool onGameRestart();   //重新开始
     bool onUserOutCard(CMD_C_OutCard OutCard);   //出牌命令
+    bool onUserOperateCard(CMD_C_OperateCard OperateCard);
     bool onEventGameConclude(uint8_t cbChairID); //结束游戏
     bool onUserEnter(IPlayer *pIPlayer);    //玩家进入
+private:
+    bool startGame(const tagStartCommand &Start);      //开始游戏
+    bool outCard(const CMD_C_OutCard &OutCard);         //出牌
+    bool operateCard(const CMD_C_OperateCard &OperateCard);    //碰、杠、胡、过
+    bool concludeGame(uint8_t cbChairID);               //结束游戏
     bool dispatchCardData(uint8_t cbCurrentUser, bool bTail = false);    //发牌
     bool estimateUserRespond(uint8_t cbCurrentUser, uint8_t cbCurrentCard, EstimateKind estimateKind);  //检测响应
     bool sendOperateNotify();   //发送操作通知
+    bool applyCommand(const tagGameCommand &Command);   //生成事件并分发给监听者
 public:
-    static GameEngine *GetGameEngine();  //获取单例
-    bool onUserOperateCard(CMD_C_OperateCard OperateCard);
+    const TingCache &getTingCache() const { return m_TingCache; }  //等牌缓存（提示、机器人使用）
+    void setRoomSeed(uint64_t llSeed) { m_RoomRandom.seed(llSeed); }   //指定房间种子，之后各局的种子随之确定
+    uint64_t getRoomSeed() const { return m_RoomRandom.getSeed(); }
+    void setGameSeed(uint64_t llSeed);     //指定下一局的种子，用于复现牌局
+    uint64_t getGameSeed() const { return m_GameState.llGameSeed; }    //本局种子（相同种子得到相同的牌墙和骰子）
+    const tagGameState &getGameState() const { return m_GameState; }   //本局状态（只读）
+    void setQuiet(bool bQuiet) { m_bQuiet = bQuiet; }     //不打印日志（搜索推演每秒结束上万局）
+    void setCommandListener(IGameCommandListener *pListener) { m_pCommandListener = pListener; }   //apply 执行的命令交给监听（reset 不清除）
+    void setBankerUser(uint8_t cbBankerUser) { m_GameState.cbBankerUser = cbBankerUser; }   //指定下一局开局前的庄家，用于回放
+
+    /**
+     * 保存本局快照
+     * @param GameState 输出，整块复制 m_GameState
+     */
+    void snapshot(tagGameState &GameState) const;
+
+    /**
+     * 从快照恢复本局，之后的命令从快照时的位置继续；玩家须已全部入座，等牌缓存按手牌重建
+     * @param GameState
+     */
+    void restore(const tagGameState &GameState);
 };
 
 
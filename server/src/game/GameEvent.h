@@ -0,0 +1,152 @@
+//
+// GameEvent.h
+// 引擎的命令和事件：GameEngine::apply 执行一条命令，把产生的事件按顺序写进调用方的缓冲区
+//
+
+#ifndef COCOSTUDIO_MAHJONG_GAMEEVENT_H
+#define COCOSTUDIO_MAHJONG_GAMEEVENT_H
+
+#include "GameCmd.h"
+
+#include <cstddef>
+
+#define MAX_GAME_EVENT               16                                //一条命令最多的事件数
+
+enum GameEventKind {
+    GameEvent_GameStart,             //游戏开始
+    GameEvent_SendCard,              //发牌
+    GameEvent_OutCard,               //出牌
+    GameEvent_OperateNotify,         //操作通知
+    GameEvent_OperateResult,         //操作结果
+    GameEvent_GameEnd,               //游戏结束
+};
+
+struct tagGameEvent {
+    uint8_t cbKind;                             //事件类型 GameEventKind
+    uint8_t cbChairID;                          //接收的座位，INVALID_CHAIR 为全部座位
+    union {
+        CMD_S_GameStart GameStart;
+        CMD_S_SendCard SendCard;
+        CMD_S_OutCard OutCard;
+        CMD_S_OperateNotify OperateNotify;
+        CMD_S_OperateResult OperateResult;
+        CMD_S_GameEnd GameEnd;
+    };
+};
+
+enum GameCommandKind {
+    GameCommand_Start,               //开始（重新开始）一局
+    GameCommand_OutCard,             //当前玩家出牌
+    GameCommand_OperateCard,         //碰、杠、胡、过
+    GameCommand_Conclude,            //结束本局
+};
+
+//开始命令：本局的座位数和机器人座位（机器人开局能看到其他人的牌）
+struct tagStartCommand {
+    uint8_t cbPlayerCount;                      //座位数
+    uint8_t cbAndroidMask;                      //机器人座位掩码，第 i 位为座位 i
+};
+
+struct tagGameCommand {
+    uint8_t cbKind;                             //命令类型 GameCommandKind
+    union {
+        tagStartCommand Start;
+        CMD_C_OutCard OutCard;
+        CMD_C_OperateCard OperateCard;
+        uint8_t cbConcludeUser;                 //结束本局的座位
+    };
+
+    static tagGameCommand makeStart(uint8_t cbPlayerCount, uint8_t cbAndroidMask) {
+        tagGameCommand Command;
+        Command.cbKind = GameCommand_Start;
+        Command.Start.cbPlayerCount = cbPlayerCount;
+        Command.Start.cbAndroidMask = cbAndroidMask;
+        return Command;
+    }
+
+    static tagGameCommand makeOutCard(uint8_t cbCardData) {
+        tagGameCommand Command;
+        Command.cbKind = GameCommand_OutCard;
+        Command.OutCard.cbCardData = cbCardData;
+        return Command;
+    }
+
+    static tagGameCommand makeOperateCard(uint8_t cbOperateUser, uint8_t cbOperateCode, uint8_t cbOperateCard) {
+        tagGameCommand Command;
+        Command.cbKind = GameCommand_OperateCard;
+        Command.OperateCard.cbOperateUser = cbOperateUser;
+        Command.OperateCard.cbOperateCode = cbOperateCode;
+        Command.OperateCard.cbOperateCard = cbOperateCard;
+        return Command;
+    }
+
+    static tagGameCommand makeConclude(uint8_t cbChairID) {
+        tagGameCommand Command;
+        Command.cbKind = GameCommand_Conclude;
+        Command.cbConcludeUser = cbChairID;
+        return Command;
+    }
+};
+
+class GameEventBuffer {
+public:
+    GameEventBuffer() : m_cbCount(0), m_bOverflow(false) {
+    }
+
+    void clear() {
+        m_cbCount = 0;
+        m_bOverflow = false;
+    }
+
+    uint8_t size() const { return m_cbCount; }
+    bool overflow() const { return m_bOverflow; }   //有事件因缓冲区已满被丢弃
+    const tagGameEvent &operator[](uint8_t cbIndex) const { return m_Events[cbIndex]; }
+
+    void push(uint8_t cbChairID, const CMD_S_GameStart &GameStart) {
+        tagGameEvent *pEvent = append(GameEvent_GameStart, cbChairID);
+        if (pEvent != NULL) pEvent->GameStart = GameStart;
+    }
+
+    void push(uint8_t cbChairID, const CMD_S_SendCard &SendCard) {
+        tagGameEvent *pEvent = append(GameEvent_SendCard, cbChairID);
+        if (pEvent != NULL) pEvent->SendCard = SendCard;
+    }
+
+    void push(uint8_t cbChairID, const CMD_S_OutCard &OutCard) {
+        tagGameEvent *pEvent = append(GameEvent_OutCard, cbChairID);
+        if (pEvent != NULL) pEvent->OutCard = OutCard;
+    }
+
+    void push(uint8_t cbChairID, const CMD_S_OperateNotify &OperateNotify) {
+        tagGameEvent *pEvent = append(GameEvent_OperateNotify, cbChairID);
+        if (pEvent != NULL) pEvent->OperateNotify = OperateNotify;
+    }
+
+    void push(uint8_t cbChairID, const CMD_S_OperateResult &OperateResult) {
+        tagGameEvent *pEvent = append(GameEvent_OperateResult, cbChairID);
+        if (pEvent != NULL) pEvent->OperateResult = OperateResult;
+    }
+
+    void push(uint8_t cbChairID, const CMD_S_GameEnd &GameEnd) {
+        tagGameEvent *pEvent = append(GameEvent_GameEnd, cbChairID);
+        if (pEvent != NULL) pEvent->GameEnd = GameEnd;
+    }
+
+private:
+    tagGameEvent *append(uint8_t cbKind, uint8_t cbChairID) {
+        if (m_cbCount >= MAX_GAME_EVENT) {
+            m_bOverflow = true;
+            return NULL;
+        }
+        tagGameEvent *pEvent = &m_Events[m_cbCount++];
+        pEvent->cbKind = cbKind;
+        pEvent->cbChairID = cbChairID;
+        return pEvent;
+    }
+
+    tagGameEvent m_Events[MAX_GAME_EVENT];
+    uint8_t m_cbCount;
+    bool m_bOverflow;
+};
+
+#endif //COCOSTUDIO_MAHJONG_GAMEEVENT_H
@@ -3,60 +3,20 @@
 //
 
 #include "GameLogic.h"
+#include "HuTable.h"
+#include "ShantenTable.h"
 
-//麻将牌
-const uint8_t GameLogic::m_cbCardDataArray[MAX_REPERTORY] = {
-        0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09,                        //筒子
-        0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09,                        //筒子
-        0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09,                        //筒子
-        0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09,                        //筒子
-        0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19,                        //万子
-        0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19,                        //万子
-        0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19,                        //万子
-        0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19,                        //万子
-        0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29,                        //条子
-        0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29,                        //条子
-        0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29,                        //条子
-        0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29,                        //条子
-        0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37,                                    //番子
-        0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37,                                    //番子
-        0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37,                                    //番子
-        0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37,                                    //番子
-};
-
-/**
- * 洗牌
- * @param cbCardData
- * @param cbMaxCount
- */
-void GameLogic::shuffle(uint8_t *cbCardData, uint8_t cbMaxCount) {
-    srand(static_cast<unsigned int>(time(NULL)));
-    uint8_t cbCardDataTemp[sizeof(m_cbCardDataArray)];
-    memcpy(cbCardDataTemp, m_cbCardDataArray, sizeof(m_cbCardDataArray));
-    uint8_t cbRandCount = 0, cbPosition = 0;
-    do {
-        cbPosition = static_cast<uint8_t>(rand() % (cbMaxCount - cbRandCount));
-        cbCardData[cbRandCount++] = cbCardDataTemp[cbPosition];
-        cbCardDataTemp[cbPosition] = cbCardDataTemp[cbMaxCount - cbRandCount];
-    } while (cbRandCount < cbMaxCount);
-}
+#include <cstdlib>
+#include <cstring>
 
 /**
- * Index转成牌
- * @param cbCardIndex
- * @return
- */
-uint8_t GameLogic::switchToCardData(uint8_t cbCardIndex) {
-    return static_cast<uint8_t>(((cbCardIndex / 9) << 4) | (cbCardIndex % 9 + 1));;
-}
-
-/**
- * 牌转成Index
+ * 洗牌（Fisher–Yates），随机数来自房间自己的发生器
  * @param cbCardData
- * @return
+ * @param cbMaxCount
+ * @param Random
  */
-uint8_t GameLogic::switchToCardIndex(uint8_t cbCardData) {
-    return static_cast<uint8_t>(((cbCardData & MASK_COLOR) >> 4) * 9 + (cbCardData & MASK_VALUE) - 1);
+void GameLogic::shuffle(uint8_t *cbCardData, uint8_t cbMaxCount, GameRandom &Random) {
+    StandardTileSet::shuffle(cbCardData, cbMaxCount, Random);
 }
 
 /**
@@ -91,7 +51,7 @@ uint8_t GameLogic::switchToCardData(uint8_t *cbCardIndex, uint8_t *cbCardData, u
  *  牌的Index
  * @return
  */
-uint8_t GameLogic::switchToCardIndex(uint8_t *cbCardData, uint8_t cbCardCount, uint8_t *cbCardIndex) {
+uint8_t GameLogic::switchToCardIndex(const uint8_t *cbCardData, uint8_t cbCardCount, uint8_t *cbCardIndex) {
     //设置变量
     memset(cbCardIndex, 0, sizeof(uint8_t) * MAX_INDEX);
     //转换扑克
@@ -102,17 +62,6 @@ uint8_t GameLogic::switchToCardIndex(uint8_t *cbCardData, uint8_t cbCardCount, u
 }
 
 
-/**
- * 是否有效的牌
- * @param cbCardData
- * @return
- */
-bool GameLogic::isValidCard(uint8_t cbCardData) {
-    uint8_t cbValue = static_cast<uint8_t>(cbCardData & MASK_VALUE);
-    uint8_t cbColor = static_cast<uint8_t>((cbCardData & MASK_COLOR) >> 4);
-    return (((cbValue >= 1) && (cbValue <= 9) && (cbColor <= 2)) || ((cbValue >= 1) && (cbValue <= 7) && (cbColor == 3)));
-}
-
 /**
  * 移除牌
  * @param cbCardIndex
@@ -283,6 +232,48 @@ uint8_t GameLogic::estimateGangCard(uint8_t *cbCardIndex, uint8_t cbCurrentCard)
     return static_cast<uint8_t>((cbCardIndex[switchToCardIndex(cbCurrentCard)] == 3) ? WIK_G : WIK_NULL);
 }
 
+/**
+ * 批量响应判定：把各座位手牌中出的那一列（张数、放弃碰标记）按座位一字节拼成 32 位，
+ * 一次算出所有座位的碰、杠，胡牌只按等牌掩码挑出候选座位，由调用方做完整分析
+ * @param cbCardIndex 各座位手牌
+ * @param bPassPeng 各座位放弃碰的牌
+ * @param llHuMask 各座位的等牌掩码
+ * @param cbPlayerCount 座位数量
+ * @param cbProvideUser 出牌的座位（不参与判定）
+ * @param cbCurrentCard 出的牌
+ * @param bOutCard 是否普通出牌（抢杠只判定胡）
+ * @param bGang 是否还能杠（有剩余的牌）
+ * @param cbUserAction 输出各座位的碰、杠动作，全部座位都会写入
+ * @return 等牌中有这张牌的座位（第 i 位为座位 i）
+ */
+uint8_t GameLogic::estimateRespond(const uint8_t cbCardIndex[GAME_PLAYER][MAX_INDEX], const bool bPassPeng[GAME_PLAYER][MAX_INDEX], const uint64_t llHuMask[GAME_PLAYER], uint8_t cbPlayerCount, uint8_t cbProvideUser, uint8_t cbCurrentCard, bool bOutCard, bool bGang, uint8_t cbUserAction[GAME_PLAYER]) {
+    static_assert(GAME_PLAYER <= 4, "每个座位占一个字节，最多 4 个座位");
+    uint8_t cbIndex = switchToCardIndex(cbCurrentCard);
+    uint32_t dwCount = 0, dwPass = 0, dwSeat = 0;   //第 i 个字节是座位 i
+    uint8_t cbHuUser = 0;
+    for (uint8_t i = 0; i < cbPlayerCount; i++) {
+        if (i == cbProvideUser) continue;
+        dwCount |= static_cast<uint32_t>(cbCardIndex[i][cbIndex]) << (8 * i);
+        dwPass |= static_cast<uint32_t>(bPassPeng[i][cbIndex] ? 0x80 : 0) << (8 * i);
+        dwSeat |= 0x80u << (8 * i);
+        cbHuUser |= static_cast<uint8_t>(((llHuMask[i] >> cbIndex) & 1) << i);
+    }
+    uint32_t dwPeng = 0, dwGang = 0;
+    if (bOutCard) {
+        //张数不超过 4，各字节相加不会进位：+0x7E 后最高位为 1 即张数 >= 2
+        dwPeng = (dwCount + 0x7E7E7E7Eu) & dwSeat & ~dwPass;
+        if (bGang) {
+            //异或 3 后为 0 的字节即张数 == 3，+0x7F 后最高位为 0
+            dwGang = ~((dwCount ^ 0x03030303u) + 0x7F7F7F7Fu) & dwSeat;
+        }
+    }
+    uint32_t dwAction = (dwPeng >> 7) * WIK_P | (dwGang >> 7) * WIK_G;
+    for (uint8_t i = 0; i < GAME_PLAYER; i++) {
+        cbUserAction[i] = static_cast<uint8_t>(dwAction >> (8 * i));
+    }
+    return cbHuUser;
+}
+
 /**
  * 分析杠
  * @param cbCardIndex
@@ -362,8 +353,7 @@ uint8_t GameLogic::analyseHuCard(const uint8_t *cbCardIndex, tagWeaveItem *Weave
     uint8_t cbCardCount = static_cast<uint8_t>(cbCardCountTemp - 1);
     //=================构造扑克结束
     //分析扑克
-    CAnalyseItemArray AnalyseItemArray;
-    AnalyseItemArray.clear();
+    CAnalyseItemArray AnalyseItemArray;                 //定长数组，不分配堆内存
     analyseCard(cbCardIndexTemp, cbCardCountTemp, WeaveItem, cbWeaveCount, AnalyseItemArray);
     //*********************************分析胡牌方式开始**********************************************//
     //平胡
@@ -446,18 +436,107 @@ uint8_t GameLogic::getUserActionRank(uint8_t cbUserAction) {
  */
 uint8_t GameLogic::analyseHuCardCount(const uint8_t *cbCardIndex, tagWeaveItem *WeaveItem, uint8_t cbWeaveCount) {
     uint8_t cbCount = 0;
-    uint8_t cbCardIndexTemp[MAX_INDEX];
-    memcpy(cbCardIndexTemp, cbCardIndex, sizeof(cbCardIndexTemp));
+    const PackedHand Hand(cbCardIndex);        //只转换一次，每张候选牌只是复制两个字再加一
     for (uint8_t j = 0; j < MAX_INDEX; j++) {
-        uint8_t cbCurrentCard = switchToCardData(j);
-        if (analyseCanHuCard(cbCardIndexTemp, WeaveItem, cbWeaveCount, cbCurrentCard)) {
+        PackedHand HandTemp = Hand;
+        HandTemp.add(j);
+        if (analyseCanHuCard(HandTemp, cbWeaveCount)) {
             cbCount++;
         }
     }
     return cbCount;
 }
 
+/**
+ * 胡牌特殊情况：与 analyseHuCard 填入 huSpecial 的结果相同，卡张（只等一张牌）由等牌掩码判断，不再逐张分析；
+ * 给不在等牌中、跳过完整分析的座位使用，结算时各座位的 cbHuSpecial 不变
+ * @param cbCardIndex
+ *  手上的牌（不含 cbCurrentCard）
+ * @param cbWeaveCount
+ * @param cbCurrentCard
+ * @param cbSendCardCount
+ * @param cbOutCardCount
+ * @param llHuMask
+ *  cbCardIndex 的等牌掩码（TingCache）
+ * @return
+ */
+uint8_t GameLogic::analyseHuSpecial(const uint8_t *cbCardIndex, uint8_t cbWeaveCount, uint8_t cbCurrentCard, const uint8_t cbSendCardCount, const uint8_t cbOutCardCount, uint64_t llHuMask) {
+    uint8_t cbCardIndexTemp[MAX_INDEX];
+    memcpy(cbCardIndexTemp, cbCardIndex, sizeof(cbCardIndexTemp));
+    if (cbCurrentCard != 0) {cbCardIndexTemp[switchToCardIndex(cbCurrentCard)]++;}
+    uint8_t cbCardCount = static_cast<uint8_t>(getCardCount(cbCardIndexTemp) - 1);
+    uint8_t huSpecial = CHS_NULL;
+    huSpecial |= gangPai(cbCardIndexTemp);                          //有杠
+    huSpecial |= danZhang(cbCardCount);                             //单张牌
+    huSpecial |= diHu(cbSendCardCount, cbOutCardCount);             //地胡
+    huSpecial |= tianHu(cbSendCardCount, cbOutCardCount);           //天胡
+    //卡张判定：与 analyseHuCardCount 一样按 analyseCanHuCard 计数。它与等牌掩码只在补牌后有 4 张同样的牌时
+    //不同（含 4 张的七对掩码算胡、analyseCanHuCard 不算；第 5 张掩码不算），只有这些牌逐张查表
+    const PackedHand Hand(cbCardIndex);
+    bool bHasFour = Hand.countEqual(4) != 0;
+    uint8_t cbHuCount = 0;
+    for (uint8_t j = 0; j < MAX_INDEX && cbHuCount < 2; j++) {
+        bool bMask = ((llHuMask >> j) & 1) != 0;
+        if (!bHasFour && cbCardIndex[j] != 3) {
+            if (bMask) cbHuCount++;
+            continue;
+        }
+        if (!bMask && cbCardIndex[j] != 4) continue;
+        PackedHand HandTemp = Hand;
+        HandTemp.add(j);
+        if (analyseCanHuCard(HandTemp, cbWeaveCount)) cbHuCount++;
+    }
+    if (cbHuCount == 1) {
+        huSpecial |= CHS_KZ;
+    }
+    return huSpecial;
+}
+
+/**
+ * 分析扑克：查表判定后列出所有不同的拆法
+ * @param cbCardIndex
+ *  手上的牌
+ * @param cbCardCount
+ *  牌数
+ * @param WeaveItem
+ *  碰、杠的牌
+ * @param cbItemCount
+ *  碰、杠数量
+ * @param AnalyseItemArray
+ *  拆分结果（组合在前）
+ * @return
+ */
 bool GameLogic::analyseCard(const uint8_t *cbCardIndex, const uint8_t cbCardCount, tagWeaveItem *WeaveItem, uint8_t cbItemCount, CAnalyseItemArray &AnalyseItemArray) {
+    //效验数目
+    if ((cbCardCount < 2) || (cbCardCount > MAX_COUNT) || ((cbCardCount - 2) % 3 != 0)) return false;
+    if (cbItemCount + (cbCardCount - 2) / 3 > MAX_WEAVE) return false;
+    return HuTable::instance().decompose(cbCardIndex, WeaveItem, cbItemCount, AnalyseItemArray) > 0;
+}
+
+/**
+ * 分析扑克：只要第一种拆法（只需判断能否拆完、或只用一种拆法的调用方），不列出其余拆法
+ * @param cbCardIndex
+ * @param cbCardCount
+ * @param WeaveItem
+ * @param cbItemCount
+ * @param AnalyseItem
+ *  第一种拆法（组合在前）
+ * @return
+ */
+bool GameLogic::analyseCardFirst(const uint8_t *cbCardIndex, const uint8_t cbCardCount, tagWeaveItem *WeaveItem, uint8_t cbItemCount, tagAnalyseItem &AnalyseItem) {
+    if ((cbCardCount < 2) || (cbCardCount > MAX_COUNT) || ((cbCardCount - 2) % 3 != 0)) return false;
+    if (cbItemCount + (cbCardCount - 2) / 3 > MAX_WEAVE) return false;
+    CAnalyseItemArray AnalyseItemArray;
+    if (HuTable::instance().decompose(cbCardIndex, WeaveItem, cbItemCount, AnalyseItemArray, 1) == 0) return false;
+    AnalyseItem = AnalyseItemArray[0];
+    return true;
+}
+
+/**
+ * 分析扑克（组合搜索）：先列出所有刻子、顺子，再枚举其中 n 个的组合。
+ * 查表实现的对照，只在测试和基准中使用；同一顺子可能出现多次，结果会有重复的拆法
+ */
+bool GameLogic::analyseCardBySearch(const uint8_t *cbCardIndex, const uint8_t cbCardCount, tagWeaveItem *WeaveItem, uint8_t cbItemCount, CAnalyseItemArray &AnalyseItemArray) {
     //效验数目
     if ((cbCardCount < 2) || (cbCardCount > MAX_COUNT) || ((cbCardCount - 2) % 3 != 0)) return false;
     //变量定义
@@ -598,18 +677,17 @@ bool GameLogic::analyseCard(const uint8_t *cbCardIndex, const uint8_t cbCardCoun
 }
 
 bool GameLogic::analyseTingCard(const uint8_t *cbCardIndex, tagWeaveItem *WeaveItem, uint8_t cbWeaveCount) {
-    uint8_t cbCardIndexTemp[MAX_INDEX];
-    memcpy(cbCardIndexTemp, cbCardIndex, sizeof(cbCardIndexTemp));
+    PackedHand Hand(cbCardIndex);
     for (uint8_t i = 0; i < MAX_INDEX; i++) {
-        if (cbCardIndexTemp[i] == 0) continue;//空牌过滤
-        cbCardIndexTemp[i]--;                  //假设出掉的牌
+        if (!Hand.remove(i)) continue;         //空牌过滤，假设出掉的牌
         for (uint8_t j = 0; j < MAX_INDEX; j++) {
-            uint8_t cbCurrentCard = switchToCardData(j);
-            if (analyseCanHuCard(cbCardIndexTemp, WeaveItem, cbWeaveCount, cbCurrentCard)) {
+            PackedHand HandTemp = Hand;
+            HandTemp.add(j);
+            if (analyseCanHuCard(HandTemp, cbWeaveCount)) {
                 return true;
             }
         }
-        cbCardIndexTemp[i]++;                 //还原假设的牌
+        Hand.add(i);                           //还原假设的牌
     }
     return false;
 }
@@ -624,18 +702,28 @@ bool GameLogic::analyseTingCard(const uint8_t *cbCardIndex, tagWeaveItem *WeaveI
  */
 bool GameLogic::analyseCanHuCard(const uint8_t *cbCardIndex, tagWeaveItem *WeaveItem, uint8_t cbWeaveCount, uint8_t cbCurrentCard) {
     //=================构造扑克开始
-    uint8_t cbCardIndexTemp[MAX_INDEX];
-    memcpy(cbCardIndexTemp, cbCardIndex, sizeof(cbCardIndexTemp));                //临时扑克，用来分析
-    if (cbCurrentCard != 0) {cbCardIndexTemp[switchToCardIndex(cbCurrentCard)]++;}//14只牌
+    PackedHand Hand(cbCardIndex);                                   //临时扑克，用来分析
+    if (cbCurrentCard != 0) {Hand.add(switchToCardIndex(cbCurrentCard));}//14只牌
+    return analyseCanHuCard(Hand, cbWeaveCount);
+}
+
+/**
+ * 判断是否能胡牌（位压缩手牌，已包含当前牌）
+ * @param Hand
+ * @param cbWeaveCount
+ * @return
+ */
+bool GameLogic::analyseCanHuCard(const PackedHand &Hand, uint8_t cbWeaveCount) {
     //计算数目
-    uint8_t cbCardCountTemp = getCardCount(cbCardIndexTemp);
-    uint8_t cbCardCount = static_cast<uint8_t>(cbCardCountTemp - 1);
-    //分析扑克
-    CAnalyseItemArray AnalyseItemArray;
-    AnalyseItemArray.clear();
-    analyseCard(cbCardIndexTemp, cbCardCountTemp, WeaveItem, cbWeaveCount, AnalyseItemArray);
-    //是否能胡牌
-    return canHu(cbCardIndexTemp, cbCardCountTemp, cbCardIndex, cbCardCount, WeaveItem, cbWeaveCount, AnalyseItemArray);
+    uint8_t cbCardCountTemp = Hand.total();
+    //七对（与 canHu 相同）
+    if (cbWeaveCount == 0 && Hand.countEqual(2) == 7) {
+        return true;
+    }
+    //查表判断，不需要列出拆法
+    if ((cbCardCountTemp < 2) || (cbCardCountTemp > MAX_COUNT) || ((cbCardCountTemp - 2) % 3 != 0)) return false;
+    if (cbWeaveCount + (cbCardCountTemp - 2) / 3 > MAX_WEAVE) return false;
+    return HuTable::instance().isComplete(Hand);
 }
 
 /**
@@ -648,17 +736,134 @@ bool GameLogic::analyseCanHuCard(const uint8_t *cbCardIndex, tagWeaveItem *Weave
  */
 bool GameLogic::analyseTingCardResult(const uint8_t *cbCardIndex, tagWeaveItem *WeaveItem, uint8_t cbWeaveCount, tagTingResult &tingResult) {
     memset(&tingResult, 0, sizeof(tagTingResult));
-    uint8_t cbCardIndexTemp[MAX_INDEX];
-    memcpy(cbCardIndexTemp, cbCardIndex, sizeof(cbCardIndexTemp));
+    const PackedHand Hand(cbCardIndex);
     for (uint8_t j = 0; j < MAX_INDEX; j++) {
-        uint8_t cbCurrentCard = switchToCardData(j);
-        if (analyseCanHuCard(cbCardIndexTemp, WeaveItem, cbWeaveCount, cbCurrentCard)) {
-            tingResult.cbTingCard[tingResult.cbTingCount++] = cbCurrentCard;
+        PackedHand HandTemp = Hand;
+        HandTemp.add(j);
+        if (analyseCanHuCard(HandTemp, cbWeaveCount)) {
+            tingResult.cbTingCard[tingResult.cbTingCount++] = switchToCardData(j);
         }
     }
     return tingResult.cbTingCount > 0;
 }
 
+namespace {
+    //七对向听数：4 张算两对（与 qiDui 一致），cbPairCount 为对子数
+    inline int8_t qiDuiShanten(uint8_t cbPairCount) {
+        return static_cast<int8_t>(6 - (cbPairCount < 7 ? cbPairCount : 7));
+    }
+}
+
+/**
+ * 向听数：平胡等（n 个面子加一对将）查表，无碰杠的 13、14 张手牌再算七对，取较小值
+ * @param cbCardIndex
+ * @param cbWeaveCount
+ * @return
+ */
+int8_t GameLogic::analyseShanten(const uint8_t *cbCardIndex, uint8_t cbWeaveCount) {
+    return analyseShanten(PackedHand(cbCardIndex), cbWeaveCount);
+}
+
+/**
+ * 向听数（位压缩手牌）
+ * @param Hand
+ * @param cbWeaveCount
+ * @return
+ */
+int8_t GameLogic::analyseShanten(const PackedHand &Hand, uint8_t cbWeaveCount) {
+    int8_t cbShanten = ShantenTable::instance().analyse(Hand);
+    if (cbWeaveCount == 0 && Hand.total() >= MAX_COUNT - 1) {
+        int8_t cbQiDui = qiDuiShanten(static_cast<uint8_t>(Hand.countAtLeast(2) + Hand.countAtLeast(4)));
+        if (cbQiDui < cbShanten) cbShanten = cbQiDui;
+    }
+    return cbShanten;
+}
+
+/**
+ * 出牌建议：3n+2 张手牌打出每种牌后的向听数，以及摸进后能减少向听数的有效牌和剩余张数，
+ * 按向听数从小到大、有效牌张数从多到少排序。打一张、摸一张只改变一两门，其余门的表项复用
+ * @param cbCardIndex
+ * @param cbWeaveCount
+ * @param cbVisibleIndex
+ *  已见的牌（各家打出、碰杠亮出），可以为空
+ * @param DiscardResult
+ * @return
+ */
+uint8_t GameLogic::analyseDiscard(const uint8_t *cbCardIndex, uint8_t cbWeaveCount, const uint8_t *cbVisibleIndex, tagDiscardResult *DiscardResult) {
+    const ShantenTable &table = ShantenTable::instance();
+    const PackedHand Hand(cbCardIndex);
+    uint8_t cbMeldCount = static_cast<uint8_t>(Hand.total() / 3);
+    if (cbMeldCount > MAX_WEAVE) cbMeldCount = MAX_WEAVE;
+    bool bQiDui = cbWeaveCount == 0 && Hand.total() == MAX_COUNT;
+    uint8_t cbPairCount = static_cast<uint8_t>(Hand.countAtLeast(2) + Hand.countAtLeast(4));
+
+    //原样的表项、各加一张的表项
+    uint64_t llEntry[4];
+    uint32_t cbBits[4];
+    for (uint8_t g = 0; g < 4; g++) {
+        cbBits[g] = Hand.suitBits(g);
+        llEntry[g] = table.suitEntry(g, cbBits[g]);
+    }
+    uint64_t llPlusEntry[MAX_INDEX];
+    for (uint8_t j = 0; j < MAX_INDEX; j++) {
+        uint8_t g = static_cast<uint8_t>(j / 9);
+        llPlusEntry[j] = Hand.count(j) < 4 ? table.suitEntry(g, cbBits[g] + (1U << (PackedHand::FIELD_BITS * (j % 9)))) : 0;
+    }
+
+    uint8_t cbResultCount = 0;
+    for (uint8_t i = 0; i < MAX_INDEX; i++) {
+        uint8_t cbOutCount = Hand.count(i);
+        if (cbOutCount == 0) continue;
+        uint8_t cbOutSuit = static_cast<uint8_t>(i / 9);
+        uint32_t cbOutBits = cbBits[cbOutSuit] - (1U << (PackedHand::FIELD_BITS * (i % 9)));
+        uint64_t llOutEntry[4];
+        memcpy(llOutEntry, llEntry, sizeof(llOutEntry));
+        llOutEntry[cbOutSuit] = table.suitEntry(cbOutSuit, cbOutBits);
+        uint8_t cbOutPair = static_cast<uint8_t>(cbPairCount - (cbOutCount % 2 == 0 ? 1 : 0));
+        int8_t cbShanten = static_cast<int8_t>(ShantenTable::combine(llOutEntry, cbMeldCount) - 1);
+        if (bQiDui && qiDuiShanten(cbOutPair) < cbShanten) cbShanten = qiDuiShanten(cbOutPair);
+
+        tagDiscardResult &Result = DiscardResult[cbResultCount++];
+        Result.cbOutCard = switchToCardData(i);
+        Result.cbShanten = cbShanten;
+        Result.cbUsefulKind = 0;
+        Result.cbUsefulCount = 0;
+        Result.llUsefulMask = 0;
+        for (uint8_t j = 0; j < MAX_INDEX; j++) {
+            uint8_t cbCount = static_cast<uint8_t>(Hand.count(j) - (j == i ? 1 : 0));
+            if (cbCount >= 4) continue;
+            uint8_t g = static_cast<uint8_t>(j / 9);
+            uint64_t llTryEntry[4];
+            memcpy(llTryEntry, llOutEntry, sizeof(llTryEntry));
+            llTryEntry[g] = (g == cbOutSuit) ? table.suitEntry(g, cbOutBits + (1U << (PackedHand::FIELD_BITS * (j % 9)))) : llPlusEntry[j];
+            int8_t cbTry = static_cast<int8_t>(ShantenTable::combine(llTryEntry, cbMeldCount) - 1);
+            if (bQiDui) {
+                int8_t cbQiDui = qiDuiShanten(static_cast<uint8_t>(cbOutPair + (cbCount % 2 == 1 ? 1 : 0)));
+                if (cbQiDui < cbTry) cbTry = cbQiDui;
+            }
+            if (cbTry >= cbShanten) continue;
+            //剩余张数：4 张减去自己手上的（含打出的这张）和已见的
+            int iLive = 4 - Hand.count(j) - (cbVisibleIndex != nullptr ? cbVisibleIndex[j] : 0);
+            Result.llUsefulMask |= 1ULL << j;
+            Result.cbUsefulKind++;
+            if (iLive > 0) Result.cbUsefulCount = static_cast<uint8_t>(Result.cbUsefulCount + iLive);
+        }
+    }
+
+    //插入排序（最多 14 项）
+    for (uint8_t k = 1; k < cbResultCount; k++) {
+        tagDiscardResult Result = DiscardResult[k];
+        uint8_t n = k;
+        while (n > 0 && (DiscardResult[n - 1].cbShanten > Result.cbShanten
+                         || (DiscardResult[n - 1].cbShanten == Result.cbShanten && DiscardResult[n - 1].cbUsefulCount < Result.cbUsefulCount))) {
+            DiscardResult[n] = DiscardResult[n - 1];
+            n--;
+        }
+        DiscardResult[n] = Result;
+    }
+    return cbResultCount;
+}
+
 /**
  * 判断是否能胡
  * @param cbCardIndexTemp
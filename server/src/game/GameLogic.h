@@ -6,10 +6,14 @@
 #define COCOSTUDIO_MAHJONG_GAMELOGIC_H
 
 #include "GameCmd.h"
-#include <vector>
+#include "GameRandom.h"
+#include "PackedHand.h"
+#include "TileSet.h"
+#include <cstddef>
 
 #define    MASK_COLOR                    0xF0                                //花色掩码
 #define    MASK_VALUE                    0x0F                                //数值掩码
+#define    MAX_ANALYSE_ITEM              32                                  //拆分结果的最大数量
 
 
 #define FALSE        0
@@ -87,65 +91,106 @@ struct tagTingResult{
     uint8_t cbTingCount;                           //听牌数量
     uint8_t cbTingCard[MAX_INDEX];                 //听的牌
 };
+
+//出牌建议
+struct tagDiscardResult {
+    uint8_t cbOutCard;                             //打出的牌
+    int8_t cbShanten;                              //打出后的向听数（0 为听牌）
+    uint8_t cbUsefulKind;                          //有效牌种数（摸进后向听数减少）
+    uint8_t cbUsefulCount;                         //有效牌剩余张数（去掉自己手牌和已见的牌）
+    uint64_t llUsefulMask;                         //有效牌掩码，第 j 位为第 j 种牌
+};
 //////////////////////////////////////////////////////////////////////////
 
-//数组说明
-typedef std::vector<tagAnalyseItem> CAnalyseItemArray;
+//数组说明：拆分结果是定长数组，放在调用方的栈上，分析手牌不分配堆内存。
+//查表的拆法不重复（单门最多 4 种），MAX_ANALYSE_ITEM 足够；组合搜索（对照用）会有重复，满了之后丢弃
+class CAnalyseItemArray {
+public:
+    CAnalyseItemArray() : m_cbItemCount(0) {
+    }
 
-class GameLogic {
+    //插入结果，已满时丢弃并返回 false
+    bool push_back(const tagAnalyseItem &AnalyseItem) {
+        if (m_cbItemCount >= MAX_ANALYSE_ITEM) return false;
+        m_AnalyseItem[m_cbItemCount++] = AnalyseItem;
+        return true;
+    }
+
+    size_t size() const { return m_cbItemCount; }
+    bool empty() const { return m_cbItemCount == 0; }
+    bool full() const { return m_cbItemCount >= MAX_ANALYSE_ITEM; }
+    void clear() { m_cbItemCount = 0; }
+
+    tagAnalyseItem &operator[](size_t i) { return m_AnalyseItem[i]; }
+    const tagAnalyseItem &operator[](size_t i) const { return m_AnalyseItem[i]; }
 
 private:
-    static const uint8_t m_cbCardDataArray[MAX_REPERTORY];    //扑克数据
+    tagAnalyseItem m_AnalyseItem[MAX_ANALYSE_ITEM];
+    uint8_t m_cbItemCount;
+};
+
+class GameLogic {
+
 public:
+    GameLogic() = delete;   //规则没有状态，全部是静态函数，所有房间共享
+    static_assert(StandardTileSet::INDEX_COUNT == MAX_INDEX && StandardTileSet::REPERTORY_COUNT == MAX_REPERTORY, "牌组与 MAX_INDEX、MAX_REPERTORY 一致");
 
-    void shuffle(uint8_t cbCardData[], uint8_t cbMaxCount);//洗牌
-    bool removeCard(uint8_t cbCardIndex[MAX_INDEX], uint8_t cbRemoveCard);//删除扑克
-    bool removeCard(uint8_t cbCardIndex[MAX_INDEX], uint8_t cbRemoveCard[], uint8_t cbRemoveCount); //删除扑克
-    bool removeCard(uint8_t cbCardData[], uint8_t cbCardCount, uint8_t cbRemoveCard[], uint8_t cbRemoveCount); //删除扑克
-    bool removeAllCard(uint8_t cbCardIndex[MAX_INDEX], uint8_t cbRemoveCard);   //移除指定的牌
+    static void shuffle(uint8_t cbCardData[], uint8_t cbMaxCount, GameRandom &Random);//洗牌
+    static bool removeCard(uint8_t cbCardIndex[MAX_INDEX], uint8_t cbRemoveCard);//删除扑克
+    static bool removeCard(uint8_t cbCardIndex[MAX_INDEX], uint8_t cbRemoveCard[], uint8_t cbRemoveCount); //删除扑克
+    static bool removeCard(uint8_t cbCardData[], uint8_t cbCardCount, uint8_t cbRemoveCard[], uint8_t cbRemoveCount); //删除扑克
+    static bool removeAllCard(uint8_t cbCardIndex[MAX_INDEX], uint8_t cbRemoveCard);   //移除指定的牌
 
 public://内部函数
-    bool isValidCard(uint8_t cbCardData);           //有效判断
-    uint8_t switchToCardData(uint8_t cbCardIndex);  //扑克转换
-    uint8_t switchToCardIndex(uint8_t cbCardData);  //扑克转换
-    uint8_t switchToCardData(uint8_t cbCardIndex[MAX_INDEX], uint8_t cbCardData[MAX_COUNT], uint8_t bMaxCount); //扑克转换
-    uint8_t switchToCardIndex(uint8_t cbCardData[], uint8_t cbCardCount, uint8_t cbCardIndex[MAX_INDEX]); //扑克转换
-    uint8_t getCardCount(uint8_t cbCardIndex[MAX_INDEX]);  //扑克数目
-    uint8_t getWeaveCard(uint8_t cbWeaveKind, uint8_t cbCenterCard, uint8_t cbCardBuffer[]);//组合扑克
+    static constexpr bool isValidCard(uint8_t cbCardData) { return StandardTileSet::isValidCard(cbCardData); }             //有效判断（查表）
+    static constexpr uint8_t switchToCardData(uint8_t cbCardIndex) { return StandardTileSet::switchToCardData(cbCardIndex); }  //扑克转换（查表）
+    static constexpr uint8_t switchToCardIndex(uint8_t cbCardData) { return StandardTileSet::switchToCardIndex(cbCardData); }  //扑克转换（查表）
+    static uint8_t switchToCardData(uint8_t cbCardIndex[MAX_INDEX], uint8_t cbCardData[MAX_COUNT], uint8_t bMaxCount); //扑克转换
+    static uint8_t switchToCardIndex(const uint8_t cbCardData[], uint8_t cbCardCount, uint8_t cbCardIndex[MAX_INDEX]); //扑克转换
+    static uint8_t getCardCount(uint8_t cbCardIndex[MAX_INDEX]);  //扑克数目
+    static uint8_t getWeaveCard(uint8_t cbWeaveKind, uint8_t cbCenterCard, uint8_t cbCardBuffer[]);//组合扑克
     //动作判断
 public:
-    uint8_t estimatePengCard(uint8_t cbCardIndex[MAX_INDEX], uint8_t cbCurrentCard); //碰牌判断
-    uint8_t estimateGangCard(uint8_t cbCardIndex[MAX_INDEX], uint8_t cbCurrentCard); //杠牌判断
+    static uint8_t estimatePengCard(uint8_t cbCardIndex[MAX_INDEX], uint8_t cbCurrentCard); //碰牌判断
+    static uint8_t estimateGangCard(uint8_t cbCardIndex[MAX_INDEX], uint8_t cbCurrentCard); //杠牌判断
+    static uint8_t estimateRespond(const uint8_t cbCardIndex[GAME_PLAYER][MAX_INDEX], const bool bPassPeng[GAME_PLAYER][MAX_INDEX], const uint64_t llHuMask[GAME_PLAYER], uint8_t cbPlayerCount, uint8_t cbProvideUser, uint8_t cbCurrentCard, bool bOutCard, bool bGang, uint8_t cbUserAction[GAME_PLAYER]); //批量响应判定，返回需要完整胡牌分析的座位
     //等级函数
 public:
-    uint8_t getUserActionRank(uint8_t wUserAction); //动作等级
-    uint8_t getHuFanShu(const uint64_t huRight, const uint8_t huKind, const uint8_t huSpecial); //胡牌分数
+    static uint8_t getUserActionRank(uint8_t wUserAction); //动作等级
+    static uint8_t getHuFanShu(const uint64_t huRight, const uint8_t huKind, const uint8_t huSpecial); //胡牌分数
 public://分析函数
-    uint8_t analyseGangCard(const uint8_t cbCardIndex[MAX_INDEX], tagWeaveItem WeaveItem[], uint8_t cbWeaveCount, tagGangCardResult &GangCardResult); //杠牌分析
-    uint8_t analyseHuCard(const uint8_t cbCardIndex[MAX_INDEX], tagWeaveItem WeaveItem[], uint8_t cbWeaveCount, uint8_t cbCurrentCard, uint8_t &huKind, uint64_t &huRight, uint8_t &huSpecial, const uint8_t cbSendCardCount, const uint8_t cbOutCardCount, const bool bGangStatus, const bool bZimo, const bool bQiangGangStatus, uint8_t &cbFanShu, const bool bCheck);    //胡牌分析，返回胡牌类型
-    uint8_t analyseHuCardCount(const uint8_t cbCardIndex[MAX_INDEX], tagWeaveItem WeaveItem[], uint8_t cbWeaveCount);    //获取胡牌的数量
-    bool analyseCard(const uint8_t cbCardIndex[MAX_INDEX], const uint8_t cbCardCount, tagWeaveItem WeaveItem[], uint8_t cbItemCount, CAnalyseItemArray &AnalyseItemArray); //分析扑克
-    bool analyseTingCard(const uint8_t cbCardIndex[MAX_INDEX], tagWeaveItem WeaveItem[], uint8_t cbWeaveCount);    //是否听牌
-    bool analyseCanHuCard(const uint8_t cbCardIndex[MAX_INDEX], tagWeaveItem WeaveItem[], uint8_t cbWeaveCount, uint8_t cbCurrentCard);   //分析是否可以胡牌
-    bool analyseTingCardResult(const uint8_t cbCardIndex[MAX_INDEX], tagWeaveItem WeaveItem[], uint8_t cbWeaveCount , tagTingResult& tingResult);
-    bool canHu(const uint8_t cbCardIndexTemp[MAX_INDEX], const uint8_t cbCardCountTemp, const uint8_t cbCardIndex[MAX_INDEX], const uint8_t cbCardCount, tagWeaveItem WeaveItem[], uint8_t cbWeaveCount, CAnalyseItemArray &AnalyseItemArray); //能胡牌
+    static uint8_t analyseGangCard(const uint8_t cbCardIndex[MAX_INDEX], tagWeaveItem WeaveItem[], uint8_t cbWeaveCount, tagGangCardResult &GangCardResult); //杠牌分析
+    static uint8_t analyseHuCard(const uint8_t cbCardIndex[MAX_INDEX], tagWeaveItem WeaveItem[], uint8_t cbWeaveCount, uint8_t cbCurrentCard, uint8_t &huKind, uint64_t &huRight, uint8_t &huSpecial, const uint8_t cbSendCardCount, const uint8_t cbOutCardCount, const bool bGangStatus, const bool bZimo, const bool bQiangGangStatus, uint8_t &cbFanShu, const bool bCheck);    //胡牌分析，返回胡牌类型
+    static uint8_t analyseHuCardCount(const uint8_t cbCardIndex[MAX_INDEX], tagWeaveItem WeaveItem[], uint8_t cbWeaveCount);    //获取胡牌的数量
+    static uint8_t analyseHuSpecial(const uint8_t cbCardIndex[MAX_INDEX], uint8_t cbWeaveCount, uint8_t cbCurrentCard, const uint8_t cbSendCardCount, const uint8_t cbOutCardCount, uint64_t llHuMask);    //胡牌特殊情况（卡张按等牌掩码判断）
+    static bool analyseCard(const uint8_t cbCardIndex[MAX_INDEX], const uint8_t cbCardCount, tagWeaveItem WeaveItem[], uint8_t cbItemCount, CAnalyseItemArray &AnalyseItemArray); //分析扑克（查表）
+    static bool analyseCardFirst(const uint8_t cbCardIndex[MAX_INDEX], const uint8_t cbCardCount, tagWeaveItem WeaveItem[], uint8_t cbItemCount, tagAnalyseItem &AnalyseItem); //分析扑克（找到第一种拆法即返回）
+    static bool analyseCardBySearch(const uint8_t cbCardIndex[MAX_INDEX], const uint8_t cbCardCount, tagWeaveItem WeaveItem[], uint8_t cbItemCount, CAnalyseItemArray &AnalyseItemArray); //分析扑克（组合搜索，对照用）
+    static bool analyseTingCard(const uint8_t cbCardIndex[MAX_INDEX], tagWeaveItem WeaveItem[], uint8_t cbWeaveCount);    //是否听牌
+    static bool analyseCanHuCard(const uint8_t cbCardIndex[MAX_INDEX], tagWeaveItem WeaveItem[], uint8_t cbWeaveCount, uint8_t cbCurrentCard);   //分析是否可以胡牌
+    static bool analyseCanHuCard(const PackedHand &Hand, uint8_t cbWeaveCount);   //分析是否可以胡牌（位压缩手牌，已含当前牌）
+    static bool analyseTingCardResult(const uint8_t cbCardIndex[MAX_INDEX], tagWeaveItem WeaveItem[], uint8_t cbWeaveCount , tagTingResult& tingResult);
+    static int8_t analyseShanten(const uint8_t cbCardIndex[MAX_INDEX], uint8_t cbWeaveCount);    //向听数（含七对），-1 表示已胡
+    static int8_t analyseShanten(const PackedHand &Hand, uint8_t cbWeaveCount);    //向听数（位压缩手牌）
+    static uint8_t analyseDiscard(const uint8_t cbCardIndex[MAX_INDEX], uint8_t cbWeaveCount, const uint8_t cbVisibleIndex[MAX_INDEX], tagDiscardResult DiscardResult[MAX_INDEX]); //出牌建议，返回可打的牌数
+    static bool canHu(const uint8_t cbCardIndexTemp[MAX_INDEX], const uint8_t cbCardCountTemp, const uint8_t cbCardIndex[MAX_INDEX], const uint8_t cbCardCount, tagWeaveItem WeaveItem[], uint8_t cbWeaveCount, CAnalyseItemArray &AnalyseItemArray); //能胡牌
 private:    //胡牌类型
-    uint64_t pingHu(const uint8_t cbCardIndexTemp[MAX_INDEX], const uint8_t cbCardCountTemp, const uint8_t cbCardIndex[MAX_INDEX], const uint8_t cbCardCount, tagWeaveItem WeaveItem[], uint8_t cbWeaveCount, CAnalyseItemArray &AnalyseItemArray); //平胡
-    uint64_t qingSe(const uint8_t cbCardIndexTemp[MAX_INDEX], const uint8_t cbCardCountTemp, const uint8_t cbCardIndex[MAX_INDEX], const uint8_t cbCardCount, tagWeaveItem WeaveItem[], uint8_t cbWeaveCount, CAnalyseItemArray &AnalyseItemArray); //清一色
-    uint64_t pengPengHu(const uint8_t cbCardIndexTemp[MAX_INDEX], const uint8_t cbCardCountTemp, const uint8_t cbCardIndex[MAX_INDEX], const uint8_t cbCardCount, tagWeaveItem WeaveItem[], uint8_t cbWeaveCount, CAnalyseItemArray &AnalyseItemArray);//碰碰胡
-    uint64_t qiDui(const uint8_t cbCardIndexTemp[MAX_INDEX], const uint8_t cbCardCountTemp, const uint8_t cbCardIndex[MAX_INDEX], const uint8_t cbCardCount, tagWeaveItem WeaveItem[], uint8_t cbWeaveCount, CAnalyseItemArray &AnalyseItemArray);//七对
-    uint64_t diaoYu(const uint8_t cbCardIndexTemp[MAX_INDEX], const uint8_t cbCardCountTemp, const uint8_t cbCardIndex[MAX_INDEX], const uint8_t cbCardCount, tagWeaveItem WeaveItem[], uint8_t cbWeaveCount, CAnalyseItemArray &AnalyseItemArray);//单钓
+    static uint64_t pingHu(const uint8_t cbCardIndexTemp[MAX_INDEX], const uint8_t cbCardCountTemp, const uint8_t cbCardIndex[MAX_INDEX], const uint8_t cbCardCount, tagWeaveItem WeaveItem[], uint8_t cbWeaveCount, CAnalyseItemArray &AnalyseItemArray); //平胡
+    static uint64_t qingSe(const uint8_t cbCardIndexTemp[MAX_INDEX], const uint8_t cbCardCountTemp, const uint8_t cbCardIndex[MAX_INDEX], const uint8_t cbCardCount, tagWeaveItem WeaveItem[], uint8_t cbWeaveCount, CAnalyseItemArray &AnalyseItemArray); //清一色
+    static uint64_t pengPengHu(const uint8_t cbCardIndexTemp[MAX_INDEX], const uint8_t cbCardCountTemp, const uint8_t cbCardIndex[MAX_INDEX], const uint8_t cbCardCount, tagWeaveItem WeaveItem[], uint8_t cbWeaveCount, CAnalyseItemArray &AnalyseItemArray);//碰碰胡
+    static uint64_t qiDui(const uint8_t cbCardIndexTemp[MAX_INDEX], const uint8_t cbCardCountTemp, const uint8_t cbCardIndex[MAX_INDEX], const uint8_t cbCardCount, tagWeaveItem WeaveItem[], uint8_t cbWeaveCount, CAnalyseItemArray &AnalyseItemArray);//七对
+    static uint64_t diaoYu(const uint8_t cbCardIndexTemp[MAX_INDEX], const uint8_t cbCardCountTemp, const uint8_t cbCardIndex[MAX_INDEX], const uint8_t cbCardCount, tagWeaveItem WeaveItem[], uint8_t cbWeaveCount, CAnalyseItemArray &AnalyseItemArray);//单钓
 private: //一些判断
-    uint8_t gangPai(const uint8_t cbCardIndex[MAX_INDEX]);    //手上有杠
-    uint8_t danZhang(const uint8_t cbCardCount);    //手上剩下一张牌
-    uint8_t tianHu(const uint8_t m_cbSendCardCount, const uint8_t m_cbOutCardCount);    //天胡
-    uint8_t diHu(const uint8_t m_cbSendCardCount, const uint8_t m_cbOutCardCount); //地胡
-    uint8_t kaZhang(const uint8_t cbCardIndex[MAX_INDEX], tagWeaveItem WeaveItem[], uint8_t cbWeaveCount);    //卡张
+    static uint8_t gangPai(const uint8_t cbCardIndex[MAX_INDEX]);    //手上有杠
+    static uint8_t danZhang(const uint8_t cbCardCount);    //手上剩下一张牌
+    static uint8_t tianHu(const uint8_t m_cbSendCardCount, const uint8_t m_cbOutCardCount);    //天胡
+    static uint8_t diHu(const uint8_t m_cbSendCardCount, const uint8_t m_cbOutCardCount); //地胡
+    static uint8_t kaZhang(const uint8_t cbCardIndex[MAX_INDEX], tagWeaveItem WeaveItem[], uint8_t cbWeaveCount);    //卡张
 private:    //胡牌方式
-    uint8_t ziMo(uint64_t llHuRight, const bool bGangStatus, const bool bZimo);//自摸
-    uint8_t gangKai(uint64_t llHuRight, const bool bGangStatus, const bool bZimo);//杠开
-    uint8_t qiangGang(uint64_t llHuRight, const bool bGangStatus, const bool bZimo);//枪杠
-    uint8_t jiePao(uint64_t llHuRight, const bool bGangStatus, const bool bZimo);//接炮
+    static uint8_t ziMo(uint64_t llHuRight, const bool bGangStatus, const bool bZimo);//自摸
+    static uint8_t gangKai(uint64_t llHuRight, const bool bGangStatus, const bool bZimo);//杠开
+    static uint8_t qiangGang(uint64_t llHuRight, const bool bGangStatus, const bool bZimo);//枪杠
+    static uint8_t jiePao(uint64_t llHuRight, const bool bGangStatus, const bool bZimo);//接炮
 };
 
 
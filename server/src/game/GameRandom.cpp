@@ -0,0 +1,51 @@
+//
+// GameRandom.cpp
+// 每个房间独立的随机数发生器实现
+//
+
+#include "GameRandom.h"
+
+#include <random>
+#if defined(__linux__)
+#include <sys/random.h>
+#endif
+
+/**
+ * 设置种子，状态由 splitmix64 展开（保证不是全 0）
+ * @param llSeed
+ */
+void GameRandom::seed(uint64_t llSeed) {
+    m_llSeed = llSeed;
+    uint64_t llState = llSeed;
+    for (uint8_t i = 0; i < 4; i++) {
+        m_llState[i] = splitMix64(llState);
+    }
+}
+
+/**
+ * splitmix64
+ * @param llState
+ * @return
+ */
+uint64_t GameRandom::splitMix64(uint64_t &llState) {
+    uint64_t z = (llState += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * 取种子：Linux 直接用 getrandom（不打开文件、不分配内存），失败时退回 std::random_device
+ * @return
+ */
+uint64_t GameRandom::makeSeed() {
+    uint64_t llSeed = 0;
+#if defined(__linux__)
+    if (getrandom(&llSeed, sizeof(llSeed), 0) == static_cast<ssize_t>(sizeof(llSeed))) {
+        return llSeed;
+    }
+#endif
+    std::random_device device;
+    llSeed = (static_cast<uint64_t>(device()) << 32) | device();
+    return llSeed;
+}
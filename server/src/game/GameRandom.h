@@ -0,0 +1,59 @@
+//
+// GameRandom.h
+// 每个房间独立的随机数发生器（xoshiro256**），用于洗牌和掷骰子
+//
+
+#ifndef COCOSTUDIO_MAHJONG_GAMERANDOM_H
+#define COCOSTUDIO_MAHJONG_GAMERANDOM_H
+
+#include <cstdint>
+
+class GameRandom {
+public:
+    explicit GameRandom(uint64_t llSeed = 0) {
+        seed(llSeed);
+    }
+
+    void seed(uint64_t llSeed);     //重新设置种子
+    uint64_t getSeed() const { return m_llSeed; }
+
+    //下一个 64 位随机数
+    uint64_t next() {
+        uint64_t llResult = rotl(m_llState[1] * 5, 7) * 9;
+        uint64_t llTemp = m_llState[1] << 17;
+        m_llState[2] ^= m_llState[0];
+        m_llState[3] ^= m_llState[1];
+        m_llState[1] ^= m_llState[2];
+        m_llState[0] ^= m_llState[3];
+        m_llState[2] ^= llTemp;
+        m_llState[3] = rotl(m_llState[3], 45);
+        return llResult;
+    }
+
+    //[0, dwBound) 内均匀分布的整数，dwBound 必须大于 0
+    uint32_t nextBounded(uint32_t dwBound) {
+        uint64_t llProduct = (next() >> 32) * dwBound;
+        uint32_t dwLow = static_cast<uint32_t>(llProduct);
+        if (dwLow < dwBound) {
+            uint32_t dwThreshold = static_cast<uint32_t>(-dwBound) % dwBound;
+            while (dwLow < dwThreshold) {
+                llProduct = (next() >> 32) * dwBound;
+                dwLow = static_cast<uint32_t>(llProduct);
+            }
+        }
+        return static_cast<uint32_t>(llProduct >> 32);
+    }
+
+    static uint64_t splitMix64(uint64_t &llState);  //种子展开
+    static uint64_t makeSeed();                     //从系统的密码学随机源取种子
+
+private:
+    static uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    uint64_t m_llState[4];
+    uint64_t m_llSeed;
+};
+
+#endif //COCOSTUDIO_MAHJONG_GAMERANDOM_H
@@ -0,0 +1,297 @@
+//
+// GameRecord.cpp
+// 牌局记录与回放
+//
+
+#include "GameRecord.h"
+#include "RecordWriter.h"
+
+#include <cstring>
+
+namespace {
+
+const uint32_t kFnvOffset = 2166136261U;
+const uint32_t kFnvPrime = 16777619U;
+
+void mixBytes(uint32_t &dwHash, const void *pData, size_t cbSize) {
+    const uint8_t *pBytes = static_cast<const uint8_t *>(pData);
+    for (size_t n = 0; n < cbSize; n++) {
+        dwHash = (dwHash ^ pBytes[n]) * kFnvPrime;
+    }
+}
+
+//整数字段（没有填充字节）
+template <typename T>
+void mixValue(uint32_t &dwHash, T Value) {
+    mixBytes(dwHash, &Value, sizeof(Value));
+}
+
+void mixWeave(uint32_t &dwHash, const CMD_WeaveItem &WeaveItem) {
+    mixValue(dwHash, WeaveItem.cbWeaveKind);
+    mixValue(dwHash, WeaveItem.cbCenterCard);
+    mixValue(dwHash, WeaveItem.cbPublicCard);
+    mixValue(dwHash, WeaveItem.cbProvideUser);
+    mixValue(dwHash, WeaveItem.cbValid);
+}
+
+void mixEvent(uint32_t &dwHash, const tagGameEvent &Event) {
+    mixValue(dwHash, Event.cbKind);
+    mixValue(dwHash, Event.cbChairID);
+    switch (Event.cbKind) {
+        case GameEvent_GameStart: {
+            const CMD_S_GameStart &GameStart = Event.GameStart;
+            mixValue(dwHash, GameStart.iDiceCount);
+            mixValue(dwHash, GameStart.cbBankerUser);
+            mixValue(dwHash, GameStart.cbCurrentUser);
+            mixBytes(dwHash, GameStart.cbCardData, sizeof(GameStart.cbCardData));
+            mixValue(dwHash, GameStart.cbLeftCardCount);
+            break;
+        }
+        case GameEvent_SendCard: {
+            const CMD_S_SendCard &SendCard = Event.SendCard;
+            mixValue(dwHash, SendCard.cbCardData);
+            mixValue(dwHash, SendCard.cbActionMask);
+            mixValue(dwHash, SendCard.cbCurrentUser);
+            mixValue(dwHash, SendCard.cbGangCount);
+            mixBytes(dwHash, SendCard.cbGangCard, sizeof(SendCard.cbGangCard));
+            mixValue(dwHash, static_cast<uint8_t>(SendCard.bTail));
+            break;
+        }
+        case GameEvent_OutCard:
+            mixValue(dwHash, Event.OutCard.cbOutCardUser);
+            mixValue(dwHash, Event.OutCard.cbOutCardData);
+            break;
+        case GameEvent_OperateNotify: {
+            const CMD_S_OperateNotify &OperateNotify = Event.OperateNotify;
+            mixValue(dwHash, OperateNotify.cbResumeUser);
+            mixValue(dwHash, OperateNotify.cbActionMask);
+            mixValue(dwHash, OperateNotify.cbActionCard);
+            mixValue(dwHash, OperateNotify.cbGangCount);
+            mixBytes(dwHash, OperateNotify.cbGangCard, sizeof(OperateNotify.cbGangCard));
+            break;
+        }
+        case GameEvent_OperateResult:
+            mixValue(dwHash, Event.OperateResult.cbOperateUser);
+            mixValue(dwHash, Event.OperateResult.cbProvideUser);
+            mixValue(dwHash, Event.OperateResult.cbOperateCode);
+            mixValue(dwHash, Event.OperateResult.cbOperateCard);
+            break;
+        case GameEvent_GameEnd: {
+            const CMD_S_GameEnd &GameEnd = Event.GameEnd;
+            mixBytes(dwHash, GameEnd.cbCardCount, sizeof(GameEnd.cbCardCount));
+            mixBytes(dwHash, GameEnd.cbCardData, sizeof(GameEnd.cbCardData));
+            mixValue(dwHash, GameEnd.cbHuUser);
+            mixValue(dwHash, GameEnd.cbProvideUser);
+            mixValue(dwHash, GameEnd.cbHuCard);
+            for (int i = 0; i < GAME_PLAYER; i++) {
+                mixValue(dwHash, GameEnd.dwHuRight[i]);
+                mixValue(dwHash, GameEnd.cbHuKind[i]);
+                mixValue(dwHash, GameEnd.cbHuSpecial[i]);
+                mixValue(dwHash, GameEnd.cbWeaveCount[i]);
+                for (int j = 0; j < MAX_WEAVE; j++) mixWeave(dwHash, GameEnd.WeaveItemArray[i][j]);
+                mixValue(dwHash, GameEnd.lMaGameScore[i]);
+                mixValue(dwHash, GameEnd.lNormalGameScore[i]);
+                mixValue(dwHash, GameEnd.lGameScore[i]);
+                mixValue(dwHash, GameEnd.lGameScoreTable[i]);
+            }
+            mixBytes(dwHash, GameEnd.cbMaCard, sizeof(GameEnd.cbMaCard));
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+uint64_t unixMicros() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+} // namespace
+
+GameRecorder::GameRecorder() : m_pWriter(NULL), m_bRecording(false), m_llSegments(0) {
+    memset(&m_Segment.Header, 0, sizeof(m_Segment.Header));
+}
+
+GameRecorder::~GameRecorder() {
+    flush();
+}
+
+/**
+ * 绑定写入器和房间号
+ * @param pWriter
+ * @param roomId
+ */
+void GameRecorder::bind(RecordWriter *pWriter, const std::string &roomId) {
+    m_pWriter = pWriter;
+    memset(m_Segment.Header.szRoomId, 0, sizeof(m_Segment.Header.szRoomId));
+    memcpy(m_Segment.Header.szRoomId, roomId.data(), roomId.size() < RECORD_ROOM_ID_LEN ? roomId.size() : RECORD_ROOM_ID_LEN - 1);
+}
+
+/**
+ * 记录一条命令
+ * @param Command
+ * @param cbChairID
+ * @param State
+ * @param Events
+ * @param cbFirstEvent
+ */
+void GameRecorder::onCommandApplied(const tagGameCommand &Command, uint8_t cbChairID, const tagGameState &State, const GameEventBuffer &Events, uint8_t cbFirstEvent) {
+    tagRecordHeader &Header = m_Segment.Header;
+    if (Command.cbKind == GameCommand_Start) {
+        if (m_bRecording) write();          //上一局没有结束（中途重新开局）
+        m_StartTime = std::chrono::steady_clock::now();
+        Header.dwMagic = RECORD_MAGIC;
+        Header.wVersion = RECORD_VERSION;
+        Header.wEntryCount = 0;
+        Header.llGameSeed = State.llGameSeed;
+        Header.llStartTime = unixMicros();
+        Header.dwStartHash = GameRecord::hashEvents(Events, cbFirstEvent);
+        Header.cbBankerUser = cbChairID;
+        Header.cbPlayerCount = Command.Start.cbPlayerCount;
+        Header.cbAndroidMask = Command.Start.cbAndroidMask;
+        Header.cbFlags = 0;
+        m_bRecording = true;
+    } else {
+        if (!m_bRecording) return;          //开局之前的命令不记录
+        if (Header.wEntryCount < RECORD_MAX_ENTRIES) {
+            recordEntry(m_Segment.Entries[Header.wEntryCount++], Command, cbChairID, Events, cbFirstEvent);
+        } else {
+            Header.cbFlags |= RecordFlag_Truncated;
+        }
+    }
+    for (uint8_t n = cbFirstEvent; n < Events.size(); n++) {
+        if (Events[n].cbKind == GameEvent_GameEnd) {
+            Header.cbFlags |= RecordFlag_Ended;
+            write();
+            break;
+        }
+    }
+}
+
+void GameRecorder::recordEntry(tagRecordEntry &Entry, const tagGameCommand &Command, uint8_t cbChairID, const GameEventBuffer &Events, uint8_t cbFirstEvent) {
+    Entry.cbKind = Command.cbKind;
+    Entry.cbChairID = cbChairID;
+    Entry.cbOperateCode = 0;
+    Entry.cbCardData = 0;
+    if (Command.cbKind == GameCommand_OutCard) {
+        Entry.cbCardData = Command.OutCard.cbCardData;
+    } else if (Command.cbKind == GameCommand_OperateCard) {
+        Entry.cbChairID = Command.OperateCard.cbOperateUser;
+        Entry.cbOperateCode = Command.OperateCard.cbOperateCode;
+        Entry.cbCardData = Command.OperateCard.cbOperateCard;
+    } else if (Command.cbKind == GameCommand_Conclude) {
+        Entry.cbChairID = Command.cbConcludeUser;
+    }
+    Entry.dwTime = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - m_StartTime).count());
+    Entry.dwEventHash = GameRecord::hashEvents(Events, cbFirstEvent);
+}
+
+/**
+ * 写出未结束的一局
+ */
+void GameRecorder::flush() {
+    if (m_bRecording) write();
+}
+
+void GameRecorder::write() {
+    m_bRecording = false;
+    m_llSegments++;
+    if (m_pWriter != NULL) {
+        m_pWriter->write(&m_Segment, sizeof(tagRecordHeader) + m_Segment.Header.wEntryCount * sizeof(tagRecordEntry));
+    }
+}
+
+/**
+ * 事件的哈希
+ * @param Events
+ * @param cbFirst
+ * @return
+ */
+uint32_t GameRecord::hashEvents(const GameEventBuffer &Events, uint8_t cbFirst) {
+    uint32_t dwHash = kFnvOffset;
+    for (uint8_t n = cbFirst; n < Events.size(); n++) {
+        mixEvent(dwHash, Events[n]);
+    }
+    return dwHash;
+}
+
+/**
+ * 读出下一段
+ * @param pData
+ * @param cbSize
+ * @param Offset
+ * @param pHeader
+ * @param pEntries
+ * @return
+ */
+bool GameRecord::nextSegment(const uint8_t *pData, size_t cbSize, size_t &Offset, const tagRecordHeader *&pHeader, const tagRecordEntry *&pEntries) {
+    if (Offset + sizeof(tagRecordHeader) > cbSize) return false;
+    const tagRecordHeader *pNext = reinterpret_cast<const tagRecordHeader *>(pData + Offset);
+    if (pNext->dwMagic != RECORD_MAGIC || pNext->wVersion != RECORD_VERSION || pNext->wEntryCount > RECORD_MAX_ENTRIES) return false;
+    size_t cbSegment = sizeof(tagRecordHeader) + pNext->wEntryCount * sizeof(tagRecordEntry);
+    if (Offset + cbSegment > cbSize) return false;      //最后一段没有写完整
+    pHeader = pNext;
+    pEntries = reinterpret_cast<const tagRecordEntry *>(pData + Offset + sizeof(tagRecordHeader));
+    Offset += cbSegment;
+    return true;
+}
+
+tagGameCommand GameRecord::makeStart(const tagRecordHeader &Header) {
+    return tagGameCommand::makeStart(Header.cbPlayerCount, Header.cbAndroidMask);
+}
+
+tagGameCommand GameRecord::makeCommand(const tagRecordEntry &Entry) {
+    switch (Entry.cbKind) {
+        case GameCommand_OutCard:
+            return tagGameCommand::makeOutCard(Entry.cbCardData);
+        case GameCommand_OperateCard:
+            return tagGameCommand::makeOperateCard(Entry.cbChairID, Entry.cbOperateCode, Entry.cbCardData);
+        default:
+            return tagGameCommand::makeConclude(Entry.cbChairID);
+    }
+}
+
+/**
+ * 开局前的准备
+ * @param Engine
+ * @param Header
+ */
+void GameRecord::prepare(GameEngine &Engine, const tagRecordHeader &Header) {
+    Engine.setBankerUser(Header.cbBankerUser);
+    Engine.setGameSeed(Header.llGameSeed);
+}
+
+/**
+ * 回放一局
+ * @param Engine
+ * @param Header
+ * @param pEntries
+ * @param Result
+ * @return
+ */
+bool GameRecord::replay(GameEngine &Engine, const tagRecordHeader &Header, const tagRecordEntry *pEntries, tagReplayResult &Result) {
+    Result.bMatch = false;
+    Result.iMismatch = -1;
+    Result.dwCommands = 1;
+    Result.bGameEnd = false;
+    prepare(Engine, Header);
+    GameEventBuffer Events;
+    Engine.apply(makeStart(Header), Events);
+    if (hashEvents(Events, 0) != Header.dwStartHash) return false;
+    for (uint16_t n = 0; n < Header.wEntryCount; n++) {
+        Result.iMismatch = n;
+        Result.dwCommands++;
+        Events.clear();
+        Engine.apply(makeCommand(pEntries[n]), Events);
+        if (hashEvents(Events, 0) != pEntries[n].dwEventHash) return false;
+        for (uint8_t e = 0; e < Events.size(); e++) {
+            if (Events[e].cbKind == GameEvent_GameEnd) Result.bGameEnd = true;
+        }
+    }
+    Result.iMismatch = Header.wEntryCount;
+    //截断的一局只核对记录到的命令
+    Result.bMatch = (Header.cbFlags & RecordFlag_Truncated) != 0 || Result.bGameEnd == ((Header.cbFlags & RecordFlag_Ended) != 0);
+    return Result.bMatch;
+}
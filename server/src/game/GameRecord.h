@@ -0,0 +1,144 @@
+//
+// GameRecord.h
+// 牌局记录与回放：每局记录本局种子和按顺序执行的命令，回放时逐条核对产生的事件
+//
+
+#ifndef COCOSTUDIO_MAHJONG_GAMERECORD_H
+#define COCOSTUDIO_MAHJONG_GAMERECORD_H
+
+#include "GameEngine.h"
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+class RecordWriter;
+
+#define RECORD_MAGIC                 0x444D4A4DU                       //"MJMD"
+#define RECORD_VERSION               1                                 //格式版本
+#define RECORD_ROOM_ID_LEN           32                                //房间号最多保存的字节数（含结尾 0）
+#define RECORD_MAX_ENTRIES           1024                              //一局最多记录的命令数，超出后截断
+
+enum RecordFlag {
+    RecordFlag_Ended = 0x01,         //以 GameEnd 结束
+    RecordFlag_Truncated = 0x02,     //命令超过 RECORD_MAX_ENTRIES，后面的没有记录
+};
+
+//段头：一局一个，64 字节
+struct tagRecordHeader {
+    uint32_t dwMagic;                           //RECORD_MAGIC
+    uint16_t wVersion;                          //RECORD_VERSION
+    uint16_t wEntryCount;                       //命令条数
+    uint64_t llGameSeed;                        //本局种子
+    uint64_t llStartTime;                       //开局时间（Unix 时间，微秒）
+    uint32_t dwStartHash;                       //开始命令产生的事件的哈希
+    uint8_t cbBankerUser;                       //开局前的庄家，INVALID_CHAIR 为由骰子决定
+    uint8_t cbPlayerCount;                      //座位数
+    uint8_t cbAndroidMask;                      //机器人座位掩码
+    uint8_t cbFlags;                            //RecordFlag
+    char szRoomId[RECORD_ROOM_ID_LEN];          //房间号（截断，以 0 结尾）
+};
+
+//命令：一条 12 字节
+struct tagRecordEntry {
+    uint8_t cbKind;                             //命令类型 GameCommandKind（不含开始）
+    uint8_t cbChairID;                          //出牌为当时的当前玩家，操作为操作玩家，结束为结束的座位
+    uint8_t cbOperateCode;                      //操作代码（出牌为 0）
+    uint8_t cbCardData;                         //出牌、操作的牌
+    uint32_t dwTime;                            //距开局的毫秒数
+    uint32_t dwEventHash;                       //这条命令产生的事件的哈希
+};
+
+//一局的记录：段头后面紧跟命令，写文件时只写前 wEntryCount 条
+struct tagRecordSegment {
+    tagRecordHeader Header;
+    tagRecordEntry Entries[RECORD_MAX_ENTRIES];
+};
+
+static_assert(sizeof(tagRecordHeader) == 64, "tagRecordHeader 布局改变");
+static_assert(sizeof(tagRecordEntry) == 12, "tagRecordEntry 布局改变");
+static_assert(offsetof(tagRecordSegment, Entries) == sizeof(tagRecordHeader), "段头和命令之间不能有填充");
+
+//回放一局的结果
+struct tagReplayResult {
+    bool bMatch;                                //全部事件一致
+    int32_t iMismatch;                          //第一条不一致的命令，-1 为开始命令，一致时为命令条数
+    uint32_t dwCommands;                        //执行的命令数（含开始）
+    bool bGameEnd;                              //回放产生了 GameEnd
+};
+
+class GameRecorder : public IGameCommandListener {
+public:
+    GameRecorder();
+    ~GameRecorder();                            //写出未结束的一局
+
+    /**
+     * 绑定写入器和房间号，之后开局的牌局写到 pWriter（NULL 为只记录不写出）
+     * @param pWriter
+     * @param roomId
+     */
+    void bind(RecordWriter *pWriter, const std::string &roomId);
+
+    //记录一条命令（GameEngine::apply 的末尾调用，也可以由房间转发）
+    void onCommandApplied(const tagGameCommand &Command, uint8_t cbChairID, const tagGameState &State, const GameEventBuffer &Events, uint8_t cbFirstEvent) override;
+
+    void flush();                               //写出未结束的一局（房间放弃本局、回收时调用）
+
+    const tagRecordSegment &getSegment() const { return m_Segment; }     //当前（或刚写出的）一局
+    bool isRecording() const { return m_bRecording; }                   //有一局尚未写出
+    uint64_t getSegmentCount() const { return m_llSegments; }           //写出的段数（累计）
+
+private:
+    void recordEntry(tagRecordEntry &Entry, const tagGameCommand &Command, uint8_t cbChairID, const GameEventBuffer &Events, uint8_t cbFirstEvent);
+    void write();
+
+    tagRecordSegment m_Segment;
+    std::chrono::steady_clock::time_point m_StartTime;
+    RecordWriter *m_pWriter;
+    bool m_bRecording;
+    uint64_t m_llSegments;
+};
+
+class GameRecord {
+public:
+    /**
+     * 事件的哈希（FNV-1a，逐字段，不含结构体的填充字节）
+     * @param Events
+     * @param cbFirst 从这条事件开始
+     * @return
+     */
+    static uint32_t hashEvents(const GameEventBuffer &Events, uint8_t cbFirst);
+
+    /**
+     * 从内存中的记录文件读出下一段
+     * @param pData
+     * @param cbSize
+     * @param Offset 输入、输出，当前位置
+     * @param pHeader 输出，指向 pData 内部
+     * @param pEntries 输出，指向 pData 内部
+     * @return 没有更多完整的段，或者段头无效时返回 false
+     */
+    static bool nextSegment(const uint8_t *pData, size_t cbSize, size_t &Offset, const tagRecordHeader *&pHeader, const tagRecordEntry *&pEntries);
+
+    static tagGameCommand makeStart(const tagRecordHeader &Header);       //段头对应的开始命令
+    static tagGameCommand makeCommand(const tagRecordEntry &Entry);       //记录对应的命令
+
+    /**
+     * 开局前的准备：按段头设置本局种子和开局前的庄家
+     * @param Engine 回放用的引擎（不需要入座玩家，不能设置命令监听）
+     * @param Header
+     */
+    static void prepare(GameEngine &Engine, const tagRecordHeader &Header);
+
+    /**
+     * 回放一局，逐条比较事件的哈希，遇到第一条不一致的命令即停止
+     * @param Engine
+     * @param Header
+     * @param pEntries
+     * @param Result 输出
+     * @return 全部一致
+     */
+    static bool replay(GameEngine &Engine, const tagRecordHeader &Header, const tagRecordEntry *pEntries, tagReplayResult &Result);
+};
+
+#endif //COCOSTUDIO_MAHJONG_GAMERECORD_H
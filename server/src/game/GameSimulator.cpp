@@ -0,0 +1,157 @@
+//
+// GameSimulator.cpp
+// 无界面的并行牌局模拟
+//
+
+#include "GameSimulator.h"
+#include "BotPlayer.h"
+#include "GameEngine.h"
+#include "AlignedAlloc.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+//一个线程的牌桌：引擎和四个机器人，批与批之间复用
+struct SimulateTable {
+    GameEngine engine;
+    BotPlayer bots[GAME_PLAYER];
+
+    //内嵌引擎按缓存行对齐，new SimulateTable 同样按对齐分配（见 AlignedAlloc.h）
+    static void *operator new(std::size_t size) { return alignedAllocate(size, alignof(SimulateTable)); }
+    static void operator delete(void *p) { alignedRelease(p); }
+};
+
+void countGameEnd(const CMD_S_GameEnd &GameEnd, tagSimulateStats &Stats) {
+    int64_t lScore = 0;
+    uint8_t cbWinners = 0;
+    for (uint8_t i = 0; i < GAME_PLAYER; i++) {
+        lScore += GameEnd.lGameScore[i];
+        if ((GameEnd.cbHuUser & (1 << i)) == 0 || GameEnd.dwHuRight[i] == 0) continue;
+        cbWinners++;
+        for (uint8_t n = 0; n < SIMULATE_HU_RIGHT; n++) {
+            if ((GameEnd.dwHuRight[i] & (1ULL << n)) != 0) Stats.llHuRight[n]++;
+        }
+        for (uint8_t n = 0; n < SIMULATE_HU_KIND; n++) {
+            if ((GameEnd.cbHuKind[i] & (1 << n)) != 0) Stats.llHuKind[n]++;
+        }
+    }
+    if (cbWinners == 0) {
+        Stats.llDrawHands++;
+    } else {
+        Stats.llHuHands++;
+        Stats.llWinners += cbWinners;
+        if (cbWinners > 1) Stats.llMultiHu++;
+    }
+    if (lScore != 0) Stats.llScoreMismatch++;
+}
+
+//执行一条命令并分发事件，遇到终局时统计
+bool applyCommand(SimulateTable &Table, const tagGameCommand &Command, tagSimulateStats &Stats) {
+    GameEventBuffer Events;
+    Table.engine.apply(Command, Events);
+    Table.engine.dispatchEvents(Events);
+    Stats.llCommands++;
+    for (uint8_t n = 0; n < Events.size(); n++) {
+        if (Events[n].cbKind != GameEvent_GameEnd) continue;
+        countGameEnd(Events[n].GameEnd, Stats);
+        return true;
+    }
+    return false;
+}
+
+//打完一局：按座位顺序取机器人的命令
+void playHand(SimulateTable &Table, tagSimulateStats &Stats) {
+    for (int iStep = 0; iStep < SIMULATE_MAX_STEPS; iStep++) {
+        tagGameCommand Command;
+        bool bTaken = false;
+        for (uint8_t i = 0; i < GAME_PLAYER && !bTaken; i++) {
+            bTaken = Table.bots[i].takeCommand(Command);
+        }
+        if (!bTaken) break;
+        if (applyCommand(Table, Command, Stats)) {
+            Stats.llHands++;
+            return;
+        }
+    }
+    Stats.llStalled++;
+}
+
+//一批：重置引擎、指定房间种子、机器人入座（入满自动开局），之后每局重新开始
+void playBatch(SimulateTable &Table, uint64_t llRoomSeed, uint64_t llHands, tagSimulateStats &Stats) {
+    Table.engine.reset();
+    Table.engine.setRoomSeed(llRoomSeed);
+    for (uint8_t i = 0; i < GAME_PLAYER; i++) Table.engine.onUserEnter(&Table.bots[i]);
+    for (uint64_t h = 0; h < llHands; h++) {
+        if (h > 0) applyCommand(Table, tagGameCommand::makeStart(GAME_PLAYER, 0x0F), Stats);
+        playHand(Table, Stats);
+    }
+}
+
+} // namespace
+
+void tagSimulateStats::clear() {
+    memset(this, 0, sizeof(*this));
+}
+
+void tagSimulateStats::merge(const tagSimulateStats &Stats) {
+    llHands += Stats.llHands;
+    llHuHands += Stats.llHuHands;
+    llDrawHands += Stats.llDrawHands;
+    llMultiHu += Stats.llMultiHu;
+    llWinners += Stats.llWinners;
+    for (int n = 0; n < SIMULATE_HU_RIGHT; n++) llHuRight[n] += Stats.llHuRight[n];
+    for (int n = 0; n < SIMULATE_HU_KIND; n++) llHuKind[n] += Stats.llHuKind[n];
+    llCommands += Stats.llCommands;
+    llStalled += Stats.llStalled;
+    llScoreMismatch += Stats.llScoreMismatch;
+}
+
+bool tagSimulateStats::sameResult(const tagSimulateStats &Stats) const {
+    tagSimulateStats Left = *this, Right = Stats;
+    Left.dElapsed = 0;
+    Right.dElapsed = 0;
+    return memcmp(&Left, &Right, sizeof(Left)) == 0;
+}
+
+uint64_t GameSimulator::batchSeed(uint64_t llSeed, uint64_t llBatch) {
+    uint64_t llState = llSeed ^ (llBatch * 0x9E3779B97F4A7C15ULL);
+    return GameRandom::splitMix64(llState);
+}
+
+void GameSimulator::run(const tagSimulateConfig &Config, tagSimulateStats &Stats) {
+    Stats.clear();
+    uint64_t llBatchHands = Config.dwBatchHands > 0 ? Config.dwBatchHands : SIMULATE_BATCH_HANDS;
+    uint64_t llBatches = (Config.llHands + llBatchHands - 1) / llBatchHands;
+    uint32_t dwThreads = Config.dwThreads > 0 ? Config.dwThreads : std::thread::hardware_concurrency();
+    if (dwThreads == 0) dwThreads = 1;
+    if (dwThreads > llBatches) dwThreads = static_cast<uint32_t>(llBatches > 0 ? llBatches : 1);
+
+    std::atomic<uint64_t> llNextBatch(0);
+    std::mutex mutex;
+    auto worker = [&]() {
+        SimulateTable *pTable = new SimulateTable();
+        tagSimulateStats Local;
+        Local.clear();
+        for (uint64_t b = llNextBatch++; b < llBatches; b = llNextBatch++) {
+            uint64_t llHands = llBatchHands;
+            if (b == llBatches - 1) llHands = Config.llHands - b * llBatchHands;    //最后一批可能不满
+            playBatch(*pTable, batchSeed(Config.llSeed, b), llHands, Local);
+        }
+        delete pTable;
+        std::lock_guard<std::mutex> lock(mutex);
+        Stats.merge(Local);
+    };
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (uint32_t t = 1; t < dwThreads; t++) threads.push_back(std::thread(worker));
+    worker();       //当前线程也参与
+    for (size_t t = 0; t < threads.size(); t++) threads[t].join();
+    Stats.dElapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
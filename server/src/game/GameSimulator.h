@@ -0,0 +1,59 @@
+//
+// GameSimulator.h
+// 无界面的并行牌局模拟：每个线程一个引擎和四个 BotPlayer，打完整局并统计结果
+//
+
+#ifndef COCOSTUDIO_MAHJONG_GAMESIMULATOR_H
+#define COCOSTUDIO_MAHJONG_GAMESIMULATOR_H
+
+#include <cstdint>
+
+#define SIMULATE_BATCH_HANDS         256                               //每批（每个房间）的局数
+#define SIMULATE_MAX_STEPS           1000                              //每局最多的命令数
+#define SIMULATE_HU_RIGHT            7                                 //统计的胡牌类型数（CHR_PH 到 CHR_TH）
+#define SIMULATE_HU_KIND             4                                 //统计的胡牌方式数（CHK_ZM 到 CHK_GK）
+
+struct tagSimulateConfig {
+    uint64_t llHands;                           //总局数
+    uint64_t llSeed;                            //种子，相同种子得到相同的统计
+    uint32_t dwThreads;                         //线程数，0 为 CPU 核数
+    uint32_t dwBatchHands;                      //每批的局数，0 为 SIMULATE_BATCH_HANDS
+};
+
+struct tagSimulateStats {
+    uint64_t llHands;                           //打完的局数
+    uint64_t llHuHands;                         //有人胡牌的局数
+    uint64_t llDrawHands;                       //流局
+    uint64_t llMultiHu;                         //一炮多响
+    uint64_t llWinners;                         //胡牌人次
+    uint64_t llHuRight[SIMULATE_HU_RIGHT];      //各胡牌类型的人次，第 i 项为 1 << i
+    uint64_t llHuKind[SIMULATE_HU_KIND];        //各胡牌方式的人次，第 i 项为 1 << i
+    uint64_t llCommands;                        //执行的命令数
+    uint64_t llStalled;                         //超过步数上限仍未结束的局数
+    uint64_t llScoreMismatch;                   //积分总和不为 0 的局数
+    double dElapsed;                            //耗时（秒）
+
+    void clear();
+    void merge(const tagSimulateStats &Stats);  //累加（不含耗时）
+    bool sameResult(const tagSimulateStats &Stats) const;   //除耗时外全部相同
+};
+
+class GameSimulator {
+public:
+    /**
+     * 按配置打完全部局数
+     * @param Config
+     * @param Stats 输出
+     */
+    static void run(const tagSimulateConfig &Config, tagSimulateStats &Stats);
+
+    /**
+     * 第 llBatch 批的房间种子
+     * @param llSeed
+     * @param llBatch
+     * @return
+     */
+    static uint64_t batchSeed(uint64_t llSeed, uint64_t llBatch);
+};
+
+#endif //COCOSTUDIO_MAHJONG_GAMESIMULATOR_H
@@ -0,0 +1,67 @@
+//
+// GameState.h
+// 一局牌的全部状态：POD、按缓存行对齐、不含指针，快照和恢复都是一次 memcpy
+//
+
+#ifndef COCOSTUDIO_MAHJONG_GAMESTATE_H
+#define COCOSTUDIO_MAHJONG_GAMESTATE_H
+
+#include "GameCmd.h"
+#include "GameLogic.h"
+
+#include <cstddef>
+#include <type_traits>
+
+#define GAME_STATE_VERSION           2                                 //状态布局版本
+
+struct alignas(64) tagGameState {
+    //第一条缓存行：响应判定和牌局进度
+    uint8_t cbUserAction[GAME_PLAYER];          //用户动作，可能包含多个动作
+    uint8_t cbPerformAction[GAME_PLAYER];       //执行动作，只会包含一个动作
+    uint8_t cbTempUserAction[GAME_PLAYER];      //暂存上一次的动作情况，用来恢复自摸点“过”的情况。
+    uint8_t cbOperateCard[GAME_PLAYER];         //操作扑克
+    uint8_t cbFanShu[GAME_PLAYER];              //上一圈番数，用来判定没过手不能胡第二家
+    uint8_t cbHuKind[GAME_PLAYER];              //胡牌类型
+    uint8_t cbHuSpecial[GAME_PLAYER];           //胡牌一些特殊情况
+    bool bResponse[GAME_PLAYER];                //响应标志
+    uint8_t cbCurrentUser;                      //当前操作的玩家
+    uint8_t cbProvideUser;                      //供应的玩家
+    uint8_t cbProvideCard;                      //当前供应的牌
+    uint8_t cbResumeUser;                       //暂存玩家，用于碰、杠后恢复
+    uint8_t cbOutCardUser;                      //出牌玩家
+    uint8_t cbOutCardData;                      //出牌数据
+    uint8_t cbSendCardData;                     //发牌扑克
+    uint8_t cbSendCardCount;                    //发牌数目
+    uint8_t cbOutCardCount;                     //出牌数目
+    uint8_t cbLeftCardCount;                    //剩余数目
+    uint8_t cbBankerUser;                       //庄家用户
+    uint8_t cbMa;                               //买马数量
+    uint8_t cbTargetUser;                       //胡牌玩家标识
+    uint8_t cbHuCard;                           //胡牌扑克
+    uint8_t cbGangCount;                        //当前可以杠的数量
+    bool bGangStatus;                           //杠上状态
+    bool bQiangGangStatus;                      //抢杆状态
+    uint8_t cbGangCard[MAX_WEAVE];              //可以杠的牌
+    uint8_t cbWeaveItemCount[GAME_PLAYER];      //组合数目
+    uint8_t cbDiscardCount[GAME_PLAYER];        //出牌数据
+    uint8_t cbPlayerCount;                      //本局座位数
+    uint8_t cbAndroidMask;                      //机器人座位掩码
+    //第二条缓存行：胡牌权重和分数
+    uint64_t llHuRight[GAME_PLAYER];            //胡牌权重
+    int64_t lGameScoreTable[GAME_PLAYER];       //记录总分
+    //手牌、碰牌检测、组合
+    uint8_t cbCardIndex[GAME_PLAYER][MAX_INDEX];        //用户扑克
+    bool cbPassPeng[GAME_PLAYER][MAX_INDEX];            //用来检测放弃碰
+    tagWeaveItem WeaveItemArray[GAME_PLAYER][MAX_WEAVE];//组合扑克
+    //出牌记录、牌墙、本局种子
+    uint8_t cbDiscardCard[GAME_PLAYER][MAX_DISCARD];    //丢弃记录
+    uint8_t cbRepertoryCard[MAX_REPERTORY];             //库存扑克
+    uint64_t llGameSeed;                                //本局种子
+    uint32_t iDiceCount;                                //骰子点数
+};
+
+static_assert(std::is_trivial<tagGameState>::value && std::is_standard_layout<tagGameState>::value, "tagGameState must be POD (memcpy snapshot)");
+static_assert(alignof(tagGameState) == 64 && sizeof(tagGameState) % 64 == 0, "tagGameState must fill whole cache lines");
+static_assert(offsetof(tagGameState, llHuRight) == 64 && offsetof(tagGameState, cbCardIndex) == 128, "hot fields must stay in the first two cache lines");
+
+#endif //COCOSTUDIO_MAHJONG_GAMESTATE_H
@@ -0,0 +1,357 @@
+//
+// HuTable.cpp
+// 查表法胡牌判定实现
+//
+
+#include "HuTable.h"
+
+#include <cstring>
+
+namespace {
+    const uint32_t kPower5[HuTable::SUIT_SIZE + 1] = {1, 5, 25, 125, 625, 3125, 15625, 78125, 390625, 1953125};
+}
+
+const HuTable &HuTable::instance() {
+    static const HuTable table;
+    return table;
+}
+
+HuTable::HuTable() {
+    generate(m_SuitTable, SUIT_SIZE, true);
+    generate(m_HonorTable, HONOR_SIZE, false);
+    for (uint16_t i = 0; i < 512; i++) {
+        uint8_t c0 = static_cast<uint8_t>(i & 7), c1 = static_cast<uint8_t>((i >> 3) & 7), c2 = static_cast<uint8_t>(i >> 6);
+        m_OctalTable[i] = static_cast<uint16_t>(((c0 + c1 + c2) << 8) | ((c0 + 5 * c1 + 25 * c2) & 0xFF));
+    }
+}
+
+/**
+ * 五进制键
+ * @param cbCardIndex
+ *  该门第一张牌的数量
+ * @param cbSize
+ *  该门牌的种数
+ * @return
+ */
+uint32_t HuTable::suitKey(const uint8_t *cbCardIndex, uint8_t cbSize) {
+    uint32_t key = 0;
+    for (uint8_t i = cbSize; i > 0; i--) {
+        key = key * 5 + cbCardIndex[i - 1];
+    }
+    return key;
+}
+
+/**
+ * 生成表：枚举所有不超过 4 个面子的组合，记录面子本身以及加一对将后的牌型
+ * @param Table
+ * @param cbSize
+ * @param bSequence
+ *  是否有顺子（字牌没有）
+ */
+void HuTable::generate(std::vector<uint8_t> &Table, uint8_t cbSize, bool bSequence) {
+    Table.assign(kPower5[cbSize], 0);
+    uint8_t cbCounts[SUIT_SIZE];
+    memset(cbCounts, 0, sizeof(cbCounts));
+    generateMelds(Table, cbCounts, cbSize, bSequence, 0, 0, false);
+}
+
+/**
+ * 递归枚举面子组合（面子种类不减，避免重复）：种类 [0, cbSize) 是刻子，[cbSize, cbSize + cbSize - 2) 是顺子
+ */
+void HuTable::generateMelds(std::vector<uint8_t> &Table, uint8_t *cbCounts, uint8_t cbSize, bool bSequence, uint8_t cbKind, uint8_t cbMeldCount, bool bHasSequence) {
+    markTable(Table, cbCounts, cbSize, bHasSequence);
+    if (cbMeldCount == MAX_WEAVE) return;
+    uint8_t cbKindCount = static_cast<uint8_t>(bSequence ? cbSize + cbSize - 2 : cbSize);
+    for (uint8_t k = cbKind; k < cbKindCount; k++) {
+        if (k < cbSize) {
+            if (cbCounts[k] + 3 > 4) continue;
+            cbCounts[k] += 3;
+            generateMelds(Table, cbCounts, cbSize, bSequence, k, static_cast<uint8_t>(cbMeldCount + 1), bHasSequence);
+            cbCounts[k] -= 3;
+        } else {
+            uint8_t i = static_cast<uint8_t>(k - cbSize);
+            if (cbCounts[i] == 4 || cbCounts[i + 1] == 4 || cbCounts[i + 2] == 4) continue;
+            cbCounts[i]++; cbCounts[i + 1]++; cbCounts[i + 2]++;
+            generateMelds(Table, cbCounts, cbSize, bSequence, k, static_cast<uint8_t>(cbMeldCount + 1), true);
+            cbCounts[i]--; cbCounts[i + 1]--; cbCounts[i + 2]--;
+        }
+    }
+}
+
+void HuTable::markTable(std::vector<uint8_t> &Table, uint8_t *cbCounts, uint8_t cbSize, bool bHasSequence) {
+    uint8_t cbFlag = static_cast<uint8_t>(MELD_OK | (bHasSequence ? MELD_SEQUENCE : MELD_TRIPLET));
+    Table[suitKey(cbCounts, cbSize)] |= cbFlag;
+    //加一对将
+    for (uint8_t i = 0; i < cbSize; i++) {
+        if (cbCounts[i] + 2 > 4) continue;
+        cbCounts[i] += 2;
+        Table[suitKey(cbCounts, cbSize)] |= static_cast<uint8_t>(cbFlag << EYE_SHIFT);
+        cbCounts[i] -= 2;
+    }
+}
+
+uint8_t HuTable::lookup(const uint8_t *cbCardIndex, uint8_t cbSize) const {
+    const std::vector<uint8_t> &Table = (cbSize == SUIT_SIZE) ? m_SuitTable : m_HonorTable;
+    return Table[suitKey(cbCardIndex, cbSize)];
+}
+
+/**
+ * 分析手牌
+ * @param cbCardIndex
+ * @return
+ */
+uint8_t HuTable::analyse(const uint8_t *cbCardIndex) const {
+    //先算各门的键和数量，数量不满足时不查表
+    uint32_t key[4];
+    uint8_t cbSum[4];
+    uint8_t cbInvalid = 0;
+    for (uint8_t g = 0; g < 4; g++) {
+        const uint8_t *pCount = cbCardIndex + g * SUIT_SIZE;
+        uint8_t cbSize = static_cast<uint8_t>(g < 3 ? SUIT_SIZE : HONOR_SIZE);
+        uint32_t k = 0;
+        uint8_t s = 0;
+        for (uint8_t i = cbSize; i > 0; i--) {
+            k = k * 5 + pCount[i - 1];
+            s = static_cast<uint8_t>(s + pCount[i - 1]);
+            cbInvalid |= static_cast<uint8_t>(pCount[i - 1] > 4);
+        }
+        key[g] = k;
+        cbSum[g] = s;
+    }
+    if (cbInvalid) return 0;
+    return analyseSuits(key, cbSum);
+}
+
+/**
+ * 分析位压缩手牌：每门的 27 位（字牌 21 位）由 suitEntry 直接查表，不展开成数组
+ * @param Hand
+ * @return
+ */
+uint8_t HuTable::analyse(const PackedHand &Hand) const {
+    if (Hand.hasOverflow()) return 0;
+    uint8_t cbEntry[4], cbSum[4];
+    for (uint8_t g = 0; g < 4; g++) {
+        cbEntry[g] = suitEntry(g, Hand.suitBits(g), cbSum[g]);
+    }
+    if (!checkSums(cbSum)) return 0;
+    return combine(cbEntry, cbSum);
+}
+
+/**
+ * 单门查表（位压缩）
+ * @param cbSuit
+ *  0 筒、1 万、2 条、3 字
+ * @param cbBits
+ *  PackedHand::suitBits
+ * @param cbSum
+ *  返回该门张数
+ * @return 表项
+ */
+uint8_t HuTable::suitEntry(uint8_t cbSuit, uint32_t cbBits, uint8_t &cbSum) const {
+    uint16_t e0 = m_OctalTable[cbBits & 511];
+    uint16_t e1 = m_OctalTable[(cbBits >> 9) & 511];
+    uint16_t e2 = m_OctalTable[cbBits >> 18];
+    uint32_t key = (e0 & 0xFF) + (e1 & 0xFF) * kPower5[3] + (e2 & 0xFF) * kPower5[6];
+    cbSum = static_cast<uint8_t>((e0 >> 8) + (e1 >> 8) + (e2 >> 8));
+    return (cbSuit < 3) ? m_SuitTable[key] : m_HonorTable[key];
+}
+
+/**
+ * 按各门的键和数量查表
+ * @param key
+ * @param cbSum
+ * @return
+ */
+uint8_t HuTable::analyseSuits(const uint32_t *key, const uint8_t *cbSum) const {
+    if (!checkSums(cbSum)) return 0;
+    uint8_t cbEntry[4];
+    for (uint8_t g = 0; g < 4; g++) {
+        cbEntry[g] = (g < 3) ? m_SuitTable[key[g]] : m_HonorTable[key[g]];
+    }
+    return combine(cbEntry, cbSum);
+}
+
+/**
+ * 各门张数：总数 3n+2，恰好一门余 2（带将），其余各门是 3 的倍数（四门各余 2 时总数也满足 3n+2）
+ * @param cbSum
+ * @return
+ */
+bool HuTable::checkSums(const uint8_t *cbSum) {
+    uint8_t cbTotal = static_cast<uint8_t>(cbSum[0] + cbSum[1] + cbSum[2] + cbSum[3]);
+    if ((cbTotal < 2) || (cbTotal > MAX_COUNT) || ((cbTotal - 2) % 3 != 0)) return false;
+    uint8_t cbEyeCount = 0;
+    for (uint8_t g = 0; g < 4; g++) {
+        uint8_t cbMod = static_cast<uint8_t>(cbSum[g] % 3);
+        if (cbMod == 1) return false;
+        if (cbMod == 2) cbEyeCount++;
+    }
+    return cbEyeCount == 1;
+}
+
+/**
+ * 合成整手结果（调用方已用 checkSums 校验张数）
+ * @param cbEntry
+ * @param cbSum
+ * @return
+ */
+uint8_t HuTable::combine(const uint8_t *cbEntry, const uint8_t *cbSum) {
+    bool bSequence = false, bTriplet = true;
+    for (uint8_t g = 0; g < 4; g++) {
+        if (cbSum[g] == 0) continue;
+        uint8_t cbFlag = cbEntry[g];
+        if (cbSum[g] % 3 == 2) cbFlag = static_cast<uint8_t>(cbFlag >> EYE_SHIFT);
+        if ((cbFlag & MELD_OK) == 0) return 0;
+        bSequence = bSequence || (cbFlag & MELD_SEQUENCE) != 0;
+        bTriplet = bTriplet && (cbFlag & MELD_TRIPLET) != 0;
+    }
+    return static_cast<uint8_t>(HU_COMPLETE | (bSequence ? HU_WITH_SEQUENCE : 0) | (bTriplet ? HU_ALL_TRIPLET : 0));
+}
+
+/**
+ * 单门拆法
+ * @param cbCardIndex
+ * @param cbBegin
+ * @param bNeedEye
+ * @param Decompose
+ * @return
+ */
+uint8_t HuTable::decomposeSuit(const uint8_t *cbCardIndex, uint8_t cbBegin, bool bNeedEye, tagSuitDecompose *Decompose) const {
+    uint8_t cbSize = static_cast<uint8_t>(cbBegin < 27 ? SUIT_SIZE : HONOR_SIZE);
+    uint8_t cbCounts[SUIT_SIZE];
+    memcpy(cbCounts, cbCardIndex + cbBegin, cbSize);
+    uint8_t cbEntry = lookup(cbCounts, cbSize);
+    if (bNeedEye) cbEntry = static_cast<uint8_t>(cbEntry >> EYE_SHIFT);
+    if ((cbEntry & MELD_OK) == 0) return 0;
+
+    tagSuitDecompose Current;
+    memset(&Current, 0, sizeof(Current));
+    uint8_t cbCount = 0;
+    decomposeFrom(cbCounts, cbBegin, cbSize, 0, bNeedEye, Current, Decompose, cbCount);
+    return cbCount;
+}
+
+/**
+ * 规范化递归：最小的一张牌必须在这一步用完（将、刻子、以它开头的顺子各选若干），
+ * 每条分支先查表确认剩余的牌还能拆完，因此不会走入死路，也不会产生重复的拆法
+ */
+void HuTable::decomposeFrom(uint8_t *cbCounts, uint8_t cbBegin, uint8_t cbSize, uint8_t cbPos, bool bNeedEye, tagSuitDecompose &Current, tagSuitDecompose *Decompose, uint8_t &cbCount) const {
+    while (cbPos < cbSize && cbCounts[cbPos] == 0) cbPos++;
+    if (cbPos == cbSize) {
+        if (!bNeedEye && cbCount < MAX_SUIT_DECOMPOSE) {
+            Decompose[cbCount++] = Current;
+        }
+        return;
+    }
+    uint8_t cbCard = cbCounts[cbPos];
+    for (uint8_t cbEye = 0; cbEye <= (bNeedEye ? 1 : 0); cbEye++) {
+        for (uint8_t cbTriplet = 0; cbTriplet <= 1; cbTriplet++) {
+            int iRest = cbCard - 2 * cbEye - 3 * cbTriplet;
+            if (iRest < 0) continue;
+            uint8_t cbSequence = static_cast<uint8_t>(iRest);
+            if (cbSequence > 0) {
+                if (cbSize != SUIT_SIZE || cbPos + 2 >= cbSize) continue;
+                if (cbCounts[cbPos + 1] < cbSequence || cbCounts[cbPos + 2] < cbSequence) continue;
+            }
+            if (Current.cbMeldCount + cbTriplet + cbSequence > MAX_WEAVE) continue;
+
+            //取出
+            cbCounts[cbPos] = 0;
+            if (cbSequence > 0) {
+                cbCounts[cbPos + 1] -= cbSequence;
+                cbCounts[cbPos + 2] -= cbSequence;
+            }
+            bool bRestEye = bNeedEye && cbEye == 0;
+            uint8_t cbEntry = lookup(cbCounts, cbSize);
+            if (bRestEye) cbEntry = static_cast<uint8_t>(cbEntry >> EYE_SHIFT);
+            if ((cbEntry & MELD_OK) != 0) {
+                uint8_t cbMeldCount = Current.cbMeldCount;
+                uint8_t cbCardData = StandardTileSet::switchToCardData(static_cast<uint8_t>(cbBegin + cbPos));
+                if (cbTriplet) {
+                    Current.cbWeaveKind[Current.cbMeldCount] = WIK_P;
+                    Current.cbCenterCard[Current.cbMeldCount++] = cbCardData;
+                }
+                for (uint8_t i = 0; i < cbSequence; i++) {
+                    Current.cbWeaveKind[Current.cbMeldCount] = WIK_S;
+                    Current.cbCenterCard[Current.cbMeldCount++] = static_cast<uint8_t>(cbCardData + 1);
+                }
+                if (cbEye) Current.cbCardEye = cbCardData;
+                decomposeFrom(cbCounts, cbBegin, cbSize, static_cast<uint8_t>(cbPos + 1), bRestEye, Current, Decompose, cbCount);
+                if (cbEye) Current.cbCardEye = 0;
+                Current.cbMeldCount = cbMeldCount;
+            }
+            //还原
+            cbCounts[cbPos] = cbCard;
+            if (cbSequence > 0) {
+                cbCounts[cbPos + 1] += cbSequence;
+                cbCounts[cbPos + 2] += cbSequence;
+            }
+        }
+    }
+}
+
+/**
+ * 列出所有拆法：各门的拆法做笛卡尔积，结果写入调用方的定长数组，够数或写满时停止
+ * @param cbCardIndex
+ * @param WeaveItem
+ * @param cbItemCount
+ * @param AnalyseItemArray
+ * @param maxCount
+ * @return
+ */
+size_t HuTable::decompose(const uint8_t *cbCardIndex, const tagWeaveItem *WeaveItem, uint8_t cbItemCount, CAnalyseItemArray &AnalyseItemArray, size_t maxCount) const {
+    if ((analyse(cbCardIndex) & HU_COMPLETE) == 0) return 0;
+
+    tagSuitDecompose Decompose[4][MAX_SUIT_DECOMPOSE];
+    uint8_t cbDecomposeCount[4];
+    for (uint8_t g = 0; g < 4; g++) {
+        uint8_t cbBegin = static_cast<uint8_t>(g * SUIT_SIZE);
+        uint8_t cbSize = static_cast<uint8_t>(g < 3 ? SUIT_SIZE : HONOR_SIZE);
+        uint8_t cbSum = 0;
+        for (uint8_t i = 0; i < cbSize; i++) {
+            cbSum += cbCardIndex[cbBegin + i];
+        }
+        if (cbSum == 0) {
+            memset(&Decompose[g][0], 0, sizeof(tagSuitDecompose));
+            cbDecomposeCount[g] = 1;
+            continue;
+        }
+        cbDecomposeCount[g] = decomposeSuit(cbCardIndex, cbBegin, cbSum % 3 == 2, Decompose[g]);
+    }
+
+    size_t count = 0;
+    uint8_t cbChoice[4] = {0, 0, 0, 0};
+    do {
+        tagAnalyseItem AnalyseItem;
+        memset(&AnalyseItem, 0, sizeof(AnalyseItem));
+        uint8_t cbWeaveCount = cbItemCount;
+        for (uint8_t i = 0; i < cbItemCount; i++) {
+            AnalyseItem.cbWeaveKind[i] = WeaveItem[i].cbWeaveKind;
+            AnalyseItem.cbCenterCard[i] = WeaveItem[i].cbCenterCard;
+        }
+        bool bValid = true;
+        for (uint8_t g = 0; g < 4 && bValid; g++) {
+            const tagSuitDecompose &Suit = Decompose[g][cbChoice[g]];
+            if (cbWeaveCount + Suit.cbMeldCount > MAX_WEAVE) {
+                bValid = false;
+                break;
+            }
+            for (uint8_t i = 0; i < Suit.cbMeldCount; i++) {
+                AnalyseItem.cbWeaveKind[cbWeaveCount] = Suit.cbWeaveKind[i];
+                AnalyseItem.cbCenterCard[cbWeaveCount++] = Suit.cbCenterCard[i];
+            }
+            if (Suit.cbCardEye != 0) AnalyseItem.cbCardEye = Suit.cbCardEye;
+        }
+        if (bValid) {
+            if (!AnalyseItemArray.push_back(AnalyseItem)) break;
+            if (++count >= maxCount) break;
+        }
+        //下一个组合
+        uint8_t g = 0;
+        for (; g < 4; g++) {
+            if (++cbChoice[g] < cbDecomposeCount[g]) break;
+            cbChoice[g] = 0;
+        }
+        if (g == 4) break;
+    } while (true);
+    return count;
+}
@@ -0,0 +1,103 @@
+//
+// HuTable.h
+// 查表法胡牌判定：按花色把 9 个（字牌 7 个）牌的数量编码成五进制键，查预先生成的表
+//
+
+#ifndef COCOSTUDIO_MAHJONG_HUTABLE_H
+#define COCOSTUDIO_MAHJONG_HUTABLE_H
+
+#include "GameCmd.h"
+#include "GameLogic.h"
+#include "PackedHand.h"
+
+#include <vector>
+
+//整手牌分析结果
+#define HU_COMPLETE         0x01        //能拆成 n 个面子加一对将
+#define HU_WITH_SEQUENCE    0x02        //存在含顺子的拆法
+#define HU_ALL_TRIPLET      0x04        //存在全刻子的拆法
+
+class HuTable {
+public:
+    static const uint8_t SUIT_SIZE = 9;             //序数牌每门 9 张
+    static const uint8_t HONOR_SIZE = 7;            //字牌 7 张
+    static const uint8_t MAX_SUIT_DECOMPOSE = 16;   //单门牌最多的拆法数（生成表时校验）
+
+    //单门拆法
+    struct tagSuitDecompose {
+        uint8_t cbMeldCount;                        //面子数量
+        uint8_t cbWeaveKind[MAX_WEAVE];             //面子类型（WIK_P / WIK_S）
+        uint8_t cbCenterCard[MAX_WEAVE];            //中心扑克
+        uint8_t cbCardEye;                          //牌眼（0 表示本门不带将）
+    };
+
+    static const HuTable &instance();               //第一次调用时生成表
+
+    /**
+     * 分析手牌（不含碰、杠组合）
+     * @param cbCardIndex 手牌，牌数需为 3n+2 且每种不超过 4 张，否则返回 0
+     * @return HU_COMPLETE | HU_WITH_SEQUENCE | HU_ALL_TRIPLET 的组合
+     */
+    uint8_t analyse(const uint8_t cbCardIndex[MAX_INDEX]) const;
+
+    uint8_t analyse(const PackedHand &Hand) const;  //位压缩手牌，结果同上
+
+    bool isComplete(const uint8_t cbCardIndex[MAX_INDEX]) const {
+        return (analyse(cbCardIndex) & HU_COMPLETE) != 0;
+    }
+
+    bool isComplete(const PackedHand &Hand) const {
+        return (analyse(Hand) & HU_COMPLETE) != 0;
+    }
+
+    /**
+     * 列出所有不同的拆法，组合在前、手牌面子在后，与 GameLogic::analyseCard 的结果格式一致
+     * @param maxCount 列出这么多种后停止（只需判断能否拆完时传 1）
+     * @return 拆法数量
+     */
+    size_t decompose(const uint8_t cbCardIndex[MAX_INDEX], const tagWeaveItem WeaveItem[], uint8_t cbItemCount, CAnalyseItemArray &AnalyseItemArray, size_t maxCount = MAX_ANALYSE_ITEM) const;
+
+    /**
+     * 单门拆法（cbBegin 为该门第一张的索引，bNeedEye 表示该门带将）
+     * @return 拆法数量，最多 MAX_SUIT_DECOMPOSE 个
+     */
+    uint8_t decomposeSuit(const uint8_t cbCardIndex[MAX_INDEX], uint8_t cbBegin, bool bNeedEye, tagSuitDecompose Decompose[MAX_SUIT_DECOMPOSE]) const;
+
+    //五进制键
+    static uint32_t suitKey(const uint8_t cbCardIndex[], uint8_t cbSize);
+
+    /**
+     * 单门查表（增量判定用：只有变化的那门需要重新查）
+     * @param cbSuit 0 筒、1 万、2 条、3 字
+     * @param cbBits PackedHand::suitBits(cbSuit)，每种不超过 4 张
+     * @param cbSum 返回该门张数
+     * @return 表项，交给 combine 合成
+     */
+    uint8_t suitEntry(uint8_t cbSuit, uint32_t cbBits, uint8_t &cbSum) const;
+
+    static bool checkSums(const uint8_t cbSum[4]);                          //各门张数能否组成 3n+2 的胡牌
+    static uint8_t combine(const uint8_t cbEntry[4], const uint8_t cbSum[4]);  //各门表项合成 HU_* 标记
+
+private:
+    //表项标记
+    static const uint8_t MELD_OK = 0x01;            //能全部拆成面子
+    static const uint8_t MELD_SEQUENCE = 0x02;      //存在含顺子的拆法
+    static const uint8_t MELD_TRIPLET = 0x04;       //存在全刻子的拆法
+    static const uint8_t EYE_SHIFT = 3;             //带将的标记左移 3 位
+
+    std::vector<uint8_t> m_SuitTable;               //序数牌表，5^9 项
+    std::vector<uint8_t> m_HonorTable;              //字牌表，5^7 项
+    uint16_t m_OctalTable[512];                     //位压缩的 3 种牌（9 位）-> 五进制键（低 8 位）和张数（高 8 位）
+
+    HuTable();
+
+    void generate(std::vector<uint8_t> &Table, uint8_t cbSize, bool bSequence);
+    void generateMelds(std::vector<uint8_t> &Table, uint8_t cbCounts[], uint8_t cbSize, bool bSequence, uint8_t cbKind, uint8_t cbMeldCount, bool bHasSequence);
+    void markTable(std::vector<uint8_t> &Table, uint8_t cbCounts[], uint8_t cbSize, bool bHasSequence);
+
+    uint8_t lookup(const uint8_t cbCardIndex[], uint8_t cbSize) const;
+    uint8_t analyseSuits(const uint32_t key[4], const uint8_t cbSum[4]) const;
+    void decomposeFrom(uint8_t cbCounts[], uint8_t cbBegin, uint8_t cbSize, uint8_t cbPos, bool bNeedEye, tagSuitDecompose &Current, tagSuitDecompose Decompose[], uint8_t &cbCount) const;
+};
+
+#endif //COCOSTUDIO_MAHJONG_HUTABLE_H
@@ -0,0 +1,365 @@
+//
+// MonteCarloSearch.cpp
+// 蒙特卡洛搜索
+//
+
+#include "MonteCarloSearch.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+uint64_t mixSeed(uint64_t llSeed, uint64_t llValue) {
+    uint64_t llState = llSeed ^ (llValue * 0x9E3779B97F4A7C15ULL);
+    return GameRandom::splitMix64(llState);
+}
+
+//座位能看到的牌：各家没被碰杠的弃牌和碰杠组合，不超过 4 减去自己的张数
+void visibleTiles(const tagGameState &State, uint8_t cbChairID, uint8_t cbVisibleIndex[MAX_INDEX]) {
+    memset(cbVisibleIndex, 0, MAX_INDEX);
+    for (uint8_t i = 0; i < State.cbPlayerCount; i++) {
+        for (uint8_t j = 0; j < State.cbDiscardCount[i]; j++) {
+            cbVisibleIndex[GameLogic::switchToCardIndex(State.cbDiscardCard[i][j])]++;
+        }
+        for (uint8_t j = 0; j < State.cbWeaveItemCount[i]; j++) {
+            uint8_t cbIndex = GameLogic::switchToCardIndex(State.WeaveItemArray[i][j].cbCenterCard);
+            cbVisibleIndex[cbIndex] = static_cast<uint8_t>(cbVisibleIndex[cbIndex] + (State.WeaveItemArray[i][j].cbWeaveKind == WIK_G ? 4 : 3));
+        }
+    }
+    for (uint8_t j = 0; j < MAX_INDEX; j++) {
+        if (cbVisibleIndex[j] + State.cbCardIndex[cbChairID][j] > 4) cbVisibleIndex[j] = static_cast<uint8_t>(4 - State.cbCardIndex[cbChairID][j]);
+    }
+}
+
+//碰牌后（再打出一张）的向听数是否比现在少
+bool pengReducesShanten(const tagGameState &State, uint8_t cbChairID) {
+    uint8_t cbIndex = GameLogic::switchToCardIndex(State.cbProvideCard);
+    if (State.cbCardIndex[cbChairID][cbIndex] < 2) return false;
+    int8_t cbShanten = GameLogic::analyseShanten(State.cbCardIndex[cbChairID], State.cbWeaveItemCount[cbChairID]);
+    uint8_t cbCardIndex[MAX_INDEX];
+    memcpy(cbCardIndex, State.cbCardIndex[cbChairID], sizeof(cbCardIndex));
+    cbCardIndex[cbIndex] = static_cast<uint8_t>(cbCardIndex[cbIndex] - 2);
+    tagDiscardResult DiscardResult[MAX_INDEX];
+    if (GameLogic::analyseDiscard(cbCardIndex, static_cast<uint8_t>(State.cbWeaveItemCount[cbChairID] + 1), NULL, DiscardResult) == 0) return false;
+    return DiscardResult[0].cbShanten < cbShanten;
+}
+
+//原地洗牌（GameLogic::shuffle 会重新生成整副牌，这里只打乱已有的牌）
+void permute(uint8_t cbCardData[], uint8_t cbCount, GameRandom &Random) {
+    for (uint8_t i = static_cast<uint8_t>(cbCount - 1); cbCount > 1 && i > 0; i--) {
+        uint8_t cbPosition = static_cast<uint8_t>(Random.nextBounded(static_cast<uint32_t>(i) + 1));
+        uint8_t cbTemp = cbCardData[i];
+        cbCardData[i] = cbCardData[cbPosition];
+        cbCardData[cbPosition] = cbTemp;
+    }
+}
+
+} // namespace
+
+MonteCarloSearch::MonteCarloSearch(const tagSearchConfig &Config)
+        : m_Config(Config), m_llNextGroup(0), m_llGeneration(0), m_dwRunning(0), m_bStop(false),
+          m_llDecisions(0), m_llRollouts(0), m_dSearchSeconds(0) {
+    uint32_t dwThreads = m_Config.dwThreads > 0 ? m_Config.dwThreads : std::thread::hardware_concurrency();
+    if (dwThreads == 0) dwThreads = 1;
+    m_Config.dwThreads = dwThreads;
+    memset(&m_Merged, 0, sizeof(m_Merged));
+    for (uint32_t t = 0; t < dwThreads; t++) {
+        GameEngine *pEngine = new GameEngine();
+        pEngine->setQuiet(true);
+        m_Engines.push_back(pEngine);
+    }
+    for (uint32_t t = 1; t < dwThreads; t++) {
+        m_Threads.push_back(std::thread(&MonteCarloSearch::workerLoop, this, t));
+    }
+}
+
+MonteCarloSearch::~MonteCarloSearch() {
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_bStop = true;
+    }
+    m_JobReady.notify_all();
+    for (size_t t = 0; t < m_Threads.size(); t++) m_Threads[t].join();
+    for (size_t t = 0; t < m_Engines.size(); t++) delete m_Engines[t];
+}
+
+/**
+ * 为座位选择下一条命令
+ * @param State
+ * @param cbChairID
+ * @param Result
+ * @return
+ */
+bool MonteCarloSearch::decide(const tagGameState &State, uint8_t cbChairID, tagSearchResult &Result) {
+    Clock::time_point Begin = Clock::now();
+    tagGameCommand Candidates[SEARCH_MAX_CANDIDATES];
+    uint8_t cbCount = listCandidates(State, cbChairID, Candidates);
+    memset(&Result, 0, sizeof(Result));
+    if (cbCount == 0) return false;
+    Result.Command = Candidates[0];
+    Result.cbCandidateCount = cbCount;
+    if (cbCount == 1) return true;
+    for (uint8_t c = 0; c < cbCount; c++) {         //能胡直接胡（胡在最后一个候选）
+        if (Candidates[c].cbKind != GameCommand_OperateCard || Candidates[c].OperateCard.cbOperateCode != WIK_H) continue;
+        Result.Command = Candidates[c];
+        return true;
+    }
+
+    //同一局面、同一座位得到相同的种子
+    uint64_t llJobSeed = mixSeed(m_Config.llSeed, State.llGameSeed);
+    llJobSeed = mixSeed(llJobSeed, (static_cast<uint64_t>(cbChairID) << 32) | (static_cast<uint64_t>(State.cbSendCardCount) << 16)
+                                   | (static_cast<uint64_t>(State.cbOutCardCount) << 8) | State.cbProvideCard);
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Job.pState = &State;
+        m_Job.cbChairID = cbChairID;
+        m_Job.pCandidates = Candidates;
+        m_Job.cbCandidateCount = cbCount;
+        m_Job.llJobSeed = llJobSeed;
+        m_Job.llMaxGroups = m_Config.dwMaxRollouts / cbCount;
+        if (m_Config.dwMaxRollouts == 0) m_Job.llMaxGroups = m_Config.dwBudgetMs == 0 ? SEARCH_DEFAULT_GROUPS : 0;
+        if (m_Config.dwMaxRollouts > 0 && m_Job.llMaxGroups == 0) m_Job.llMaxGroups = 1;
+        m_Job.bDeadline = m_Config.dwBudgetMs > 0;
+        m_Job.Deadline = Begin + std::chrono::milliseconds(m_Config.dwBudgetMs);
+        memset(&m_Merged, 0, sizeof(m_Merged));
+        m_llNextGroup = 0;
+        m_dwRunning = static_cast<uint32_t>(m_Threads.size());
+        m_llGeneration++;
+    }
+    m_JobReady.notify_all();
+    runJob(0);
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_JobDone.wait(lock, [this]() { return m_dwRunning == 0; });
+    }
+
+    //平均积分最高的候选；要换掉第一个候选（启发式的选择），比它多出的积分要超过两倍标准误差
+    uint8_t cbBest = 0;
+    uint32_t dwGroups = m_Merged.dwGroups;
+    if (dwGroups >= SEARCH_MIN_GROUPS) {
+        double dBestGain = 0;
+        for (uint8_t c = 1; c < cbCount; c++) {
+            double dGain = static_cast<double>(m_Merged.lGain[c]) / dwGroups;
+            double dVariance = static_cast<double>(m_Merged.lGainSquare[c]) / dwGroups - dGain * dGain;
+            if (dGain <= dBestGain || dGain <= 2 * std::sqrt(dVariance > 0 ? dVariance / dwGroups : 0)) continue;
+            cbBest = c;
+            dBestGain = dGain;
+        }
+    }
+    Result.Command = Candidates[cbBest];
+    Result.dExpectedScore = dwGroups > 0 ? static_cast<double>(m_Merged.lScore[cbBest]) / dwGroups : 0;
+    Result.llRollouts = static_cast<uint64_t>(m_Merged.llRollouts);
+    Result.dElapsed = std::chrono::duration<double>(Clock::now() - Begin).count();
+    m_llDecisions++;
+    m_llRollouts += Result.llRollouts;
+    m_dSearchSeconds += Result.dElapsed;
+    return true;
+}
+
+//后台线程：等待新的决策，推演完通知调用线程
+void MonteCarloSearch::workerLoop(uint32_t dwIndex) {
+    uint64_t llSeen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_JobReady.wait(lock, [this, llSeen]() { return m_bStop || m_llGeneration != llSeen; });
+            if (m_bStop) return;
+            llSeen = m_llGeneration;
+        }
+        runJob(dwIndex);
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (--m_dwRunning == 0) m_JobDone.notify_all();
+    }
+}
+
+//领取组号直到次数用完或超时：一组用同一份抽样把每个候选各推演一次，合计在栈上累加
+void MonteCarloSearch::runJob(uint32_t dwIndex) {
+    GameEngine &Engine = *m_Engines[dwIndex];
+    const SearchJob &Job = m_Job;
+    SearchTotals Totals;
+    memset(&Totals, 0, sizeof(Totals));
+    GameRandom Random;
+    tagGameState Sample;
+    int64_t lScore[SEARCH_MAX_CANDIDATES];
+    for (;;) {
+        if (Job.bDeadline && Clock::now() >= Job.Deadline) break;
+        uint64_t llGroup = m_llNextGroup++;
+        if (Job.llMaxGroups > 0 && llGroup >= Job.llMaxGroups) break;
+        Random.seed(mixSeed(Job.llJobSeed, llGroup));
+        determinize(*Job.pState, Job.cbChairID, Random, Sample);
+        bool bFinished = true;
+        for (uint8_t c = 0; c < Job.cbCandidateCount && bFinished; c++) {
+            bFinished = rollout(Engine, Sample, Job.pCandidates[c], Job.cbChairID, lScore[c]);
+            Totals.llRollouts++;
+        }
+        if (!bFinished) continue;                   //有一个没打完，整组不计
+        Totals.dwGroups++;
+        for (uint8_t c = 0; c < Job.cbCandidateCount; c++) {
+            int64_t lGain = lScore[c] - lScore[0];
+            Totals.lScore[c] += lScore[c];
+            Totals.lGain[c] += lGain;
+            Totals.lGainSquare[c] += lGain * lGain;
+        }
+    }
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for (uint8_t c = 0; c < SEARCH_MAX_CANDIDATES; c++) {
+        m_Merged.lScore[c] += Totals.lScore[c];
+        m_Merged.lGain[c] += Totals.lGain[c];
+        m_Merged.lGainSquare[c] += Totals.lGainSquare[c];
+    }
+    m_Merged.dwGroups += Totals.dwGroups;
+    m_Merged.llRollouts += Totals.llRollouts;
+}
+
+/**
+ * 列出座位当前可选的命令
+ * @param State
+ * @param cbChairID
+ * @param Candidates
+ * @return
+ */
+uint8_t MonteCarloSearch::listCandidates(const tagGameState &State, uint8_t cbChairID, tagGameCommand Candidates[SEARCH_MAX_CANDIDATES]) {
+    uint8_t cbCount = 0;
+    uint8_t cbAction = State.cbUserAction[cbChairID];
+    if (cbAction != WIK_NULL && !State.bResponse[cbChairID]) {
+        //第一个候选是启发式的选择：能杠就杠，碰了向听数减少就碰，否则过
+        tagGameCommand Pass = tagGameCommand::makeOperateCard(cbChairID, WIK_NULL, State.cbProvideCard);
+        bool bPassFirst = (cbAction & WIK_G) == 0 && ((cbAction & WIK_P) == 0 || !pengReducesShanten(State, cbChairID));
+        if (bPassFirst) Candidates[cbCount++] = Pass;
+        if ((cbAction & WIK_G) != 0) {
+            if (State.cbCurrentUser == cbChairID) {                     //自己回合：暗杠、补杠，每张可杠的牌一个候选
+                for (uint8_t g = 0; g < State.cbGangCount && g < MAX_WEAVE; g++) {
+                    Candidates[cbCount++] = tagGameCommand::makeOperateCard(cbChairID, WIK_G, State.cbGangCard[g]);
+                }
+            } else {
+                Candidates[cbCount++] = tagGameCommand::makeOperateCard(cbChairID, WIK_G, State.cbProvideCard);
+            }
+        }
+        if ((cbAction & WIK_P) != 0) {
+            Candidates[cbCount++] = tagGameCommand::makeOperateCard(cbChairID, WIK_P, State.cbProvideCard);
+        }
+        if (!bPassFirst) Candidates[cbCount++] = Pass;
+        if ((cbAction & WIK_H) != 0) {
+            Candidates[cbCount++] = tagGameCommand::makeOperateCard(cbChairID, WIK_H, State.cbProvideCard);
+        }
+        return cbCount;
+    }
+    if (State.cbCurrentUser != cbChairID) return 0;
+    uint8_t cbCardCount = 0;
+    for (uint8_t j = 0; j < MAX_INDEX; j++) cbCardCount = static_cast<uint8_t>(cbCardCount + State.cbCardIndex[cbChairID][j]);
+    if (cbCardCount % 3 != 2) return 0;
+    //出牌只推演向听数最小的几张（按有效牌张数排序），其余的推演次数不够也很少更好
+    uint8_t cbVisibleIndex[MAX_INDEX];
+    visibleTiles(State, cbChairID, cbVisibleIndex);
+    tagDiscardResult DiscardResult[MAX_INDEX];
+    uint8_t cbResultCount = GameLogic::analyseDiscard(State.cbCardIndex[cbChairID], State.cbWeaveItemCount[cbChairID], cbVisibleIndex, DiscardResult);
+    for (uint8_t n = 0; n < cbResultCount && cbCount < SEARCH_MAX_DISCARDS; n++) {
+        if (DiscardResult[n].cbShanten != DiscardResult[0].cbShanten) break;
+        Candidates[cbCount++] = tagGameCommand::makeOutCard(DiscardResult[n].cbOutCard);
+    }
+    return cbCount;
+}
+
+/**
+ * 抽样
+ * @param State
+ * @param cbChairID
+ * @param Random
+ * @param Sample
+ */
+void MonteCarloSearch::determinize(const tagGameState &State, uint8_t cbChairID, GameRandom &Random, tagGameState &Sample) {
+    memcpy(&Sample, &State, sizeof(Sample));
+    //其他人的手牌接在牌墙后面，一起洗牌后按原来的张数分回去
+    uint8_t cbHidden[MAX_REPERTORY];
+    uint8_t cbHiddenCount = Sample.cbLeftCardCount;
+    memcpy(cbHidden, Sample.cbRepertoryCard, cbHiddenCount);
+    for (uint8_t i = 0; i < Sample.cbPlayerCount; i++) {
+        if (i == cbChairID) continue;
+        for (uint8_t j = 0; j < MAX_INDEX; j++) {
+            for (uint8_t n = 0; n < Sample.cbCardIndex[i][j]; n++) cbHidden[cbHiddenCount++] = GameLogic::switchToCardData(j);
+        }
+    }
+    permute(cbHidden, cbHiddenCount, Random);
+    memcpy(Sample.cbRepertoryCard, cbHidden, Sample.cbLeftCardCount);
+    uint8_t cbNext = Sample.cbLeftCardCount;
+    for (uint8_t i = 0; i < Sample.cbPlayerCount; i++) {
+        if (i == cbChairID) continue;
+        uint8_t cbCount = 0;
+        for (uint8_t j = 0; j < MAX_INDEX; j++) cbCount = static_cast<uint8_t>(cbCount + State.cbCardIndex[i][j]);
+        memset(Sample.cbCardIndex[i], 0, sizeof(Sample.cbCardIndex[i]));
+        GameLogic::switchToCardIndex(&cbHidden[cbNext], cbCount, Sample.cbCardIndex[i]);
+        cbNext = static_cast<uint8_t>(cbNext + cbCount);
+        //别人的动作看不到，清掉（推演中出牌、摸牌后由引擎按抽到的手牌重新判定）
+        Sample.cbUserAction[i] = WIK_NULL;
+        Sample.cbPerformAction[i] = WIK_NULL;
+        Sample.cbTempUserAction[i] = WIK_NULL;
+        Sample.bResponse[i] = false;
+        Sample.llHuRight[i] = 0;
+        Sample.cbHuKind[i] = 0;
+        Sample.cbHuSpecial[i] = 0;
+    }
+    Sample.cbTargetUser = static_cast<uint8_t>(Sample.cbTargetUser & (1 << cbChairID));
+}
+
+/**
+ * 从抽样局面推演到终局
+ * @param Engine
+ * @param Sample
+ * @param First
+ * @param cbChairID
+ * @param lScore
+ * @return
+ */
+bool MonteCarloSearch::rollout(GameEngine &Engine, const tagGameState &Sample, const tagGameCommand &First, uint8_t cbChairID, int64_t &lScore) {
+    Engine.restore(Sample);
+    GameEventBuffer Events;
+    tagGameCommand Command = First;
+    for (int iStep = 0; iStep < SEARCH_MAX_STEPS; iStep++) {
+        Events.clear();
+        Engine.apply(Command, Events);
+        for (uint8_t n = 0; n < Events.size(); n++) {
+            if (Events[n].cbKind != GameEvent_GameEnd) continue;
+            lScore = Events[n].GameEnd.lGameScore[cbChairID];
+            return true;
+        }
+        if (!rolloutCommand(Engine.getGameState(), Command)) return false;
+    }
+    return false;
+}
+
+/**
+ * 快速策略
+ * @param State
+ * @param Command
+ * @return
+ */
+bool MonteCarloSearch::rolloutCommand(const tagGameState &State, tagGameCommand &Command) {
+    for (uint8_t i = 0; i < State.cbPlayerCount; i++) {
+        if (State.cbUserAction[i] == WIK_NULL || State.bResponse[i]) continue;
+        uint8_t cbCode = (State.cbUserAction[i] & WIK_H) != 0 ? WIK_H : WIK_NULL;
+        Command = tagGameCommand::makeOperateCard(i, cbCode, State.cbProvideCard);
+        return true;
+    }
+    uint8_t cbCurrentUser = State.cbCurrentUser;
+    if (cbCurrentUser >= State.cbPlayerCount) return false;
+    uint8_t cbCardIndex[MAX_INDEX];
+    memcpy(cbCardIndex, State.cbCardIndex[cbCurrentUser], sizeof(cbCardIndex));
+    uint8_t cbOutCard = 0;
+    int8_t cbBest = 127;
+    for (int j = MAX_INDEX - 1; j >= 0; j--) {
+        if (cbCardIndex[j] == 0) continue;
+        cbCardIndex[j]--;
+        int8_t cbShanten = GameLogic::analyseShanten(cbCardIndex, State.cbWeaveItemCount[cbCurrentUser]);
+        cbCardIndex[j]++;
+        if (cbShanten < cbBest) {
+            cbBest = cbShanten;
+            cbOutCard = GameLogic::switchToCardData(static_cast<uint8_t>(j));
+        }
+    }
+    if (cbOutCard == 0) return false;
+    Command = tagGameCommand::makeOutCard(cbOutCard);
+    return true;
+}
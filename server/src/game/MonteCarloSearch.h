@@ -0,0 +1,144 @@
+//
+// MonteCarloSearch.h
+// 蒙特卡洛搜索：按一个座位能看到的信息抽样推演到终局，按期望积分选择出牌和碰杠胡
+//
+
+#ifndef COCOSTUDIO_MAHJONG_MONTECARLOSEARCH_H
+#define COCOSTUDIO_MAHJONG_MONTECARLOSEARCH_H
+
+#include "GameEngine.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define SEARCH_MAX_CANDIDATES        16                                //候选命令上限（手牌最多 14 种，动作最多 过碰胡 + 4 杠）
+#define SEARCH_MAX_DISCARDS          4                                 //出牌最多推演的候选数（向听数最小的几张）
+#define SEARCH_MAX_STEPS             400                               //每次推演最多的命令数
+#define SEARCH_MIN_GROUPS            8                                 //至少推演这么多组才会换掉启发式的选择
+#define SEARCH_DEFAULT_GROUPS        256                               //不限时间、不限次数时推演的组数
+
+struct tagSearchConfig {
+    uint32_t dwThreads;                         //线程数（含调用线程），0 为 CPU 核数
+    uint32_t dwBudgetMs;                        //每次决策的时间预算（毫秒），0 为不限
+    uint32_t dwMaxRollouts;                     //每次决策的推演次数上限，0 为不限（两项都为 0 时推演 SEARCH_DEFAULT_GROUPS 组）
+    uint64_t llSeed;                            //种子
+
+    tagSearchConfig() : dwThreads(0), dwBudgetMs(50), dwMaxRollouts(0), llSeed(1) {
+    }
+};
+
+struct tagSearchResult {
+    tagGameCommand Command;                     //选中的命令
+    uint8_t cbCandidateCount;                   //候选数量
+    uint64_t llRollouts;                        //推演次数
+    double dExpectedScore;                      //选中命令的平均积分（推演的终局积分）
+    double dElapsed;                            //耗时（秒）
+};
+
+class MonteCarloSearch {
+public:
+    explicit MonteCarloSearch(const tagSearchConfig &Config);
+    ~MonteCarloSearch();
+
+    const tagSearchConfig &getConfig() const { return m_Config; }
+    uint64_t getDecisionCount() const { return m_llDecisions; }     //推演过的决策次数（累计）
+    uint64_t getRolloutCount() const { return m_llRollouts; }       //推演次数（累计）
+    double getSearchSeconds() const { return m_dSearchSeconds; }    //推演耗时（累计，秒）
+
+    /**
+     * 为座位选择下一条命令：有待响应的动作时在 过/碰/杠/胡 中选择，轮到自己出牌时选择打哪张
+     * @param State 当前局面（只使用该座位能看到的部分）
+     * @param cbChairID
+     * @param Result 输出
+     * @return 该座位没有要做的事返回 false；只有一个候选或者能胡时不推演
+     */
+    bool decide(const tagGameState &State, uint8_t cbChairID, tagSearchResult &Result);
+
+    /**
+     * 列出座位当前可选的命令
+     * @param State
+     * @param cbChairID
+     * @param Candidates 输出
+     * @return 候选数量
+     */
+    static uint8_t listCandidates(const tagGameState &State, uint8_t cbChairID, tagGameCommand Candidates[SEARCH_MAX_CANDIDATES]);
+
+    /**
+     * 抽样：其他人的手牌和牌墙重新洗牌（张数不变），清掉别人的待响应动作
+     * @param State
+     * @param cbChairID
+     * @param Random
+     * @param Sample 输出
+     */
+    static void determinize(const tagGameState &State, uint8_t cbChairID, GameRandom &Random, tagGameState &Sample);
+
+    /**
+     * 从抽样局面执行第一条命令后用快速策略推演到终局
+     * @param Engine 推演用的引擎（不需要入座玩家）
+     * @param Sample
+     * @param First
+     * @param cbChairID
+     * @param lScore 输出，该座位的终局积分
+     * @return 超过步数上限仍未结束返回 false
+     */
+    static bool rollout(GameEngine &Engine, const tagGameState &Sample, const tagGameCommand &First, uint8_t cbChairID, int64_t &lScore);
+
+    /**
+     * 快速策略：有待响应的座位先响应（能胡就胡，否则过），否则当前玩家打出向听数最小的牌
+     * @param State
+     * @param Command 输出
+     * @return
+     */
+    static bool rolloutCommand(const tagGameState &State, tagGameCommand &Command);
+
+private:
+    //一次决策的共享数据，工作线程只读（计数器除外）
+    struct SearchJob {
+        const tagGameState *pState;
+        uint8_t cbChairID;
+        const tagGameCommand *pCandidates;
+        uint8_t cbCandidateCount;
+        uint64_t llJobSeed;
+        uint64_t llMaxGroups;                   //0 为不限（只看时间）
+        std::chrono::steady_clock::time_point Deadline;
+        bool bDeadline;
+
+        SearchJob() : pState(NULL), cbChairID(0), pCandidates(NULL), cbCandidateCount(0), llJobSeed(0), llMaxGroups(0),
+                      Deadline(), bDeadline(false) {
+        }
+    };
+
+    //各候选的积分合计和相对第一个候选的差值（同一组配对），每个线程在栈上各自累加，结束后加锁合并
+    struct SearchTotals {
+        int64_t lScore[SEARCH_MAX_CANDIDATES];
+        int64_t lGain[SEARCH_MAX_CANDIDATES];
+        int64_t lGainSquare[SEARCH_MAX_CANDIDATES];
+        uint32_t dwGroups;                      //打完的组数
+        uint64_t llRollouts;
+    };
+
+    void workerLoop(uint32_t dwIndex);
+    void runJob(uint32_t dwIndex);
+
+    tagSearchConfig m_Config;
+    std::vector<std::thread> m_Threads;         //后台线程（调用线程是第 0 个）
+    std::vector<GameEngine *> m_Engines;        //每个线程一个推演引擎
+    SearchTotals m_Merged;                      //本次决策合并后的合计
+    std::atomic<uint64_t> m_llNextGroup;        //下一组推演的组号
+    SearchJob m_Job;
+    std::mutex m_Mutex;
+    std::condition_variable m_JobReady;
+    std::condition_variable m_JobDone;
+    uint64_t m_llGeneration;                    //决策序号，后台线程据此领取新任务
+    uint32_t m_dwRunning;                       //本次决策尚未结束的后台线程数
+    bool m_bStop;
+    uint64_t m_llDecisions;
+    uint64_t m_llRollouts;
+    double m_dSearchSeconds;
+};
+
+#endif //COCOSTUDIO_MAHJONG_MONTECARLOSEARCH_H
@@ -0,0 +1,188 @@
+//
+// PackedHand.h
+// 位压缩手牌：34 种牌每种 3 位，共两个 64 位字
+//
+
+#ifndef COCOSTUDIO_MAHJONG_PACKEDHAND_H
+#define COCOSTUDIO_MAHJONG_PACKEDHAND_H
+
+#include "GameCmd.h"
+
+class PackedHand {
+public:
+    static const uint8_t FIELD_BITS = 3;                    //每种牌的位数
+    static const uint8_t FIELDS_PER_WORD = 18;              //每个字的种类数
+    static const uint8_t SUIT_BITS = 27;                    //每门 9 种牌的位数
+
+    PackedHand() {
+        m_llWord[0] = 0;
+        m_llWord[1] = 0;
+    }
+
+    explicit PackedHand(const uint8_t cbCardIndex[MAX_INDEX]) {
+        fromIndex(cbCardIndex);
+    }
+
+    void fromIndex(const uint8_t cbCardIndex[MAX_INDEX]) {
+        uint64_t llWord0 = 0, llWord1 = 0;
+        for (uint8_t i = 0; i < FIELDS_PER_WORD; i++) {
+            llWord0 |= static_cast<uint64_t>(cbCardIndex[i]) << (FIELD_BITS * i);
+        }
+        for (uint8_t i = FIELDS_PER_WORD; i < MAX_INDEX; i++) {
+            llWord1 |= static_cast<uint64_t>(cbCardIndex[i]) << (FIELD_BITS * (i - FIELDS_PER_WORD));
+        }
+        m_llWord[0] = llWord0;
+        m_llWord[1] = llWord1;
+    }
+
+    void toIndex(uint8_t cbCardIndex[MAX_INDEX]) const {
+        for (uint8_t i = 0; i < MAX_INDEX; i++) {
+            cbCardIndex[i] = count(i);
+        }
+    }
+
+    //某种牌的数量
+    uint8_t count(uint8_t cbIndex) const {
+        return static_cast<uint8_t>((m_llWord[wordOf(cbIndex)] >> shiftOf(cbIndex)) & 7);
+    }
+
+    //加一张（调用方保证不超过 4 张）
+    void add(uint8_t cbIndex) {
+        m_llWord[wordOf(cbIndex)] += 1ULL << shiftOf(cbIndex);
+    }
+
+    void add(uint8_t cbIndex, uint8_t cbCount) {
+        m_llWord[wordOf(cbIndex)] += static_cast<uint64_t>(cbCount) << shiftOf(cbIndex);
+    }
+
+    //删一张，没有这张牌时不变并返回 false
+    bool remove(uint8_t cbIndex) {
+        uint64_t &llWord = m_llWord[wordOf(cbIndex)];
+        uint8_t cbShift = shiftOf(cbIndex);
+        uint64_t llHas = ((llWord >> cbShift) & 7) != 0;
+        llWord -= llHas << cbShift;
+        return llHas != 0;
+    }
+
+    //删 cbCount 张，不够时不变并返回 false
+    bool remove(uint8_t cbIndex, uint8_t cbCount) {
+        uint64_t &llWord = m_llWord[wordOf(cbIndex)];
+        uint8_t cbShift = shiftOf(cbIndex);
+        uint64_t llEnough = ((llWord >> cbShift) & 7) >= cbCount;
+        llWord -= (llEnough * cbCount) << cbShift;
+        return llEnough != 0;
+    }
+
+    //删除某种牌的全部
+    void removeAll(uint8_t cbIndex) {
+        m_llWord[wordOf(cbIndex)] &= ~(7ULL << shiftOf(cbIndex));
+    }
+
+    //牌的总数
+    uint8_t total() const {
+        return static_cast<uint8_t>(fieldSum(m_llWord[0]) + fieldSum(m_llWord[1]));
+    }
+
+    //有牌的种类数
+    uint8_t kindCount() const {
+        return countAtLeast(1);
+    }
+
+    //数量恰好为 cbCount 的种类数（如七对判断 countEqual(2) == 7）
+    uint8_t countEqual(uint8_t cbCount) const {
+        return static_cast<uint8_t>(popcount(equalMask(m_llWord[0], LOW_MASK_0, cbCount)) + popcount(equalMask(m_llWord[1], LOW_MASK_1, cbCount)));
+    }
+
+    //数量不少于 cbCount 的种类数（cbCount 为 1~4）
+    uint8_t countAtLeast(uint8_t cbCount) const {
+        return static_cast<uint8_t>(popcount(atLeastMask(m_llWord[0], LOW_MASK_0, cbCount)) + popcount(atLeastMask(m_llWord[1], LOW_MASK_1, cbCount)));
+    }
+
+    //某门牌（0 筒、1 万、2 条、3 字）的原始位，每种牌 3 位
+    uint32_t suitBits(uint8_t cbSuit) const {
+        return static_cast<uint32_t>((m_llWord[cbSuit >> 1] >> (SUIT_BITS * (cbSuit & 1))) & ((1ULL << SUIT_BITS) - 1));
+    }
+
+    //某门牌的张数
+    uint8_t suitTotal(uint8_t cbSuit) const {
+        return static_cast<uint8_t>(fieldSum(suitBits(cbSuit)));
+    }
+
+    //任意一种牌超过 4 张（无效手牌）
+    bool hasOverflow() const {
+        return (atLeastOverflow(m_llWord[0], LOW_MASK_0) | atLeastOverflow(m_llWord[1], LOW_MASK_1)) != 0;
+    }
+
+    uint64_t word(uint8_t i) const {
+        return m_llWord[i];
+    }
+
+    bool operator==(const PackedHand &other) const {
+        return ((m_llWord[0] ^ other.m_llWord[0]) | (m_llWord[1] ^ other.m_llWord[1])) == 0;
+    }
+
+    bool operator!=(const PackedHand &other) const {
+        return !(*this == other);
+    }
+
+private:
+    static const uint64_t LOW_MASK_0 = 0x9249249249249ULL;     //第 0 个字每种牌的最低位（18 种）
+    static const uint64_t LOW_MASK_1 = 0x249249249249ULL;      //第 1 个字每种牌的最低位（16 种）
+
+    uint64_t m_llWord[2];
+
+    static uint8_t wordOf(uint8_t cbIndex) {
+        return static_cast<uint8_t>(cbIndex >= FIELDS_PER_WORD);
+    }
+
+    static uint8_t shiftOf(uint8_t cbIndex) {
+        return static_cast<uint8_t>(FIELD_BITS * (cbIndex - FIELDS_PER_WORD * wordOf(cbIndex)));
+    }
+
+    //没有 POPCNT 指令时 __builtin_popcountll 会调用 libgcc 的查表函数，改用移位相加
+    static uint32_t popcount(uint64_t llValue) {
+#if defined(__POPCNT__)
+        return static_cast<uint32_t>(__builtin_popcountll(llValue));
+#else
+        llValue = llValue - ((llValue >> 1) & 0x5555555555555555ULL);
+        llValue = (llValue & 0x3333333333333333ULL) + ((llValue >> 2) & 0x3333333333333333ULL);
+        llValue = (llValue + (llValue >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return static_cast<uint32_t>((llValue * 0x0101010101010101ULL) >> 56);
+#endif
+    }
+
+    //各种牌数量之和：相邻两种相加（6 位一组），再两组相加（12 位一组），最后乘法把各组累加到最高组
+    static uint32_t fieldSum(uint64_t llWord) {
+        uint64_t llPair = (llWord & 0x01C71C71C71C71C7ULL) + ((llWord >> 3) & 0x01C71C71C71C71C7ULL);
+        uint64_t llQuad = (llPair & 0x003F03F03F03F03FULL) + ((llPair >> 6) & 0x003F03F03F03F03FULL);
+        return static_cast<uint32_t>(((llQuad * 0x0001001001001001ULL) >> 48) & 0xFFF);
+    }
+
+    //数量等于 cbCount 的种类，结果位于每种牌的最低位
+    static uint64_t equalMask(uint64_t llWord, uint64_t llLow, uint8_t cbCount) {
+        uint64_t llDiff = llWord ^ (llLow * cbCount);
+        return llLow & ~(llDiff | (llDiff >> 1) | (llDiff >> 2));
+    }
+
+    static uint64_t atLeastMask(uint64_t llWord, uint64_t llLow, uint8_t cbCount) {
+        switch (cbCount) {
+            case 0:
+                return llLow;
+            case 1:
+                return (llWord | (llWord >> 1) | (llWord >> 2)) & llLow;
+            case 2:
+                return ((llWord >> 1) | (llWord >> 2)) & llLow;
+            case 3:
+                return ((llWord >> 2) | (llWord & (llWord >> 1))) & llLow;
+            default:
+                return (llWord >> 2) & llLow;
+        }
+    }
+
+    //数量为 5~7 的种类（最高位与另外两位之一同时为 1）
+    static uint64_t atLeastOverflow(uint64_t llWord, uint64_t llLow) {
+        return (llWord >> 2) & (llWord | (llWord >> 1)) & llLow;
+    }
+};
+
+#endif //COCOSTUDIO_MAHJONG_PACKEDHAND_H
@@ -0,0 +1,102 @@
+//
+// RecordWriter.cpp
+// 牌局记录的后台写入
+//
+
+#include "RecordWriter.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+RecordWriter::RecordWriter(const std::string &path)
+        : m_Path(path), m_pFile(NULL), m_llQueued(0), m_llWritten(0), m_llDropped(0), m_bFlush(false), m_bStop(false) {
+    m_pFile = std::fopen(path.c_str(), "ab");
+    if (m_pFile == NULL) {
+        std::cout << "[RecordWriter] 无法打开记录文件: " << path << std::endl;
+        return;
+    }
+    m_Front.reserve(RECORD_FLUSH_BYTES * 2);
+    m_Back.reserve(RECORD_FLUSH_BYTES * 2);
+    m_Thread = std::thread(&RecordWriter::writerLoop, this);
+}
+
+RecordWriter::~RecordWriter() {
+    if (m_pFile == NULL) return;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_bStop = true;
+    }
+    m_WakeWriter.notify_one();
+    m_Thread.join();
+    std::fclose(m_pFile);
+}
+
+/**
+ * 追加一段
+ * @param pData
+ * @param cbSize
+ */
+void RecordWriter::write(const void *pData, size_t cbSize) {
+    if (m_pFile == NULL) return;
+    bool bWake = false;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (m_Front.size() + m_Back.size() + cbSize > RECORD_MAX_PENDING) {
+            m_llDropped += cbSize;
+            return;
+        }
+        const uint8_t *pBytes = static_cast<const uint8_t *>(pData);
+        m_Front.insert(m_Front.end(), pBytes, pBytes + cbSize);
+        m_llQueued += cbSize;
+        bWake = m_Front.size() >= RECORD_FLUSH_BYTES;
+    }
+    if (bWake) m_WakeWriter.notify_one();
+}
+
+/**
+ * 等待此前追加的数据全部写进文件
+ */
+void RecordWriter::flush() {
+    if (m_pFile == NULL) return;
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    uint64_t llTarget = m_llQueued;
+    m_bFlush = true;
+    m_WakeWriter.notify_one();
+    m_Written.wait(lock, [this, llTarget] { return m_llWritten >= llTarget; });
+}
+
+uint64_t RecordWriter::getWrittenBytes() const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_llWritten;
+}
+
+uint64_t RecordWriter::getDroppedBytes() const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_llDropped;
+}
+
+void RecordWriter::writerLoop() {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    for (;;) {
+        m_WakeWriter.wait_for(lock, std::chrono::milliseconds(RECORD_FLUSH_MS), [this] {
+            return m_bStop || m_bFlush || m_Front.size() >= RECORD_FLUSH_BYTES;
+        });
+        bool bStop = m_bStop;
+        m_bFlush = false;
+        if (!m_Front.empty()) {
+            m_Back.swap(m_Front);
+            lock.unlock();
+            size_t cbWritten = std::fwrite(m_Back.data(), 1, m_Back.size(), m_pFile);
+            std::fflush(m_pFile);
+            if (cbWritten != m_Back.size()) {
+                std::cout << "[RecordWriter] 写记录文件失败: " << m_Path << std::endl;
+            }
+            lock.lock();
+            m_llWritten += m_Back.size();
+            m_Back.clear();
+        }
+        m_Written.notify_all();
+        if (bStop && m_Front.empty()) break;
+    }
+}
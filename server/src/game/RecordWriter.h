@@ -0,0 +1,63 @@
+//
+// RecordWriter.h
+// 牌局记录的后台写入：各房间把写完的一局追加到内存缓冲区，后台线程成批写文件
+//
+
+#ifndef COCOSTUDIO_MAHJONG_RECORDWRITER_H
+#define COCOSTUDIO_MAHJONG_RECORDWRITER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define RECORD_FLUSH_BYTES           (64 * 1024)                       //攒够这么多字节就写
+#define RECORD_FLUSH_MS              200                               //最长等待这么久就写
+#define RECORD_MAX_PENDING           (16 * 1024 * 1024)                //待写数据的上限，超过后丢弃
+
+class RecordWriter {
+public:
+    /**
+     * 以追加方式打开记录文件并启动后台线程
+     * @param path
+     */
+    explicit RecordWriter(const std::string &path);
+    ~RecordWriter();                            //写完剩余数据后关闭
+
+    bool isOpen() const { return m_pFile != NULL; }
+    const std::string &getPath() const { return m_Path; }
+
+    /**
+     * 追加一段（不等待写盘）
+     * @param pData
+     * @param cbSize
+     */
+    void write(const void *pData, size_t cbSize);
+
+    void flush();                               //等待此前追加的数据全部写进文件
+
+    uint64_t getWrittenBytes() const;           //已写进文件的字节数
+    uint64_t getDroppedBytes() const;           //因待写数据过多丢弃的字节数
+
+private:
+    void writerLoop();
+
+    std::string m_Path;
+    FILE *m_pFile;
+    std::vector<uint8_t> m_Front;               //房间线程追加的缓冲区
+    std::vector<uint8_t> m_Back;                //后台线程正在写的缓冲区
+    mutable std::mutex m_Mutex;
+    std::condition_variable m_WakeWriter;
+    std::condition_variable m_Written;
+    uint64_t m_llQueued;                        //追加的字节数（累计）
+    uint64_t m_llWritten;                       //写进文件的字节数（累计）
+    uint64_t m_llDropped;
+    bool m_bFlush;                              //有 flush 在等待，立即写
+    bool m_bStop;
+    std::thread m_Thread;
+};
+
+#endif //COCOSTUDIO_MAHJONG_RECORDWRITER_H
@@ -0,0 +1,172 @@
+//
+// ShantenTable.cpp
+// 查表法向听数实现
+//
+
+#include "ShantenTable.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    const uint32_t kPower5[ShantenTable::SUIT_SIZE + 1] = {1, 5, 25, 125, 625, 3125, 15625, 78125, 390625, 1953125};
+}
+
+const ShantenTable &ShantenTable::instance() {
+    static const ShantenTable table;
+    return table;
+}
+
+ShantenTable::ShantenTable() {
+    generate(m_SuitTable, SUIT_SIZE, true);
+    generate(m_HonorTable, HONOR_SIZE, false);
+    for (uint16_t i = 0; i < 512; i++) {
+        uint8_t c0 = static_cast<uint8_t>(i & 7), c1 = static_cast<uint8_t>((i >> 3) & 7), c2 = static_cast<uint8_t>(i >> 6);
+        m_OctalTable[i] = static_cast<uint8_t>((c0 + 5 * c1 + 25 * c2) & 0xFF);
+    }
+}
+
+/**
+ * 生成表
+ * @param Table
+ * @param cbSize
+ * @param bSequence
+ *  是否有顺子（字牌没有）
+ */
+void ShantenTable::generate(std::vector<uint64_t> &Table, uint8_t cbSize, bool bSequence) {
+    uint32_t cbKeyCount = kPower5[cbSize];
+    //第 l 位：该牌型包含第 l 层的某个目标牌型
+    std::vector<uint16_t> Contain(cbKeyCount, 0);
+    uint8_t cbCounts[SUIT_SIZE];
+    memset(cbCounts, 0, sizeof(cbCounts));
+    generateMelds(Contain, cbCounts, cbSize, bSequence, 0, 0);
+
+    //包含关系向上传递：少一张的牌型包含的目标，本牌型也包含（少一张的键更小，已处理）
+    uint8_t cbDigit[SUIT_SIZE];
+    memset(cbDigit, 0, sizeof(cbDigit));
+    for (uint32_t key = 0; key < cbKeyCount; key++) {
+        uint16_t wContain = Contain[key];
+        for (uint8_t j = 0; j < cbSize; j++) {
+            if (cbDigit[j] > 0) wContain |= Contain[key - kPower5[j]];
+        }
+        Contain[key] = wContain;
+        for (uint8_t j = 0; j < cbSize && ++cbDigit[j] == 5; j++) cbDigit[j] = 0;
+    }
+
+    //差张数向下求：不包含时为加一张后的最小差张数 + 1（多一张的键更大，已处理）；全 4 张的牌型包含全部目标
+    Table.assign(cbKeyCount, 0);
+    for (uint8_t j = 0; j < cbSize; j++) cbDigit[j] = 4;
+    for (uint32_t key = cbKeyCount; key-- > 0;) {
+        uint16_t wContain = Contain[key];
+        if (wContain != (1 << LAYER_COUNT) - 1) {
+            uint64_t llNext[SUIT_SIZE];
+            uint8_t cbNextCount = 0;
+            for (uint8_t j = 0; j < cbSize; j++) {
+                if (cbDigit[j] < 4) llNext[cbNextCount++] = Table[key + kPower5[j]];
+            }
+            uint64_t llEntry = 0;
+            for (uint8_t l = 0; l < LAYER_COUNT; l++) {
+                if (wContain & (1 << l)) continue;
+                uint8_t cbMin = 0xF;
+                for (uint8_t n = 0; n < cbNextCount; n++) {
+                    uint8_t cbNeed = static_cast<uint8_t>((llNext[n] >> (ENTRY_BITS * l)) & 0xF);
+                    if (cbNeed < cbMin) cbMin = cbNeed;
+                }
+                llEntry |= static_cast<uint64_t>(cbMin + 1) << (ENTRY_BITS * l);
+            }
+            Table[key] = llEntry;
+        }
+        for (uint8_t j = 0; j < cbSize && cbDigit[j]-- == 0; j++) cbDigit[j] = 4;
+    }
+}
+
+/**
+ * 递归枚举恰好 cbMeldCount 个面子（以及加一对将）的牌型，种类 [0, cbSize) 是刻子，[cbSize, cbSize + cbSize - 2) 是顺子
+ */
+void ShantenTable::generateMelds(std::vector<uint16_t> &Contain, uint8_t *cbCounts, uint8_t cbSize, bool bSequence, uint8_t cbKind, uint8_t cbMeldCount) {
+    uint32_t key = 0;
+    for (uint8_t i = cbSize; i > 0; i--) key = key * 5 + cbCounts[i - 1];
+    Contain[key] |= static_cast<uint16_t>(1 << cbMeldCount);
+    for (uint8_t i = 0; i < cbSize; i++) {
+        if (cbCounts[i] + 2 > 4) continue;
+        Contain[key + 2 * kPower5[i]] |= static_cast<uint16_t>(1 << (MAX_WEAVE + 1 + cbMeldCount));
+    }
+    if (cbMeldCount == MAX_WEAVE) return;
+    uint8_t cbKindCount = static_cast<uint8_t>(bSequence ? cbSize + cbSize - 2 : cbSize);
+    for (uint8_t k = cbKind; k < cbKindCount; k++) {
+        if (k < cbSize) {
+            if (cbCounts[k] + 3 > 4) continue;
+            cbCounts[k] += 3;
+            generateMelds(Contain, cbCounts, cbSize, bSequence, k, static_cast<uint8_t>(cbMeldCount + 1));
+            cbCounts[k] -= 3;
+        } else {
+            uint8_t i = static_cast<uint8_t>(k - cbSize);
+            if (cbCounts[i] == 4 || cbCounts[i + 1] == 4 || cbCounts[i + 2] == 4) continue;
+            cbCounts[i]++; cbCounts[i + 1]++; cbCounts[i + 2]++;
+            generateMelds(Contain, cbCounts, cbSize, bSequence, k, static_cast<uint8_t>(cbMeldCount + 1));
+            cbCounts[i]--; cbCounts[i + 1]--; cbCounts[i + 2]--;
+        }
+    }
+}
+
+/**
+ * 单门查表（位压缩）
+ * @param cbSuit
+ * @param cbBits
+ * @return
+ */
+uint64_t ShantenTable::suitEntry(uint8_t cbSuit, uint32_t cbBits) const {
+    uint32_t key = m_OctalTable[cbBits & 511] + m_OctalTable[(cbBits >> 9) & 511] * kPower5[3] + m_OctalTable[cbBits >> 18] * kPower5[6];
+    return (cbSuit < 3) ? m_SuitTable[key] : m_HonorTable[key];
+}
+
+/**
+ * 合成整手：逐门做 (min, +) 卷积，cbNeed0 不带将，cbNeed1 带将
+ * @param llEntry
+ * @param cbMeldCount
+ * @return
+ */
+uint8_t ShantenTable::combine(const uint64_t *llEntry, uint8_t cbMeldCount) {
+    uint8_t cbNeed0[MAX_WEAVE + 1], cbNeed1[MAX_WEAVE + 1];
+    for (uint8_t m = 0; m <= cbMeldCount; m++) {
+        cbNeed0[m] = need(llEntry[0], false, m);
+        cbNeed1[m] = need(llEntry[0], true, m);
+    }
+    for (uint8_t g = 1; g < 4; g++) {
+        uint8_t cbSuit0[MAX_WEAVE + 1], cbSuit1[MAX_WEAVE + 1];
+        for (uint8_t m = 0; m <= cbMeldCount; m++) {
+            cbSuit0[m] = need(llEntry[g], false, m);
+            cbSuit1[m] = need(llEntry[g], true, m);
+        }
+        //从大到小更新，cbNeed0/cbNeed1[a] (a <= m) 仍是前几门的值
+        for (uint8_t m = cbMeldCount + 1; m-- > 0;) {
+            uint8_t cbBest0 = 0xFF, cbBest1 = 0xFF;
+            for (uint8_t a = 0; a <= m; a++) {
+                uint8_t b = static_cast<uint8_t>(m - a);
+                uint8_t cbWithout = static_cast<uint8_t>(cbNeed0[a] + cbSuit0[b]);
+                uint8_t cbEyeHere = static_cast<uint8_t>(cbNeed1[a] + cbSuit0[b]);
+                uint8_t cbEyeThere = static_cast<uint8_t>(cbNeed0[a] + cbSuit1[b]);
+                cbBest0 = std::min(cbBest0, cbWithout);
+                cbBest1 = std::min(cbBest1, std::min(cbEyeHere, cbEyeThere));
+            }
+            cbNeed0[m] = cbBest0;
+            cbNeed1[m] = cbBest1;
+        }
+    }
+    return cbNeed1[cbMeldCount];
+}
+
+/**
+ * 整手向听数（不含七对）
+ * @param Hand
+ * @return
+ */
+int8_t ShantenTable::analyse(const PackedHand &Hand) const {
+    uint64_t llEntry[4];
+    for (uint8_t g = 0; g < 4; g++) {
+        llEntry[g] = suitEntry(g, Hand.suitBits(g));
+    }
+    uint8_t cbMeldCount = static_cast<uint8_t>(Hand.total() / 3);
+    if (cbMeldCount > MAX_WEAVE) cbMeldCount = MAX_WEAVE;
+    return static_cast<int8_t>(combine(llEntry, cbMeldCount) - 1);
+}
@@ -0,0 +1,60 @@
+//
+// ShantenTable.h
+// 查表法向听数：每门预先算好凑出 m 个面子（以及再加一对将）的差张数，整手按门合成
+//
+
+#ifndef COCOSTUDIO_MAHJONG_SHANTENTABLE_H
+#define COCOSTUDIO_MAHJONG_SHANTENTABLE_H
+
+#include "GameCmd.h"
+#include "PackedHand.h"
+
+#include <vector>
+
+class ShantenTable {
+public:
+    static const uint8_t SUIT_SIZE = 9;             //序数牌每门 9 张
+    static const uint8_t HONOR_SIZE = 7;            //字牌 7 张
+    static const uint8_t ENTRY_BITS = 4;            //每个差张数的位数
+    static const uint8_t LAYER_COUNT = 2 * (MAX_WEAVE + 1); //表项中差张数的个数
+
+    static const ShantenTable &instance();          //第一次调用时生成表
+
+    /**
+     * 单门查表
+     * @param cbSuit 0 筒、1 万、2 条、3 字
+     * @param cbBits PackedHand::suitBits(cbSuit)，每种不超过 4 张
+     * @return 表项，交给 combine 合成
+     */
+    uint64_t suitEntry(uint8_t cbSuit, uint32_t cbBits) const;
+
+    //表项中凑出 cbMeldCount 个面子（bEye 为真时再加一对将）的差张数
+    static uint8_t need(uint64_t llEntry, bool bEye, uint8_t cbMeldCount) {
+        return static_cast<uint8_t>((llEntry >> (ENTRY_BITS * ((bEye ? MAX_WEAVE + 1 : 0) + cbMeldCount))) & 0xF);
+    }
+
+    /**
+     * 合成整手：各门的面子数之和为 cbMeldCount，恰好一门带将
+     * @return 至少还要摸进的张数
+     */
+    static uint8_t combine(const uint64_t llEntry[4], uint8_t cbMeldCount);
+
+    /**
+     * 整手查表（不含七对）
+     * @param Hand 手牌，每种不超过 4 张
+     * @return 向听数，-1 表示已经能拆成 n 个面子加一对将
+     */
+    int8_t analyse(const PackedHand &Hand) const;
+
+private:
+    std::vector<uint64_t> m_SuitTable;              //序数牌表，5^9 项
+    std::vector<uint64_t> m_HonorTable;             //字牌表，5^7 项
+    uint8_t m_OctalTable[512];                      //位压缩的 3 种牌（9 位）-> 五进制键
+
+    ShantenTable();
+
+    void generate(std::vector<uint64_t> &Table, uint8_t cbSize, bool bSequence);
+    void generateMelds(std::vector<uint16_t> &Contain, uint8_t cbCounts[], uint8_t cbSize, bool bSequence, uint8_t cbKind, uint8_t cbMeldCount);
+};
+
+#endif //COCOSTUDIO_MAHJONG_SHANTENTABLE_H
@@ -0,0 +1,180 @@
+//
+// TileSet.h
+// 牌的编码：牌值（花色 << 4 | 点数）与索引的转换、牌墙，编码表在编译期生成
+//
+
+#ifndef COCOSTUDIO_MAHJONG_TILESET_H
+#define COCOSTUDIO_MAHJONG_TILESET_H
+
+#include <cstdint>
+
+#include "GameRandom.h"
+
+//编译期序列 0, 1, ..., N - 1（C++11 没有 std::index_sequence）
+template <uint8_t... I>
+struct TileSequence {
+};
+
+template <uint16_t N, uint8_t... I>
+struct MakeTileSequence : MakeTileSequence<static_cast<uint16_t>(N - 1), static_cast<uint8_t>(N - 1), I...> {
+};
+
+template <uint8_t... I>
+struct MakeTileSequence<0, I...> {
+    typedef TileSequence<I...> type;
+};
+
+//按 F::value(i) 生成的常量表
+template <typename F, typename SEQUENCE>
+struct TileTable;
+
+template <typename F, uint8_t... I>
+struct TileTable<F, TileSequence<I...> > {
+    static constexpr uint8_t s_cbValue[sizeof...(I)] = {F::value(I)...};
+};
+
+template <typename F, uint8_t... I>
+constexpr uint8_t TileTable<F, TileSequence<I...> >::s_cbValue[sizeof...(I)];
+
+template <uint8_t SUIT_COUNT, uint8_t HONOR_COUNT, uint8_t FLOWER_COUNT>
+class TileSet {
+public:
+    static_assert(SUIT_COUNT <= 3, "数牌最多 3 门（花色 0~2）");
+    static_assert(HONOR_COUNT <= 7 && FLOWER_COUNT <= 8, "字牌最多 7 种，花牌最多 8 种");
+
+    static constexpr uint8_t SUIT_KIND = SUIT_COUNT * 9;                                        //数牌种数
+    static constexpr uint8_t INDEX_COUNT = SUIT_KIND + HONOR_COUNT + FLOWER_COUNT;              //索引数量
+    static constexpr uint8_t REPERTORY_COUNT = 4 * (SUIT_KIND + HONOR_COUNT) + FLOWER_COUNT;    //牌墙张数（花牌各 1 张）
+    static constexpr uint8_t HONOR_COLOR = 3;                                                   //字牌花色
+    static constexpr uint8_t FLOWER_COLOR = 4;                                                  //花牌花色
+    static constexpr uint8_t INVALID_INDEX = 0xFF;                                              //无效牌值的索引
+
+    //按编码计算索引，无效的牌值返回 INVALID_INDEX（编译期生成表用）
+    static constexpr uint8_t makeCardIndex(uint8_t cbCardData) {
+        return (cbCardData & 0x0F) == 0 ? INVALID_INDEX
+             : (cbCardData >> 4) < SUIT_COUNT ? ((cbCardData & 0x0F) <= 9 ? static_cast<uint8_t>((cbCardData >> 4) * 9 + (cbCardData & 0x0F) - 1) : INVALID_INDEX)
+             : (cbCardData >> 4) == HONOR_COLOR ? ((cbCardData & 0x0F) <= HONOR_COUNT ? static_cast<uint8_t>(SUIT_KIND + (cbCardData & 0x0F) - 1) : INVALID_INDEX)
+             : (cbCardData >> 4) == FLOWER_COLOR ? ((cbCardData & 0x0F) <= FLOWER_COUNT ? static_cast<uint8_t>(SUIT_KIND + HONOR_COUNT + (cbCardData & 0x0F) - 1) : INVALID_INDEX)
+             : INVALID_INDEX;
+    }
+
+    //按编码计算牌值（编译期生成表用）
+    static constexpr uint8_t makeCardData(uint8_t cbCardIndex) {
+        return cbCardIndex < SUIT_KIND ? static_cast<uint8_t>(((cbCardIndex / 9) << 4) | (cbCardIndex % 9 + 1))
+             : cbCardIndex < SUIT_KIND + HONOR_COUNT ? static_cast<uint8_t>((HONOR_COLOR << 4) | (cbCardIndex - SUIT_KIND + 1))
+             : static_cast<uint8_t>((FLOWER_COLOR << 4) | (cbCardIndex - SUIT_KIND - HONOR_COUNT + 1));
+    }
+
+    //第 cbPosition 张牌墙的牌：数牌每门 4 排 1~9，字牌 4 排，最后是花牌
+    static constexpr uint8_t makeRepertoryCard(uint8_t cbPosition) {
+        return cbPosition < 4 * SUIT_KIND ? static_cast<uint8_t>(((cbPosition / 36) << 4) | (cbPosition % 9 + 1))
+             : cbPosition < 4 * (SUIT_KIND + HONOR_COUNT) ? static_cast<uint8_t>((HONOR_COLOR << 4) | ((cbPosition - 4 * SUIT_KIND) % (HONOR_COUNT > 0 ? HONOR_COUNT : 1) + 1))
+             : static_cast<uint8_t>((FLOWER_COLOR << 4) | (cbPosition - 4 * (SUIT_KIND + HONOR_COUNT) + 1));
+    }
+
+private:
+    struct IndexOf {
+        static constexpr uint8_t value(uint8_t cbCardData) { return makeCardIndex(cbCardData); }
+    };
+    struct DataOf {
+        static constexpr uint8_t value(uint8_t cbCardIndex) { return makeCardData(cbCardIndex); }
+    };
+    struct RepertoryOf {
+        static constexpr uint8_t value(uint8_t cbPosition) { return makeRepertoryCard(cbPosition); }
+    };
+    typedef TileTable<IndexOf, typename MakeTileSequence<256>::type> IndexTable;
+    typedef TileTable<DataOf, typename MakeTileSequence<INDEX_COUNT>::type> DataTable;
+    typedef TileTable<RepertoryOf, typename MakeTileSequence<REPERTORY_COUNT>::type> RepertoryTable;
+
+public:
+    //牌值 -> 索引（查表）
+    static constexpr uint8_t switchToCardIndex(uint8_t cbCardData) {
+        return IndexTable::s_cbValue[cbCardData];
+    }
+
+    //索引 -> 牌值（查表）
+    static constexpr uint8_t switchToCardData(uint8_t cbCardIndex) {
+        return DataTable::s_cbValue[cbCardIndex];
+    }
+
+    static constexpr bool isValidCard(uint8_t cbCardData) {
+        return IndexTable::s_cbValue[cbCardData] != INVALID_INDEX;
+    }
+
+    //整副牌（未洗）
+    static constexpr const uint8_t *repertory() {
+        return RepertoryTable::s_cbValue;
+    }
+
+    //检查编码：每个索引的牌值有效，索引 -> 牌值 -> 索引 还原
+    static constexpr bool checkIndex(uint8_t cbCardIndex = 0) {
+        return cbCardIndex == INDEX_COUNT
+               || (isValidCard(switchToCardData(cbCardIndex))
+                   && switchToCardIndex(switchToCardData(cbCardIndex)) == cbCardIndex
+                   && checkIndex(static_cast<uint8_t>(cbCardIndex + 1)));
+    }
+
+    //检查编码：有效的牌值恰好 INDEX_COUNT 个，牌值 -> 索引 -> 牌值 还原
+    static constexpr uint16_t countValid(uint16_t wCardData = 0) {
+        return wCardData == 256 ? 0
+             : static_cast<uint16_t>((isValidCard(static_cast<uint8_t>(wCardData))
+                                      && switchToCardData(switchToCardIndex(static_cast<uint8_t>(wCardData))) == wCardData ? 1 : 0)
+                                     + countValid(static_cast<uint16_t>(wCardData + 1)));
+    }
+
+    //检查牌墙：每张都是有效的牌（每种张数由测试检查）
+    static constexpr bool checkRepertory(uint8_t cbPosition = 0) {
+        return cbPosition == REPERTORY_COUNT
+               || (isValidCard(repertory()[cbPosition]) && checkRepertory(static_cast<uint8_t>(cbPosition + 1)));
+    }
+
+    /**
+     * 洗牌（Fisher–Yates），取整副牌的前 cbMaxCount 张
+     * @param cbCardData
+     * @param cbMaxCount
+     * @param Random
+     */
+    static void shuffle(uint8_t cbCardData[], uint8_t cbMaxCount, GameRandom &Random) {
+        for (uint8_t i = 0; i < cbMaxCount; i++) {
+            cbCardData[i] = repertory()[i];
+        }
+        for (uint8_t i = static_cast<uint8_t>(cbMaxCount - 1); i > 0; i--) {
+            uint8_t cbPosition = static_cast<uint8_t>(Random.nextBounded(static_cast<uint32_t>(i) + 1));
+            uint8_t cbTemp = cbCardData[i];
+            cbCardData[i] = cbCardData[cbPosition];
+            cbCardData[cbPosition] = cbTemp;
+        }
+    }
+};
+
+template <uint8_t S, uint8_t H, uint8_t F> constexpr uint8_t TileSet<S, H, F>::SUIT_KIND;
+template <uint8_t S, uint8_t H, uint8_t F> constexpr uint8_t TileSet<S, H, F>::INDEX_COUNT;
+template <uint8_t S, uint8_t H, uint8_t F> constexpr uint8_t TileSet<S, H, F>::REPERTORY_COUNT;
+template <uint8_t S, uint8_t H, uint8_t F> constexpr uint8_t TileSet<S, H, F>::HONOR_COLOR;
+template <uint8_t S, uint8_t H, uint8_t F> constexpr uint8_t TileSet<S, H, F>::FLOWER_COLOR;
+template <uint8_t S, uint8_t H, uint8_t F> constexpr uint8_t TileSet<S, H, F>::INVALID_INDEX;
+
+typedef TileSet<3, 7, 0> StandardTileSet;      //标准 136 张（筒、万、条、字）
+typedef TileSet<3, 0, 0> SuitTileSet;          //无字牌 108 张
+typedef TileSet<3, 7, 8> FlowerTileSet;        //带花牌 144 张
+
+static_assert(StandardTileSet::INDEX_COUNT == 34 && StandardTileSet::REPERTORY_COUNT == 136, "标准牌组 34 种 136 张");
+static_assert(SuitTileSet::INDEX_COUNT == 27 && SuitTileSet::REPERTORY_COUNT == 108, "无字牌 27 种 108 张");
+static_assert(FlowerTileSet::INDEX_COUNT == 42 && FlowerTileSet::REPERTORY_COUNT == 144, "带花牌 42 种 144 张");
+
+static_assert(StandardTileSet::switchToCardIndex(0x01) == 0 && StandardTileSet::switchToCardIndex(0x19) == 17
+              && StandardTileSet::switchToCardIndex(0x29) == 26 && StandardTileSet::switchToCardIndex(0x37) == 33, "标准牌组索引");
+static_assert(StandardTileSet::switchToCardData(9) == 0x11 && StandardTileSet::switchToCardData(27) == 0x31, "标准牌组牌值");
+static_assert(!StandardTileSet::isValidCard(0x00) && !StandardTileSet::isValidCard(0x0A)
+              && !StandardTileSet::isValidCard(0x38) && !StandardTileSet::isValidCard(0x41), "标准牌组无效牌值");
+static_assert(!SuitTileSet::isValidCard(0x31) && FlowerTileSet::switchToCardIndex(0x48) == 41, "无字牌、带花牌");
+
+static_assert(StandardTileSet::checkIndex() && StandardTileSet::countValid() == StandardTileSet::INDEX_COUNT, "标准牌组编码");
+static_assert(SuitTileSet::checkIndex() && SuitTileSet::countValid() == SuitTileSet::INDEX_COUNT, "无字牌编码");
+static_assert(FlowerTileSet::checkIndex() && FlowerTileSet::countValid() == FlowerTileSet::INDEX_COUNT, "带花牌编码");
+
+static_assert(StandardTileSet::checkRepertory() && SuitTileSet::checkRepertory() && FlowerTileSet::checkRepertory(), "牌墙");
+static_assert(StandardTileSet::repertory()[0] == 0x01 && StandardTileSet::repertory()[36] == 0x11
+              && StandardTileSet::repertory()[108] == 0x31 && StandardTileSet::repertory()[135] == 0x37, "标准牌墙排列");
+
+#endif //COCOSTUDIO_MAHJONG_TILESET_H
@@ -0,0 +1,153 @@
+//
+// TingCache.cpp
+// 等牌缓存实现
+//
+
+#include "TingCache.h"
+#include "HuTable.h"
+
+#include <cstring>
+
+namespace {
+    //第 cbSuit 门的种类数
+    inline uint8_t suitSize(uint8_t cbSuit) {
+        return static_cast<uint8_t>(cbSuit < 3 ? HuTable::SUIT_SIZE : HuTable::HONOR_SIZE);
+    }
+}
+
+TingCache::TingCache() : m_llHitCount(0), m_llPartialCount(0), m_llFullCount(0) {
+    reset();
+}
+
+void TingCache::reset() {
+    //值初始化：各字段清零（PackedHand 有构造函数，不能整块 memset）
+    for (uint8_t i = 0; i < GAME_PLAYER; i++) {
+        m_Seat[i] = tagSeat();
+    }
+}
+
+/**
+ * 更新座位的等牌：与上次相比只重查变化的花色，再合成 34 种候选牌
+ * @param cbChairID
+ * @param cbCardIndex
+ * @param WeaveItem
+ * @param cbWeaveCount
+ * @return
+ */
+uint64_t TingCache::update(uint8_t cbChairID, const uint8_t *cbCardIndex, const tagWeaveItem *WeaveItem, uint8_t cbWeaveCount) {
+    tagSeat &Seat = m_Seat[cbChairID];
+    PackedHand Hand(cbCardIndex);
+    uint8_t cbWeaveColor = 0;
+    for (uint8_t i = 0; i < cbWeaveCount; i++) {
+        cbWeaveColor |= static_cast<uint8_t>(1 << ((WeaveItem[i].cbCenterCard & MASK_COLOR) >> 4));
+    }
+    if (Seat.bValid && Seat.Hand == Hand && Seat.cbWeaveCount == cbWeaveCount && Seat.cbWeaveColor == cbWeaveColor) {
+        m_llHitCount++;
+        return Seat.llHuMask;
+    }
+    uint8_t cbChanged = 0;
+    for (uint8_t g = 0; g < 4; g++) {
+        if (!Seat.bValid || Seat.Hand.suitBits(g) != Hand.suitBits(g)) {
+            cbChanged |= static_cast<uint8_t>(1 << g);
+        }
+    }
+    if (Seat.bValid) {
+        m_llPartialCount++;
+    } else {
+        m_llFullCount++;
+    }
+    Seat.bValid = true;
+    Seat.Hand = Hand;
+    Seat.cbWeaveCount = cbWeaveCount;
+    Seat.cbWeaveColor = cbWeaveColor;
+    for (uint8_t g = 0; g < 4; g++) {
+        if (cbChanged & (1 << g)) refreshSuit(Seat, g);
+    }
+    Seat.llHuMask = combineMask(Seat);
+    return Seat.llHuMask;
+}
+
+/**
+ * 重查一门：原样以及该门每种牌各加一张的表项
+ * @param Seat
+ * @param cbSuit
+ */
+void TingCache::refreshSuit(tagSeat &Seat, uint8_t cbSuit) {
+    const HuTable &table = HuTable::instance();
+    uint32_t cbBits = Seat.Hand.suitBits(cbSuit);
+    uint8_t cbSum = 0;
+    Seat.cbEntry[cbSuit] = table.suitEntry(cbSuit, cbBits, Seat.cbSum[cbSuit]);
+    uint8_t cbBegin = static_cast<uint8_t>(cbSuit * HuTable::SUIT_SIZE);
+    for (uint8_t i = 0; i < suitSize(cbSuit); i++) {
+        uint8_t cbShift = static_cast<uint8_t>(PackedHand::FIELD_BITS * i);
+        //已有 4 张的牌不能再摸进，combineMask 中跳过
+        if (((cbBits >> cbShift) & 7) >= 4) {
+            Seat.cbPlusEntry[cbBegin + i] = 0;
+            continue;
+        }
+        Seat.cbPlusEntry[cbBegin + i] = table.suitEntry(cbSuit, cbBits + (1U << cbShift), cbSum);
+    }
+}
+
+/**
+ * 合成等牌掩码，判定与 GameLogic::analyseHuCard 的 huRight 一致：
+ * 平胡（有含顺子的拆法）、碰碰胡（全刻子拆法，且至少有一个刻子或组合）、清一色（一种花色且能拆完或七对）、
+ * 七对（无组合且没有 1、3 张的牌）
+ * @param Seat
+ * @return
+ */
+uint64_t TingCache::combineMask(const tagSeat &Seat) const {
+    uint64_t llHuMask = 0;
+    for (uint8_t j = 0; j < MAX_INDEX; j++) {
+        if (Seat.Hand.count(j) >= 4) continue;
+        uint8_t cbSuit = static_cast<uint8_t>(j / HuTable::SUIT_SIZE);
+        uint8_t cbEntry[4], cbSum[4];
+        memcpy(cbEntry, Seat.cbEntry, sizeof(cbEntry));
+        memcpy(cbSum, Seat.cbSum, sizeof(cbSum));
+        cbEntry[cbSuit] = Seat.cbPlusEntry[j];
+        cbSum[cbSuit]++;
+        uint8_t cbTotal = static_cast<uint8_t>(cbSum[0] + cbSum[1] + cbSum[2] + cbSum[3]);
+
+        uint8_t cbFlags = 0;
+        if (HuTable::checkSums(cbSum) && Seat.cbWeaveCount + (cbTotal - 2) / 3 <= MAX_WEAVE) {
+            cbFlags = HuTable::combine(cbEntry, cbSum);
+        }
+        //平胡、碰碰胡
+        bool bHu = (cbFlags & HU_WITH_SEQUENCE) != 0 || ((cbFlags & HU_ALL_TRIPLET) != 0 && (Seat.cbWeaveCount > 0 || cbTotal > 2));
+        //清一色、七对需要具体张数
+        if (!bHu) {
+            PackedHand Hand = Seat.Hand;
+            Hand.add(j);
+            uint8_t cbColor = Seat.cbWeaveColor;
+            for (uint8_t g = 0; g < 4; g++) {
+                if (cbSum[g] != 0) cbColor |= static_cast<uint8_t>(1 << g);
+            }
+            bool bSingleColor = (cbColor & (cbColor - 1)) == 0;
+            if (bSingleColor) {
+                bHu = (cbFlags & HU_COMPLETE) != 0 || (Seat.cbWeaveCount == 0 && Hand.countEqual(2) == 7);
+            }
+            if (!bHu && Seat.cbWeaveCount == 0) {
+                bHu = Hand.countEqual(1) == 0 && Hand.countEqual(3) == 0;
+            }
+        }
+        if (bHu) llHuMask |= 1ULL << j;
+    }
+    return llHuMask;
+}
+
+/**
+ * 等牌列表
+ * @param cbChairID
+ * @param cbTingCard
+ * @return
+ */
+uint8_t TingCache::getTingCard(uint8_t cbChairID, uint8_t *cbTingCard) const {
+    uint8_t cbCount = 0;
+    uint64_t llHuMask = m_Seat[cbChairID].llHuMask;
+    for (uint8_t j = 0; j < MAX_INDEX; j++) {
+        if ((llHuMask >> j) & 1) {
+            cbTingCard[cbCount++] = static_cast<uint8_t>(((j / 9) << 4) | (j % 9 + 1));
+        }
+    }
+    return cbCount;
+}
@@ -0,0 +1,67 @@
+//
+// TingCache.h
+// 每个座位的等牌缓存：记录 3n+1 张手牌摸进哪些牌可以胡，出牌、摸牌、碰杠后增量更新
+//
+
+#ifndef COCOSTUDIO_MAHJONG_TINGCACHE_H
+#define COCOSTUDIO_MAHJONG_TINGCACHE_H
+
+#include "GameCmd.h"
+#include "GameLogic.h"
+#include "PackedHand.h"
+
+class TingCache {
+public:
+    TingCache();
+
+    void reset();   //清空全部座位（开局、对象池复用），统计次数保留
+
+    /**
+     * 更新座位的等牌
+     * @param cbChairID 座位
+     * @param cbCardIndex 手牌（3n+1 张）
+     * @param WeaveItem 碰、杠组合
+     * @param cbWeaveCount 组合数量
+     * @return 等牌掩码，第 j 位为 1 表示摸进或别人打出第 j 种牌可以胡
+     */
+    uint64_t update(uint8_t cbChairID, const uint8_t cbCardIndex[MAX_INDEX], const tagWeaveItem WeaveItem[], uint8_t cbWeaveCount);
+
+    uint64_t getHuMask(uint8_t cbChairID) const {
+        return m_Seat[cbChairID].llHuMask;
+    }
+
+    //上次 update 的手牌能否胡第 cbCardIndex 种牌
+    bool canHu(uint8_t cbChairID, uint8_t cbCardIndex) const {
+        return (m_Seat[cbChairID].llHuMask >> cbCardIndex) & 1;
+    }
+
+    //等牌列表（扑克数据），返回数量
+    uint8_t getTingCard(uint8_t cbChairID, uint8_t cbTingCard[MAX_INDEX]) const;
+
+    //统计：手牌未变直接返回 / 只重查部分花色 / 全部重查 的次数
+    uint64_t getHitCount() const { return m_llHitCount; }
+    uint64_t getPartialCount() const { return m_llPartialCount; }
+    uint64_t getFullCount() const { return m_llFullCount; }
+
+private:
+    struct tagSeat {
+        bool bValid;                            //是否已计算
+        PackedHand Hand;                        //上次的手牌
+        uint8_t cbWeaveCount;                   //上次的组合数量
+        uint8_t cbWeaveColor;                   //组合的花色（第 g 位表示有第 g 门）
+        uint8_t cbEntry[4];                     //各门原样的表项
+        uint8_t cbSum[4];                       //各门张数
+        uint8_t cbPlusEntry[MAX_INDEX];         //该门加一张第 j 种牌后的表项
+        uint64_t llHuMask;                      //等牌掩码
+    };
+
+    tagSeat m_Seat[GAME_PLAYER];
+    uint64_t m_llHitCount;
+    uint64_t m_llPartialCount;
+    uint64_t m_llFullCount;
+
+    void refreshSuit(tagSeat &Seat, uint8_t cbSuit);
+    uint64_t combineMask(const tagSeat &Seat) const;
+};
+
+#endif //COCOSTUDIO_MAHJONG_TINGCACHE_H
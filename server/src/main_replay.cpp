@@ -0,0 +1,159 @@
+//
+// main_replay.cpp
+// 牌局回放：读取服务器的牌局记录（MAHJONG_RECORD_FILE），每局重新送进 GameEngine，核对每条命令产生的事件
+//
+// 用法：mahjong_replay 记录文件 [房间号] [重复次数]
+//
+// 说明：
+// - 不指定房间号（或为 -）时回放全部牌局，只输出不一致的局和汇总；指定房间号时只回放该房间，
+//   并逐条打印命令和回放产生的事件，用于核查有争议的牌局；
+// - 重复次数用于测速，输出回放耗时、每秒命令数和相对真实时长（各局最后一条命令的时间之和）的倍数；
+// - 有不一致的局时返回非 0。
+//
+
+#include "GameRecord.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+bool readFile(const char *szPath, std::vector<uint8_t> &Data) {
+    FILE *pFile = std::fopen(szPath, "rb");
+    if (pFile == NULL) return false;
+    uint8_t cbBuffer[64 * 1024];
+    size_t cbRead;
+    while ((cbRead = std::fread(cbBuffer, 1, sizeof(cbBuffer), pFile)) > 0) {
+        Data.insert(Data.end(), cbBuffer, cbBuffer + cbRead);
+    }
+    std::fclose(pFile);
+    return true;
+}
+
+void printEvents(const GameEventBuffer &Events) {
+    for (uint8_t n = 0; n < Events.size(); n++) {
+        const tagGameEvent &Event = Events[n];
+        std::printf("    -> 座位 %3u ", Event.cbChairID);
+        switch (Event.cbKind) {
+            case GameEvent_GameStart:
+                std::printf("开始 骰子 %u 庄家 %u 剩余 %u\n", Event.GameStart.iDiceCount, Event.GameStart.cbBankerUser, Event.GameStart.cbLeftCardCount);
+                break;
+            case GameEvent_SendCard:
+                std::printf("发牌 0x%02x 给 %u 动作 0x%02x%s\n", Event.SendCard.cbCardData, Event.SendCard.cbCurrentUser,
+                            Event.SendCard.cbActionMask, Event.SendCard.bTail ? " 杠后" : "");
+                break;
+            case GameEvent_OutCard:
+                std::printf("出牌 %u 打出 0x%02x\n", Event.OutCard.cbOutCardUser, Event.OutCard.cbOutCardData);
+                break;
+            case GameEvent_OperateNotify:
+                std::printf("操作通知 动作 0x%02x 牌 0x%02x\n", Event.OperateNotify.cbActionMask, Event.OperateNotify.cbActionCard);
+                break;
+            case GameEvent_OperateResult:
+                std::printf("操作结果 %u 代码 0x%02x 牌 0x%02x 供牌 %u\n", Event.OperateResult.cbOperateUser, Event.OperateResult.cbOperateCode,
+                            Event.OperateResult.cbOperateCard, Event.OperateResult.cbProvideUser);
+                break;
+            case GameEvent_GameEnd:
+                std::printf("结束 胡牌 0x%02x 积分 %lld %lld %lld %lld\n", Event.GameEnd.cbHuUser,
+                            static_cast<long long>(Event.GameEnd.lGameScore[0]), static_cast<long long>(Event.GameEnd.lGameScore[1]),
+                            static_cast<long long>(Event.GameEnd.lGameScore[2]), static_cast<long long>(Event.GameEnd.lGameScore[3]));
+                break;
+            default:
+                std::printf("未知事件 %u\n", Event.cbKind);
+                break;
+        }
+    }
+}
+
+//逐条回放并打印，返回是否一致
+bool dumpSegment(GameEngine &Engine, const tagRecordHeader &Header, const tagRecordEntry *pEntries) {
+    std::printf("[%s] 开局 %llu 种子 0x%016llx 庄家 %u 座位 %u 机器人 0x%x 命令 %u%s%s\n", Header.szRoomId,
+                static_cast<unsigned long long>(Header.llStartTime), static_cast<unsigned long long>(Header.llGameSeed),
+                Header.cbBankerUser, Header.cbPlayerCount, Header.cbAndroidMask, Header.wEntryCount,
+                (Header.cbFlags & RecordFlag_Ended) != 0 ? "" : " 未结束", (Header.cbFlags & RecordFlag_Truncated) != 0 ? " 已截断" : "");
+    GameRecord::prepare(Engine, Header);
+    GameEventBuffer Events;
+    Engine.apply(GameRecord::makeStart(Header), Events);
+    bool bMatch = GameRecord::hashEvents(Events, 0) == Header.dwStartHash;
+    printEvents(Events);
+    for (uint16_t n = 0; n < Header.wEntryCount && bMatch; n++) {
+        const tagRecordEntry &Entry = pEntries[n];
+        static const char *szKind[] = {"开始", "出牌", "操作", "结束"};
+        std::printf("  %6u ms 座位 %u %s 代码 0x%02x 牌 0x%02x\n", Entry.dwTime, Entry.cbChairID,
+                    Entry.cbKind <= GameCommand_Conclude ? szKind[Entry.cbKind] : "?", Entry.cbOperateCode, Entry.cbCardData);
+        Events.clear();
+        Engine.apply(GameRecord::makeCommand(Entry), Events);
+        bMatch = GameRecord::hashEvents(Events, 0) == Entry.dwEventHash;
+        printEvents(Events);
+    }
+    std::printf("  %s\n", bMatch ? "一致" : "不一致：上面最后一条命令产生的事件与记录不同");
+    return bMatch;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::fprintf(stderr, "用法：%s 记录文件 [房间号] [重复次数]\n", argv[0]);
+        return 2;
+    }
+    std::string roomId = argc > 2 ? argv[2] : "-";
+    int iRepeat = argc > 3 ? std::atoi(argv[3]) : 1;
+    if (iRepeat < 1) iRepeat = 1;
+    std::vector<uint8_t> Data;
+    if (!readFile(argv[1], Data)) {
+        std::fprintf(stderr, "[mahjong_replay] 无法读取 %s\n", argv[1]);
+        return 2;
+    }
+
+    std::cout.setstate(std::ios::failbit);      //引擎每局结束会打日志
+    GameEngine engine;
+    engine.setQuiet(true);
+    uint64_t llSegments = 0, llCommands = 0, llMismatch = 0, llUnfinished = 0, llRecordedMs = 0;
+    size_t Offset = 0;
+    const tagRecordHeader *pHeader = NULL;
+    const tagRecordEntry *pEntries = NULL;
+    std::chrono::steady_clock::time_point Begin = std::chrono::steady_clock::now();
+    for (int r = 0; r < iRepeat; r++) {
+        Offset = 0;
+        while (GameRecord::nextSegment(Data.data(), Data.size(), Offset, pHeader, pEntries)) {
+            if (roomId != "-" && roomId != pHeader->szRoomId) continue;
+            bool bMatch;
+            if (roomId != "-" && r == 0) {
+                bMatch = dumpSegment(engine, *pHeader, pEntries);
+                llCommands += pHeader->wEntryCount + 1;
+            } else {
+                tagReplayResult Result;
+                bMatch = GameRecord::replay(engine, *pHeader, pEntries, Result);
+                llCommands += Result.dwCommands;
+                if (!bMatch && r == 0) {
+                    std::printf("[%s] 开局 %llu 种子 0x%016llx 不一致：第 %d 条命令（-1 为开始）\n", pHeader->szRoomId,
+                                static_cast<unsigned long long>(pHeader->llStartTime),
+                                static_cast<unsigned long long>(pHeader->llGameSeed), Result.iMismatch);
+                }
+            }
+            if (r > 0) continue;
+            llSegments++;
+            if (!bMatch) llMismatch++;
+            if ((pHeader->cbFlags & RecordFlag_Ended) == 0) llUnfinished++;
+            if (pHeader->wEntryCount > 0) llRecordedMs += pEntries[pHeader->wEntryCount - 1].dwTime;
+        }
+    }
+    double dElapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - Begin).count();
+    std::cout.clear();
+
+    std::printf("[mahjong_replay] %llu 局，不一致 %llu 局，未结束 %llu 局，%llu 条命令（重复 %d 次）\n",
+                static_cast<unsigned long long>(llSegments), static_cast<unsigned long long>(llMismatch),
+                static_cast<unsigned long long>(llUnfinished), static_cast<unsigned long long>(llCommands), iRepeat);
+    if (Offset < Data.size()) {
+        std::printf("文件末尾 %zu 字节不是完整的段，已忽略\n", Data.size() - Offset);
+    }
+    std::printf("回放耗时 %.3f 秒，%.0f 条命令/秒，真实时长 %.1f 秒，快 %.0f 倍\n", dElapsed,
+                dElapsed > 0 ? llCommands / dElapsed : 0.0, llRecordedMs / 1000.0,
+                dElapsed > 0 ? llRecordedMs / 1000.0 * iRepeat / dElapsed : 0.0);
+    return llMismatch == 0 ? 0 : 1;
+}
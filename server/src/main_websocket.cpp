@@ -8,35 +8,212 @@
 //
 
 #include "WebSocketServer.h"
+#include "LockStats.h"
+#include "MatchHistory.h"
+#include "Leaderboard.h"
+#include "ProfileCache.h"
 #include "MessageHandler.h"
 #include "Room.h"
+#include "RoomDirectory.h"
+#include "RoomJournal.h"
+#include "ThreadPlacement.h"
+#include "RecordWriter.h"
+#ifdef MAHJONG_COROUTINES
+#include "SessionServer.h"
+#endif
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
 #include <iostream>
 #include <memory>
-#include <map>
+#include <vector>
 
 int main() {
     const int kServerPort = 5555;
     
-    WebSocketServer server;
+    // 线程绑核与 NUMA 放置（环境变量 MAHJONG_CPU_AFFINITY=1 开启）
+    PlacementConfig placement = PlacementConfig::fromEnvironment();
+    if (placement.enabled) {
+        std::cout << "[mahjong_server] 已启用绑核与 NUMA 放置，节点数 " << ThreadPlacement::nodeCount() << std::endl;
+    }
+    
+    // 锁竞争统计（CMake 选项 MAHJONG_LOCK_STATS=ON 时编译）：kill -USR2 <pid> 写出报告，
+    // 文件路径可用环境变量 MAHJONG_LOCK_STATS_FILE 指定
+    if (LockStats::enabled()) {
+        const char* lockStatsFile = std::getenv("MAHJONG_LOCK_STATS_FILE");
+        LockStats::installDumpSignal(SIGUSR2, lockStatsFile != nullptr ? lockStatsFile : "lock_stats.txt");
+    }
+    
+    // 牌局记录（环境变量 MAHJONG_RECORD_FILE 指定文件时开启）：每局的种子和命令追加到该文件，
+    // 用 mahjong_replay 回放核对；写入器先于房间创建、后于房间销毁，房间回收时写出的段都能落盘
+    std::unique_ptr<RecordWriter> recordWriter;
+    const char* recordFile = std::getenv("MAHJONG_RECORD_FILE");
+    if (recordFile != nullptr && recordFile[0] != '\0') {
+        recordWriter.reset(new RecordWriter(recordFile));
+        if (recordWriter->isOpen()) {
+            std::cout << "[mahjong_server] 牌局记录写入 " << recordFile << std::endl;
+        } else {
+            recordWriter.reset();
+        }
+    }
+    
+    // 崩溃恢复日志（环境变量 MAHJONG_JOURNAL_FILE 指定路径前缀时开启）：开桌、种子和每条命令写进内存映射的日志，
+    // 重启时按日志重建进行中的牌局，玩家重新 join_room 即可继续。MAHJONG_JOURNAL_SYNC 为 none / interval / always
+    // （默认 interval，间隔 MAHJONG_JOURNAL_SYNC_MS 毫秒，默认 10），MAHJONG_JOURNAL_CHECKPOINT_S 为检查点间隔（默认 60 秒）
+    std::unique_ptr<RoomJournal> journal;
+    std::vector<RecoveredRoom> recoveredRooms;
+    std::chrono::milliseconds checkpointInterval(std::chrono::seconds(60));
+    const char* journalFile = std::getenv("MAHJONG_JOURNAL_FILE");
+    if (journalFile != nullptr && journalFile[0] != '\0') {
+        RoomJournal::Config journalConfig;
+        journalConfig.path = journalFile;
+        const char* syncEnv = std::getenv("MAHJONG_JOURNAL_SYNC");
+        if (syncEnv != nullptr && std::string(syncEnv) == "none") {
+            journalConfig.sync = JournalSync::None;
+        } else if (syncEnv != nullptr && std::string(syncEnv) == "always") {
+            journalConfig.sync = JournalSync::Always;
+        }
+        const char* syncMsEnv = std::getenv("MAHJONG_JOURNAL_SYNC_MS");
+        if (syncMsEnv != nullptr) {
+            journalConfig.syncInterval = std::chrono::milliseconds(std::atol(syncMsEnv));
+        }
+        const char* checkpointEnv = std::getenv("MAHJONG_JOURNAL_CHECKPOINT_S");
+        if (checkpointEnv != nullptr) {
+            checkpointInterval = std::chrono::seconds(std::atol(checkpointEnv));
+        }
+        journal.reset(new RoomJournal(journalConfig));
+        RecoveryStats recovery;
+        if (journal->open(recoveredRooms, &recovery)) {
+            std::cout << "[mahjong_server] 崩溃恢复日志 " << journalFile << "：重放 " << recovery.commands << " 条命令，恢复 "
+                      << recovery.rooms << " 个房间，耗时 " << recovery.seconds * 1000 << " ms" << std::endl;
+        } else {
+            journal.reset();
+        }
+    }
+    
+    // 对局历史（环境变量 MAHJONG_HISTORY_FILE 指定路径前缀时开启）：每局的结算结果按列写进内存映射的段文件，
+    // 可按玩家查询历史和积分、按时间统计胡牌规则
+    std::unique_ptr<MatchHistory> matchHistory;
+    const char* historyFile = std::getenv("MAHJONG_HISTORY_FILE");
+    if (historyFile != nullptr && historyFile[0] != '\0') {
+        MatchHistory::Config historyConfig;
+        historyConfig.path = historyFile;
+        matchHistory.reset(new MatchHistory(historyConfig));
+        if (!matchHistory->open()) {
+            matchHistory.reset();
+        }
+    }
+    
+    // 排行榜（环境变量 MAHJONG_LEADERBOARD_FILE 指定快照文件时开启）：按单局积分累加总榜、日榜和周榜，
+    // 每隔 MAHJONG_LEADERBOARD_SNAPSHOT_S 秒（默认 60）写一次快照
+    std::unique_ptr<Leaderboard> leaderboard;
+    const char* leaderboardFile = std::getenv("MAHJONG_LEADERBOARD_FILE");
+    if (leaderboardFile != nullptr && leaderboardFile[0] != '\0') {
+        Leaderboard::Config leaderboardConfig;
+        leaderboardConfig.path = leaderboardFile;
+        const char* snapshotEnv = std::getenv("MAHJONG_LEADERBOARD_SNAPSHOT_S");
+        if (snapshotEnv != nullptr) {
+            leaderboardConfig.snapshotInterval = std::chrono::seconds(std::atol(snapshotEnv));
+        }
+        leaderboard.reset(new Leaderboard(leaderboardConfig));
+        if (!leaderboard->open()) {
+            leaderboard.reset();
+        }
+    }
+    
+    // 玩家档案（环境变量 MAHJONG_PROFILE_FILE 指定日志文件时开启）：昵称、累计积分和设置放在分片 LRU 缓存里，
+    // 启动时读日志预热，修改每隔 MAHJONG_PROFILE_FLUSH_MS 毫秒（默认 100）成批追加到日志
+    std::unique_ptr<ProfileCache> profiles;
+    const char* profileFile = std::getenv("MAHJONG_PROFILE_FILE");
+    if (profileFile != nullptr && profileFile[0] != '\0') {
+        ProfileCache::Config profileConfig;
+        profileConfig.path = profileFile;
+        const char* flushEnv = std::getenv("MAHJONG_PROFILE_FLUSH_MS");
+        if (flushEnv != nullptr) {
+            profileConfig.flushInterval = std::chrono::milliseconds(std::atol(flushEnv));
+        }
+        profiles.reset(new ProfileCache(profileConfig));
+        if (!profiles->open()) {
+            profiles.reset();
+        }
+    }
+    
+    // 连接模型：默认每个连接一个线程；MAHJONG_SESSION_MODE=coroutine 时所有连接作为协程运行在一个事件循环上
+    std::unique_ptr<WebSocketServer> serverPtr;
+    PlacementConfig handlerPlacement = placement;
+#ifdef MAHJONG_COROUTINES
+    const char* sessionMode = std::getenv("MAHJONG_SESSION_MODE");
+    if (sessionMode != nullptr && std::string(sessionMode) == "coroutine") {
+        std::cout << "[mahjong_server] 使用协程会话模式" << std::endl;
+        serverPtr.reset(new SessionServer());
+        handlerPlacement.migrateToRoomNode = false;    // 所有连接共用一个事件循环线程，不随房间迁移
+    }
+#endif
+    if (!serverPtr) {
+        serverPtr.reset(new WebSocketServer());
+    }
+    WebSocketServer& server = *serverPtr;
+    server.setPlacement(placement);
     MessageHandler messageHandler(&server);
+    messageHandler.setPlacement(handlerPlacement);
+    messageHandler.setProfileCache(profiles.get());
     
-    // 房间管理：存储所有房间
-    std::map<std::string, std::shared_ptr<Room>> rooms;
+    // 房间管理：分片的并发房间目录，后台线程回收空闲或已结束的房间
+    RoomDirectory::Config roomConfig;
+    roomConfig.numaAware = placement.enabled;
+    RoomDirectory rooms(roomConfig);
+    rooms.startReaper();
+    
+    // 机器人补位：第一位玩家进入后等待 MAHJONG_BOT_FILL_MS 毫秒（默认 15000，0 为不补位）仍未坐满，
+    // 由机器人补齐；MAHJONG_BOT_LEVEL 为 easy / normal / hard，补位和掉线代打共用
+    const char* botFillEnv = std::getenv("MAHJONG_BOT_FILL_MS");
+    std::chrono::milliseconds botFillDelay(botFillEnv != nullptr ? std::atol(botFillEnv) : 15000);
+    const char* botLevelEnv = std::getenv("MAHJONG_BOT_LEVEL");
+    BotLevel botLevel = BotLevel_Normal;
+    if (botLevelEnv != nullptr && std::string(botLevelEnv) == "easy") {
+        botLevel = BotLevel_Easy;
+    } else if (botLevelEnv != nullptr && std::string(botLevelEnv) == "hard") {
+        botLevel = BotLevel_Hard;
+    }
     
-    // 设置房间管理器回调
-    messageHandler.setRoomManager([&rooms](const std::string& roomId) -> std::shared_ptr<Room> {
-        auto it = rooms.find(roomId);
-        if (it != rooms.end()) {
-            return it->second;
+    // 设置房间管理器回调（会被多个客户端线程并发调用）
+    RecordWriter* writer = recordWriter.get();
+    RoomJournal* journalPtr = journal.get();
+    MatchHistory* historyPtr = matchHistory.get();
+    Leaderboard* leaderboardPtr = leaderboard.get();
+    ProfileCache* profilesPtr = profiles.get();
+    messageHandler.setRoomManager([&rooms, botFillDelay, botLevel, writer, journalPtr, historyPtr, leaderboardPtr, profilesPtr](const std::string& roomId) -> std::shared_ptr<Room> {
+        std::shared_ptr<Room> room = rooms.getOrCreate(roomId);
+        if (room) {
+            room->setBotPolicy(botFillDelay, botLevel);
+            room->setRecordWriter(writer);
+            room->setJournal(journalPtr);
+            room->setMatchHistory(historyPtr);
+            room->setLeaderboard(leaderboardPtr);
+            room->setProfileCache(profilesPtr);
         }
-        
-        // 创建新房间
-        auto room = std::make_shared<Room>(roomId);
-        rooms[roomId] = room;
-        std::cout << "[main] 创建新房间: " << roomId << std::endl;
         return room;
     });
     
+    // 按日志重建房间，随即写一次检查点（之前的日志文件随之删除）
+    if (journalPtr != nullptr) {
+        for (size_t i = 0; i < recoveredRooms.size(); i++) {
+            std::shared_ptr<Room> room = rooms.getOrCreate(recoveredRooms[i].roomId);
+            if (room) {
+                room->setBotPolicy(botFillDelay, botLevel);
+                room->setRecordWriter(writer);
+                room->setJournal(journalPtr);
+                room->setMatchHistory(historyPtr);
+                room->setLeaderboard(leaderboardPtr);
+                room->setProfileCache(profilesPtr);
+                room->recoverFromJournal(recoveredRooms[i]);
+            }
+        }
+        recoveredRooms.clear();
+        rooms.setJournal(journalPtr, checkpointInterval);
+        rooms.checkpoint();
+    }
+    
     // 设置连接回调（简化版：连接时不发送消息，等客户端发送 join_room）
     server.onConnect = [](int clientFd) {
         std::cout << "[mahjong_server] 客户端已连接 (fd=" << clientFd << ")" << std::endl;
@@ -67,5 +244,6 @@ int main() {
     server.run();
     
     server.stop();
+    rooms.stopReaper();
     return 0;
 }
@@ -0,0 +1,208 @@
+//
+// EventLoop.cpp
+// 事件循环实现
+//
+
+#include "EventLoop.h"
+
+#include <cstdint>
+#include <iostream>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace {
+const int kMaxEvents = 256;
+}
+
+EventLoop::EventLoop()
+    : epollFd_(::epoll_create1(EPOLL_CLOEXEC))
+    , wakeFd_(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+    , running_(false)
+    , stopRequested_(false)
+    , loopThread_(std::this_thread::get_id()) {
+    if (epollFd_ < 0 || wakeFd_ < 0) {
+        std::perror("[EventLoop] 创建 epoll/eventfd 失败");
+        return;
+    }
+    epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.fd = wakeFd_;
+    ::epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &ev);
+}
+
+EventLoop::~EventLoop() {
+    if (wakeFd_ >= 0) {
+        ::close(wakeFd_);
+    }
+    if (epollFd_ >= 0) {
+        ::close(epollFd_);
+    }
+}
+
+bool EventLoop::add(int fd) {
+    epoll_event ev;
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    ev.data.fd = fd;
+    if (::epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        std::perror("[EventLoop] epoll_ctl ADD 失败");
+        return false;
+    }
+    watches_[fd] = Watch();
+    return true;
+}
+
+void EventLoop::remove(int fd) {
+    ::epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr);
+    auto it = watches_.find(fd);
+    if (it == watches_.end()) {
+        return;
+    }
+    // 还在等待的协程照常恢复，由它们自己发现连接已关闭
+    if (it->second.reader) {
+        schedule(it->second.reader);
+    }
+    if (it->second.writer) {
+        schedule(it->second.writer);
+    }
+    watches_.erase(it);
+}
+
+void EventLoop::waitReadable(int fd, std::coroutine_handle<> handle) {
+    auto it = watches_.find(fd);
+    if (it == watches_.end() || it->second.readReady) {
+        if (it != watches_.end()) {
+            it->second.readReady = false;
+        }
+        schedule(handle);
+        return;
+    }
+    it->second.reader = handle;
+}
+
+void EventLoop::waitWritable(int fd, std::coroutine_handle<> handle) {
+    auto it = watches_.find(fd);
+    if (it == watches_.end() || it->second.writeReady) {
+        if (it != watches_.end()) {
+            it->second.writeReady = false;
+        }
+        schedule(handle);
+        return;
+    }
+    it->second.writer = handle;
+}
+
+void EventLoop::schedule(std::coroutine_handle<> handle) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pendingHandles_.push_back(handle);
+    }
+    if (!inLoopThread()) {
+        wakeup();
+    }
+}
+
+void EventLoop::post(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pendingTasks_.push_back(std::move(task));
+    }
+    if (!inLoopThread()) {
+        wakeup();
+    }
+}
+
+void EventLoop::wakeup() {
+    uint64_t one = 1;
+    ssize_t n = ::write(wakeFd_, &one, sizeof(one));
+    (void)n;
+}
+
+bool EventLoop::inLoopThread() const {
+    return loopThread_ == std::this_thread::get_id();
+}
+
+void EventLoop::run() {
+    loopThread_ = std::this_thread::get_id();
+    running_ = true;
+    while (!stopRequested_) {
+        runOnce(-1);
+    }
+    stopRequested_ = false;
+    running_ = false;
+}
+
+void EventLoop::stop() {
+    stopRequested_ = true;
+    wakeup();
+}
+
+size_t EventLoop::runOnce(int timeoutMs) {
+    {
+        // 还有待恢复的协程时不阻塞
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!pendingHandles_.empty() || !pendingTasks_.empty()) {
+            timeoutMs = 0;
+        }
+    }
+
+    epoll_event events[kMaxEvents];
+    int n = ::epoll_wait(epollFd_, events, kMaxEvents, timeoutMs);
+    for (int i = 0; i < n; i++) {
+        int fd = events[i].data.fd;
+        if (fd == wakeFd_) {
+            uint64_t count = 0;
+            ssize_t r = ::read(wakeFd_, &count, sizeof(count));
+            (void)r;
+            continue;
+        }
+        auto it = watches_.find(fd);
+        if (it == watches_.end()) {
+            continue;
+        }
+        Watch& watch = it->second;
+        // 出错或对端关闭时同时唤醒读写两端，由读写调用返回具体结果
+        bool readable = (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0;
+        bool writable = (events[i].events & (EPOLLOUT | EPOLLHUP | EPOLLERR)) != 0;
+        if (readable) {
+            if (watch.reader) {
+                readyHandles_.push_back(watch.reader);
+                watch.reader = nullptr;
+            } else {
+                watch.readReady = true;
+            }
+        }
+        if (writable) {
+            if (watch.writer) {
+                readyHandles_.push_back(watch.writer);
+                watch.writer = nullptr;
+            } else {
+                watch.writeReady = true;
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        readyHandles_.insert(readyHandles_.end(), pendingHandles_.begin(), pendingHandles_.end());
+        pendingHandles_.clear();
+        readyTasks_.swap(pendingTasks_);
+    }
+
+    for (size_t i = 0; i < readyTasks_.size(); i++) {
+        readyTasks_[i]();
+    }
+    readyTasks_.clear();
+
+    // 恢复过程中新调度的协程进入 pending 队列，下一轮再处理
+    std::vector<std::coroutine_handle<>> handles;
+    handles.swap(readyHandles_);
+    for (size_t i = 0; i < handles.size(); i++) {
+        handles[i].resume();
+    }
+    size_t resumed = handles.size();
+    handles.clear();
+    readyHandles_.swap(handles);    // 保留容量，避免每轮重新分配
+    return resumed;
+}
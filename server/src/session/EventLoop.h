@@ -0,0 +1,74 @@
+//
+// EventLoop.h
+// 基于 epoll 的单线程事件循环，负责恢复挂起在读写就绪上的协程（C++20）
+//
+
+#ifndef SESSION_EVENT_LOOP_H
+#define SESSION_EVENT_LOOP_H
+
+#include <atomic>
+#include <coroutine>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class EventLoop {
+public:
+    EventLoop();
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    bool valid() const { return epollFd_ >= 0 && wakeFd_ >= 0; }
+
+    // 注册/注销文件描述符（fd 需已设为非阻塞）
+    bool add(int fd);
+    void remove(int fd);
+
+    // 等待 fd 可读/可写，就绪后在事件循环中恢复 handle（只能在事件循环线程调用）
+    void waitReadable(int fd, std::coroutine_handle<> handle);
+    void waitWritable(int fd, std::coroutine_handle<> handle);
+
+    // 在事件循环中恢复协程 / 执行任务（线程安全）
+    void schedule(std::coroutine_handle<> handle);
+    void post(std::function<void()> task);
+
+    // 运行事件循环直到 stop()
+    void run();
+    void stop();
+
+    // 处理一轮就绪事件和待恢复的协程，返回恢复的协程数（timeoutMs 为 epoll_wait 的超时）
+    size_t runOnce(int timeoutMs);
+
+    bool inLoopThread() const;
+    bool running() const { return running_; }
+
+private:
+    struct Watch {
+        std::coroutine_handle<> reader;
+        std::coroutine_handle<> writer;
+        bool readReady = false;     // 已就绪但还没有协程等待
+        bool writeReady = false;
+    };
+
+    int epollFd_;
+    int wakeFd_;
+    std::atomic<bool> running_;
+    std::atomic<bool> stopRequested_;
+    std::thread::id loopThread_;
+
+    std::unordered_map<int, Watch> watches_;            // 只在事件循环线程访问
+
+    std::mutex mutex_;                                  // 保护 pending 队列
+    std::vector<std::coroutine_handle<>> pendingHandles_;
+    std::vector<std::function<void()>> pendingTasks_;
+    std::vector<std::coroutine_handle<>> readyHandles_; // 本轮要恢复的协程（事件循环线程私有）
+    std::vector<std::function<void()>> readyTasks_;
+
+    void wakeup();
+};
+
+#endif // SESSION_EVENT_LOOP_H
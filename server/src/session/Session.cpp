@@ -0,0 +1,222 @@
+//
+// Session.cpp
+// 协程会话实现
+//
+
+#include "Session.h"
+#include "SessionServer.h"
+#include "SessionStream.h"
+#include "WebSocketCodec.h"
+
+#include <cerrno>
+#include <iostream>
+
+namespace {
+const size_t kReadChunk = 4096;
+const size_t kMaxHandshake = 8192;          // 握手请求头上限
+const size_t kIdleBufferCapacity = 1024;    // 缓冲区清空后保留的容量上限
+}
+
+Session::Session(SessionServer& server, std::unique_ptr<SessionStream> stream)
+    : server_(server)
+    , stream_(std::move(stream))
+    , outOffset_(0)
+    , activeTasks_(0)
+    , handshaken_(false)
+    , writing_(false)
+    , closed_(false) {
+}
+
+Session::~Session() {
+}
+
+int Session::id() const {
+    return stream_->id();
+}
+
+void Session::start() {
+    readLoop();
+}
+
+SessionTask Session::readLoop() {
+    activeTasks_++;
+    bool ok = true;
+
+    // 握手：读取完整的 HTTP 请求头
+    while (ok && !closed_) {
+        bool done = false;
+        ok = processHandshake(done);
+        if (!ok || done) {
+            break;
+        }
+        ssize_t n = fill();
+        if (n == 0) {
+            ok = false;
+        } else if (n < 0) {
+            co_await Readable{*stream_};
+        }
+    }
+
+    if (ok && handshaken_ && !closed_) {
+        server_.sessionOpened(this);
+        // 客户端可能紧跟握手请求发送了消息帧
+        ok = processFrames();
+        while (ok && !closed_) {
+            ssize_t n = fill();
+            if (n == 0) {
+                break;
+            }
+            if (n < 0) {
+                co_await Readable{*stream_};
+                continue;
+            }
+            ok = processFrames();
+        }
+    }
+
+    bool opened = handshaken_;
+    close();
+    server_.sessionClosed(this, opened);
+    taskFinished();
+}
+
+SessionTask Session::writeLoop() {
+    activeTasks_++;
+    while (!closed_ && outOffset_ < outbox_.size()) {
+        co_await Writable{*stream_};
+        if (closed_) {
+            break;
+        }
+        if (!flush()) {
+            close();
+            break;
+        }
+    }
+    writing_ = false;
+    taskFinished();
+}
+
+ssize_t Session::fill() {
+    char buffer[kReadChunk];
+    ssize_t n = stream_->readSome(buffer, sizeof(buffer));
+    if (n > 0) {
+        inbuf_.append(buffer, static_cast<size_t>(n));
+        return n;
+    }
+    if (n < 0 && errno == EAGAIN) {
+        return -1;
+    }
+    return 0;   // 对端关闭或读取出错
+}
+
+bool Session::processHandshake(bool& done) {
+    done = false;
+    size_t end = inbuf_.find("\r\n\r\n");
+    if (end == std::string::npos) {
+        return inbuf_.size() <= kMaxHandshake;
+    }
+
+    std::string key = WebSocketCodec::extractKey(inbuf_.substr(0, end + 4));
+    if (key.empty()) {
+        std::cout << "[Session] 未找到 Sec-WebSocket-Key，拒绝连接 (id=" << id() << ")" << std::endl;
+        return false;
+    }
+    inbuf_.erase(0, end + 4);
+    outbox_.append(WebSocketCodec::handshakeResponse(key));
+    handshaken_ = true;
+    done = true;
+    if (!flush()) {
+        return false;
+    }
+    if (outOffset_ < outbox_.size() && !writing_) {
+        writing_ = true;
+        writeLoop();
+    }
+    return true;
+}
+
+bool Session::processFrames() {
+    size_t offset = 0;
+    std::string payload;
+    bool ok = true;
+    while (ok && !closed_) {
+        int opcode = 0;
+        long consumed = WebSocketCodec::decodeFrame(inbuf_.data() + offset, inbuf_.size() - offset, opcode, payload);
+        if (consumed == 0) {
+            break;
+        }
+        if (consumed < 0) {
+            std::cout << "[Session] 帧格式错误，关闭连接 (id=" << id() << ")" << std::endl;
+            ok = false;
+            break;
+        }
+        offset += static_cast<size_t>(consumed);
+        if (opcode == WebSocketCodec::kOpcodeClose) {
+            ok = false;
+        } else if (opcode == WebSocketCodec::kOpcodeText) {
+            server_.sessionMessage(this, payload);
+        }
+    }
+    if (closed_) {
+        return false;
+    }
+    inbuf_.erase(0, offset);
+    if (inbuf_.empty() && inbuf_.capacity() > kIdleBufferCapacity) {
+        std::string().swap(inbuf_);
+    }
+    return ok;
+}
+
+bool Session::sendText(const std::string& text) {
+    if (closed_) {
+        return false;
+    }
+    WebSocketCodec::appendTextFrame(text, outbox_);
+    if (writing_) {
+        return true;    // 写协程会继续发送
+    }
+    if (!flush()) {
+        close();
+        return false;
+    }
+    if (outOffset_ < outbox_.size()) {
+        writing_ = true;
+        writeLoop();
+    }
+    return true;
+}
+
+bool Session::flush() {
+    while (outOffset_ < outbox_.size()) {
+        ssize_t n = stream_->writeSome(outbox_.data() + outOffset_, outbox_.size() - outOffset_);
+        if (n > 0) {
+            outOffset_ += static_cast<size_t>(n);
+        } else if (n < 0 && errno == EAGAIN) {
+            return true;
+        } else {
+            return false;
+        }
+    }
+    outOffset_ = 0;
+    if (outbox_.capacity() > kIdleBufferCapacity) {
+        std::string().swap(outbox_);
+    } else {
+        outbox_.clear();
+    }
+    return true;
+}
+
+void Session::close() {
+    if (closed_) {
+        return;
+    }
+    closed_ = true;
+    stream_->close();
+}
+
+void Session::taskFinished() {
+    // 读写协程都结束后释放会话（之后不能再访问成员）
+    if (--activeTasks_ == 0 && closed_) {
+        delete this;
+    }
+}
@@ -0,0 +1,73 @@
+//
+// Session.h
+// 协程会话：一个连接的完整生命周期（握手 → 消息循环 → 断开）写成一个协程（C++20）
+//
+
+#ifndef SESSION_SESSION_H
+#define SESSION_SESSION_H
+
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <string>
+
+class SessionServer;
+class SessionStream;
+
+// 即发即弃的协程：立即开始执行，结束时自动释放协程帧
+struct SessionTask {
+    struct promise_type {
+        SessionTask get_return_object() noexcept { return SessionTask(); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+class Session {
+public:
+    Session(SessionServer& server, std::unique_ptr<SessionStream> stream);
+    ~Session();
+
+    int id() const;
+
+    // 启动读协程
+    void start();
+
+    // 发送文本消息（在事件循环线程调用）
+    bool sendText(const std::string& text);
+
+    // 主动关闭连接，读写协程随后结束
+    void close();
+
+private:
+    SessionServer& server_;
+    std::unique_ptr<SessionStream> stream_;
+    std::string inbuf_;         // 已读取、尚未解码的数据
+    std::string outbox_;        // 待发送的数据
+    size_t outOffset_;
+    int activeTasks_;           // 正在运行的协程数
+    bool handshaken_;
+    bool writing_;              // 写协程是否在运行
+    bool closed_;
+
+    SessionTask readLoop();
+    SessionTask writeLoop();
+
+    // 从流中读取一次：返回 >0 已读字节数，0 连接关闭，-1 暂无数据
+    ssize_t fill();
+
+    // 处理 inbuf_ 中的握手请求，返回 false 表示握手失败
+    bool processHandshake(bool& done);
+
+    // 解码并分发 inbuf_ 中的完整帧，返回 false 表示连接应关闭
+    bool processFrames();
+
+    // 尽量直接写出发件箱，返回 false 表示写入出错
+    bool flush();
+
+    void taskFinished();
+};
+
+#endif // SESSION_SESSION_H
@@ -0,0 +1,190 @@
+//
+// SessionServer.cpp
+// 协程会话服务器实现
+//
+
+#include "SessionServer.h"
+#include "EventLoop.h"
+#include "Session.h"
+#include "SessionStream.h"
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// 监听套接字上的 accept 协程
+struct SessionAcceptor {
+    // 等待监听套接字可读
+    struct Acceptable {
+        EventLoop& loop;
+        int fd;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) { loop.waitReadable(fd, handle); }
+        void await_resume() const noexcept {}
+    };
+
+    static SessionTask run(SessionServer& server) {
+        while (!server.stopping_ && server.acceptFd_ >= 0) {
+            sockaddr_in clientAddr;
+            socklen_t clientLen = sizeof(clientAddr);
+            int clientFd = ::accept4(server.acceptFd_, reinterpret_cast<sockaddr*>(&clientAddr), &clientLen,
+                                     SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (clientFd >= 0) {
+                std::cout << "[SessionServer] 新客户端连接: "
+                          << inet_ntoa(clientAddr.sin_addr) << ":"
+                          << ntohs(clientAddr.sin_port)
+                          << " (fd=" << clientFd << ")" << std::endl;
+                server.adopt(std::unique_ptr<SessionStream>(new SocketStream(server.loop(), clientFd)));
+                continue;
+            }
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                std::perror("[SessionServer] accept 失败");
+            }
+            co_await Acceptable{server.loop(), server.acceptFd_};
+        }
+    }
+};
+
+SessionServer::SessionServer()
+    : loop_(new EventLoop())
+    , acceptFd_(-1)
+    , nextVirtualId_(kVirtualIdBase)
+    , stopping_(false) {
+}
+
+SessionServer::~SessionServer() {
+    stop();
+}
+
+bool SessionServer::start(int port) {
+    if (!loop_->valid()) {
+        return false;
+    }
+    stopping_ = false;
+    acceptFd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (acceptFd_ < 0) {
+        std::perror("[SessionServer] 创建 socket 失败");
+        return false;
+    }
+
+    int opt = 1;
+    ::setsockopt(acceptFd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+
+    if (::bind(acceptFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        std::perror("[SessionServer] 绑定端口失败");
+        ::close(acceptFd_);
+        acceptFd_ = -1;
+        return false;
+    }
+    if (::listen(acceptFd_, SOMAXCONN) < 0) {
+        std::perror("[SessionServer] listen 失败");
+        ::close(acceptFd_);
+        acceptFd_ = -1;
+        return false;
+    }
+
+    loop_->add(acceptFd_);
+    SessionAcceptor::run(*this);
+    std::cout << "[SessionServer] 启动成功（协程会话），监听端口 " << port << std::endl;
+    return true;
+}
+
+void SessionServer::run() {
+    loop_->run();
+    closeAll();
+}
+
+void SessionServer::stop() {
+    stopping_ = true;
+    if (loop_->running() && !loop_->inLoopThread()) {
+        // 事件循环在其他线程运行：由 run() 退出时清理
+        loop_->stop();
+        return;
+    }
+    loop_->stop();
+    closeAll();
+}
+
+size_t SessionServer::runOnce(int timeoutMs) {
+    return loop_->runOnce(timeoutMs);
+}
+
+bool SessionServer::sendText(int clientFd, const std::string& text) {
+    if (!loop_->inLoopThread()) {
+        // 其他线程（如回收线程）发起的发送转交给事件循环
+        loop_->post([this, clientFd, text]() {
+            sendText(clientFd, text);
+        });
+        return true;
+    }
+    auto it = sessions_.find(clientFd);
+    if (it == sessions_.end()) {
+        return false;
+    }
+    return it->second->sendText(text);
+}
+
+int SessionServer::adopt(std::unique_ptr<SessionStream> stream) {
+    int id = stream->id();
+    Session* session = new Session(*this, std::move(stream));
+    sessions_[id] = session;
+    session->start();   // 可能同步结束并释放会话，之后不再访问
+    return id;
+}
+
+void SessionServer::sessionOpened(Session* session) {
+    if (onConnect) {
+        onConnect(session->id());
+    }
+}
+
+void SessionServer::sessionMessage(Session* session, const std::string& message) {
+    if (onMessage) {
+        onMessage(session->id(), message);
+    }
+}
+
+void SessionServer::sessionClosed(Session* session, bool opened) {
+    int id = session->id();
+    sessions_.erase(id);
+    if (opened && onDisconnect) {
+        onDisconnect(id);
+    }
+}
+
+void SessionServer::closeAll() {
+    if (acceptFd_ >= 0) {
+        loop_->remove(acceptFd_);
+        ::close(acceptFd_);
+        acceptFd_ = -1;
+    }
+    std::vector<Session*> sessions;
+    sessions.reserve(sessions_.size());
+    for (auto& pair : sessions_) {
+        sessions.push_back(pair.second);
+    }
+    for (size_t i = 0; i < sessions.size(); i++) {
+        sessions[i]->close();
+    }
+    // 推进事件循环，让被唤醒的读写协程执行完毕
+    for (int round = 0; round < 16; round++) {
+        if (loop_->runOnce(0) == 0 && sessions_.empty()) {
+            break;
+        }
+    }
+}
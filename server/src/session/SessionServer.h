@@ -0,0 +1,68 @@
+//
+// SessionServer.h
+// 基于协程会话的 WebSocket 服务器：所有连接在一个事件循环线程上运行，接口与 WebSocketServer 一致
+//
+
+#ifndef SESSION_SERVER_H
+#define SESSION_SERVER_H
+
+#include "WebSocketServer.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+class EventLoop;
+class Session;
+class SessionStream;
+
+class SessionServer : public WebSocketServer {
+public:
+    SessionServer();
+    ~SessionServer() override;
+
+    // 启动监听（非阻塞套接字，由事件循环中的 accept 协程接入连接）
+    bool start(int port) override;
+
+    // 停止事件循环并关闭所有会话
+    void stop() override;
+
+    // 运行事件循环（阻塞调用）
+    void run() override;
+
+    // 向指定会话发送文本消息
+    bool sendText(int clientFd, const std::string& text) override;
+
+    // 接入一个已建立的字节流，立即开始握手，返回会话 ID
+    int adopt(std::unique_ptr<SessionStream> stream);
+
+    // 为内存管道分配会话 ID（不与真实 fd 冲突）
+    int allocateVirtualId() { return nextVirtualId_++; }
+
+    // 处理一轮事件（测试中代替 run() 手动推进）
+    size_t runOnce(int timeoutMs);
+
+    size_t sessionCount() const { return sessions_.size(); }
+    EventLoop& loop() { return *loop_; }
+
+private:
+    friend class Session;
+    friend struct SessionAcceptor;
+
+    static const int kVirtualIdBase = 0x40000000;
+
+    std::unique_ptr<EventLoop> loop_;
+    std::unordered_map<int, Session*> sessions_;    // 会话 ID -> 会话（只在事件循环线程访问）
+    int acceptFd_;
+    int nextVirtualId_;
+    bool stopping_;
+
+    // 会话握手完成 / 收到消息 / 结束（由 Session 回调）
+    void sessionOpened(Session* session);
+    void sessionMessage(Session* session, const std::string& message);
+    void sessionClosed(Session* session, bool opened);
+
+    void closeAll();
+};
+
+#endif // SESSION_SERVER_H
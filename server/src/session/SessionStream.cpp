@@ -0,0 +1,185 @@
+//
+// SessionStream.cpp
+// 会话字节流实现
+//
+
+#include "SessionStream.h"
+#include "EventLoop.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+// 内存流读空后保留的缓冲区上限，超过则释放，避免大量空闲会话各自占着大缓冲区
+const size_t kIdleBufferCapacity = 256;
+}
+
+// ========== SocketStream ==========
+
+SocketStream::SocketStream(EventLoop& loop, int fd)
+    : loop_(loop)
+    , fd_(fd)
+    , closed_(false) {
+    int flags = ::fcntl(fd_, F_GETFL, 0);
+    ::fcntl(fd_, F_SETFL, flags | O_NONBLOCK);
+    loop_.add(fd_);
+}
+
+SocketStream::~SocketStream() {
+    close();
+}
+
+ssize_t SocketStream::readSome(char* buf, size_t len) {
+    if (closed_) {
+        return 0;
+    }
+    ssize_t n;
+    do {
+        n = ::recv(fd_, buf, len, 0);
+    } while (n < 0 && errno == EINTR);
+    return n;
+}
+
+ssize_t SocketStream::writeSome(const char* buf, size_t len) {
+    if (closed_) {
+        errno = EPIPE;
+        return -1;
+    }
+    ssize_t n;
+    do {
+        n = ::send(fd_, buf, len, MSG_NOSIGNAL);
+    } while (n < 0 && errno == EINTR);
+    return n;
+}
+
+void SocketStream::waitReadable(std::coroutine_handle<> handle) {
+    if (closed_) {
+        loop_.schedule(handle);
+        return;
+    }
+    loop_.waitReadable(fd_, handle);
+}
+
+void SocketStream::waitWritable(std::coroutine_handle<> handle) {
+    if (closed_) {
+        loop_.schedule(handle);
+        return;
+    }
+    loop_.waitWritable(fd_, handle);
+}
+
+void SocketStream::close() {
+    if (closed_) {
+        return;
+    }
+    closed_ = true;
+    loop_.remove(fd_);
+    ::close(fd_);
+}
+
+// ========== MemoryStream ==========
+
+MemoryStream::MemoryStream(EventLoop& loop, int id)
+    : loop_(loop)
+    , id_(id)
+    , peer_(nullptr)
+    , readOffset_(0) {
+}
+
+void MemoryStream::createPair(EventLoop& loop, int serverId,
+                              std::unique_ptr<MemoryStream>& serverEnd,
+                              std::unique_ptr<MemoryStream>& clientEnd) {
+    serverEnd.reset(new MemoryStream(loop, serverId));
+    clientEnd.reset(new MemoryStream(loop, -serverId));
+    serverEnd->peer_ = clientEnd.get();
+    clientEnd->peer_ = serverEnd.get();
+}
+
+MemoryStream::~MemoryStream() {
+    close();
+}
+
+ssize_t MemoryStream::readSome(char* buf, size_t len) {
+    size_t available = inbox_.size() - readOffset_;
+    if (available == 0) {
+        if (peer_ == nullptr) {
+            return 0;
+        }
+        errno = EAGAIN;
+        return -1;
+    }
+    size_t n = available < len ? available : len;
+    std::memcpy(buf, inbox_.data() + readOffset_, n);
+    readOffset_ += n;
+    if (readOffset_ == inbox_.size()) {
+        readOffset_ = 0;
+        if (inbox_.capacity() > kIdleBufferCapacity) {
+            std::string().swap(inbox_);
+        } else {
+            inbox_.clear();
+        }
+    }
+    return static_cast<ssize_t>(n);
+}
+
+ssize_t MemoryStream::writeSome(const char* buf, size_t len) {
+    if (peer_ == nullptr) {
+        errno = EPIPE;
+        return -1;
+    }
+    peer_->inbox_.append(buf, len);
+    if (peer_->reader_) {
+        std::coroutine_handle<> reader = peer_->reader_;
+        peer_->reader_ = nullptr;
+        loop_.schedule(reader);
+    }
+    return static_cast<ssize_t>(len);
+}
+
+void MemoryStream::waitReadable(std::coroutine_handle<> handle) {
+    if (available() > 0 || peer_ == nullptr) {
+        loop_.schedule(handle);
+        return;
+    }
+    reader_ = handle;
+}
+
+void MemoryStream::waitWritable(std::coroutine_handle<> handle) {
+    // 内存管道不限制缓冲区，总是可写
+    loop_.schedule(handle);
+}
+
+void MemoryStream::close() {
+    detachPeer();
+    if (reader_) {
+        std::coroutine_handle<> reader = reader_;
+        reader_ = nullptr;
+        loop_.schedule(reader);
+    }
+}
+
+std::string MemoryStream::takeAll() {
+    std::string data = inbox_.substr(readOffset_);
+    std::string().swap(inbox_);
+    readOffset_ = 0;
+    return data;
+}
+
+void MemoryStream::detachPeer() {
+    MemoryStream* peer = peer_;
+    if (peer == nullptr) {
+        return;
+    }
+    peer_ = nullptr;
+    peer->peer_ = nullptr;
+    // 对端正在等待读取：唤醒后读到 0（连接关闭）
+    if (peer->reader_) {
+        std::coroutine_handle<> reader = peer->reader_;
+        peer->reader_ = nullptr;
+        loop_.schedule(reader);
+    }
+}
@@ -0,0 +1,106 @@
+//
+// SessionStream.h
+// 会话的非阻塞字节流：TCP 套接字，或同一进程内的内存管道（C++20）
+//
+
+#ifndef SESSION_STREAM_H
+#define SESSION_STREAM_H
+
+#include <coroutine>
+#include <memory>
+#include <string>
+
+#include <sys/types.h>
+
+class EventLoop;
+
+class SessionStream {
+public:
+    virtual ~SessionStream() {}
+
+    // 连接标识（MessageHandler 中的 clientFd）
+    virtual int id() const = 0;
+
+    // 不阻塞：返回 >0 为字节数，0 为对端关闭（仅读），-1 且 errno == EAGAIN 为暂时不可读写，其他 -1 为错误
+    virtual ssize_t readSome(char* buf, size_t len) = 0;
+    virtual ssize_t writeSome(const char* buf, size_t len) = 0;
+
+    // 挂起协程，就绪或流被关闭时在事件循环中恢复
+    virtual void waitReadable(std::coroutine_handle<> handle) = 0;
+    virtual void waitWritable(std::coroutine_handle<> handle) = 0;
+
+    // 关闭流，正在等待的协程会被恢复
+    virtual void close() = 0;
+};
+
+// 协程等待流可读 / 可写：co_await Readable{stream}
+struct Readable {
+    SessionStream& stream;
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) { stream.waitReadable(handle); }
+    void await_resume() const noexcept {}
+};
+
+struct Writable {
+    SessionStream& stream;
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) { stream.waitWritable(handle); }
+    void await_resume() const noexcept {}
+};
+
+// TCP 套接字（构造时设为非阻塞并注册到事件循环，析构时关闭）
+class SocketStream : public SessionStream {
+public:
+    SocketStream(EventLoop& loop, int fd);
+    ~SocketStream() override;
+
+    int id() const override { return fd_; }
+    ssize_t readSome(char* buf, size_t len) override;
+    ssize_t writeSome(const char* buf, size_t len) override;
+    void waitReadable(std::coroutine_handle<> handle) override;
+    void waitWritable(std::coroutine_handle<> handle) override;
+    void close() override;
+
+private:
+    EventLoop& loop_;
+    int fd_;
+    bool closed_;
+};
+
+// 内存管道的一端
+class MemoryStream : public SessionStream {
+public:
+    // 创建一对相连的内存流，serverId 为服务端一端的连接标识
+    static void createPair(EventLoop& loop, int serverId,
+                           std::unique_ptr<MemoryStream>& serverEnd,
+                           std::unique_ptr<MemoryStream>& clientEnd);
+
+    ~MemoryStream() override;
+
+    int id() const override { return id_; }
+    ssize_t readSome(char* buf, size_t len) override;
+    ssize_t writeSome(const char* buf, size_t len) override;
+    void waitReadable(std::coroutine_handle<> handle) override;
+    void waitWritable(std::coroutine_handle<> handle) override;
+    void close() override;
+
+    // 测试辅助：写入整个字符串 / 取出全部已收到的数据
+    void writeAll(const std::string& data) { writeSome(data.data(), data.size()); }
+    std::string takeAll();
+    size_t available() const { return inbox_.size() - readOffset_; }
+    bool peerClosed() const { return peer_ == nullptr; }
+
+private:
+    MemoryStream(EventLoop& loop, int id);
+
+    EventLoop& loop_;
+    int id_;
+    MemoryStream* peer_;
+    std::string inbox_;                 // 对端写入、本端待读的数据
+    size_t readOffset_;
+    std::coroutine_handle<> reader_;    // 等待可读的协程
+
+    void detachPeer();
+};
+
+#endif // SESSION_STREAM_H
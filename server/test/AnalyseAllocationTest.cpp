@@ -0,0 +1,252 @@
+//
+// AnalyseAllocationTest.cpp
+// 手牌分析不分配堆内存：拆分结果是调用方栈上的定长数组
+//
+// - analyseCard / analyseCardFirst / analyseHuCard 对胡牌手（有多种拆法）和不能胡的手牌都不分配；
+// - 4 个机器人打完整局，每次出牌（onUserOutCard：三家响应判定 + 下一家摸牌判定）都不分配，
+//   机器人按出牌建议打牌，保证有足够多的出牌经过响应方的完整胡牌分析。
+//
+// 通过替换全局 operator new/delete 统计测量区间内的分配次数（与 PoolAllocationTest 相同）。
+//
+
+#include "TestUtil.h"
+#include "GameEngine.h"
+#include "GameLogic.h"
+#include "HuTable.h"
+#include "ShantenTable.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+
+namespace {
+
+std::atomic<bool> g_counting(false);
+std::atomic<size_t> g_allocations(0);
+
+class AllocationScope {
+public:
+    AllocationScope() {
+        g_allocations.store(0);
+        g_counting.store(true);
+    }
+    ~AllocationScope() {
+        g_counting.store(false);
+    }
+    size_t stop() {
+        g_counting.store(false);
+        return g_allocations.load();
+    }
+};
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    if (g_counting.load(std::memory_order_relaxed)) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+// 随机胡牌（面子 + 将），偏向同一门以产生多种拆法
+void winningHand(std::mt19937 &rng, uint8_t cbCardIndex[MAX_INDEX]) {
+    do {
+        memset(cbCardIndex, 0, MAX_INDEX);
+        uint8_t cbSuit = static_cast<uint8_t>(rng() % 3);
+        for (int m = 0; m < MAX_WEAVE; m++) {
+            if (rng() % 2 == 0) {
+                uint8_t i = static_cast<uint8_t>(cbSuit * 9 + rng() % 7);
+                cbCardIndex[i]++; cbCardIndex[i + 1]++; cbCardIndex[i + 2]++;
+            } else {
+                cbCardIndex[cbSuit * 9 + rng() % 9] += 3;
+            }
+        }
+        cbCardIndex[rng() % MAX_INDEX] += 2;
+    } while (std::count_if(cbCardIndex, cbCardIndex + MAX_INDEX, [](uint8_t c) { return c > 4; }) > 0);
+}
+
+void testAnalyse(std::mt19937 &rng) {
+    size_t multiple = 0;
+    for (int n = 0; n < 2000; n++) {
+        uint8_t cbCardIndex[MAX_INDEX];
+        winningHand(rng, cbCardIndex);
+        tagWeaveItem WeaveItem[MAX_WEAVE];
+        memset(WeaveItem, 0, sizeof(WeaveItem));
+
+        AllocationScope scope;
+        CAnalyseItemArray AnalyseItemArray;
+        bool bAll = GameLogic::analyseCard(cbCardIndex, MAX_COUNT, WeaveItem, 0, AnalyseItemArray);
+        tagAnalyseItem AnalyseItem;
+        bool bFirst = GameLogic::analyseCardFirst(cbCardIndex, MAX_COUNT, WeaveItem, 0, AnalyseItem);
+        //去掉一张作为当前牌
+        uint8_t i = 0;
+        while (cbCardIndex[i] == 0) i++;
+        cbCardIndex[i]--;
+        uint8_t huKind = 0, huSpecial = 0, cbFanShu = 0;
+        uint64_t huRight = 0;
+        uint8_t cbResult = GameLogic::analyseHuCard(cbCardIndex, WeaveItem, 0, GameLogic::switchToCardData(i), huKind, huRight, huSpecial, 10, 10, false, false, false, cbFanShu, false);
+        CHECK_EQ(scope.stop(), 0u);
+
+        CHECK(bAll);
+        CHECK(bFirst);
+        CHECK_EQ(cbResult, WIK_H);
+        CHECK(!AnalyseItemArray.full());
+        CHECK(memcmp(&AnalyseItem, &AnalyseItemArray[0], sizeof(AnalyseItem)) == 0);
+        if (AnalyseItemArray.size() > 1) multiple++;
+    }
+    CHECK(multiple > 0);
+    std::printf("[AnalyseAllocationTest] 胡牌手 2000 手，有多种拆法 %zu 手\n", multiple);
+}
+
+// 一次待处理的动作（回调中只记录，驱动循环在引擎调用返回后执行）；定长队列，记录本身不分配
+struct Pending {
+    uint8_t cbChairID;
+    bool bRespond;
+    uint8_t cbActionMask;
+    uint8_t cbCard;
+};
+
+struct PendingQueue {
+    Pending items[16];
+    size_t head;
+    size_t tail;
+
+    void clear() { head = tail = 0; }
+    bool empty() const { return head == tail; }
+    void push(const Pending &pending) { items[tail++ % 16] = pending; }
+    Pending pop() { return items[head++ % 16]; }
+};
+
+class AdvisorPlayer : public IPlayer, public IGameEngineEventListener {
+public:
+    AdvisorPlayer(PendingQueue *pQueue, bool *pGameEnd, size_t *pHuChance)
+            : IPlayer(true, MALE, NULL), m_pQueue(pQueue), m_pGameEnd(pGameEnd), m_pHuChance(pHuChance) {
+        setGameEngineEventListener(this);
+        memset(m_cbCardIndex, 0, sizeof(m_cbCardIndex));
+    }
+
+    bool onUserEnterEvent(IPlayer *pIPlayer) override { return true; }
+
+    bool onGameStartEvent(const CMD_S_GameStart &GameStart) override {
+        memset(m_cbCardIndex, 0, sizeof(m_cbCardIndex));
+        GameLogic::switchToCardIndex(GameStart.cbCardData, MAX_COUNT - 1, m_cbCardIndex);
+        return true;
+    }
+
+    bool onSendCardEvent(const CMD_S_SendCard &SendCard) override {
+        if (SendCard.cbCurrentUser != m_ChairID) return true;
+        m_cbCardIndex[GameLogic::switchToCardIndex(SendCard.cbCardData)]++;
+        Pending pending = {m_ChairID, false, SendCard.cbActionMask, SendCard.cbCardData};
+        m_pQueue->push(pending);
+        return true;
+    }
+
+    bool onOutCardEvent(const CMD_S_OutCard &OutCard) override { return true; }
+
+    bool onOperateNotifyEvent(const CMD_S_OperateNotify &OperateNotify) override {
+        if ((OperateNotify.cbActionMask & WIK_H) != 0) (*m_pHuChance)++;
+        Pending pending = {m_ChairID, true, OperateNotify.cbActionMask, OperateNotify.cbActionCard};
+        m_pQueue->push(pending);
+        return true;
+    }
+
+    bool onOperateResultEvent(const CMD_S_OperateResult &OperateResult) override { return true; }
+
+    bool onGameEndEvent(const CMD_S_GameEnd &GameEnd) override {
+        *m_pGameEnd = true;
+        return true;
+    }
+
+    //按出牌建议打出第一张
+    uint8_t chooseOutCard() {
+        tagDiscardResult DiscardResult[MAX_INDEX];
+        GameLogic::analyseDiscard(m_cbCardIndex, 0, nullptr, DiscardResult);
+        GameLogic::removeCard(m_cbCardIndex, DiscardResult[0].cbOutCard);
+        return DiscardResult[0].cbOutCard;
+    }
+
+private:
+    uint8_t m_cbCardIndex[MAX_INDEX];   //自己的手牌（不碰不杠）
+    PendingQueue *m_pQueue;
+    bool *m_pGameEnd;
+    size_t *m_pHuChance;
+};
+
+void testDiscardPath() {
+    PendingQueue queue;
+    queue.clear();
+    bool bGameEnd = false;
+    size_t huChance = 0;
+    GameEngine engine;
+    AdvisorPlayer *players[GAME_PLAYER];
+    for (int i = 0; i < GAME_PLAYER; i++) {
+        players[i] = new AdvisorPlayer(&queue, &bGameEnd, &huChance);
+    }
+
+    size_t discards = 0, allocations = 0;
+    for (int g = 0; g < 200; g++) {
+        bGameEnd = false;
+        queue.clear();
+        if (g == 0) {
+            for (int i = 0; i < GAME_PLAYER; i++) engine.onUserEnter(players[i]);
+        } else {
+            engine.onGameRestart();
+        }
+        while (!bGameEnd && !queue.empty()) {
+            Pending pending = queue.pop();
+            CMD_C_OperateCard OperateCard;
+            OperateCard.cbOperateUser = pending.cbChairID;
+            OperateCard.cbOperateCard = pending.cbCard;
+            if ((pending.cbActionMask & WIK_H) != 0) {
+                OperateCard.cbOperateCode = WIK_H;
+                engine.onUserOperateCard(OperateCard);
+                continue;
+            }
+            if (pending.bRespond || pending.cbActionMask != WIK_NULL) {
+                OperateCard.cbOperateCode = WIK_NULL;       //不碰不杠
+                engine.onUserOperateCard(OperateCard);
+                if (pending.bRespond) continue;
+            }
+            CMD_C_OutCard OutCard;
+            OutCard.cbCardData = players[pending.cbChairID]->chooseOutCard();
+            AllocationScope scope;
+            engine.onUserOutCard(OutCard);
+            allocations += scope.stop();
+            discards++;
+        }
+    }
+    CHECK_EQ(allocations, 0u);
+    CHECK(huChance > 0);
+    std::printf("[AnalyseAllocationTest] 200 局 %zu 次出牌，响应方可胡 %zu 次，分配 %zu 次\n", discards, huChance, allocations);
+    for (int i = 0; i < GAME_PLAYER; i++) delete players[i];
+}
+
+} // namespace
+
+int main() {
+    TestUtil::muteStdout();
+    HuTable::instance();        //表在第一次使用时生成，不计入
+    ShantenTable::instance();
+    std::mt19937 rng(20180705);
+    testAnalyse(rng);
+    testDiscardPath();
+    return TestUtil::finish("AnalyseAllocationTest");
+}
@@ -0,0 +1,207 @@
+//
+// GameEventTest.cpp
+// 命令 / 事件接口测试
+//
+// - 不入座任何玩家，只用 apply 打完整局：开局每个座位一条 GameStart，终局一条 GameEnd，
+//   事件数从不超过缓冲区容量；
+// - apply 不调用监听者，dispatchEvents 之后监听者才收到；
+// - 相同房间种子下，监听者适配（onUserOutCard 等）收到的事件序列与 apply 产生的事件
+//   按座位展开后完全一致。
+//
+
+#include "TestUtil.h"
+#include "GameEngine.h"
+#include "GameEvent.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace {
+
+void appendEvent(std::string &log, uint8_t cbChairID, const tagGameEvent &Event) {
+    char szBuf[64];
+    switch (Event.cbKind) {
+        case GameEvent_GameStart:
+            snprintf(szBuf, sizeof(szBuf), "%u:G%u:%u:%02x;", cbChairID, Event.GameStart.iDiceCount, Event.GameStart.cbBankerUser, Event.GameStart.cbCardData[0]);
+            break;
+        case GameEvent_SendCard:
+            snprintf(szBuf, sizeof(szBuf), "%u:S%u:%02x:%u;", cbChairID, Event.SendCard.cbCurrentUser, Event.SendCard.cbCardData, Event.SendCard.cbActionMask);
+            break;
+        case GameEvent_OutCard:
+            snprintf(szBuf, sizeof(szBuf), "%u:O%u:%02x;", cbChairID, Event.OutCard.cbOutCardUser, Event.OutCard.cbOutCardData);
+            break;
+        case GameEvent_OperateNotify:
+            snprintf(szBuf, sizeof(szBuf), "%u:N%u:%02x;", cbChairID, Event.OperateNotify.cbActionMask, Event.OperateNotify.cbActionCard);
+            break;
+        case GameEvent_OperateResult:
+            snprintf(szBuf, sizeof(szBuf), "%u:R%u:%u:%02x;", cbChairID, Event.OperateResult.cbOperateUser, Event.OperateResult.cbOperateCode, Event.OperateResult.cbOperateCard);
+            break;
+        case GameEvent_GameEnd:
+            snprintf(szBuf, sizeof(szBuf), "%u:E%u:%lld;", cbChairID, Event.GameEnd.cbHuUser, static_cast<long long>(Event.GameEnd.lGameScore[0]));
+            break;
+        default:
+            snprintf(szBuf, sizeof(szBuf), "?");
+            break;
+    }
+    log.append(szBuf);
+}
+
+// 按 dispatchEvents 的顺序展开到各座位
+void appendEvents(std::string &log, const GameEventBuffer &Events, uint8_t cbPlayerCount) {
+    for (uint8_t n = 0; n < Events.size(); n++) {
+        for (uint8_t i = 0; i < cbPlayerCount; i++) {
+            if (Events[n].cbChairID != INVALID_CHAIR && Events[n].cbChairID != i) continue;
+            appendEvent(log, i, Events[n]);
+        }
+    }
+}
+
+class LogPlayer : public IPlayer, public IGameEngineEventListener {
+public:
+    explicit LogPlayer(std::string *pLog) : IPlayer(false, MALE, NULL), m_pLog(pLog) {
+        setGameEngineEventListener(this);
+    }
+
+    bool onUserEnterEvent(IPlayer *pIPlayer) override { return true; }
+    bool onGameStartEvent(const CMD_S_GameStart &GameStart) override { tagGameEvent Event; Event.cbKind = GameEvent_GameStart; Event.GameStart = GameStart; return log(Event); }
+    bool onSendCardEvent(const CMD_S_SendCard &SendCard) override { tagGameEvent Event; Event.cbKind = GameEvent_SendCard; Event.SendCard = SendCard; return log(Event); }
+    bool onOutCardEvent(const CMD_S_OutCard &OutCard) override { tagGameEvent Event; Event.cbKind = GameEvent_OutCard; Event.OutCard = OutCard; return log(Event); }
+    bool onOperateNotifyEvent(const CMD_S_OperateNotify &OperateNotify) override { tagGameEvent Event; Event.cbKind = GameEvent_OperateNotify; Event.OperateNotify = OperateNotify; return log(Event); }
+    bool onOperateResultEvent(const CMD_S_OperateResult &OperateResult) override { tagGameEvent Event; Event.cbKind = GameEvent_OperateResult; Event.OperateResult = OperateResult; return log(Event); }
+    bool onGameEndEvent(const CMD_S_GameEnd &GameEnd) override { tagGameEvent Event; Event.cbKind = GameEvent_GameEnd; Event.GameEnd = GameEnd; return log(Event); }
+
+private:
+    bool log(const tagGameEvent &Event) {
+        appendEvent(*m_pLog, m_ChairID, Event);
+        return true;
+    }
+
+    std::string *m_pLog;
+};
+
+// 按状态选下一条命令：有未响应的动作先响应（胡 > 碰 > 过），否则当前玩家打出编号最大的牌
+bool nextCommand(const tagGameState &State, tagGameCommand &Command) {
+    for (uint8_t i = 0; i < State.cbPlayerCount; i++) {
+        if (State.cbUserAction[i] == WIK_NULL || State.bResponse[i]) continue;
+        uint8_t cbCode = WIK_NULL;
+        if ((State.cbUserAction[i] & WIK_H) != 0) {
+            cbCode = WIK_H;
+        } else if ((State.cbUserAction[i] & WIK_P) != 0) {
+            cbCode = WIK_P;
+        }
+        Command = tagGameCommand::makeOperateCard(i, cbCode, State.cbProvideCard);
+        return true;
+    }
+    if (State.cbCurrentUser >= State.cbPlayerCount) return false;
+    for (int j = MAX_INDEX - 1; j >= 0; j--) {
+        if (State.cbCardIndex[State.cbCurrentUser][j] == 0) continue;
+        Command = tagGameCommand::makeOutCard(GameLogic::switchToCardData(static_cast<uint8_t>(j)));
+        return true;
+    }
+    return false;
+}
+
+bool hasGameEnd(const GameEventBuffer &Events) {
+    for (uint8_t n = 0; n < Events.size(); n++) {
+        if (Events[n].cbKind == GameEvent_GameEnd) return true;
+    }
+    return false;
+}
+
+void testHeadless() {
+    GameEngine engine;
+    engine.setRoomSeed(7);
+    size_t games = 0, commands = 0, huEnds = 0;
+    uint8_t cbMaxEvents = 0;
+    for (int g = 0; g < 100; g++) {
+        GameEventBuffer Events;
+        CHECK(engine.apply(tagGameCommand::makeStart(GAME_PLAYER, 0), Events));
+        uint8_t cbStarts = 0;
+        for (uint8_t n = 0; n < Events.size(); n++) {
+            if (Events[n].cbKind == GameEvent_GameStart) {
+                CHECK_EQ(Events[n].cbChairID, cbStarts);
+                cbStarts++;
+            }
+        }
+        CHECK_EQ(cbStarts, GAME_PLAYER);
+        bool bEnd = false;
+        tagGameCommand Command;
+        for (int n = 0; n < 1000 && !bEnd && nextCommand(engine.getGameState(), Command); n++) {
+            Events.clear();
+            engine.apply(Command, Events);
+            CHECK(!Events.overflow());
+            if (Events.size() > cbMaxEvents) cbMaxEvents = Events.size();
+            bEnd = hasGameEnd(Events);
+            commands++;
+        }
+        CHECK(bEnd);
+        if (engine.getGameState().cbHuCard != 0) huEnds++;
+        games++;
+    }
+    CHECK(huEnds > 0);
+    CHECK(cbMaxEvents < MAX_GAME_EVENT);
+    std::printf("[GameEventTest] 无玩家 %zu 局 %zu 条命令，胡牌结束 %zu 局，单条命令最多 %u 条事件\n", games, commands, huEnds, cbMaxEvents);
+}
+
+void testAdapter() {
+    std::string listenerLog, applyLog;
+    LogPlayer *players[GAME_PLAYER];
+    for (int i = 0; i < GAME_PLAYER; i++) players[i] = new LogPlayer(&listenerLog);
+
+    //适配：入座后自动开局，命令经 onUserOutCard / onUserOperateCard
+    GameEngine adapter;
+    adapter.setRoomSeed(11);
+    for (int i = 0; i < GAME_PLAYER; i++) adapter.onUserEnter(players[i]);
+    //纯接口：相同房间种子
+    GameEngine core;
+    core.setRoomSeed(11);
+    GameEventBuffer Events;
+    core.apply(tagGameCommand::makeStart(GAME_PLAYER, 0), Events);
+    appendEvents(applyLog, Events, GAME_PLAYER);
+
+    for (int g = 0; g < 20; g++) {
+        if (g > 0) {
+            adapter.onGameRestart();
+            Events.clear();
+            core.apply(tagGameCommand::makeStart(GAME_PLAYER, 0), Events);
+            appendEvents(applyLog, Events, GAME_PLAYER);
+        }
+        tagGameCommand Command;
+        bool bEnd = false;
+        for (int n = 0; n < 1000 && !bEnd && nextCommand(core.getGameState(), Command); n++) {
+            if (Command.cbKind == GameCommand_OutCard) {
+                adapter.onUserOutCard(Command.OutCard);
+            } else {
+                adapter.onUserOperateCard(Command.OperateCard);
+            }
+            Events.clear();
+            core.apply(Command, Events);
+            appendEvents(applyLog, Events, GAME_PLAYER);
+            bEnd = hasGameEnd(Events);
+        }
+        CHECK(bEnd);
+        CHECK(memcmp(&adapter.getGameState(), &core.getGameState(), sizeof(tagGameState)) == 0);
+    }
+    CHECK(!applyLog.empty());
+    CHECK(listenerLog == applyLog);
+
+    //apply 不调用监听者，dispatchEvents 之后才收到
+    listenerLog.clear();
+    Events.clear();
+    adapter.apply(tagGameCommand::makeStart(GAME_PLAYER, 0), Events);
+    CHECK(listenerLog.empty());
+    CHECK(Events.size() > GAME_PLAYER);
+    adapter.dispatchEvents(Events);
+    CHECK(!listenerLog.empty());
+    for (int i = 0; i < GAME_PLAYER; i++) delete players[i];
+}
+
+} // namespace
+
+int main() {
+    TestUtil::muteStdout();
+    testHeadless();
+    testAdapter();
+    return TestUtil::finish("GameEventTest");
+}
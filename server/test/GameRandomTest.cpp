@@ -0,0 +1,188 @@
+//
+// GameRandomTest.cpp
+// 房间随机数与洗牌测试
+//
+// - 相同种子得到相同序列，重新设置种子后从头开始，不同种子的序列不同；
+// - nextBounded 在 [0, n) 内均匀（卡方检验，骰子 6、牌墙 136 和非 2 的幂的区间）；
+// - 洗 4 张不同的牌，24 种排列出现的次数均匀（卡方检验）；
+// - 整副牌洗牌后每种牌仍是 4 张，首、中、尾几个位置上 34 种牌出现的次数均匀（卡方检验）；
+// - 两个引擎指定相同的本局种子，发到各家的手牌、骰子、庄家相同；不指定时各房间种子不同。
+//
+// 卡方临界值取显著性 0.001（df = 5: 20.52，df = 6: 22.46，df = 23: 49.73，df = 33: 63.87，df = 135: 194.1），种子固定，结果可复现。
+//
+
+#include "TestUtil.h"
+#include "GameEngine.h"
+#include "GameLogic.h"
+#include "GameRandom.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+double chiSquare(const std::vector<long> &observed, double expected) {
+    double chi = 0;
+    for (size_t i = 0; i < observed.size(); i++) {
+        double diff = observed[i] - expected;
+        chi += diff * diff / expected;
+    }
+    return chi;
+}
+
+void testSequence() {
+    GameRandom a(12345), b(12345), c(12346);
+    bool bDiffer = false;
+    uint64_t llFirst[16];
+    for (int i = 0; i < 16; i++) {
+        llFirst[i] = a.next();
+        CHECK_EQ(llFirst[i], b.next());
+        bDiffer = bDiffer || llFirst[i] != c.next();
+    }
+    CHECK(bDiffer);
+    CHECK_EQ(a.getSeed(), 12345u);
+    a.seed(12345);
+    for (int i = 0; i < 16; i++) CHECK_EQ(a.next(), llFirst[i]);
+    //种子为 0 也能正常工作（splitmix64 展开后状态不是全 0）
+    GameRandom zero(0);
+    CHECK(zero.next() != 0 || zero.next() != 0);
+    CHECK(GameRandom::makeSeed() != GameRandom::makeSeed());
+}
+
+void testBounded() {
+    const uint32_t dwBounds[] = {6, 7, 136};
+    const double dCritical[] = {20.52, 22.46, 194.1};
+    GameRandom random(20180705);
+    for (int b = 0; b < 3; b++) {
+        uint32_t dwBound = dwBounds[b];
+        std::vector<long> counts(dwBound, 0);
+        const long samples = 200000;
+        for (long n = 0; n < samples; n++) {
+            uint32_t dwValue = random.nextBounded(dwBound);
+            CHECK(dwValue < dwBound);
+            if (dwValue < dwBound) counts[dwValue]++;
+        }
+        double chi = chiSquare(counts, static_cast<double>(samples) / dwBound);
+        CHECK(chi < dCritical[b]);
+        std::printf("[GameRandomTest] nextBounded(%u) 卡方 %.1f\n", dwBound, chi);
+    }
+}
+
+//洗前 4 张（各不相同），统计 24 种排列
+void testPermutation() {
+    GameRandom random(42);
+    std::vector<long> counts(24, 0);
+    const long samples = 240000;
+    for (long n = 0; n < samples; n++) {
+        uint8_t cbCard[4];
+        GameLogic::shuffle(cbCard, 4, random);
+        //排列编号（康托展开）
+        int rank = 0;
+        for (int i = 0; i < 4; i++) {
+            int smaller = 0;
+            for (int j = i + 1; j < 4; j++) smaller += cbCard[j] < cbCard[i];
+            static const int kFactorial[4] = {6, 2, 1, 0};
+            rank += smaller * kFactorial[i];
+        }
+        counts[rank]++;
+    }
+    double chi = chiSquare(counts, static_cast<double>(samples) / 24);
+    CHECK(chi < 49.73);
+    std::printf("[GameRandomTest] 4 张牌 24 种排列卡方 %.1f\n", chi);
+}
+
+void testDeck() {
+    GameRandom random(7);
+    const uint8_t cbPositions[] = {0, 1, 67, 134, 135};
+    std::vector<long> counts[5];
+    for (int p = 0; p < 5; p++) counts[p].assign(MAX_INDEX, 0);
+    const long samples = 50000;
+    for (long n = 0; n < samples; n++) {
+        uint8_t cbCardData[MAX_REPERTORY];
+        GameLogic::shuffle(cbCardData, MAX_REPERTORY, random);
+        uint8_t cbCardIndex[MAX_INDEX];
+        memset(cbCardIndex, 0, sizeof(cbCardIndex));
+        GameLogic::switchToCardIndex(cbCardData, MAX_REPERTORY, cbCardIndex);
+        for (uint8_t i = 0; i < MAX_INDEX; i++) CHECK_EQ(cbCardIndex[i], 4);
+        for (int p = 0; p < 5; p++) counts[p][GameLogic::switchToCardIndex(cbCardData[cbPositions[p]])]++;
+    }
+    for (int p = 0; p < 5; p++) {
+        double chi = chiSquare(counts[p], static_cast<double>(samples) / MAX_INDEX);
+        CHECK(chi < 63.87);
+        std::printf("[GameRandomTest] 第 %d 张牌 34 种卡方 %.1f\n", cbPositions[p], chi);
+    }
+}
+
+// 只记录开局数据
+class StartPlayer : public IPlayer, public IGameEngineEventListener {
+public:
+    StartPlayer() : IPlayer(false, MALE, NULL) {
+        setGameEngineEventListener(this);
+        memset(&m_GameStart, 0, sizeof(m_GameStart));
+    }
+
+    bool onUserEnterEvent(IPlayer *pIPlayer) override { return true; }
+    bool onGameStartEvent(const CMD_S_GameStart &GameStart) override {
+        m_GameStart = GameStart;
+        return true;
+    }
+    bool onSendCardEvent(const CMD_S_SendCard &SendCard) override { return true; }
+    bool onOutCardEvent(const CMD_S_OutCard &OutCard) override { return true; }
+    bool onOperateNotifyEvent(const CMD_S_OperateNotify &OperateNotify) override { return true; }
+    bool onOperateResultEvent(const CMD_S_OperateResult &OperateResult) override { return true; }
+    bool onGameEndEvent(const CMD_S_GameEnd &GameEnd) override { return true; }
+
+    CMD_S_GameStart m_GameStart;
+};
+
+bool sameStart(StartPlayer a[GAME_PLAYER], StartPlayer b[GAME_PLAYER]) {
+    for (int i = 0; i < GAME_PLAYER; i++) {
+        const CMD_S_GameStart &x = a[i].m_GameStart, &y = b[i].m_GameStart;
+        if (x.iDiceCount != y.iDiceCount || x.cbBankerUser != y.cbBankerUser) return false;
+        if (memcmp(x.cbCardData, y.cbCardData, MAX_COUNT - 1) != 0) return false;
+    }
+    return true;
+}
+
+void testEngineSeed() {
+    StartPlayer first[GAME_PLAYER], second[GAME_PLAYER], third[GAME_PLAYER];
+    GameEngine engineFirst, engineSecond, engineThird;
+    CHECK(engineFirst.getRoomSeed() != engineSecond.getRoomSeed());
+    engineFirst.setGameSeed(0x1234567890ABCDEFULL);
+    engineSecond.setGameSeed(0x1234567890ABCDEFULL);
+    for (int i = 0; i < GAME_PLAYER; i++) {
+        engineFirst.onUserEnter(&first[i]);
+        engineSecond.onUserEnter(&second[i]);
+        engineThird.onUserEnter(&third[i]);
+    }
+    CHECK_EQ(engineFirst.getGameSeed(), 0x1234567890ABCDEFULL);
+    CHECK(sameStart(first, second));
+    CHECK(!sameStart(first, third));
+    for (int i = 0; i < GAME_PLAYER; i++) {
+        uint32_t dwDice = first[i].m_GameStart.iDiceCount;
+        CHECK(dwDice >= 2 && dwDice <= 12);
+    }
+
+    //相同房间种子，之后每一局都相同
+    engineFirst.setRoomSeed(99);
+    engineSecond.setRoomSeed(99);
+    for (int g = 0; g < 3; g++) {
+        engineFirst.onGameRestart();
+        engineSecond.onGameRestart();
+        CHECK_EQ(engineFirst.getGameSeed(), engineSecond.getGameSeed());
+        CHECK(sameStart(first, second));
+    }
+}
+
+} // namespace
+
+int main() {
+    TestUtil::muteStdout();
+    testSequence();
+    testBounded();
+    testPermutation();
+    testDeck();
+    testEngineSeed();
+    return TestUtil::finish("GameRandomTest");
+}
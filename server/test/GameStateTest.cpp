@@ -0,0 +1,227 @@
+//
+// GameStateTest.cpp
+// 牌局状态快照测试
+//
+// - tagGameState 是 POD、按缓存行对齐，热点字段在前两条缓存行；堆上 new 的引擎同样对齐；
+// - 牌局中途快照，写入文件再读回，字节不变；
+// - 同一引擎恢复快照后重新打完，事件序列和终局状态与第一次完全一致；
+// - 另一个引擎（玩家已入座、种子不同）恢复同一快照后打完，结果也一致，等牌缓存按手牌重建。
+//
+// 牌局由状态驱动：有未响应的动作先响应（胡 > 碰 > 过），否则当前玩家打出编号最大的牌，
+// 决策只依赖引擎状态，因此从快照继续时不需要恢复玩家这一侧的任何数据。
+//
+
+#include "TestUtil.h"
+#include "GameEngine.h"
+#include "GameState.h"
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+
+namespace {
+
+class LogPlayer : public IPlayer, public IGameEngineEventListener {
+public:
+    LogPlayer() : IPlayer(false, MALE, NULL), m_pLog(NULL), m_bGameEnd(false) {
+        setGameEngineEventListener(this);
+    }
+
+    void attach(std::string *pLog) { m_pLog = pLog; m_bGameEnd = false; }
+    bool isGameEnd() const { return m_bGameEnd; }
+
+    bool onUserEnterEvent(IPlayer *pIPlayer) override { return true; }
+
+    bool onGameStartEvent(const CMD_S_GameStart &GameStart) override {
+        m_bGameEnd = false;
+        return true;
+    }
+
+    bool onSendCardEvent(const CMD_S_SendCard &SendCard) override {
+        append("S%u:%02x:%u:%u;", SendCard.cbCurrentUser, SendCard.cbCardData, SendCard.cbActionMask, SendCard.bTail ? 1 : 0);
+        return true;
+    }
+
+    bool onOutCardEvent(const CMD_S_OutCard &OutCard) override {
+        append("O%u:%02x;", OutCard.cbOutCardUser, OutCard.cbOutCardData);
+        return true;
+    }
+
+    bool onOperateNotifyEvent(const CMD_S_OperateNotify &OperateNotify) override {
+        append("N%u:%u:%02x;", m_ChairID, OperateNotify.cbActionMask, OperateNotify.cbActionCard);
+        return true;
+    }
+
+    bool onOperateResultEvent(const CMD_S_OperateResult &OperateResult) override {
+        append("R%u:%u:%02x;", OperateResult.cbOperateUser, OperateResult.cbOperateCode, OperateResult.cbOperateCard);
+        return true;
+    }
+
+    bool onGameEndEvent(const CMD_S_GameEnd &GameEnd) override {
+        append("E%u:%u:%02x", GameEnd.cbHuUser, GameEnd.cbProvideUser, GameEnd.cbHuCard);
+        for (int i = 0; i < GAME_PLAYER; i++) append(":%lld", static_cast<long long>(GameEnd.lGameScore[i]));
+        append(";");
+        m_bGameEnd = true;
+        return true;
+    }
+
+private:
+    template<typename... Args>
+    void append(const char *szFormat, Args... args) {
+        if (m_pLog == NULL) return;
+        char szBuf[64];
+        snprintf(szBuf, sizeof(szBuf), szFormat, args...);
+        m_pLog->append(szBuf);
+    }
+
+    std::string *m_pLog;
+    bool m_bGameEnd;
+};
+
+struct Table {
+    GameEngine engine;
+    LogPlayer players[GAME_PLAYER];
+    std::string log;
+
+    explicit Table(uint64_t llRoomSeed) {
+        engine.setRoomSeed(llRoomSeed);
+        for (int i = 0; i < GAME_PLAYER; i++) players[i].attach(&log);
+        for (int i = 0; i < GAME_PLAYER; i++) engine.onUserEnter(&players[i]);
+    }
+
+    bool isGameEnd() const { return players[0].isGameEnd(); }
+
+    void restore(const tagGameState &GameState) {
+        log.clear();
+        for (int i = 0; i < GAME_PLAYER; i++) players[i].attach(&log);
+        engine.restore(GameState);
+    }
+};
+
+// 按引擎状态走一步，没有可走的返回 false
+bool step(GameEngine &engine) {
+    const tagGameState &State = engine.getGameState();
+    for (uint8_t i = 0; i < GAME_PLAYER; i++) {
+        if (State.cbUserAction[i] == WIK_NULL || State.bResponse[i]) continue;
+        CMD_C_OperateCard OperateCard;
+        OperateCard.cbOperateUser = i;
+        OperateCard.cbOperateCard = State.cbProvideCard;
+        if ((State.cbUserAction[i] & WIK_H) != 0) {
+            OperateCard.cbOperateCode = WIK_H;
+        } else if ((State.cbUserAction[i] & WIK_P) != 0) {
+            OperateCard.cbOperateCode = WIK_P;
+        } else {
+            OperateCard.cbOperateCode = WIK_NULL;
+        }
+        engine.onUserOperateCard(OperateCard);
+        return true;
+    }
+    uint8_t cbCurrentUser = State.cbCurrentUser;
+    if (cbCurrentUser >= GAME_PLAYER) return false;
+    for (int j = MAX_INDEX - 1; j >= 0; j--) {
+        if (State.cbCardIndex[cbCurrentUser][j] == 0) continue;
+        CMD_C_OutCard OutCard;
+        OutCard.cbCardData = GameLogic::switchToCardData(static_cast<uint8_t>(j));
+        engine.onUserOutCard(OutCard);
+        return true;
+    }
+    return false;
+}
+
+// 打到终局，返回步数（超过上限说明卡住）
+int playToEnd(Table &table) {
+    int iSteps = 0;
+    while (!table.isGameEnd() && iSteps < 1000 && step(table.engine)) iSteps++;
+    return iSteps;
+}
+
+bool sameState(const GameEngine &first, const GameEngine &second) {
+    if (memcmp(&first.getGameState(), &second.getGameState(), sizeof(tagGameState)) != 0) return false;
+    for (uint8_t i = 0; i < GAME_PLAYER; i++) {
+        if (first.getTingCache().getHuMask(i) != second.getTingCache().getHuMask(i)) return false;
+    }
+    return true;
+}
+
+void testLayout() {
+    CHECK_EQ(alignof(tagGameState), 64u);
+    CHECK_EQ(sizeof(tagGameState) % 64, 0u);
+    tagGameState GameState;
+    CHECK_EQ(reinterpret_cast<uintptr_t>(&GameState) % 64, 0u);
+    //堆上的引擎经类内 operator new 分配，不受全局 new 只保证 16 字节的限制
+    for (int i = 0; i < 8; i++) {
+        std::unique_ptr<GameEngine> pEngine(new GameEngine());
+        CHECK_EQ(reinterpret_cast<uintptr_t>(&pEngine->getGameState()) % 64, 0u);
+    }
+    std::printf("[GameStateTest] sizeof(tagGameState)=%zu（%zu 条缓存行）\n", sizeof(tagGameState), sizeof(tagGameState) / 64);
+}
+
+void testSnapshotRestore() {
+    size_t games = 0, weaveSnapshots = 0, huEnds = 0;
+    for (uint64_t g = 1; g <= 60; g++) {
+        Table first(g);
+        //走到牌局中途（步数随局变化），遇到终局就跳过这一局
+        int iStop = 10 + static_cast<int>(g % 40);
+        int iSteps = 0;
+        while (!first.isGameEnd() && iSteps < iStop && step(first.engine)) iSteps++;
+        if (first.isGameEnd()) continue;
+
+        tagGameState Snapshot;
+        first.engine.snapshot(Snapshot);
+        CHECK(memcmp(&Snapshot, &first.engine.getGameState(), sizeof(Snapshot)) == 0);
+        for (uint8_t i = 0; i < GAME_PLAYER; i++) {
+            if (Snapshot.cbWeaveItemCount[i] > 0) { weaveSnapshots++; break; }
+        }
+
+        //写入文件再读回
+        FILE *pFile = tmpfile();
+        CHECK(pFile != NULL);
+        if (pFile == NULL) return;
+        CHECK_EQ(fwrite(&Snapshot, sizeof(Snapshot), 1, pFile), 1u);
+        rewind(pFile);
+        tagGameState Loaded;
+        memset(&Loaded, 0xCD, sizeof(Loaded));
+        CHECK_EQ(fread(&Loaded, sizeof(Loaded), 1, pFile), 1u);
+        fclose(pFile);
+        CHECK(memcmp(&Snapshot, &Loaded, sizeof(Snapshot)) == 0);
+
+        //第一次打完
+        first.log.clear();
+        CHECK(playToEnd(first) < 1000);
+        CHECK(first.isGameEnd());
+        std::string firstLog = first.log;
+        tagGameState FirstEnd;
+        first.engine.snapshot(FirstEnd);
+        if (FirstEnd.cbHuCard != 0) huEnds++;
+
+        //同一引擎恢复后重新打完
+        first.restore(Snapshot);
+        CHECK(!first.isGameEnd());
+        CHECK(playToEnd(first) < 1000);
+        CHECK(first.log == firstLog);
+        CHECK(memcmp(&FirstEnd, &first.engine.getGameState(), sizeof(FirstEnd)) == 0);
+
+        //另一个引擎恢复读回的快照
+        Table second(g + 1000);
+        second.restore(Loaded);
+        CHECK_EQ(second.engine.getGameSeed(), Snapshot.llGameSeed);
+        CHECK(playToEnd(second) < 1000);
+        CHECK(second.log == firstLog);
+        CHECK(sameState(first.engine, second.engine));
+        games++;
+    }
+    CHECK(games > 40);
+    CHECK(weaveSnapshots > 0);
+    CHECK(huEnds > 0);
+    std::printf("[GameStateTest] %zu 局中途快照，含碰杠 %zu 局，胡牌结束 %zu 局\n", games, weaveSnapshots, huEnds);
+}
+
+} // namespace
+
+int main() {
+    TestUtil::muteStdout();
+    testLayout();
+    testSnapshotRestore();
+    return TestUtil::finish("GameStateTest");
+}
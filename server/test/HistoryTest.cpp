@@ -0,0 +1,300 @@
+//
+// HistoryTest.cpp
+// 对局历史测试
+//
+// - 四个机器人连打 700 局，结算结果按 37 位玩家轮流入座（部分座位为机器人）写进每段 128 行的历史，
+//   写满的段在后台压缩；按玩家的历史、积分汇总（含时间范围）和胡牌规则统计都与逐局累加的结果一致，
+//   压缩后的段比原始宽度小；
+// - 关闭后重新打开（未写满的段在关闭时压缩），查询结果不变，之后继续追加；
+// - 子进程追加若干局后不关闭直接退出，重新打开时写入段里的局一局不少；
+// - 房间开启历史后，真人加补位机器人打完一局，历史里有这一局，真人在原座位，机器人座位为空。
+//
+
+#include "TestUtil.h"
+#include "RoomTestUtil.h"
+#include "BotPlayer.h"
+#include "MatchHistory.h"
+#include "NetPlayer.h"
+#include "Room.h"
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+const uint32_t kBaseTime = 1700000000;
+
+void removeHistory(const std::string &path) {
+    char szPath[256];
+    for (unsigned int seq = 1; seq < 100; seq++) {
+        std::snprintf(szPath, sizeof(szPath), "%s.%08u", path.c_str(), seq);
+        std::remove(szPath);
+    }
+    std::remove((path + ".players").c_str());
+}
+
+//收集每局的结算
+class GameEndTap : public IGameCommandListener {
+public:
+    explicit GameEndTap(std::vector<CMD_S_GameEnd> &GameEnds) : m_GameEnds(GameEnds) {}
+
+    void onCommandApplied(const tagGameCommand &, uint8_t, const tagGameState &, const GameEventBuffer &Events,
+                          uint8_t cbFirstEvent) override {
+        for (uint8_t i = cbFirstEvent; i < Events.size(); i++) {
+            if (Events[i].cbKind == GameEvent_GameEnd) m_GameEnds.push_back(Events[i].GameEnd);
+        }
+    }
+
+private:
+    std::vector<CMD_S_GameEnd> &m_GameEnds;
+};
+
+std::vector<CMD_S_GameEnd> playHands(size_t hands) {
+    std::vector<CMD_S_GameEnd> GameEnds;
+    GameEndTap Tap(GameEnds);
+    GameEngine engine;
+    engine.setQuiet(true);
+    engine.setCommandListener(&Tap);
+    BotPlayer bots[GAME_PLAYER];
+    engine.setRoomSeed(48);
+    for (int i = 0; i < GAME_PLAYER; i++) engine.onUserEnter(&bots[i]);
+    for (size_t h = 0; h < hands; h++) {
+        if (h > 0) engine.onGameRestart();
+        for (int n = 0; n < 1000 && !bots[0].isGameEnd(); n++) {
+            tagGameCommand Command;
+            bool bTaken = false;
+            for (int i = 0; i < GAME_PLAYER && !bTaken; i++) bTaken = bots[i].takeCommand(Command);
+            if (!bTaken) break;
+            GameEventBuffer Events;
+            engine.apply(Command, Events);
+            engine.dispatchEvents(Events);
+        }
+    }
+    engine.setCommandListener(NULL);
+    return GameEnds;
+}
+
+//第 h 局的座位：37 位玩家轮流入座，每 5 局有一个机器人座位
+std::vector<MatchRecord> makeRecords(const std::vector<CMD_S_GameEnd> &GameEnds) {
+    std::vector<MatchRecord> Records;
+    for (size_t h = 0; h < GameEnds.size(); h++) {
+        std::string playerIds[GAME_PLAYER];
+        for (int s = 0; s < GAME_PLAYER; s++) {
+            if (h % 5 == 0 && s == static_cast<int>(h / 5 % GAME_PLAYER)) continue;
+            playerIds[s] = "p" + std::to_string((h * 3 + s * 7) % 37);
+        }
+        Records.push_back(MatchRecord::fromGameEnd(GameEnds[h], playerIds, kBaseTime + static_cast<uint32_t>(h) * 60));
+    }
+    return Records;
+}
+
+bool sameRecord(const MatchRecord &a, const MatchRecord &b) {
+    bool bSame = a.time == b.time && a.huUser == b.huUser && a.provideUser == b.provideUser && a.huCard == b.huCard &&
+                 std::memcmp(a.maCard, b.maCard, sizeof(a.maCard)) == 0;
+    for (int s = 0; s < GAME_PLAYER; s++) {
+        bSame = bSame && a.playerIds[s] == b.playerIds[s] && a.huRight[s] == b.huRight[s] && a.huKind[s] == b.huKind[s] &&
+                a.weaveCount[s] == b.weaveCount[s] && a.score[s] == b.score[s];
+    }
+    return bSame;
+}
+
+//逐局累加的期望值
+PlayerTotals expectTotals(const std::vector<MatchRecord> &Records, const std::string &playerId, uint32_t fromTime, uint32_t toTime) {
+    PlayerTotals Totals;
+    for (size_t h = 0; h < Records.size(); h++) {
+        const MatchRecord &Record = Records[h];
+        if (Record.time < fromTime || Record.time >= toTime) continue;
+        for (int s = 0; s < GAME_PLAYER; s++) {
+            if (Record.playerIds[s] != playerId) continue;
+            Totals.hands++;
+            Totals.score += Record.score[s];
+            if ((Record.huUser & (1 << s)) != 0) {
+                Totals.wins++;
+                if ((Record.huKind[s] & CHK_ZM) != 0) Totals.selfDrawn++;
+            } else if (Record.huUser != 0 && Record.provideUser == s) {
+                Totals.dealtIn++;
+            }
+        }
+    }
+    return Totals;
+}
+
+RuleStats expectStats(const std::vector<MatchRecord> &Records, uint32_t fromTime, uint32_t toTime) {
+    RuleStats Stats;
+    for (size_t h = 0; h < Records.size(); h++) {
+        const MatchRecord &Record = Records[h];
+        if (Record.time < fromTime || Record.time >= toTime) continue;
+        Stats.hands++;
+        if (Record.huUser == 0) {
+            Stats.draws++;
+            continue;
+        }
+        if ((Record.huUser & (Record.huUser - 1)) != 0) Stats.multiWins++;
+        for (int s = 0; s < GAME_PLAYER; s++) {
+            if ((Record.huUser & (1 << s)) == 0) continue;
+            Stats.winners++;
+            for (int b = 0; b < 64; b++) {
+                if ((Record.huRight[s] >> b) & 1) Stats.huRight[b]++;
+            }
+            for (int b = 0; b < 8; b++) {
+                if ((Record.huKind[s] >> b) & 1) Stats.huKind[b]++;
+            }
+        }
+    }
+    return Stats;
+}
+
+bool sameTotals(const PlayerTotals &a, const PlayerTotals &b) {
+    return a.hands == b.hands && a.wins == b.wins && a.selfDrawn == b.selfDrawn && a.dealtIn == b.dealtIn && a.score == b.score;
+}
+
+bool sameStats(const RuleStats &a, const RuleStats &b) {
+    return a.hands == b.hands && a.draws == b.draws && a.winners == b.winners && a.multiWins == b.multiWins &&
+           std::memcmp(a.huRight, b.huRight, sizeof(a.huRight)) == 0 && std::memcmp(a.huKind, b.huKind, sizeof(a.huKind)) == 0;
+}
+
+//全部查询与逐局累加的结果比较
+void checkQueries(const MatchHistory &history, const std::vector<MatchRecord> &Records) {
+    CHECK_EQ(history.getHandCount(), static_cast<uint64_t>(Records.size()));
+    uint32_t dwEnd = kBaseTime + static_cast<uint32_t>(Records.size()) * 60;
+    const uint32_t Ranges[][2] = {{0, UINT32_MAX}, {kBaseTime + 6000, kBaseTime + 21000}, {kBaseTime + 7680, dwEnd}, {dwEnd, UINT32_MAX}};
+    for (int p = 0; p < 37; p += 6) {
+        std::string playerId = "p" + std::to_string(p);
+        for (size_t r = 0; r < sizeof(Ranges) / sizeof(Ranges[0]); r++) {
+            CHECK(sameTotals(history.playerTotals(playerId, Ranges[r][0], Ranges[r][1]), expectTotals(Records, playerId, Ranges[r][0], Ranges[r][1])));
+        }
+        std::vector<MatchRecord> Found;
+        history.playerHistory(playerId, 30, Found);
+        std::vector<const MatchRecord *> Expected;
+        for (size_t h = Records.size(); h-- > 0 && Expected.size() < 30;) {
+            for (int s = 0; s < GAME_PLAYER; s++) {
+                if (Records[h].playerIds[s] == playerId) {
+                    Expected.push_back(&Records[h]);
+                    break;
+                }
+            }
+        }
+        CHECK_EQ(Found.size(), Expected.size());
+        for (size_t i = 0; i < Found.size() && i < Expected.size(); i++) CHECK(sameRecord(Found[i], *Expected[i]));
+    }
+    for (size_t r = 0; r < sizeof(Ranges) / sizeof(Ranges[0]); r++) {
+        CHECK(sameStats(history.ruleStats(Ranges[r][0], Ranges[r][1]), expectStats(Records, Ranges[r][0], Ranges[r][1])));
+    }
+    std::vector<MatchRecord> Found;
+    CHECK_EQ(history.playerHistory("nobody", 10, Found), 0u);
+    CHECK_EQ(history.playerTotals("nobody").hands, 0u);
+}
+
+void testQueries() {
+    const std::string path = "HistoryTest";
+    removeHistory(path);
+    std::vector<MatchRecord> Records = makeRecords(playHands(700));
+    RuleStats All = expectStats(Records, 0, UINT32_MAX);
+    CHECK(All.draws > 0);
+    CHECK(All.winners > 0);
+    MatchHistory::Config config;
+    config.path = path;
+    config.segmentRows = 128;
+    {
+        MatchHistory history(config);
+        CHECK(history.open());
+        for (size_t h = 0; h < 500; h++) history.append(Records[h]);
+        history.waitSealed();
+        CHECK_EQ(history.getSealedHands(), 384u);
+        CHECK_EQ(history.getSegmentCount(), 4u);
+        //原始宽度每局 4 + 16 + 3 + 32 + 4 + 4 + 8 + 32 = 103 字节
+        CHECK(history.getStoredBytes() < history.getSealedHands() * 103 / 2);
+        std::vector<MatchRecord> Partial(Records.begin(), Records.begin() + 500);
+        checkQueries(history, Partial);
+        std::printf("[HistoryTest] 压缩后每局 %.1f 字节（原始宽度 103 字节）\n", 1.0 * history.getStoredBytes() / history.getSealedHands());
+    }
+    {
+        //重新打开：关闭时压缩的最后一段照常读取，新追加的局写进新段
+        MatchHistory history(config);
+        CHECK(history.open());
+        std::vector<MatchRecord> Partial(Records.begin(), Records.begin() + 500);
+        checkQueries(history, Partial);
+        for (size_t h = 500; h < Records.size(); h++) history.append(Records[h]);
+        checkQueries(history, Records);
+    }
+    {
+        MatchHistory history(config);
+        CHECK(history.open());
+        checkQueries(history, Records);
+    }
+    removeHistory(path);
+}
+
+void testKilled() {
+    const std::string path = "HistoryTest_killed";
+    removeHistory(path);
+    std::vector<MatchRecord> Records = makeRecords(playHands(200));
+    MatchHistory::Config config;
+    config.path = path;
+    config.segmentRows = 128;
+    pid_t pid = fork();
+    if (pid == 0) {
+        MatchHistory *pHistory = new MatchHistory(config);
+        if (!pHistory->open()) _exit(1);
+        for (size_t h = 0; h < Records.size(); h++) pHistory->append(Records[h]);
+        _exit(0);       //不关闭：写入段未压缩，后台线程可能还没压缩完第一段
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    MatchHistory history(config);
+    CHECK(history.open());
+    history.waitSealed();
+    checkQueries(history, Records);
+    CHECK_EQ(history.getSealedHands(), 128u);
+    removeHistory(path);
+}
+
+void testRoomHistory() {
+    const std::string path = "HistoryTest_room";
+    removeHistory(path);
+    MatchHistory::Config config;
+    config.path = path;
+    MatchHistory history(config);
+    CHECK(history.open());
+    {
+        Room room("history_room");
+        room.setMatchHistory(&history);
+        room.setBotPolicy(std::chrono::milliseconds(10), BotLevel_Normal);
+        std::shared_ptr<TestPlayer> human = std::make_shared<TestPlayer>("human");
+        CHECK(room.addPlayer(human));
+        CHECK(room.tick(std::chrono::steady_clock::now() + std::chrono::milliseconds(100)));
+        for (int n = 0; n < 300 && !human->isGameEnd() && stepHuman(room, 0); n++) {}
+        CHECK(human->isGameEnd());
+    }
+    CHECK_EQ(history.getHandCount(), 1u);
+    std::vector<MatchRecord> Found;
+    CHECK_EQ(history.playerHistory("human", 10, Found), 1u);
+    if (!Found.empty()) {
+        CHECK(Found[0].playerIds[0] == "human");
+        for (int s = 1; s < GAME_PLAYER; s++) CHECK(Found[0].playerIds[s].empty());
+        int64_t lTotal = 0;
+        for (int s = 0; s < GAME_PLAYER; s++) lTotal += Found[0].score[s];
+        CHECK_EQ(lTotal, 0);
+        CHECK_EQ(history.playerTotals("human").score, Found[0].score[0]);
+    }
+    history.close();
+    removeHistory(path);
+}
+
+} // namespace
+
+int main() {
+    TestUtil::muteStdout();
+    testQueries();
+    testKilled();
+    testRoomHistory();
+    return TestUtil::finish("HistoryTest");
+}
@@ -0,0 +1,222 @@
+//
+// HuTableTest.cpp
+// 查表法胡牌判定测试：与组合搜索 GameLogic::analyseCardBySearch 逐手对照
+//
+// - 穷举单门序数牌、字牌的全部手牌（2/5/8/11/14 张，每种不超过 4 张），以及跨花色的全部 2、5 张手牌；
+// - 随机抽取的混合手牌、随机拼出的胡牌，以及带碰、杠组合的手牌；
+// 对照内容：能否胡牌、拆法集合（组合搜索的结果去重后比较）、是否存在含顺子 / 全刻子的拆法，
+// 以及 analyseCanHuCard 与原来 analyseCard + canHu 的结果。
+//
+
+#include "TestUtil.h"
+#include "GameLogic.h"
+#include "HuTable.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+size_t g_handCount = 0;
+size_t g_huCount = 0;
+
+// 拆法的规范形式：面子排序后连同牌眼拼成字符串
+std::string normalize(const tagAnalyseItem &item) {
+    std::vector<uint16_t> melds;
+    for (uint8_t i = 0; i < MAX_WEAVE; i++) {
+        melds.push_back(static_cast<uint16_t>((item.cbWeaveKind[i] << 8) | item.cbCenterCard[i]));
+    }
+    std::sort(melds.begin(), melds.end());
+    std::string key(1, static_cast<char>(item.cbCardEye));
+    for (size_t i = 0; i < melds.size(); i++) {
+        key.push_back(static_cast<char>(melds[i] >> 8));
+        key.push_back(static_cast<char>(melds[i] & 0xFF));
+    }
+    return key;
+}
+
+std::set<std::string> normalizeAll(const CAnalyseItemArray &items) {
+    std::set<std::string> keys;
+    for (size_t i = 0; i < items.size(); i++) {
+        keys.insert(normalize(items[i]));
+    }
+    return keys;
+}
+
+// 对照一手牌（cbCardIndex 为手牌，WeaveItem 为碰、杠组合）
+void compareHand(const uint8_t cbCardIndex[MAX_INDEX], tagWeaveItem WeaveItem[], uint8_t cbWeaveCount) {
+    uint8_t cbCardCount = 0;
+    for (uint8_t i = 0; i < MAX_INDEX; i++) {
+        cbCardCount += cbCardIndex[i];
+    }
+    CAnalyseItemArray searchItems, tableItems;
+    bool bSearch = GameLogic::analyseCardBySearch(cbCardIndex, cbCardCount, WeaveItem, cbWeaveCount, searchItems);
+    bool bTable = GameLogic::analyseCard(cbCardIndex, cbCardCount, WeaveItem, cbWeaveCount, tableItems);
+    g_handCount++;
+    if (bSearch) g_huCount++;
+
+    bool bSame = (bSearch == bTable) && normalizeAll(searchItems) == normalizeAll(tableItems);
+    // 查表结果本身不应有重复
+    bSame = bSame && normalizeAll(tableItems).size() == tableItems.size();
+
+    // 含顺子 / 全刻子
+    bool bWithSequence = false, bAllTriplet = false;
+    for (size_t i = 0; i < searchItems.size(); i++) {
+        bool bLian = false;
+        for (uint8_t j = cbWeaveCount; j < MAX_WEAVE; j++) {
+            bLian = bLian || (searchItems[i].cbWeaveKind[j] & WIK_S) != 0;
+        }
+        bWithSequence = bWithSequence || bLian;
+        bAllTriplet = bAllTriplet || !bLian;
+    }
+    uint8_t cbFlags = HuTable::instance().analyse(cbCardIndex);
+    bSame = bSame && ((cbFlags & HU_COMPLETE) != 0) == bSearch
+                  && ((cbFlags & HU_WITH_SEQUENCE) != 0) == bWithSequence
+                  && ((cbFlags & HU_ALL_TRIPLET) != 0) == bAllTriplet;
+
+    // analyseCanHuCard：去掉一张再作为当前牌加回，与原来的 analyseCard + canHu 对照
+    for (uint8_t i = 0; i < MAX_INDEX && bSame; i++) {
+        if (cbCardIndex[i] == 0) continue;
+        uint8_t cbHand[MAX_INDEX];
+        memcpy(cbHand, cbCardIndex, sizeof(cbHand));
+        cbHand[i]--;
+        bool bCanHu = GameLogic::analyseCanHuCard(cbHand, WeaveItem, cbWeaveCount, GameLogic::switchToCardData(i));
+        bool bExpected = GameLogic::canHu(cbCardIndex, cbCardCount, cbHand, static_cast<uint8_t>(cbCardCount - 1), WeaveItem, cbWeaveCount, searchItems);
+        bSame = bCanHu == bExpected;
+        break;
+    }
+
+    if (!bSame) {
+        std::printf("不一致的手牌:");
+        for (uint8_t i = 0; i < MAX_INDEX; i++) {
+            if (cbCardIndex[i] != 0) std::printf(" %02x×%d", GameLogic::switchToCardData(i), cbCardIndex[i]);
+        }
+        std::printf(" (组合 %d) search=%d/%zu table=%d/%zu\n", cbWeaveCount, bSearch, searchItems.size(), bTable, tableItems.size());
+    }
+    CHECK(bSame);
+}
+
+// 穷举一门牌 [cbBegin, cbBegin + cbSize) 的所有手牌
+void enumerateSuit(uint8_t cbCardIndex[MAX_INDEX], uint8_t cbBegin, uint8_t cbSize, uint8_t cbPos, uint8_t cbCount) {
+    if (cbPos == cbSize) {
+        if (cbCount >= 2 && (cbCount - 2) % 3 == 0) {
+            compareHand(cbCardIndex, nullptr, 0);
+        }
+        return;
+    }
+    for (uint8_t c = 0; c <= 4 && cbCount + c <= MAX_COUNT; c++) {
+        cbCardIndex[cbBegin + cbPos] = c;
+        enumerateSuit(cbCardIndex, cbBegin, cbSize, static_cast<uint8_t>(cbPos + 1), static_cast<uint8_t>(cbCount + c));
+    }
+    cbCardIndex[cbBegin + cbPos] = 0;
+}
+
+// 穷举全部 34 种牌中恰好 cbRemain 张的手牌（跨花色）
+void enumerateAll(uint8_t cbCardIndex[MAX_INDEX], uint8_t cbPos, uint8_t cbRemain) {
+    if (cbRemain == 0) {
+        compareHand(cbCardIndex, nullptr, 0);
+        return;
+    }
+    if (cbPos == MAX_INDEX) return;
+    for (uint8_t c = 0; c <= 4 && c <= cbRemain; c++) {
+        cbCardIndex[cbPos] = c;
+        enumerateAll(cbCardIndex, static_cast<uint8_t>(cbPos + 1), static_cast<uint8_t>(cbRemain - c));
+    }
+    cbCardIndex[cbPos] = 0;
+}
+
+void testExhaustiveSuits() {
+    uint8_t cbCardIndex[MAX_INDEX];
+    memset(cbCardIndex, 0, sizeof(cbCardIndex));
+    size_t before = g_handCount;
+    enumerateSuit(cbCardIndex, 0, 9, 0, 0);        // 筒子
+    enumerateSuit(cbCardIndex, 27, 7, 0, 0);       // 字牌
+    enumerateAll(cbCardIndex, 0, 2);
+    enumerateAll(cbCardIndex, 0, 5);
+    std::printf("[HuTableTest] 穷举单门手牌及全部 2、5 张手牌共 %zu 手\n", g_handCount - before);
+}
+
+// 随机摸牌：大部分不能胡
+void testRandomHands(std::mt19937 &rng) {
+    std::vector<uint8_t> wall;
+    for (uint8_t i = 0; i < MAX_INDEX; i++) {
+        for (int k = 0; k < 4; k++) wall.push_back(i);
+    }
+    const uint8_t sizes[] = {2, 5, 8, 11, 14};
+    for (int n = 0; n < 100000; n++) {
+        std::shuffle(wall.begin(), wall.end(), rng);
+        uint8_t cbCardIndex[MAX_INDEX];
+        memset(cbCardIndex, 0, sizeof(cbCardIndex));
+        uint8_t cbSize = sizes[n % 5];
+        for (uint8_t i = 0; i < cbSize; i++) cbCardIndex[wall[i]]++;
+        compareHand(cbCardIndex, nullptr, 0);
+    }
+}
+
+// 随机拼出胡牌（面子 + 将），部分面子作为碰、杠组合
+void testRandomWinningHands(std::mt19937 &rng) {
+    for (int n = 0; n < 100000; n++) {
+        uint8_t cbCardIndex[MAX_INDEX];
+        memset(cbCardIndex, 0, sizeof(cbCardIndex));
+        uint8_t cbUsed[MAX_INDEX];
+        memset(cbUsed, 0, sizeof(cbUsed));
+        tagWeaveItem WeaveItem[MAX_WEAVE];
+        memset(WeaveItem, 0, sizeof(WeaveItem));
+        uint8_t cbWeaveCount = static_cast<uint8_t>(rng() % 3 == 0 ? rng() % 4 : 0);
+        // 偏向同一门，制造更多的拆法
+        uint8_t cbSuit = static_cast<uint8_t>(rng() % 4);
+
+        for (uint8_t m = 0; m < MAX_WEAVE; m++) {
+            for (int attempt = 0; attempt < 20; attempt++) {
+                uint8_t cbGroup = static_cast<uint8_t>(rng() % 2 == 0 ? cbSuit : rng() % 4);
+                bool bSequence = cbGroup < 3 && rng() % 2 == 0 && m >= cbWeaveCount;
+                if (bSequence) {
+                    uint8_t i = static_cast<uint8_t>(cbGroup * 9 + rng() % 7);
+                    if (cbUsed[i] < 4 && cbUsed[i + 1] < 4 && cbUsed[i + 2] < 4) {
+                        cbUsed[i]++; cbUsed[i + 1]++; cbUsed[i + 2]++;
+                        cbCardIndex[i]++; cbCardIndex[i + 1]++; cbCardIndex[i + 2]++;
+                        break;
+                    }
+                } else {
+                    uint8_t i = static_cast<uint8_t>(cbGroup * 9 + rng() % (cbGroup < 3 ? 9 : 7));
+                    if (cbUsed[i] + 3 <= 4) {
+                        cbUsed[i] += 3;
+                        if (m < cbWeaveCount) {
+                            WeaveItem[m].cbWeaveKind = WIK_P;
+                            WeaveItem[m].cbCenterCard = GameLogic::switchToCardData(i);
+                        } else {
+                            cbCardIndex[i] += 3;
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+        for (int attempt = 0; attempt < 20; attempt++) {
+            uint8_t cbGroup = static_cast<uint8_t>(rng() % 2 == 0 ? cbSuit : rng() % 4);
+            uint8_t i = static_cast<uint8_t>(cbGroup * 9 + rng() % (cbGroup < 3 ? 9 : 7));
+            if (cbUsed[i] + 2 <= 4) {
+                cbUsed[i] += 2;
+                cbCardIndex[i] += 2;
+                break;
+            }
+        }
+        compareHand(cbCardIndex, WeaveItem, cbWeaveCount);
+    }
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(20180705);
+    testExhaustiveSuits();
+    testRandomHands(rng);
+    testRandomWinningHands(rng);
+    std::printf("[HuTableTest] 共对照 %zu 手，其中可胡 %zu 手\n", g_handCount, g_huCount);
+    return TestUtil::finish("HuTableTest");
+}
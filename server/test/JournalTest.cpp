@@ -0,0 +1,417 @@
+//
+// JournalTest.cpp
+// 崩溃恢复日志测试
+//
+// - 一个房间（一位真人加补位机器人）连打多局后停在局中，另一个房间四位真人停在局中，第三个房间打完后解散；
+//   日志不关桌直接丢弃房间（相当于进程崩溃），重新打开日志恢复出前两个房间，状态与崩溃前逐字节一致，
+//   座位上的机器人和真人（玩家号、昵称）都对得上；文件写满后换到下一个文件；
+// - 恢复的房间在真人重连前不行动，重连后由机器人代打其余掉线座位，整局打到结束；无人重连超时后放弃本局；
+// - 日志末尾有垃圾或最后一条记录被截断时忽略这部分，其余照常恢复；
+// - 检查点写出各房间的状态后删除之前的文件，之后恢复的状态不变；
+// - 子进程开局后被 kill -9：停在两步之间被杀，恢复的状态与子进程最后报告的一致；
+//   连续打牌时被杀，恢复的牌局不早于最后报告的进度，并且可以继续打到结束。
+//
+
+#include "TestUtil.h"
+#include "RoomTestUtil.h"
+#include "NetPlayer.h"
+#include "Room.h"
+#include "RoomDirectory.h"
+#include "RoomJournal.h"
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+//重连后替换玩家的事件监听，只记录终局
+class EndWatcher : public IGameEngineEventListener {
+public:
+    EndWatcher() : m_bGameEnd(false) {}
+    bool onUserEnterEvent(IPlayer *) override { return true; }
+    bool onGameStartEvent(const CMD_S_GameStart &) override { return true; }
+    bool onSendCardEvent(const CMD_S_SendCard &) override { return true; }
+    bool onOutCardEvent(const CMD_S_OutCard &) override { return true; }
+    bool onOperateNotifyEvent(const CMD_S_OperateNotify &) override { return true; }
+    bool onOperateResultEvent(const CMD_S_OperateResult &) override { return true; }
+    bool onGameEndEvent(const CMD_S_GameEnd &) override {
+        m_bGameEnd = true;
+        return true;
+    }
+    bool isGameEnd() const { return m_bGameEnd; }
+
+private:
+    bool m_bGameEnd;
+};
+
+void removeJournal(const std::string &path) {
+    for (unsigned seq = 1; seq < 200; seq++) {
+        char suffix[16];
+        std::snprintf(suffix, sizeof(suffix), ".%08u", seq);
+        std::remove((path + suffix).c_str());
+    }
+}
+
+bool fileExists(const std::string &path, unsigned seq) {
+    char suffix[16];
+    std::snprintf(suffix, sizeof(suffix), ".%08u", seq);
+    return access((path + suffix).c_str(), F_OK) == 0;
+}
+
+bool sameState(const tagGameState &a, const tagGameState &b) {
+    return std::memcmp(&a, &b, sizeof(tagGameState)) == 0;
+}
+
+const RecoveredRoom *findRecovered(const std::vector<RecoveredRoom> &rooms, const std::string &roomId) {
+    for (size_t i = 0; i < rooms.size(); i++) {
+        if (rooms[i].roomId == roomId) return &rooms[i];
+    }
+    return nullptr;
+}
+
+// 一位真人加补位机器人开局
+std::shared_ptr<TestPlayer> startWithBots(Room &room, const std::string &playerId) {
+    room.setBotPolicy(std::chrono::milliseconds(10), BotLevel_Normal);
+    std::shared_ptr<TestPlayer> human = std::make_shared<TestPlayer>(playerId, "nick_" + playerId);
+    room.addPlayer(human);
+    room.tick(Clock::now() + std::chrono::milliseconds(100));
+    return human;
+}
+
+// 恢复的房间：重连座位上的真人，其余真人座位继续由机器人代打，打到本局结束，返回是否结束；
+// 崩溃前的最后一步可能正好结束了本局（真人无事可做），这时开下一局再打完
+bool resumeToEnd(Room &room, const std::string &playerId) {
+    bool allowRestart = true;
+    std::shared_ptr<NetPlayer> player = room.reconnectPlayer(playerId, -1, nullptr);
+    if (!player) return false;
+    EndWatcher watcher;
+    player->setGameEngineEventListener(&watcher);
+    for (int n = 0; n < 800 && !watcher.isGameEnd(); n++) {
+        if (stepHumans(room)) continue;
+        if (!allowRestart) break;
+        allowRestart = false;
+        room.restartGame();
+    }
+    player->setGameEngineEventListener(player.get());
+    return watcher.isGameEnd();
+}
+
+void testCrashRecovery() {
+    const std::string path = "JournalTest_crash";
+    removeJournal(path);
+    RoomJournal::Config config;
+    config.path = path;
+    config.fileBytes = 64 * 1024;
+    tagGameState StateA, StateB;
+    size_t hands = 0;
+    {
+        RoomJournal journal(config);
+        std::vector<RecoveredRoom> recovered;
+        CHECK(journal.open(recovered));
+        CHECK(recovered.empty());
+
+        Room roomA("room_a");
+        roomA.setJournal(&journal);
+        std::shared_ptr<TestPlayer> a0 = startWithBots(roomA, "a0");
+        CHECK(roomA.getState() == RoomState::PLAYING);
+        //连打多局，文件写满后换文件
+        while (fileExists(path, 1) && !fileExists(path, 2) && hands < 200) {
+            for (int n = 0; n < 400 && !a0->isGameEnd() && stepHumans(roomA); n++) {}
+            CHECK(a0->isGameEnd());
+            CHECK(roomA.restartGame());
+            hands++;
+        }
+        CHECK(fileExists(path, 2));
+        for (int n = 0; n < 5; n++) stepHumans(roomA);
+
+        Room roomB("room_b");
+        roomB.setJournal(&journal);
+        std::shared_ptr<TestPlayer> b[GAME_PLAYER];
+        for (int i = 0; i < GAME_PLAYER; i++) {
+            b[i] = std::make_shared<TestPlayer>("b" + std::to_string(i), "nick_b" + std::to_string(i));
+            CHECK(roomB.addPlayer(b[i]));
+        }
+        roomB.startGame();
+        for (int n = 0; n < 12; n++) stepHumans(roomB);
+        CHECK(roomB.onPlayerDisconnect("b2"));      //掉线由机器人代打，恢复后仍是真人座位
+
+        Room roomC("room_c");
+        roomC.setJournal(&journal);
+        std::shared_ptr<TestPlayer> c0 = startWithBots(roomC, "c0");
+        for (int n = 0; n < 400 && !c0->isGameEnd() && stepHumans(roomC); n++) {}
+        roomC.finishGame();                         //解散，不再恢复
+
+        StateA = roomA.getGameEngine()->getGameState();
+        StateB = roomB.getGameEngine()->getGameState();
+        CHECK(journal.getAppendedBytes() > 0);
+        journal.close();                            //房间不关桌：相当于进程在这里崩溃
+    }
+
+    RoomJournal journal(config);
+    std::vector<RecoveredRoom> recovered;
+    RecoveryStats stats;
+    CHECK(journal.open(recovered, &stats));
+    CHECK_EQ(recovered.size(), 2u);
+    CHECK(stats.files >= 2);
+    CHECK_EQ(stats.tornFiles, 0u);
+    std::printf("[JournalTest] %zu 局后崩溃，%zu 个文件 %llu 条记录，重放 %llu 条命令，恢复 %zu 个房间，%.2f ms\n", hands,
+                stats.files, static_cast<unsigned long long>(stats.records), static_cast<unsigned long long>(stats.commands),
+                stats.rooms, stats.seconds * 1000);
+    const RecoveredRoom *pA = findRecovered(recovered, "room_a");
+    const RecoveredRoom *pB = findRecovered(recovered, "room_b");
+    CHECK(pA != nullptr && pB != nullptr && findRecovered(recovered, "room_c") == nullptr);
+    if (pA == nullptr || pB == nullptr) return;
+    CHECK(sameState(pA->state, StateA));
+    CHECK(sameState(pB->state, StateB));
+    CHECK(!pA->seats[0].bot && pA->seats[0].playerId == "a0" && pA->seats[0].nickname == "nick_a0");
+    CHECK(pA->seats[1].bot && pA->seats[2].bot && pA->seats[3].bot);
+    CHECK(!pB->seats[2].bot && pB->seats[2].playerId == "b2" && pB->seats[2].nickname == "nick_b2");
+
+    //恢复后真人重连前不行动
+    Room roomA("room_a");
+    roomA.setBotPolicy(std::chrono::milliseconds(10), BotLevel_Normal);
+    roomA.setJournal(&journal);
+    CHECK(roomA.recoverFromJournal(*pA));
+    CHECK(roomA.getState() == RoomState::PLAYING);
+    CHECK(roomA.isBotSeat(0));
+    CHECK(!roomA.tick(Clock::now()));
+    CHECK(sameState(roomA.getGameEngine()->getGameState(), StateA));
+    CHECK(roomA.getPlayerById("a0") != nullptr);
+    CHECK(resumeToEnd(roomA, "a0"));
+    CHECK(roomA.restartGame());                     //恢复后的下一局照常写日志
+
+    //四位真人的房间只有一位重连，其余三个座位由机器人代打
+    Room roomB("room_b");
+    roomB.setJournal(&journal);
+    CHECK(roomB.recoverFromJournal(*pB));
+    CHECK(resumeToEnd(roomB, "b1"));
+    CHECK(!roomB.isBotSeat(1) && roomB.isBotSeat(0) && roomB.isBotSeat(2));
+
+    //无人重连：超时后放弃本局，房间空闲
+    Room roomIdle("room_b");
+    CHECK(roomIdle.recoverFromJournal(*pB));
+    CHECK(!roomIdle.isIdle());
+    CHECK(!roomIdle.tick(Clock::now() + std::chrono::seconds(301)));
+    CHECK(roomIdle.isIdle());
+    CHECK(roomIdle.reconnectPlayer("b0", -1, nullptr) == nullptr);
+
+    //继续打的房间再次崩溃：room_a 在新一局中，room_b 这局已结束（下一局未开始）仍可恢复
+    tagGameState StateA2 = roomA.getGameEngine()->getGameState();
+    journal.close();
+    RoomJournal again(config);
+    CHECK(again.open(recovered));
+    pA = findRecovered(recovered, "room_a");
+    CHECK(pA != nullptr && sameState(pA->state, StateA2));
+    again.close();
+    removeJournal(path);
+}
+
+void testTornTail() {
+    const std::string path = "JournalTest_torn";
+    removeJournal(path);
+    RoomJournal::Config config;
+    config.path = path;
+    config.sync = JournalSync::None;
+    tagGameState State;
+    {
+        RoomJournal journal(config);
+        std::vector<RecoveredRoom> recovered;
+        CHECK(journal.open(recovered));
+        Room room("room_t");
+        room.setJournal(&journal);
+        startWithBots(room, "t0");
+        for (int n = 0; n < 6; n++) stepHumans(room);
+        State = room.getGameEngine()->getGameState();
+        journal.close();
+    }
+    //文件末尾追加半条记录
+    FILE *pFile = std::fopen((path + ".00000001").c_str(), "ab");
+    CHECK(pFile != nullptr);
+    if (pFile == nullptr) return;
+    const uint8_t cbGarbage[10] = {0x12, 0x34, 0x56, 0x78, 0x20, 0, 4, 0, 1, 0};
+    std::fwrite(cbGarbage, 1, sizeof(cbGarbage), pFile);
+    std::fclose(pFile);
+
+    RoomJournal journal(config);
+    std::vector<RecoveredRoom> recovered;
+    RecoveryStats stats;
+    CHECK(journal.open(recovered, &stats));
+    CHECK_EQ(stats.tornFiles, 1u);
+    CHECK_EQ(recovered.size(), 1u);
+    CHECK(!recovered.empty() && sameState(recovered[0].state, State));
+    journal.close();
+    removeJournal(path);
+}
+
+void testCheckpoint() {
+    const std::string path = "JournalTest_checkpoint";
+    removeJournal(path);
+    RoomJournal::Config config;
+    config.path = path;
+    RoomJournal journal(config);
+    std::vector<RecoveredRoom> recovered;
+    CHECK(journal.open(recovered));
+
+    RoomDirectory::Config roomConfig;
+    roomConfig.preallocatedRooms = 4;
+    RoomDirectory rooms(roomConfig);
+    rooms.setJournal(&journal, std::chrono::milliseconds(0));
+    std::shared_ptr<TestPlayer> humans[3];
+    for (int r = 0; r < 3; r++) {
+        std::shared_ptr<Room> room = rooms.getOrCreate("cp" + std::to_string(r));
+        room->setJournal(&journal);
+        humans[r] = startWithBots(*room, "cp_player" + std::to_string(r));
+        for (int n = 0; n < 3 + r; n++) stepHumans(*room);
+    }
+    rooms.getOrCreate("cp1")->finishGame();
+    CHECK_EQ(rooms.checkpoint(), 2u);
+    CHECK(!fileExists(path, 1));
+    CHECK(fileExists(path, 2));
+    //检查点之后继续打
+    std::shared_ptr<Room> room0 = rooms.getOrCreate("cp0");
+    for (int n = 0; n < 4; n++) stepHumans(*room0);
+    tagGameState State0 = room0->getGameEngine()->getGameState();
+    tagGameState State2 = rooms.getOrCreate("cp2")->getGameEngine()->getGameState();
+    journal.close();
+
+    RoomJournal reopened(config);
+    RecoveryStats stats;
+    CHECK(reopened.open(recovered, &stats));
+    CHECK_EQ(stats.files, 1u);
+    CHECK_EQ(recovered.size(), 2u);
+    const RecoveredRoom *p0 = findRecovered(recovered, "cp0");
+    const RecoveredRoom *p2 = findRecovered(recovered, "cp2");
+    CHECK(p0 != nullptr && sameState(p0->state, State0));
+    CHECK(p2 != nullptr && sameState(p2->state, State2));
+    CHECK(p2 != nullptr && p2->seats[0].playerId == "cp_player2");
+    reopened.close();
+    removeJournal(path);
+}
+
+// 子进程每走一步向管道报告本局种子、剩余牌数和状态
+struct tagProgress {
+    uint64_t llGameSeed;
+    uint32_t dwHands;
+    uint8_t cbLeftCardCount;
+    tagGameState State;
+};
+
+// 子进程：开局后连续打 steps 步（0 为一直打），每步报告一次，之后停住等待被杀
+void childPlay(const RoomJournal::Config &config, int fd, int steps) {
+    RoomJournal journal(config);
+    std::vector<RecoveredRoom> recovered;
+    journal.open(recovered);
+    Room room("room_k");
+    room.setJournal(&journal);
+    std::shared_ptr<TestPlayer> human = startWithBots(room, "k0");
+    tagProgress Progress;
+    std::memset(&Progress, 0, sizeof(Progress));
+    for (int n = 0; steps == 0 || n < steps; n++) {
+        if (human->isGameEnd()) {
+            room.restartGame();
+            Progress.dwHands++;
+        } else if (!stepHumans(room)) {
+            continue;
+        }
+        const tagGameState &State = room.getGameEngine()->getGameState();
+        Progress.llGameSeed = State.llGameSeed;
+        Progress.cbLeftCardCount = State.cbLeftCardCount;
+        Progress.State = State;
+        if (write(fd, &Progress, sizeof(Progress)) != static_cast<ssize_t>(sizeof(Progress))) break;
+    }
+    for (;;) pause();
+}
+
+// fork 子进程打牌，读到 reports 次报告后 kill -9，返回最后读到的报告
+bool killChild(const RoomJournal::Config &config, int steps, int reports, tagProgress &Last) {
+    int fds[2];
+    if (pipe(fds) != 0) return false;
+    std::fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        childPlay(config, fds[1], steps);
+        _exit(0);
+    }
+    close(fds[1]);
+    int received = 0;
+    while (received < reports) {
+        size_t got = 0;
+        uint8_t *pBytes = reinterpret_cast<uint8_t *>(&Last);
+        while (got < sizeof(Last)) {
+            ssize_t n = read(fds[0], pBytes + got, sizeof(Last) - got);
+            if (n <= 0) break;
+            got += static_cast<size_t>(n);
+        }
+        if (got < sizeof(Last)) break;
+        received++;
+    }
+    kill(pid, SIGKILL);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    close(fds[0]);
+    return received == reports && WIFSIGNALED(status) && WTERMSIG(status) == SIGKILL;
+}
+
+void testKill9() {
+    const std::string path = "JournalTest_kill";
+    RoomJournal::Config config;
+    config.path = path;
+
+    //停在两步之间被杀（每条记录都等落盘）：恢复的状态与最后的报告逐字节一致
+    removeJournal(path);
+    config.sync = JournalSync::Always;
+    tagProgress Last;
+    CHECK(killChild(config, 8, 8, Last));
+    {
+        RoomJournal journal(config);
+        std::vector<RecoveredRoom> recovered;
+        CHECK(journal.open(recovered));
+        CHECK_EQ(recovered.size(), 1u);
+        CHECK(!recovered.empty() && sameState(recovered[0].state, Last.State));
+        journal.close();
+    }
+
+    //连续打牌时被杀（不主动落盘，进程被杀不丢页缓存）：恢复的进度不早于最后的报告，且能继续打完
+    removeJournal(path);
+    config.sync = JournalSync::None;
+    CHECK(killChild(config, 0, 300, Last));
+    RoomJournal journal(config);
+    std::vector<RecoveredRoom> recovered;
+    RecoveryStats stats;
+    CHECK(journal.open(recovered, &stats));
+    CHECK_EQ(recovered.size(), 1u);
+    if (recovered.empty()) return;
+    const tagGameState &State = recovered[0].state;
+    CHECK(State.llGameSeed != Last.llGameSeed || State.cbLeftCardCount <= Last.cbLeftCardCount);
+    std::printf("[JournalTest] kill -9：报告第 %u 局剩余 %u 张，恢复 %s剩余 %u 张（重放 %llu 条命令）\n", Last.dwHands,
+                Last.cbLeftCardCount, State.llGameSeed == Last.llGameSeed ? "同一局" : "下一局", State.cbLeftCardCount,
+                static_cast<unsigned long long>(stats.commands));
+    Room room("room_k");
+    room.setJournal(&journal);
+    CHECK(room.recoverFromJournal(recovered[0]));
+    CHECK(resumeToEnd(room, "k0"));
+    journal.close();
+    removeJournal(path);
+}
+
+} // namespace
+
+int main() {
+    TestUtil::muteStdout();
+    testCrashRecovery();
+    testTornTail();
+    testCheckpoint();
+    testKill9();
+    return TestUtil::finish("JournalTest");
+}
@@ -0,0 +1,215 @@
+//
+// LeaderboardTest.cpp
+// 排行榜测试
+//
+// - 300 位玩家的 20000 次积分更新，时间跨越三周（夹杂早于当前周期的更新），每 1000 次更新后
+//   总榜、日榜、周榜的名次、积分和整榜顺序都与逐条累加的结果一致；时间放在未来，后台线程按时钟换榜不影响结果；
+// - 写快照后关闭，重新打开时各榜不变，之后继续累加；损坏的快照无法打开；
+// - 房间开启排行榜后，真人加补位机器人打完一局，总榜上只有真人，积分等于本局的单局积分。
+//
+
+#include "TestUtil.h"
+#include "RoomTestUtil.h"
+#include "Leaderboard.h"
+#include "NetPlayer.h"
+#include "Room.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int32_t kUtcOffset = 8 * 3600;
+
+// 逐条累加的参考实现：每个榜一个 map，进入新周期时清空
+struct RefBoard {
+    std::map<std::string, int64_t> Scores[Leaderboard::kWindowCount];
+    uint32_t dwPeriod[Leaderboard::kWindowCount];
+
+    RefBoard() { for (int w = 0; w < Leaderboard::kWindowCount; w++) dwPeriod[w] = 0; }
+
+    static uint32_t periodOf(int w, uint32_t dwTime) {
+        int64_t llDay = (static_cast<int64_t>(dwTime) + kUtcOffset) / 86400;
+        if (w == static_cast<int>(LeaderboardWindow::Daily)) return static_cast<uint32_t>(llDay);
+        if (w == static_cast<int>(LeaderboardWindow::Weekly)) return static_cast<uint32_t>((llDay + 3) / 7);
+        return 0;
+    }
+
+    void add(const std::string &playerId, int64_t lDelta, uint32_t dwTime) {
+        for (int w = 0; w < Leaderboard::kWindowCount; w++) {
+            uint32_t dwP = periodOf(w, dwTime);
+            if (dwP < dwPeriod[w]) continue;
+            if (dwP > dwPeriod[w]) {
+                Scores[w].clear();
+                dwPeriod[w] = dwP;
+            }
+            Scores[w][playerId] += lDelta;
+        }
+    }
+
+    //积分降序；积分相同时先登记的玩家在前
+    std::vector<std::string> sorted(int w, const std::map<std::string, uint32_t> &Order) const {
+        std::vector<std::string> Ids;
+        for (std::map<std::string, int64_t>::const_iterator it = Scores[w].begin(); it != Scores[w].end(); ++it) Ids.push_back(it->first);
+        const std::map<std::string, int64_t> &S = Scores[w];
+        std::sort(Ids.begin(), Ids.end(), [&S, &Order](const std::string &a, const std::string &b) {
+            int64_t la = S.find(a)->second, lb = S.find(b)->second;
+            return la > lb || (la == lb && Order.find(a)->second < Order.find(b)->second);
+        });
+        return Ids;
+    }
+};
+
+// 从当前时间起 60 天后的周一 0 点（按 kUtcOffset），之后三周内后台线程不会按时钟换榜
+uint32_t futureMonday() {
+    int64_t llDay = (static_cast<int64_t>(std::time(nullptr)) + kUtcOffset) / 86400 + 60;
+    llDay = (llDay + 3) / 7 * 7 - 3 + 7;
+    return static_cast<uint32_t>(llDay * 86400 - kUtcOffset);
+}
+
+void checkBoards(const Leaderboard &board, const RefBoard &Ref, const std::map<std::string, uint32_t> &Order) {
+    for (int w = 0; w < Leaderboard::kWindowCount; w++) {
+        LeaderboardWindow window = static_cast<LeaderboardWindow>(w);
+        std::vector<std::string> Expected = Ref.sorted(w, Order);
+        CHECK_EQ(board.size(window), Expected.size());
+        std::vector<LeaderboardEntry> Entries;
+        CHECK_EQ(board.range(window, 0, Expected.size() + 10, Entries), Expected.size());
+        bool bSame = Entries.size() == Expected.size();
+        for (size_t i = 0; bSame && i < Entries.size(); i++) {
+            bSame = Entries[i].playerId == Expected[i] && Entries[i].score == Ref.Scores[w].find(Expected[i])->second &&
+                    Entries[i].rank == i + 1;
+        }
+        CHECK(bSame);
+        for (size_t i = 0; i < Expected.size(); i++) {
+            LeaderboardEntry Entry;
+            bool bFound = board.rank(window, Expected[i], Entry);
+            if (!bFound || Entry.rank != i + 1 || Entry.score != Ref.Scores[w].find(Expected[i])->second) {
+                CHECK(false);
+                break;
+            }
+        }
+        //中间一段
+        if (Expected.size() > 20) {
+            CHECK_EQ(board.range(window, 10, 7, Entries), 7u);
+            CHECK(Entries[0].playerId == Expected[10] && Entries[0].rank == 11u && Entries[6].playerId == Expected[16]);
+        }
+        CHECK_EQ(board.range(window, Expected.size(), 5, Entries), 0u);
+    }
+    //不在日榜上的玩家
+    for (std::map<std::string, uint32_t>::const_iterator it = Order.begin(); it != Order.end(); ++it) {
+        int w = static_cast<int>(LeaderboardWindow::Daily);
+        LeaderboardEntry Entry;
+        if (Ref.Scores[w].count(it->first) == 0) {
+            CHECK(!board.rank(LeaderboardWindow::Daily, it->first, Entry));
+            break;
+        }
+    }
+}
+
+void testRanks() {
+    const std::string path = "LeaderboardTest.snapshot";
+    std::remove(path.c_str());
+    Leaderboard::Config config;
+    config.path = path;
+    config.utcOffset = kUtcOffset;
+    RefBoard Ref;
+    std::map<std::string, uint32_t> Order;
+    uint32_t dwBase = futureMonday();
+    uint32_t dwTime = dwBase;
+    uint64_t llRandom = 0x9E3779B97F4A7C15ULL;
+    {
+        Leaderboard board(config);
+        CHECK(board.open());
+        for (int n = 0; n < 20000; n++) {
+            llRandom ^= llRandom << 13;
+            llRandom ^= llRandom >> 7;
+            llRandom ^= llRandom << 17;
+            std::string playerId = "player_" + std::to_string(llRandom % 300);
+            int64_t lDelta = static_cast<int64_t>((llRandom >> 20) % 41) - 20;      // 含 0，积分相同的玩家很多
+            dwTime += static_cast<uint32_t>((llRandom >> 40) % 181);                // 平均 90 秒一次，共约三周
+            uint32_t dwAt = (llRandom >> 50) % 16 == 0 && dwTime > dwBase + 2 * 86400 ? dwTime - 2 * 86400 : dwTime;
+            if (Order.count(playerId) == 0) Order[playerId] = static_cast<uint32_t>(Order.size());
+            board.addScore(playerId, lDelta, dwAt);
+            Ref.add(playerId, lDelta, dwAt);
+            if (n % 1000 == 999) {
+                board.flush();
+                checkBoards(board, Ref, Order);
+            }
+        }
+        CHECK(dwTime - dwBase > 14 * 86400 && dwTime - dwBase < 21 * 86400);
+        CHECK_EQ(board.getAppliedUpdates(), 20000u);
+        CHECK_EQ(board.getPlayerCount(), Order.size());
+        CHECK(board.snapshot());
+    }
+
+    //重新打开：各榜不变，继续累加
+    {
+        Leaderboard board(config);
+        CHECK(board.open());
+        CHECK_EQ(board.getPlayerCount(), Order.size());
+        checkBoards(board, Ref, Order);
+        board.addScore("player_new", 1000000, dwTime);
+        Ref.add("player_new", 1000000, dwTime);
+        Order["player_new"] = static_cast<uint32_t>(Order.size());
+        board.flush();
+        LeaderboardEntry Entry;
+        CHECK(board.rank(LeaderboardWindow::Weekly, "player_new", Entry) && Entry.rank == 1u);
+        checkBoards(board, Ref, Order);
+    }
+
+    //关闭时写的快照包含最后一次更新；截断后无法打开
+    {
+        Leaderboard board(config);
+        CHECK(board.open());
+        checkBoards(board, Ref, Order);
+    }
+    FILE *pFile = std::fopen(path.c_str(), "r+b");
+    CHECK(pFile != nullptr);
+    if (pFile != nullptr) {
+        std::fseek(pFile, 0, SEEK_END);
+        long lSize = std::ftell(pFile);
+        std::fclose(pFile);
+        CHECK(truncate(path.c_str(), lSize - 5) == 0);
+        Leaderboard board(config);
+        CHECK(!board.open());
+    }
+    std::remove(path.c_str());
+}
+
+void testRoomLeaderboard() {
+    Leaderboard::Config config;
+    Leaderboard board(config);
+    CHECK(board.open());
+    std::shared_ptr<TestPlayer> human = std::make_shared<TestPlayer>("human");
+    {
+        Room room("leaderboard_room");
+        room.setLeaderboard(&board);
+        room.setBotPolicy(std::chrono::milliseconds(10), BotLevel_Normal);
+        CHECK(room.addPlayer(human));
+        CHECK(room.tick(std::chrono::steady_clock::now() + std::chrono::milliseconds(100)));
+        for (int n = 0; n < 300 && !human->isGameEnd() && stepHuman(room, 0); n++) {}
+        CHECK(human->isGameEnd());
+    }
+    board.flush();
+    CHECK_EQ(board.size(LeaderboardWindow::Total), 1u);
+    CHECK_EQ(board.size(LeaderboardWindow::Daily), 1u);
+    LeaderboardEntry Entry;
+    CHECK(board.rank(LeaderboardWindow::Total, "human", Entry));
+    CHECK_EQ(Entry.score, human->getScore());
+    CHECK_EQ(Entry.rank, 1u);
+    CHECK(!board.snapshot());       // 没有快照文件
+}
+
+} // namespace
+
+int main() {
+    TestUtil::muteStdout();
+    testRanks();
+    testRoomLeaderboard();
+    return TestUtil::finish("LeaderboardTest");
+}
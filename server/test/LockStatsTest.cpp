@@ -0,0 +1,146 @@
+//
+// LockStatsTest.cpp
+// 锁竞争统计测试：获取次数、竞争计数、直方图总数、同名汇总、报告输出和信号触发的转储
+//
+// 本测试自行编译 LockStats.cpp 并定义 MAHJONG_LOCK_STATS（见 test/CMakeLists.txt），
+// 不依赖 mahjong_core 是否开启统计；关闭时的零开销由 LockStats.h 中的 static_assert 保证。
+//
+
+#include "TestUtil.h"
+#include "LockStats.h"
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+uint64_t histogramTotal(const std::atomic<uint64_t>* histogram) {
+    uint64_t total = 0;
+    for (int i = 0; i < LockStats::kBuckets; i++) {
+        total += histogram[i].load();
+    }
+    return total;
+}
+
+void testSingleThread() {
+    InstrumentedMutex mutex("Test::single");
+    LockStats::Record* record = LockStats::record("Test::single");
+    for (int i = 0; i < 100; i++) {
+        std::lock_guard<InstrumentedMutex> lock(mutex);
+    }
+    CHECK(mutex.try_lock());
+    mutex.unlock();
+
+    CHECK_EQ(record->acquisitions.load(), 101u);
+    CHECK_EQ(record->contended.load(), 0u);
+    CHECK_EQ(histogramTotal(record->waitHistogram), 101u);
+    CHECK_EQ(histogramTotal(record->holdHistogram), 101u);
+    // 没有竞争时等待时间都记在第 0 桶
+    CHECK_EQ(record->waitHistogram[0].load(), 101u);
+}
+
+void testContention() {
+    const int kThreads = 4;
+    const int kIterations = 2000;
+    InstrumentedMutex mutex("Test::contended");
+    LockStats::Record* record = LockStats::record("Test::contended");
+    long counter = 0;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; t++) {
+        threads.push_back(std::thread([&]() {
+            for (int i = 0; i < kIterations; i++) {
+                std::lock_guard<InstrumentedMutex> lock(mutex);
+                counter++;
+                if (i % 100 == 0) {
+                    // 偶尔长时间持有，制造竞争
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                }
+            }
+        }));
+    }
+    for (size_t i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+
+    const uint64_t total = static_cast<uint64_t>(kThreads) * kIterations;
+    CHECK_EQ(counter, static_cast<long>(total));
+    CHECK_EQ(record->acquisitions.load(), total);
+    CHECK_EQ(histogramTotal(record->waitHistogram), total);
+    CHECK_EQ(histogramTotal(record->holdHistogram), total);
+    CHECK(record->contended.load() > 0);
+    CHECK(record->waitNsTotal.load() > 0);
+    // 200 微秒的持有应落在 2^17 ns 以上的桶中
+    CHECK(record->holdNsMax.load() >= 200000u);
+    uint64_t longHolds = 0;
+    for (int i = 17; i < LockStats::kBuckets; i++) {
+        longHolds += record->holdHistogram[i].load();
+    }
+    CHECK(longHolds >= static_cast<uint64_t>(kThreads * kIterations / 100));
+}
+
+void testSharedName() {
+    InstrumentedMutex a("Test::shared");
+    InstrumentedMutex b("Test::shared");
+    a.lock();
+    a.unlock();
+    b.lock();
+    b.unlock();
+    CHECK(LockStats::record("Test::shared") == LockStats::record("Test::shared"));
+    CHECK_EQ(LockStats::record("Test::shared")->acquisitions.load(), 2u);
+}
+
+void testDumpAndReset() {
+    std::ostringstream out;
+    LockStats::dump(out);
+    std::string report = out.str();
+    CHECK(report.find("Test::contended") != std::string::npos);
+    CHECK(report.find("Test::shared") != std::string::npos);
+
+    LockStats::reset();
+    CHECK_EQ(LockStats::record("Test::contended")->acquisitions.load(), 0u);
+    CHECK_EQ(histogramTotal(LockStats::record("Test::contended")->holdHistogram), 0u);
+}
+
+void testSignalDump() {
+    const std::string path = "LockStatsTest_dump.txt";
+    std::remove(path.c_str());
+    CHECK(LockStats::installDumpSignal(SIGUSR2, path));
+    {
+        InstrumentedMutex mutex("Test::signal");
+        std::lock_guard<InstrumentedMutex> lock(mutex);
+    }
+    std::raise(SIGUSR2);
+
+    // 转储在后台线程完成
+    std::string content;
+    for (int i = 0; i < 200 && content.find("Test::signal") == std::string::npos; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        std::ifstream file(path.c_str());
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        content = buffer.str();
+    }
+    CHECK(content.find("Test::signal") != std::string::npos);
+    std::remove(path.c_str());
+}
+
+} // namespace
+
+int main() {
+    TestUtil::muteStdout();
+    CHECK(LockStats::enabled());
+    testSingleThread();
+    testContention();
+    testSharedName();
+    testDumpAndReset();
+    testSignalDump();
+    return TestUtil::finish("LockStatsTest");
+}
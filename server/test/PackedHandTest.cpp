@@ -0,0 +1,178 @@
+//
+// PackedHandTest.cpp
+// 位压缩手牌测试：每项操作与 uint8_t[34] 数组的结果逐一对照
+//
+// - 随机手牌（0~14 张，含 4 张的种类）的转换、数牌、增删、按数量统计、整手比较；
+// - 位压缩的查表判定与数组版本一致（含超过 4 张的无效手牌）；
+// - GameLogic 的听牌、胡牌数量接口与逐张构造数组后查表的结果一致。
+//
+
+#include "TestUtil.h"
+#include "GameLogic.h"
+#include "HuTable.h"
+#include "PackedHand.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+void randomHand(std::mt19937 &rng, uint8_t cbCardIndex[MAX_INDEX], uint8_t cbSize) {
+    static std::vector<uint8_t> wall;
+    if (wall.empty()) {
+        for (uint8_t i = 0; i < MAX_INDEX; i++) {
+            for (int k = 0; k < 4; k++) wall.push_back(i);
+        }
+    }
+    std::shuffle(wall.begin(), wall.end(), rng);
+    memset(cbCardIndex, 0, MAX_INDEX);
+    for (uint8_t i = 0; i < cbSize; i++) cbCardIndex[wall[i]]++;
+}
+
+void testBasicOps(std::mt19937 &rng) {
+    for (int n = 0; n < 20000; n++) {
+        uint8_t cbCardIndex[MAX_INDEX];
+        randomHand(rng, cbCardIndex, static_cast<uint8_t>(n % (MAX_COUNT + 1)));
+        if (n % 7 == 0) cbCardIndex[rng() % MAX_INDEX] = 4;
+        PackedHand Hand(cbCardIndex);
+
+        uint8_t cbBack[MAX_INDEX];
+        Hand.toIndex(cbBack);
+        CHECK(memcmp(cbBack, cbCardIndex, MAX_INDEX) == 0);
+        CHECK_EQ(Hand.total(), GameLogic::getCardCount(cbCardIndex));
+
+        uint8_t cbEqual[5] = {0, 0, 0, 0, 0}, cbAtLeast[5] = {0, 0, 0, 0, 0};
+        for (uint8_t i = 0; i < MAX_INDEX; i++) {
+            CHECK_EQ(Hand.count(i), cbCardIndex[i]);
+            uint8_t cbKind = cbCardIndex[i];
+            CHECK(cbKind <= 4);             // randomHand 每种最多 4 张
+            if (cbKind > 4) continue;
+            cbEqual[cbKind]++;
+            for (uint8_t c = 0; c <= cbKind; c++) cbAtLeast[c]++;
+        }
+        for (uint8_t c = 0; c <= 4; c++) {
+            CHECK_EQ(Hand.countEqual(c), cbEqual[c]);
+            CHECK_EQ(Hand.countAtLeast(c), cbAtLeast[c]);
+        }
+        CHECK_EQ(Hand.kindCount(), cbAtLeast[1]);
+        for (uint8_t g = 0; g < 4; g++) {
+            uint8_t cbSum = 0;
+            for (uint8_t i = 0; i < (g < 3 ? 9 : 7); i++) cbSum += cbCardIndex[g * 9 + i];
+            CHECK_EQ(Hand.suitTotal(g), cbSum);
+        }
+        CHECK(!Hand.hasOverflow());
+
+        //删一张：与 GameLogic::removeCard 一致，没有时不变
+        uint8_t i = static_cast<uint8_t>(rng() % MAX_INDEX);
+        PackedHand Removed = Hand;
+        bool bRemoved = Removed.remove(i);
+        uint8_t cbRemoved[MAX_INDEX];
+        memcpy(cbRemoved, cbCardIndex, MAX_INDEX);
+        CHECK_EQ(bRemoved, GameLogic::removeCard(cbRemoved, GameLogic::switchToCardData(i)));
+        CHECK(Removed == PackedHand(cbRemoved));
+        CHECK_EQ(Removed != Hand, bRemoved);
+
+        //删多张
+        uint8_t cbCount = static_cast<uint8_t>(rng() % 5);
+        Removed = Hand;
+        bool bEnough = Removed.remove(i, cbCount);
+        CHECK_EQ(bEnough, cbCardIndex[i] >= cbCount);
+        CHECK_EQ(Removed.count(i), bEnough ? cbCardIndex[i] - cbCount : cbCardIndex[i]);
+        Removed.removeAll(i);
+        CHECK_EQ(Removed.count(i), 0);
+        CHECK_EQ(Removed.total(), Hand.total() - cbCardIndex[i]);
+
+        //加回来后相等
+        Removed.add(i, cbCardIndex[i]);
+        CHECK(Removed == Hand);
+    }
+}
+
+void testHuAgreement(std::mt19937 &rng) {
+    const HuTable &table = HuTable::instance();
+    for (int n = 0; n < 50000; n++) {
+        uint8_t cbCardIndex[MAX_INDEX];
+        randomHand(rng, cbCardIndex, static_cast<uint8_t>(2 + 3 * (n % 5)));
+        //偶尔构造 5 张（摸到第 5 张的无效手牌）
+        if (n % 11 == 0) cbCardIndex[rng() % MAX_INDEX] = 5;
+        PackedHand Hand(cbCardIndex);
+        CHECK_EQ(Hand.hasOverflow(), std::count(cbCardIndex, cbCardIndex + MAX_INDEX, 5) > 0);
+        CHECK_EQ(table.analyse(Hand), table.analyse(cbCardIndex));
+    }
+    //随机胡牌（面子 + 将）
+    for (int n = 0; n < 20000; n++) {
+        uint8_t cbCardIndex[MAX_INDEX];
+        memset(cbCardIndex, 0, sizeof(cbCardIndex));
+        for (int m = 0; m < MAX_WEAVE; m++) {
+            if (rng() % 2 == 0) {
+                uint8_t i = static_cast<uint8_t>((rng() % 3) * 9 + rng() % 7);
+                cbCardIndex[i]++; cbCardIndex[i + 1]++; cbCardIndex[i + 2]++;
+            } else {
+                cbCardIndex[rng() % MAX_INDEX] += 3;
+            }
+        }
+        cbCardIndex[rng() % MAX_INDEX] += 2;
+        if (std::count_if(cbCardIndex, cbCardIndex + MAX_INDEX, [](uint8_t c) { return c > 4; }) > 0) continue;
+        PackedHand Hand(cbCardIndex);
+        CHECK_EQ(table.analyse(Hand), table.analyse(cbCardIndex));
+        CHECK(table.isComplete(Hand));
+    }
+}
+
+void testLogicAgreement(std::mt19937 &rng) {
+    const HuTable &table = HuTable::instance();
+    tagWeaveItem WeaveItem[MAX_WEAVE];
+    memset(WeaveItem, 0, sizeof(WeaveItem));
+    size_t tingHands = 0;
+    for (int n = 0; n < 5000; n++) {
+        uint8_t cbCardIndex[MAX_INDEX];
+        randomHand(rng, cbCardIndex, MAX_COUNT - 1);
+        //对照：逐张构造数组，七对或查表
+        uint8_t cbExpected = 0;
+        tagTingResult Expected;
+        memset(&Expected, 0, sizeof(Expected));
+        for (uint8_t j = 0; j < MAX_INDEX; j++) {
+            uint8_t cbHand[MAX_INDEX];
+            memcpy(cbHand, cbCardIndex, sizeof(cbHand));
+            cbHand[j]++;
+            uint8_t cbDuiCount = 0;
+            for (uint8_t k = 0; k < MAX_INDEX; k++) cbDuiCount += cbHand[k] == 2;
+            if (cbDuiCount == 7 || table.isComplete(cbHand)) {
+                cbExpected++;
+                Expected.cbTingCard[Expected.cbTingCount++] = GameLogic::switchToCardData(j);
+            }
+        }
+        CHECK_EQ(GameLogic::analyseHuCardCount(cbCardIndex, WeaveItem, 0), cbExpected);
+        tagTingResult Result;
+        CHECK_EQ(GameLogic::analyseTingCardResult(cbCardIndex, WeaveItem, 0, Result), cbExpected > 0);
+        CHECK(memcmp(&Result, &Expected, sizeof(Result)) == 0);
+        if (cbExpected > 0) tingHands++;
+
+        //14 张：打一张后能否听牌
+        uint8_t cbDraw = static_cast<uint8_t>(rng() % MAX_INDEX);
+        if (cbCardIndex[cbDraw] == 4) continue;
+        cbCardIndex[cbDraw]++;
+        bool bTing = false;
+        for (uint8_t i = 0; i < MAX_INDEX && !bTing; i++) {
+            if (cbCardIndex[i] == 0) continue;
+            cbCardIndex[i]--;
+            bTing = GameLogic::analyseHuCardCount(cbCardIndex, WeaveItem, 0) > 0;
+            cbCardIndex[i]++;
+        }
+        CHECK_EQ(GameLogic::analyseTingCard(cbCardIndex, WeaveItem, 0), bTing);
+    }
+    std::printf("[PackedHandTest] 听牌对照 5000 手，其中听牌 %zu 手\n", tingHands);
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(20180705);
+    testBasicOps(rng);
+    testHuAgreement(rng);
+    testLogicAgreement(rng);
+    return TestUtil::finish("PackedHandTest");
+}
@@ -0,0 +1,222 @@
+//
+// PoolAllocationTest.cpp
+// 对象池测试：房间、GameEngine、NetPlayer 复用后，开局/结束/下一局不再分配堆内存
+//
+// 通过替换全局 operator new/delete 统计测量区间内的分配次数；绑定连接的玩家发给桩服务器，
+// 测量区间包含各事件的 JSON 编码。
+//
+
+#include "TestUtil.h"
+#include "RoomDirectory.h"
+#include "NetPlayerPool.h"
+#include "NetPlayer.h"
+#include "Room.h"
+#include "WebSocketServer.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+namespace {
+
+std::atomic<bool> g_counting(false);
+std::atomic<size_t> g_allocations(0);
+
+// 统计区间：构造时清零并开始计数，stop() 返回区间内的分配次数
+class AllocationScope {
+public:
+    AllocationScope() {
+        g_allocations.store(0);
+        g_counting.store(true);
+    }
+    ~AllocationScope() {
+        g_counting.store(false);
+    }
+    size_t stop() {
+        g_counting.store(false);
+        return g_allocations.load();
+    }
+};
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    if (g_counting.load(std::memory_order_relaxed)) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+const char* kPlayerIds[Room::kMaxPlayers] = { "p0", "p1", "p2", "p3" };
+
+// 桩服务器：只统计收到的消息，不写 socket
+class CountingServer : public WebSocketServer {
+public:
+    CountingServer() : messages(0), bytes(0) {}
+
+    bool sendText(int clientFd, const std::string& text) override {
+        messages++;
+        bytes += text.size();
+        return clientFd > 0;
+    }
+
+    size_t messages;
+    size_t bytes;
+};
+
+// 入座 4 个池化玩家；server 为 nullptr 时不绑定连接，事件不编码消息，只测房间和引擎本身
+void seatPlayers(NetPlayerPool& pool, Room& room, WebSocketServer* server = nullptr) {
+    for (int i = 0; i < Room::kMaxPlayers; i++) {
+        room.addPlayer(pool.acquire(kPlayerIds[i], server != nullptr ? 100 + i : -1, server));
+    }
+}
+
+void leaveAll(Room& room) {
+    for (int i = 0; i < Room::kMaxPlayers; i++) {
+        room.removePlayer(kPlayerIds[i]);
+    }
+}
+
+void testGameLifecycle() {
+    NetPlayerPool pool(8);
+    Room room("alloc_room");
+
+    // 预热：第一局可能触发标准库的惰性初始化
+    seatPlayers(pool, room);
+    room.startGame();
+    room.getGameEngine()->onEventGameConclude(INVALID_CHAIR);
+    room.restartGame();
+    leaveAll(room);
+    room.reset("alloc_room");
+
+    for (int round = 0; round < 100; round++) {
+        seatPlayers(pool, room);
+
+        AllocationScope start;
+        room.startGame();
+        CHECK_EQ(start.stop(), 0u);
+        CHECK(room.getState() == RoomState::PLAYING);
+
+        AllocationScope conclude;
+        room.getGameEngine()->onEventGameConclude(INVALID_CHAIR);
+        room.finishGame();
+        CHECK_EQ(conclude.stop(), 0u);
+
+        AllocationScope restart;
+        CHECK(room.restartGame());
+        CHECK_EQ(restart.stop(), 0u);
+
+        leaveAll(room);
+        AllocationScope recycle;
+        room.reset("alloc_room");
+        CHECK_EQ(recycle.stop(), 0u);
+    }
+    CHECK(pool.size() == 8u);
+    CHECK_EQ(pool.inUse(), 0u);
+}
+
+// 绑定连接的玩家：开局、结束、下一局的事件都编码成 JSON 发出，编码缓冲区复用，同样不分配
+void testConnectedGame() {
+    NetPlayerPool pool(8);
+    CountingServer server;
+    Room room("alloc_connected");
+
+    seatPlayers(pool, room, &server);
+    room.startGame();
+    room.getGameEngine()->onEventGameConclude(INVALID_CHAIR);
+    room.restartGame();
+    leaveAll(room);
+    room.reset("alloc_connected");
+
+    size_t allocations = 0;
+    size_t messagesBefore = server.messages;
+    for (int round = 0; round < 100; round++) {
+        seatPlayers(pool, room, &server);
+
+        AllocationScope scope;
+        room.startGame();
+        room.getGameEngine()->onEventGameConclude(INVALID_CHAIR);
+        room.finishGame();
+        CHECK(room.restartGame());
+        allocations += scope.stop();
+
+        leaveAll(room);
+        room.reset("alloc_connected");
+    }
+    std::printf("[PoolAllocationTest] 绑定连接打 100 局：发出 %zu 条消息，分配 %zu 次\n",
+                server.messages - messagesBefore, allocations);
+    CHECK_EQ(allocations, 0u);
+    // 每局至少每人一条开局、一条结算
+    CHECK(server.messages - messagesBefore >= 100u * 2 * Room::kMaxPlayers);
+}
+
+void testPlayerPoolReuse() {
+    NetPlayerPool pool(4);
+    std::string id = "player";
+
+    AllocationScope scope;
+    for (int i = 0; i < 1000; i++) {
+        std::shared_ptr<NetPlayer> player = pool.acquire(id, -1, nullptr);
+        CHECK_EQ(player->getSeat(), -1);
+    }
+    CHECK_EQ(scope.stop(), 0u);
+    CHECK_EQ(pool.size(), 4u);
+
+    // 池耗尽时扩容
+    std::shared_ptr<NetPlayer> held[5];
+    for (int i = 0; i < 5; i++) {
+        held[i] = pool.acquire(id, -1, nullptr);
+    }
+    CHECK_EQ(pool.size(), 5u);
+    CHECK_EQ(pool.inUse(), 5u);
+}
+
+void testDirectoryReuse() {
+    RoomDirectory::Config config;
+    config.slotsPerShard = 4;
+    config.idleTtl = std::chrono::milliseconds(0);
+    RoomDirectory directory(config);
+
+    // 别名字符串在测量区间外构造，只测目录和房间对象的复用
+    std::string alias = "reuse_room";
+    directory.getOrCreate(alias);
+    directory.reapIdle();
+
+    AllocationScope scope;
+    for (int i = 0; i < 100; i++) {
+        directory.getOrCreate(alias);
+        directory.reapIdle();
+    }
+    size_t allocations = scope.stop();
+    std::printf("[PoolAllocationTest] 目录创建/回收 100 次，分配 %zu 次\n", allocations);
+    // 仅别名表节点会分配（每次 1 个），房间对象、GameEngine 和回收扫描都不再分配
+    CHECK(allocations <= 100u);
+    CHECK_EQ(directory.getStats().reapedTotal, 101u);
+}
+
+} // namespace
+
+int main() {
+    TestUtil::muteStdout();
+    testGameLifecycle();
+    testConnectedGame();
+    testPlayerPoolReuse();
+    testDirectoryReuse();
+    return TestUtil::finish("PoolAllocationTest");
+}
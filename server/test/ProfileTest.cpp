@@ -0,0 +1,288 @@
+//
+// ProfileTest.cpp
+// 玩家档案缓存测试
+//
+// - 1000 位玩家、缓存只放 64 份时的 20000 次随机修改（昵称、积分、设置），大部分修改落在不在缓存里的
+//   玩家上；每 2000 次后每位玩家的档案都与逐条应用的结果一致，写完后缓存回到容量以内；
+// - 关闭后重新打开：档案不变，最近写入的档案不用等待即可命中；日志末尾写了一半的记录被截掉，
+//   不是档案日志的文件无法打开；
+// - 日志超过有效记录的两倍时重写，重写后和重新打开后档案不变；
+// - 档案超过 ttl 后视为未命中，由后台线程重新读入；
+// - 房间开启档案后，真人加补位机器人打完一局，真人的累计积分等于本局的单局积分，机器人没有档案；
+// - profile 消息里的昵称、设置按 JSON 转义，save_settings 拒绝含反斜杠或控制字符的设置。
+//
+
+#include "TestUtil.h"
+#include "RoomTestUtil.h"
+#include "MessageHandler.h"
+#include "NetPlayer.h"
+#include "ProfileCache.h"
+#include "Room.h"
+#include "game/AlignedAlloc.h"
+
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Random {
+    uint64_t llState;
+
+    explicit Random(uint64_t llSeed) : llState(llSeed) {}
+
+    uint64_t next() {
+        llState ^= llState << 13;
+        llState ^= llState >> 7;
+        llState ^= llState << 17;
+        return llState;
+    }
+};
+
+ProfileCache::Config smallConfig(const std::string &path) {
+    ProfileCache::Config config;
+    config.path = path;
+    config.shards = 4;
+    config.capacity = 64;
+    config.flushInterval = std::chrono::milliseconds(5);
+    return config;
+}
+
+bool sameProfile(const PlayerProfile &a, const PlayerProfile &b) {
+    return a.playerId == b.playerId && a.nickname == b.nickname && a.score == b.score && a.settings == b.settings;
+}
+
+void checkAll(ProfileCache &cache, const std::map<std::string, PlayerProfile> &Ref) {
+    bool bSame = true;
+    for (std::map<std::string, PlayerProfile>::const_iterator it = Ref.begin(); bSame && it != Ref.end(); ++it) {
+        PlayerProfile Profile;
+        bSame = cache.load(it->first, Profile) && sameProfile(Profile, it->second);
+    }
+    CHECK(bSame);
+}
+
+// 随机修改 n 次，同时记在 Ref 里
+void mutateRandomly(ProfileCache &cache, std::map<std::string, PlayerProfile> &Ref, Random &random, int n) {
+    for (int i = 0; i < n; i++) {
+        uint64_t llValue = random.next();
+        std::string playerId = "player_" + std::to_string(llValue % 1000);
+        PlayerProfile &Profile = Ref[playerId];
+        Profile.playerId = playerId;
+        switch ((llValue >> 20) % 4) {
+            case 0:
+                Profile.nickname = "nick_" + std::to_string(llValue >> 40);
+                cache.setNickname(playerId, Profile.nickname);
+                break;
+            case 1:
+                Profile.settings = std::string((llValue >> 24) % 40, static_cast<char>('a' + (llValue >> 32) % 26));
+                cache.setSettings(playerId, Profile.settings);
+                break;
+            default: {
+                int64_t lDelta = static_cast<int64_t>((llValue >> 32) % 201) - 100;
+                Profile.score += lDelta;
+                cache.addScore(playerId, lDelta);
+                break;
+            }
+        }
+        if (i % 97 == 0) {
+            PlayerProfile Cached;
+            if (cache.get(playerId, Cached)) {
+                CHECK(sameProfile(Cached, Profile));
+            }
+        }
+    }
+}
+
+void testProfiles() {
+    const std::string path = "ProfileTest.log";
+    std::remove(path.c_str());
+    std::map<std::string, PlayerProfile> Ref;
+    Random random(0x9E3779B97F4A7C15ULL);
+    {
+        ProfileCache cache(smallConfig(path));
+        CHECK(cache.open());
+        PlayerProfile Profile;
+        CHECK(!cache.get("player_0", Profile));
+        for (int round = 0; round < 10; round++) {
+            mutateRandomly(cache, Ref, random, 2000);
+            cache.flush();
+            cache.flush();                  // 写完后第二轮扫描时回到容量以内（第一轮只清掉用过的标志）
+            CHECK(cache.getStats().cached <= 64);
+            checkAll(cache, Ref);
+        }
+        ProfileCache::Stats stats = cache.getStats();
+        CHECK_EQ(stats.players, Ref.size());
+        CHECK(stats.loads > 1000);          // 不在缓存里的玩家由后台线程读入
+        CHECK(stats.hits > 0 && stats.evictions > 0);
+        CHECK(stats.written >= Ref.size() && stats.batches > 0);
+
+        //最后一次修改只在缓存里，关闭时写盘
+        Ref["player_last"].playerId = "player_last";
+        Ref["player_last"].nickname = "last";
+        cache.setNickname("player_last", "last");
+    }
+
+    //重新打开：档案不变，最近写入的档案已预热
+    {
+        ProfileCache cache(smallConfig(path));
+        CHECK(cache.open());
+        PlayerProfile Profile;
+        CHECK(cache.get("player_last", Profile) && Profile.nickname == "last");
+        CHECK_EQ(cache.getStats().players, Ref.size());
+        checkAll(cache, Ref);
+    }
+
+    //末尾写了一半的记录被截掉，之前的档案不变
+    FILE *pFile = std::fopen(path.c_str(), "ab");
+    CHECK(pFile != nullptr);
+    if (pFile != nullptr) {
+        const char szPartial[] = "\x12\x34\x56\x78\x40\x00\x00\x00\x05";
+        std::fwrite(szPartial, 1, sizeof(szPartial) - 1, pFile);
+        std::fclose(pFile);
+        ProfileCache cache(smallConfig(path));
+        CHECK(cache.open());
+        checkAll(cache, Ref);
+        cache.addScore("player_1", 7);
+        Ref["player_1"].score += 7;
+    }
+    {
+        ProfileCache cache(smallConfig(path));
+        CHECK(cache.open());
+        checkAll(cache, Ref);
+    }
+
+    //不是档案日志
+    const std::string other = "ProfileTest.other";
+    pFile = std::fopen(other.c_str(), "wb");
+    if (pFile != nullptr) {
+        std::fputs("not a profile log", pFile);
+        std::fclose(pFile);
+    }
+    {
+        ProfileCache::Config config = smallConfig(other);
+        ProfileCache cache(config);
+        CHECK(!cache.open());
+    }
+    std::remove(other.c_str());
+    std::remove(path.c_str());
+}
+
+void testCompaction() {
+    const std::string path = "ProfileTest.compact.log";
+    std::remove(path.c_str());
+    std::map<std::string, PlayerProfile> Ref;
+    Random random(42);
+    ProfileCache::Config config = smallConfig(path);
+    config.compactMinBytes = 16 * 1024;
+    {
+        ProfileCache cache(config);
+        CHECK(cache.open());
+        for (int round = 0; round < 20; round++) {
+            mutateRandomly(cache, Ref, random, 1000);
+            cache.flush();
+        }
+        ProfileCache::Stats stats = cache.getStats();
+        CHECK(stats.compactions > 0);
+        CHECK(stats.logBytes <= 3 * stats.liveBytes);
+        checkAll(cache, Ref);
+    }
+    {
+        ProfileCache cache(config);
+        CHECK(cache.open());
+        CHECK_EQ(cache.getStats().players, Ref.size());
+        checkAll(cache, Ref);
+    }
+    std::remove(path.c_str());
+    std::remove((path + ".compact").c_str());
+}
+
+void testTtl() {
+    const std::string path = "ProfileTest.ttl.log";
+    std::remove(path.c_str());
+    ProfileCache::Config config = smallConfig(path);
+    config.ttl = std::chrono::seconds(1);
+    ProfileCache cache(config);
+    CHECK(cache.open());
+    cache.setNickname("alice", "Alice");
+    cache.addScore("alice", 30);
+    cache.flush();
+    PlayerProfile Profile;
+    CHECK(cache.get("alice", Profile) && Profile.score == 30);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    CHECK(!cache.get("alice", Profile));
+    cache.flush();
+    CHECK(cache.get("alice", Profile) && Profile.nickname == "Alice" && Profile.score == 30);
+    cache.close();
+    std::remove(path.c_str());
+}
+
+void testRoomProfiles() {
+    ProfileCache::Config config;
+    ProfileCache cache(config);
+    CHECK(cache.open());
+    cache.setNickname("human", "Human");
+    std::shared_ptr<TestPlayer> human = std::make_shared<TestPlayer>("human");
+    {
+        Room room("profile_room");
+        room.setProfileCache(&cache);
+        room.setBotPolicy(std::chrono::milliseconds(10), BotLevel_Normal);
+        CHECK(room.addPlayer(human));
+        CHECK(room.tick(std::chrono::steady_clock::now() + std::chrono::milliseconds(100)));
+        for (int n = 0; n < 300 && !human->isGameEnd() && stepHuman(room, 0); n++) {}
+        CHECK(human->isGameEnd());
+    }
+    PlayerProfile Profile;
+    CHECK(cache.get("human", Profile));
+    CHECK(Profile.nickname == "Human");
+    CHECK_EQ(Profile.score, human->getScore());
+    CHECK_EQ(cache.getStats().players, 1u);
+}
+
+void testProfileMessage() {
+    ProfileCache::Config config;
+    ProfileCache cache(config);
+    CHECK(cache.open());
+    cache.setNickname("quoted", "a\"b\\c\n\x01");
+    cache.setSettings("quoted", "x\"}");
+
+    CaptureServer server;
+    std::shared_ptr<Room> room = std::allocate_shared<Room>(AlignedAllocator<Room>(), "json_room");
+    MessageHandler handler(&server);
+    handler.setProfileCache(&cache);
+    handler.setRoomManager([room](const std::string &) { return room; });
+
+    //昵称沿用档案；引号、反斜杠和控制字符都转义，消息仍是一个完整的对象
+    handler.handleMessage(7, R"({"type":"join_room","roomId":"json_room","playerId":"quoted"})");
+    CHECK(server.find("profile") == R"({"type":"profile","playerId":"quoted","nickname":"a\"b\\c\n\u0001","score":0,"settings":"x\"}"})");
+
+    //getString 不解码转义，含反斜杠的设置拒绝保存，档案不变
+    server.m_Sent.clear();
+    handler.handleMessage(7, R"({"type":"save_settings","settings":"v\\u0022"})");
+    CHECK(server.find("error").find("INVALID_PARAMS") != std::string::npos);
+    PlayerProfile Profile;
+    CHECK(cache.get("quoted", Profile));
+    CHECK(Profile.settings == "x\"}");
+
+    server.m_Sent.clear();
+    handler.handleMessage(7, R"({"type":"save_settings","settings":"sound=off"})");
+    CHECK(server.find("error").empty());
+    CHECK(cache.get("quoted", Profile));
+    CHECK(Profile.settings == "sound=off");
+    handler.cleanupClient(7);
+}
+
+} // namespace
+
+int main() {
+    TestUtil::muteStdout();
+    testProfiles();
+    testCompaction();
+    testTtl();
+    testRoomProfiles();
+    testProfileMessage();
+    return TestUtil::finish("ProfileTest");
+}
@@ -0,0 +1,185 @@
+//
+// RecordTest.cpp
+// 牌局记录与回放测试
+//
+// - 四个机器人连续打 60 局，记录经 RecordWriter 写进文件，读回后每局回放的事件与记录逐条一致，
+//   庄家在各局之间的传递、机器人座位都按段头复现；
+// - 改动一条命令的牌或本局种子，回放在这条命令（种子为开始命令）处报告不一致；
+// - 房间开启记录后，真人加补位机器人打完一局、再开一局后最后一位真人离开，两局都写进文件，第二局标记为未结束；
+// - 文件末尾不完整的段被忽略，前面的段照常读取。
+//
+
+#include "TestUtil.h"
+#include "RoomTestUtil.h"
+#include "BotPlayer.h"
+#include "GameRecord.h"
+#include "RecordWriter.h"
+#include "Room.h"
+#include "NetPlayer.h"
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<uint8_t> readFile(const std::string &path) {
+    std::vector<uint8_t> Data;
+    FILE *pFile = std::fopen(path.c_str(), "rb");
+    if (pFile == NULL) return Data;
+    uint8_t cbBuffer[4096];
+    size_t cbRead;
+    while ((cbRead = std::fread(cbBuffer, 1, sizeof(cbBuffer), pFile)) > 0) Data.insert(Data.end(), cbBuffer, cbBuffer + cbRead);
+    std::fclose(pFile);
+    return Data;
+}
+
+//回放文件中的全部段，返回段数
+size_t replayAll(const std::vector<uint8_t> &Data, size_t &mismatches, size_t &ended) {
+    GameEngine engine;
+    engine.setQuiet(true);
+    size_t Offset = 0, segments = 0;
+    const tagRecordHeader *pHeader = NULL;
+    const tagRecordEntry *pEntries = NULL;
+    mismatches = 0;
+    ended = 0;
+    while (GameRecord::nextSegment(Data.data(), Data.size(), Offset, pHeader, pEntries)) {
+        tagReplayResult Result;
+        if (!GameRecord::replay(engine, *pHeader, pEntries, Result)) mismatches++;
+        if ((pHeader->cbFlags & RecordFlag_Ended) != 0) ended++;
+        segments++;
+    }
+    return segments;
+}
+
+void testRecordReplay() {
+    const std::string path = "RecordTest_bots.rec";
+    std::remove(path.c_str());
+    size_t commands = 0;
+    {
+        RecordWriter writer(path);
+        CHECK(writer.isOpen());
+        GameRecorder recorder;
+        recorder.bind(&writer, "bots");
+        GameEngine engine;
+        engine.setQuiet(true);
+        engine.setCommandListener(&recorder);
+        BotPlayer bots[GAME_PLAYER];
+        bots[1].setLevel(BotLevel_Easy);
+        bots[2].setLevel(BotLevel_Hard);
+        engine.setRoomSeed(46);
+        for (int i = 0; i < GAME_PLAYER; i++) engine.onUserEnter(&bots[i]);
+        for (int g = 0; g < 60; g++) {
+            if (g > 0) engine.onGameRestart();
+            for (int n = 0; n < 1000 && !bots[0].isGameEnd(); n++) {
+                tagGameCommand Command;
+                bool bTaken = false;
+                for (int i = 0; i < GAME_PLAYER && !bTaken; i++) bTaken = bots[i].takeCommand(Command);
+                if (!bTaken) break;
+                GameEventBuffer Events;
+                engine.apply(Command, Events);
+                engine.dispatchEvents(Events);
+                commands++;
+            }
+            CHECK(bots[0].isGameEnd());
+            CHECK(!recorder.isRecording());
+        }
+        CHECK_EQ(recorder.getSegmentCount(), 60u);
+        writer.flush();
+        CHECK_EQ(writer.getWrittenBytes(), 60 * sizeof(tagRecordHeader) + commands * sizeof(tagRecordEntry));
+        CHECK_EQ(writer.getDroppedBytes(), 0u);
+    }
+
+    std::vector<uint8_t> Data = readFile(path);
+    size_t mismatches = 0, ended = 0;
+    CHECK_EQ(replayAll(Data, mismatches, ended), 60u);
+    CHECK_EQ(mismatches, 0u);
+    CHECK_EQ(ended, 60u);
+    std::printf("[RecordTest] 60 局 %zu 条命令，记录 %zu 字节，回放全部一致\n", commands, Data.size());
+
+    //第一局：记录的庄家由骰子决定，之后各局的庄家来自上一局
+    size_t Offset = 0;
+    const tagRecordHeader *pHeader = NULL;
+    const tagRecordEntry *pEntries = NULL;
+    CHECK(GameRecord::nextSegment(Data.data(), Data.size(), Offset, pHeader, pEntries));
+    CHECK_EQ(pHeader->cbBankerUser, INVALID_CHAIR);
+    CHECK_EQ(pHeader->cbAndroidMask, 0x0F);
+    CHECK(std::strcmp(pHeader->szRoomId, "bots") == 0);
+    size_t SecondOffset = Offset;
+    CHECK(GameRecord::nextSegment(Data.data(), Data.size(), Offset, pHeader, pEntries));
+    CHECK(pHeader->cbBankerUser < GAME_PLAYER);
+
+    //改动第二局的一张出牌：回放在这条命令处不一致
+    tagRecordHeader *pSecond = reinterpret_cast<tagRecordHeader *>(&Data[SecondOffset]);
+    tagRecordEntry *pSecondEntries = reinterpret_cast<tagRecordEntry *>(pSecond + 1);
+    uint16_t wTarget = 0;
+    while (wTarget < pSecond->wEntryCount && pSecondEntries[wTarget].cbKind != GameCommand_OutCard) wTarget++;
+    CHECK(wTarget < pSecond->wEntryCount);
+    uint8_t cbCard = pSecondEntries[wTarget].cbCardData;
+    pSecondEntries[wTarget].cbCardData = static_cast<uint8_t>(cbCard == 0x01 ? 0x02 : 0x01);
+    GameEngine engine;
+    engine.setQuiet(true);
+    tagReplayResult Result;
+    CHECK(!GameRecord::replay(engine, *pSecond, pSecondEntries, Result));
+    CHECK_EQ(Result.iMismatch, static_cast<int32_t>(wTarget));
+    pSecondEntries[wTarget].cbCardData = cbCard;
+    CHECK(GameRecord::replay(engine, *pSecond, pSecondEntries, Result));
+
+    //改动种子：开始命令就不一致
+    pSecond->llGameSeed ^= 1;
+    CHECK(!GameRecord::replay(engine, *pSecond, pSecondEntries, Result));
+    CHECK_EQ(Result.iMismatch, -1);
+    pSecond->llGameSeed ^= 1;
+
+    //末尾不完整的段被忽略
+    Data.resize(Data.size() - sizeof(tagRecordEntry));
+    CHECK_EQ(replayAll(Data, mismatches, ended), 59u);
+    CHECK_EQ(mismatches, 0u);
+    std::remove(path.c_str());
+}
+
+void testRoomRecord() {
+    const std::string path = "RecordTest_room.rec";
+    std::remove(path.c_str());
+    {
+        RecordWriter writer(path);
+        Room room("record_room");
+        room.setRecordWriter(&writer);
+        room.setBotPolicy(std::chrono::milliseconds(10), BotLevel_Normal);
+        std::shared_ptr<TestPlayer> human = std::make_shared<TestPlayer>("human");
+        CHECK(room.addPlayer(human));
+        CHECK(room.tick(std::chrono::steady_clock::now() + std::chrono::milliseconds(100)));
+        for (int n = 0; n < 300 && !human->isGameEnd() && stepHuman(room, 0); n++) {}
+        CHECK(human->isGameEnd());
+        CHECK(room.restartGame());
+        stepHuman(room, 0);
+        CHECK(!room.onPlayerDisconnect("human"));     //最后一位真人离开，放弃本局
+        writer.flush();
+    }
+
+    std::vector<uint8_t> Data = readFile(path);
+    size_t mismatches = 0, ended = 0;
+    CHECK_EQ(replayAll(Data, mismatches, ended), 2u);
+    CHECK_EQ(mismatches, 0u);
+    CHECK_EQ(ended, 1u);
+    size_t Offset = 0;
+    const tagRecordHeader *pHeader = NULL;
+    const tagRecordEntry *pEntries = NULL;
+    CHECK(GameRecord::nextSegment(Data.data(), Data.size(), Offset, pHeader, pEntries));
+    CHECK(std::strcmp(pHeader->szRoomId, "record_room") == 0);
+    CHECK_EQ(pHeader->cbAndroidMask, 0x0E);
+    CHECK(GameRecord::nextSegment(Data.data(), Data.size(), Offset, pHeader, pEntries));
+    CHECK((pHeader->cbFlags & RecordFlag_Ended) == 0);
+    std::remove(path.c_str());
+}
+
+} // namespace
+
+int main() {
+    TestUtil::muteStdout();
+    testRecordReplay();
+    testRoomRecord();
+    return TestUtil::finish("RecordTest");
+}
@@ -0,0 +1,101 @@
+//
+// RespondTest.cpp
+// 批量响应判定测试
+//
+// - estimateRespond 一次算出的各座位碰、杠与逐座位调用 estimatePengCard / estimateGangCard 一致
+//   （出牌者、超出座位数的座位、放弃碰、抢杠、没有剩余牌等情况）；
+// - 返回的候选座位与等牌掩码一致，候选座位做完整分析后，动作与逐座位完整调用 analyseHuCard 一致。
+//
+
+#include "TestUtil.h"
+#include "GameLogic.h"
+#include "TingCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+namespace {
+
+void randomHand(std::mt19937 &rng, uint8_t cbRemain[MAX_INDEX], uint8_t cbCardIndex[MAX_INDEX], uint8_t cbSize, int iSuit) {
+    memset(cbCardIndex, 0, MAX_INDEX);
+    for (uint8_t k = 0; k < cbSize;) {
+        uint8_t i = static_cast<uint8_t>(iSuit >= 0 && rng() % 2 == 0 ? iSuit * 9 + rng() % 9 : rng() % MAX_INDEX);
+        if (cbRemain[i] == 0) continue;
+        cbRemain[i]--;
+        cbCardIndex[i]++;
+        k++;
+    }
+}
+
+uint8_t analyse(const uint8_t cbCardIndex[MAX_INDEX], uint8_t cbCard) {
+    uint8_t huKind = 0, huSpecial = 0, cbFanShu = 0;
+    uint64_t huRight = 0;
+    tagWeaveItem WeaveItem[MAX_WEAVE];
+    return GameLogic::analyseHuCard(cbCardIndex, WeaveItem, 0, cbCard, huKind, huRight, huSpecial, 10, 10, false, false, false, cbFanShu, false);
+}
+
+void testRespond(std::mt19937 &rng) {
+    TingCache cache;
+    size_t pengCount = 0, gangCount = 0, huCount = 0;
+    for (int n = 0; n < 20000; n++) {
+        //四家从同一副牌里取，偏向同一门，出的牌也从剩下的牌里取
+        uint8_t cbRemain[MAX_INDEX];
+        memset(cbRemain, 4, sizeof(cbRemain));
+        uint8_t cbCardIndex[GAME_PLAYER][MAX_INDEX];
+        int iSuit = static_cast<int>(rng() % 3);
+        for (uint8_t s = 0; s < GAME_PLAYER; s++) {
+            randomHand(rng, cbRemain, cbCardIndex[s], MAX_COUNT - 1, iSuit);
+        }
+        uint8_t cbIndex;
+        do {
+            cbIndex = static_cast<uint8_t>(rng() % 2 == 0 ? iSuit * 9 + rng() % 9 : rng() % MAX_INDEX);
+        } while (cbRemain[cbIndex] == 0);
+        uint8_t cbCard = GameLogic::switchToCardData(cbIndex);
+        bool bPassPeng[GAME_PLAYER][MAX_INDEX];
+        for (uint8_t s = 0; s < GAME_PLAYER; s++) {
+            for (uint8_t i = 0; i < MAX_INDEX; i++) bPassPeng[s][i] = rng() % 4 == 0;
+        }
+        uint8_t cbPlayerCount = static_cast<uint8_t>(n % 10 == 0 ? 2 + rng() % 3 : GAME_PLAYER);
+        uint8_t cbProvideUser = static_cast<uint8_t>(rng() % cbPlayerCount);
+        bool bOutCard = n % 8 != 0;
+        bool bGang = n % 16 != 1;
+
+        uint64_t llHuMask[GAME_PLAYER];
+        for (uint8_t s = 0; s < GAME_PLAYER; s++) llHuMask[s] = cache.update(s, cbCardIndex[s], nullptr, 0);
+        uint8_t cbUserAction[GAME_PLAYER];
+        memset(cbUserAction, 0xFF, sizeof(cbUserAction));
+        uint8_t cbHuUser = GameLogic::estimateRespond(cbCardIndex, bPassPeng, llHuMask, cbPlayerCount, cbProvideUser, cbCard, bOutCard, bGang, cbUserAction);
+
+        for (uint8_t s = 0; s < GAME_PLAYER; s++) {
+            //逐座位判定（批量判定之前 estimateUserRespond 的做法）
+            uint8_t cbExpected = WIK_NULL;
+            bool bRespond = s < cbPlayerCount && s != cbProvideUser;
+            if (bRespond && bOutCard) {
+                if (!bPassPeng[s][cbIndex]) cbExpected |= GameLogic::estimatePengCard(cbCardIndex[s], cbCard);
+                if (bGang) cbExpected |= GameLogic::estimateGangCard(cbCardIndex[s], cbCard);
+            }
+            CHECK_EQ(cbUserAction[s], cbExpected);
+            CHECK_EQ(((cbHuUser >> s) & 1) != 0, bRespond && ((llHuMask[s] >> cbIndex) & 1) != 0);
+            if (bRespond) {
+                uint8_t cbHu = analyse(cbCardIndex[s], cbCard);
+                if ((cbHuUser >> s) & 1) cbUserAction[s] |= cbHu;
+                CHECK_EQ(cbUserAction[s], static_cast<uint8_t>(cbExpected | cbHu));
+                huCount += cbHu == WIK_H;
+            }
+            pengCount += (cbExpected & WIK_P) != 0;
+            gangCount += (cbExpected & WIK_G) != 0;
+        }
+        CHECK_EQ(cbHuUser >> cbPlayerCount, 0);
+    }
+    CHECK(pengCount > 0 && gangCount > 0 && huCount > 0);
+    std::printf("[RespondTest] 20000 次出牌，可碰 %zu 次，可杠 %zu 次，可胡 %zu 次\n", pengCount, gangCount, huCount);
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(20180705);
+    testRespond(rng);
+    return TestUtil::finish("RespondTest");
+}
@@ -0,0 +1,158 @@
+//
+// RoomBotTest.cpp
+// 房间机器人测试
+//
+// - 只有一位真人时，等待未超时不开局，超时后 tick 用机器人补齐空座位开局，真人每次行动后
+//   机器人座位立即行动，整局打完；不是自己回合出牌、替机器人座位出牌都被拒绝；
+// - 四位真人开局，中途一人掉线由机器人接管（按引擎状态同步手牌），重连后收回座位继续打完；
+//   重连时的 game_resume 带各家手牌张数、出牌记录和当前供应的牌，与引擎状态一致；
+// - 等待中掉线不接管；游戏中最后一位真人掉线时不再代打，放弃本局，房间清空后空闲。
+//
+
+#include "TestUtil.h"
+#include "RoomTestUtil.h"
+#include "Room.h"
+#include "NetPlayer.h"
+#include "JsonHelper.h"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+//game_resume 中各家出牌记录的总张数（嵌套数组，JsonHelper 不支持，按逗号分隔的数字计数）
+size_t countResumeDiscards(const std::string &message) {
+    const std::string key = R"("discards":[)";
+    size_t begin = message.find(key);
+    size_t end = message.find(R"(],"provideUser")", begin);
+    if (begin == std::string::npos || end == std::string::npos) return 0;
+    size_t count = 0;
+    bool digit = false;
+    for (size_t i = begin + key.size(); i < end; i++) {
+        bool isDigit = message[i] >= '0' && message[i] <= '9';
+        if (isDigit && !digit) count++;
+        digit = isDigit;
+    }
+    return count;
+}
+
+//重连消息与引擎状态一致：手牌张数、出牌记录（含桌面上等待响应的那张）、供应的牌
+void checkResume(const std::string &message, const tagGameState &State) {
+    CHECK(!message.empty());
+    std::vector<int> handCount = JsonHelper::getIntArray(message, "handCount");
+    CHECK_EQ(handCount.size(), static_cast<size_t>(GAME_PLAYER));
+    for (size_t i = 0; i < handCount.size() && i < GAME_PLAYER; i++) {
+        int count = 0;
+        for (uint8_t j = 0; j < MAX_INDEX; j++) count += State.cbCardIndex[i][j];
+        CHECK_EQ(handCount[i], count);
+    }
+    size_t discards = State.cbOutCardData != 0 ? 1 : 0;
+    for (int i = 0; i < GAME_PLAYER; i++) discards += State.cbDiscardCount[i];
+    CHECK_EQ(countResumeDiscards(message), discards);
+    CHECK_EQ(JsonHelper::getInt(message, "provideCard"), static_cast<int>(State.cbProvideCard));
+}
+
+void testBotFill() {
+    Room room("bot_fill");
+    room.setBotPolicy(std::chrono::milliseconds(50), BotLevel_Easy);
+    Clock::time_point joined = Clock::now();
+    std::shared_ptr<TestPlayer> human = std::make_shared<TestPlayer>("human");
+    CHECK(room.addPlayer(human));
+    CHECK(!room.tick(joined));
+    CHECK(room.getState() == RoomState::WAITING);
+    CHECK(room.tick(joined + std::chrono::milliseconds(100)));
+    CHECK(room.getState() == RoomState::PLAYING);
+    CHECK(!room.isBotSeat(0));
+    for (int i = 1; i < GAME_PLAYER; i++) CHECK(room.isBotSeat(i));
+    CHECK(!room.tick(joined + std::chrono::milliseconds(200)));       //已开局，不再补位
+
+    //替机器人座位出牌、不是自己的回合出牌都被拒绝
+    const tagGameState &State = room.getGameEngine()->getGameState();
+    CHECK(!room.onUserOutCard(1, 0x01));
+    if (State.cbCurrentUser != 0) CHECK(!room.onUserOutCard(0, 0x01));
+
+    int iSteps = 0;
+    while (!human->isGameEnd() && iSteps < 200 && stepHumans(room, true)) iSteps++;
+    CHECK(human->isGameEnd());
+    std::printf("[RoomBotTest] 1 位真人 + 3 个机器人，真人行动 %d 次后终局\n", iSteps);
+}
+
+void testTakeover() {
+    size_t takeovers = 0;
+    for (int g = 0; g < 20; g++) {
+        CaptureServer server;    //重连的玩家之后发给它，须比房间活得久
+        Room room("takeover");
+        room.setBotPolicy(std::chrono::milliseconds(0), BotLevel_Normal);
+        std::shared_ptr<TestPlayer> players[GAME_PLAYER];
+        for (int i = 0; i < GAME_PLAYER; i++) {
+            players[i] = std::make_shared<TestPlayer>("p" + std::to_string(i));
+            CHECK(room.addPlayer(players[i]));
+        }
+        CHECK(!room.onPlayerDisconnect("p0"));            //等待中不接管
+        room.startGame();
+        CHECK(room.getState() == RoomState::PLAYING);
+
+        int seat = g % GAME_PLAYER;
+        std::string playerId = "p" + std::to_string(seat);
+        TestPlayer &watcher = *players[(seat + 1) % GAME_PLAYER];     //始终在线，用来判断终局
+        int iSteps = 0;
+        while (!watcher.isGameEnd() && iSteps < 5 + g && stepHumans(room, true)) iSteps++;
+        if (watcher.isGameEnd()) continue;
+
+        CHECK(room.onPlayerDisconnect(playerId));
+        CHECK(room.isBotSeat(seat));
+        CHECK(!room.isIdle());
+        takeovers++;
+        //其余三人继续，机器人代打
+        for (int n = 0; n < 10 && !watcher.isGameEnd() && stepHumans(room, true); n++) {}
+        if (!watcher.isGameEnd()) {
+            std::shared_ptr<NetPlayer> back = room.reconnectPlayer(playerId, 100 + seat, &server);
+            CHECK(back == players[seat]);
+            checkResume(server.find("game_resume"), room.getGameEngine()->getGameState());
+            CHECK(!room.isBotSeat(seat));
+            CHECK_EQ(back->getSeat(), seat);
+            CHECK(room.reconnectPlayer(playerId, -1, nullptr) == nullptr);   //已收回
+        }
+        iSteps = 0;
+        while (!watcher.isGameEnd() && iSteps < 300 && stepHumans(room, true)) iSteps++;
+        CHECK(watcher.isGameEnd());
+    }
+    CHECK(takeovers > 10);
+    std::printf("[RoomBotTest] %zu 局中途掉线代打，全部打完\n", takeovers);
+}
+
+void testAllDisconnected() {
+    Room room("all_gone");
+    std::shared_ptr<TestPlayer> players[GAME_PLAYER];
+    for (int i = 0; i < GAME_PLAYER; i++) {
+        players[i] = std::make_shared<TestPlayer>("q" + std::to_string(i));
+        CHECK(room.addPlayer(players[i]));
+    }
+    room.startGame();
+    CHECK(!room.isIdle());
+    for (int i = 0; i < GAME_PLAYER - 1; i++) {
+        CHECK(room.onPlayerDisconnect("q" + std::to_string(i)));
+        CHECK(!room.isIdle());
+    }
+    //最后一人掉线：代打的玩家被清掉，剩下这位和 MessageHandler 一样由调用方移除
+    CHECK(!room.onPlayerDisconnect("q3"));
+    CHECK_EQ(room.getPlayerCount(), 1u);
+    CHECK(room.removePlayer("q3"));
+    CHECK(room.isIdle());
+    CHECK(room.reconnectPlayer("q0", -1, nullptr) == nullptr);
+}
+
+} // namespace
+
+int main() {
+    TestUtil::muteStdout();
+    testBotFill();
+    testTakeover();
+    testAllDisconnected();
+    return TestUtil::finish("RoomBotTest");
+}
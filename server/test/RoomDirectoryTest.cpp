@@ -0,0 +1,219 @@
+//
+// RoomDirectoryTest.cpp
+// RoomDirectory 测试：别名/ID 查找、回收后 ID 失效、并发创建，以及压缩时间的 24 小时浸泡模拟
+//
+
+#include "TestUtil.h"
+#include "RoomDirectory.h"
+#include "Room.h"
+#include "NetPlayer.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+RoomDirectory::Config fastConfig(size_t slotsPerShard) {
+    RoomDirectory::Config config;
+    config.slotsPerShard = slotsPerShard;
+    config.idleTtl = std::chrono::milliseconds(0);
+    return config;
+}
+
+void testLookup() {
+    RoomDirectory directory(fastConfig(4));
+    std::shared_ptr<Room> room = directory.getOrCreate("room_a");
+    CHECK(room != nullptr);
+    // 房间内嵌 GameEngine（tagGameState 按缓存行对齐），目录按房间的对齐分配
+    CHECK_EQ(reinterpret_cast<uintptr_t>(room.get()) % alignof(Room), 0u);
+    CHECK_EQ(alignof(Room), 64u);
+    CHECK(directory.getOrCreate("room_a") == room);
+    CHECK(directory.getOrCreate("") == nullptr);
+
+    RoomId id = directory.lookupId("room_a");
+    CHECK(id != kInvalidRoomId);
+    CHECK(directory.find(id) == room);
+    CHECK(directory.findByAlias("room_a") == room);
+    CHECK(directory.find(kInvalidRoomId) == nullptr);
+    CHECK(directory.find(0xFFFF) == nullptr);
+
+    // 有玩家的房间不会被回收
+    std::shared_ptr<NetPlayer> player = std::make_shared<NetPlayer>("p1", 1, nullptr);
+    CHECK(room->addPlayer(player));
+    CHECK_EQ(directory.reapIdle(), 0u);
+    CHECK(directory.find(id) == room);
+
+    // 玩家离开后房间空闲，被回收；旧 ID 失效，同名别名得到新房间
+    CHECK(room->removePlayer("p1"));
+    CHECK_EQ(directory.reapIdle(), 1u);
+    CHECK(directory.find(id) == nullptr);
+    CHECK_EQ(directory.lookupId("room_a"), kInvalidRoomId);
+    std::shared_ptr<Room> again = directory.getOrCreate("room_a");
+    CHECK(again != nullptr && again != room);
+    CHECK(directory.lookupId("room_a") != id);
+
+    CHECK(directory.remove(directory.lookupId("room_a")));
+    CHECK(directory.findByAlias("room_a") == nullptr);
+
+    // 没有外部引用的房间回收后留在槽位上，下次分配直接复用同一个对象
+    std::shared_ptr<Room> pooled = directory.getOrCreate("room_b");
+    Room* raw = pooled.get();
+    pooled.reset();
+    CHECK(directory.remove(directory.lookupId("room_b")));
+    pooled = directory.getOrCreate("room_b");
+    CHECK(pooled.get() == raw);
+    CHECK(pooled->getId() == "room_b");
+    CHECK_EQ(pooled->getPlayerCount(), 0u);
+}
+
+void testCapacity() {
+    RoomDirectory directory(fastConfig(1));
+    std::vector<std::shared_ptr<Room>> rooms;
+    for (size_t i = 0; i < directory.capacity(); i++) {
+        rooms.push_back(directory.getOrCreate("cap_" + std::to_string(i)));
+        CHECK(rooms.back() != nullptr);
+    }
+    CHECK(directory.getOrCreate("cap_overflow") == nullptr);
+    CHECK_EQ(directory.getStats().liveRooms, directory.capacity());
+}
+
+void testConcurrentCreate() {
+    RoomDirectory directory(fastConfig(64));
+    const int kThreads = 8;
+    const int kAliases = 200;
+    std::vector<std::vector<RoomId>> seen(kThreads, std::vector<RoomId>(kAliases));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; t++) {
+        threads.push_back(std::thread([&directory, &seen, t]() {
+            for (int i = 0; i < kAliases; i++) {
+                std::string alias = "shared_" + std::to_string(i);
+                std::shared_ptr<Room> room = directory.getOrCreate(alias);
+                seen[t][i] = room ? directory.lookupId(alias) : kInvalidRoomId;
+                directory.find(seen[t][i]);
+            }
+        }));
+    }
+    for (size_t i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+    // 所有线程对同一别名看到同一个 ID
+    for (int i = 0; i < kAliases; i++) {
+        for (int t = 1; t < kThreads; t++) {
+            CHECK_EQ(seen[t][i], seen[0][i]);
+        }
+    }
+    CHECK_EQ(directory.getStats().liveRooms, static_cast<size_t>(kAliases));
+}
+
+// 查找与回收并发：回收线程反复移除、重建同一批房间，查找线程拿到的房间始终可用（ASan/TSan 下检查释放时机）
+void testFindWhileReaping() {
+    RoomDirectory directory(fastConfig(4));
+    const int kAliases = 16;
+    std::atomic<RoomId> ids[kAliases];
+    for (int i = 0; i < kAliases; i++) {
+        directory.getOrCreate("race_" + std::to_string(i));
+        ids[i] = directory.lookupId("race_" + std::to_string(i));
+    }
+    std::atomic<bool> stop(false);
+    std::atomic<size_t> found(0);
+    std::vector<std::thread> finders;
+    for (int t = 0; t < 4; t++) {
+        finders.push_back(std::thread([&directory, &ids, &stop, &found, t, kAliases]() {
+            for (size_t n = t; !stop.load(); n++) {
+                std::shared_ptr<Room> room = directory.find(ids[n % kAliases].load());
+                if (room) {
+                    room->getPlayerCount();
+                    found++;
+                }
+            }
+        }));
+    }
+    for (int round = 0; round < 2000; round++) {
+        int i = round % kAliases;
+        std::string alias = "race_" + std::to_string(i);
+        directory.remove(directory.lookupId(alias));
+        directory.getOrCreate(alias);
+        ids[i] = directory.lookupId(alias);
+    }
+    // 查找线程可能在重建结束后才开始运行，至少等它们拿到一次房间再停止
+    while (found.load() == 0) {
+        std::this_thread::yield();
+    }
+    stop = true;
+    for (size_t i = 0; i < finders.size(); i++) {
+        finders[i].join();
+    }
+    CHECK(found.load() > 0);
+    CHECK_EQ(directory.getStats().liveRooms, static_cast<size_t>(kAliases));
+}
+
+// 24 小时浸泡模拟：按分钟推进，每分钟开 60 桌，每桌 4 人进出，按时回收。
+// 用压缩时间（TTL 为 0，每分钟一次回收扫描）代替真实时钟，检查内存有界。
+void testSoak24h() {
+    RoomDirectory directory(fastConfig(64));
+    const int kMinutes = 24 * 60;
+    const int kTablesPerMinute = 60;
+
+    size_t baseline = 0;
+    size_t peakLive = 0;
+    for (int minute = 0; minute < kMinutes; minute++) {
+        std::vector<std::shared_ptr<Room>> tables;
+        for (int t = 0; t < kTablesPerMinute; t++) {
+            std::shared_ptr<Room> room = directory.getOrCreate("soak_" + std::to_string(minute) + "_" + std::to_string(t));
+            CHECK(room != nullptr);
+            if (!room) {
+                continue;
+            }
+            for (int seat = 0; seat < 4; seat++) {
+                room->addPlayer(std::make_shared<NetPlayer>("p" + std::to_string(seat), seat + 10, nullptr));
+            }
+            tables.push_back(room);
+        }
+        RoomDirectory::Stats stats = directory.getStats();
+        if (stats.liveRooms > peakLive) {
+            peakLive = stats.liveRooms;
+        }
+        for (size_t t = 0; t < tables.size(); t++) {
+            for (int seat = 0; seat < 4; seat++) {
+                tables[t]->removePlayer("p" + std::to_string(seat));
+            }
+        }
+        tables.clear();
+        directory.reapIdle();
+        if (minute == 60) {
+            baseline = TestUtil::residentBytes();    // 第一个小时后作为基线，排除预热分配
+        }
+    }
+
+    RoomDirectory::Stats stats = directory.getStats();
+    size_t finalRss = TestUtil::residentBytes();
+    long growth = static_cast<long>(finalRss) - static_cast<long>(baseline);
+    std::printf("[RoomDirectoryTest] 24h 浸泡: 创建 %llu 间，回收 %llu 间，峰值 %zu 间，剩余 %zu 间，"
+                "房间对象 %zu 个，RSS 基线 %zu KB -> 结束 %zu KB（增长 %ld KB）\n",
+                static_cast<unsigned long long>(stats.createdTotal),
+                static_cast<unsigned long long>(stats.reapedTotal),
+                peakLive, stats.liveRooms, stats.pooledRooms, baseline / 1024, finalRss / 1024, growth / 1024);
+
+    CHECK_EQ(stats.liveRooms, 0u);
+    CHECK_EQ(stats.aliases, 0u);
+    // 房间对象池化复用：对象数只取决于各分片的峰值房间数，不随累计创建数增长
+    CHECK(stats.pooledRooms <= peakLive * 4);
+    CHECK_EQ(stats.createdTotal, static_cast<uint64_t>(kMinutes * kTablesPerMinute));
+    CHECK(growth < 1024 * 1024);
+}
+
+} // namespace
+
+int main() {
+    TestUtil::muteStdout();
+    testLookup();
+    testCapacity();
+    testConcurrentCreate();
+    testFindWhileReaping();
+    testSoak24h();
+    return TestUtil::finish("RoomDirectoryTest");
+}
@@ -0,0 +1,105 @@
+//
+// RoomTestUtil.h
+// 房间测试共用的玩家和出牌驱动（不连接网络，直接调用 Room 的接口）
+//
+
+#ifndef MAHJONG_ROOM_TEST_UTIL_H
+#define MAHJONG_ROOM_TEST_UTIL_H
+
+#include "NetPlayer.h"
+#include "Room.h"
+#include "WebSocketServer.h"
+
+#include <string>
+#include <vector>
+
+//记录终局和本座位单局积分的玩家（未连接，不发送消息）
+class TestPlayer : public NetPlayer {
+public:
+    explicit TestPlayer(const std::string &playerId, const std::string &nickname = "")
+            : NetPlayer(playerId, -1, nullptr), m_bGameEnd(false), m_lScore(0) {
+        if (!nickname.empty()) setNickname(nickname);
+    }
+
+    bool onGameStartEvent(const CMD_S_GameStart &GameStart) override {
+        m_bGameEnd = false;
+        return NetPlayer::onGameStartEvent(GameStart);
+    }
+
+    bool onGameEndEvent(const CMD_S_GameEnd &GameEnd) override {
+        m_bGameEnd = true;
+        int seat = getSeat();
+        m_lScore = seat >= 0 && seat < GAME_PLAYER ? GameEnd.lGameScore[seat] : 0;
+        return NetPlayer::onGameEndEvent(GameEnd);
+    }
+
+    bool isGameEnd() const { return m_bGameEnd; }
+    int64_t getScore() const { return m_lScore; }
+
+private:
+    bool m_bGameEnd;
+    int64_t m_lScore;
+};
+
+//桩服务器：记下发给客户端的消息，不写 socket
+class CaptureServer : public WebSocketServer {
+public:
+    bool sendText(int clientFd, const std::string& text) override {
+        m_Sent.push_back(text);
+        return clientFd > 0;
+    }
+
+    //第一条该类型的消息，没有时返回空串
+    std::string find(const std::string &type) const {
+        std::string key = R"({"type":")" + type + "\"";
+        for (size_t i = 0; i < m_Sent.size(); i++) {
+            if (m_Sent[i].compare(0, key.size(), key) == 0) return m_Sent[i];
+        }
+        return "";
+    }
+
+    std::vector<std::string> m_Sent;
+};
+
+//座位有待响应的动作时的选择：胡 > 碰（bPeng 为 true 时）> 过
+inline uint8_t chooseResponse(uint8_t cbUserAction, bool bPeng) {
+    if ((cbUserAction & WIK_H) != 0) return WIK_H;
+    if (bPeng && (cbUserAction & WIK_P) != 0) return WIK_P;
+    return WIK_NULL;
+}
+
+//打出座位上编号最大的牌
+inline bool outLargestCard(Room &room, const tagGameState &State, int seat) {
+    for (int j = MAX_INDEX - 1; j >= 0; j--) {
+        if (State.cbCardIndex[seat][j] > 0) return room.onUserOutCard(seat, GameLogic::switchToCardData(static_cast<uint8_t>(j)));
+    }
+    return false;
+}
+
+//指定座位走一步：有待响应的动作时 胡 > 过，否则只在轮到自己时出编号最大的牌
+inline bool stepHuman(Room &room, int seat) {
+    GameEngine *pEngine = room.getGameEngine();
+    if (pEngine == nullptr) return false;
+    const tagGameState &State = pEngine->getGameState();
+    if (State.cbUserAction[seat] != WIK_NULL && !State.bResponse[seat]) {
+        return room.onUserOperateCard(seat, chooseResponse(State.cbUserAction[seat], false), State.cbProvideCard);
+    }
+    if (State.cbCurrentUser != seat) return false;
+    return outLargestCard(room, State, seat);
+}
+
+//全部真人座位走一步：有待响应的动作先响应，否则当前座位是真人时出编号最大的牌
+inline bool stepHumans(Room &room, bool bPeng = false) {
+    GameEngine *pEngine = room.getGameEngine();
+    if (pEngine == nullptr) return false;
+    const tagGameState &State = pEngine->getGameState();
+    for (int i = 0; i < GAME_PLAYER; i++) {
+        if (room.isBotSeat(i) || State.cbUserAction[i] == WIK_NULL || State.bResponse[i]) continue;
+        return room.onUserOperateCard(i, chooseResponse(State.cbUserAction[i], bPeng), State.cbProvideCard);
+    }
+    int seat = State.cbCurrentUser;
+    if (seat >= GAME_PLAYER || room.isBotSeat(seat)) return false;
+    return outLargestCard(room, State, seat);
+}
+
+#endif // MAHJONG_ROOM_TEST_UTIL_H
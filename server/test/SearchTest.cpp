@@ -0,0 +1,191 @@
+//
+// SearchTest.cpp
+// 蒙特卡洛搜索测试
+//
+// - 抽样只改动别人的手牌和牌墙：自己的手牌、各家张数、隐藏牌的总体不变，换种子得到不同的抽样；
+// - 出牌的候选是打出后向听数最小的几张，有动作时候选是 过 加上可选的动作；
+// - 只限推演次数时，1 个线程和 3 个线程选出相同的命令；能胡的时候不推演，直接胡；
+// - 专家机器人和三个普通机器人打完整局，手牌与引擎状态保持一致。
+//
+
+#include "TestUtil.h"
+#include "BotPlayer.h"
+#include "MonteCarloSearch.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+//四个机器人打到 bStop 返回 true 或终局，返回是否停在了 bStop
+template <typename Stop>
+bool playUntil(GameEngine &engine, BotPlayer bots[GAME_PLAYER], Stop bStop) {
+    for (int n = 0; n < 1000 && !bots[0].isGameEnd(); n++) {
+        if (bStop(engine.getGameState())) return true;
+        tagGameCommand Command;
+        bool bTaken = false;
+        for (int i = 0; i < GAME_PLAYER && !bTaken; i++) bTaken = bots[i].takeCommand(Command);
+        if (!bTaken) return false;
+        GameEventBuffer Events;
+        engine.apply(Command, Events);
+        engine.dispatchEvents(Events);
+    }
+    return false;
+}
+
+void countTiles(const uint8_t cbCardIndex[MAX_INDEX], uint8_t cbTotal[MAX_INDEX]) {
+    for (uint8_t j = 0; j < MAX_INDEX; j++) cbTotal[j] = static_cast<uint8_t>(cbTotal[j] + cbCardIndex[j]);
+}
+
+//别人的手牌加上牌墙
+void hiddenTiles(const tagGameState &State, uint8_t cbChairID, uint8_t cbTotal[MAX_INDEX]) {
+    memset(cbTotal, 0, MAX_INDEX);
+    for (uint8_t i = 0; i < GAME_PLAYER; i++) {
+        if (i != cbChairID) countTiles(State.cbCardIndex[i], cbTotal);
+    }
+    for (uint8_t n = 0; n < State.cbLeftCardCount; n++) cbTotal[GameLogic::switchToCardIndex(State.cbRepertoryCard[n])]++;
+}
+
+uint8_t handCount(const tagGameState &State, uint8_t cbChairID) {
+    uint8_t cbCount = 0;
+    for (uint8_t j = 0; j < MAX_INDEX; j++) cbCount = static_cast<uint8_t>(cbCount + State.cbCardIndex[cbChairID][j]);
+    return cbCount;
+}
+
+void testDeterminize() {
+    GameEngine engine;
+    engine.setQuiet(true);
+    BotPlayer bots[GAME_PLAYER];
+    engine.setRoomSeed(11);
+    for (int i = 0; i < GAME_PLAYER; i++) engine.onUserEnter(&bots[i]);
+    CHECK(playUntil(engine, bots, [](const tagGameState &State) { return State.cbOutCardCount >= 20 && State.cbCurrentUser < GAME_PLAYER; }));
+    const tagGameState &State = engine.getGameState();
+    uint8_t cbChairID = State.cbCurrentUser;
+
+    uint8_t cbBefore[MAX_INDEX], cbAfter[MAX_INDEX];
+    hiddenTiles(State, cbChairID, cbBefore);
+    GameRandom Random(3);
+    tagGameState Sample, Other;
+    MonteCarloSearch::determinize(State, cbChairID, Random, Sample);
+    MonteCarloSearch::determinize(State, cbChairID, Random, Other);
+    CHECK(memcmp(Sample.cbCardIndex[cbChairID], State.cbCardIndex[cbChairID], MAX_INDEX) == 0);
+    for (uint8_t i = 0; i < GAME_PLAYER; i++) CHECK_EQ(handCount(Sample, i), handCount(State, i));
+    CHECK_EQ(Sample.cbLeftCardCount, State.cbLeftCardCount);
+    CHECK(memcmp(Sample.WeaveItemArray, State.WeaveItemArray, sizeof(State.WeaveItemArray)) == 0);
+    CHECK(memcmp(Sample.cbDiscardCard, State.cbDiscardCard, sizeof(State.cbDiscardCard)) == 0);
+    hiddenTiles(Sample, cbChairID, cbAfter);
+    CHECK(memcmp(cbBefore, cbAfter, MAX_INDEX) == 0);
+    CHECK(memcmp(Sample.cbCardIndex, Other.cbCardIndex, sizeof(Sample.cbCardIndex)) != 0);
+
+    //出牌候选是向听数最小的几张，第一个和出牌建议的第一项相同
+    tagGameCommand Candidates[SEARCH_MAX_CANDIDATES];
+    tagDiscardResult DiscardResult[MAX_INDEX];
+    GameLogic::analyseDiscard(State.cbCardIndex[cbChairID], State.cbWeaveItemCount[cbChairID], NULL, DiscardResult);
+    uint8_t cbCandidates = MonteCarloSearch::listCandidates(State, cbChairID, Candidates);
+    CHECK(cbCandidates > 0 && cbCandidates <= SEARCH_MAX_DISCARDS);
+    for (uint8_t c = 0; c < cbCandidates; c++) {
+        CHECK(Candidates[c].cbKind == GameCommand_OutCard);
+        uint8_t cbIndex = GameLogic::switchToCardIndex(Candidates[c].OutCard.cbCardData);
+        CHECK(State.cbCardIndex[cbChairID][cbIndex] > 0);
+        uint8_t cbCardIndex[MAX_INDEX];
+        memcpy(cbCardIndex, State.cbCardIndex[cbChairID], MAX_INDEX);
+        cbCardIndex[cbIndex]--;
+        CHECK_EQ(GameLogic::analyseShanten(cbCardIndex, State.cbWeaveItemCount[cbChairID]), DiscardResult[0].cbShanten);
+    }
+    CHECK_EQ(MonteCarloSearch::listCandidates(State, static_cast<uint8_t>((cbChairID + 1) % GAME_PLAYER), Candidates), 0);
+
+    //推演能打到终局
+    GameEngine rolloutEngine;
+    rolloutEngine.setQuiet(true);
+    int64_t lScore = 0;
+    CHECK(MonteCarloSearch::rollout(rolloutEngine, Sample, Candidates[0], cbChairID, lScore));
+}
+
+void testDecide() {
+    GameEngine engine;
+    engine.setQuiet(true);
+    BotPlayer bots[GAME_PLAYER];
+    engine.setRoomSeed(21);
+    for (int i = 0; i < GAME_PLAYER; i++) engine.onUserEnter(&bots[i]);
+    CHECK(playUntil(engine, bots, [](const tagGameState &State) { return State.cbOutCardCount >= 8 && State.cbCurrentUser < GAME_PLAYER; }));
+    const tagGameState &State = engine.getGameState();
+
+    tagSearchConfig Config;
+    Config.dwBudgetMs = 0;
+    Config.dwMaxRollouts = 160;
+    Config.llSeed = 7;
+    Config.dwThreads = 1;
+    MonteCarloSearch single(Config);
+    Config.dwThreads = 3;
+    MonteCarloSearch parallel(Config);
+    tagSearchResult Single, Parallel;
+    CHECK(single.decide(State, State.cbCurrentUser, Single));
+    CHECK(parallel.decide(State, State.cbCurrentUser, Parallel));
+    CHECK(Single.llRollouts > 100 && Single.llRollouts <= 160);     //按组推演，每组每个候选一次
+    CHECK_EQ(Parallel.llRollouts, Single.llRollouts);
+    CHECK(Single.Command.cbKind == GameCommand_OutCard && Parallel.Command.cbKind == GameCommand_OutCard);
+    CHECK_EQ(Single.Command.OutCard.cbCardData, Parallel.Command.OutCard.cbCardData);
+    CHECK(Single.dExpectedScore == Parallel.dExpectedScore);
+    std::printf("[SearchTest] %u 个候选，%llu 次推演：1 线程 %.3f 秒，3 线程 %.3f 秒\n", Single.cbCandidateCount,
+                static_cast<unsigned long long>(Single.llRollouts), Single.dElapsed, Parallel.dElapsed);
+
+    //能胡的时候选择胡
+    size_t huChecked = 0;
+    for (int g = 0; g < 20 && huChecked < 3; g++) {
+        uint8_t cbHuUser = INVALID_CHAIR;
+        bool bFound = playUntil(engine, bots, [&cbHuUser](const tagGameState &S) {
+            for (uint8_t i = 0; i < GAME_PLAYER; i++) {
+                if ((S.cbUserAction[i] & WIK_H) != 0 && !S.bResponse[i]) {
+                    cbHuUser = i;
+                    return true;
+                }
+            }
+            return false;
+        });
+        if (bFound) {
+            tagSearchResult Result;
+            CHECK(parallel.decide(engine.getGameState(), cbHuUser, Result));
+            CHECK(Result.Command.cbKind == GameCommand_OperateCard && Result.Command.OperateCard.cbOperateCode == WIK_H);
+            CHECK_EQ(Result.llRollouts, 0u);
+            huChecked++;
+        }
+        playUntil(engine, bots, [](const tagGameState &) { return false; });
+        engine.onGameRestart();
+    }
+    CHECK(huChecked > 0);
+}
+
+void testExpertBot() {
+    tagSearchConfig Config;
+    Config.dwThreads = 2;
+    Config.dwBudgetMs = 0;
+    Config.dwMaxRollouts = 48;
+    MonteCarloSearch search(Config);
+    GameEngine engine;
+    engine.setQuiet(true);
+    BotPlayer bots[GAME_PLAYER];
+    bots[0].setLevel(BotLevel_Expert);
+    bots[0].setSearch(&search, &engine.getGameState());
+    engine.setRoomSeed(31);
+    for (int i = 0; i < GAME_PLAYER; i++) engine.onUserEnter(&bots[i]);
+    size_t mismatches = 0;
+    for (int g = 0; g < 3; g++) {
+        if (g > 0) engine.onGameRestart();
+        playUntil(engine, bots, [&bots, &mismatches](const tagGameState &State) {
+            if (memcmp(bots[0].getCardIndex(), State.cbCardIndex[0], MAX_INDEX) != 0) mismatches++;
+            return false;
+        });
+        CHECK(bots[0].isGameEnd());
+    }
+    CHECK_EQ(mismatches, 0u);
+}
+
+} // namespace
+
+int main() {
+    TestUtil::muteStdout();
+    testDeterminize();
+    testDecide();
+    testExpertBot();
+    return TestUtil::finish("SearchTest");
+}
@@ -0,0 +1,198 @@
+//
+// SessionTest.cpp
+// 协程会话测试：套接字会话的握手与收发、断开清理，以及单进程同时保持 10 万个会话
+//
+// 10 万个会话使用进程内的内存管道（沙箱的文件描述符上限只有 2 万），
+// 服务端走的是与真实连接相同的会话协程、MessageHandler 和房间逻辑。
+//
+
+#include "TestUtil.h"
+#include "EventLoop.h"
+#include "MessageHandler.h"
+#include "Room.h"
+#include "RoomDirectory.h"
+#include "SessionServer.h"
+#include "SessionStream.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+const char* kHandshake =
+    "GET / HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+    "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n";
+
+// 客户端发送的文本帧（带 mask）
+std::string clientFrame(const std::string& payload) {
+    std::string frame;
+    frame.push_back(static_cast<char>(0x81));
+    size_t len = payload.size();
+    if (len < 126) {
+        frame.push_back(static_cast<char>(0x80 | len));
+    } else {
+        frame.push_back(static_cast<char>(0x80 | 126));
+        frame.push_back(static_cast<char>((len >> 8) & 0xFF));
+        frame.push_back(static_cast<char>(len & 0xFF));
+    }
+    const unsigned char mask[4] = { 0xA1, 0xB2, 0xC3, 0xD4 };
+    frame.append(reinterpret_cast<const char*>(mask), 4);
+    for (size_t i = 0; i < len; i++) {
+        frame.push_back(static_cast<char>(payload[i] ^ mask[i % 4]));
+    }
+    return frame;
+}
+
+std::string joinRoom(const std::string& roomId, const std::string& playerId) {
+    return clientFrame(R"({"type":"join_room","roomId":")" + roomId + R"(","playerId":")" + playerId
+                       + R"(","nickname":"n"})");
+}
+
+// 把服务器与 MessageHandler、房间目录按 main_websocket.cpp 的方式连接起来
+struct Fixture {
+    SessionServer server;
+    MessageHandler handler;
+    RoomDirectory rooms;
+    size_t connected;
+    size_t disconnected;
+
+    explicit Fixture(const RoomDirectory::Config& config)
+        : handler(&server)
+        , rooms(config)
+        , connected(0)
+        , disconnected(0) {
+        handler.setRoomManager([this](const std::string& roomId) -> std::shared_ptr<Room> {
+            return rooms.getOrCreate(roomId);
+        });
+        server.onConnect = [this](int) {
+            connected++;
+        };
+        server.onMessage = [this](int clientFd, const std::string& message) {
+            handler.handleMessage(clientFd, message);
+        };
+        server.onDisconnect = [this](int clientFd) {
+            disconnected++;
+            handler.cleanupClient(clientFd);
+        };
+    }
+
+    void pump() {
+        while (server.runOnce(0) > 0) {
+        }
+    }
+};
+
+void testSocketSession() {
+    Fixture fixture{RoomDirectory::Config()};
+    int fds[2];
+    CHECK_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    fixture.server.adopt(std::unique_ptr<SessionStream>(new SocketStream(fixture.server.loop(), fds[0])));
+
+    std::string request = std::string(kHandshake) + joinRoom("sock_room", "sock_player");
+    CHECK_EQ(::send(fds[1], request.data(), request.size(), 0), static_cast<ssize_t>(request.size()));
+    for (int i = 0; i < 10; i++) {
+        fixture.server.runOnce(10);
+    }
+    CHECK_EQ(fixture.connected, 1u);
+
+    char buffer[4096];
+    ssize_t n = ::recv(fds[1], buffer, sizeof(buffer), MSG_DONTWAIT);
+    std::string received = n > 0 ? std::string(buffer, n) : std::string();
+    CHECK(received.find("101 Switching Protocols") != std::string::npos);
+    CHECK(received.find("room_info") != std::string::npos);
+
+    // 客户端断开：会话结束，玩家离开房间
+    ::close(fds[1]);
+    for (int i = 0; i < 10 && fixture.server.sessionCount() > 0; i++) {
+        fixture.server.runOnce(10);
+    }
+    CHECK_EQ(fixture.server.sessionCount(), 0u);
+    CHECK_EQ(fixture.disconnected, 1u);
+    std::shared_ptr<Room> room = fixture.rooms.findByAlias("sock_room");
+    CHECK(room != nullptr && room->getPlayerCount() == 0);
+}
+
+void testRejectsBadHandshake() {
+    Fixture fixture{RoomDirectory::Config()};
+    std::unique_ptr<MemoryStream> serverEnd, clientEnd;
+    MemoryStream::createPair(fixture.server.loop(), fixture.server.allocateVirtualId(), serverEnd, clientEnd);
+    fixture.server.adopt(std::unique_ptr<SessionStream>(serverEnd.release()));
+    clientEnd->writeAll("GET / HTTP/1.1\r\nHost: x\r\n\r\n");
+    fixture.pump();
+    CHECK_EQ(fixture.server.sessionCount(), 0u);
+    CHECK_EQ(fixture.connected, 0u);
+    CHECK(clientEnd->peerClosed());
+}
+
+void testHundredThousandSessions() {
+    const size_t kSessions = 100000;
+    RoomDirectory::Config config;
+    config.slotsPerShard = 2048;           // 2.5 万张桌子
+    config.preallocatedRooms = 0;
+    Fixture fixture(config);
+
+    std::vector<std::unique_ptr<MemoryStream>> clients(kSessions);
+    size_t before = TestUtil::residentBytes();
+    for (size_t i = 0; i < kSessions; i++) {
+        std::unique_ptr<MemoryStream> serverEnd;
+        MemoryStream::createPair(fixture.server.loop(), fixture.server.allocateVirtualId(), serverEnd, clients[i]);
+        fixture.server.adopt(std::unique_ptr<SessionStream>(serverEnd.release()));
+        clients[i]->writeAll(kHandshake);
+    }
+    fixture.pump();
+    size_t after = TestUtil::residentBytes();
+    CHECK_EQ(fixture.server.sessionCount(), kSessions);
+    CHECK_EQ(fixture.connected, kSessions);
+
+    // 丢弃握手响应后再统计每个会话的常驻内存
+    size_t handshaken = 0;
+    for (size_t i = 0; i < kSessions; i++) {
+        if (clients[i]->takeAll().find("101 Switching Protocols") != std::string::npos) {
+            handshaken++;
+        }
+    }
+    CHECK_EQ(handshaken, kSessions);
+    double perSession = static_cast<double>(after - before) / kSessions;
+    std::printf("[SessionTest] %zu 个会话，常驻内存增加 %zu KB，每个会话约 %.0f 字节\n",
+                kSessions, (after - before) / 1024, perSession);
+    CHECK(perSession < 4096.0);
+
+    // 全部加入房间：每 4 个会话一桌，坐满后自动开局
+    for (size_t i = 0; i < kSessions; i++) {
+        clients[i]->writeAll(joinRoom("table_" + std::to_string(i / 4), "p" + std::to_string(i)));
+    }
+    fixture.pump();
+    size_t started = 0;
+    for (size_t i = 0; i < kSessions; i++) {
+        std::string data = clients[i]->takeAll();
+        if (data.find("room_info") != std::string::npos && data.find("game_start") != std::string::npos) {
+            started++;
+        }
+    }
+    CHECK_EQ(started, kSessions);
+    CHECK_EQ(fixture.server.sessionCount(), kSessions);
+
+    // 全部断开：会话协程结束，玩家离开房间
+    clients.clear();
+    fixture.pump();
+    CHECK_EQ(fixture.server.sessionCount(), 0u);
+    CHECK_EQ(fixture.disconnected, kSessions);
+    std::shared_ptr<Room> room = fixture.rooms.findByAlias("table_0");
+    CHECK(room != nullptr && room->getPlayerCount() == 0);
+}
+
+} // namespace
+
+int main() {
+    TestUtil::muteStdout();
+    testSocketSession();
+    testRejectsBadHandshake();
+    testHundredThousandSessions();
+    return TestUtil::finish("SessionTest");
+}
@@ -0,0 +1,211 @@
+//
+// ShantenTest.cpp
+// 向听数与出牌建议测试
+//
+// - 单门表项与逐个枚举该门全部目标牌型（面子 + 将）算出的差张数一致；
+// - 整手向听数满足定义的递推：14 张已胡为 -1，否则等于打出一张后的最小值；13 张等于摸进一张后的最小值 + 1；
+// - 13 张手牌向听数为 0 当且仅当等牌缓存非空（与 analyseHuCard 的判定一致）；
+// - 出牌建议的向听数、有效牌、剩余张数与逐张调用 analyseShanten 的结果一致，且按向听数、有效牌张数排序。
+//
+
+#include "TestUtil.h"
+#include "GameLogic.h"
+#include "HuTable.h"
+#include "ShantenTable.h"
+#include "TingCache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+//单门目标牌型：张数和面子数、是否带将
+struct Target {
+    uint8_t cbCounts[9];
+    uint8_t cbMeldCount;
+    bool bEye;
+};
+
+void collectTargets(std::vector<Target> &Targets, uint8_t cbCounts[], uint8_t cbSize, uint8_t cbKind, uint8_t cbMeldCount) {
+    Target target;
+    memcpy(target.cbCounts, cbCounts, 9);
+    target.cbMeldCount = cbMeldCount;
+    target.bEye = false;
+    Targets.push_back(target);
+    for (uint8_t i = 0; i < cbSize; i++) {
+        if (cbCounts[i] + 2 > 4) continue;
+        target.cbCounts[i] += 2;
+        target.bEye = true;
+        Targets.push_back(target);
+        target.cbCounts[i] -= 2;
+    }
+    if (cbMeldCount == MAX_WEAVE) return;
+    uint8_t cbKindCount = static_cast<uint8_t>(cbSize == 9 ? 16 : cbSize);
+    for (uint8_t k = cbKind; k < cbKindCount; k++) {
+        if (k < cbSize) {
+            if (cbCounts[k] > 1) continue;
+            cbCounts[k] += 3;
+            collectTargets(Targets, cbCounts, cbSize, k, static_cast<uint8_t>(cbMeldCount + 1));
+            cbCounts[k] -= 3;
+        } else {
+            uint8_t i = static_cast<uint8_t>(k - cbSize);
+            if (cbCounts[i] == 4 || cbCounts[i + 1] == 4 || cbCounts[i + 2] == 4) continue;
+            cbCounts[i]++; cbCounts[i + 1]++; cbCounts[i + 2]++;
+            collectTargets(Targets, cbCounts, cbSize, k, static_cast<uint8_t>(cbMeldCount + 1));
+            cbCounts[i]--; cbCounts[i + 1]--; cbCounts[i + 2]--;
+        }
+    }
+}
+
+void testSuitEntry(std::mt19937 &rng) {
+    const ShantenTable &table = ShantenTable::instance();
+    for (uint8_t cbSuit = 2; cbSuit < 4; cbSuit++) {
+        uint8_t cbSize = static_cast<uint8_t>(cbSuit < 3 ? 9 : 7);
+        std::vector<Target> Targets;
+        uint8_t cbCounts[9];
+        memset(cbCounts, 0, sizeof(cbCounts));
+        collectTargets(Targets, cbCounts, cbSize, 0, 0);
+        for (int n = 0; n < 300; n++) {
+            //随机张数（0~14 张，每种不超过 4 张）
+            memset(cbCounts, 0, sizeof(cbCounts));
+            uint8_t cbTotal = static_cast<uint8_t>(rng() % 15);
+            for (uint8_t k = 0; k < cbTotal; k++) {
+                uint8_t i = static_cast<uint8_t>(rng() % cbSize);
+                if (cbCounts[i] < 4) cbCounts[i]++;
+            }
+            uint32_t cbBits = 0;
+            for (uint8_t i = 0; i < cbSize; i++) cbBits |= static_cast<uint32_t>(cbCounts[i]) << (3 * i);
+            uint8_t cbExpected[2][MAX_WEAVE + 1];
+            memset(cbExpected, 0xFF, sizeof(cbExpected));
+            for (size_t t = 0; t < Targets.size(); t++) {
+                uint8_t cbNeed = 0;
+                for (uint8_t i = 0; i < cbSize; i++) {
+                    if (Targets[t].cbCounts[i] > cbCounts[i]) cbNeed = static_cast<uint8_t>(cbNeed + Targets[t].cbCounts[i] - cbCounts[i]);
+                }
+                uint8_t &cbBest = cbExpected[Targets[t].bEye ? 1 : 0][Targets[t].cbMeldCount];
+                if (cbNeed < cbBest) cbBest = cbNeed;
+            }
+            uint64_t llEntry = table.suitEntry(cbSuit, cbBits);
+            for (uint8_t m = 0; m <= MAX_WEAVE; m++) {
+                CHECK_EQ(ShantenTable::need(llEntry, false, m), cbExpected[0][m]);
+                CHECK_EQ(ShantenTable::need(llEntry, true, m), cbExpected[1][m]);
+            }
+        }
+    }
+}
+
+void randomHand(std::mt19937 &rng, uint8_t cbCardIndex[MAX_INDEX], uint8_t cbSize, int iSuit) {
+    memset(cbCardIndex, 0, MAX_INDEX);
+    for (uint8_t k = 0; k < cbSize;) {
+        uint8_t i = static_cast<uint8_t>(iSuit >= 0 && rng() % 3 != 0 ? iSuit * 9 + rng() % (iSuit < 3 ? 9 : 7) : rng() % MAX_INDEX);
+        if (cbCardIndex[i] == 4) continue;
+        cbCardIndex[i]++;
+        k++;
+    }
+}
+
+//14 张：已胡为 -1，否则等于打出一张后的最小值；13 张：等于摸进一张后的最小值 + 1
+void testRecurrence(std::mt19937 &rng) {
+    TingCache cache;
+    size_t readyCount = 0;
+    for (int n = 0; n < 3000; n++) {
+        uint8_t cbWeaveCount = static_cast<uint8_t>(n % 4 == 0 ? rng() % 4 : 0);
+        uint8_t cbSize = static_cast<uint8_t>(MAX_COUNT - 3 * cbWeaveCount);
+        uint8_t cbCardIndex[MAX_INDEX];
+        randomHand(rng, cbCardIndex, cbSize, n % 3 == 0 ? static_cast<int>(rng() % 4) : -1);
+
+        int8_t cbShanten = GameLogic::analyseShanten(cbCardIndex, cbWeaveCount);
+        bool bHu = HuTable::instance().isComplete(cbCardIndex);
+        if (cbWeaveCount == 0) {
+            bool bQiDui = true;
+            for (uint8_t i = 0; i < MAX_INDEX; i++) bQiDui = bQiDui && cbCardIndex[i] % 2 == 0;
+            bHu = bHu || bQiDui;
+        }
+        CHECK_EQ(cbShanten == -1, bHu);
+        int8_t cbMinOut = 127;
+        for (uint8_t i = 0; i < MAX_INDEX; i++) {
+            if (cbCardIndex[i] == 0) continue;
+            cbCardIndex[i]--;
+            int8_t cbOut = GameLogic::analyseShanten(cbCardIndex, cbWeaveCount);
+            cbMinOut = std::min(cbMinOut, cbOut);
+
+            //13 张
+            int8_t cbMinIn = 127;
+            for (uint8_t j = 0; j < MAX_INDEX; j++) {
+                if (cbCardIndex[j] == 4) continue;
+                cbCardIndex[j]++;
+                cbMinIn = std::min(cbMinIn, GameLogic::analyseShanten(cbCardIndex, cbWeaveCount));
+                cbCardIndex[j]--;
+            }
+            CHECK_EQ(cbOut, static_cast<int8_t>(cbMinIn + 1));
+            if (cbWeaveCount == 0) {
+                uint64_t llHuMask = cache.update(0, cbCardIndex, nullptr, 0);
+                CHECK_EQ(cbOut == 0, llHuMask != 0);
+                readyCount += cbOut == 0;
+            }
+            cbCardIndex[i]++;
+        }
+        if (!bHu) CHECK_EQ(cbShanten, cbMinOut);
+    }
+    std::printf("[ShantenTest] 递推对照 3000 手，打出后听牌 %zu 次\n", readyCount);
+}
+
+void testDiscard(std::mt19937 &rng) {
+    for (int n = 0; n < 2000; n++) {
+        uint8_t cbWeaveCount = static_cast<uint8_t>(n % 5 == 0 ? rng() % 4 : 0);
+        uint8_t cbCardIndex[MAX_INDEX], cbVisibleIndex[MAX_INDEX];
+        randomHand(rng, cbCardIndex, static_cast<uint8_t>(MAX_COUNT - 3 * cbWeaveCount), n % 2 == 0 ? static_cast<int>(rng() % 4) : -1);
+        for (uint8_t i = 0; i < MAX_INDEX; i++) cbVisibleIndex[i] = static_cast<uint8_t>(rng() % (5 - cbCardIndex[i]));
+
+        tagDiscardResult DiscardResult[MAX_INDEX];
+        uint8_t cbResultCount = GameLogic::analyseDiscard(cbCardIndex, cbWeaveCount, n % 7 == 0 ? nullptr : cbVisibleIndex, DiscardResult);
+        uint8_t cbOriginal[MAX_INDEX];
+        memcpy(cbOriginal, cbCardIndex, sizeof(cbOriginal));
+        uint8_t cbKindCount = 0;
+        for (uint8_t i = 0; i < MAX_INDEX; i++) cbKindCount += cbCardIndex[i] > 0;
+        CHECK_EQ(cbResultCount, cbKindCount);
+
+        for (uint8_t r = 0; r < cbResultCount; r++) {
+            const tagDiscardResult &Result = DiscardResult[r];
+            uint8_t i = GameLogic::switchToCardIndex(Result.cbOutCard);
+            CHECK(cbCardIndex[i] > 0);
+            cbCardIndex[i]--;
+            int8_t cbShanten = GameLogic::analyseShanten(cbCardIndex, cbWeaveCount);
+            CHECK_EQ(Result.cbShanten, cbShanten);
+            uint64_t llMask = 0;
+            uint8_t cbUsefulCount = 0;
+            for (uint8_t j = 0; j < MAX_INDEX; j++) {
+                if (cbCardIndex[j] == 4) continue;
+                cbCardIndex[j]++;
+                if (GameLogic::analyseShanten(cbCardIndex, cbWeaveCount) < cbShanten) {
+                    llMask |= 1ULL << j;
+                    //剩余张数按打出前的手牌算（打出的这张也已不在牌墙）
+                    int iLive = 4 - cbOriginal[j] - (n % 7 == 0 ? 0 : cbVisibleIndex[j]);
+                    if (iLive > 0) cbUsefulCount = static_cast<uint8_t>(cbUsefulCount + iLive);
+                }
+                cbCardIndex[j]--;
+            }
+            cbCardIndex[i]++;
+            CHECK_EQ(Result.llUsefulMask, llMask);
+            CHECK_EQ(Result.cbUsefulKind, static_cast<uint8_t>(__builtin_popcountll(llMask)));
+            CHECK_EQ(Result.cbUsefulCount, cbUsefulCount);
+            if (r > 0) {
+                const tagDiscardResult &Prev = DiscardResult[r - 1];
+                CHECK(Prev.cbShanten < Result.cbShanten || (Prev.cbShanten == Result.cbShanten && Prev.cbUsefulCount >= Result.cbUsefulCount));
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(20180705);
+    testSuitEntry(rng);
+    testRecurrence(rng);
+    testDiscard(rng);
+    return TestUtil::finish("ShantenTest");
+}
@@ -0,0 +1,102 @@
+//
+// SimulatorTest.cpp
+// 机器人和并行模拟器测试
+//
+// - BotPlayer 只凭事件维护的手牌、组合数，每条命令之后都与引擎状态一致（含碰、各种杠）；
+// - 机器人打的每局都能结束，积分总和为 0；
+// - 相同种子下 1 个线程和多个线程的统计完全相同，换种子统计不同。
+//
+
+#include "TestUtil.h"
+#include "BotPlayer.h"
+#include "GameEngine.h"
+#include "GameSimulator.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+void testBotTracksEngine() {
+    GameEngine engine;
+    BotPlayer bots[GAME_PLAYER];
+    engine.setRoomSeed(5);
+    for (int i = 0; i < GAME_PLAYER; i++) engine.onUserEnter(&bots[i]);
+    CHECK(bots[0].isAndroid());
+
+    size_t games = 0, commands = 0, mismatches = 0, pengs = 0, gangs = 0, huEnds = 0;
+    for (int g = 0; g < 200; g++) {
+        if (g > 0) engine.onGameRestart();
+        for (int n = 0; n < SIMULATE_MAX_STEPS && !bots[0].isGameEnd(); n++) {
+            tagGameCommand Command;
+            bool bTaken = false;
+            for (int i = 0; i < GAME_PLAYER && !bTaken; i++) bTaken = bots[i].takeCommand(Command);
+            CHECK(bTaken);
+            if (!bTaken) break;
+            GameEventBuffer Events;
+            engine.apply(Command, Events);
+            engine.dispatchEvents(Events);
+            commands++;
+            for (uint8_t e = 0; e < Events.size(); e++) {
+                if (Events[e].cbKind != GameEvent_OperateResult) continue;
+                if (Events[e].OperateResult.cbOperateCode == WIK_P) pengs++;
+                if (Events[e].OperateResult.cbOperateCode == WIK_G) gangs++;
+            }
+            if (bots[0].isGameEnd()) break;
+            const tagGameState &State = engine.getGameState();
+            for (int i = 0; i < GAME_PLAYER; i++) {
+                if (memcmp(bots[i].getCardIndex(), State.cbCardIndex[i], MAX_INDEX) != 0
+                    || bots[i].getWeaveCount() != State.cbWeaveItemCount[i]) {
+                    mismatches++;
+                }
+            }
+        }
+        CHECK(bots[0].isGameEnd());
+        if (engine.getGameState().cbHuCard != 0) huEnds++;
+        games++;
+    }
+    CHECK_EQ(mismatches, 0u);
+    CHECK(pengs > 0);
+    CHECK(gangs > 0);
+    CHECK(huEnds > 0);
+    std::printf("[SimulatorTest] %zu 局 %zu 条命令，碰 %zu 次、杠 %zu 次，胡牌结束 %zu 局\n", games, commands, pengs, gangs, huEnds);
+}
+
+void testDeterministic() {
+    tagSimulateConfig Config;
+    Config.llHands = 300;
+    Config.llSeed = 9;
+    Config.dwBatchHands = 32;
+    Config.dwThreads = 1;
+    tagSimulateStats Single;
+    GameSimulator::run(Config, Single);
+    CHECK_EQ(Single.llHands, Config.llHands);
+    CHECK_EQ(Single.llStalled, 0u);
+    CHECK_EQ(Single.llScoreMismatch, 0u);
+    CHECK_EQ(Single.llHuHands + Single.llDrawHands, Single.llHands);
+    CHECK(Single.llHuHands > 0);
+    CHECK(Single.llWinners >= Single.llHuHands);
+    CHECK_EQ(Single.llHuKind[0] + Single.llHuKind[1] + Single.llHuKind[2] + Single.llHuKind[3], Single.llWinners);   //每人次恰好一种方式
+
+    Config.dwThreads = 4;
+    tagSimulateStats Parallel;
+    GameSimulator::run(Config, Parallel);
+    CHECK(Parallel.sameResult(Single));
+
+    Config.llSeed = 10;
+    tagSimulateStats Other;
+    GameSimulator::run(Config, Other);
+    CHECK(!Other.sameResult(Single));
+    std::printf("[SimulatorTest] %llu 局：胡牌 %llu，流局 %llu，1 线程 %.3f 秒，4 线程 %.3f 秒\n",
+                static_cast<unsigned long long>(Single.llHands), static_cast<unsigned long long>(Single.llHuHands),
+                static_cast<unsigned long long>(Single.llDrawHands), Single.dElapsed, Parallel.dElapsed);
+}
+
+} // namespace
+
+int main() {
+    TestUtil::muteStdout();
+    testBotTracksEngine();
+    testDeterministic();
+    return TestUtil::finish("SimulatorTest");
+}
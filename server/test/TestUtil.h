@@ -0,0 +1,68 @@
+//
+// TestUtil.h
+// 单元测试辅助宏（不依赖第三方测试框架）
+//
+// 每个测试程序是一个独立的可执行文件，由 ctest 调用，返回非 0 表示失败。
+//
+
+#ifndef MAHJONG_TEST_UTIL_H
+#define MAHJONG_TEST_UTIL_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#include <unistd.h>
+
+namespace TestUtil {
+    inline int& failureCount() {
+        static int count = 0;
+        return count;
+    }
+
+    // 关闭 std::cout，避免被测代码的日志淹没测试输出（测试结果统一用 printf 输出）
+    inline void muteStdout() {
+        std::cout.setstate(std::ios::failbit);
+    }
+
+    // 当前进程常驻内存（字节）
+    inline size_t residentBytes() {
+        long pages = 0, resident = 0;
+        FILE* f = std::fopen("/proc/self/statm", "r");
+        if (f == nullptr) {
+            return 0;
+        }
+        if (std::fscanf(f, "%ld %ld", &pages, &resident) != 2) {
+            resident = 0;
+        }
+        std::fclose(f);
+        return static_cast<size_t>(resident) * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    }
+
+    inline int finish(const char* name) {
+        if (failureCount() == 0) {
+            std::printf("[%s] 全部通过\n", name);
+            return 0;
+        }
+        std::printf("[%s] 失败 %d 项\n", name, failureCount());
+        return 1;
+    }
+}
+
+#define CHECK(cond)                                                                  \
+    do {                                                                             \
+        if (!(cond)) {                                                               \
+            std::printf("CHECK 失败: %s (%s:%d)\n", #cond, __FILE__, __LINE__);     \
+            TestUtil::failureCount()++;                                              \
+        }                                                                            \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                                          \
+    do {                                                                                        \
+        if (!((a) == (b))) {                                                                    \
+            std::printf("CHECK_EQ 失败: %s == %s (%s:%d)\n", #a, #b, __FILE__, __LINE__);      \
+            TestUtil::failureCount()++;                                                         \
+        }                                                                                       \
+    } while (0)
+
+#endif // MAHJONG_TEST_UTIL_H
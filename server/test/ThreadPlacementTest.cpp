@@ -0,0 +1,139 @@
+//
+// ThreadPlacementTest.cpp
+// ThreadPlacement 测试：cpulist 解析、CPU 选择策略、绑核，以及按节点划分的房间目录
+//
+
+#include "TestUtil.h"
+#include "ThreadPlacement.h"
+#include "RoomDirectory.h"
+#include "Room.h"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+void testParseCpuList() {
+    std::vector<int> cpus = ThreadPlacement::parseCpuList("0-3,8,10-11\n");
+    int expected[] = { 0, 1, 2, 3, 8, 10, 11 };
+    CHECK_EQ(cpus.size(), 7u);
+    for (size_t i = 0; i < cpus.size() && i < 7; i++) {
+        CHECK_EQ(cpus[i], expected[i]);
+    }
+    CHECK_EQ(ThreadPlacement::parseCpuList("5,1,1").size(), 2u);
+    CHECK(ThreadPlacement::parseCpuList("").empty());
+    CHECK(ThreadPlacement::parseCpuList("3-1").empty());
+    CHECK(ThreadPlacement::parseCpuList("a-b").empty());
+    CHECK(ThreadPlacement::parseCpuList("1,x").empty());
+}
+
+void testTopology() {
+    CHECK(ThreadPlacement::nodeCount() >= 1);
+    size_t total = 0;
+    for (int node = 0; node < ThreadPlacement::nodeCount(); node++) {
+        const std::vector<int>& cpus = ThreadPlacement::nodeCpus(node);
+        total += cpus.size();
+        for (size_t i = 0; i < cpus.size(); i++) {
+            CHECK_EQ(ThreadPlacement::nodeOfCpu(cpus[i]), node);
+        }
+    }
+    CHECK(total >= 1u);
+    CHECK(ThreadPlacement::nodeCpus(-1).empty());
+    CHECK_EQ(ThreadPlacement::nodeOfCpu(-1), 0);
+}
+
+void testChooseWorkerCpu() {
+    PlacementConfig config;
+    config.workerCpus = ThreadPlacement::parseCpuList("2,4,6");
+
+    // 收包 CPU 在工作集合中：直接使用
+    CHECK_EQ(ThreadPlacement::chooseWorkerCpu(config, 4, 0), 4);
+    // 未知收包 CPU：轮转
+    CHECK_EQ(ThreadPlacement::chooseWorkerCpu(config, -1, 0), 2);
+    CHECK_EQ(ThreadPlacement::chooseWorkerCpu(config, -1, 4), 4);
+    // 关闭 followIncomingCpu：忽略收包 CPU
+    config.followIncomingCpu = false;
+    CHECK_EQ(ThreadPlacement::chooseWorkerCpu(config, 4, 2), 6);
+}
+
+void testPinCurrentThread() {
+    // 在子线程里绑核，不影响主线程后续的测试
+    const std::vector<int>& cpus = ThreadPlacement::nodeCpus(0);
+    int target = cpus.empty() ? 0 : cpus.back();
+    int observed = -1;
+    int pinnedCpu = -1;
+    bool pinned = false;
+    std::thread worker([target, &observed, &pinnedCpu, &pinned]() {
+        pinned = ThreadPlacement::pinCurrentThread(std::vector<int>(1, target));
+        observed = ThreadPlacement::currentCpu();
+        pinnedCpu = ThreadPlacement::pinnedCpu();
+    });
+    worker.join();
+    CHECK(pinned);
+    CHECK_EQ(observed, target);
+    CHECK_EQ(pinnedCpu, target);
+    // 绑定到多个 CPU 不算单核绑定（加入房间时仍可迁移）
+    if (cpus.size() > 1) {
+        std::thread spread([&cpus, &pinnedCpu]() {
+            ThreadPlacement::pinCurrentThread(cpus);
+            pinnedCpu = ThreadPlacement::pinnedCpu();
+        });
+        spread.join();
+        CHECK_EQ(pinnedCpu, -1);
+    }
+    CHECK(!ThreadPlacement::pinCurrentThread(std::vector<int>()));
+}
+
+void testNumaAwareDirectory() {
+    RoomDirectory::Config config;
+    config.slotsPerShard = 4;
+    config.numaAware = true;
+    config.preallocatedRooms = RoomDirectory::kShardCount * 2;
+    RoomDirectory directory(config);
+    CHECK_EQ(directory.getStats().pooledRooms, static_cast<size_t>(RoomDirectory::kShardCount * 2));
+
+    // 新房间分配在调用线程所在节点的分片上（调用线程固定在最后一个节点）
+    int node = ThreadPlacement::nodeCount() - 1;
+    std::thread worker([&directory, node]() {
+        CHECK(ThreadPlacement::migrateCurrentThreadToNode(node, std::vector<int>()));
+        for (int i = 0; i < 8; i++) {
+            std::shared_ptr<Room> room = directory.getOrCreate("numa_" + std::to_string(i));
+            CHECK(room != nullptr);
+            if (room) {
+                CHECK_EQ(room->getHomeNode(), node);
+            }
+        }
+    });
+    worker.join();
+
+    // 调用线程所在节点的分片都满了，从其他节点的分片取槽位：新建的房间对象仍在调用线程所在节点
+    RoomDirectory::Config small;
+    small.slotsPerShard = 1;
+    small.numaAware = true;
+    small.preallocatedRooms = 0;
+    RoomDirectory full(small);
+    std::thread filler([&full, node]() {
+        CHECK(ThreadPlacement::migrateCurrentThreadToNode(node, std::vector<int>()));
+        for (size_t i = 0; i < full.capacity(); i++) {
+            std::shared_ptr<Room> room = full.getOrCreate("full_" + std::to_string(i));
+            CHECK(room != nullptr);
+            if (room) {
+                CHECK_EQ(room->getHomeNode(), node);
+            }
+        }
+    });
+    filler.join();
+}
+
+} // namespace
+
+int main() {
+    TestUtil::muteStdout();
+    testParseCpuList();
+    testTopology();
+    testChooseWorkerCpu();
+    testPinCurrentThread();
+    testNumaAwareDirectory();
+    return TestUtil::finish("ThreadPlacementTest");
+}
@@ -0,0 +1,86 @@
+//
+// TileSetTest.cpp
+// 牌编码测试（编码本身由 TileSet.h 的 static_assert 在编译期检查，这里检查运行时的表）
+//
+// - 标准牌组的查表转换与原来按花色、点数计算的结果一致（全部 256 个牌值、34 个索引）；
+// - 三种牌组的牌墙每种牌张数正确（数牌、字牌 4 张，花牌 1 张），洗牌后不变；
+// - GameLogic 的转换是 constexpr，可以用在常量表达式里。
+//
+
+#include "TestUtil.h"
+#include "GameLogic.h"
+#include "TileSet.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+//改动前 GameLogic 的计算方式
+uint8_t arithmeticIndex(uint8_t cbCardData) {
+    return static_cast<uint8_t>(((cbCardData & MASK_COLOR) >> 4) * 9 + (cbCardData & MASK_VALUE) - 1);
+}
+
+uint8_t arithmeticData(uint8_t cbCardIndex) {
+    return static_cast<uint8_t>(((cbCardIndex / 9) << 4) | (cbCardIndex % 9 + 1));
+}
+
+bool arithmeticValid(uint8_t cbCardData) {
+    uint8_t cbValue = static_cast<uint8_t>(cbCardData & MASK_VALUE);
+    uint8_t cbColor = static_cast<uint8_t>((cbCardData & MASK_COLOR) >> 4);
+    return (((cbValue >= 1) && (cbValue <= 9) && (cbColor <= 2)) || ((cbValue >= 1) && (cbValue <= 7) && (cbColor == 3)));
+}
+
+void testStandard() {
+    for (uint16_t d = 0; d < 256; d++) {
+        uint8_t cbCardData = static_cast<uint8_t>(d);
+        CHECK_EQ(GameLogic::isValidCard(cbCardData), arithmeticValid(cbCardData));
+        if (arithmeticValid(cbCardData)) {
+            CHECK_EQ(GameLogic::switchToCardIndex(cbCardData), arithmeticIndex(cbCardData));
+        } else {
+            CHECK_EQ(GameLogic::switchToCardIndex(cbCardData), StandardTileSet::INVALID_INDEX);
+        }
+    }
+    for (uint8_t i = 0; i < MAX_INDEX; i++) {
+        CHECK_EQ(GameLogic::switchToCardData(i), arithmeticData(i));
+    }
+    //常量表达式
+    static_assert(GameLogic::switchToCardIndex(GameLogic::switchToCardData(20)) == 20, "constexpr 转换");
+    uint8_t cbKindCount[GameLogic::switchToCardIndex(0x37) + 1];
+    CHECK_EQ(sizeof(cbKindCount), static_cast<size_t>(MAX_INDEX));
+}
+
+template <class TILE_SET>
+void checkRepertory(const uint8_t cbCardData[]) {
+    uint8_t cbCount[TILE_SET::INDEX_COUNT];
+    memset(cbCount, 0, sizeof(cbCount));
+    for (uint8_t p = 0; p < TILE_SET::REPERTORY_COUNT; p++) {
+        CHECK(TILE_SET::isValidCard(cbCardData[p]));
+        cbCount[TILE_SET::switchToCardIndex(cbCardData[p])]++;
+    }
+    for (uint8_t i = 0; i < TILE_SET::INDEX_COUNT; i++) {
+        uint8_t cbExpected = static_cast<uint8_t>((TILE_SET::switchToCardData(i) >> 4) == TILE_SET::FLOWER_COLOR ? 1 : 4);
+        CHECK_EQ(cbCount[i], cbExpected);
+    }
+}
+
+template <class TILE_SET>
+void testRepertory(const char *name) {
+    checkRepertory<TILE_SET>(TILE_SET::repertory());
+    GameRandom random(2018);
+    uint8_t cbCardData[TILE_SET::REPERTORY_COUNT];
+    TILE_SET::shuffle(cbCardData, TILE_SET::REPERTORY_COUNT, random);
+    checkRepertory<TILE_SET>(cbCardData);
+    CHECK(memcmp(cbCardData, TILE_SET::repertory(), TILE_SET::REPERTORY_COUNT) != 0);
+    std::printf("[TileSetTest] %s %d 种 %d 张\n", name, TILE_SET::INDEX_COUNT, TILE_SET::REPERTORY_COUNT);
+}
+
+} // namespace
+
+int main() {
+    testStandard();
+    testRepertory<StandardTileSet>("标准");
+    testRepertory<SuitTileSet>("无字牌");
+    testRepertory<FlowerTileSet>("带花牌");
+    return TestUtil::finish("TileSetTest");
+}
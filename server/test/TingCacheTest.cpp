@@ -0,0 +1,200 @@
+//
+// TingCacheTest.cpp
+// 等牌缓存测试：增量更新后的等牌掩码与逐张调用 GameLogic::analyseHuCard 的结果一致
+//
+// - 随机 13 张手牌连续摸一张、打一张（大部分只有一两门变化，走增量路径），每步对照全部 34 种牌；
+// - 带碰、杠组合的 3n+1 张手牌（组合花色影响清一色）；
+// - 偏向同一门的手牌，制造清一色、七对、碰碰胡；
+// - 跳过完整分析的座位用等牌掩码算出的胡牌特殊情况（GameLogic::analyseHuSpecial）与 analyseHuCard 填入的相同。
+//
+
+#include "TestUtil.h"
+#include "GameLogic.h"
+#include "TingCache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+size_t g_checkCount = 0;
+size_t g_huCount = 0;
+
+uint64_t expectedMask(const uint8_t cbCardIndex[MAX_INDEX], tagWeaveItem WeaveItem[], uint8_t cbWeaveCount) {
+    uint64_t llMask = 0;
+    for (uint8_t j = 0; j < MAX_INDEX; j++) {
+        uint8_t huKind = 0, huSpecial = 0, cbFanShu = 0;
+        uint64_t huRight = 0;
+        if (GameLogic::analyseHuCard(cbCardIndex, WeaveItem, cbWeaveCount, GameLogic::switchToCardData(j), huKind, huRight, huSpecial, 10, 10, false, false, false, cbFanShu, false) == WIK_H) {
+            llMask |= 1ULL << j;
+        }
+    }
+    return llMask;
+}
+
+void compare(TingCache &cache, uint8_t cbChairID, const uint8_t cbCardIndex[MAX_INDEX], tagWeaveItem WeaveItem[], uint8_t cbWeaveCount) {
+    uint64_t llMask = cache.update(cbChairID, cbCardIndex, WeaveItem, cbWeaveCount);
+    uint64_t llExpected = expectedMask(cbCardIndex, WeaveItem, cbWeaveCount);
+    g_checkCount++;
+    if (llExpected != 0) g_huCount++;
+    if (llMask != llExpected) {
+        std::printf("不一致的手牌:");
+        for (uint8_t i = 0; i < MAX_INDEX; i++) {
+            if (cbCardIndex[i] != 0) std::printf(" %02x×%d", GameLogic::switchToCardData(i), cbCardIndex[i]);
+        }
+        for (uint8_t i = 0; i < cbWeaveCount; i++) {
+            std::printf(" [%02x %02x]", WeaveItem[i].cbWeaveKind, WeaveItem[i].cbCenterCard);
+        }
+        std::printf(" (组合 %d) cache=%llx expected=%llx\n", cbWeaveCount, (unsigned long long) llMask, (unsigned long long) llExpected);
+    }
+    CHECK_EQ(llMask, llExpected);
+    CHECK_EQ(cache.getHuMask(cbChairID), llExpected);
+    //胡牌特殊情况：每种来牌、天胡/地胡/普通三种出牌进度
+    static const uint8_t cbProgress[3][2] = {{1, 0}, {1, 1}, {10, 10}};
+    bool bSameSpecial = true;
+    for (uint8_t j = 0; j < MAX_INDEX; j++) {
+        const uint8_t (&cbSendOut)[2] = cbProgress[j % 3];
+        uint8_t huKind = 0, huSpecial = 0, cbFanShu = 0;
+        uint64_t huRight = 0;
+        uint8_t cbCard = GameLogic::switchToCardData(j);
+        GameLogic::analyseHuCard(cbCardIndex, WeaveItem, cbWeaveCount, cbCard, huKind, huRight, huSpecial, cbSendOut[0], cbSendOut[1], false, false, false, cbFanShu, false);
+        bSameSpecial = bSameSpecial && huSpecial == GameLogic::analyseHuSpecial(cbCardIndex, cbWeaveCount, cbCard, cbSendOut[0], cbSendOut[1], llMask);
+    }
+    CHECK(bSameSpecial);
+    uint8_t cbTingCard[MAX_INDEX];
+    uint8_t cbTingCount = cache.getTingCard(cbChairID, cbTingCard);
+    CHECK_EQ(cbTingCount, static_cast<uint8_t>(__builtin_popcountll(llExpected)));
+    for (uint8_t i = 0; i < cbTingCount; i++) {
+        CHECK(cache.canHu(cbChairID, GameLogic::switchToCardIndex(cbTingCard[i])));
+    }
+}
+
+// 牌墙：iSuit >= 0 时该门一半的牌排在前面
+std::vector<uint8_t> makeWall(std::mt19937 &rng, int iSuit) {
+    std::vector<uint8_t> wall;
+    for (uint8_t i = 0; i < MAX_INDEX; i++) {
+        for (int k = 0; k < 4; k++) wall.push_back(i);
+    }
+    std::shuffle(wall.begin(), wall.end(), rng);
+    if (iSuit < 0) return wall;
+    std::vector<uint8_t> front, back;
+    for (size_t k = 0; k < wall.size(); k++) {
+        if (wall[k] / 9 == iSuit && rng() % 2 == 0) {
+            front.push_back(wall[k]);
+        } else {
+            back.push_back(wall[k]);
+        }
+    }
+    front.insert(front.end(), back.begin(), back.end());
+    return front;
+}
+
+// 一局：摸一张、打一张（随机或打刚摸的），每步对照
+void testDrawDiscard(std::mt19937 &rng, int iSuit, uint8_t cbWeaveCount) {
+    TingCache cache;
+    std::vector<uint8_t> wall = makeWall(rng, iSuit);
+    size_t pos = 0;
+    uint8_t cbCardIndex[MAX_INDEX];
+    memset(cbCardIndex, 0, sizeof(cbCardIndex));
+    tagWeaveItem WeaveItem[MAX_WEAVE];
+    memset(WeaveItem, 0, sizeof(WeaveItem));
+
+    //组合：从牌墙里找 3 张相同的作为碰（或 4 张作为杠）
+    uint8_t cbUsed[MAX_INDEX];
+    memset(cbUsed, 0, sizeof(cbUsed));
+    for (uint8_t w = 0; w < cbWeaveCount; w++) {
+        uint8_t i = static_cast<uint8_t>(iSuit >= 0 && rng() % 4 != 0 ? iSuit * 9 + rng() % (iSuit < 3 ? 9 : 7) : rng() % MAX_INDEX);
+        if (cbUsed[i] != 0) continue;
+        bool bGang = rng() % 3 == 0;
+        cbUsed[i] = static_cast<uint8_t>(bGang ? 4 : 3);
+        WeaveItem[w].cbWeaveKind = static_cast<uint8_t>(bGang ? WIK_G : WIK_P);
+        WeaveItem[w].cbCenterCard = GameLogic::switchToCardData(i);
+        WeaveItem[w].cbValid = 1;
+    }
+    uint8_t cbRealWeave = 0;
+    for (uint8_t w = 0; w < cbWeaveCount; w++) {
+        if (WeaveItem[w].cbWeaveKind != 0) WeaveItem[cbRealWeave++] = WeaveItem[w];
+    }
+    //去掉组合用掉的牌
+    std::vector<uint8_t> rest;
+    for (size_t k = 0; k < wall.size(); k++) {
+        if (cbUsed[wall[k]] > 0) {
+            cbUsed[wall[k]]--;
+            continue;
+        }
+        rest.push_back(wall[k]);
+    }
+    uint8_t cbHandSize = static_cast<uint8_t>(MAX_COUNT - 1 - 3 * cbRealWeave);
+    for (uint8_t k = 0; k < cbHandSize; k++) cbCardIndex[rest[pos++]]++;
+    compare(cache, 0, cbCardIndex, WeaveItem, cbRealWeave);
+
+    while (pos < rest.size()) {
+        uint8_t cbDraw = rest[pos++];
+        cbCardIndex[cbDraw]++;
+        uint8_t cbOut = cbDraw;
+        if (rng() % 3 != 0) {
+            //随机打一张
+            do {
+                cbOut = static_cast<uint8_t>(rng() % MAX_INDEX);
+            } while (cbCardIndex[cbOut] == 0);
+        }
+        cbCardIndex[cbOut]--;
+        compare(cache, 0, cbCardIndex, WeaveItem, cbRealWeave);
+    }
+    CHECK(cache.getHitCount() > 0);
+    CHECK(cache.getPartialCount() > 0);
+    CHECK_EQ(cache.getFullCount(), 1u);
+}
+
+// 胡牌手去掉一张：一定有等牌
+void testReadyHands(std::mt19937 &rng) {
+    TingCache cache;
+    for (int n = 0; n < 20000; n++) {
+        uint8_t cbCardIndex[MAX_INDEX];
+        memset(cbCardIndex, 0, sizeof(cbCardIndex));
+        uint8_t cbSuit = static_cast<uint8_t>(rng() % 4);
+        bool bPairs = rng() % 4 == 0;
+        bool bValid = true;
+        if (bPairs) {
+            for (int p = 0; p < 7; p++) {
+                uint8_t i = static_cast<uint8_t>(rng() % 2 == 0 ? cbSuit * 9 + rng() % (cbSuit < 3 ? 9 : 7) : rng() % MAX_INDEX);
+                cbCardIndex[i] += 2;
+            }
+        } else {
+            for (int m = 0; m < MAX_WEAVE; m++) {
+                uint8_t cbGroup = static_cast<uint8_t>(rng() % 2 == 0 ? cbSuit : rng() % 4);
+                if (cbGroup < 3 && rng() % 2 == 0) {
+                    uint8_t i = static_cast<uint8_t>(cbGroup * 9 + rng() % 7);
+                    cbCardIndex[i]++; cbCardIndex[i + 1]++; cbCardIndex[i + 2]++;
+                } else {
+                    cbCardIndex[cbGroup * 9 + rng() % (cbGroup < 3 ? 9 : 7)] += 3;
+                }
+            }
+            cbCardIndex[cbSuit * 9 + rng() % (cbSuit < 3 ? 9 : 7)] += 2;
+        }
+        for (uint8_t i = 0; i < MAX_INDEX; i++) bValid = bValid && cbCardIndex[i] <= 4;
+        if (!bValid) continue;
+        uint8_t cbOut;
+        do {
+            cbOut = static_cast<uint8_t>(rng() % MAX_INDEX);
+        } while (cbCardIndex[cbOut] == 0);
+        cbCardIndex[cbOut]--;
+        compare(cache, static_cast<uint8_t>(n % GAME_PLAYER), cbCardIndex, nullptr, 0);
+    }
+}
+
+} // namespace
+
+int main() {
+    TestUtil::muteStdout();
+    std::mt19937 rng(20180705);
+    for (int g = 0; g < 300; g++) {
+        testDrawDiscard(rng, g % 5 - 1, static_cast<uint8_t>(g % 3 == 0 ? rng() % 4 : 0));
+    }
+    testReadyHands(rng);
+    std::printf("[TingCacheTest] 共对照 %zu 手，其中听牌 %zu 手\n", g_checkCount, g_huCount);
+    return TestUtil::finish("TingCacheTest");
+}
@@ -0,0 +1,103 @@
+//
+// WebSocketCodecTest.cpp
+// WebSocketCodec 测试：握手响应、帧编码/解码（含 mask、扩展长度、数据不足、超长帧）
+//
+
+#include "TestUtil.h"
+#include "WebSocketCodec.h"
+
+#include <string>
+
+namespace {
+
+// 构造客户端发送的帧（客户端必须加 mask）
+std::string maskedFrame(int opcode, const std::string& payload) {
+    std::string frame;
+    frame.push_back(static_cast<char>(0x80 | opcode));
+    size_t len = payload.size();
+    if (len < 126) {
+        frame.push_back(static_cast<char>(0x80 | len));
+    } else {
+        frame.push_back(static_cast<char>(0x80 | 126));
+        frame.push_back(static_cast<char>((len >> 8) & 0xFF));
+        frame.push_back(static_cast<char>(len & 0xFF));
+    }
+    const unsigned char mask[4] = { 0x12, 0x34, 0x56, 0x78 };
+    frame.append(reinterpret_cast<const char*>(mask), 4);
+    for (size_t i = 0; i < len; i++) {
+        frame.push_back(static_cast<char>(payload[i] ^ mask[i % 4]));
+    }
+    return frame;
+}
+
+void testHandshake() {
+    std::string request = "GET / HTTP/1.1\r\nHost: localhost\r\nSec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n\r\n";
+    std::string key = WebSocketCodec::extractKey(request);
+    CHECK(key == "dGhlIHNhbXBsZSBub25jZQ==");
+    // RFC 6455 示例
+    std::string response = WebSocketCodec::handshakeResponse(key);
+    CHECK(response.find("Sec-WebSocket-Accept: s3pPLMBiTxaQ9kYGzzhZRbK+xOo=\r\n") != std::string::npos);
+    CHECK(WebSocketCodec::extractKey("GET / HTTP/1.1\r\n\r\n").empty());
+}
+
+void testRoundTrip() {
+    const size_t sizes[] = { 0, 5, 125, 126, 300, 65535, 65536, 70000 };
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        std::string text(sizes[i], 'x');
+        std::string frame;
+        WebSocketCodec::appendTextFrame(text, frame);
+
+        int opcode = 0;
+        std::string payload;
+        long consumed = WebSocketCodec::decodeFrame(frame.data(), frame.size(), opcode, payload);
+        CHECK_EQ(consumed, static_cast<long>(frame.size()));
+        CHECK_EQ(opcode, WebSocketCodec::kOpcodeText);
+        CHECK(payload == text);
+
+        // 数据不足时返回 0
+        CHECK_EQ(WebSocketCodec::decodeFrame(frame.data(), frame.size() - 1, opcode, payload), 0L);
+    }
+}
+
+void testMaskedFrames() {
+    std::string data = maskedFrame(WebSocketCodec::kOpcodeText, "{\"type\":\"join_room\"}")
+                      + maskedFrame(WebSocketCodec::kOpcodeText, std::string(200, 'a'))
+                      + maskedFrame(WebSocketCodec::kOpcodeClose, "");
+    int opcode = 0;
+    std::string payload;
+    size_t offset = 0;
+
+    long consumed = WebSocketCodec::decodeFrame(data.data(), data.size(), opcode, payload);
+    CHECK(consumed > 0);
+    CHECK(payload == "{\"type\":\"join_room\"}");
+    offset += consumed;
+
+    consumed = WebSocketCodec::decodeFrame(data.data() + offset, data.size() - offset, opcode, payload);
+    CHECK(consumed > 0);
+    CHECK(payload == std::string(200, 'a'));
+    offset += consumed;
+
+    consumed = WebSocketCodec::decodeFrame(data.data() + offset, data.size() - offset, opcode, payload);
+    CHECK_EQ(opcode, WebSocketCodec::kOpcodeClose);
+    CHECK_EQ(offset + consumed, data.size());
+}
+
+void testOversizedFrame() {
+    std::string frame;
+    frame.push_back(static_cast<char>(0x81));
+    frame.push_back(static_cast<char>(127));
+    frame.append("\x00\x00\x00\x00\x10\x00\x00\x00", 8);    // 256 MB
+    int opcode = 0;
+    std::string payload;
+    CHECK_EQ(WebSocketCodec::decodeFrame(frame.data(), frame.size(), opcode, payload), -1L);
+}
+
+} // namespace
+
+int main() {
+    testHandshake();
+    testRoundTrip();
+    testMaskedFrames();
+    testOversizedFrame();
+    return TestUtil::finish("WebSocketCodecTest");
+}